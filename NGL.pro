@@ -131,6 +131,18 @@ win32{
 SOURCES += $$SRC_DIR/Vec4.cpp \
 		$$SRC_DIR/VAOPrimitives.cpp \
 		$$SRC_DIR/Util.cpp \
+		$$SRC_DIR/BatchTransform.cpp \
+		$$SRC_DIR/BoundingVolume.cpp \
+		$$SRC_DIR/BVH.cpp \
+		$$SRC_DIR/DynamicBVH.cpp \
+		$$SRC_DIR/TransformHierarchy.cpp \
+		$$SRC_DIR/QuaternionArray.cpp \
+		$$SRC_DIR/GLStateCache.cpp \
+		$$SRC_DIR/UniformBlock.cpp \
+		$$SRC_DIR/UniformBuffer.cpp \
+		$$SRC_DIR/BatchRenderer.cpp \
+		$$SRC_DIR/Vec3Array.cpp \
+		$$SRC_DIR/Vec4Array.cpp \
 		$$SRC_DIR/Texture.cpp \
 		$$SRC_DIR/SpotLight.cpp \
 		$$SRC_DIR/ShaderLib.cpp \
@@ -146,6 +158,7 @@ SOURCES += $$SRC_DIR/Vec4.cpp \
 		$$SRC_DIR/Colour.cpp \
 		$$SRC_DIR/Camera.cpp \
 		$$SRC_DIR/NCCABinMesh.cpp \
+		$$SRC_DIR/MappedFile.cpp \
 		$$SRC_DIR/BezierCurve.cpp \
 		$$SRC_DIR/BBox.cpp \
 		$$SRC_DIR/AbstractMesh.cpp \
@@ -191,6 +204,19 @@ HEADERS += $$INC_DIR/Vec4.h \
 		$$INC_DIR/VAOPrimitives.h \
 		$$INC_DIR/Singleton.h \
 		$$INC_DIR/Util.h \
+		$$INC_DIR/BatchTransform.h \
+		$$INC_DIR/BoundingVolume.h \
+		$$INC_DIR/BVH.h \
+		$$INC_DIR/DynamicBVH.h \
+		$$INC_DIR/TransformHierarchy.h \
+		$$INC_DIR/QuaternionArray.h \
+		$$INC_DIR/GLStateCache.h \
+		$$INC_DIR/UniformBlock.h \
+		$$INC_DIR/UniformBuffer.h \
+		$$INC_DIR/BatchRenderer.h \
+		$$INC_DIR/AlignedAllocator.h \
+		$$INC_DIR/Vec3Array.h \
+		$$INC_DIR/Vec4Array.h \
 		$$INC_DIR/Types.h \
 		$$INC_DIR/Texture.h \
 		$$INC_DIR/SpotLight.h \
@@ -209,6 +235,7 @@ HEADERS += $$INC_DIR/Vec4.h \
 		$$INC_DIR/Camera.h \
 		$$INC_DIR/BezierCurve.h \
 		$$INC_DIR/NCCABinMesh.h \
+		$$INC_DIR/MappedFile.h \
 		$$INC_DIR/BBox.h \
 		$$INC_DIR/AbstractMesh.h \
 		$$INC_DIR/Random.h \
@@ -236,6 +263,10 @@ HEADERS += $$INC_DIR/Vec4.h \
 		$$SRC_DIR/shaders/ColourShaders.h \
 		$$SRC_DIR/shaders/DiffuseShaders.h \
 		$$SRC_DIR/shaders/ToonShaders.h \
+		$$SRC_DIR/ngl/TextScanner.h \
+		$$SRC_DIR/ngl/SIMD.h \
+		$$SRC_DIR/ngl/LaneKernels.h \
+		$$SRC_DIR/ngl/ParallelFor.h \
 		$$INC_DIR/rapidxml/rapidxml.hpp \
 		$$INC_DIR/rapidxml/rapidxml_iterators.hpp \
 		$$INC_DIR/rapidxml/rapidxml_print.hpp \
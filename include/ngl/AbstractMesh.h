@@ -35,17 +35,117 @@
 namespace ngl
 {
 //----------------------------------------------------------------------------------------------------------------------
-/// @class Face  "include/Obj.h"
-/// @brief simple class used to encapsulate a single face of an abstract mesh file
-/// @todo add the ability to have user installable attribute lists
+/// @class FaceList  "include/AbstractMesh.h"
+/// @brief compact storage for the faces of an abstract mesh. Rather than each face owning its own
+/// index lists all the indices are held in contiguous arrays (compressed sparse row style) with an offset
+/// array giving the start of each face. The texture and normal index arrays are either empty (if no face
+/// uses them) or parallel to the vertex index array.
 //----------------------------------------------------------------------------------------------------------------------
-class Face
+class NGL_DLLEXPORT FaceList
 {
 public :
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief the number of vertices in the face
+  /// @class Face
+  /// @brief a light weight read only view of a single face in the FaceList
   //----------------------------------------------------------------------------------------------------------------------
-  unsigned int m_numVerts;
+  class Face
+  {
+  public :
+    Face(const FaceList &_list, size_t _index) noexcept :
+      m_list(&_list),m_begin(_list.m_offsets[_index]),m_end(_list.m_offsets[_index+1]),m_flags(_list.m_flags[_index]) {;}
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of vertices in the face
+    //----------------------------------------------------------------------------------------------------------------------
+    uint32_t numVerts() const noexcept { return m_end-m_begin; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief The vertices index
+    //----------------------------------------------------------------------------------------------------------------------
+    uint32_t vert(uint32_t _i) const noexcept { return m_list->m_vert[m_begin+_i]; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief The texture co-ord index (only valid if hasTextureCoords)
+    //----------------------------------------------------------------------------------------------------------------------
+    uint32_t tex(uint32_t _i) const noexcept { return m_list->m_tex[m_begin+_i]; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the normal index (only valid if hasNormals)
+    //----------------------------------------------------------------------------------------------------------------------
+    uint32_t norm(uint32_t _i) const noexcept { return m_list->m_norm[m_begin+_i]; }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief pointer to the vertex indices of this face (numVerts long)
+    //----------------------------------------------------------------------------------------------------------------------
+    const uint32_t *verts() const noexcept { return &m_list->m_vert[m_begin]; }
+    bool hasTextureCoords() const noexcept { return (m_flags & TextureCoords) !=0; }
+    bool hasNormals() const noexcept { return (m_flags & Normals) !=0; }
+  private :
+    const FaceList *m_list;
+    uint32_t m_begin;
+    uint32_t m_end;
+    uint8_t m_flags;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief forward iterator over the faces, dereferences to a Face view
+  //----------------------------------------------------------------------------------------------------------------------
+  class const_iterator
+  {
+  public :
+    const_iterator(const FaceList &_list, size_t _index) noexcept : m_list(&_list), m_index(_index) {;}
+    Face operator*() const noexcept { return Face(*m_list,m_index); }
+    const_iterator & operator++() noexcept { ++m_index; return *this; }
+    bool operator==(const const_iterator &_rhs) const noexcept { return m_index==_rhs.m_index; }
+    bool operator!=(const const_iterator &_rhs) const noexcept { return m_index!=_rhs.m_index; }
+  private :
+    const FaceList *m_list;
+    size_t m_index;
+  };
+
+  FaceList() noexcept : m_offsets(1,0) {;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of faces
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t size() const noexcept { return m_flags.size(); }
+  bool empty() const noexcept { return m_flags.empty(); }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the total number of face vertices (corners) in all the faces
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t numIndices() const noexcept { return m_vert.size(); }
+  Face operator[](size_t _i) const noexcept { return Face(*this,_i); }
+  const_iterator begin() const noexcept { return const_iterator(*this,0); }
+  const_iterator end() const noexcept { return const_iterator(*this,size()); }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a face to the end of the list
+  /// @param[in] _numVerts the number of vertices in the face
+  /// @param[in] _vert the vertex indices
+  /// @param[in] _tex the texture co-ord indices or nullptr if not used
+  /// @param[in] _norm the normal indices or nullptr if not used
+  //----------------------------------------------------------------------------------------------------------------------
+  void addFace(uint32_t _numVerts, const uint32_t *_vert, const uint32_t *_tex, const uint32_t *_norm);
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief overwrite the indices of an existing face, the number of vertices can't change
+  //----------------------------------------------------------------------------------------------------------------------
+  void setFace(size_t _face, const uint32_t *_vert, const uint32_t *_tex, const uint32_t *_norm) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief append all the faces from another list (indices are copied as is)
+  //----------------------------------------------------------------------------------------------------------------------
+  void append(const FaceList &_faces);
+  void reserve(size_t _numFaces, size_t _numIndices);
+  void clear() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the raw arrays, offsets has size()+1 entries, face i uses indices [offsets[i],offsets[i+1])
+  //----------------------------------------------------------------------------------------------------------------------
+  const std::vector<uint32_t> & offsets() const noexcept { return m_offsets; }
+  const std::vector<uint32_t> & vertIndices() const noexcept { return m_vert; }
+  const std::vector<uint32_t> & texIndices() const noexcept { return m_tex; }
+  const std::vector<uint32_t> & normalIndices() const noexcept { return m_norm; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of bytes used to store the faces
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t memorySize() const noexcept;
+
+private :
+  enum : uint8_t { TextureCoords=1, Normals=2 };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the start of each face in the index arrays plus a final end value
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<uint32_t> m_offsets;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief The vertices index
   //----------------------------------------------------------------------------------------------------------------------
@@ -59,12 +159,16 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   std::vector<uint32_t> m_norm;
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief debug flag to turn face on and off
+  /// @brief per face flags to say if texture co-ords and normals are present
   //----------------------------------------------------------------------------------------------------------------------
-  bool m_textureCoord;
-  bool m_normals;
+  std::vector<uint8_t> m_flags;
 };
 
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the old Face class has been replaced by a view into the FaceList
+//----------------------------------------------------------------------------------------------------------------------
+using Face=FaceList::Face;
+
 //----------------------------------------------------------------------------------------------------------------------
 /// @class IndexRef
 /// @brief a class to hold the index into vert / norm and tex list for creating the VBO data structure
@@ -142,7 +246,7 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   void scale( Real _sx, Real _sy, Real _sz ) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief a method to set the BBox and center
+  /// @brief a method to set the BBox, center and bounding sphere
   //----------------------------------------------------------------------------------------------------------------------
   void calcDimensions() noexcept;
   //----------------------------------------------------------------------------------------------------------------------
@@ -162,6 +266,84 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   virtual void createVAO() noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief create an indexed VAO from the current mesh data, face corners with the same (vert,normal,uv)
+  /// indices are merged into a single vertex and drawn using a SimpleIndexVAO, GL_UNSIGNED_SHORT indices
+  /// are used if there are at most 65536 unique vertices else GL_UNSIGNED_INT. The vertex layout is
+  /// the same as createVAO so the same shaders can be used.
+  /// @param[in] _optimise if true optimiseIndexedData is run before the data is uploaded
+  //----------------------------------------------------------------------------------------------------------------------
+  void createIndexedVAO(bool _optimise=false) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief build the de-duplicated vertex list (getIndices) and the triangle index list (getOutIndices)
+  /// on the CPU, this is called by createIndexedVAO but needs no GL context so may be used on it's own
+  //----------------------------------------------------------------------------------------------------------------------
+  void buildIndexedData() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the triangle index list built by buildIndexedData, each value indexes getIndices
+  /// @returns the array of triangle indices
+  //----------------------------------------------------------------------------------------------------------------------
+  const std::vector<GLuint> & getOutIndices() const noexcept{ return m_outIndices; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the ratio of triangle corners to unique vertices from the last buildIndexedData call
+  /// (1.0 means no vertices were shared)
+  //----------------------------------------------------------------------------------------------------------------------
+  Real getVertexReuseRatio() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief pack the vertices built by buildIndexedData (which is called if needed) in the u,v,nx,ny,nz,x,y,z layout
+  /// used by createVAO, getOutIndices then indexes them. No GL context is needed, this is used by BatchRenderer
+  /// @param[out] o_data the packed vertices, 8 floats each
+  //----------------------------------------------------------------------------------------------------------------------
+  void getIndexedVertexData(std::vector<Real> &o_data) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief re-order the triangles built by buildIndexedData for the post transform vertex cache using
+  /// Tom Forsyth's linear speed vertex cache optimisation, then renumber the vertices in the order they are
+  /// first used so vertex fetches are also sequential. The ACMR before and after is reported.
+  /// @param[in] _cacheSize the size of the vertex cache to optimise for
+  //----------------------------------------------------------------------------------------------------------------------
+  void optimiseIndexedData(unsigned int _cacheSize=32) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief calculate the average cache miss ratio (vertices transformed per triangle) of the current
+  /// triangle index list using a FIFO cache simulation, 3.0 is the worst case and ~0.5 the best for a regular grid
+  /// @param[in] _cacheSize the size of the simulated vertex cache
+  //----------------------------------------------------------------------------------------------------------------------
+  Real calcACMR(unsigned int _cacheSize=32) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief create a VAO for meshes with animated positions (for example from NCCAPointBake), the
+  /// positions are kept in their own buffer and the uv / normals in a second static buffer of a
+  /// MultiBufferVAO. The corner to vertex remap is built once so each new frame of positions is
+  /// uploaded with updatePositionStream without touching the rest of the vertex data. Attributes are as createVAO.
+  //----------------------------------------------------------------------------------------------------------------------
+  void createAnimatedVAO() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief build the remap from each triangle corner (in createVAO order) to its vertex, this is called
+  /// by createAnimatedVAO but needs no GL context so may be used on it's own
+  //----------------------------------------------------------------------------------------------------------------------
+  void buildPositionRemap() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the corner to vertex remap built by buildPositionRemap
+  //----------------------------------------------------------------------------------------------------------------------
+  const std::vector<uint32_t> & getPositionRemap() const noexcept{ return m_positionRemap; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief gather per vertex positions into draw order (one per triangle corner) using the remap
+  /// @param[in] _positions the position of each vertex
+  /// @param[out] o_stream the positions in the order of the position buffer
+  //----------------------------------------------------------------------------------------------------------------------
+  void remapPositions(const std::vector<Vec3> &_positions, std::vector<Vec3> &o_stream) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief upload new vertex positions to a VAO created by createAnimatedVAO, the buffer storage is
+  /// orphaned and re-filled with glBufferSubData so we don't stall on the previous frame's draw
+  /// @param[in] _positions the position of each vertex
+  //----------------------------------------------------------------------------------------------------------------------
+  void updatePositionStream(const std::vector<Vec3> &_positions) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief was the VAO created with createAnimatedVAO
+  //----------------------------------------------------------------------------------------------------------------------
+  bool hasPositionStream() const noexcept{ return m_positionStream; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief is the VAO indexed (created with createIndexedVAO)
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isIndexed() const noexcept{ return m_indexed; }
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief get the texture id
   /// @returns the texture id
   //----------------------------------------------------------------------------------------------------------------------
@@ -182,11 +364,12 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   const std::vector<IndexRef> & getIndices()  noexcept{ return m_indices; }
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief save the mesh as NCCA Binary VBO format
-  /// basically this format is the processed binary vbo mesh data as
-  /// as packed by the CreateVBO() method is called.
+  /// @brief save the mesh in the NCCA binary (version 2) format, this is the indexed data from
+  /// buildIndexedData (which is called if needed) so no GL context is required, see NCCABinMesh
+  /// @param[in] _fname the name of the file to save
+  /// @returns true on success
   //----------------------------------------------------------------------------------------------------------------------
-  void saveNCCABinaryMesh( const std::string &_fname ) noexcept;
+  virtual bool saveNCCABinaryMesh( const std::string &_fname ) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief a method to get the current bounding box of the mesh
   /// @returns the bounding box for the loaded mesh;
@@ -199,6 +382,10 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   std::vector <Vec3> getVertexList() noexcept{return m_verts;}
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief read only access to the vertex data without copying it
+  //----------------------------------------------------------------------------------------------------------------------
+  const std::vector <Vec3> & getVertices() const noexcept{return m_verts;}
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief accessor for the vertex data
   /// @returns a std::vector containing the vert data
   //----------------------------------------------------------------------------------------------------------------------
@@ -220,9 +407,9 @@ public :
   std::vector <Vec3> getTextureCordList() noexcept{return m_tex;}
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief accessor for the Face data
-  /// @returns a std::vector containing the face data
+  /// @returns the face list which can be iterated or indexed to give a Face view
   //----------------------------------------------------------------------------------------------------------------------
-  std::vector <Face> getFaceList() noexcept{return m_face;}
+  const FaceList & getFaceList() const noexcept{return m_face;}
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief accessor to get the number of vertices in the object
   //----------------------------------------------------------------------------------------------------------------------
@@ -253,7 +440,7 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   Vec3 getCenter() const  noexcept{return m_center;}
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief check to see if obj is triangulated as we only support tri or quad objs at the moment
+  /// @brief check to see if obj is triangulated, polygon faces are split into triangle fans by createVAO
   /// @returns true or false
   //----------------------------------------------------------------------------------------------------------------------
   bool isTriangular() noexcept;
@@ -288,19 +475,20 @@ protected :
   //----------------------------------------------------------------------------------------------------------------------
   std::vector<Vec3> m_tex;
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief Pointer to the Face list
+  /// @brief the Face list
   //----------------------------------------------------------------------------------------------------------------------
-  std::vector<Face> m_face;
+  FaceList m_face;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief Center of the object
   //----------------------------------------------------------------------------------------------------------------------
   Vec3 m_center;
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief a vector of indices used to pass the index into the Data arrays to the VBO
+  /// @brief the unique (vert,normal,tex) index triples, one per vertex of the indexed VAO
   //----------------------------------------------------------------------------------------------------------------------
   std::vector<IndexRef> m_indices;
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief a vectr of indices without duplicates which are actually passed to the VBO when creating
+  /// @brief the triangle list indices into m_indices which are passed to the index buffer when creating
+  /// the indexed VAO
   //----------------------------------------------------------------------------------------------------------------------
   std::vector<GLuint> m_outIndices;
   //----------------------------------------------------------------------------------------------------------------------
@@ -325,6 +513,18 @@ protected :
   //----------------------------------------------------------------------------------------------------------------------
   bool m_vao;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief flag to indicate if the VAO was created by createIndexedVAO, in this case the vertex
+  /// buffer holds one entry per m_indices element rather than one per triangle corner
+  //----------------------------------------------------------------------------------------------------------------------
+  bool m_indexed=false;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief flag to indicate if the VAO was created by createAnimatedVAO, the positions are then in
+  /// buffer 0 (one per m_positionRemap entry) and m_positionData is the last data uploaded
+  //----------------------------------------------------------------------------------------------------------------------
+  bool m_positionStream=false;
+  std::vector<uint32_t> m_positionRemap;
+  std::vector<Vec3> m_positionData;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief flag to indicate if the VBO vertex data has been mapped
   //----------------------------------------------------------------------------------------------------------------------
   bool m_vboMapped;
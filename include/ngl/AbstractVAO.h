@@ -18,6 +18,7 @@
 #define ABSTRACTVAO_H_
 
 #include "Types.h"
+#include <vector>
 
 namespace ngl
 {
@@ -63,6 +64,13 @@ class NGL_DLLEXPORT AbstractVAO
     //----------------------------------------------------------------------------------------------------------------------
     virtual void draw()const =0;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw _instances copies of the VAO with one call (glDrawArraysInstanced type function), the per
+    /// instance data is set with setInstanceData and setInstanceAttributePointer, VAO must be bound before calling
+    /// this. The default prints a warning, all the VAO's from the VAOFactory implement it.
+    /// @param _instances the number of instances to draw
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void drawInstanced(GLsizei _instances) const;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief this method is used to set the data in the VAO, we have a base data type of
     /// VertexData above, but the user can extend this to create custom data types
     //----------------------------------------------------------------------------------------------------------------------
@@ -85,6 +93,34 @@ class NGL_DLLEXPORT AbstractVAO
     //----------------------------------------------------------------------------------------------------------------------
     void setVertexAttributePointer(GLuint _id, GLint _size, GLenum _type, GLsizei _stride, unsigned int _dataOffset, bool _normalise=false );
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief copy per instance data to an instance buffer, the buffer is created the first time it is used. Each call
+    /// gives the buffer new storage so the data can be sent every frame without waiting for the last draws to finish
+    /// (use GL_STREAM_DRAW for the mode), VAO must be bound before calling this.
+    /// @param _buffer the index of the instance buffer (from 0, the buffers are separate from the vertex data)
+    /// @param _data the data to copy
+    //----------------------------------------------------------------------------------------------------------------------
+    void setInstanceData(unsigned int _buffer, const VertexData &_data);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set a generic vertex attribute to read from an instance buffer, stepping once every _divisor instances
+    /// rather than once per vertex. The other parameters are as setVertexAttributePointer
+    /// @param _buffer the index of the instance buffer set with setInstanceData
+    /// @param _divisor the number of instances drawn with each value
+    //----------------------------------------------------------------------------------------------------------------------
+    void setInstanceAttributePointer(unsigned int _buffer, GLuint _id, GLint _size, GLenum _type, GLsizei _stride,
+                                     unsigned int _dataOffset, GLuint _divisor=1, bool _normalise=false);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief set the four attributes from _id to read a Mat4 per instance (a column each as Mat4::openGL) from an
+    /// instance buffer, use as a mat4 attribute at _id in the shader
+    /// @param _buffer the index of the instance buffer set with setInstanceData
+    /// @param _id the first of the four attributes
+    //----------------------------------------------------------------------------------------------------------------------
+    void setInstanceMat4AttributePointer(unsigned int _buffer, GLuint _id);
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the number of instance buffers created and the id of one
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t numInstanceBuffers() const {return m_instanceBuffers.size();}
+    GLuint getInstanceBufferID(unsigned int _buffer) const;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief the number of indices to draw in the array. It may be that the draw routine can overide this at another time.
     /// @param _s the number of indices to draw (from 0)
     //----------------------------------------------------------------------------------------------------------------------
@@ -113,6 +149,10 @@ class NGL_DLLEXPORT AbstractVAO
     //----------------------------------------------------------------------------------------------------------------------
     AbstractVAO(GLenum _mode=GL_TRIANGLES) ;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief delete the instance buffers, called by removeVAO
+    //----------------------------------------------------------------------------------------------------------------------
+    void removeInstanceBuffers();
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief the draw mode
     //----------------------------------------------------------------------------------------------------------------------
     GLenum m_mode=GL_TRIANGLES;
@@ -132,6 +172,10 @@ class NGL_DLLEXPORT AbstractVAO
     /// @brief the number of indices stored in the VAO.
     //----------------------------------------------------------------------------------------------------------------------
     size_t m_indicesCount=0;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the ids of the per instance data buffers
+    //----------------------------------------------------------------------------------------------------------------------
+    std::vector<GLuint> m_instanceBuffers;
 };
 
 
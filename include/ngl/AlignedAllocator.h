@@ -0,0 +1,82 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef ALIGNEDALLOCATOR_H_
+#define ALIGNEDALLOCATOR_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file AlignedAllocator.h
+/// @brief a std allocator returning memory aligned to a given boundary so std::vector can be used for
+/// data processed with SIMD instructions (C++11 new doesn't honour alignment over 16 bytes)
+//----------------------------------------------------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class AlignedAllocator "include/ngl/AlignedAllocator.h"
+/// @brief allocator for std containers with the storage aligned to Alignment bytes (a power of 2)
+/// @example std::vector<float,AlignedAllocator<float,32>> data;
+//----------------------------------------------------------------------------------------------------------------------
+template <class T, size_t Alignment>
+class AlignedAllocator
+{
+  static_assert(Alignment>=alignof(void *) && (Alignment & (Alignment-1))==0,"Alignment must be a power of 2");
+public :
+  typedef T value_type;
+  template <class U> struct rebind { typedef AlignedAllocator<U,Alignment> other; };
+
+  AlignedAllocator() noexcept {}
+  template <class U> AlignedAllocator(const AlignedAllocator<U,Alignment> &) noexcept {}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief allocate space for _n T's, we over allocate and keep the pointer malloc gave us just before
+  /// the aligned block so it can be freed
+  //----------------------------------------------------------------------------------------------------------------------
+  T * allocate(size_t _n)
+  {
+    void *raw=std::malloc(_n*sizeof(T)+Alignment+sizeof(void *));
+    if(raw==nullptr)
+    {
+      throw std::bad_alloc();
+    }
+    uintptr_t start=reinterpret_cast<uintptr_t>(raw)+sizeof(void *);
+    uintptr_t aligned=(start+Alignment-1) & ~(uintptr_t(Alignment)-1);
+    reinterpret_cast<void **>(aligned)[-1]=raw;
+    return reinterpret_cast<T *>(aligned);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief free memory from allocate
+  //----------------------------------------------------------------------------------------------------------------------
+  void deallocate(T *_p, size_t) noexcept
+  {
+    if(_p !=nullptr)
+    {
+      std::free(reinterpret_cast<void **>(_p)[-1]);
+    }
+  }
+};
+
+template <class T, class U, size_t Alignment>
+inline bool operator==(const AlignedAllocator<T,Alignment> &, const AlignedAllocator<U,Alignment> &) noexcept { return true; }
+template <class T, class U, size_t Alignment>
+inline bool operator!=(const AlignedAllocator<T,Alignment> &, const AlignedAllocator<U,Alignment> &) noexcept { return false; }
+
+} // end namespace ngl
+
+#endif
+//----------------------------------------------------------------------------------------------------------------------
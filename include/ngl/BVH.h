@@ -0,0 +1,178 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef BVH_H_
+#define BVH_H_
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Vec3.h"
+#include <cstdint>
+#include <limits>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BVH.h
+/// @brief a bounding volume hierarchy over triangles for ray, overlap and frustum queries
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+class AbstractMesh;
+class Camera;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the result of a ray query
+//----------------------------------------------------------------------------------------------------------------------
+struct NGL_DLLEXPORT BVHHit
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the distance along the ray (in units of the ray direction)
+  //----------------------------------------------------------------------------------------------------------------------
+  Real m_t=0.0f;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the barycentric co-ordinates of the hit, the point is v0*(1-u-v)+v1*u+v2*v
+  //----------------------------------------------------------------------------------------------------------------------
+  Real m_u=0.0f;
+  Real m_v=0.0f;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the id of the triangle hit (see BVH::build)
+  //----------------------------------------------------------------------------------------------------------------------
+  uint32_t m_id=0;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class BVH "include/ngl/BVH.h"
+/// @brief a bounding volume hierarchy over a set of triangles. The tree is built with a binned surface area
+/// heuristic, sub trees are built in parallel, and stored as a flat depth first array of 32 byte nodes (the
+/// left child directly follows its parent) with the triangles copied into leaf order. Each triangle has an id,
+/// its index in the input or the face it came from when built from a mesh, which the queries return.
+/// For picking, un project the mouse position to get a ray and use intersect.
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT BVH
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a node of the tree, leaves have m_count triangles starting at m_offset, inner nodes have m_count 0,
+  /// the left child is the next node and the right child is at m_offset
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Node
+  {
+    Real m_min[3];
+    uint32_t m_offset;
+    Real m_max[3];
+    uint32_t m_count;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief default ctor an empty tree
+  //----------------------------------------------------------------------------------------------------------------------
+  BVH() noexcept{}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief build the tree from indexed triangles, the triangle ids are the index of each triangle (i/3)
+  /// @param[in] _verts the vertices
+  /// @param[in] _indices three vertex indices per triangle
+  /// @param[in] _numThreads the most threads to use, 0 will use all the cores available
+  /// @returns false if the indices are not whole triangles or are out of range
+  //----------------------------------------------------------------------------------------------------------------------
+  bool build(const std::vector<Vec3> &_verts, const std::vector<uint32_t> &_indices, unsigned int _numThreads=0) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief build the tree from the faces of a mesh, polygons are split into fans of triangles and the triangle
+  /// ids are the index of the face
+  /// @param[in] _mesh the mesh
+  /// @param[in] _numThreads the most threads to use, 0 will use all the cores available
+  /// @returns false if the mesh has no faces or bad indices
+  //----------------------------------------------------------------------------------------------------------------------
+  bool build(const AbstractMesh &_mesh, unsigned int _numThreads=0) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief remove all the triangles
+  //----------------------------------------------------------------------------------------------------------------------
+  void clear() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief find the closest triangle hit by a ray
+  /// @param[in] _origin the start of the ray
+  /// @param[in] _dir the direction of the ray (doesn't need to be normalized)
+  /// @param[out] o_hit the closest hit if there is one
+  /// @param[in] _tMax only hits closer than this are found
+  /// @returns true if a triangle was hit
+  //----------------------------------------------------------------------------------------------------------------------
+  bool intersect(const Vec3 &_origin, const Vec3 &_dir, BVHHit &o_hit,
+                 Real _tMax=std::numeric_limits<Real>::max()) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief check if a ray hits any triangle, faster than intersect as it stops at the first hit (for shadows etc)
+  /// @param[in] _origin the start of the ray
+  /// @param[in] _dir the direction of the ray
+  /// @param[in] _tMax only hits closer than this count
+  /// @returns true if a triangle was hit
+  //----------------------------------------------------------------------------------------------------------------------
+  bool intersectAny(const Vec3 &_origin, const Vec3 &_dir, Real _tMax=std::numeric_limits<Real>::max()) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief find the triangles touching an axis aligned box
+  /// @param[in] _min the minimum corner of the box
+  /// @param[in] _max the maximum corner of the box
+  /// @param[out] o_ids the ids of the triangles, sorted and each id once
+  //----------------------------------------------------------------------------------------------------------------------
+  void overlapBox(const Vec3 &_min, const Vec3 &_max, std::vector<uint32_t> &o_ids) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief find the triangles touching a sphere
+  /// @param[in] _center the center of the sphere
+  /// @param[in] _radius the radius of the sphere
+  /// @param[out] o_ids the ids of the triangles, sorted and each id once
+  //----------------------------------------------------------------------------------------------------------------------
+  void overlapSphere(const Vec3 &_center, Real _radius, std::vector<uint32_t> &o_ids) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief find the triangles which may be visible to a camera, those with a bounding box not outside the frustum
+  /// @param[in] _camera the camera (calculateFrustum must be up to date)
+  /// @param[out] o_ids the ids of the triangles, sorted and each id once
+  //----------------------------------------------------------------------------------------------------------------------
+  void inFrustum(const Camera &_camera, std::vector<uint32_t> &o_ids) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of triangles in the tree
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t numTriangles() const noexcept{return m_ids.size();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the nodes of the tree, the root is the first
+  //----------------------------------------------------------------------------------------------------------------------
+  const std::vector<Node> & getNodes() const noexcept{return m_nodes;}
+
+protected :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a triangle stored as a corner and two edges ready for intersection
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Triangle
+  {
+    Vec3 m_v0;
+    Vec3 m_e1;
+    Vec3 m_e2;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief build from triangle corners, three per triangle, with one id per triangle
+  //----------------------------------------------------------------------------------------------------------------------
+  void buildTriangles(const std::vector<Vec3> &_corners, const std::vector<uint32_t> &_ids, unsigned int _numThreads) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the flattened tree
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Node> m_nodes;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the triangles in leaf order
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Triangle> m_triangles;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the id of each triangle in leaf order
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<uint32_t> m_ids;
+};
+
+} // end namespace ngl
+
+#endif
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,280 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef BATCHRENDERER_H_
+#define BATCHRENDERER_H_
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Mat4.h"
+#include "VAOPrimitives.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BatchRenderer.h
+/// @brief draws many instances of primitives and meshes from one shared buffer with multi draw indirect
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+class AbstractMesh;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the command layout read by glMultiDrawArraysIndirect
+//----------------------------------------------------------------------------------------------------------------------
+struct DrawArraysIndirectCommand
+{
+  GLuint m_count;
+  GLuint m_instanceCount;
+  GLuint m_first;
+  GLuint m_baseInstance;
+};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the command layout read by glMultiDrawElementsIndirect
+//----------------------------------------------------------------------------------------------------------------------
+struct DrawElementsIndirectCommand
+{
+  GLuint m_count;
+  GLuint m_instanceCount;
+  GLuint m_firstIndex;
+  GLint m_baseVertex;
+  GLuint m_baseInstance;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class BatchRenderer "include/ngl/BatchRenderer.h"
+/// @brief VAOPrimitives and meshes are copied into one vertex / index arena, each frame the instances to draw are
+/// added as (program, primitive, transform), build sorts them by program then primitive (a counting sort) and makes
+/// one indirect command per primitive and one group of commands per program and draw mode, draw then issues a
+/// glMultiDrawArraysIndirect / glMultiDrawElementsIndirect per group rather than a bind, draw and matrix upload per
+/// instance. The transforms are sent in one buffer and read in the vertex shader as a per instance mat4 at
+/// instanceTransformAttribute (attributes 3 to 6), the vertices use attributes 0 (position), 1 (uv) and 2 (normal)
+/// as VAOPrimitives
+/// @code
+/// layout(location=0) in vec3 inVert;
+/// layout(location=2) in vec3 inNormal;
+/// layout(location=3) in mat4 inModel;
+/// uniform mat4 VP;
+/// void main(){ gl_Position=VP*inModel*vec4(inVert,1.0); }
+/// @endcode
+/// Everything up to draw runs on the CPU (the GL objects are made on the first draw) so the command building can be
+/// used and tested without a context. Without OpenGL 4.3 / ARB_multi_draw_indirect each command is drawn with
+/// glDrawArraysInstanced / glDrawElementsInstancedBaseVertex and the transform attributes pointed at its instances
+/// (OpenGL 4.1 on the mac has no base instance).
+/// @example
+/// ngl::BatchRenderer batch;
+/// int sphere=batch.addFromPrimitives("sphere");
+/// int troll=batch.addMesh("troll",mesh);
+/// GLuint phong=shader->getProgramID("Phong");
+/// // each frame
+/// batch.begin();
+/// for(auto &o : objects) batch.add(phong,o.isTroll ? troll : sphere,o.transform);
+/// shader->use("Phong"); shader->setUniform("VP",camera.getVPMatrix());
+/// batch.draw();
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT BatchRenderer
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief where a primitive is in the arena
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Primitive
+  {
+    std::string m_name;
+    GLenum m_mode;
+    bool m_indexed;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the first vertex (or index if indexed) and the number of them
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_first;
+    GLuint m_count;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief added to each index, the first vertex of an indexed primitive
+    //----------------------------------------------------------------------------------------------------------------------
+    GLint m_baseVertex;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a run of commands drawn with one multi draw call
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Group
+  {
+    GLuint m_program;
+    GLenum m_mode;
+    bool m_indexed;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the first command in arraysCommands or elementsCommands and the number of them
+    //----------------------------------------------------------------------------------------------------------------------
+    size_t m_firstCommand;
+    size_t m_numCommands;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief counts for the last draw since the last resetStats
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Stats
+  {
+    size_t m_instances=0;
+    size_t m_commands=0;
+    size_t m_drawCalls=0;
+    size_t m_bytesUploaded=0;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor, no GL objects are made until the first draw
+  //----------------------------------------------------------------------------------------------------------------------
+  BatchRenderer() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief dtor deletes the vertex array and buffers
+  //----------------------------------------------------------------------------------------------------------------------
+  ~BatchRenderer() noexcept;
+  BatchRenderer(const BatchRenderer &)=delete;
+  BatchRenderer & operator=(const BatchRenderer &)=delete;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a primitive to the arena
+  /// @param[in] _name the name to look the primitive up by
+  /// @param[in] _data the vertices in the u,v,nx,ny,nz,x,y,z layout of vertData
+  /// @param[in] _numVerts the number of vertices
+  /// @param[in] _mode the draw mode (GL_TRIANGLES etc)
+  /// @param[in] _indices optional indices into _data, drawn with DrawElements if given
+  /// @param[in] _numIndices the number of indices
+  /// @returns the id of the primitive to pass to add or -1 if the name is already used or there is no data
+  //----------------------------------------------------------------------------------------------------------------------
+  int addPrimitive(const std::string &_name, const Real *_data, size_t _numVerts, GLenum _mode,
+                   const GLuint *_indices=nullptr, size_t _numIndices=0) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a primitive to the arena from vertData
+  //----------------------------------------------------------------------------------------------------------------------
+  int addPrimitive(const std::string &_name, const std::vector<vertData> &_data, GLenum _mode) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief copy a primitive created by VAOPrimitives into the arena, the vertices are read back from its buffer so
+  /// a GL context is needed
+  /// @param[in] _name the name of the primitive in VAOPrimitives, also used here
+  //----------------------------------------------------------------------------------------------------------------------
+  int addFromPrimitives(const std::string &_name) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add the indexed triangles of a mesh (see AbstractMesh::buildIndexedData) to the arena
+  //----------------------------------------------------------------------------------------------------------------------
+  int addMesh(const std::string &_name, AbstractMesh &_mesh) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the id of a primitive by name
+  /// @returns the id or -1 if not known
+  //----------------------------------------------------------------------------------------------------------------------
+  int getPrimitiveID(const std::string &_name) const noexcept;
+  const Primitive & getPrimitive(int _id) const noexcept{return m_primitives[static_cast<size_t>(_id)];}
+  size_t numPrimitives() const noexcept{return m_primitives.size();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the arena, 8 floats per vertex and the indices of the indexed primitives
+  //----------------------------------------------------------------------------------------------------------------------
+  const std::vector<Real> & vertices() const noexcept{return m_vertices;}
+  const std::vector<GLuint> & indices() const noexcept{return m_indices;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief start a new frame, removes the instances added
+  //----------------------------------------------------------------------------------------------------------------------
+  void begin() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add an instance to draw this frame
+  /// @param[in] _program the program to draw it with (ShaderLib::getProgramID)
+  /// @param[in] _primitive the id returned when the primitive was added
+  /// @param[in] _transform the model matrix of the instance
+  //----------------------------------------------------------------------------------------------------------------------
+  void add(GLuint _program, int _primitive, const Mat4 &_transform) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add an instance by shader and primitive name, this looks both up so use the ids when adding many
+  /// @returns false if the primitive isn't known
+  //----------------------------------------------------------------------------------------------------------------------
+  bool add(const std::string &_shader, const std::string &_primitive, const Mat4 &_transform) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of instances added this frame
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t numInstances() const noexcept{return m_instancePrimitive.size();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief sort the instances and make the commands and groups, called by draw if needed (no GL is used)
+  //----------------------------------------------------------------------------------------------------------------------
+  void build() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief upload the arena (if changed), the transforms and the commands then draw each group with its program,
+  /// the program of the last group is left in use
+  //----------------------------------------------------------------------------------------------------------------------
+  void draw() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the output of build, the transforms in draw order and the commands for each group
+  //----------------------------------------------------------------------------------------------------------------------
+  const std::vector<Mat4> & transforms() const noexcept{return m_sorted;}
+  const std::vector<DrawArraysIndirectCommand> & arraysCommands() const noexcept{return m_arraysCommands;}
+  const std::vector<DrawElementsIndirectCommand> & elementsCommands() const noexcept{return m_elementsCommands;}
+  const std::vector<Group> & groups() const noexcept{return m_groups;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief use glMultiDraw*Indirect if the context has it (the default), else one instanced draw per command
+  //----------------------------------------------------------------------------------------------------------------------
+  void setMultiDraw(bool _enabled) noexcept{m_multiDraw=_enabled;}
+  bool multiDraw() const noexcept;
+  const Stats & stats() const noexcept{return m_stats;}
+  void resetStats() noexcept{m_stats=Stats();}
+
+protected :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief make the vertex array and buffers
+  //----------------------------------------------------------------------------------------------------------------------
+  void createGLObjects() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief point the transform attributes at the instances from _baseInstance
+  //----------------------------------------------------------------------------------------------------------------------
+  void setTransformPointers(GLuint _baseInstance) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the primitives and their ids by name
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Primitive> m_primitives;
+  std::unordered_map<std::string,int> m_names;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the arena, true if changed since it was uploaded
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Real> m_vertices;
+  std::vector<GLuint> m_indices;
+  bool m_arenaDirty=false;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the instances added this frame, the program is an index into m_programs
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<uint32_t> m_instanceProgram;
+  std::vector<uint32_t> m_instancePrimitive;
+  std::vector<Mat4> m_instanceTransform;
+  std::vector<GLuint> m_programs;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the last program added and its index, most instances use the same one as the last
+  //----------------------------------------------------------------------------------------------------------------------
+  GLuint m_lastProgram=0;
+  uint32_t m_lastProgramIndex=UINT32_MAX;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the output of build, m_built is false when instances have been added since
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Mat4> m_sorted;
+  std::vector<DrawArraysIndirectCommand> m_arraysCommands;
+  std::vector<DrawElementsIndirectCommand> m_elementsCommands;
+  std::vector<Group> m_groups;
+  std::vector<uint32_t> m_bucketStart;
+  bool m_built=true;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the GL objects
+  //----------------------------------------------------------------------------------------------------------------------
+  GLuint m_vao=0;
+  GLuint m_vertexBuffer=0;
+  GLuint m_indexBuffer=0;
+  GLuint m_transformBuffer=0;
+  GLuint m_commandBuffer=0;
+  bool m_multiDraw=true;
+  Stats m_stats;
+}; // end class BatchRenderer
+
+} // end namespace ngl
+
+#endif
@@ -0,0 +1,102 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef BATCHTRANSFORM_H_
+#define BATCHTRANSFORM_H_
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Vec3.h"
+#include "Vec4.h"
+#include "Mat3.h"
+#include "Mat4.h"
+#include <cstddef>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BatchTransform.h
+/// @brief functions to transform arrays of points, directions and normals by one matrix in a single call.
+/// Vectors are treated as rows as in Vec4 * Mat4 (so translations come from m_30,m_31,m_32) and no
+/// projective divide is done. Data is either an array of Vec3 / Vec4 (AoS) or separate x,y,z arrays (SoA),
+/// the inner loops use SSE / NEON when available. The output may be the same array as the input but
+/// must not otherwise overlap it.
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief transform points (w=1) by a matrix
+/// @param[in] _m the matrix to transform by
+/// @param[in] _in the points to transform
+/// @param[out] o_out the transformed points
+/// @param[in] _n the number of points
+//----------------------------------------------------------------------------------------------------------------------
+NGL_DLLEXPORT void transformPoints(const Mat4 &_m, const Vec3 *_in, Vec3 *o_out, size_t _n) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief transform directions (w=0) by a matrix, the translation is ignored
+/// @param[in] _m the matrix to transform by
+/// @param[in] _in the directions to transform
+/// @param[out] o_out the transformed directions
+/// @param[in] _n the number of directions
+//----------------------------------------------------------------------------------------------------------------------
+NGL_DLLEXPORT void transformDirections(const Mat4 &_m, const Vec3 *_in, Vec3 *o_out, size_t _n) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief transform homogeneous vectors by a matrix, the same as _in[i] * _m
+/// @param[in] _m the matrix to transform by
+/// @param[in] _in the vectors to transform
+/// @param[out] o_out the transformed vectors
+/// @param[in] _n the number of vectors
+//----------------------------------------------------------------------------------------------------------------------
+NGL_DLLEXPORT void transformVectors(const Mat4 &_m, const Vec4 *_in, Vec4 *o_out, size_t _n) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief transform normals by a normal matrix (usually the inverse transpose of the model matrix)
+/// @param[in] _m the normal matrix
+/// @param[in] _in the normals to transform
+/// @param[out] o_out the transformed normals
+/// @param[in] _n the number of normals
+/// @param[in] _normalise re-normalise the results (zero length normals are left as zero)
+//----------------------------------------------------------------------------------------------------------------------
+NGL_DLLEXPORT void transformNormals(const Mat3 &_m, const Vec3 *_in, Vec3 *o_out, size_t _n, bool _normalise=true) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief transform points (w=1) held as separate x,y,z arrays by a matrix
+/// @param[in] _m the matrix to transform by
+/// @param[in] _x,_y,_z the components of the points to transform
+/// @param[out] o_x,o_y,o_z the components of the transformed points
+/// @param[in] _n the number of points
+//----------------------------------------------------------------------------------------------------------------------
+NGL_DLLEXPORT void transformPoints(const Mat4 &_m, const Real *_x, const Real *_y, const Real *_z,
+                                   Real *o_x, Real *o_y, Real *o_z, size_t _n) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief transform directions (w=0) held as separate x,y,z arrays by a matrix
+/// @param[in] _m the matrix to transform by
+/// @param[in] _x,_y,_z the components of the directions to transform
+/// @param[out] o_x,o_y,o_z the components of the transformed directions
+/// @param[in] _n the number of directions
+//----------------------------------------------------------------------------------------------------------------------
+NGL_DLLEXPORT void transformDirections(const Mat4 &_m, const Real *_x, const Real *_y, const Real *_z,
+                                       Real *o_x, Real *o_y, Real *o_z, size_t _n) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief transform normals held as separate x,y,z arrays by a normal matrix
+/// @param[in] _m the normal matrix
+/// @param[in] _x,_y,_z the components of the normals to transform
+/// @param[out] o_x,o_y,o_z the components of the transformed normals
+/// @param[in] _n the number of normals
+/// @param[in] _normalise re-normalise the results (zero length normals are left as zero)
+//----------------------------------------------------------------------------------------------------------------------
+NGL_DLLEXPORT void transformNormals(const Mat3 &_m, const Real *_x, const Real *_y, const Real *_z,
+                                    Real *o_x, Real *o_y, Real *o_z, size_t _n, bool _normalise=true) noexcept;
+
+} // end namespace ngl
+
+#endif
+//----------------------------------------------------------------------------------------------------------------------
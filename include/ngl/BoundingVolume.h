@@ -0,0 +1,80 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef BOUNDINGVOLUME_H_
+#define BOUNDINGVOLUME_H_
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Vec3.h"
+#include "Vec3Array.h"
+#include <cstddef>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BoundingVolume.h
+/// @brief functions to compute the axis aligned box, centroid and a bounding sphere of a set of points.
+/// The points are read twice, once for the box and centroid and once for the sphere radius, using SSE / NEON
+/// when available and splitting the work across threads for large point counts.
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the bounding volumes of a set of points, all zero for an empty set
+//----------------------------------------------------------------------------------------------------------------------
+struct NGL_DLLEXPORT BoundingVolume
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the minimum corner of the axis aligned box
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3 m_min;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the maximum corner of the axis aligned box
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3 m_max;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the average of the points
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3 m_centroid;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the center of the bounding sphere
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3 m_sphereCenter;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the radius of the bounding sphere
+  //----------------------------------------------------------------------------------------------------------------------
+  Real m_sphereRadius=0.0f;
+};
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief calculate the bounding volumes of an array of points. The sphere is centered on either the middle
+/// of the box or the centroid, whichever gives the smaller radius, and contains every point.
+/// @param[in] _points the points
+/// @param[in] _n the number of points
+/// @param[in] _numThreads the most threads to use, 0 will use all the cores available, small point
+/// counts always use one thread
+/// @returns the bounding volumes
+//----------------------------------------------------------------------------------------------------------------------
+NGL_DLLEXPORT BoundingVolume calcBoundingVolume(const Vec3 *_points, size_t _n, unsigned int _numThreads=0) noexcept;
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief calculate the bounding volumes of the points in a Vec3Array
+/// @param[in] _points the points
+/// @param[in] _numThreads the most threads to use, 0 will use all the cores available
+/// @returns the bounding volumes
+//----------------------------------------------------------------------------------------------------------------------
+NGL_DLLEXPORT BoundingVolume calcBoundingVolume(const Vec3Array &_points, unsigned int _numThreads=0) noexcept;
+
+} // end namespace ngl
+
+#endif
+//----------------------------------------------------------------------------------------------------------------------
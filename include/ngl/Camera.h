@@ -27,6 +27,8 @@
 #include "RibExport.h"
 #include "Plane.h"
 #include "AABB.h"
+#include <cstdint>
+#include <vector>
 
 
 namespace ngl
@@ -284,6 +286,62 @@ public :
   /// @returns the result of the test (inside outside intercept)
   //----------------------------------------------------------------------------------------------------------------------
   CameraIntercept boxInFrustum(const AABB &b) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief check to see if the axis aligned box with the corners passed in is within the frustum, this is
+  /// the test used to cull the nodes of BVH and DynamicBVH
+  /// @param[in] _min the minimum corner (x,y,z)
+  /// @param[in] _max the maximum corner (x,y,z)
+  /// @returns the result of the test (inside outside intercept)
+  //----------------------------------------------------------------------------------------------------------------------
+  CameraIntercept boxInFrustum(const Real *_min, const Real *_max) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the six frustum planes (top, bottom, left, right, near, far) with normals pointing into the frustum
+  //----------------------------------------------------------------------------------------------------------------------
+  const Plane * getFrustumPlanes() const noexcept{return m_planes;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief test an array of spheres against the frustum, the same test as isSphereInFrustum but four
+  /// spheres at a time with SIMD. A sphere is visible unless the test would return OUTSIDE.
+  /// @param[in] _x,_y,_z the centers of the spheres
+  /// @param[in] _radius the radius of each sphere
+  /// @param[in] _n the number of spheres
+  /// @param[out] o_mask bit (i%32) of o_mask[i/32] is set if sphere i is visible, must hold (_n+31)/32 values
+  /// @param[in] _numThreads the most threads to use, 0 will use all the cores available
+  //----------------------------------------------------------------------------------------------------------------------
+  void spheresInFrustum(const Real *_x, const Real *_y, const Real *_z, const Real *_radius, size_t _n,
+                        uint32_t *o_mask, unsigned int _numThreads=1) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief test an array of spheres against the frustum and list the visible ones
+  /// @param[in] _x,_y,_z the centers of the spheres
+  /// @param[in] _radius the radius of each sphere
+  /// @param[in] _n the number of spheres
+  /// @param[out] o_visible the indices of the visible spheres in order
+  /// @param[in] _numThreads the most threads to use, 0 will use all the cores available
+  //----------------------------------------------------------------------------------------------------------------------
+  void spheresInFrustum(const Real *_x, const Real *_y, const Real *_z, const Real *_radius, size_t _n,
+                        std::vector<uint32_t> &o_visible, unsigned int _numThreads=1) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief test an array of axis aligned boxes against the frustum, the same test as boxInFrustum but four
+  /// boxes at a time with SIMD. A box is visible unless the test would return OUTSIDE.
+  /// @param[in] _minX,_minY,_minZ the minimum corner of each box
+  /// @param[in] _maxX,_maxY,_maxZ the maximum corner of each box
+  /// @param[in] _n the number of boxes
+  /// @param[out] o_mask bit (i%32) of o_mask[i/32] is set if box i is visible, must hold (_n+31)/32 values
+  /// @param[in] _numThreads the most threads to use, 0 will use all the cores available
+  //----------------------------------------------------------------------------------------------------------------------
+  void boxesInFrustum(const Real *_minX, const Real *_minY, const Real *_minZ,
+                      const Real *_maxX, const Real *_maxY, const Real *_maxZ, size_t _n,
+                      uint32_t *o_mask, unsigned int _numThreads=1) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief test an array of axis aligned boxes against the frustum and list the visible ones
+  /// @param[in] _minX,_minY,_minZ the minimum corner of each box
+  /// @param[in] _maxX,_maxY,_maxZ the maximum corner of each box
+  /// @param[in] _n the number of boxes
+  /// @param[out] o_visible the indices of the visible boxes in order
+  /// @param[in] _numThreads the most threads to use, 0 will use all the cores available
+  //----------------------------------------------------------------------------------------------------------------------
+  void boxesInFrustum(const Real *_minX, const Real *_minY, const Real *_minZ,
+                      const Real *_maxX, const Real *_maxY, const Real *_maxZ, size_t _n,
+                      std::vector<uint32_t> &o_visible, unsigned int _numThreads=1) const noexcept;
 
 protected :
 
@@ -0,0 +1,259 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef DYNAMICBVH_H_
+#define DYNAMICBVH_H_
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Vec3.h"
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file DynamicBVH.h
+/// @brief an incrementally updated tree of axis aligned boxes for culling and proximity queries on moving objects
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+class BBox;
+class Camera;
+class Mat4;
+//----------------------------------------------------------------------------------------------------------------------
+/// @class DynamicBVH "include/ngl/DynamicBVH.h"
+/// @brief a dynamic bounding volume hierarchy of object boxes keyed by an object id. Each leaf keeps a "fat" box,
+/// the object box grown by a margin (and in the direction it is moving), so most moves don't change the tree. When
+/// an object leaves its fat box the leaf is removed and re-inserted, choosing the sibling by the surface area
+/// heuristic, and the nodes above it are refitted and rotated to reduce their area. Only the path to the root is
+/// touched (and the walk stops once a node is unchanged) so insert, remove and move are O(log n).
+/// Queries test the exact object boxes, the fat boxes are only used to cull the tree.
+/// @example
+/// ngl::DynamicBVH tree;
+/// tree.insert(id,box,transform.getMatrix());
+/// // each frame
+/// tree.move(id,box,transform.getMatrix());
+/// tree.inFrustum(camera,visible);
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT DynamicBVH
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a node of the tree, leaves have m_child[0] set to -1
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Node
+  {
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the box around the node, the fat box for a leaf
+    //----------------------------------------------------------------------------------------------------------------------
+    Real m_min[3];
+    Real m_max[3];
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the parent node (-1 for the root) or the next free node when the node isn't used
+    //----------------------------------------------------------------------------------------------------------------------
+    int32_t m_parent;
+    int32_t m_child[2];
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief leaves are 0, -1 if the node isn't used
+    //----------------------------------------------------------------------------------------------------------------------
+    int32_t m_height;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the object id of a leaf
+    //----------------------------------------------------------------------------------------------------------------------
+    uint32_t m_id;
+    bool isLeaf() const noexcept{return m_child[0]==-1;}
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor
+  /// @param[in] _margin how much the leaf boxes are grown on each side, larger values mean fewer updates but
+  /// looser culling of the tree
+  //----------------------------------------------------------------------------------------------------------------------
+  DynamicBVH(Real _margin=0.1f) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add an object
+  /// @param[in] _id the id of the object, used by the other methods and returned by the queries
+  /// @param[in] _min the minimum corner of the object box
+  /// @param[in] _max the maximum corner of the object box
+  /// @returns false if the id is already in the tree
+  //----------------------------------------------------------------------------------------------------------------------
+  bool insert(uint32_t _id, const Vec3 &_min, const Vec3 &_max) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add an object from its local bounding box and transform (for example Transformation::getMatrix())
+  /// @param[in] _id the id of the object
+  /// @param[in] _box the bounding box of the object in its own space
+  /// @param[in] _transform the object to world matrix, the box stored is the world axis aligned box around it
+  /// @returns false if the id is already in the tree
+  //----------------------------------------------------------------------------------------------------------------------
+  bool insert(uint32_t _id, const BBox &_box, const Mat4 &_transform) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief remove an object
+  /// @param[in] _id the id of the object
+  /// @returns false if the id isn't in the tree
+  //----------------------------------------------------------------------------------------------------------------------
+  bool remove(uint32_t _id) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief update the box of an object, the tree only changes if the box has left the fat box of the leaf
+  /// @param[in] _id the id of the object
+  /// @param[in] _min the minimum corner of the new box
+  /// @param[in] _max the maximum corner of the new box
+  /// @param[in] _displacement how far the object is expected to move before the next update (e.g. velocity * dt),
+  /// the fat box is stretched in this direction to save updates
+  /// @returns true if the leaf was moved in the tree, false if it didn't need to be or the id isn't in the tree
+  //----------------------------------------------------------------------------------------------------------------------
+  bool move(uint32_t _id, const Vec3 &_min, const Vec3 &_max, const Vec3 &_displacement=Vec3(0.0f,0.0f,0.0f)) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief update the box of an object from its local bounding box and transform
+  /// @param[in] _id the id of the object
+  /// @param[in] _box the bounding box of the object in its own space
+  /// @param[in] _transform the object to world matrix
+  /// @returns true if the leaf was moved in the tree
+  //----------------------------------------------------------------------------------------------------------------------
+  bool move(uint32_t _id, const BBox &_box, const Mat4 &_transform) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief check if an object is in the tree
+  //----------------------------------------------------------------------------------------------------------------------
+  bool contains(uint32_t _id) const noexcept{return m_leaves.count(_id)!=0;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get the box of an object
+  /// @param[in] _id the id of the object
+  /// @param[out] o_min the minimum corner
+  /// @param[out] o_max the maximum corner
+  /// @returns false if the id isn't in the tree
+  //----------------------------------------------------------------------------------------------------------------------
+  bool getBox(uint32_t _id, Vec3 &o_min, Vec3 &o_max) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief remove all the objects
+  //----------------------------------------------------------------------------------------------------------------------
+  void clear() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of objects in the tree
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t size() const noexcept{return m_leaves.size();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the height of the tree, 0 for a single object, -1 when empty
+  //----------------------------------------------------------------------------------------------------------------------
+  int height() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief find the objects with boxes touching an axis aligned box
+  /// @param[in] _min the minimum corner of the box
+  /// @param[in] _max the maximum corner of the box
+  /// @param[out] o_ids the ids of the objects (in no particular order)
+  //----------------------------------------------------------------------------------------------------------------------
+  void overlapBox(const Vec3 &_min, const Vec3 &_max, std::vector<uint32_t> &o_ids) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief find the objects with boxes touching a sphere
+  /// @param[in] _center the center of the sphere
+  /// @param[in] _radius the radius of the sphere
+  /// @param[out] o_ids the ids of the objects (in no particular order)
+  //----------------------------------------------------------------------------------------------------------------------
+  void overlapSphere(const Vec3 &_center, Real _radius, std::vector<uint32_t> &o_ids) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief find the objects which may be visible to a camera, those with a box not outside the frustum
+  /// (the same test as Camera::boxInFrustum)
+  /// @param[in] _camera the camera (calculateFrustum must be up to date)
+  /// @param[out] o_ids the ids of the objects (in no particular order)
+  //----------------------------------------------------------------------------------------------------------------------
+  void inFrustum(const Camera &_camera, std::vector<uint32_t> &o_ids) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief find all the pairs of objects with touching boxes, the broad phase for collisions
+  /// @param[out] o_pairs each pair once with the smaller id first (in no particular order)
+  //----------------------------------------------------------------------------------------------------------------------
+  void overlappingPairs(std::vector<std::pair<uint32_t,uint32_t>> &o_pairs) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the nodes of the tree, unused nodes have a height of -1
+  //----------------------------------------------------------------------------------------------------------------------
+  const std::vector<Node> & getNodes() const noexcept{return m_nodes;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the root node, -1 when empty
+  //----------------------------------------------------------------------------------------------------------------------
+  int32_t getRoot() const noexcept{return m_root;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the world axis aligned box around a transformed local box, as used by the BBox versions of insert and move
+  /// @param[in] _min the minimum corner of the local box
+  /// @param[in] _max the maximum corner of the local box
+  /// @param[in] _transform the object to world matrix
+  /// @param[out] o_min the minimum corner of the world box
+  /// @param[out] o_max the maximum corner of the world box
+  //----------------------------------------------------------------------------------------------------------------------
+  static void transformBox(const Vec3 &_min, const Vec3 &_max, const Mat4 &_transform, Vec3 &o_min, Vec3 &o_max) noexcept;
+
+protected :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief an exact object box
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Box
+  {
+    Real m_min[3];
+    Real m_max[3];
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief take a node from the free list (growing the pool if needed)
+  //----------------------------------------------------------------------------------------------------------------------
+  int32_t allocateNode() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief return a node to the free list
+  //----------------------------------------------------------------------------------------------------------------------
+  void freeNode(int32_t _node) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief link a leaf into the tree next to the sibling with the lowest surface area cost
+  //----------------------------------------------------------------------------------------------------------------------
+  void insertLeaf(int32_t _leaf) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief unlink a leaf from the tree, the node itself is kept
+  //----------------------------------------------------------------------------------------------------------------------
+  void removeLeaf(int32_t _leaf) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief walk from a node to the root rebalancing and refitting the boxes and heights
+  //----------------------------------------------------------------------------------------------------------------------
+  void refit(int32_t _node) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief swap a child and grandchild (or two grandchildren) of a node if it reduces the surface area
+  //----------------------------------------------------------------------------------------------------------------------
+  void rotate(int32_t _node) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the fat box of a leaf from the exact box
+  //----------------------------------------------------------------------------------------------------------------------
+  void setFatBox(int32_t _leaf, const Vec3 &_displacement) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief all the nodes, used or in the free list
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Node> m_nodes;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the exact box of each leaf node (indexed by node)
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Box> m_boxes;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the leaf node of each object id
+  //----------------------------------------------------------------------------------------------------------------------
+  std::unordered_map<uint32_t,int32_t> m_leaves;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the root node, -1 when empty
+  //----------------------------------------------------------------------------------------------------------------------
+  int32_t m_root=-1;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the first unused node, -1 if there are none
+  //----------------------------------------------------------------------------------------------------------------------
+  int32_t m_freeList=-1;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief how much the leaf boxes are grown
+  //----------------------------------------------------------------------------------------------------------------------
+  Real m_margin;
+};
+
+} // end namespace ngl
+
+#endif
+//----------------------------------------------------------------------------------------------------------------------
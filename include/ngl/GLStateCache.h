@@ -0,0 +1,146 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef GLSTATECACHE_H_
+#define GLSTATECACHE_H_
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Singleton.h"
+#include <cstddef>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file GLStateCache.h
+/// @brief shadow of the OpenGL program and vertex array bindings used to skip redundant state changes
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class GLStateCache "include/ngl/GLStateCache.h"
+/// @brief Singleton remembering the program and vertex array bound through NGL so ShaderProgram, ShaderLib and the
+/// VAO classes only call glUseProgram / glBindVertexArray when the binding changes. ShaderProgram also keeps the last
+/// value written to each registered uniform (valid while its generation matches the one here) and skips writing the
+/// same value again. The shadow is only right when all binds and uniform writes go through NGL, after using OpenGL
+/// directly (or a library that does) call invalidate so the next calls are all issued, or turn the filtering off.
+/// The number of calls issued and skipped are counted in stats.
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT GLStateCache : public Singleton<GLStateCache>
+{
+  friend class Singleton<GLStateCache>;
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief counts of the GL calls made and skipped since the last resetStats
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Stats
+  {
+    size_t m_programBinds=0;
+    size_t m_programBindsSkipped=0;
+    size_t m_vaoBinds=0;
+    size_t m_vaoBindsSkipped=0;
+    size_t m_uniforms=0;
+    size_t m_uniformsSkipped=0;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief glUseProgram unless _id is already in use
+  /// @param[in] _id the program to use, 0 for none
+  //----------------------------------------------------------------------------------------------------------------------
+  void useProgram(GLuint _id) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief glBindVertexArray unless _id is already bound
+  /// @param[in] _id the vertex array to bind, 0 for none
+  //----------------------------------------------------------------------------------------------------------------------
+  void bindVertexArray(GLuint _id) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief bind vertex array 0, or when deferred unbinding is on leave the current one bound so drawing the same
+  /// VAO again (bind, draw, unbind in a loop) doesn't rebind it
+  //----------------------------------------------------------------------------------------------------------------------
+  void unbindVertexArray() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief must be called when a program is deleted as OpenGL may give the id to a new program
+  //----------------------------------------------------------------------------------------------------------------------
+  void programDeleted(GLuint _id) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief must be called when a vertex array is deleted, OpenGL binds 0 if it was bound
+  //----------------------------------------------------------------------------------------------------------------------
+  void vertexArrayDeleted(GLuint _id) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief true if _id is known to be the program in use
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isProgramInUse(GLuint _id) const noexcept{ return m_programKnown && m_program==_id; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief true if _id is known to be the bound vertex array
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isVertexArrayBound(GLuint _id) const noexcept{ return m_vaoKnown && m_vao==_id; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief forget all the shadowed state (bindings and uniform values), the next calls are all issued. Use after
+  /// OpenGL state has been changed outside NGL
+  //----------------------------------------------------------------------------------------------------------------------
+  void invalidate() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief forget the shadowed uniform values of every program
+  //----------------------------------------------------------------------------------------------------------------------
+  void invalidateUniforms() noexcept{ ++m_generation; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the uniform values stored by ShaderProgram are valid while they hold this generation
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int generation() const noexcept{ return m_generation; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief turn the filtering on (default) or off, when off every call is issued but still tracked
+  //----------------------------------------------------------------------------------------------------------------------
+  void setEnabled(bool _enabled) noexcept;
+  bool isEnabled() const noexcept{ return m_enabled; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief defer unbindVertexArray (off by default) so a VAO stays bound until another is bound. Only safe when no
+  /// code outside NGL changes vertex or element buffer state expecting vertex array 0 to be bound
+  //----------------------------------------------------------------------------------------------------------------------
+  void setDeferredUnbind(bool _defer) noexcept{ m_deferUnbind=_defer; }
+  bool isDeferredUnbind() const noexcept{ return m_deferUnbind; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief count a glUniform call issued or skipped (used by ShaderProgram)
+  //----------------------------------------------------------------------------------------------------------------------
+  void countUniform(bool _issued) noexcept{ _issued ? ++m_stats.m_uniforms : ++m_stats.m_uniformsSkipped; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the counts of calls issued and skipped
+  //----------------------------------------------------------------------------------------------------------------------
+  const Stats & stats() const noexcept{ return m_stats; }
+  void resetStats() noexcept{ m_stats=Stats(); }
+
+protected :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor private as a singleton, nothing is known to be bound at the start
+  //----------------------------------------------------------------------------------------------------------------------
+  GLStateCache() noexcept{}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the program in use when m_programKnown
+  //----------------------------------------------------------------------------------------------------------------------
+  GLuint m_program=0;
+  bool m_programKnown=false;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the bound vertex array when m_vaoKnown
+  //----------------------------------------------------------------------------------------------------------------------
+  GLuint m_vao=0;
+  bool m_vaoKnown=false;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief uniform values with a different generation are unknown, starts at 1 so new uniforms (0) are unknown
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int m_generation=1;
+  bool m_enabled=true;
+  bool m_deferUnbind=false;
+  Stats m_stats;
+}; // end class
+
+} // end namespace ngl
+
+#endif
+//----------------------------------------------------------------------------------------------------------------------
@@ -29,6 +29,7 @@
 
 namespace ngl
 {
+class UniformBlock;
 //----------------------------------------------------------------------------------------------------------------------
 ///  @enum LIGHTMODES used to flag if a light is local or remote to the scene
 ///
@@ -163,6 +164,12 @@ public:
   //----------------------------------------------------------------------------------------------------------------------
   void loadToShader(std::string _uniformName )const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the same values as loadToShader in a struct of a uniform block instead of the active shader
+  /// @param[out] o_block the block to set
+  /// @param[in] _uniformName the name of the struct in the block eg "lights[0]"
+  //----------------------------------------------------------------------------------------------------------------------
+  void loadToBlock(UniformBlock &o_block, const std::string &_uniformName )const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief set a transform so that the light position is multiplied by this value (default is identity matrix)
   /// @param[in] _t the transform matrix
   //----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,120 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file MappedFile.h
+/// @brief read only memory mapped file used by the mesh loaders
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include <string>
+#include <vector>
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class MappedFile "include/MappedFile.h"
+/// @brief a read only view of a whole file, on posix systems the file is memory mapped so pages are
+/// only read when touched, on windows it is read into a buffer.
+/// @author Jonathan Macey
+/// @version 1.0
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT MappedFile
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief how the file will be accessed, passed to the OS as a paging hint
+  //----------------------------------------------------------------------------------------------------------------------
+  enum class Access : char {Sequential,Random};
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief default ctor, no file is open
+  //----------------------------------------------------------------------------------------------------------------------
+  MappedFile() noexcept {;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor to open a file
+  /// @param[in] _fname the file to open
+  /// @param[in] _access the expected access pattern
+  //----------------------------------------------------------------------------------------------------------------------
+  explicit MappedFile(const std::string &_fname, Access _access=Access::Sequential) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief dtor unmaps the file
+  //----------------------------------------------------------------------------------------------------------------------
+  ~MappedFile() noexcept;
+  MappedFile(const MappedFile &)=delete;
+  MappedFile & operator=(const MappedFile &)=delete;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief open a file, any currently open file is closed first
+  /// @param[in] _fname the file to open
+  /// @param[in] _access the expected access pattern
+  /// @returns true if the file could be opened (an empty file is valid)
+  //----------------------------------------------------------------------------------------------------------------------
+  bool open(const std::string &_fname, Access _access=Access::Sequential) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief close the file and release the mapping
+  //----------------------------------------------------------------------------------------------------------------------
+  void close() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief tell the OS we have finished with part of the file so the pages can be dropped from our
+  /// resident set, the data is still valid and will be paged back in if touched again
+  /// @param[in] _offset the start of the range in bytes
+  /// @param[in] _size the size of the range in bytes
+  //----------------------------------------------------------------------------------------------------------------------
+  void release(size_t _offset, size_t _size) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief is the file open
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isValid() const noexcept { return m_valid; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief is the data memory mapped (false if it has been read into a buffer)
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isMapped() const noexcept { return m_mapped; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the start of the file data (nullptr for an empty file)
+  //----------------------------------------------------------------------------------------------------------------------
+  const char *data() const noexcept { return m_data; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the size of the file in bytes
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t size() const noexcept { return m_size; }
+
+private :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the start of the file data
+  //----------------------------------------------------------------------------------------------------------------------
+  const char *m_data=nullptr;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the file size
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_size=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief flag to indicate the file is open
+  //----------------------------------------------------------------------------------------------------------------------
+  bool m_valid=false;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief flag to indicate m_data is a mapping rather than m_buffer
+  //----------------------------------------------------------------------------------------------------------------------
+  bool m_mapped=false;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the file contents when we can't map
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<char> m_buffer;
+};
+
+} // end namespace ngl
+
+#endif
+//----------------------------------------------------------------------------------------------------------------------
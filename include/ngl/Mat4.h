@@ -46,6 +46,8 @@ class Quaternion;
 /// [ (2,0) 2 m_02 | (2,1) 6 m_12 | (2,2) 10 m_22 | (2,3) 14 m_32]
 /// [ (3,0) 3 m_03 | (3,1) 7 m_13 | (3,2) 11 m_23 | (3,3) 15 m_33]
 /// you will note that the m_ values are transposed so be wary
+/// Multiply, inverse, transpose and Mat4*Vec4 use SSE or NEON when the compiler targets them (define
+/// NGL_NO_SIMD to use the scalar versions), the layout above is the same either way.
 /// @author Jonathan Macey
 /// @version 3.0
 /// @date Last Revision 28/09/09 Updated to NCCA Coding standard
@@ -36,6 +36,7 @@
 
 namespace ngl
 {
+class UniformBlock;
 //----------------------------------------------------------------------------------------------------------------------
 /// @class Material "include/Material.h"
 /// @brief a simple OpenGL material class and set the parameters
@@ -180,6 +181,12 @@ public :
   /// @param[in] _uniformName
   //----------------------------------------------------------------------------------------------------------------------
   void loadToShader( std::string _uniformName )const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the same values as loadToShader in a struct of a uniform block instead of the active shader
+  /// @param[out] o_block the block to set
+  /// @param[in] _uniformName the name of the struct in the block
+  //----------------------------------------------------------------------------------------------------------------------
+  void loadToBlock( UniformBlock &o_block, const std::string &_uniformName )const noexcept;
 
 protected :
   //----------------------------------------------------------------------------------------------------------------------
@@ -45,6 +45,10 @@ class NGL_DLLEXPORT MultiBufferVAO : public AbstractVAO
     //----------------------------------------------------------------------------------------------------------------------
     virtual void draw() const;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw _instances copies of the VAO using glDrawArraysInstanced
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void drawInstanced(GLsizei _instances) const;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief dtor don't do anything as the remove clears things
     //----------------------------------------------------------------------------------------------------------------------
     virtual ~MultiBufferVAO();
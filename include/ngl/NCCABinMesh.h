@@ -27,6 +27,7 @@
 #include "RibExport.h"
 #include "Texture.h"
 #include "Vec4.h"
+#include "MappedFile.h"
 #include <string>
 #include <vector>
 
@@ -34,12 +35,27 @@ namespace ngl
 {
 //----------------------------------------------------------------------------------------------------------------------
 /// @class NCCABinMesh "include/NCCABinMesh.h"
-/// @brief basically this class Loads the contents of the current VBO to file,
-/// this is basically the AbstractMesh packed Vert, Texture cord and Normal data
-/// Which are stored in contiguous blocks from the Parent Save method.
-/// this will then create a VBO which can be mapped and drawn etc.
+/// @brief loads and saves meshes in the NCCA binary format. Version 2 files are written from the
+/// CPU side mesh data (no GL context is needed) and hold the indexed, de-duplicated vertex data ready
+/// to draw. All values are little endian and fixed width, the 128 byte header is
+/// @code
+///   0 char[8]  magic "ngl:bin2"
+///   8 uint32   version (2)
+///  12 uint32   flags (1 has normals, 2 has uv's)
+///  16 uint64   number of vertices
+///  24 uint64   number of indices
+///  32 uint32   bytes per index (2 or 4)
+///  36 uint32   source vert, normal, tex and face counts (4 values)
+///  52 float    center x,y,z then bbox min x,y,z and max x,y,z
+///  88 uint64   file offsets of the position, normal, uv and index sections (0 if not present)
+/// 120 uint64   total file size
+/// @endcode
+/// each section starts on a 64 byte boundary, positions and normals are 3 floats per vertex, uv's are 2.
+/// Version 2 files are memory mapped and createVAO uploads straight from the mapping so loading only
+/// reads the header. Version 1 ("ngl::bin") files, the packed VBO dump from older versions, are still
+/// loaded (64 bit long header fields) and can be converted with convert.
 /// @author Jonathan Macey
-/// @version 1.0
+/// @version 2.0
 /// @date 6/05/10 initial development
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -47,6 +63,31 @@ class NGL_DLLEXPORT NCCABinMesh : public  AbstractMesh
 {
 
 public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the data written to a version 2 file, each stream is tightly packed
+  //----------------------------------------------------------------------------------------------------------------------
+  struct BinaryData
+  {
+    /// @brief x,y,z for each vertex
+    const Real *m_positions=nullptr;
+    /// @brief nx,ny,nz for each vertex or nullptr
+    const Real *m_normals=nullptr;
+    /// @brief u,v for each vertex or nullptr
+    const Real *m_uvs=nullptr;
+    /// @brief triangle list indices of m_indexBytes each
+    const void *m_indices=nullptr;
+    uint64_t m_numVertices=0;
+    uint64_t m_numIndices=0;
+    uint32_t m_indexBytes=4;
+    /// @brief the counts from the source mesh
+    uint32_t m_nVerts=0;
+    uint32_t m_nNorm=0;
+    uint32_t m_nTex=0;
+    uint32_t m_nFaces=0;
+    Vec3 m_center;
+    Vec3 m_min;
+    Vec3 m_max;
+  };
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief default constructor
@@ -64,19 +105,79 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   NCCABinMesh( const std::string& _fname, const std::string& _texName) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief  Method to load the file in
+  /// @brief  Method to load the file in, version 2 files are mapped and only the header is read
   /// @param[in]  _fname the name of the obj file to load
+  /// @param[in] _calcBB create the BBox from the stored extents
   //----------------------------------------------------------------------------------------------------------------------
   bool load( const std::string& _fname, bool _calcBB=true) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief  method to save the obj
+  /// @brief  method to save the mesh as a version 2 file
+  /// @param[in] _fname the name of the file to save
+  //----------------------------------------------------------------------------------------------------------------------
+  bool save( const std::string& _fname) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief save the loaded data as a version 2 file
+  /// @param[in] _fname the name of the file to save
+  //----------------------------------------------------------------------------------------------------------------------
+  bool saveNCCABinaryMesh( const std::string &_fname ) noexcept override;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief create a SimpleIndexVAO from the loaded streams, for version 2 files the data is uploaded
+  /// directly from the mapped file
+  //----------------------------------------------------------------------------------------------------------------------
+  void createVAO() noexcept override;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief write a version 2 file
   /// @param[in] _fname the name of the file to save
+  /// @param[in] _data the mesh streams and header values to write
+  /// @returns true on success
+  //----------------------------------------------------------------------------------------------------------------------
+  static bool writeFile( const std::string &_fname, const BinaryData &_data ) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert a version 1 file to version 2
+  /// @param[in] _v1Name the file to read
+  /// @param[in] _v2Name the file to write
+  /// @returns true on success
+  //----------------------------------------------------------------------------------------------------------------------
+  static bool convert( const std::string &_v1Name, const std::string &_v2Name ) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the version of the file loaded (0 if nothing loaded)
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int getVersion() const noexcept{ return m_version; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the loaded streams, these point into the mapped file for version 2 files
   //----------------------------------------------------------------------------------------------------------------------
-  void save( const std::string& _fname) noexcept;
+  const BinaryData & getData() const noexcept{ return m_data; }
 
 protected :
-
-  // not data all in parent
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief parse a version 2 file in m_file
+  //----------------------------------------------------------------------------------------------------------------------
+  bool loadV2() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief parse a version 1 file in m_file, the packed vertices are de-duplicated into m_streams
+  //----------------------------------------------------------------------------------------------------------------------
+  bool loadV1() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the file being loaded / used for the streams
+  //----------------------------------------------------------------------------------------------------------------------
+  MappedFile m_file;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the current streams and header values
+  //----------------------------------------------------------------------------------------------------------------------
+  BinaryData m_data;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief storage for the vertex streams (positions then normals then uv's) when they can't be used
+  /// from the file directly (version 1 files or big endian hosts)
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Real> m_streams;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief storage for the index data when it can't be used from the file directly
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<char> m_indexStream;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the file version loaded
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int m_version=0;
 };
 
 }
@@ -84,4 +185,3 @@ protected :
 
 #endif
 //----------------------------------------------------------------------------------------------------------------------
-
@@ -26,6 +26,7 @@
 #include "Vec4.h"
 #include <vector>
 #include <string>
+#include <memory>
 
 namespace ngl
 {
@@ -50,8 +51,13 @@ namespace ngl
 </NCCAPointBake>
 @endverbatim
  **/
+/// Binary bakes are saved in a versioned (ngl:bpb2) format, a 64 byte little endian header followed by
+/// the frames (each 64 byte aligned) and a table of frame offsets / sizes so any frame can be found
+/// without reading the others. These can be loaded completely with loadBinaryPointBake or played back
+/// from disk with openBinaryPointBake. Older ngl::binpb files are still read. Frames are either raw
+/// floats (saveBinaryPointBake) or quantised and compressed (saveCompressedPointBake).
 /// @author Jonathan Macey
-/// @version 1.0
+/// @version 2.0
 /// @date Last Revision 2/09/10
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -78,10 +84,13 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   void setFrame(const unsigned int frame ) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief  method to load a point baked file
+  /// @brief  method to load a point baked file, the file is memory mapped and scanned in place a frame at
+  /// a time (the pages of each frame are released once read) so large exports don't need a DOM or a copy
+  /// of the text in memory. Frames are independent so can be read by several threads.
   /// @param[in] _fileName the file to load
+  /// @param[in] _numThreads the number of threads to use, 0 will use all the cores available
   //----------------------------------------------------------------------------------------------------------------------
-  bool loadPointBake( const std::string &_fileName) noexcept;
+  bool loadPointBake( const std::string &_fileName, unsigned int _numThreads=1) noexcept;
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief  method to load a binary point baked file
@@ -89,11 +98,41 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   bool loadBinaryPointBake(const std::string &_fileName) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief  open a binary point baked file for streaming playback, frames are decoded on demand from
+  /// the memory mapped file into a least recently used cache and the frames following each request are
+  /// decoded ahead on a background thread. Only the cached frames are held in memory so bakes larger
+  /// than RAM can be played back.
+  /// @param[in] _fileName the file to open
+  /// @param[in] _cacheFrames the number of decoded frames to keep (at least _prefetch+3 are kept, the
+  /// two last returned by getRawDataPointerAtFrame, the prefetched frames and one to decode into)
+  /// @param[in] _prefetch the number of frames after the requested one to decode in the background
+  //----------------------------------------------------------------------------------------------------------------------
+  bool openBinaryPointBake(const std::string &_fileName, unsigned int _cacheFrames=8, unsigned int _prefetch=2) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief  are the frames being streamed from disk (openBinaryPointBake) rather than all loaded
+  //----------------------------------------------------------------------------------------------------------------------
+  bool isStreaming() const noexcept{return m_stream !=nullptr;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief  has any streamed frame failed to decode, corrupt frames are returned zeroed when streaming
+  /// (loadBinaryPointBake fails instead)
+  //----------------------------------------------------------------------------------------------------------------------
+  bool hasCorruptFrames() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief  method to save a binary point baked file basically re-ordered data only
   /// @param[in] _fileName the file to load
   //----------------------------------------------------------------------------------------------------------------------
   bool saveBinaryPointBake( const std::string &_fileName) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief  save a binary point bake with the positions quantised to a grid so no coordinate moves by
+  /// more than _tolerance, frames are stored as differences from the previous frames and entropy coded.
+  /// Files are read by loadBinaryPointBake and openBinaryPointBake as normal, seeking to a frame decodes
+  /// forward from the keyframe before it.
+  /// @param[in] _fileName the file to save
+  /// @param[in] _tolerance the largest error allowed in any coordinate
+  /// @param[in] _keyInterval a keyframe (not depending on earlier frames) is stored every _keyInterval frames
+  //----------------------------------------------------------------------------------------------------------------------
+  bool saveCompressedPointBake(const std::string &_fileName, Real _tolerance=0.0001f, unsigned int _keyInterval=32) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief  method to attach a mesh to the data
   /// this method will check for basic vetex compatibility and then re-order the data
   /// to match the VBO structure of the mesh
@@ -102,7 +141,8 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   bool attachMesh(AbstractMesh *_mesh) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief  set the attached mesh to the current frame
+  /// @brief  set the attached mesh to the current frame, if the mesh VAO was made with
+  /// AbstractMesh::createAnimatedVAO only the position buffer is re-uploaded
   /// @param[in] _frame the frame to set the mesh to
   //----------------------------------------------------------------------------------------------------------------------
   void setMeshToFrame( const unsigned int _frame) noexcept;
@@ -117,12 +157,14 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   unsigned int getNumVerts() const  noexcept{return m_nVerts;}
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief  get a Raw data pointer to the un-sorted PointBake data
+  /// @brief  get a Raw data pointer to the un-sorted PointBake data, this is empty when streaming
   /// @returns a pointer to the data
   //----------------------------------------------------------------------------------------------------------------------
   std::vector < std::vector<Vec3> > & getRawDataPointer()   noexcept{return m_data;}
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief  get a Raw data pointer to the un-sorted PointBake for a particular frame
+  /// @brief  get a Raw data pointer to the un-sorted PointBake for a particular frame, when streaming
+  /// this is a cache entry, the two most recently returned frames are kept so the reference stays valid
+  /// through the next call but may be overwritten (by the prefetch thread) once a second call returns
   /// @param[in] _f the frame to access
   /// @returns a pointer to the data at frame _f
   //----------------------------------------------------------------------------------------------------------------------
@@ -172,6 +214,11 @@ protected :
   /// @brief flag to indicate if we have a binary or xml based file loaded
   //----------------------------------------------------------------------------------------------------------------------
   bool m_binFile;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the frame cache used for streaming playback (nullptr when all frames are in m_data)
+  //----------------------------------------------------------------------------------------------------------------------
+  class FrameStream;
+  std::unique_ptr<FrameStream> m_stream;
 }; // end class
 
 } // end namespace ngl
@@ -40,11 +40,11 @@ namespace ngl
 //----------------------------------------------------------------------------------------------------------------------
 /// @class Obj "include/Obj.h"
 /// @brief used to load in an alias wave front obj format file and draw using open gl
-///  has been completly re-written to use boost::spirit parser, most of this code is a
-/// modified version of the OBJReader class from the cortex-vfx lib framework here
+///  the file is read into a single buffer and parsed with a hand written scanner (negative / relative
+/// indices are supported), the original boost::spirit version was a modified version of the OBJReader class from the cortex-vfx lib framework here
 /// http://code.google.com/p/cortex-vfx/
 /// @author Jonathan Macey
-/// @version 4.0
+/// @version 5.0
 /// @date 22/10/09 updated to use boost::spirit parser framework
 /// @example AnimatedObj/AnimatedObj.cpp
 /// @example ObjViewer/ObjViewer.cpp
@@ -79,6 +79,15 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   bool load(const std::string& _fname, bool _calcBB=true ) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief  load the file using several threads, the file is memory mapped and split into new line
+  /// aligned chunks which are parsed in parallel then concatenated, the result is the same as load
+  /// (including relative indices) however the parse functions below are not called.
+  /// @param[in]  _fname the name of the obj file to load
+  /// @param[in] _calcBB if we only want to load data and not use GL then set this to false
+  /// @param[in] _numThreads the number of threads to use, 0 will use all the cores available
+  //----------------------------------------------------------------------------------------------------------------------
+  bool loadParallel(const std::string& _fname, bool _calcBB=true, unsigned int _numThreads=0 ) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief  method to save the obj
   /// @param[in] _fname the name of the file to save
   //----------------------------------------------------------------------------------------------------------------------
@@ -86,23 +95,23 @@ public :
 
 protected :
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief parser function to parse the vertex used by boost::spirit parser
-  /// @param[in] _begin the start of the string to parse
+  /// @brief parser function to parse a vertex line (v x y z)
+  /// @param[in] _begin the start of the line to parse (pointing at the keyword) the line ends at \n or \0
   //----------------------------------------------------------------------------------------------------------------------
   virtual void parseVertex( const char *_begin ) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief parser function to parse the Norma used by boost::spirit parser
-  /// @param[in] _begin the start of the string to parse
+  /// @brief parser function to parse a normal line (vn x y z)
+  /// @param[in] _begin the start of the line to parse (pointing at the keyword) the line ends at \n or \0
   //----------------------------------------------------------------------------------------------------------------------
   virtual void parseNormal( const char *_begin  ) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief parser function to parse the text cord used by boost::spirit parser
-  /// @param[in] _begin the start of the string to parse
+  /// @brief parser function to parse a texture cord line (vt u v [w])
+  /// @param[in] _begin the start of the line to parse (pointing at the keyword) the line ends at \n or \0
   //----------------------------------------------------------------------------------------------------------------------
   virtual void parseTextureCoordinate( const char * _begin ) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief parser function to parse the Face data used by boost::spirit parser
-  /// @param[in] _begin the start of the string to parse
+  /// @brief parser function to parse a face line (f v/t/n ...)
+  /// @param[in] _begin the start of the line to parse (pointing at the keyword) the line ends at \n or \0
   //----------------------------------------------------------------------------------------------------------------------
   virtual void parseFace( const char * _begin ) noexcept;
 
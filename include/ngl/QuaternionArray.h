@@ -0,0 +1,178 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef QUATERNIONARRAY_H_
+#define QUATERNIONARRAY_H_
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Quaternion.h"
+#include "AlignedAllocator.h"
+#include <vector>
+#include <cstddef>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file QuaternionArray.h
+/// @brief an array of Quaternion stored as separate component arrays for batch blending and rotation
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+class Vec3Array;
+//----------------------------------------------------------------------------------------------------------------------
+/// @class QuaternionArray "include/ngl/QuaternionArray.h"
+/// @brief an array of Quaternion stored structure of arrays style, each component (s, x, y, z) is held in its own
+/// 32 byte aligned array so operations on every element (for example blending the joints of two poses) work on
+/// four quaternions at once with SIMD instructions. The operations match the Quaternion ones element by element
+/// and the arrays used together must be the same size, outputs may be one of the inputs.
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT QuaternionArray
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the storage for one component
+  //----------------------------------------------------------------------------------------------------------------------
+  typedef std::vector<Real,AlignedAllocator<Real,32>> Lane;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief default ctor an empty array
+  //----------------------------------------------------------------------------------------------------------------------
+  QuaternionArray() noexcept{}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor with _size zero elements
+  /// @param[in] _size the number of elements
+  //----------------------------------------------------------------------------------------------------------------------
+  explicit QuaternionArray(size_t _size) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor copying an array of Quaternion
+  /// @param[in] _q the values to copy
+  //----------------------------------------------------------------------------------------------------------------------
+  QuaternionArray(const std::vector<Quaternion> &_q) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief replace the contents with an array of Quaternion
+  /// @param[in] _q the values to copy
+  //----------------------------------------------------------------------------------------------------------------------
+  void set(const std::vector<Quaternion> &_q) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief copy the contents to an array of Quaternion
+  /// @param[out] o_q resized and filled with the elements
+  //----------------------------------------------------------------------------------------------------------------------
+  void get(std::vector<Quaternion> &o_q) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the contents as an array of Quaternion
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Quaternion> toVector() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get element _i
+  //----------------------------------------------------------------------------------------------------------------------
+  Quaternion operator[](size_t _i) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set element _i
+  //----------------------------------------------------------------------------------------------------------------------
+  void set(size_t _i, const Quaternion &_q) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add an element to the end
+  //----------------------------------------------------------------------------------------------------------------------
+  void push_back(const Quaternion &_q) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of elements
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t size() const noexcept{return m_s.size();}
+  bool empty() const noexcept{return m_s.empty();}
+  void resize(size_t _size) noexcept;
+  void reserve(size_t _size) noexcept;
+  void clear() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the scalar components
+  //----------------------------------------------------------------------------------------------------------------------
+  Real * s() noexcept{return m_s.data();}
+  const Real * s() const noexcept{return m_s.data();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the x components
+  //----------------------------------------------------------------------------------------------------------------------
+  Real * x() noexcept{return m_x.data();}
+  const Real * x() const noexcept{return m_x.data();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the y components
+  //----------------------------------------------------------------------------------------------------------------------
+  Real * y() noexcept{return m_y.data();}
+  const Real * y() const noexcept{return m_y.data();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the z components
+  //----------------------------------------------------------------------------------------------------------------------
+  Real * z() noexcept{return m_z.data();}
+  const Real * z() const noexcept{return m_z.data();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set each element to _a*_b (as Quaternion::operator*)
+  //----------------------------------------------------------------------------------------------------------------------
+  void multiply(const QuaternionArray &_a, const QuaternionArray &_b) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief normalise each element, zero elements are left as zero
+  //----------------------------------------------------------------------------------------------------------------------
+  void normalise() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set each element to the normalised linear interpolation of _a and _b, taking the shorter path. Faster
+  /// than slerp but the speed of the rotation varies across the interpolation, fine for blending nearby poses
+  /// @param[in] _a the rotations at _t=0
+  /// @param[in] _b the rotations at _t=1
+  /// @param[in] _t the interpolation value
+  //----------------------------------------------------------------------------------------------------------------------
+  void nlerp(const QuaternionArray &_a, const QuaternionArray &_b, Real _t) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief nlerp with an interpolation value per element
+  /// @param[in] _t the interpolation value of each element
+  //----------------------------------------------------------------------------------------------------------------------
+  void nlerp(const QuaternionArray &_a, const QuaternionArray &_b, const std::vector<Real> &_t) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set each element to the spherical linear interpolation of unit quaternions _a and _b taking the shorter
+  /// path (as Quaternion::slerp). The sin / acos are replaced with D. Eberly's polynomial ("A Fast and Accurate
+  /// Algorithm for Computing SLERP" 2011) which for _t in [0,1] keeps each weight within 2e-5 of the exact
+  /// sin((1-t)a)/sin(a) and sin(ta)/sin(a) for every angle, the results are within 4e-5 of the exact slerp
+  /// @param[in] _a the rotations at _t=0
+  /// @param[in] _b the rotations at _t=1
+  /// @param[in] _t the interpolation value in [0,1]
+  //----------------------------------------------------------------------------------------------------------------------
+  void slerp(const QuaternionArray &_a, const QuaternionArray &_b, Real _t) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief slerp with an interpolation value per element
+  /// @param[in] _t the interpolation value of each element, each in [0,1]
+  //----------------------------------------------------------------------------------------------------------------------
+  void slerp(const QuaternionArray &_a, const QuaternionArray &_b, const std::vector<Real> &_t) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief rotate each point by the matching unit quaternion (as Quaternion::rotatePoint)
+  /// @param[in,out] io_points the points to rotate, the same size as this
+  //----------------------------------------------------------------------------------------------------------------------
+  void rotatePoints(Vec3Array &io_points) const noexcept;
+
+protected :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the scalar component of each element
+  //----------------------------------------------------------------------------------------------------------------------
+  Lane m_s;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the x component of each element
+  //----------------------------------------------------------------------------------------------------------------------
+  Lane m_x;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the y component of each element
+  //----------------------------------------------------------------------------------------------------------------------
+  Lane m_y;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the z component of each element
+  //----------------------------------------------------------------------------------------------------------------------
+  Lane m_z;
+}; // end class
+
+} // end namespace ngl
+
+#endif
+//----------------------------------------------------------------------------------------------------------------------
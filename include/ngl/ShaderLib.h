@@ -165,27 +165,27 @@ public :
   /// @param[in] _paramName the name of the parameter in the shader to set
   /// @param[in] _p1 the matrix to set from (float 16) value of the parameter to set
   //----------------------------------------------------------------------------------------------------------------------
-  void setShaderParamFromMat4(const std::string &_paramName, Mat4 _p1 )  noexcept;
+  void setShaderParamFromMat4(const std::string &_paramName, const Mat4 &_p1 )  noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief set a shader param by name for 1 int param note that the shader
   /// must be the currently active shader of else this will fail
   /// @param[in] _registeredUniformName the name of the registered uniform in the shader to set
   /// @param[in] _p1 the matrix to set from (float 16) value of the parameter to set
   //----------------------------------------------------------------------------------------------------------------------
-  void setRegisteredUniformFromMat4(const std::string &_registeredUniformName, Mat4 _p1  ) noexcept;
+  void setRegisteredUniformFromMat4(const std::string &_registeredUniformName, const Mat4 &_p1  ) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief set a shader param by name for 1 int param note that the shader
   /// must be the currently active shader of else this will fail
   /// @param[in] _paramName the name of the parameter in the shader to set
   /// @param[in] _p1 the matrix to set from (float 16) value of the parameter to set
   //----------------------------------------------------------------------------------------------------------------------
-  void setShaderParamFromMat3( const std::string &_paramName, Mat3 _p1 ) noexcept;
+  void setShaderParamFromMat3( const std::string &_paramName, const Mat3 &_p1 ) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief set the registered uniform from Max3x3
   /// @param[in] _uniformName the name of the uniform in the shader to set
   /// @param[in] _p1 the matrix to set from (float 16) value of the parameter to set
   //----------------------------------------------------------------------------------------------------------------------
-  void setRegisteredUniformFromMat3( const std::string &_paramName,  Mat3 _p1 ) noexcept;
+  void setRegisteredUniformFromMat3( const std::string &_paramName, const Mat3 &_p1 ) noexcept;
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief set a shader param by name for 1 int param note that the shader
@@ -339,6 +339,10 @@ public :
   /// will go to the fixed function pipeline
   //----------------------------------------------------------------------------------------------------------------------
   void useNullProgram() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the ShaderProgram set by the last use (or []), the null program if none
+  //----------------------------------------------------------------------------------------------------------------------
+  ShaderProgram * getCurrentProgram() const noexcept{ return m_currentProgram; }
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief grab the index of the unifrom block, this may not be supported on all GPU's
@@ -346,6 +350,12 @@ public :
   /// @returns the index of the block or -1 on error
   //----------------------------------------------------------------------------------------------------------------------
   GLuint getUniformBlockIndex(const std::string &_uniformBlockName  ) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the binding point a uniform block of the current program reads its buffer range from
+  /// @param _uniformBlockName the name of the block
+  /// @param _binding the binding point to pass to UniformBuffer::bindRange
+  //----------------------------------------------------------------------------------------------------------------------
+  void setUniformBlockBinding(const std::string &_uniformBlockName, GLuint _binding) const noexcept;
  //----------------------------------------------------------------------------------------------------------------------
   /// @brief register a uniform so we don't have to call glGet functions when using
   /// @param[in] _shaderName the name of the shader to set the param for
@@ -572,7 +582,7 @@ public :
   /// @param[in] _paramName the name of the Uniform to set
   /// @param[in] _v0 the Mat3 value of the parameter to set
   //----------------------------------------------------------------------------------------------------------------------
-  void setUniform(const std::string &_paramName,Mat3 _v0) noexcept;
+  void setUniform(const std::string &_paramName,const Mat3 &_v0) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief overloaded method to set shader Uniforms that have been pre-registered
   /// using auto-register uniforms method
@@ -580,14 +590,14 @@ public :
   /// @param[in] _paramName the name of the Uniform to set
   /// @param[in] _v0 the Mat3 value of the parameter to set
   //----------------------------------------------------------------------------------------------------------------------
-  void setRegisteredUniform(const std::string &_paramName,Mat3 _v0) noexcept;
+  void setRegisteredUniform(const std::string &_paramName,const Mat3 &_v0) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief overloaded method to set shader Uniforms the shader
   /// must be the currently active shader of else this will fail
   /// @param[in] _paramName the name of the Uniform to set
   /// @param[in] _v0 the Mat4 value of the parameter to set
   //----------------------------------------------------------------------------------------------------------------------
-  void setUniform(const std::string &_paramName,Mat4 _v0) noexcept;
+  void setUniform(const std::string &_paramName,const Mat4 &_v0) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief overloaded method to set shader Uniforms that have been pre-registered
   /// using auto-register uniforms method
@@ -595,7 +605,77 @@ public :
   /// @param[in] _paramName the name of the Uniform to set
   /// @param[in] _v0 the Mat4 value of the parameter to set
   //----------------------------------------------------------------------------------------------------------------------
-  void setRegisteredUniform(const std::string &_paramName,Mat4 _v0) noexcept;
+  void setRegisteredUniform(const std::string &_paramName,const Mat4 &_v0) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @name set uniforms by handle
+  /// @brief the setUniform overloads taking a UniformHandle look the location up in the current program by index so
+  /// no strings are hashed per call, get the handle once (for example at init) and keep it. The current program
+  /// must be set with use first, a handle not in the current program gives location -1 which OpenGL ignores
+  //----------------------------------------------------------------------------------------------------------------------
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief intern a uniform name (see ShaderProgram::getUniformHandle)
+  /// @param[in] _paramName the name of the Uniform
+  /// @returns the handle for the name, the same for all programs
+  //----------------------------------------------------------------------------------------------------------------------
+  UniformHandle getUniformHandle(const std::string &_paramName) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set a float uniform in the current program
+  /// @param[in] _handle the interned name of the Uniform to set
+  /// @param[in] _v0 the value to set
+  //----------------------------------------------------------------------------------------------------------------------
+  void setUniform(UniformHandle _handle,Real _v0) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set a vec2 uniform in the current program
+  //----------------------------------------------------------------------------------------------------------------------
+  void setUniform(UniformHandle _handle,Real _v0,Real _v1) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set a vec3 uniform in the current program
+  //----------------------------------------------------------------------------------------------------------------------
+  void setUniform(UniformHandle _handle,Real _v0,Real _v1,Real _v2) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set a vec4 uniform in the current program
+  //----------------------------------------------------------------------------------------------------------------------
+  void setUniform(UniformHandle _handle,Real _v0,Real _v1,Real _v2,Real _v3) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set an int (or sampler) uniform in the current program
+  //----------------------------------------------------------------------------------------------------------------------
+  void setUniform(UniformHandle _handle,GLint _v0) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set an ivec2 uniform in the current program
+  //----------------------------------------------------------------------------------------------------------------------
+  void setUniform(UniformHandle _handle,GLint _v0,GLint _v1) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set an ivec3 uniform in the current program
+  //----------------------------------------------------------------------------------------------------------------------
+  void setUniform(UniformHandle _handle,GLint _v0,GLint _v1,GLint _v2) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set an ivec4 uniform in the current program
+  //----------------------------------------------------------------------------------------------------------------------
+  void setUniform(UniformHandle _handle,GLint _v0,GLint _v1,GLint _v2,GLint _v3) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set a vec4 uniform from a Colour in the current program
+  //----------------------------------------------------------------------------------------------------------------------
+  void setUniform(UniformHandle _handle,const Colour &_v0) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set a vec2 uniform in the current program
+  //----------------------------------------------------------------------------------------------------------------------
+  void setUniform(UniformHandle _handle,const Vec2 &_v0) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set a vec3 uniform in the current program
+  //----------------------------------------------------------------------------------------------------------------------
+  void setUniform(UniformHandle _handle,const Vec3 &_v0) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set a vec4 uniform in the current program
+  //----------------------------------------------------------------------------------------------------------------------
+  void setUniform(UniformHandle _handle,const Vec4 &_v0) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set a mat3 uniform in the current program
+  //----------------------------------------------------------------------------------------------------------------------
+  void setUniform(UniformHandle _handle,const Mat3 &_v0) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set a mat4 uniform in the current program
+  //----------------------------------------------------------------------------------------------------------------------
+  void setUniform(UniformHandle _handle,const Mat4 &_v0) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
     /// @brief method to return a shader ID
     /// @param _shaderName the name of the shader who's ID to return
@@ -651,6 +731,10 @@ protected:
   //----------------------------------------------------------------------------------------------------------------------
   std::string m_currentShader;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the currently active program (m_currentShader) so the setters don't have to look it up by name
+  //----------------------------------------------------------------------------------------------------------------------
+  ShaderProgram *m_currentProgram;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief  flag to indicate the debug state
   //----------------------------------------------------------------------------------------------------------------------
   bool m_debugState;
@@ -20,6 +20,7 @@
 #include "Shader.h"
 #include "Types.h"
 #include "Util.h"
+#include <array>
 #include <vector>
 #include <unordered_map>
 
@@ -33,6 +34,11 @@
 //----------------------------------------------------------------------------------------------------------------------
 namespace ngl
 {
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief an interned uniform name, get one with ShaderProgram::getUniformHandle (or ShaderLib::getUniformHandle)
+/// once and use it to find the uniform location in any program by index rather than string lookups
+//----------------------------------------------------------------------------------------------------------------------
+typedef GLuint UniformHandle;
 
 class NGL_DLLEXPORT ShaderProgram
 {
@@ -94,6 +100,33 @@ public :
   /// @return the uniform variable id
   //----------------------------------------------------------------------------------------------------------------------
   GLint getUniformLocation( const char* _name) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief intern a uniform name, the same name always gives the same handle and the handle is valid for every
+  /// program. Handles are shared by all programs so only call this from the thread owning the GL context
+  /// @param _name the name of the uniform
+  /// @return the handle for the name
+  //----------------------------------------------------------------------------------------------------------------------
+  static UniformHandle getUniformHandle( const std::string &_name) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the name a handle was interned from
+  //----------------------------------------------------------------------------------------------------------------------
+  static const std::string & getUniformHandleName( UniformHandle _handle) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the location of the uniform interned as _handle in this program, the name is looked up the first time
+  /// the handle is used with this program and then cached in an array indexed by the handle.
+  /// @return the uniform location or -1 if the program has no active uniform with that name
+  //----------------------------------------------------------------------------------------------------------------------
+  GLint getUniformLocation( UniformHandle _handle) const noexcept{ return location(getUniform(_handle)); }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief check if a uniform write would change the value, the value is compared with the last one written through
+  /// this program (see GLStateCache) and stored if different
+  /// @param _handle the uniform to write
+  /// @param _value the raw value to be written
+  /// @param _bytes the size of the value
+  /// @param o_location the location of the uniform to write to (-1 when not in the program)
+  /// @returns false if the uniform already holds the value and the glUniform call can be skipped
+  //----------------------------------------------------------------------------------------------------------------------
+  bool uniformNeedsUpload( UniformHandle _handle, const void *_value, size_t _bytes, GLint &o_location) const noexcept;
 
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief   lists the available uniforms for the shader (this was a pain because the compiler quietly gets rid of unused uniforms).
@@ -474,6 +507,12 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
 
   GLuint getUniformBlockIndex( const std::string &_uniformBlockName  )const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the binding point a uniform block reads its buffer range from (see UniformBuffer::bindRange)
+  /// @param[in] _uniformBlockName the name of the uniform block
+  /// @param[in] _binding the binding point
+  //----------------------------------------------------------------------------------------------------------------------
+  void setUniformBlockBinding( const std::string &_uniformBlockName, GLuint _binding )const noexcept;
 
 private :
   //----------------------------------------------------------------------------------------------------------------------
@@ -510,6 +549,10 @@ private :
     GLint loc;
     std::string name;
     GLenum type;
+    // the last value written, only known while generation matches GLStateCache::generation
+    mutable std::array<GLint,16> value;
+    mutable size_t size=0;
+    mutable unsigned int generation=0;
   };
 
   //----------------------------------------------------------------------------------------------------------------------
@@ -518,6 +561,49 @@ private :
   //----------------------------------------------------------------------------------------------------------------------
   std::unordered_map <std::string, uniformData> m_registeredUniforms;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the registered uniform for each UniformHandle used with this program (nullptr if not in the program),
+  /// indexed by handle and filled on first use from m_registeredUniforms, cleared when the uniforms are registered again
+  //----------------------------------------------------------------------------------------------------------------------
+  mutable std::vector<const uniformData *> m_handleUniforms;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief marks a handle not yet looked up in m_handleUniforms
+  //----------------------------------------------------------------------------------------------------------------------
+  static const uniformData s_unresolvedUniform;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the registered uniform for a handle
+  //----------------------------------------------------------------------------------------------------------------------
+  const uniformData * getUniform( UniformHandle _handle) const noexcept
+  {
+    if(_handle<m_handleUniforms.size() && m_handleUniforms[_handle]!=&s_unresolvedUniform)
+    {
+      return m_handleUniforms[_handle];
+    }
+    return resolveUniformHandle(_handle);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief look up the uniform of a handle by name and cache it
+  //----------------------------------------------------------------------------------------------------------------------
+  const uniformData * resolveUniformHandle( UniformHandle _handle) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the registered uniform called _name, reports an error and returns nullptr if there isn't one
+  //----------------------------------------------------------------------------------------------------------------------
+  const uniformData * getUniform( const char *_name) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the location of a uniform from getUniform
+  //----------------------------------------------------------------------------------------------------------------------
+  static GLint location( const uniformData *_uniform) noexcept{ return _uniform!=nullptr ? _uniform->loc : -1; }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief compare a value to be written with the one stored for the uniform (see GLStateCache) storing it if
+  /// different. Writes of more than one array element (or transposed matrices) aren't stored and make all
+  /// stored values unknown as they change the following elements too.
+  /// @param _uniform the uniform to be written, nullptr if not in the program
+  /// @param _value the raw value to be written
+  /// @param _bytes the size of the value
+  /// @param _single true when writing one (non transposed) element
+  /// @returns true if the glUniform call must be made
+  //----------------------------------------------------------------------------------------------------------------------
+  bool needsUpload( const uniformData *_uniform, const void *_value, size_t _bytes, bool _single=true) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief indicate if this program is the current active program
   //----------------------------------------------------------------------------------------------------------------------
   bool m_active;
@@ -58,6 +58,10 @@ class NGL_DLLEXPORT SimpleIndexVAO : public AbstractVAO
     //----------------------------------------------------------------------------------------------------------------------
     virtual void draw() const;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw _instances copies of the VAO using glDrawElementsInstanced
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void drawInstanced(GLsizei _instances) const;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief dtor don't do anything as the remove clears things
     //----------------------------------------------------------------------------------------------------------------------
     virtual ~SimpleIndexVAO();
@@ -101,6 +105,10 @@ class NGL_DLLEXPORT SimpleIndexVAO : public AbstractVAO
     //----------------------------------------------------------------------------------------------------------------------
     GLuint m_buffer=0;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief the id of the element (index) buffer for the VAO
+    //----------------------------------------------------------------------------------------------------------------------
+    GLuint m_indexBuffer=0;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief data type of the index data (e.g. GL_UNSIGNED_INT)
     //----------------------------------------------------------------------------------------------------------------------
     GLenum m_indexType;
@@ -45,6 +45,10 @@ class NGL_DLLEXPORT SimpleVAO : public AbstractVAO
     //----------------------------------------------------------------------------------------------------------------------
     virtual void draw() const;
     //----------------------------------------------------------------------------------------------------------------------
+    /// @brief draw _instances copies of the VAO using glDrawArraysInstanced
+    //----------------------------------------------------------------------------------------------------------------------
+    virtual void drawInstanced(GLsizei _instances) const;
+    //----------------------------------------------------------------------------------------------------------------------
     /// @brief dtor clears the VAO data
     //----------------------------------------------------------------------------------------------------------------------
     virtual ~SimpleVAO();
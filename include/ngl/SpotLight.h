@@ -131,6 +131,12 @@ public:
 
   void loadToShader(std::string _uniformName  )const noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the same values as loadToShader in a struct of a uniform block instead of the active shader
+  /// @param[out] o_block the block to set
+  /// @param[in] _uniformName the name of the struct in the block eg "spots[0]"
+  //----------------------------------------------------------------------------------------------------------------------
+  void loadToBlock(UniformBlock &o_block, const std::string &_uniformName  )const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief set the transform of the light this will be multiplied by the position
   /// Vec4 pos=m_transform*m_position;
   /// @param[in] _t the transform
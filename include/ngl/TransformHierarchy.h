@@ -0,0 +1,207 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TRANSFORMHIERARCHY_H_
+#define TRANSFORMHIERARCHY_H_
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Mat4.h"
+#include "Transformation.h"
+#include <cstdint>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file TransformHierarchy.h
+/// @brief a parent / child hierarchy of Transformations with cached world matrices
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class TransformHierarchy "include/ngl/TransformHierarchy.h"
+/// @brief a scene graph of Transformations, each node has a local transform and an optional parent and the
+/// hierarchy keeps the world matrix of every node (local * parent world). Nodes are referred to by a handle
+/// which stays the same for the life of the node.
+/// Internally the nodes are stored in flat arrays sorted by depth, so a parent is always before its children
+/// and update is one linear pass: a node is recomputed only if its local transform or an ancestor changed
+/// since the last update, and each depth can be split across threads.
+/// Changing the structure (setParent, removeNode or adding a node above the current deepest level) re-sorts
+/// the arrays at the next update, which is O(n), so is meant for occasional use.
+/// @example
+/// ngl::TransformHierarchy scene;
+/// uint32_t body=scene.addNode(bodyTx);
+/// uint32_t arm=scene.addNode(armTx,body);
+/// scene.setRotation(arm,ngl::Vec3(0.0f,0.0f,45.0f));
+/// scene.update();
+/// shader->setUniform("M",scene.getWorldMatrix(arm));
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT TransformHierarchy
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the parent of a root node, also returned by addNode on failure
+  //----------------------------------------------------------------------------------------------------------------------
+  static constexpr uint32_t s_none=0xffffffff;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief default ctor an empty hierarchy
+  //----------------------------------------------------------------------------------------------------------------------
+  TransformHierarchy() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a node
+  /// @param[in] _local the local transform of the node
+  /// @param[in] _parent the parent node or s_none for a root
+  /// @returns the handle of the node or s_none if the parent isn't valid
+  //----------------------------------------------------------------------------------------------------------------------
+  uint32_t addNode(const Transformation &_local=Transformation(), uint32_t _parent=s_none) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief remove a node and all of its descendants
+  /// @param[in] _node the node to remove
+  /// @returns false if the node isn't valid
+  //----------------------------------------------------------------------------------------------------------------------
+  bool removeNode(uint32_t _node) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief move a node (and its descendants) to a new parent, the local transform is kept
+  /// @param[in] _node the node to move
+  /// @param[in] _parent the new parent or s_none to make it a root
+  /// @returns false if either node isn't valid or the parent is the node or one of its descendants
+  //----------------------------------------------------------------------------------------------------------------------
+  bool setParent(uint32_t _node, uint32_t _parent) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the parent of a node
+  /// @returns the parent or s_none for a root or an invalid node
+  //----------------------------------------------------------------------------------------------------------------------
+  uint32_t getParent(uint32_t _node) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief check a handle refers to a node in the hierarchy
+  //----------------------------------------------------------------------------------------------------------------------
+  bool contains(uint32_t _node) const noexcept{return _node<m_slot.size() && m_slot[_node]!=-1;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the local transform of a node, it and its descendants are recomputed at the next update
+  /// @returns false if the node isn't valid
+  //----------------------------------------------------------------------------------------------------------------------
+  bool setLocal(uint32_t _node, const Transformation &_local) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the position of the local transform of a node
+  /// @returns false if the node isn't valid
+  //----------------------------------------------------------------------------------------------------------------------
+  bool setPosition(uint32_t _node, const Vec3 &_position) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the rotation (in degrees about x, y then z) of the local transform of a node
+  /// @returns false if the node isn't valid
+  //----------------------------------------------------------------------------------------------------------------------
+  bool setRotation(uint32_t _node, const Vec3 &_rotation) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the scale of the local transform of a node
+  /// @returns false if the node isn't valid
+  //----------------------------------------------------------------------------------------------------------------------
+  bool setScale(uint32_t _node, const Vec3 &_scale) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the local transform of a node, use setLocal etc to change it
+  /// @param[in] _node a valid node
+  //----------------------------------------------------------------------------------------------------------------------
+  const Transformation & getLocal(uint32_t _node) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the world matrix of a node as of the last update
+  /// @param[in] _node a valid node
+  //----------------------------------------------------------------------------------------------------------------------
+  const Mat4 & getWorldMatrix(uint32_t _node) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief recompute the world matrices of the nodes which have changed and their descendants
+  /// @param[in] _numThreads the most threads to use, 0 will use all the cores available. Only depths with
+  /// thousands of nodes are split so small hierarchies are always updated on the calling thread
+  //----------------------------------------------------------------------------------------------------------------------
+  void update(unsigned int _numThreads=1) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of world matrices recomputed by the last update
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t numUpdated() const noexcept{return m_numUpdated;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of nodes
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t size() const noexcept{return m_handle.size();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of depths, 1 if there are only roots
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t numLevels() const noexcept{return m_levels.size()-1;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief remove all the nodes
+  //----------------------------------------------------------------------------------------------------------------------
+  void clear() noexcept;
+
+protected :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief mark a node changed
+  /// @returns the slot of the node or -1 if it isn't valid
+  //----------------------------------------------------------------------------------------------------------------------
+  int32_t touch(uint32_t _node) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief re-order the slots by depth after the structure has changed
+  //----------------------------------------------------------------------------------------------------------------------
+  void sortByDepth() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief update the slots [_begin,_end) which all have the same depth
+  /// @returns the number of world matrices recomputed
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t updateSlots(size_t _begin, size_t _end) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the local transform of each slot
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Transformation> m_local;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the world matrix of each slot
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Mat4> m_world;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the slot of the parent of each slot, -1 for roots
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<int32_t> m_parentSlot;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set for slots changed since the last update, during update also set for their descendants
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<uint8_t> m_changed;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the handle of the node in each slot
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<uint32_t> m_handle;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the first slot of each depth, with the number of slots at the end
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<size_t> m_levels;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the slot of each handle, -1 for handles not in use
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<int32_t> m_slot;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the parent handle of each handle
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<uint32_t> m_parent;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief handles of removed nodes to reuse
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<uint32_t> m_freeHandles;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set when the slots need sorting by depth again
+  //----------------------------------------------------------------------------------------------------------------------
+  bool m_orderChanged=false;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of world matrices recomputed by the last update
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_numUpdated=0;
+};
+
+} // end namespace ngl
+
+#endif
+//----------------------------------------------------------------------------------------------------------------------
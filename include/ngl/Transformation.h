@@ -23,7 +23,7 @@
 // Library includes
 #include "Mat4.h"
 #include "NGLassert.h"
-#include "Transformation.h"
+#include "Quaternion.h"
 #include "Vec4.h"
 
 namespace ngl
@@ -35,7 +35,8 @@ enum  class ActiveMatrix : char{NORMAL,TRANSPOSE,INVERSE};
 //----------------------------------------------------------------------------------------------------------------------
 /// @class Transformation "include/ngl/Transformation.h"
 /// @brief Transformation describes a transformation (translate, scale, rotation)
-/// modifed by j macey and included into NGL
+/// modifed by j macey and included into NGL. The matrix is built directly from the scale, rotation and position
+/// when it is first asked for after a change, the transpose and inverse are only computed when they are asked for.
 /// @author Vincent Bonnet
 /// @version 1.5
 /// @date 14/03/10 Last Revision 14/03/10
@@ -141,6 +142,12 @@ public:
   //----------------------------------------------------------------------------------------------------------------------
   void setRotation( Real _x, Real _y, Real _z ) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief method to set the rotation from a Quaternion, used instead of the euler angles until they are set again
+  /// @note getRotation still returns the last euler angles set, addRotation adds to them and uses them again
+  /// @param[in] _rotation the rotation (should be normalized)
+  //----------------------------------------------------------------------------------------------------------------------
+  void setRotation( const Quaternion& _rotation ) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief method to add to the existing  rotation
   /// @param[in] _rotation rotation
   /// @note each value is an axis rotation as the values are calculated
@@ -184,12 +191,12 @@ public:
   /// @brief function to get the transpose matrix. It computes the transpose matrix if it's dirty
   /// @returns the transpose matrix
   //----------------------------------------------------------------------------------------------------------------------
-  Mat4 getTransposeMatrix() noexcept{  computeMatrices(); return m_transposeMatrix; }
+  Mat4 getTransposeMatrix() noexcept{  computeTranspose(); return m_transposeMatrix; }
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief function to get the inverse matrix. It computes the inverse matrix if it's dirty
   /// @returns the inverse matrix
   //----------------------------------------------------------------------------------------------------------------------
-  Mat4 getInverseMatrix() noexcept {  computeMatrices(); return m_inverseMatrix; }
+  Mat4 getInverseMatrix() noexcept {  computeInverse(); return m_inverseMatrix; }
   //----------------------------------------------------------------------------------------------------------------------
   /// @brief *= operator
   /// @param _m the transformation to combine
@@ -232,10 +239,27 @@ protected :
   //----------------------------------------------------------------------------------------------------------------------
   Vec3 m_rotation;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief  rotation as a Quaternion used instead of m_rotation when m_useQuaternion is set
+  //----------------------------------------------------------------------------------------------------------------------
+  Quaternion m_quaternion;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief  true when the rotation was last set with a Quaternion
+  //----------------------------------------------------------------------------------------------------------------------
+  bool m_useQuaternion;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief  boolean defines if the matrix is dirty or not
   //----------------------------------------------------------------------------------------------------------------------
   bool m_isMatrixComputed;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief  booleans defining if the transpose and inverse are up to date with m_matrix
+  //----------------------------------------------------------------------------------------------------------------------
+  bool m_isTransposeComputed;
+  bool m_isInverseComputed;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief  true when m_matrix was set directly with setMatrix so the inverse can't be built from the values
+  //----------------------------------------------------------------------------------------------------------------------
+  bool m_isMatrixSet;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief  matrix transformation
   //----------------------------------------------------------------------------------------------------------------------
   Mat4 m_matrix;
@@ -248,9 +272,18 @@ protected :
   //----------------------------------------------------------------------------------------------------------------------
   Mat4 m_inverseMatrix;
   //----------------------------------------------------------------------------------------------------------------------
-  /// @brief method to compute the matrix, transpose and inverse matrix. set the m_bIsMatrixComputed variable to true.
+  /// @brief method to compute the matrix if it is dirty. set the m_isMatrixComputed variable to true.
   //----------------------------------------------------------------------------------------------------------------------
   void computeMatrices() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief method to compute the transpose matrix if it is dirty
+  //----------------------------------------------------------------------------------------------------------------------
+  void computeTranspose() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief method to compute the inverse matrix if it is dirty, from the scale, rotation and position unless the
+  /// matrix was set directly
+  //----------------------------------------------------------------------------------------------------------------------
+  void computeInverse() noexcept;
 
 };
 
@@ -0,0 +1,219 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef UNIFORMBLOCK_H_
+#define UNIFORMBLOCK_H_
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Colour.h"
+#include "Vec2.h"
+#include "Vec3.h"
+#include "Vec4.h"
+#include "Mat3.h"
+#include "Mat4.h"
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file UniformBlock.h
+/// @brief the std140 layout of a uniform block and a block of data packed to it on the CPU
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class UniformBlockLayout "include/ngl/UniformBlock.h"
+/// @brief the offset and strides of each member of a uniform block. The layout can be built on the CPU with the
+/// std140 rules by adding the members in the order they are declared in the shader, or read from a linked program
+/// (which works for any layout the driver uses). Members of arrays of structs are named as OpenGL reports them,
+/// eg "lights[1].diffuse", arrays of basic types are held once and indexed with "name[i]" when set.
+/// @example
+/// ngl::UniformBlockLayout light;
+/// light.addMember("position",GL_FLOAT_VEC4);
+/// light.addMember("diffuse",GL_FLOAT_VEC4);
+/// ngl::UniformBlockLayout frame;
+/// frame.addMember("VP",GL_FLOAT_MAT4);
+/// frame.addStruct("lights",light,4);
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT UniformBlockLayout
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief one member of the block, all sizes are in bytes
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Member
+  {
+    std::string m_name;
+    GLenum m_type;
+    GLint m_arraySize;
+    size_t m_offset;
+    size_t m_arrayStride;
+    size_t m_matrixStride;
+    bool m_rowMajor;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief default ctor an empty layout
+  //----------------------------------------------------------------------------------------------------------------------
+  UniformBlockLayout() noexcept{}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a member after the last one using the std140 rules
+  /// @param[in] _name the name of the member
+  /// @param[in] _type the GL type (GL_FLOAT, GL_FLOAT_VEC3, GL_INT, GL_FLOAT_MAT4 etc)
+  /// @param[in] _arraySize the number of elements for an array, 1 if not an array
+  /// @returns false if the type isn't a basic type
+  //----------------------------------------------------------------------------------------------------------------------
+  bool addMember(const std::string &_name, GLenum _type, GLint _arraySize=1) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a struct (or array of structs) after the last member using the std140 rules, the members are named
+  /// _name.member or _name[i].member
+  /// @param[in] _name the name of the struct member
+  /// @param[in] _struct the layout of the struct built with addMember
+  /// @param[in] _arraySize the number of elements for an array, 1 if not an array
+  //----------------------------------------------------------------------------------------------------------------------
+  void addStruct(const std::string &_name, const UniformBlockLayout &_struct, GLint _arraySize=1) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief replace the layout with the one the driver reports for a block of a linked program
+  /// @param[in] _program the id of the program
+  /// @param[in] _blockName the name of the block in the shader
+  /// @returns false if the program has no active block called _blockName
+  //----------------------------------------------------------------------------------------------------------------------
+  bool loadFromProgram(GLuint _program, const std::string &_blockName) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief find a member
+  /// @param[in] _name the name of the member, for arrays of basic types the name without [i]
+  /// @returns the member or nullptr if not found
+  //----------------------------------------------------------------------------------------------------------------------
+  const Member * find(const std::string &_name) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the members in order of offset
+  //----------------------------------------------------------------------------------------------------------------------
+  const std::vector<Member> & members() const noexcept{return m_members;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the size of the block data in bytes
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t size() const noexcept{return m_size;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief remove all the members
+  //----------------------------------------------------------------------------------------------------------------------
+  void clear() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of columns and rows of a GL type, scalars and vectors have one column
+  /// @returns false if _type isn't a basic type which can be in a uniform block
+  //----------------------------------------------------------------------------------------------------------------------
+  static bool typeSize(GLenum _type, unsigned int &o_columns, unsigned int &o_rows) noexcept;
+
+protected :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add a member at an offset and index it by name
+  //----------------------------------------------------------------------------------------------------------------------
+  void insert(const Member &_member) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the members in order of offset
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Member> m_members;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the index of each member in m_members by name
+  //----------------------------------------------------------------------------------------------------------------------
+  std::unordered_map<std::string,size_t> m_index;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the size of the block in bytes
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_size=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the end of the last member added, the next one is placed from here
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_end=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the largest alignment of the members, used when the layout is a struct in another
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_alignment=4;
+}; // end class UniformBlockLayout
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class UniformBlock "include/ngl/UniformBlock.h"
+/// @brief the data for one instance of a uniform block packed to a UniformBlockLayout, ready to copy into a
+/// UniformBuffer. Members are set by name (and index for arrays) like the ShaderLib setters, or by the Member from
+/// UniformBlockLayout::find which avoids looking the name up each time.
+/// The layout must outlive the block.
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT UniformBlock
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor zero filled data for a layout
+  /// @param[in] _layout the layout of the block
+  //----------------------------------------------------------------------------------------------------------------------
+  explicit UniformBlock(const UniformBlockLayout &_layout) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set a member, the name may have an array index "name[i]"
+  /// @returns false (with a warning) if the member isn't in the layout
+  //----------------------------------------------------------------------------------------------------------------------
+  bool set(const std::string &_name, Real _v) noexcept;
+  bool set(const std::string &_name, GLint _v) noexcept;
+  bool set(const std::string &_name, const Vec2 &_v) noexcept;
+  bool set(const std::string &_name, const Vec3 &_v) noexcept;
+  bool set(const std::string &_name, const Vec4 &_v) noexcept;
+  bool set(const std::string &_name, const Colour &_v) noexcept;
+  bool set(const std::string &_name, const Mat3 &_v) noexcept;
+  bool set(const std::string &_name, const Mat4 &_v) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set element _index of a member found in the layout
+  //----------------------------------------------------------------------------------------------------------------------
+  void set(const UniformBlockLayout::Member &_member, Real _v, GLint _index=0) noexcept;
+  void set(const UniformBlockLayout::Member &_member, GLint _v, GLint _index=0) noexcept;
+  void set(const UniformBlockLayout::Member &_member, const Vec2 &_v, GLint _index=0) noexcept;
+  void set(const UniformBlockLayout::Member &_member, const Vec3 &_v, GLint _index=0) noexcept;
+  void set(const UniformBlockLayout::Member &_member, const Vec4 &_v, GLint _index=0) noexcept;
+  void set(const UniformBlockLayout::Member &_member, const Colour &_v, GLint _index=0) noexcept;
+  void set(const UniformBlockLayout::Member &_member, const Mat3 &_v, GLint _index=0) noexcept;
+  void set(const UniformBlockLayout::Member &_member, const Mat4 &_v, GLint _index=0) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the packed data
+  //----------------------------------------------------------------------------------------------------------------------
+  const unsigned char * data() const noexcept{return m_data.data();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the size of the packed data in bytes
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t size() const noexcept{return m_data.size();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the layout of the block
+  //----------------------------------------------------------------------------------------------------------------------
+  const UniformBlockLayout & layout() const noexcept{return *m_layout;}
+
+protected :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief find a member from a name with an optional [i], a warning is given if not found
+  /// @param[out] o_index the array index
+  //----------------------------------------------------------------------------------------------------------------------
+  const UniformBlockLayout::Member * find(const std::string &_name, GLint &o_index) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief copy column major 4 byte values, _columns of _rows, to element _index of a member using its strides
+  //----------------------------------------------------------------------------------------------------------------------
+  void write(const UniformBlockLayout::Member &_member, GLint _index, const void *_values, unsigned int _columns,
+             unsigned int _rows) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the layout the data is packed to
+  //----------------------------------------------------------------------------------------------------------------------
+  const UniformBlockLayout *m_layout;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the packed data
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<unsigned char> m_data;
+}; // end class UniformBlock
+
+} // end namespace ngl
+
+#endif
@@ -0,0 +1,220 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef UNIFORMBUFFER_H_
+#define UNIFORMBUFFER_H_
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "UniformBlock.h"
+#include <cstddef>
+#include <deque>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file UniformBuffer.h
+/// @brief a ring buffer of uniform block data used to set uniform blocks with one bind per draw
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class UniformRing "include/ngl/UniformBuffer.h"
+/// @brief the allocation of ranges from a ring of fixed capacity (no OpenGL is used). Each allocation starts at a
+/// multiple of the alignment and wraps to the start when it won't fit at the end. The ranges allocated in the last
+/// framesInFlight frames are kept, so data the GPU may still be reading isn't overwritten, and the ranges of older
+/// frames are reused when nextFrame is called.
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT UniformRing
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor
+  /// @param[in] _capacity the size of the ring in bytes
+  /// @param[in] _alignment every allocation starts at a multiple of this
+  /// @param[in] _framesInFlight the number of frames (including the current one) whose ranges are kept
+  //----------------------------------------------------------------------------------------------------------------------
+  UniformRing(size_t _capacity, size_t _alignment, unsigned int _framesInFlight=3) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief allocate a range
+  /// @param[in] _bytes the size of the range
+  /// @returns the offset of the range or -1 if there isn't room without overwriting a frame in flight
+  //----------------------------------------------------------------------------------------------------------------------
+  GLintptr allocate(size_t _bytes) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief start a new frame, the ranges of the frame framesInFlight ago are free for reuse
+  //----------------------------------------------------------------------------------------------------------------------
+  void nextFrame() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief free everything
+  //----------------------------------------------------------------------------------------------------------------------
+  void reset() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the size of the ring in bytes
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t capacity() const noexcept{return m_capacity;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the alignment of the allocations
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t alignment() const noexcept{return m_alignment;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the bytes in use by the frames in flight, including alignment padding and the end skipped on a wrap
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t used() const noexcept{return m_used;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief where the next allocation will be tried
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t head() const noexcept{return m_head;}
+
+protected :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the size of the ring
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_capacity;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the alignment of the allocations
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_alignment;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of frames kept
+  //----------------------------------------------------------------------------------------------------------------------
+  unsigned int m_framesInFlight;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the end of the last allocation
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_head=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the bytes used by all the frames kept
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_used=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the bytes used by the current frame
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_frameUsed=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the bytes used by each of the previous frames kept, oldest first
+  //----------------------------------------------------------------------------------------------------------------------
+  std::deque<size_t> m_frames;
+}; // end class UniformRing
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @class UniformBuffer "include/ngl/UniformBuffer.h"
+/// @brief a GL_UNIFORM_BUFFER used as a ring: per frame and per object UniformBlocks are copied in with push and
+/// the range of each is bound to a block binding point with bindRange, replacing the uniforms set one at a time
+/// for each draw. The data is kept on the CPU until a range is bound so all the blocks pushed before a bind are
+/// sent with one glBufferSubData. Call nextFrame once a frame.
+/// Plain glBufferSubData is used (no persistent mapping) so this works with OpenGL 3.3 / 4.1 on the mac, OpenGL
+/// keeps writes to a range still in use correct and the ring only avoids waiting for them.
+/// @example
+/// ngl::UniformBuffer ubo;
+/// shader->setUniformBlockBinding("Frame",0);
+/// shader->setUniformBlockBinding("Object",1);
+/// GLintptr frame=ubo.push(frameBlock);
+/// for(auto &o : objects) o.offset=ubo.push(o.block);
+/// ubo.bindRange(0,frame,frameBlock.size());
+/// for(auto &o : objects) { ubo.bindRange(1,o.offset,o.block.size()); o.vao->draw(); }
+/// ubo.nextFrame();
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT UniformBuffer
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief counts of the data sent since the last resetStats
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Stats
+  {
+    size_t m_uploads=0;
+    size_t m_bytesUploaded=0;
+    size_t m_binds=0;
+    size_t m_overflows=0;
+  };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor creates the buffer
+  /// @param[in] _size the size of the buffer in bytes
+  /// @param[in] _framesInFlight the number of frames whose data is kept
+  /// @param[in] _alignment the offset alignment of bound ranges, 0 to use GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+  //----------------------------------------------------------------------------------------------------------------------
+  UniformBuffer(size_t _size=1<<20, unsigned int _framesInFlight=3, size_t _alignment=0) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief dtor deletes the buffer
+  //----------------------------------------------------------------------------------------------------------------------
+  ~UniformBuffer() noexcept;
+  UniformBuffer(const UniformBuffer &)=delete;
+  UniformBuffer & operator=(const UniformBuffer &)=delete;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief copy a block into the ring
+  /// @returns the offset of the data to pass to bindRange
+  //----------------------------------------------------------------------------------------------------------------------
+  GLintptr push(const UniformBlock &_block) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief copy raw data into the ring
+  /// @returns the offset of the data to pass to bindRange
+  //----------------------------------------------------------------------------------------------------------------------
+  GLintptr push(const void *_data, size_t _bytes) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief send any data pushed since the last upload then bind a range to a block binding point
+  /// @param[in] _binding the binding point (see ShaderLib::setUniformBlockBinding)
+  /// @param[in] _offset the offset returned by push
+  /// @param[in] _bytes the size of the block
+  //----------------------------------------------------------------------------------------------------------------------
+  void bindRange(GLuint _binding, GLintptr _offset, size_t _bytes) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief send the data pushed since the last upload to the buffer
+  //----------------------------------------------------------------------------------------------------------------------
+  void flush() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief start a new frame
+  //----------------------------------------------------------------------------------------------------------------------
+  void nextFrame() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the id of the buffer
+  //----------------------------------------------------------------------------------------------------------------------
+  GLuint getID() const noexcept{return m_id;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the allocation of the buffer
+  //----------------------------------------------------------------------------------------------------------------------
+  const UniformRing & ring() const noexcept{return m_ring;}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the counts of the data sent
+  //----------------------------------------------------------------------------------------------------------------------
+  const Stats & stats() const noexcept{return m_stats;}
+  void resetStats() noexcept{m_stats=Stats();}
+
+protected :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the offset alignment to use
+  //----------------------------------------------------------------------------------------------------------------------
+  static size_t offsetAlignment(size_t _alignment) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the id of the buffer
+  //----------------------------------------------------------------------------------------------------------------------
+  GLuint m_id=0;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the allocation of the buffer
+  //----------------------------------------------------------------------------------------------------------------------
+  UniformRing m_ring;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a copy of the buffer on the CPU the blocks are pushed to
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<unsigned char> m_data;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the range [m_dirtyBegin,m_dirtyEnd) pushed but not yet sent
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t m_dirtyBegin=0;
+  size_t m_dirtyEnd=0;
+  Stats m_stats;
+}; // end class UniformBuffer
+
+} // end namespace ngl
+
+#endif
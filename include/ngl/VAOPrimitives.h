@@ -21,6 +21,7 @@
 #include "Singleton.h"
 #include "Types.h"
 #include "Vec3.h"
+#include "Mat4.h"
 #include "AbstractVAO.h"
 #include <vector>
 #include <string>
@@ -51,6 +52,11 @@ struct vertData
     ngl::Real z;
 };
 
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief the first of the four attributes the per instance transform is passed in by VAOPrimitives::drawInstanced
+/// and BatchRenderer, declared in the vertex shader as layout(location=3) in mat4 inModel;
+//----------------------------------------------------------------------------------------------------------------------
+constexpr GLuint instanceTransformAttribute=3;
 class NGL_DLLEXPORT VAOPrimitives : public  Singleton<VAOPrimitives>
 {
 
@@ -70,6 +76,21 @@ public :
   //----------------------------------------------------------------------------------------------------------------------
   void draw( const std::string &_name,GLenum _mode ) noexcept;
   //----------------------------------------------------------------------------------------------------------------------
+  /// @brief Draw an instance of one of the VAO's for each transform with one instanced draw call, the transforms are
+  /// streamed to a per instance buffer of the VAO and read as a mat4 attribute at instanceTransformAttribute (using
+  /// attributes 3 to 6) rather than set as a uniform for each draw
+  /// @param[in] _name the name of the VBO to lookup in the VBO map
+  /// @param[in] _transforms the model matrix of each instance
+  //----------------------------------------------------------------------------------------------------------------------
+  void drawInstanced( const std::string &_name, const std::vector<Mat4> &_transforms ) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief Draw _count instances of one of the VAO's
+  /// @param[in] _name the name of the VBO to lookup in the VBO map
+  /// @param[in] _transforms pointer to the first of _count transforms
+  /// @param[in] _count the number of instances to draw
+  //----------------------------------------------------------------------------------------------------------------------
+  void drawInstanced( const std::string &_name, const Mat4 *_transforms, size_t _count ) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
   /// @brief create a triangulated Sphere as a vbo with auto generated texture cords
   /// @param[in] _name the name of the object created used when drawing
   /// @param[in] _radius the sphere radius
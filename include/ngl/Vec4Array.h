@@ -0,0 +1,187 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VEC4ARRAY_H_
+#define VEC4ARRAY_H_
+// must include types.h first for Real and GLEW if required
+#include "Types.h"
+#include "Vec4.h"
+#include "AlignedAllocator.h"
+#include <vector>
+#include <cstddef>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Vec4Array.h
+/// @brief an array of Vec4 stored as separate component arrays
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+//----------------------------------------------------------------------------------------------------------------------
+/// @class Vec4Array "include/ngl/Vec4Array.h"
+/// @brief an array of Vec4 stored structure of arrays style, each component (x, y, z, w) is held in its own
+/// 32 byte aligned array so bulk operations work on several elements at once with SIMD instructions.
+/// The operations work element by element and the arrays used together must be the same size. As with Vec4 the dot, length, normalize and cross only use x,y,z.
+//----------------------------------------------------------------------------------------------------------------------
+class NGL_DLLEXPORT Vec4Array
+{
+public :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the storage for one component
+  //----------------------------------------------------------------------------------------------------------------------
+  typedef std::vector<Real,AlignedAllocator<Real,32>> Lane;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief default ctor an empty array
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec4Array() noexcept{}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor with _size zero elements
+  /// @param[in] _size the number of elements
+  //----------------------------------------------------------------------------------------------------------------------
+  explicit Vec4Array(size_t _size) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief ctor copying an array of Vec4
+  /// @param[in] _v the values to copy
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec4Array(const std::vector<Vec4> &_v) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief replace the contents with an array of Vec4
+  /// @param[in] _v the values to copy
+  //----------------------------------------------------------------------------------------------------------------------
+  void set(const std::vector<Vec4> &_v) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief copy the contents to an array of Vec4
+  /// @param[out] o_v resized and filled with the elements
+  //----------------------------------------------------------------------------------------------------------------------
+  void get(std::vector<Vec4> &o_v) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the contents as an array of Vec4
+  //----------------------------------------------------------------------------------------------------------------------
+  std::vector<Vec4> toVector() const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief get element _i
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec4 operator[](size_t _i) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set element _i
+  //----------------------------------------------------------------------------------------------------------------------
+  void set(size_t _i, const Vec4 &_v) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add an element to the end
+  //----------------------------------------------------------------------------------------------------------------------
+  void push_back(const Vec4 &_v) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of elements
+  //----------------------------------------------------------------------------------------------------------------------
+  size_t size() const noexcept{return m_x.size();}
+  bool empty() const noexcept{return m_x.empty();}
+  void resize(size_t _size) noexcept;
+  void reserve(size_t _size) noexcept;
+  void clear() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the x components
+  //----------------------------------------------------------------------------------------------------------------------
+  Real * x() noexcept{return m_x.data();}
+  const Real * x() const noexcept{return m_x.data();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the y components
+  //----------------------------------------------------------------------------------------------------------------------
+  Real * y() noexcept{return m_y.data();}
+  const Real * y() const noexcept{return m_y.data();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the z components
+  //----------------------------------------------------------------------------------------------------------------------
+  Real * z() noexcept{return m_z.data();}
+  const Real * z() const noexcept{return m_z.data();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the w components
+  //----------------------------------------------------------------------------------------------------------------------
+  Real * w() noexcept{return m_w.data();}
+  const Real * w() const noexcept{return m_w.data();}
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief add _v to each element
+  //----------------------------------------------------------------------------------------------------------------------
+  void operator+=(const Vec4Array &_v) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief subtract _v from each element
+  //----------------------------------------------------------------------------------------------------------------------
+  void operator-=(const Vec4Array &_v) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief multiply each element by the matching element of _v (component wise)
+  //----------------------------------------------------------------------------------------------------------------------
+  void operator*=(const Vec4Array &_v) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief multiply each element by _s
+  //----------------------------------------------------------------------------------------------------------------------
+  void operator*=(Real _s) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief this += _a*_s, for example position += velocity*dt
+  //----------------------------------------------------------------------------------------------------------------------
+  void madd(const Vec4Array &_a, Real _s) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief this += _a*_b component wise
+  //----------------------------------------------------------------------------------------------------------------------
+  void madd(const Vec4Array &_a, const Vec4Array &_b) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set this to the linear interpolation of _a and _b, _a+(_b-_a)*_t
+  //----------------------------------------------------------------------------------------------------------------------
+  void lerp(const Vec4Array &_a, const Vec4Array &_b, Real _t) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief set the x,y,z of this to _v1 cross _v2
+  //----------------------------------------------------------------------------------------------------------------------
+  void cross(const Vec4Array &_v1, const Vec4Array &_v2) noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the dot product of each element with the matching element of _v
+  /// @param[out] o_res resized and filled with the results
+  //----------------------------------------------------------------------------------------------------------------------
+  void dot(const Vec4Array &_v, std::vector<Real> &o_res) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the length of each element
+  /// @param[out] o_res resized and filled with the results
+  //----------------------------------------------------------------------------------------------------------------------
+  void length(std::vector<Real> &o_res) const noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief normalize each element, zero length elements are left as zero
+  //----------------------------------------------------------------------------------------------------------------------
+  void normalize() noexcept;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the smallest and largest value of each component over all the elements, both are zero if empty
+  /// @param[out] o_min the minimum of each component
+  /// @param[out] o_max the maximum of each component
+  //----------------------------------------------------------------------------------------------------------------------
+  void minMax(Vec4 &o_min, Vec4 &o_max) const noexcept;
+
+protected :
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the x component of each element
+  //----------------------------------------------------------------------------------------------------------------------
+  Lane m_x;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the y component of each element
+  //----------------------------------------------------------------------------------------------------------------------
+  Lane m_y;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the z component of each element
+  //----------------------------------------------------------------------------------------------------------------------
+  Lane m_z;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the w component of each element
+  //----------------------------------------------------------------------------------------------------------------------
+  Lane m_w;
+}; // end class
+
+} // end namespace ngl
+
+#endif
+//----------------------------------------------------------------------------------------------------------------------
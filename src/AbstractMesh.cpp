@@ -17,10 +17,16 @@
 
 #include "AbstractMesh.h"
 #include "Util.h"
-#include <list>
+#include <algorithm>
+#include <cmath>
 #include "NGLStream.h"
 #include "VAOFactory.h"
 #include "SimpleVAO.h"
+#include "SimpleIndexVAO.h"
+#include "MultiBufferVAO.h"
+#include "NCCABinMesh.h"
+#include "BatchTransform.h"
+#include "BoundingVolume.h"
 //----------------------------------------------------------------------------------------------------------------------
 /// @file AbstractMesh.cpp
 /// @brief a series of classes used to define an abstract 3D mesh of Faces, Vertex Normals and TexCords
@@ -28,9 +34,111 @@
 
 namespace ngl
 {
-  //----------------------------------------------------------------------------------------------------------------------
+//----------------------------------------------------------------------------------------------------------------------
+void FaceList::addFace(uint32_t _numVerts, const uint32_t *_vert, const uint32_t *_tex, const uint32_t *_norm)
+{
+  size_t start=m_vert.size();
+  m_vert.insert(m_vert.end(),_vert,_vert+_numVerts);
+  uint8_t flags=0;
+  // the tex and normal arrays are only created when the first face uses them, after that they
+  // are kept parallel to the vert array (padded with 0 for faces which don't use them)
+  if(_tex !=nullptr)
+  {
+    m_tex.resize(start,0);
+    m_tex.insert(m_tex.end(),_tex,_tex+_numVerts);
+    flags|=TextureCoords;
+  }
+  else if(!m_tex.empty())
+  {
+    m_tex.resize(m_vert.size(),0);
+  }
+  if(_norm !=nullptr)
+  {
+    m_norm.resize(start,0);
+    m_norm.insert(m_norm.end(),_norm,_norm+_numVerts);
+    flags|=Normals;
+  }
+  else if(!m_norm.empty())
+  {
+    m_norm.resize(m_vert.size(),0);
+  }
+  m_offsets.push_back(static_cast<uint32_t>(m_vert.size()));
+  m_flags.push_back(flags);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void FaceList::setFace(size_t _face, const uint32_t *_vert, const uint32_t *_tex, const uint32_t *_norm) noexcept
+{
+  uint32_t begin=m_offsets[_face];
+  uint32_t numVerts=m_offsets[_face+1]-begin;
+  std::copy(_vert,_vert+numVerts,m_vert.begin()+begin);
+  if(_tex !=nullptr && (m_flags[_face] & TextureCoords))
+  {
+    std::copy(_tex,_tex+numVerts,m_tex.begin()+begin);
+  }
+  if(_norm !=nullptr && (m_flags[_face] & Normals))
+  {
+    std::copy(_norm,_norm+numVerts,m_norm.begin()+begin);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void FaceList::append(const FaceList &_faces)
+{
+  size_t start=m_vert.size();
+  uint32_t offset=static_cast<uint32_t>(start);
+  m_vert.insert(m_vert.end(),_faces.m_vert.begin(),_faces.m_vert.end());
+  if(!_faces.m_tex.empty())
+  {
+    m_tex.resize(start,0);
+    m_tex.insert(m_tex.end(),_faces.m_tex.begin(),_faces.m_tex.end());
+  }
+  else if(!m_tex.empty())
+  {
+    m_tex.resize(m_vert.size(),0);
+  }
+  if(!_faces.m_norm.empty())
+  {
+    m_norm.resize(start,0);
+    m_norm.insert(m_norm.end(),_faces.m_norm.begin(),_faces.m_norm.end());
+  }
+  else if(!m_norm.empty())
+  {
+    m_norm.resize(m_vert.size(),0);
+  }
+  for(size_t i=1; i<_faces.m_offsets.size(); ++i)
+  {
+    m_offsets.push_back(_faces.m_offsets[i]+offset);
+  }
+  m_flags.insert(m_flags.end(),_faces.m_flags.begin(),_faces.m_flags.end());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void FaceList::reserve(size_t _numFaces, size_t _numIndices)
+{
+  m_offsets.reserve(_numFaces+1);
+  m_flags.reserve(_numFaces);
+  m_vert.reserve(_numIndices);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void FaceList::clear() noexcept
+{
+  m_offsets.assign(1,0);
+  m_vert.clear();
+  m_tex.clear();
+  m_norm.clear();
+  m_flags.clear();
+}
 
 //----------------------------------------------------------------------------------------------------------------------
+size_t FaceList::memorySize() const noexcept
+{
+  return sizeof(FaceList)+
+         m_offsets.capacity()*sizeof(uint32_t)+
+         (m_vert.capacity()+m_tex.capacity()+m_norm.capacity())*sizeof(uint32_t)+
+         m_flags.capacity()*sizeof(uint8_t);
+}
 
 //----------------------------------------------------------------------------------------------------------------------
 void AbstractMesh::drawBBox() const noexcept
@@ -40,17 +148,9 @@ void AbstractMesh::drawBBox() const noexcept
 
 void AbstractMesh::scale(Real _sx, Real _sy, Real _sz ) noexcept
 {
-  m_center=0;
-  // do lambda here
-  for (auto &v : m_verts)
-  {
-    v.m_x*=_sx;
-    v.m_y*=_sy;
-    v.m_z*=_sz;
-    m_center+=v;
-  }
-// calculate the center
-  m_center/=m_nVerts;
+  Mat4 scale;
+  scale.scale(_sx,_sy,_sz);
+  transformPoints(scale,m_verts.data(),m_verts.data(),m_verts.size());
   calcDimensions();
 }
 
@@ -64,7 +164,7 @@ AbstractMesh::~AbstractMesh() noexcept
     m_verts.erase(m_verts.begin(),m_verts.end());
     m_norm.erase(m_norm.begin(),m_norm.end());
     m_tex.erase(m_tex.begin(),m_tex.end());
-    m_face.erase(m_face.begin(),m_face.end());
+    m_face.clear();
     m_indices.erase(m_indices.begin(),m_indices.end());
     m_outIndices.erase(m_outIndices.begin(),m_outIndices.end());
 
@@ -86,113 +186,58 @@ void AbstractMesh::loadTexture( const std::string& _fName  ) noexcept
 	m_texture=true;
 }
 
-/// @todo correct the rib exporter and  add Normal information to  the export
+/// @todo add Normal information to  the export
 /// @verbatim
-/// The following code is adapted from an MSc project by
+/// Originally adapted from an MSc project by
 /// Authors: Elaine Kieran, Gavin Harrison, Luke Openshaw
 /// Write the obj as a SubdivisionMesh package to the rib file
 /// Renderman specification: SubdivisionMesh scheme nverts vertids tags nargs intargs floatargs parameterlist
+/// as the face list is already indexed the vertids are the face vertex indices and P is the vert list
 /// @endverbatim
 
 //----------------------------------------------------------------------------------------------------------------------
 void AbstractMesh::writeToRibSubdiv(RibExport& _ribFile )const noexcept
 {
-	// Declare the variables
-	std::list< int > lVertLink;
-	std::list< int >::iterator vertLinkItr;
-	std::vector< float > vVerts;
-	std::vector< float >::iterator vertsItr;
-
   // Check if the rib exists
   if( _ribFile.isOpen() != 0 )
   {
     _ribFile.comment( "OBJ AbstractMeshect" );
-  // Start printing the SubdivisionPolygons tag to the rib
+    // Start printing the SubdivisionPolygons tag to the rib
     _ribFile.getStream() << "SubdivisionMesh \"catmull-clark\" [ ";
-
-		// Loop through all the Polygons
-		for (unsigned long  int I=0; I<m_nVerts; ++I)
-		{
-		// Print the count of vertices for the current polygon to the rib
-		_ribFile.getStream() << m_face[I].m_numVerts << " ";
-		// Start building the vertids and parameterlist
-		for (unsigned long int i = 0; i < m_face[I].m_numVerts; ++i)
-		{
-			// Set the verts vector size and testing variables
-      size_t iVecSize = vVerts.size();
-			bool bTest = false;
-			int counter = 0;
-			// Loop through the expanding vector checking whether
-			// the current vertice exists
-      for (unsigned int j = 0; j < iVecSize; j = j + 3)
-			{
-				// If the vertice if found in the vector, set the test
-				// flag and exit the loop. Else keep going.
-				if( ( FCompare(m_verts[i].m_x ,vVerts[j]) ) &&
-					( FCompare(m_verts[i].m_y,vVerts[j + 1]) ) &&
-					( FCompare(m_verts[i].m_y,vVerts[j + 2]) )
-					 )
-				{
-					bTest = true;
-					break;
-				}
-				else
-				{
-					counter++;
-				}
-			} //end for
-
-			// Add the vertice to the vector if it is not found
-			if( bTest == false )
-			{
-				vVerts.push_back( m_verts[m_face[I].m_vert[i]].m_x );
-				vVerts.push_back( m_verts[m_face[I].m_vert[i]].m_y );
-				vVerts.push_back( m_verts[m_face[I].m_vert[i]].m_z );
-				lVertLink.push_back( counter );
-			}
-			else
-			{
-				lVertLink.push_back( counter );
-			}
-
-		}// end outer for
-
-	}// end if
-
-	_ribFile.getStream() << "] [ ";
-
-	// Print the vertids to the rib
-	std::list< int >::iterator vertLinkEnd=lVertLink.end();
-	for (vertLinkItr = lVertLink.begin(); vertLinkItr != vertLinkEnd; ++vertLinkItr)
-	{
-		_ribFile.getStream() << *vertLinkItr << " ";
-	}
-
-	_ribFile.getStream() << "] [\"interpolateboundary\"] [0 0] [] [] \"P\" [ ";
-	// Print the parameterlist to the rib
-	std::vector< float >::iterator vVertEnd=vVerts.end();
-	for (vertsItr = vVerts.begin(); vertsItr != vVertEnd; ++vertsItr)
-	{
-		_ribFile.getStream() << *vertsItr << " ";
-	}
-
-	// Print new lines to the rib
-	_ribFile.getStream() << "]\n\n";
-	}
-
+    // Print the count of vertices for each polygon to the rib
+    for(auto face : m_face)
+    {
+      _ribFile.getStream() << face.numVerts() << " ";
+    }
+    _ribFile.getStream() << "] [ ";
+    // Print the vertids to the rib, these index straight into the vert list
+    for(auto index : m_face.vertIndices())
+    {
+      _ribFile.getStream() << index << " ";
+    }
+    _ribFile.getStream() << "] [\"interpolateboundary\"] [0 0] [] [] \"P\" [ ";
+    // Print the parameterlist to the rib
+    for(auto v : m_verts)
+    {
+      _ribFile.getStream() << v.m_x << " " << v.m_y << " " << v.m_z << " ";
+    }
+    // Print new lines to the rib
+    _ribFile.getStream() << "]\n\n";
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 bool AbstractMesh::isTriangular() noexcept
-{ 
-	for(auto f : m_face)
-	{
-		if (f.m_numVerts >3)
-		{
-			return false;
-		}
-	}
-	return true;
+{
+  const std::vector<uint32_t> &offsets=m_face.offsets();
+  for(size_t i=1; i<offsets.size(); ++i)
+  {
+    if(offsets[i]-offsets[i-1] !=3)
+    {
+      return false;
+    }
+  }
+  return true;
 }
 
 // a simple structure to hold our vertex data
@@ -210,6 +255,207 @@ struct VertData
   GLfloat z;
 };
 
+namespace
+{
+  // fill in a VertData from the (vert,normal,tex) indices, if norms or tex are not present
+  // (only verts like Zbrush models) they are set to 0
+  void packVertex(const IndexRef &_ref, const std::vector<Vec3> &_verts, const std::vector<Vec3> &_norm,
+                  const std::vector<Vec3> &_tex, bool _hasNormals, bool _hasTex, VertData &o_d) noexcept
+  {
+    const Vec3 &vert=_verts[_ref.m_v];
+    o_d.x=vert.m_x;
+    o_d.y=vert.m_y;
+    o_d.z=vert.m_z;
+    if(_hasNormals)
+    {
+      const Vec3 &norm=_norm[_ref.m_n];
+      o_d.nx=norm.m_x;
+      o_d.ny=norm.m_y;
+      o_d.nz=norm.m_z;
+    }
+    else
+    {
+      o_d.nx=o_d.ny=o_d.nz=0;
+    }
+    if(_hasTex)
+    {
+      const Vec3 &tex=_tex[_ref.m_t];
+      o_d.u=tex.m_x;
+      o_d.v=tex.m_y;
+    }
+    else
+    {
+      o_d.u=o_d.v=0;
+    }
+  }
+
+  // hash for the open addressing table used to find duplicate (vert,normal,tex) triples
+  inline size_t hashIndexRef(uint32_t _v, uint32_t _n, uint32_t _t) noexcept
+  {
+    uint64_t h=(static_cast<uint64_t>(_v) | static_cast<uint64_t>(_n)<<32)*0x9E3779B97F4A7C15ULL;
+    h^=static_cast<uint64_t>(_t)*0xC2B2AE3D27D4EB4FULL;
+    h^=h>>29;
+    return static_cast<size_t>(h);
+  }
+
+  const uint32_t s_emptySlot=0xffffffff;
+
+  // the number of triangles a fan split of the faces gives, faces with less than 3 vertices give none
+  size_t numFanTriangles(const std::vector<uint32_t> &_offsets) noexcept
+  {
+    size_t triangles=0;
+    for(size_t f=0; f+1<_offsets.size(); ++f)
+    {
+      uint32_t numVerts=_offsets[f+1]-_offsets[f];
+      triangles+= numVerts>2 ? numVerts-2 : 0;
+    }
+    return triangles;
+  }
+
+  // Tom Forsyth's vertex score, vertices used by the last triangle get a fixed score (so the next
+  // triangle doesn't just re-use the same edge), the rest decay with cache position and vertices
+  // with few triangles left are boosted so we don't leave lone triangles behind
+  float forsythScore(int _cachePos, uint32_t _remaining, unsigned int _cacheSize) noexcept
+  {
+    if(_remaining==0)
+    {
+      return -1.0f;
+    }
+    float score=0.0f;
+    if(_cachePos>=0)
+    {
+      if(_cachePos<3)
+      {
+        score=0.75f;
+      }
+      else
+      {
+        float scale=1.0f-static_cast<float>(_cachePos-3)/static_cast<float>(_cacheSize-3);
+        score=std::pow(scale,1.5f);
+      }
+    }
+    return score+2.0f/std::sqrt(static_cast<float>(_remaining));
+  }
+
+  // re-order the triangles in io_indices for an LRU vertex cache of _cacheSize entries
+  void optimiseVertexCache(std::vector<GLuint> &io_indices, size_t _numVerts, unsigned int _cacheSize) noexcept
+  {
+    const size_t numTris=io_indices.size()/3;
+    // triangles using each vertex stored as contiguous lists, the first m_remaining[v] entries
+    // of each list are the triangles not yet emitted
+    std::vector<uint32_t> adjOffset(_numVerts+1,0);
+    for(auto i : io_indices)
+    {
+      ++adjOffset[i+1];
+    }
+    std::vector<uint32_t> remaining(_numVerts);
+    for(size_t v=0; v<_numVerts; ++v)
+    {
+      remaining[v]=adjOffset[v+1];
+      adjOffset[v+1]+=adjOffset[v];
+    }
+    std::vector<uint32_t> adjTris(io_indices.size());
+    {
+      std::vector<uint32_t> fill(adjOffset.begin(),adjOffset.end()-1);
+      for(size_t i=0; i<io_indices.size(); ++i)
+      {
+        adjTris[fill[io_indices[i]]++]=static_cast<uint32_t>(i/3);
+      }
+    }
+    std::vector<int> cachePos(_numVerts,-1);
+    std::vector<float> vertScore(_numVerts);
+    for(size_t v=0; v<_numVerts; ++v)
+    {
+      vertScore[v]=forsythScore(-1,remaining[v],_cacheSize);
+    }
+    std::vector<float> triScore(numTris);
+    for(size_t t=0; t<numTris; ++t)
+    {
+      triScore[t]=vertScore[io_indices[t*3]]+vertScore[io_indices[t*3+1]]+vertScore[io_indices[t*3+2]];
+    }
+    std::vector<bool> emitted(numTris,false);
+    std::vector<GLuint> out;
+    out.reserve(io_indices.size());
+    // the cache may temporarily hold 3 more than its size before the extra vertices are evicted
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> newCache;
+    cache.reserve(_cacheSize+3);
+    newCache.reserve(_cacheSize+3);
+    size_t cursor=0;
+    int64_t best=-1;
+    for(size_t n=0; n<numTris; ++n)
+    {
+      // if nothing in the cache has a triangle left just take the next unused one in file order
+      if(best<0)
+      {
+        while(emitted[cursor])
+        {
+          ++cursor;
+        }
+        best=static_cast<int64_t>(cursor);
+      }
+      const size_t t=static_cast<size_t>(best);
+      emitted[t]=true;
+      newCache.clear();
+      for(size_t k=0; k<3; ++k)
+      {
+        uint32_t v=io_indices[t*3+k];
+        out.push_back(v);
+        // remove the triangle from the vertex's active list
+        uint32_t *list=&adjTris[adjOffset[v]];
+        uint32_t last=--remaining[v];
+        for(uint32_t j=0; j<=last; ++j)
+        {
+          if(list[j]==t)
+          {
+            std::swap(list[j],list[last]);
+            break;
+          }
+        }
+        if(std::find(newCache.begin(),newCache.end(),v)==newCache.end())
+        {
+          newCache.push_back(v);
+        }
+      }
+      for(auto v : cache)
+      {
+        if(std::find(newCache.begin(),newCache.end(),v)==newCache.end())
+        {
+          newCache.push_back(v);
+        }
+      }
+      // update the scores of everything in the cache (including the ones about to be evicted)
+      // and find the best triangle using these vertices
+      float bestScore=-1.0f;
+      best=-1;
+      for(size_t i=0; i<newCache.size(); ++i)
+      {
+        uint32_t v=newCache[i];
+        cachePos[v]= i<_cacheSize ? static_cast<int>(i) : -1;
+        float score=forsythScore(cachePos[v],remaining[v],_cacheSize);
+        float delta=score-vertScore[v];
+        vertScore[v]=score;
+        const uint32_t *list=&adjTris[adjOffset[v]];
+        for(uint32_t j=0; j<remaining[v]; ++j)
+        {
+          uint32_t tri=list[j];
+          triScore[tri]+=delta;
+          if(triScore[tri]>bestScore)
+          {
+            bestScore=triScore[tri];
+            best=tri;
+          }
+        }
+      }
+      if(newCache.size()>_cacheSize)
+      {
+        newCache.resize(_cacheSize);
+      }
+      std::swap(cache,newCache);
+    }
+    io_indices.swap(out);
+  }
+}
 
 void AbstractMesh::createVAO() noexcept
 {
@@ -220,75 +466,44 @@ void AbstractMesh::createVAO() noexcept
 		return;
 	}
 // else allocate space as build our VAO
-	m_dataPackType=0;
+	m_dataPackType=GL_TRIANGLES;
 	if(isTriangular())
 	{
-		m_dataPackType=GL_TRIANGLES;
 		std::cout <<"Doing Tri Data"<<std::endl;
 	}
-	// data is mixed of > quad so exit error
-	if(m_dataPackType == 0)
+	else
 	{
-		std::cerr<<"Can only create VBO from all Triangle or ALL Quad data at present"<<std::endl;
-		exit(EXIT_FAILURE);
+		std::cout <<"Triangulating polygon data"<<std::endl;
 	}
 
   // now we are going to process and pack the mesh into an ngl::VertexArrayObject
+  // the face data is stored as contiguous index arrays so we walk these directly
+  const std::vector<uint32_t> &offsets=m_face.offsets();
+  const std::vector<uint32_t> &vertIndex=m_face.vertIndices();
+  const std::vector<uint32_t> &normIndex=m_face.normalIndices();
+  const std::vector<uint32_t> &texIndex=m_face.texIndices();
+  bool hasNormals= m_nNorm>0 && !normIndex.empty();
+  bool hasTex= m_nTex>0 && !texIndex.empty();
   std::vector <VertData> vboMesh;
+  vboMesh.reserve(vertIndex.size());
   VertData d;
 
-
 	// loop for each of the faces
-	for(unsigned int i=0;i<m_nFaces;++i)
+	for(size_t f=0; f<m_face.size(); ++f)
 	{
-		// now for each triangle in the face (remember we ensured tri above)
-    for(unsigned int j=0;j<3;++j)
+		// now for each triangle in the face, polygons are split into a fan around the first vertex
+		uint32_t first=offsets[f];
+		for(uint32_t k=first+1; k+1<offsets[f+1]; ++k)
 		{
-
-			// pack in the vertex data first
-			d.x=m_verts[m_face[i].m_vert[j]].m_x;
-			d.y=m_verts[m_face[i].m_vert[j]].m_y;
-			d.z=m_verts[m_face[i].m_vert[j]].m_z;
-			// now if we have norms of tex (possibly could not) pack them as well
-			if(m_nNorm >0 && m_nTex > 0)
+			const uint32_t corners[3]={first,k,k+1};
+			for(auto c : corners)
 			{
-        d.nx=m_norm[m_face[i].m_norm[j]].m_x;
-        d.ny=m_norm[m_face[i].m_norm[j]].m_y;
-        d.nz=m_norm[m_face[i].m_norm[j]].m_z;
-
-				d.u=m_tex[m_face[i].m_tex[j]].m_x;
-				d.v=m_tex[m_face[i].m_tex[j]].m_y;
-      }
-      // now if neither are present (only verts like Zbrush models)
-      else if(m_nNorm ==0 && m_nTex==0)
-      {
-        d.nx=0;
-        d.ny=0;
-        d.nz=0;
-        d.u=0;
-        d.v=0;
-      }
-      // here we've got norms but not tex
-      else if(m_nNorm >0 && m_nTex==0)
-      {
-        d.nx=m_norm[m_face[i].m_norm[j]].m_x;
-        d.ny=m_norm[m_face[i].m_norm[j]].m_y;
-        d.nz=m_norm[m_face[i].m_norm[j]].m_z;
-        d.u=0;
-        d.v=0;
-      }
-      // here we've got tex but not norm least common
-      else if(m_nNorm ==0 && m_nTex>0)
-      {
-        d.nx=0;
-        d.ny=0;
-        d.nz=0;
-        d.u=m_tex[m_face[i].m_tex[j]].m_x;
-        d.v=m_tex[m_face[i].m_tex[j]].m_y;
-      }
-    vboMesh.push_back(d);
-    }
-  }
+				IndexRef ref(vertIndex[c],hasNormals ? normIndex[c] : 0,hasTex ? texIndex[c] : 0);
+				packVertex(ref,m_verts,m_norm,m_tex,hasNormals,hasTex,d);
+				vboMesh.push_back(d);
+			}
+		}
+	}
 
   // first we grab an instance of our VOA
   m_vaoMesh.reset( ngl::VAOFactory::createVAO("simpleVAO",m_dataPackType));
@@ -327,9 +542,332 @@ void AbstractMesh::createVAO() noexcept
 
 	// indicate we have a vao now
 	m_vao=true;
+	m_indexed=false;
+	m_positionStream=false;
 
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+void AbstractMesh::buildIndexedData() noexcept
+{
+  const std::vector<uint32_t> &offsets=m_face.offsets();
+  const std::vector<uint32_t> &vertIndex=m_face.vertIndices();
+  const std::vector<uint32_t> &normIndex=m_face.normalIndices();
+  const std::vector<uint32_t> &texIndex=m_face.texIndices();
+  bool hasNormals= m_nNorm>0 && !normIndex.empty();
+  bool hasTex= m_nTex>0 && !texIndex.empty();
+  m_indices.clear();
+  m_outIndices.clear();
+  size_t numCorners=vertIndex.size();
+  if(numCorners==0)
+  {
+    return;
+  }
+  // open addressing hash table (linear probing) holding the id's of the unique vertices in m_indices,
+  // sized to a power of two at least twice the number of corners so it is never more than half full
+  size_t tableSize=1;
+  while(tableSize < numCorners*2)
+  {
+    tableSize<<=1;
+  }
+  const size_t mask=tableSize-1;
+  std::vector<uint32_t> table(tableSize,s_emptySlot);
+  m_indices.reserve(numCorners/2);
+  // first map each face corner to its unique vertex, vertices are numbered in order of first use
+  std::vector<GLuint> cornerVertex(numCorners);
+  for(size_t c=0; c<numCorners; ++c)
+  {
+    uint32_t v=vertIndex[c];
+    uint32_t n=hasNormals ? normIndex[c] : 0;
+    uint32_t t=hasTex ? texIndex[c] : 0;
+    size_t slot=hashIndexRef(v,n,t) & mask;
+    uint32_t id;
+    for(;;)
+    {
+      id=table[slot];
+      if(id==s_emptySlot)
+      {
+        id=static_cast<uint32_t>(m_indices.size());
+        table[slot]=id;
+        m_indices.push_back(IndexRef(v,n,t));
+        break;
+      }
+      const IndexRef &ref=m_indices[id];
+      if(ref.m_v==v && ref.m_n==n && ref.m_t==t)
+      {
+        break;
+      }
+      slot=(slot+1) & mask;
+    }
+    cornerVertex[c]=id;
+  }
+  // now build the triangle list, polygons are split into a fan around the first vertex as in createVAO
+  m_outIndices.reserve(3*numFanTriangles(offsets));
+  for(size_t f=0; f<m_face.size(); ++f)
+  {
+    uint32_t first=offsets[f];
+    for(uint32_t k=first+1; k+1<offsets[f+1]; ++k)
+    {
+      m_outIndices.push_back(cornerVertex[first]);
+      m_outIndices.push_back(cornerVertex[k]);
+      m_outIndices.push_back(cornerVertex[k+1]);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Real AbstractMesh::getVertexReuseRatio() const noexcept
+{
+  if(m_indices.empty())
+  {
+    return 0.0f;
+  }
+  return static_cast<Real>(m_outIndices.size())/static_cast<Real>(m_indices.size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void AbstractMesh::getIndexedVertexData(std::vector<Real> &o_data) noexcept
+{
+  static_assert(sizeof(VertData)==8*sizeof(Real),"VertData must be 8 packed floats");
+  if(m_indices.empty())
+  {
+    buildIndexedData();
+  }
+  bool hasNormals= m_nNorm>0 && !m_face.normalIndices().empty();
+  bool hasTex= m_nTex>0 && !m_face.texIndices().empty();
+  o_data.resize(m_indices.size()*8);
+  VertData *verts=reinterpret_cast<VertData *>(o_data.data());
+  for(size_t i=0; i<m_indices.size(); ++i)
+  {
+    packVertex(m_indices[i],m_verts,m_norm,m_tex,hasNormals,hasTex,verts[i]);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Real AbstractMesh::calcACMR(unsigned int _cacheSize) const noexcept
+{
+  if(m_outIndices.empty())
+  {
+    return 0.0f;
+  }
+  // FIFO cache, a vertex is still in the cache if fewer than _cacheSize misses have happened since
+  // it was loaded (stamps are offset by one so 0 means never loaded)
+  std::vector<size_t> stamp(m_indices.size(),0);
+  size_t misses=0;
+  for(auto i : m_outIndices)
+  {
+    if(stamp[i]==0 || misses-stamp[i] >= _cacheSize)
+    {
+      ++misses;
+      stamp[i]=misses;
+    }
+  }
+  return static_cast<Real>(misses)/static_cast<Real>(m_outIndices.size()/3);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void AbstractMesh::optimiseIndexedData(unsigned int _cacheSize) noexcept
+{
+  if(m_outIndices.empty())
+  {
+    buildIndexedData();
+  }
+  if(m_outIndices.empty())
+  {
+    return;
+  }
+  if(_cacheSize<4)
+  {
+    std::cerr<<"vertex cache size must be at least 4 using 32\n";
+    _cacheSize=32;
+  }
+  Real before=calcACMR(_cacheSize);
+  optimiseVertexCache(m_outIndices,m_indices.size(),_cacheSize);
+  // now renumber the vertices in the order the triangles first use them so the vertex fetches
+  // walk through memory rather than jumping around
+  std::vector<uint32_t> remap(m_indices.size(),s_emptySlot);
+  std::vector<IndexRef> indices;
+  indices.reserve(m_indices.size());
+  for(auto &i : m_outIndices)
+  {
+    if(remap[i]==s_emptySlot)
+    {
+      remap[i]=static_cast<uint32_t>(indices.size());
+      indices.push_back(m_indices[i]);
+    }
+    i=remap[i];
+  }
+  m_indices.swap(indices);
+  std::cout<<"Vertex cache optimisation ACMR "<<before<<" -> "<<calcACMR(_cacheSize)
+           <<" (cache size "<<_cacheSize<<")\n";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void AbstractMesh::createIndexedVAO(bool _optimise) noexcept
+{
+  // if we have already created a VBO just return.
+  if(m_vao == true)
+  {
+    std::cout<<"VAO exist so returning\n";
+    return;
+  }
+  m_dataPackType=GL_TRIANGLES;
+  buildIndexedData();
+  if(_optimise)
+  {
+    optimiseIndexedData();
+  }
+  if(m_outIndices.empty())
+  {
+    std::cerr<<"no face data to create indexed VAO from\n";
+    return;
+  }
+  bool hasNormals= m_nNorm>0 && !m_face.normalIndices().empty();
+  bool hasTex= m_nTex>0 && !m_face.texIndices().empty();
+  std::vector <VertData> vboMesh(m_indices.size());
+  for(size_t i=0; i<m_indices.size(); ++i)
+  {
+    packVertex(m_indices[i],m_verts,m_norm,m_tex,hasNormals,hasTex,vboMesh[i]);
+  }
+  std::cout<<"Indexed VAO "<<m_indices.size()<<" unique vertices from "<<m_outIndices.size()
+           <<" triangle corners (reuse ratio "<<getVertexReuseRatio()<<")\n";
+
+  m_vaoMesh.reset( ngl::VAOFactory::createVAO("simpleIndexVAO",m_dataPackType));
+  m_vaoMesh->bind();
+  m_meshSize=m_outIndices.size();
+  // use 16 bit indices where we can as they are half the size
+  if(m_indices.size() <= 0xffff+1)
+  {
+    std::vector<GLushort> shortIndices(m_outIndices.begin(),m_outIndices.end());
+    m_vaoMesh->setData(SimpleIndexVAO::VertexData(vboMesh.size()*sizeof(VertData),vboMesh[0].u,
+                                                  static_cast<unsigned int>(shortIndices.size()),&shortIndices[0],
+                                                  GL_UNSIGNED_SHORT));
+  }
+  else
+  {
+    m_vaoMesh->setData(SimpleIndexVAO::VertexData(vboMesh.size()*sizeof(VertData),vboMesh[0].u,
+                                                  static_cast<unsigned int>(m_outIndices.size()),&m_outIndices[0],
+                                                  GL_UNSIGNED_INT));
+  }
+  // same interleaved u,v,nx,ny,nz,x,y,z layout and attributes as createVAO
+  m_vaoMesh->setVertexAttributePointer(0,3,GL_FLOAT,sizeof(VertData),5);
+  m_vaoMesh->setVertexAttributePointer(1,2,GL_FLOAT,sizeof(VertData),0);
+  m_vaoMesh->setVertexAttributePointer(2,3,GL_FLOAT,sizeof(VertData),2);
+  m_vaoMesh->setNumIndices(m_meshSize);
+  m_vaoMesh->unbind();
+
+  m_vao=true;
+  m_indexed=true;
+  m_positionStream=false;
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+void AbstractMesh::buildPositionRemap() noexcept
+{
+  const std::vector<uint32_t> &offsets=m_face.offsets();
+  const std::vector<uint32_t> &vertIndex=m_face.vertIndices();
+  m_positionRemap.clear();
+  m_positionRemap.reserve(3*numFanTriangles(offsets));
+  // same fan triangulation as createVAO
+  for(size_t f=0; f<m_face.size(); ++f)
+  {
+    uint32_t first=offsets[f];
+    for(uint32_t k=first+1; k+1<offsets[f+1]; ++k)
+    {
+      m_positionRemap.push_back(vertIndex[first]);
+      m_positionRemap.push_back(vertIndex[k]);
+      m_positionRemap.push_back(vertIndex[k+1]);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void AbstractMesh::remapPositions(const std::vector<Vec3> &_positions, std::vector<Vec3> &o_stream) const noexcept
+{
+  o_stream.resize(m_positionRemap.size());
+  const uint32_t *remap=m_positionRemap.data();
+  const Vec3 *src=_positions.data();
+  Vec3 *dst=o_stream.data();
+  for(size_t i=0; i<m_positionRemap.size(); ++i)
+  {
+    dst[i]=src[remap[i]];
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void AbstractMesh::createAnimatedVAO() noexcept
+{
+  // if we have already created a VBO just return.
+  if(m_vao == true)
+  {
+    std::cout<<"VAO exist so returning\n";
+    return;
+  }
+  m_dataPackType=GL_TRIANGLES;
+  buildPositionRemap();
+  if(m_positionRemap.empty())
+  {
+    std::cerr<<"no face data to create animated VAO from\n";
+    return;
+  }
+  // the uv and normals don't change so are packed once into their own buffer as u,v,nx,ny,nz
+  const std::vector<uint32_t> &offsets=m_face.offsets();
+  const std::vector<uint32_t> &vertIndex=m_face.vertIndices();
+  const std::vector<uint32_t> &normIndex=m_face.normalIndices();
+  const std::vector<uint32_t> &texIndex=m_face.texIndices();
+  bool hasNormals= m_nNorm>0 && !normIndex.empty();
+  bool hasTex= m_nTex>0 && !texIndex.empty();
+  std::vector<GLfloat> attributes;
+  attributes.reserve(m_positionRemap.size()*5);
+  VertData d;
+  for(size_t f=0; f<m_face.size(); ++f)
+  {
+    uint32_t first=offsets[f];
+    for(uint32_t k=first+1; k+1<offsets[f+1]; ++k)
+    {
+      const uint32_t corners[3]={first,k,k+1};
+      for(auto c : corners)
+      {
+        IndexRef ref(vertIndex[c],hasNormals ? normIndex[c] : 0,hasTex ? texIndex[c] : 0);
+        packVertex(ref,m_verts,m_norm,m_tex,hasNormals,hasTex,d);
+        attributes.insert(attributes.end(),{d.u,d.v,d.nx,d.ny,d.nz});
+      }
+    }
+  }
+  remapPositions(m_verts,m_positionData);
+
+  m_vaoMesh.reset( ngl::VAOFactory::createVAO("multiBufferVAO",m_dataPackType));
+  m_vaoMesh->bind();
+  m_meshSize=m_positionRemap.size();
+  // buffer 0 is the positions (attribute 0) which are re-written each frame
+  m_vaoMesh->setData(MultiBufferVAO::VertexData(m_meshSize*sizeof(Vec3),m_positionData[0].m_x,GL_DYNAMIC_DRAW));
+  m_vaoMesh->setVertexAttributePointer(0,3,GL_FLOAT,0,0);
+  // buffer 1 is the uv (attribute 1) and normal (attribute 2) as createVAO
+  m_vaoMesh->setData(MultiBufferVAO::VertexData(attributes.size()*sizeof(GLfloat),attributes[0],GL_STATIC_DRAW));
+  m_vaoMesh->setVertexAttributePointer(1,2,GL_FLOAT,5*sizeof(GLfloat),0);
+  m_vaoMesh->setVertexAttributePointer(2,3,GL_FLOAT,5*sizeof(GLfloat),2);
+  m_vaoMesh->setNumIndices(m_meshSize);
+  m_vaoMesh->unbind();
+
+  m_vao=true;
+  m_indexed=false;
+  m_positionStream=true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void AbstractMesh::updatePositionStream(const std::vector<Vec3> &_positions) noexcept
+{
+  NGL_ASSERT(m_positionStream && _positions.size()>=m_verts.size());
+  remapPositions(_positions,m_positionData);
+  const GLsizeiptr size=static_cast<GLsizeiptr>(m_positionData.size()*sizeof(Vec3));
+  m_vaoMesh->bind();
+  glBindBuffer(GL_ARRAY_BUFFER, m_vaoMesh->getBufferID(0));
+  // orphan the old storage so we don't have to wait for the GPU to finish drawing the last frame
+  glBufferData(GL_ARRAY_BUFFER,size,nullptr,GL_DYNAMIC_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER,0,size,m_positionData.data());
+  m_vaoMesh->unbind();
+}
 
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -386,223 +924,100 @@ void AbstractMesh::unMapVAO() noexcept
 //----------------------------------------------------------------------------------------------------------------------
 void AbstractMesh::calcDimensions() noexcept
 {
-  // Calculate the center of the object.
-  m_center=0.0;
-  for(auto v : m_verts)
+  // one pass over the verts gives the center and extents and a second the bounding sphere
+  BoundingVolume bounds=calcBoundingVolume(m_verts.data(),m_verts.size());
+  m_center=bounds.m_centroid;
+  m_minX=bounds.m_min.m_x; m_maxX=bounds.m_max.m_x;
+  m_minY=bounds.m_min.m_y; m_maxY=bounds.m_max.m_y;
+  m_minZ=bounds.m_min.m_z; m_maxZ=bounds.m_max.m_z;
+  m_sphereCenter=bounds.m_sphereCenter;
+  m_sphereRadius=bounds.m_sphereRadius;
+  // create a new bbox based on the new object size
+  m_ext.reset(new BBox(m_minX,m_maxX,m_minY,m_maxY,m_minZ,m_maxZ));
+}
+
+bool AbstractMesh::saveNCCABinaryMesh( const std::string &_fname  ) noexcept
+{
+  // the file holds the de-duplicated vertex streams and triangle indices built on the CPU
+  if(m_outIndices.empty())
   {
-    m_center+=v;
+    buildIndexedData();
   }
-  m_center/=m_nVerts;
-  // calculate the extents
-  m_maxX=m_minX=m_center.m_x;
-  m_maxY=m_minY=m_center.m_y;
-  m_maxZ=m_minZ=m_center.m_z;
-
-
-  // Calculate the center of the object.
-  m_center=0.0;
-  for( auto  v :m_verts)
+  if(m_outIndices.empty())
   {
-    m_center+=v;
+    std::cerr<<"no mesh data to save to "<<_fname<<"\n";
+    return false;
   }
-  m_center/=m_nVerts;
-  // calculate the extents
-  m_maxX=m_minX=m_center.m_x;
-  m_maxY=m_minY=m_center.m_y;
-  m_maxZ=m_minZ=m_center.m_z;
-
-  for(auto v : m_verts)
+  bool hasNormals= m_nNorm>0 && !m_face.normalIndices().empty();
+  bool hasTex= m_nTex>0 && !m_face.texIndices().empty();
+  const size_t numVerts=m_indices.size();
+  std::vector<Real> positions(numVerts*3);
+  std::vector<Real> normals(hasNormals ? numVerts*3 : 0);
+  std::vector<Real> uvs(hasTex ? numVerts*2 : 0);
+  for(size_t i=0; i<numVerts; ++i)
   {
-    if     (v.m_x >m_maxX) { m_maxX=v.m_x; }
-    else if(v.m_x <m_minX) { m_minX=v.m_x; }
-    if     (v.m_y >m_maxY) { m_maxY=v.m_y; }
-    else if(v.m_y <m_minY) { m_minY=v.m_y; }
-    if     (v.m_z >m_maxZ) { m_maxZ=v.m_z; }
-    else if(v.m_z <m_minZ) { m_minZ=v.m_z; }
+    const IndexRef &ref=m_indices[i];
+    const Vec3 &p=m_verts[ref.m_v];
+    positions[i*3]=p.m_x;
+    positions[i*3+1]=p.m_y;
+    positions[i*3+2]=p.m_z;
+    if(hasNormals)
+    {
+      const Vec3 &n=m_norm[ref.m_n];
+      normals[i*3]=n.m_x;
+      normals[i*3+1]=n.m_y;
+      normals[i*3+2]=n.m_z;
+    }
+    if(hasTex)
+    {
+      uvs[i*2]=m_tex[ref.m_t].m_x;
+      uvs[i*2+1]=m_tex[ref.m_t].m_y;
+    }
   }
-
-
-
-  // create a new bbox based on the new object size
-  m_ext.reset(new BBox(m_minX,m_maxX,m_minY,m_maxY,m_minZ,m_maxZ));
-
-}
-
-void AbstractMesh::saveNCCABinaryMesh( const std::string &_fname  ) noexcept
-{
-// so basically we need to save all the state data from the abstract mesh
-// then map the vbo on the gpu and dump that in one go, this means we have to
-// call CreateVBO first the Save
-  std::fstream file;
-  file.open(_fname.c_str(),std::ios::out | std::ios::binary);
-  if (!file.is_open())
+  NCCABinMesh::BinaryData data;
+  data.m_positions=positions.data();
+  data.m_normals= hasNormals ? normals.data() : nullptr;
+  data.m_uvs= hasTex ? uvs.data() : nullptr;
+  data.m_numVertices=numVerts;
+  data.m_numIndices=m_outIndices.size();
+  std::vector<GLushort> shortIndices;
+  if(numVerts <= 0xffff+1)
   {
-    std::cerr<<"problems Opening File "<<_fname<<std::endl;
-    return;
+    shortIndices.assign(m_outIndices.begin(),m_outIndices.end());
+    data.m_indices=shortIndices.data();
+    data.m_indexBytes=2;
   }
-  // lets write out our own Magic Number file ID
-  const std::string header("ngl::bin");
-  file.write(header.c_str(),header.length());
-  /// The number of vertices in the object
-  file.write(reinterpret_cast <char *>(&m_nVerts),sizeof(unsigned long int));
-  /// The number of normals in the object
-  file.write(reinterpret_cast <char *>(&m_nNorm),sizeof(unsigned long int));
-
-  /// the number of texture co-ordinates in the object
-  file.write(reinterpret_cast <char *>(&m_nTex),sizeof(unsigned long int));
-
-  /// the number of faces in the object
-  file.write(reinterpret_cast <char *>(&m_nFaces),sizeof(unsigned long int));
-  file.write(reinterpret_cast <char *>(&m_center.m_x),sizeof(Real));
-  file.write(reinterpret_cast <char *>(&m_center.m_y),sizeof(Real));
-  file.write(reinterpret_cast <char *>(&m_center.m_z),sizeof(Real));
-
-  file.write(reinterpret_cast <char *>(&m_texture),sizeof(bool));
-
-  file.write(reinterpret_cast <char *>(&m_maxX),sizeof(Real));
-  file.write(reinterpret_cast <char *>(&m_maxY),sizeof(Real));
-  file.write(reinterpret_cast <char *>(&m_maxZ),sizeof(Real));
-  file.write(reinterpret_cast <char *>(&m_minX),sizeof(Real));
-  file.write(reinterpret_cast <char *>(&m_minY),sizeof(Real));
-  file.write(reinterpret_cast <char *>(&m_minZ),sizeof(Real));
-
-  file.write(reinterpret_cast <char *>(&  m_dataPackType),sizeof(GLuint));
-  file.write(reinterpret_cast <char *>(&  m_indexSize),sizeof(unsigned int));
-  file.write(reinterpret_cast <char *>(&  m_bufferPackSize),sizeof(unsigned int));
-  /// now we can dump the data from the vbo
-  unsigned int size=m_indexSize*m_bufferPackSize*sizeof(GLfloat);
-  std::cout<<"size is"<<size<<std::endl;
-  file.write(reinterpret_cast <char *>(&size),sizeof(unsigned int));
-
-
-  Real *vboMem=this->mapVAOVerts();
-  file.write(reinterpret_cast<char *>(vboMem),size);
-
-  // now write the indices
-  // first the size
-  size=m_outIndices.size();
-  std::cout<<"Size of out indices ="<<size<<std::endl;
-  file.write(reinterpret_cast <char *>(&size),sizeof(unsigned int));
-
-
-  for (auto d : m_outIndices)
+  else
   {
-    file.write(reinterpret_cast <char *>(d),sizeof(unsigned int));
+    data.m_indices=m_outIndices.data();
+    data.m_indexBytes=4;
   }
-
-  file.close();
-  this->unMapVAO();
-
+  data.m_nVerts=m_nVerts;
+  data.m_nNorm=m_nNorm;
+  data.m_nTex=m_nTex;
+  data.m_nFaces=m_nFaces;
+  // work out the extents here as calcDimensions may not have been called
+  BoundingVolume bounds=calcBoundingVolume(m_verts.data(),m_verts.size());
+  data.m_min=bounds.m_min;
+  data.m_max=bounds.m_max;
+  data.m_center=bounds.m_centroid;
+  return NCCABinMesh::writeFile(_fname,data);
 }
 
-/// modified from example in Rick Parent book
-/// Computer Animation Algorithms and Techniques
-/// Morgan Korfman Appendix B
+//----------------------------------------------------------------------------------------------------------------------
 void AbstractMesh::calcBoundingSphere() noexcept
 {
-auto size=m_verts.size();
-if( size <=0 )
-{
-	std::cerr<<"now vertices loaded \n";
-	m_sphereCenter=0;
-	m_sphereRadius=0;
-	return;
-
-}
-// find minimal and maximal extents and indexs into
-// into vert array
-int minXI=0; int minYI=0; int minZI=0;
-int maxXI=0; int maxYI=0; int maxZI=0;
-Real minX=m_verts[0].m_x; Real maxX=m_verts[0].m_x;
-Real minY=m_verts[0].m_y; Real maxY=m_verts[0].m_y;
-Real minZ=m_verts[0].m_z; Real maxZ=m_verts[0].m_z;
-
-for(unsigned int i=0; i<size; ++i)
-{
-  if(m_verts[i].m_x < minX) { minXI=i; minX=m_verts[i].m_x; }
-  if(m_verts[i].m_x > maxX) { maxXI=i; maxX=m_verts[i].m_x; }
-  if(m_verts[i].m_y < minY) { minYI=i; minY=m_verts[i].m_y; }
-  if(m_verts[i].m_y > maxY) { maxYI=i; maxY=m_verts[i].m_y; }
-  if(m_verts[i].m_z < minZ) { minZI=i; minZ=m_verts[i].m_z; }
-  if(m_verts[i].m_z > maxZ) { maxZI=i; maxZ=m_verts[i].m_z; }
-}
-// now we find maximally seperated points from the 3 pairs
-// we will use this to initialise the spheres
-Real dx=m_verts[minXI].m_x-m_verts[maxXI].m_x;
-Real dy=m_verts[minXI].m_y-m_verts[maxXI].m_y;
-Real dz=m_verts[minXI].m_z-m_verts[maxXI].m_z;
-Real diam2x=dx*dx+dy*dy+dz*dz;
-
-dx=m_verts[minYI].m_x-m_verts[maxYI].m_x;
-dy=m_verts[minYI].m_y-m_verts[maxYI].m_y;
-dz=m_verts[minYI].m_z-m_verts[maxYI].m_z;
-Real diam2y=dx*dx+dy*dy+dz*dz;
-
-dx=m_verts[minZI].m_x-m_verts[maxZI].m_x;
-dy=m_verts[minZI].m_y-m_verts[maxZI].m_y;
-dz=m_verts[minZI].m_z-m_verts[maxZI].m_z;
-Real diam2z=dx*dx+dy*dy+dz*dz;
-
-Real diamTwo=diam2x;
-int p1i=minXI;
-int p2i=maxXI;
-if(diam2y>diamTwo){ diamTwo=diam2y; p1i=minYI; p2i=maxYI;}
-if(diam2z>diamTwo){ diamTwo=diam2z; p1i=minZI; p2i=maxZI;}
-// now we can get the center of the sphere as the average
-// of the two points
-m_sphereCenter=(m_verts[p1i]+m_verts[p2i])/2.0;
-// now calculate radius and radius^2 of the initial sphere
-Real radTwo=diamTwo/4.0;
-Real rad=sqrt(radTwo);
-// now check and adjust for outlying points
-Vec3 newCenter;
-Real newRad2;
-Real newRad;
-Real dist2;
-Real dist;
-Real delta;
-
-for (auto v : m_verts)
-{
-  dx=v.m_x-m_sphereCenter.m_x;
-  dy=v.m_y-m_sphereCenter.m_y;
-  dz=v.m_z-m_sphereCenter.m_z;
-  // distance squared of old center to current point
-  dist2=dx*dx+dy*dy+dz*dz;
-  // need to update the sphere if this point is outside the radius
-  if(dist2 > radTwo)
-  {
-    dist=sqrt(dist2);
-    newRad=(rad+dist)/2.0;
-    newRad2=newRad*newRad;
-    delta=dist-newRad;
-    // now compute new center using the weights above
-    newCenter.m_x=(newRad*m_sphereCenter.m_x+delta*v.m_x)/dist;
-    newCenter.m_y=(newRad*m_sphereCenter.m_y+delta*v.m_y)/dist;
-    newCenter.m_z=(newRad*m_sphereCenter.m_z+delta*v.m_z)/dist;
-    // now test to see if we have a fit
-    dx=v.m_x-newCenter.m_x;
-    dy=v.m_y-newCenter.m_y;
-    dz=v.m_z-newCenter.m_z;
-    dist2=dx*dx+dy*dy+dz*dz;
-    if(dist2 > newRad2)
-    {
-      std::cerr<<"something wrong here\n";
-      std::cerr<<"error margin "<<dist2-newRad2<<"\n";
-    }
-    m_sphereCenter=newCenter;
-    rad=newRad;
-    radTwo=rad*rad;
-  } // end if dist2>rad2
-  m_sphereRadius=rad;
-
-}
-
-m_sphereRadius=rad;
-std::cout<<m_sphereCenter<<"  rad "<<m_sphereRadius<<"\n";
-
+  if(m_verts.empty())
+  {
+    std::cerr<<"now vertices loaded \n";
+    m_sphereCenter=0;
+    m_sphereRadius=0;
+    return;
+  }
+  BoundingVolume bounds=calcBoundingVolume(m_verts.data(),m_verts.size());
+  m_sphereCenter=bounds.m_sphereCenter;
+  m_sphereRadius=bounds.m_sphereRadius;
 }
-/// end of citation
 
 
 } //end ngl namespace
@@ -1,4 +1,6 @@
 #include "AbstractVAO.h"
+#include "GLStateCache.h"
+#include "Mat4.h"
 #include <iostream>
 namespace ngl
 {
@@ -22,13 +24,13 @@ namespace ngl
   //----------------------------------------------------------------------------------------------------------------------
   void AbstractVAO::bind()
   {
-    glBindVertexArray(m_id);
+    GLStateCache::instance()->bindVertexArray(m_id);
     m_bound=true;
   }
   //----------------------------------------------------------------------------------------------------------------------
   void AbstractVAO::unbind()
   {
-    glBindVertexArray(0);
+    GLStateCache::instance()->unbindVertexArray();
     m_bound=false;
   }
 
@@ -44,4 +46,67 @@ namespace ngl
     glEnableVertexAttribArray(_id);
   }
 
+  //----------------------------------------------------------------------------------------------------------------------
+  void AbstractVAO::drawInstanced(GLsizei ) const
+  {
+    std::cerr<<"Warning drawInstanced not implemented for this VAO type\n";
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  void AbstractVAO::setInstanceData(unsigned int _buffer, const VertexData &_data)
+  {
+    if(m_bound !=true)
+    {
+      std::cerr<<"Warning trying to set instance data on Unbound VOA\n";
+    }
+    if(_buffer>=m_instanceBuffers.size())
+    {
+      size_t first=m_instanceBuffers.size();
+      m_instanceBuffers.resize(_buffer+1);
+      glGenBuffers(static_cast<GLsizei>(m_instanceBuffers.size()-first),&m_instanceBuffers[first]);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffers[_buffer]);
+    glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>(_data.m_size), &_data.m_data, _data.m_mode);
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  void AbstractVAO::setInstanceAttributePointer(unsigned int _buffer, GLuint _id, GLint _size, GLenum _type,
+                                                GLsizei _stride, unsigned int _dataOffset, GLuint _divisor,
+                                                bool _normalise)
+  {
+    if(_buffer>=m_instanceBuffers.size())
+    {
+      std::cerr<<"Warning instance buffer "<<_buffer<<" has no data set\n";
+      return;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffers[_buffer]);
+    setVertexAttributePointer(_id,_size,_type,_stride,_dataOffset,_normalise);
+    glVertexAttribDivisor(_id,_divisor);
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  void AbstractVAO::setInstanceMat4AttributePointer(unsigned int _buffer, GLuint _id)
+  {
+    for(GLuint c=0; c<4; ++c)
+    {
+      setInstanceAttributePointer(_buffer,_id+c,4,GL_FLOAT,sizeof(Mat4),c*4);
+    }
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  GLuint AbstractVAO::getInstanceBufferID(unsigned int _buffer) const
+  {
+    return _buffer<m_instanceBuffers.size() ? m_instanceBuffers[_buffer] : 0;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  void AbstractVAO::removeInstanceBuffers()
+  {
+    if(!m_instanceBuffers.empty())
+    {
+      glDeleteBuffers(static_cast<GLsizei>(m_instanceBuffers.size()),&m_instanceBuffers[0]);
+      m_instanceBuffers.clear();
+    }
+  }
+
 }
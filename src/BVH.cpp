@@ -0,0 +1,868 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "BVH.h"
+#include "AbstractMesh.h"
+#include "Camera.h"
+#include "Plane.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BVH.cpp
+/// @brief implementation files for BVH class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+
+static_assert(sizeof(BVH::Node)==32,"BVH nodes should be 32 bytes, two to a cache line");
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of bins each axis is split into when looking for the best split
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr int s_numBins=16;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief nodes with more triangles than this are always split
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr uint32_t s_maxLeafSize=8;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the deepest the tree goes, also sets the size of the traversal stacks
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr int s_maxDepth=64;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief sub trees with fewer triangles than this are built on the current thread
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr uint32_t s_minParallelSize=1<<12;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the cost of visiting a node relative to testing a triangle for the SAH
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr Real s_traversalCost=1.0f;
+
+  inline Real dot(const Vec3 &_a, const Vec3 &_b) noexcept
+  {
+    return _a.m_x*_b.m_x+_a.m_y*_b.m_y+_a.m_z*_b.m_z;
+  }
+
+  inline Vec3 cross(const Vec3 &_a, const Vec3 &_b) noexcept
+  {
+    return Vec3(_a.m_y*_b.m_z-_a.m_z*_b.m_y,_a.m_z*_b.m_x-_a.m_x*_b.m_z,_a.m_x*_b.m_y-_a.m_y*_b.m_x);
+  }
+
+  inline Vec3 sub(const Vec3 &_a, const Vec3 &_b) noexcept
+  {
+    return Vec3(_a.m_x-_b.m_x,_a.m_y-_b.m_y,_a.m_z-_b.m_z);
+  }
+
+  inline Vec3 madd(const Vec3 &_a, const Vec3 &_b, Real _s) noexcept
+  {
+    return Vec3(_a.m_x+_b.m_x*_s,_a.m_y+_b.m_y*_s,_a.m_z+_b.m_z*_s);
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief an axis aligned box used while building
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Box
+  {
+    Real m_min[3];
+    Real m_max[3];
+    void reset() noexcept
+    {
+      for(int i=0; i<3; ++i)
+      {
+        m_min[i]=std::numeric_limits<Real>::max();
+        m_max[i]=-std::numeric_limits<Real>::max();
+      }
+    }
+    void grow(const Box &_b) noexcept
+    {
+      for(int i=0; i<3; ++i)
+      {
+        m_min[i]=std::min(m_min[i],_b.m_min[i]);
+        m_max[i]=std::max(m_max[i],_b.m_max[i]);
+      }
+    }
+    void grow(const Real *_p) noexcept
+    {
+      for(int i=0; i<3; ++i)
+      {
+        m_min[i]=std::min(m_min[i],_p[i]);
+        m_max[i]=std::max(m_max[i],_p[i]);
+      }
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief half the surface area, which is all the SAH needs
+    //----------------------------------------------------------------------------------------------------------------------
+    Real area() const noexcept
+    {
+      Real x=m_max[0]-m_min[0];
+      Real y=m_max[1]-m_min[1];
+      Real z=m_max[2]-m_min[2];
+      return x*y+y*z+z*x;
+    }
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief builds the tree into a node array with room for the largest tree possible (2n-1 nodes). A node with
+  /// n triangles owns the 2n-1 slots from its own, so the left child is the next slot and the right child follows
+  /// the left's range. This lets sub trees be built on different threads without sharing anything, the gaps left
+  /// by leaves with more than one triangle are squeezed out afterwards.
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Builder
+  {
+    const std::vector<Box> &m_bounds;
+    const std::vector<Vec3> &m_centroids;
+    std::vector<uint32_t> &m_order;
+    std::vector<BVH::Node> &m_nodes;
+
+    int binOf(Real _c, Real _min, Real _scale) const noexcept
+    {
+      return std::min(s_numBins-1,static_cast<int>((_c-_min)*_scale));
+    }
+
+    void build(uint32_t _node, uint32_t _begin, uint32_t _end, int _depth, unsigned int _numThreads) noexcept
+    {
+      Box bounds;
+      Box centroids;
+      bounds.reset();
+      centroids.reset();
+      for(uint32_t i=_begin; i<_end; ++i)
+      {
+        bounds.grow(m_bounds[m_order[i]]);
+        centroids.grow(m_centroids[m_order[i]].m_openGL.data());
+      }
+      BVH::Node &node=m_nodes[_node];
+      for(int i=0; i<3; ++i)
+      {
+        node.m_min[i]=bounds.m_min[i];
+        node.m_max[i]=bounds.m_max[i];
+      }
+      uint32_t n=_end-_begin;
+      if(n==1 || _depth>=s_maxDepth)
+      {
+        node.m_offset=_begin;
+        node.m_count=n;
+        return;
+      }
+
+      // find the cheapest split between bins on each axis
+      Real bestCost=std::numeric_limits<Real>::max();
+      int bestAxis=-1;
+      int bestSplit=0;
+      for(int axis=0; axis<3; ++axis)
+      {
+        Real extent=centroids.m_max[axis]-centroids.m_min[axis];
+        if(extent<=0.0f)
+        {
+          continue;
+        }
+        Real scale=s_numBins/extent;
+        Box binBounds[s_numBins];
+        uint32_t binCount[s_numBins]={0};
+        for(auto &b : binBounds)
+        {
+          b.reset();
+        }
+        for(uint32_t i=_begin; i<_end; ++i)
+        {
+          uint32_t t=m_order[i];
+          int b=binOf(m_centroids[t].m_openGL[axis],centroids.m_min[axis],scale);
+          binBounds[b].grow(m_bounds[t]);
+          ++binCount[b];
+        }
+        // sweep from the right to get the cost of everything right of each split
+        Real rightCost[s_numBins];
+        Box right;
+        right.reset();
+        uint32_t count=0;
+        for(int b=s_numBins-1; b>0; --b)
+        {
+          right.grow(binBounds[b]);
+          count+=binCount[b];
+          rightCost[b]= count ? right.area()*count : 0.0f;
+        }
+        Box left;
+        left.reset();
+        count=0;
+        for(int split=1; split<s_numBins; ++split)
+        {
+          left.grow(binBounds[split-1]);
+          count+=binCount[split-1];
+          if(count==0 || count==n)
+          {
+            continue;
+          }
+          Real cost=left.area()*count+rightCost[split];
+          if(cost<bestCost)
+          {
+            bestCost=cost;
+            bestAxis=axis;
+            bestSplit=split;
+          }
+        }
+      }
+
+      Real area=bounds.area();
+      Real leafCost=static_cast<Real>(n);
+      Real splitCost= area>0.0f ? s_traversalCost+bestCost/area : s_traversalCost+n;
+      if(n<=s_maxLeafSize && (bestAxis<0 || leafCost<=splitCost))
+      {
+        node.m_offset=_begin;
+        node.m_count=n;
+        return;
+      }
+
+      uint32_t mid;
+      if(bestAxis>=0)
+      {
+        Real scale=s_numBins/(centroids.m_max[bestAxis]-centroids.m_min[bestAxis]);
+        Real min=centroids.m_min[bestAxis];
+        auto first=m_order.begin()+_begin;
+        mid=_begin+static_cast<uint32_t>(std::partition(first,m_order.begin()+_end,[&](uint32_t _t)
+        {
+          return binOf(m_centroids[_t].m_openGL[bestAxis],min,scale)<bestSplit;
+        })-first);
+      }
+      else
+      {
+        // all the centroids are in the same place so any split is as good as another
+        mid=_begin+n/2;
+      }
+
+      uint32_t leftNode=_node+1;
+      uint32_t rightNode=_node+2*(mid-_begin);
+      node.m_offset=rightNode;
+      node.m_count=0;
+      if(_numThreads>1 && n>=s_minParallelSize)
+      {
+        unsigned int leftThreads=_numThreads/2;
+        std::thread t(&Builder::build,this,leftNode,_begin,mid,_depth+1,leftThreads);
+        build(rightNode,mid,_end,_depth+1,_numThreads-leftThreads);
+        t.join();
+      }
+      else
+      {
+        build(leftNode,_begin,mid,_depth+1,1);
+        build(rightNode,mid,_end,_depth+1,1);
+      }
+    }
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief copy the reachable nodes depth first into o_nodes, removing the gaps from the build
+  //----------------------------------------------------------------------------------------------------------------------
+  void flatten(const std::vector<BVH::Node> &_nodes, uint32_t _index, std::vector<BVH::Node> &o_nodes) noexcept
+  {
+    const BVH::Node &node=_nodes[_index];
+    size_t at=o_nodes.size();
+    o_nodes.push_back(node);
+    if(node.m_count==0)
+    {
+      flatten(_nodes,_index+1,o_nodes);
+      o_nodes[at].m_offset=static_cast<uint32_t>(o_nodes.size());
+      flatten(_nodes,node.m_offset,o_nodes);
+    }
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a ray with the reciprocal direction for the slab tests
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Ray
+  {
+    Vec3 m_origin;
+    Vec3 m_dir;
+    Real m_inv[3];
+    Ray(const Vec3 &_origin, const Vec3 &_dir) noexcept : m_origin(_origin), m_dir(_dir)
+    {
+      for(int i=0; i<3; ++i)
+      {
+        // a zero component gives +/- infinity which the slab test handles
+        m_inv[i]=1.0f/_dir.m_openGL[i];
+      }
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief does the ray hit the node's box before _tMax, o_t is where it enters the box
+    //----------------------------------------------------------------------------------------------------------------------
+    bool hit(const BVH::Node &_node, Real _tMax, Real &o_t) const noexcept
+    {
+      Real tNear=0.0f;
+      Real tFar=_tMax;
+      for(int i=0; i<3; ++i)
+      {
+        Real t0=(_node.m_min[i]-m_origin.m_openGL[i])*m_inv[i];
+        Real t1=(_node.m_max[i]-m_origin.m_openGL[i])*m_inv[i];
+        if(t0>t1)
+        {
+          std::swap(t0,t1);
+        }
+        // written so a NaN (origin on the slab with a zero direction) doesn't reject the box
+        tNear= t0>tNear ? t0 : tNear;
+        tFar= t1<tFar ? t1 : tFar;
+      }
+      o_t=tNear;
+      return tNear<=tFar;
+    }
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief Moller Trumbore ray triangle test, both sides of the triangle count
+  //----------------------------------------------------------------------------------------------------------------------
+  inline bool hitTriangle(const Ray &_ray, const Vec3 &_v0, const Vec3 &_e1, const Vec3 &_e2, Real _tMax,
+                          Real &o_t, Real &o_u, Real &o_v) noexcept
+  {
+    Vec3 p=cross(_ray.m_dir,_e2);
+    Real det=dot(_e1,p);
+    if(std::fabs(det)<std::numeric_limits<Real>::min())
+    {
+      return false;
+    }
+    Real inv=1.0f/det;
+    Vec3 s=sub(_ray.m_origin,_v0);
+    Real u=dot(s,p)*inv;
+    if(u<0.0f || u>1.0f)
+    {
+      return false;
+    }
+    Vec3 q=cross(s,_e1);
+    Real v=dot(_ray.m_dir,q)*inv;
+    if(v<0.0f || u+v>1.0f)
+    {
+      return false;
+    }
+    Real t=dot(_e2,q)*inv;
+    if(t<=0.0f || t>=_tMax)
+    {
+      return false;
+    }
+    o_t=t;
+    o_u=u;
+    o_v=v;
+    return true;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief separating axis test of a triangle against a box of half size _h centered on the origin, the
+  /// triangle is already moved relative to the box center
+  //----------------------------------------------------------------------------------------------------------------------
+  bool triangleBoxOverlap(const Vec3 &_v0, const Vec3 &_v1, const Vec3 &_v2, const Vec3 &_h) noexcept
+  {
+    // the box face normals
+    for(int i=0; i<3; ++i)
+    {
+      Real lo=std::min(std::min(_v0.m_openGL[i],_v1.m_openGL[i]),_v2.m_openGL[i]);
+      Real hi=std::max(std::max(_v0.m_openGL[i],_v1.m_openGL[i]),_v2.m_openGL[i]);
+      if(lo>_h.m_openGL[i] || hi<-_h.m_openGL[i])
+      {
+        return false;
+      }
+    }
+    auto separated=[&](const Vec3 &_axis)
+    {
+      Real p0=dot(_v0,_axis);
+      Real p1=dot(_v1,_axis);
+      Real p2=dot(_v2,_axis);
+      Real r=_h.m_x*std::fabs(_axis.m_x)+_h.m_y*std::fabs(_axis.m_y)+_h.m_z*std::fabs(_axis.m_z);
+      return std::min(std::min(p0,p1),p2)>r || std::max(std::max(p0,p1),p2)<-r;
+    };
+    // the triangle normal
+    Vec3 e0=sub(_v1,_v0);
+    Vec3 e1=sub(_v2,_v1);
+    Vec3 e2=sub(_v0,_v2);
+    if(separated(cross(e0,e1)))
+    {
+      return false;
+    }
+    // the triangle edges crossed with the box axes
+    for(const Vec3 *e : {&e0,&e1,&e2})
+    {
+      if(separated(Vec3(0.0f,-e->m_z,e->m_y)) || separated(Vec3(e->m_z,0.0f,-e->m_x)) ||
+         separated(Vec3(-e->m_y,e->m_x,0.0f)))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the closest point on a triangle to _p, from Ericson Real-Time Collision Detection 5.1.5
+  //----------------------------------------------------------------------------------------------------------------------
+  Vec3 closestPoint(const Vec3 &_p, const Vec3 &_a, const Vec3 &_ab, const Vec3 &_ac) noexcept
+  {
+    Vec3 ap=sub(_p,_a);
+    Real d1=dot(_ab,ap);
+    Real d2=dot(_ac,ap);
+    if(d1<=0.0f && d2<=0.0f)
+    {
+      return _a;
+    }
+    Vec3 b=_a+_ab;
+    Vec3 bp=sub(_p,b);
+    Real d3=dot(_ab,bp);
+    Real d4=dot(_ac,bp);
+    if(d3>=0.0f && d4<=d3)
+    {
+      return b;
+    }
+    Real vc=d1*d4-d3*d2;
+    if(vc<=0.0f && d1>=0.0f && d3<=0.0f)
+    {
+      return madd(_a,_ab,d1/(d1-d3));
+    }
+    Vec3 c=_a+_ac;
+    Vec3 cp=sub(_p,c);
+    Real d5=dot(_ab,cp);
+    Real d6=dot(_ac,cp);
+    if(d6>=0.0f && d5<=d6)
+    {
+      return c;
+    }
+    Real vb=d5*d2-d1*d6;
+    if(vb<=0.0f && d2>=0.0f && d6<=0.0f)
+    {
+      return madd(_a,_ac,d2/(d2-d6));
+    }
+    Real va=d3*d6-d5*d4;
+    if(va<=0.0f && (d4-d3)>=0.0f && (d5-d6)>=0.0f)
+    {
+      return madd(b,sub(c,b),(d4-d3)/((d4-d3)+(d5-d6)));
+    }
+    Real denom=1.0f/(va+vb+vc);
+    return madd(madd(_a,_ab,vb*denom),_ac,vc*denom);
+  }
+
+  bool boxesOverlap(const BVH::Node &_node, const Vec3 &_min, const Vec3 &_max) noexcept
+  {
+    for(int i=0; i<3; ++i)
+    {
+      if(_node.m_min[i]>_max.m_openGL[i] || _node.m_max[i]<_min.m_openGL[i])
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool boxSphereOverlap(const BVH::Node &_node, const Vec3 &_center, Real _radius2) noexcept
+  {
+    Real dist2=0.0f;
+    for(int i=0; i<3; ++i)
+    {
+      Real c=_center.m_openGL[i];
+      Real d= c<_node.m_min[i] ? _node.m_min[i]-c : (c>_node.m_max[i] ? c-_node.m_max[i] : 0.0f);
+      dist2+=d*d;
+    }
+    return dist2<=_radius2;
+  }
+
+  void sortUnique(std::vector<uint32_t> &io_ids) noexcept
+  {
+    std::sort(io_ids.begin(),io_ids.end());
+    io_ids.erase(std::unique(io_ids.begin(),io_ids.end()),io_ids.end());
+  }
+} // end anonymous namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+bool BVH::build(const std::vector<Vec3> &_verts, const std::vector<uint32_t> &_indices, unsigned int _numThreads) noexcept
+{
+  clear();
+  if(_indices.size()%3 !=0)
+  {
+    std::cerr<<"BVH::build the number of indices must be a multiple of 3\n";
+    return false;
+  }
+  std::vector<Vec3> corners;
+  corners.reserve(_indices.size());
+  for(auto i : _indices)
+  {
+    if(i>=_verts.size())
+    {
+      std::cerr<<"BVH::build index "<<i<<" out of range\n";
+      return false;
+    }
+    corners.push_back(_verts[i]);
+  }
+  std::vector<uint32_t> ids(_indices.size()/3);
+  for(size_t i=0; i<ids.size(); ++i)
+  {
+    ids[i]=static_cast<uint32_t>(i);
+  }
+  buildTriangles(corners,ids,_numThreads);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool BVH::build(const AbstractMesh &_mesh, unsigned int _numThreads) noexcept
+{
+  clear();
+  const FaceList &faces=_mesh.getFaceList();
+  const std::vector<Vec3> &verts=_mesh.getVertices();
+  std::vector<Vec3> corners;
+  std::vector<uint32_t> ids;
+  corners.reserve(faces.numIndices()*3);
+  ids.reserve(faces.numIndices());
+  for(size_t f=0; f<faces.size(); ++f)
+  {
+    FaceList::Face face=faces[f];
+    const uint32_t *v=face.verts();
+    for(uint32_t i=0; i<face.numVerts(); ++i)
+    {
+      if(v[i]>=verts.size())
+      {
+        std::cerr<<"BVH::build face "<<f<<" has a vertex index out of range\n";
+        return false;
+      }
+    }
+    // polygons are split into a fan around the first vertex
+    for(uint32_t i=2; i<face.numVerts(); ++i)
+    {
+      corners.push_back(verts[v[0]]);
+      corners.push_back(verts[v[i-1]]);
+      corners.push_back(verts[v[i]]);
+      ids.push_back(static_cast<uint32_t>(f));
+    }
+  }
+  if(ids.empty())
+  {
+    std::cerr<<"BVH::build the mesh has no faces\n";
+    return false;
+  }
+  buildTriangles(corners,ids,_numThreads);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void BVH::buildTriangles(const std::vector<Vec3> &_corners, const std::vector<uint32_t> &_ids, unsigned int _numThreads) noexcept
+{
+  size_t n=_ids.size();
+  if(n==0)
+  {
+    return;
+  }
+  if(_numThreads==0)
+  {
+    _numThreads=std::max(1u,std::thread::hardware_concurrency());
+  }
+  std::vector<Box> bounds(n);
+  std::vector<Vec3> centroids(n);
+  std::vector<uint32_t> order(n);
+  for(size_t i=0; i<n; ++i)
+  {
+    bounds[i].reset();
+    for(int c=0; c<3; ++c)
+    {
+      bounds[i].grow(_corners[i*3+c].m_openGL.data());
+    }
+    centroids[i].set((bounds[i].m_min[0]+bounds[i].m_max[0])*0.5f,(bounds[i].m_min[1]+bounds[i].m_max[1])*0.5f,
+                     (bounds[i].m_min[2]+bounds[i].m_max[2])*0.5f);
+    order[i]=static_cast<uint32_t>(i);
+  }
+  std::vector<Node> nodes(2*n-1);
+  Builder builder={bounds,centroids,order,nodes};
+  builder.build(0,0,static_cast<uint32_t>(n),0,_numThreads);
+  m_nodes.reserve(nodes.size());
+  flatten(nodes,0,m_nodes);
+  m_nodes.shrink_to_fit();
+
+  // copy the triangles into leaf order so each leaf reads one contiguous block
+  m_triangles.resize(n);
+  m_ids.resize(n);
+  for(size_t i=0; i<n; ++i)
+  {
+    const Vec3 *v=&_corners[order[i]*3];
+    m_triangles[i].m_v0=v[0];
+    m_triangles[i].m_e1=sub(v[1],v[0]);
+    m_triangles[i].m_e2=sub(v[2],v[0]);
+    m_ids[i]=_ids[order[i]];
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void BVH::clear() noexcept
+{
+  m_nodes.clear();
+  m_triangles.clear();
+  m_ids.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool BVH::intersect(const Vec3 &_origin, const Vec3 &_dir, BVHHit &o_hit, Real _tMax) const noexcept
+{
+  Ray ray(_origin,_dir);
+  Real tNear;
+  if(m_nodes.empty() || !ray.hit(m_nodes[0],_tMax,tNear))
+  {
+    return false;
+  }
+  bool found=false;
+  uint32_t stack[s_maxDepth];
+  Real stackT[s_maxDepth];
+  int top=0;
+  uint32_t index=0;
+  for(;;)
+  {
+    const Node &node=m_nodes[index];
+    if(node.m_count!=0)
+    {
+      for(uint32_t i=node.m_offset; i<node.m_offset+node.m_count; ++i)
+      {
+        const Triangle &tri=m_triangles[i];
+        if(hitTriangle(ray,tri.m_v0,tri.m_e1,tri.m_e2,_tMax,o_hit.m_t,o_hit.m_u,o_hit.m_v))
+        {
+          _tMax=o_hit.m_t;
+          o_hit.m_id=m_ids[i];
+          found=true;
+        }
+      }
+    }
+    else
+    {
+      // visit the nearer child first and come back to the other if it is still closer than the best hit
+      Real tLeft,tRight;
+      bool left=ray.hit(m_nodes[index+1],_tMax,tLeft);
+      bool right=ray.hit(m_nodes[node.m_offset],_tMax,tRight);
+      if(left && right)
+      {
+        if(tLeft<=tRight)
+        {
+          stackT[top]=tRight;
+          stack[top++]=node.m_offset;
+          index=index+1;
+        }
+        else
+        {
+          stackT[top]=tLeft;
+          stack[top++]=index+1;
+          index=node.m_offset;
+        }
+        continue;
+      }
+      else if(left || right)
+      {
+        index= left ? index+1 : node.m_offset;
+        continue;
+      }
+    }
+    // pop the next node that could still have a closer hit
+    do
+    {
+      if(top==0)
+      {
+        return found;
+      }
+      --top;
+    } while(stackT[top]>=_tMax);
+    index=stack[top];
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool BVH::intersectAny(const Vec3 &_origin, const Vec3 &_dir, Real _tMax) const noexcept
+{
+  Ray ray(_origin,_dir);
+  Real tNear;
+  if(m_nodes.empty() || !ray.hit(m_nodes[0],_tMax,tNear))
+  {
+    return false;
+  }
+  uint32_t stack[s_maxDepth];
+  int top=0;
+  uint32_t index=0;
+  Real t,u,v;
+  for(;;)
+  {
+    const Node &node=m_nodes[index];
+    if(node.m_count!=0)
+    {
+      for(uint32_t i=node.m_offset; i<node.m_offset+node.m_count; ++i)
+      {
+        const Triangle &tri=m_triangles[i];
+        if(hitTriangle(ray,tri.m_v0,tri.m_e1,tri.m_e2,_tMax,t,u,v))
+        {
+          return true;
+        }
+      }
+    }
+    else
+    {
+      bool left=ray.hit(m_nodes[index+1],_tMax,t);
+      bool right=ray.hit(m_nodes[node.m_offset],_tMax,t);
+      if(left && right)
+      {
+        stack[top++]=node.m_offset;
+        index=index+1;
+        continue;
+      }
+      else if(left || right)
+      {
+        index= left ? index+1 : node.m_offset;
+        continue;
+      }
+    }
+    if(top==0)
+    {
+      return false;
+    }
+    index=stack[--top];
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void BVH::overlapBox(const Vec3 &_min, const Vec3 &_max, std::vector<uint32_t> &o_ids) const noexcept
+{
+  o_ids.clear();
+  if(m_nodes.empty())
+  {
+    return;
+  }
+  Vec3 center=(_min+_max)*0.5f;
+  Vec3 half=sub(_max,_min)*0.5f;
+  uint32_t stack[s_maxDepth+1];
+  int top=0;
+  stack[top++]=0;
+  while(top>0)
+  {
+    const Node &node=m_nodes[stack[--top]];
+    if(!boxesOverlap(node,_min,_max))
+    {
+      continue;
+    }
+    if(node.m_count!=0)
+    {
+      for(uint32_t i=node.m_offset; i<node.m_offset+node.m_count; ++i)
+      {
+        const Triangle &tri=m_triangles[i];
+        Vec3 v0=sub(tri.m_v0,center);
+        if(triangleBoxOverlap(v0,v0+tri.m_e1,v0+tri.m_e2,half))
+        {
+          o_ids.push_back(m_ids[i]);
+        }
+      }
+    }
+    else
+    {
+      stack[top++]=node.m_offset;
+      stack[top++]=static_cast<uint32_t>(&node-m_nodes.data())+1;
+    }
+  }
+  sortUnique(o_ids);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void BVH::overlapSphere(const Vec3 &_center, Real _radius, std::vector<uint32_t> &o_ids) const noexcept
+{
+  o_ids.clear();
+  if(m_nodes.empty())
+  {
+    return;
+  }
+  Real radius2=_radius*_radius;
+  uint32_t stack[s_maxDepth+1];
+  int top=0;
+  stack[top++]=0;
+  while(top>0)
+  {
+    const Node &node=m_nodes[stack[--top]];
+    if(!boxSphereOverlap(node,_center,radius2))
+    {
+      continue;
+    }
+    if(node.m_count!=0)
+    {
+      for(uint32_t i=node.m_offset; i<node.m_offset+node.m_count; ++i)
+      {
+        const Triangle &tri=m_triangles[i];
+        Vec3 d=sub(closestPoint(_center,tri.m_v0,tri.m_e1,tri.m_e2),_center);
+        if(dot(d,d)<=radius2)
+        {
+          o_ids.push_back(m_ids[i]);
+        }
+      }
+    }
+    else
+    {
+      stack[top++]=node.m_offset;
+      stack[top++]=static_cast<uint32_t>(&node-m_nodes.data())+1;
+    }
+  }
+  sortUnique(o_ids);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void BVH::inFrustum(const Camera &_camera, std::vector<uint32_t> &o_ids) const noexcept
+{
+  o_ids.clear();
+  if(m_nodes.empty())
+  {
+    return;
+  }
+  // the stack holds the node and whether it is already known to be inside the frustum
+  uint32_t stack[s_maxDepth+1];
+  bool stackInside[s_maxDepth+1];
+  int top=0;
+  stack[top]=0;
+  stackInside[top++]=false;
+  while(top>0)
+  {
+    --top;
+    const Node &node=m_nodes[stack[top]];
+    bool inside=stackInside[top];
+    if(!inside)
+    {
+      CameraIntercept c=_camera.boxInFrustum(node.m_min,node.m_max);
+      if(c==CameraIntercept::OUTSIDE)
+      {
+        continue;
+      }
+      inside= c==CameraIntercept::INSIDE;
+    }
+    if(node.m_count!=0)
+    {
+      for(uint32_t i=node.m_offset; i<node.m_offset+node.m_count; ++i)
+      {
+        if(!inside)
+        {
+          const Triangle &tri=m_triangles[i];
+          Box b;
+          b.reset();
+          Vec3 v1=tri.m_v0+tri.m_e1;
+          Vec3 v2=tri.m_v0+tri.m_e2;
+          b.grow(tri.m_v0.m_openGL.data());
+          b.grow(v1.m_openGL.data());
+          b.grow(v2.m_openGL.data());
+          if(_camera.boxInFrustum(b.m_min,b.m_max)==CameraIntercept::OUTSIDE)
+          {
+            continue;
+          }
+        }
+        o_ids.push_back(m_ids[i]);
+      }
+    }
+    else
+    {
+      stack[top]=node.m_offset;
+      stackInside[top++]=inside;
+      stack[top]=static_cast<uint32_t>(&node-m_nodes.data())+1;
+      stackInside[top++]=inside;
+    }
+  }
+  sortUnique(o_ids);
+}
+
+} // end namespace ngl
+//----------------------------------------------------------------------------------------------------------------------
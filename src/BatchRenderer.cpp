@@ -0,0 +1,414 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "BatchRenderer.h"
+#include "AbstractMesh.h"
+#include "GLStateCache.h"
+#include "ShaderLib.h"
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BatchRenderer.cpp
+/// @brief implementation files for BatchRenderer class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+// the floats per vertex in the u,v,nx,ny,nz,x,y,z layout of vertData
+constexpr size_t c_vertexSize=8;
+
+//----------------------------------------------------------------------------------------------------------------------
+BatchRenderer::BatchRenderer() noexcept
+{
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+BatchRenderer::~BatchRenderer() noexcept
+{
+  if(m_vao!=0)
+  {
+    glDeleteVertexArrays(1,&m_vao);
+    GLStateCache::instance()->vertexArrayDeleted(m_vao);
+    GLuint buffers[4]={m_vertexBuffer,m_indexBuffer,m_transformBuffer,m_commandBuffer};
+    glDeleteBuffers(4,buffers);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+int BatchRenderer::addPrimitive(const std::string &_name, const Real *_data, size_t _numVerts, GLenum _mode,
+                                const GLuint *_indices, size_t _numIndices) noexcept
+{
+  if(m_names.find(_name)!=m_names.end())
+  {
+    std::cerr<<"BatchRenderer primitive "<<_name<<" already added\n";
+    return -1;
+  }
+  if(_data==nullptr || _numVerts==0)
+  {
+    std::cerr<<"BatchRenderer primitive "<<_name<<" has no vertices\n";
+    return -1;
+  }
+  Primitive p;
+  p.m_name=_name;
+  p.m_mode=_mode;
+  p.m_indexed= _indices!=nullptr && _numIndices>0;
+  GLuint firstVertex=static_cast<GLuint>(m_vertices.size()/c_vertexSize);
+  m_vertices.insert(m_vertices.end(),_data,_data+_numVerts*c_vertexSize);
+  if(p.m_indexed)
+  {
+    // the indices are kept relative to the primitive and offset by the base vertex when drawn
+    p.m_first=static_cast<GLuint>(m_indices.size());
+    p.m_count=static_cast<GLuint>(_numIndices);
+    p.m_baseVertex=static_cast<GLint>(firstVertex);
+    m_indices.insert(m_indices.end(),_indices,_indices+_numIndices);
+  }
+  else
+  {
+    p.m_first=firstVertex;
+    p.m_count=static_cast<GLuint>(_numVerts);
+    p.m_baseVertex=0;
+  }
+  int id=static_cast<int>(m_primitives.size());
+  m_primitives.push_back(p);
+  m_names[_name]=id;
+  m_arenaDirty=true;
+  return id;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+int BatchRenderer::addPrimitive(const std::string &_name, const std::vector<vertData> &_data, GLenum _mode) noexcept
+{
+  return addPrimitive(_name,_data.empty() ? nullptr : &_data[0].u,_data.size(),_mode);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+int BatchRenderer::addFromPrimitives(const std::string &_name) noexcept
+{
+  AbstractVAO *vao=VAOPrimitives::instance()->getVAOFromName(_name);
+  if(vao==nullptr)
+  {
+    std::cerr<<"BatchRenderer primitive "<<_name<<" not found in VAOPrimitives\n";
+    return -1;
+  }
+  // VAOPrimitives keeps no copy of the data so read it back from the buffer
+  size_t numVerts=vao->numIndices();
+  std::vector<Real> data(numVerts*c_vertexSize);
+  glBindBuffer(GL_ARRAY_BUFFER,vao->getBufferID(0));
+  glGetBufferSubData(GL_ARRAY_BUFFER,0,static_cast<GLsizeiptr>(data.size()*sizeof(Real)),data.data());
+  glBindBuffer(GL_ARRAY_BUFFER,0);
+  return addPrimitive(_name,data.data(),numVerts,vao->getMode());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+int BatchRenderer::addMesh(const std::string &_name, AbstractMesh &_mesh) noexcept
+{
+  std::vector<Real> data;
+  _mesh.getIndexedVertexData(data);
+  const std::vector<GLuint> &indices=_mesh.getOutIndices();
+  return addPrimitive(_name,data.data(),data.size()/c_vertexSize,GL_TRIANGLES,indices.data(),indices.size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+int BatchRenderer::getPrimitiveID(const std::string &_name) const noexcept
+{
+  auto p=m_names.find(_name);
+  return p!=m_names.end() ? p->second : -1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void BatchRenderer::begin() noexcept
+{
+  m_instanceProgram.clear();
+  m_instancePrimitive.clear();
+  m_instanceTransform.clear();
+  m_programs.clear();
+  m_lastProgramIndex=UINT32_MAX;
+  m_built=false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void BatchRenderer::add(GLuint _program, int _primitive, const Mat4 &_transform) noexcept
+{
+  if(_primitive<0 || static_cast<size_t>(_primitive)>=m_primitives.size())
+  {
+    std::cerr<<"BatchRenderer unknown primitive id "<<_primitive<<"\n";
+    return;
+  }
+  if(_program!=m_lastProgram || m_lastProgramIndex==UINT32_MAX)
+  {
+    auto program=std::find(m_programs.begin(),m_programs.end(),_program);
+    m_lastProgramIndex=static_cast<uint32_t>(program-m_programs.begin());
+    if(program==m_programs.end())
+    {
+      m_programs.push_back(_program);
+    }
+    m_lastProgram=_program;
+  }
+  m_instanceProgram.push_back(m_lastProgramIndex);
+  m_instancePrimitive.push_back(static_cast<uint32_t>(_primitive));
+  m_instanceTransform.push_back(_transform);
+  m_built=false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool BatchRenderer::add(const std::string &_shader, const std::string &_primitive, const Mat4 &_transform) noexcept
+{
+  int primitive=getPrimitiveID(_primitive);
+  if(primitive<0)
+  {
+    std::cerr<<"BatchRenderer primitive "<<_primitive<<" not known\n";
+    return false;
+  }
+  add(ShaderLib::instance()->getProgramID(_shader),primitive,_transform);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void BatchRenderer::build() noexcept
+{
+  m_built=true;
+  m_sorted.clear();
+  m_arraysCommands.clear();
+  m_elementsCommands.clear();
+  m_groups.clear();
+  size_t numInstances=m_instancePrimitive.size();
+  if(numInstances==0)
+  {
+    return;
+  }
+  // within a program the primitives drawn with the same mode are next to each other so they share a group
+  size_t numPrimitives=m_primitives.size();
+  std::vector<uint32_t> primitiveOrder(numPrimitives);
+  std::iota(primitiveOrder.begin(),primitiveOrder.end(),0);
+  std::stable_sort(primitiveOrder.begin(),primitiveOrder.end(),[this](uint32_t _a, uint32_t _b)
+  {
+    const Primitive &a=m_primitives[_a];
+    const Primitive &b=m_primitives[_b];
+    return a.m_indexed!=b.m_indexed ? a.m_indexed<b.m_indexed : a.m_mode<b.m_mode;
+  });
+  std::vector<uint32_t> primitiveRank(numPrimitives);
+  for(uint32_t r=0; r<numPrimitives; ++r)
+  {
+    primitiveRank[primitiveOrder[r]]=r;
+  }
+  size_t numPrograms=m_programs.size();
+  std::vector<uint32_t> programOrder(numPrograms);
+  std::iota(programOrder.begin(),programOrder.end(),0);
+  std::sort(programOrder.begin(),programOrder.end(),[this](uint32_t _a, uint32_t _b)
+  {
+    return m_programs[_a]<m_programs[_b];
+  });
+  std::vector<uint32_t> programRank(numPrograms);
+  for(uint32_t r=0; r<numPrograms; ++r)
+  {
+    programRank[programOrder[r]]=r;
+  }
+  // counting sort of the instances into one bucket per (program, primitive), a bucket becomes a command
+  size_t numBuckets=numPrograms*numPrimitives;
+  m_bucketStart.assign(numBuckets+1,0);
+  for(size_t i=0; i<numInstances; ++i)
+  {
+    ++m_bucketStart[programRank[m_instanceProgram[i]]*numPrimitives+primitiveRank[m_instancePrimitive[i]]+1];
+  }
+  for(size_t b=1; b<=numBuckets; ++b)
+  {
+    m_bucketStart[b]+=m_bucketStart[b-1];
+  }
+  std::vector<uint32_t> next(m_bucketStart.begin(),m_bucketStart.end()-1);
+  m_sorted.resize(numInstances);
+  for(size_t i=0; i<numInstances; ++i)
+  {
+    size_t bucket=programRank[m_instanceProgram[i]]*numPrimitives+primitiveRank[m_instancePrimitive[i]];
+    m_sorted[next[bucket]++]=m_instanceTransform[i];
+  }
+  for(size_t b=0; b<numBuckets; ++b)
+  {
+    GLuint count=m_bucketStart[b+1]-m_bucketStart[b];
+    if(count==0)
+    {
+      continue;
+    }
+    GLuint program=m_programs[programOrder[b/numPrimitives]];
+    const Primitive &p=m_primitives[primitiveOrder[b%numPrimitives]];
+    if(m_groups.empty() || m_groups.back().m_program!=program || m_groups.back().m_mode!=p.m_mode ||
+       m_groups.back().m_indexed!=p.m_indexed)
+    {
+      size_t first= p.m_indexed ? m_elementsCommands.size() : m_arraysCommands.size();
+      m_groups.push_back({program,p.m_mode,p.m_indexed,first,0});
+    }
+    if(p.m_indexed)
+    {
+      m_elementsCommands.push_back({p.m_count,count,p.m_first,p.m_baseVertex,m_bucketStart[b]});
+    }
+    else
+    {
+      m_arraysCommands.push_back({p.m_count,count,p.m_first,m_bucketStart[b]});
+    }
+    ++m_groups.back().m_numCommands;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool BatchRenderer::multiDraw() const noexcept
+{
+  return m_multiDraw && (GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void BatchRenderer::createGLObjects() noexcept
+{
+  glGenVertexArrays(1,&m_vao);
+  GLuint buffers[4];
+  glGenBuffers(4,buffers);
+  m_vertexBuffer=buffers[0];
+  m_indexBuffer=buffers[1];
+  m_transformBuffer=buffers[2];
+  m_commandBuffer=buffers[3];
+  GLStateCache::instance()->bindVertexArray(m_vao);
+  // the same attributes as VAOPrimitives, 0 vertex, 1 uv, 2 normal
+  GLsizei stride=static_cast<GLsizei>(c_vertexSize*sizeof(Real));
+  glBindBuffer(GL_ARRAY_BUFFER,m_vertexBuffer);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,stride,reinterpret_cast<const GLvoid *>(5*sizeof(Real)));
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(1,2,GL_FLOAT,GL_FALSE,stride,nullptr);
+  glEnableVertexAttribArray(2);
+  glVertexAttribPointer(2,3,GL_FLOAT,GL_FALSE,stride,reinterpret_cast<const GLvoid *>(2*sizeof(Real)));
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m_indexBuffer);
+  // a mat4 takes four attributes, one per column, stepped once per instance
+  for(GLuint c=0; c<4; ++c)
+  {
+    glEnableVertexAttribArray(instanceTransformAttribute+c);
+    glVertexAttribDivisor(instanceTransformAttribute+c,1);
+  }
+  setTransformPointers(0);
+  m_arenaDirty=true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void BatchRenderer::setTransformPointers(GLuint _baseInstance) noexcept
+{
+  glBindBuffer(GL_ARRAY_BUFFER,m_transformBuffer);
+  for(GLuint c=0; c<4; ++c)
+  {
+    size_t offset=_baseInstance*sizeof(Mat4)+c*4*sizeof(Real);
+    glVertexAttribPointer(instanceTransformAttribute+c,4,GL_FLOAT,GL_FALSE,sizeof(Mat4),
+                          reinterpret_cast<const GLvoid *>(offset));
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void BatchRenderer::draw() noexcept
+{
+  if(!m_built)
+  {
+    build();
+  }
+  if(m_sorted.empty())
+  {
+    return;
+  }
+  if(m_vao==0)
+  {
+    createGLObjects();
+  }
+  GLStateCache *cache=GLStateCache::instance();
+  cache->bindVertexArray(m_vao);
+  if(m_arenaDirty)
+  {
+    glBindBuffer(GL_ARRAY_BUFFER,m_vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>(m_vertices.size()*sizeof(Real)),m_vertices.data(),
+                 GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m_indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,static_cast<GLsizeiptr>(m_indices.size()*sizeof(GLuint)),m_indices.data(),
+                 GL_STATIC_DRAW);
+    m_stats.m_bytesUploaded+=m_vertices.size()*sizeof(Real)+m_indices.size()*sizeof(GLuint);
+    m_arenaDirty=false;
+  }
+  // a new store each frame so the transforms of the last one can still be read by the GPU
+  size_t transformBytes=m_sorted.size()*sizeof(Mat4);
+  glBindBuffer(GL_ARRAY_BUFFER,m_transformBuffer);
+  glBufferData(GL_ARRAY_BUFFER,static_cast<GLsizeiptr>(transformBytes),m_sorted.data(),GL_STREAM_DRAW);
+  m_stats.m_bytesUploaded+=transformBytes;
+  m_stats.m_instances+=m_sorted.size();
+  m_stats.m_commands+=m_arraysCommands.size()+m_elementsCommands.size();
+  bool multi=multiDraw();
+  // the elements commands follow the arrays commands in the one buffer
+  size_t arraysBytes=m_arraysCommands.size()*sizeof(DrawArraysIndirectCommand);
+  if(multi)
+  {
+    size_t elementsBytes=m_elementsCommands.size()*sizeof(DrawElementsIndirectCommand);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER,m_commandBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER,static_cast<GLsizeiptr>(arraysBytes+elementsBytes),nullptr,GL_STREAM_DRAW);
+    if(arraysBytes!=0)
+    {
+      glBufferSubData(GL_DRAW_INDIRECT_BUFFER,0,static_cast<GLsizeiptr>(arraysBytes),m_arraysCommands.data());
+    }
+    if(elementsBytes!=0)
+    {
+      glBufferSubData(GL_DRAW_INDIRECT_BUFFER,static_cast<GLintptr>(arraysBytes),
+                      static_cast<GLsizeiptr>(elementsBytes),m_elementsCommands.data());
+    }
+    m_stats.m_bytesUploaded+=arraysBytes+elementsBytes;
+  }
+  for(auto &g : m_groups)
+  {
+    cache->useProgram(g.m_program);
+    if(multi)
+    {
+      GLsizei count=static_cast<GLsizei>(g.m_numCommands);
+      if(g.m_indexed)
+      {
+        size_t offset=arraysBytes+g.m_firstCommand*sizeof(DrawElementsIndirectCommand);
+        glMultiDrawElementsIndirect(g.m_mode,GL_UNSIGNED_INT,reinterpret_cast<const GLvoid *>(offset),count,0);
+      }
+      else
+      {
+        size_t offset=g.m_firstCommand*sizeof(DrawArraysIndirectCommand);
+        glMultiDrawArraysIndirect(g.m_mode,reinterpret_cast<const GLvoid *>(offset),count,0);
+      }
+      ++m_stats.m_drawCalls;
+      continue;
+    }
+    // no base instance so point the transforms at the first instance of each command
+    for(size_t c=g.m_firstCommand; c<g.m_firstCommand+g.m_numCommands; ++c)
+    {
+      if(g.m_indexed)
+      {
+        const DrawElementsIndirectCommand &command=m_elementsCommands[c];
+        setTransformPointers(command.m_baseInstance);
+        glDrawElementsInstancedBaseVertex(g.m_mode,static_cast<GLsizei>(command.m_count),GL_UNSIGNED_INT,
+                                          reinterpret_cast<const GLvoid *>(command.m_firstIndex*sizeof(GLuint)),
+                                          static_cast<GLsizei>(command.m_instanceCount),command.m_baseVertex);
+      }
+      else
+      {
+        const DrawArraysIndirectCommand &command=m_arraysCommands[c];
+        setTransformPointers(command.m_baseInstance);
+        glDrawArraysInstanced(g.m_mode,static_cast<GLint>(command.m_first),static_cast<GLsizei>(command.m_count),
+                              static_cast<GLsizei>(command.m_instanceCount));
+      }
+      ++m_stats.m_drawCalls;
+    }
+  }
+  if(!multi)
+  {
+    setTransformPointers(0);
+  }
+  cache->unbindVertexArray();
+}
+
+} // end namespace ngl
@@ -0,0 +1,245 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "BatchTransform.h"
+#include "SIMD.h"
+#include <cmath>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BatchTransform.cpp
+/// @brief implementation files for the batch transform functions
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+
+static_assert(sizeof(Vec3)==3*sizeof(Real),"Vec3 arrays are accessed as packed x,y,z");
+static_assert(sizeof(Vec4)==4*sizeof(Real),"Vec4 arrays are accessed as packed x,y,z,w");
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the upper 3x3 of the matrix and the translation (zero for directions and normals) so the
+  /// three kinds of transform can share the same loops
+  //----------------------------------------------------------------------------------------------------------------------
+  struct Affine
+  {
+    Real m[3][3];
+    Real t[3];
+  };
+
+  Affine affine(const Mat4 &_m, bool _translate) noexcept
+  {
+    Affine a;
+    for(int y=0; y<3; ++y)
+    {
+      for(int x=0; x<3; ++x)
+      {
+        a.m[y][x]=_m.m_m[y][x];
+      }
+      a.t[y]= _translate ? _m.m_m[3][y] : 0.0f;
+    }
+    return a;
+  }
+
+  Affine affine(const Mat3 &_m) noexcept
+  {
+    Affine a;
+    for(int y=0; y<3; ++y)
+    {
+      for(int x=0; x<3; ++x)
+      {
+        a.m[y][x]=_m.m_m[y][x];
+      }
+      a.t[y]=0.0f;
+    }
+    return a;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief transform one x,y,z, used for the scalar version and the elements left over from the SIMD loops
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void transformOne(const Affine &_a, bool _normalise, Real _x, Real _y, Real _z, Real &o_x, Real &o_y, Real &o_z) noexcept
+  {
+    Real x=_x*_a.m[0][0] + _y*_a.m[1][0] + _z*_a.m[2][0] + _a.t[0];
+    Real y=_x*_a.m[0][1] + _y*_a.m[1][1] + _z*_a.m[2][1] + _a.t[1];
+    Real z=_x*_a.m[0][2] + _y*_a.m[1][2] + _z*_a.m[2][2] + _a.t[2];
+    if(_normalise)
+    {
+      Real len=x*x+y*y+z*z;
+      Real inv= len>0.0f ? 1.0f/std::sqrt(len) : 0.0f;
+      x*=inv;
+      y*=inv;
+      z*=inv;
+    }
+    o_x=x;
+    o_y=y;
+    o_z=z;
+  }
+
+#if defined(NGL_SIMD)
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the Affine with each element broadcast to a register
+  //----------------------------------------------------------------------------------------------------------------------
+  struct AffineSIMD
+  {
+    simd::float4 m[3][3];
+    simd::float4 t[3];
+    explicit AffineSIMD(const Affine &_a) noexcept
+    {
+      for(int y=0; y<3; ++y)
+      {
+        for(int x=0; x<3; ++x)
+        {
+          m[y][x]=simd::splat(_a.m[y][x]);
+        }
+        t[y]=simd::splat(_a.t[y]);
+      }
+    }
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief transform four x,y,z at once
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void transformFour(const AffineSIMD &_a, bool _normalise, simd::float4 &io_x, simd::float4 &io_y, simd::float4 &io_z) noexcept
+  {
+    simd::float4 x=simd::madd(io_x,_a.m[0][0],simd::madd(io_y,_a.m[1][0],simd::madd(io_z,_a.m[2][0],_a.t[0])));
+    simd::float4 y=simd::madd(io_x,_a.m[0][1],simd::madd(io_y,_a.m[1][1],simd::madd(io_z,_a.m[2][1],_a.t[1])));
+    simd::float4 z=simd::madd(io_x,_a.m[0][2],simd::madd(io_y,_a.m[1][2],simd::madd(io_z,_a.m[2][2],_a.t[2])));
+    if(_normalise)
+    {
+      simd::float4 inv=simd::safeInvSqrt(simd::madd(x,x,simd::madd(y,y,simd::mul(z,z))));
+      x=simd::mul(x,inv);
+      y=simd::mul(y,inv);
+      z=simd::mul(z,inv);
+    }
+    io_x=x;
+    io_y=y;
+    io_z=z;
+  }
+#endif
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief transform packed x,y,z triples, four at a time through SIMD and the rest one at a time
+  //----------------------------------------------------------------------------------------------------------------------
+  void transformAoS(const Affine &_a, bool _normalise, const Real *_in, Real *o_out, size_t _n) noexcept
+  {
+    size_t i=0;
+#if defined(NGL_SIMD)
+    AffineSIMD a(_a);
+    // all four inputs are loaded before any are stored so working in place is fine
+    for(; i+4<=_n; i+=4)
+    {
+      simd::float4 x,y,z;
+      simd::load3(_in+i*3,x,y,z);
+      transformFour(a,_normalise,x,y,z);
+      simd::store3(o_out+i*3,x,y,z);
+    }
+#endif
+    for(; i<_n; ++i)
+    {
+      const Real *in=_in+i*3;
+      Real *out=o_out+i*3;
+      transformOne(_a,_normalise,in[0],in[1],in[2],out[0],out[1],out[2]);
+    }
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief transform separate x,y,z arrays
+  //----------------------------------------------------------------------------------------------------------------------
+  void transformSoA(const Affine &_a, bool _normalise, const Real *_x, const Real *_y, const Real *_z,
+                    Real *o_x, Real *o_y, Real *o_z, size_t _n) noexcept
+  {
+    size_t i=0;
+#if defined(NGL_SIMD)
+    AffineSIMD a(_a);
+    for(; i+4<=_n; i+=4)
+    {
+      simd::float4 x=simd::load(_x+i);
+      simd::float4 y=simd::load(_y+i);
+      simd::float4 z=simd::load(_z+i);
+      transformFour(a,_normalise,x,y,z);
+      simd::store(o_x+i,x);
+      simd::store(o_y+i,y);
+      simd::store(o_z+i,z);
+    }
+#endif
+    for(; i<_n; ++i)
+    {
+      transformOne(_a,_normalise,_x[i],_y[i],_z[i],o_x[i],o_y[i],o_z[i]);
+    }
+  }
+} // end anonymous namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+void transformPoints(const Mat4 &_m, const Vec3 *_in, Vec3 *o_out, size_t _n) noexcept
+{
+  transformAoS(affine(_m,true),false,reinterpret_cast<const Real *>(_in),reinterpret_cast<Real *>(o_out),_n);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void transformDirections(const Mat4 &_m, const Vec3 *_in, Vec3 *o_out, size_t _n) noexcept
+{
+  transformAoS(affine(_m,false),false,reinterpret_cast<const Real *>(_in),reinterpret_cast<Real *>(o_out),_n);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void transformNormals(const Mat3 &_m, const Vec3 *_in, Vec3 *o_out, size_t _n, bool _normalise) noexcept
+{
+  transformAoS(affine(_m),_normalise,reinterpret_cast<const Real *>(_in),reinterpret_cast<Real *>(o_out),_n);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void transformVectors(const Mat4 &_m, const Vec4 *_in, Vec4 *o_out, size_t _n) noexcept
+{
+#if defined(NGL_SIMD)
+  simd::float4 r0=simd::load(&_m.m_openGL[0]);
+  simd::float4 r1=simd::load(&_m.m_openGL[4]);
+  simd::float4 r2=simd::load(&_m.m_openGL[8]);
+  simd::float4 r3=simd::load(&_m.m_openGL[12]);
+  for(size_t i=0; i<_n; ++i)
+  {
+    simd::store(&o_out[i].m_openGL[0],simd::combine(simd::load(&_in[i].m_openGL[0]),r0,r1,r2,r3));
+  }
+#else
+  for(size_t i=0; i<_n; ++i)
+  {
+    o_out[i]=_in[i]*_m;
+  }
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void transformPoints(const Mat4 &_m, const Real *_x, const Real *_y, const Real *_z,
+                     Real *o_x, Real *o_y, Real *o_z, size_t _n) noexcept
+{
+  transformSoA(affine(_m,true),false,_x,_y,_z,o_x,o_y,o_z,_n);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void transformDirections(const Mat4 &_m, const Real *_x, const Real *_y, const Real *_z,
+                         Real *o_x, Real *o_y, Real *o_z, size_t _n) noexcept
+{
+  transformSoA(affine(_m,false),false,_x,_y,_z,o_x,o_y,o_z,_n);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void transformNormals(const Mat3 &_m, const Real *_x, const Real *_y, const Real *_z,
+                      Real *o_x, Real *o_y, Real *o_z, size_t _n, bool _normalise) noexcept
+{
+  transformSoA(affine(_m),_normalise,_x,_y,_z,o_x,o_y,o_z,_n);
+}
+
+} // end namespace ngl
+//----------------------------------------------------------------------------------------------------------------------
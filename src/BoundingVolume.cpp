@@ -0,0 +1,269 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "BoundingVolume.h"
+#include "SIMD.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file BoundingVolume.cpp
+/// @brief implementation files for the bounding volume functions
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+
+static_assert(sizeof(Vec3)==3*sizeof(Real),"Vec3 arrays are accessed as packed x,y,z");
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief below this many points per thread it isn't worth starting threads
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t s_minPointsPerThread=1<<16;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the float sums are moved into doubles after this many points so large meshes keep their precision
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t s_sumBlock=1024;
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief access to packed x,y,z points
+  //----------------------------------------------------------------------------------------------------------------------
+  struct PackedPoints
+  {
+    const Real *m_p;
+    void get(size_t _i, Real &o_x, Real &o_y, Real &o_z) const noexcept
+    {
+      o_x=m_p[_i*3]; o_y=m_p[_i*3+1]; o_z=m_p[_i*3+2];
+    }
+#if defined(NGL_SIMD)
+    void get4(size_t _i, simd::float4 &o_x, simd::float4 &o_y, simd::float4 &o_z) const noexcept
+    {
+      simd::load3(m_p+_i*3,o_x,o_y,o_z);
+    }
+#endif
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief access to points held as separate x,y,z arrays
+  //----------------------------------------------------------------------------------------------------------------------
+  struct SplitPoints
+  {
+    const Real *m_x;
+    const Real *m_y;
+    const Real *m_z;
+    void get(size_t _i, Real &o_x, Real &o_y, Real &o_z) const noexcept
+    {
+      o_x=m_x[_i]; o_y=m_y[_i]; o_z=m_z[_i];
+    }
+#if defined(NGL_SIMD)
+    void get4(size_t _i, simd::float4 &o_x, simd::float4 &o_y, simd::float4 &o_z) const noexcept
+    {
+      o_x=simd::load(m_x+_i); o_y=simd::load(m_y+_i); o_z=simd::load(m_z+_i);
+    }
+#endif
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the box and sum of one range of points
+  //----------------------------------------------------------------------------------------------------------------------
+  struct BoxSum
+  {
+    Real m_min[3];
+    Real m_max[3];
+    double m_sum[3];
+  };
+
+  template <class Points>
+  BoxSum boxSum(const Points &_p, size_t _begin, size_t _end) noexcept
+  {
+    BoxSum res;
+    Real x,y,z;
+    _p.get(_begin,x,y,z);
+    res.m_min[0]=res.m_max[0]=x;
+    res.m_min[1]=res.m_max[1]=y;
+    res.m_min[2]=res.m_max[2]=z;
+    res.m_sum[0]=res.m_sum[1]=res.m_sum[2]=0.0;
+    size_t i=_begin;
+#if defined(NGL_SIMD)
+    if(_end-_begin>=4)
+    {
+      simd::float4 lo[3]={simd::splat(x),simd::splat(y),simd::splat(z)};
+      simd::float4 hi[3]={lo[0],lo[1],lo[2]};
+      while(i+4<=_end)
+      {
+        simd::float4 sum[3]={simd::splat(0.0f),simd::splat(0.0f),simd::splat(0.0f)};
+        size_t blockEnd=std::min(_end,i+s_sumBlock);
+        for(; i+4<=blockEnd; i+=4)
+        {
+          simd::float4 v[3];
+          _p.get4(i,v[0],v[1],v[2]);
+          for(int c=0; c<3; ++c)
+          {
+            lo[c]=simd::min(lo[c],v[c]);
+            hi[c]=simd::max(hi[c],v[c]);
+            sum[c]=simd::add(sum[c],v[c]);
+          }
+        }
+        for(int c=0; c<3; ++c)
+        {
+          Real s[4];
+          simd::store(s,sum[c]);
+          res.m_sum[c]+=double(s[0])+s[1]+s[2]+s[3];
+        }
+      }
+      for(int c=0; c<3; ++c)
+      {
+        Real l[4],h[4];
+        simd::store(l,lo[c]);
+        simd::store(h,hi[c]);
+        res.m_min[c]=std::min(std::min(l[0],l[1]),std::min(l[2],l[3]));
+        res.m_max[c]=std::max(std::max(h[0],h[1]),std::max(h[2],h[3]));
+      }
+    }
+#endif
+    Real v[3];
+    for(; i<_end; ++i)
+    {
+      _p.get(i,v[0],v[1],v[2]);
+      for(int c=0; c<3; ++c)
+      {
+        res.m_min[c]=std::min(res.m_min[c],v[c]);
+        res.m_max[c]=std::max(res.m_max[c],v[c]);
+        res.m_sum[c]+=v[c];
+      }
+    }
+    return res;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the largest squared distance of one range of points from two candidate sphere centers
+  //----------------------------------------------------------------------------------------------------------------------
+  template <class Points>
+  void maxDistance(const Points &_p, size_t _begin, size_t _end, const Vec3 &_c0, const Vec3 &_c1, Real &o_d0, Real &o_d1) noexcept
+  {
+    Real d0=0.0f;
+    Real d1=0.0f;
+    size_t i=_begin;
+#if defined(NGL_SIMD)
+    if(_end-_begin>=4)
+    {
+      simd::float4 c0[3]={simd::splat(_c0.m_x),simd::splat(_c0.m_y),simd::splat(_c0.m_z)};
+      simd::float4 c1[3]={simd::splat(_c1.m_x),simd::splat(_c1.m_y),simd::splat(_c1.m_z)};
+      simd::float4 max0=simd::splat(0.0f);
+      simd::float4 max1=max0;
+      for(; i+4<=_end; i+=4)
+      {
+        simd::float4 v[3];
+        _p.get4(i,v[0],v[1],v[2]);
+        simd::float4 e0=simd::sub(v[0],c0[0]);
+        simd::float4 e1=simd::sub(v[0],c1[0]);
+        simd::float4 dist0=simd::mul(e0,e0);
+        simd::float4 dist1=simd::mul(e1,e1);
+        for(int c=1; c<3; ++c)
+        {
+          e0=simd::sub(v[c],c0[c]);
+          e1=simd::sub(v[c],c1[c]);
+          dist0=simd::madd(e0,e0,dist0);
+          dist1=simd::madd(e1,e1,dist1);
+        }
+        max0=simd::max(max0,dist0);
+        max1=simd::max(max1,dist1);
+      }
+      Real m0[4],m1[4];
+      simd::store(m0,max0);
+      simd::store(m1,max1);
+      d0=std::max(std::max(m0[0],m0[1]),std::max(m0[2],m0[3]));
+      d1=std::max(std::max(m1[0],m1[1]),std::max(m1[2],m1[3]));
+    }
+#endif
+    for(; i<_end; ++i)
+    {
+      Real x,y,z;
+      _p.get(i,x,y,z);
+      d0=std::max(d0,(x-_c0.m_x)*(x-_c0.m_x)+(y-_c0.m_y)*(y-_c0.m_y)+(z-_c0.m_z)*(z-_c0.m_z));
+      d1=std::max(d1,(x-_c1.m_x)*(x-_c1.m_x)+(y-_c1.m_y)*(y-_c1.m_y)+(z-_c1.m_z)*(z-_c1.m_z));
+    }
+    o_d0=d0;
+    o_d1=d1;
+  }
+
+  template <class Points>
+  BoundingVolume calcBounds(const Points &_p, size_t _n, unsigned int _numThreads) noexcept
+  {
+    BoundingVolume res;
+    if(_n==0)
+    {
+      return res;
+    }
+    // chunks are a multiple of 4 points so only the last has a scalar remainder
+    size_t numChunks=chunkCount(_n,s_minPointsPerThread,_numThreads);
+    size_t chunkSize=((_n+numChunks-1)/numChunks+3) & ~size_t(3);
+    numChunks=(_n+chunkSize-1)/chunkSize;
+
+    std::vector<BoxSum> boxes(numChunks);
+    forEachChunk(numChunks,[&](size_t _c)
+    {
+      boxes[_c]=boxSum(_p,_c*chunkSize,std::min(_n,(_c+1)*chunkSize));
+    });
+    BoxSum total=boxes[0];
+    for(size_t c=1; c<numChunks; ++c)
+    {
+      for(int i=0; i<3; ++i)
+      {
+        total.m_min[i]=std::min(total.m_min[i],boxes[c].m_min[i]);
+        total.m_max[i]=std::max(total.m_max[i],boxes[c].m_max[i]);
+        total.m_sum[i]+=boxes[c].m_sum[i];
+      }
+    }
+    res.m_min.set(total.m_min[0],total.m_min[1],total.m_min[2]);
+    res.m_max.set(total.m_max[0],total.m_max[1],total.m_max[2]);
+    res.m_centroid.set(static_cast<Real>(total.m_sum[0]/_n),static_cast<Real>(total.m_sum[1]/_n),
+                       static_cast<Real>(total.m_sum[2]/_n));
+
+    // the middle of the box is best for evenly spread points, the centroid can be better when
+    // most points are bunched up, so measure both and keep the smaller sphere
+    Vec3 boxCenter=(res.m_min+res.m_max)*0.5f;
+    std::vector<Real> dist0(numChunks),dist1(numChunks);
+    forEachChunk(numChunks,[&](size_t _c)
+    {
+      maxDistance(_p,_c*chunkSize,std::min(_n,(_c+1)*chunkSize),boxCenter,res.m_centroid,dist0[_c],dist1[_c]);
+    });
+    Real d0=*std::max_element(dist0.begin(),dist0.end());
+    Real d1=*std::max_element(dist1.begin(),dist1.end());
+    res.m_sphereCenter= d0<=d1 ? boxCenter : res.m_centroid;
+    res.m_sphereRadius=std::sqrt(std::min(d0,d1));
+    return res;
+  }
+} // end anonymous namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+BoundingVolume calcBoundingVolume(const Vec3 *_points, size_t _n, unsigned int _numThreads) noexcept
+{
+  PackedPoints p={reinterpret_cast<const Real *>(_points)};
+  return calcBounds(p,_n,_numThreads);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+BoundingVolume calcBoundingVolume(const Vec3Array &_points, unsigned int _numThreads) noexcept
+{
+  SplitPoints p={_points.x(),_points.y(),_points.z()};
+  return calcBounds(p,_points.size(),_numThreads);
+}
+
+} // end namespace ngl
+//----------------------------------------------------------------------------------------------------------------------
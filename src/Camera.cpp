@@ -21,6 +21,9 @@
 #include "SimpleVAO.h"
 #include <vector>
 #include "Vec3.h"
+#include "SIMD.h"
+#include "ParallelFor.h"
+#include <algorithm>
 #include <iostream>
 #include <cmath>
 #include <memory>
@@ -497,6 +500,246 @@ CameraIntercept Camera::boxInFrustum(const AABB &b) const noexcept
 
 /// end citation http://www.lighthouse3d.com/opengl/viewfrustum/index.php?intro
 
+CameraIntercept Camera::boxInFrustum(const Real *_min, const Real *_max) const noexcept
+{
+  CameraIntercept result=CameraIntercept::INSIDE;
+  for(int p=0; p<6; ++p)
+  {
+    const Vec3 n=m_planes[p].getNormal();
+    const Real d=m_planes[p].getD();
+    // the corners furthest along and furthest against the normal
+    Real far=d+n.m_x*(n.m_x>0.0f ? _max[0] : _min[0])+n.m_y*(n.m_y>0.0f ? _max[1] : _min[1])+
+             n.m_z*(n.m_z>0.0f ? _max[2] : _min[2]);
+    if(far<0.0f)
+    {
+      return CameraIntercept::OUTSIDE;
+    }
+    Real near=d+n.m_x*(n.m_x>0.0f ? _min[0] : _max[0])+n.m_y*(n.m_y>0.0f ? _min[1] : _max[1])+
+              n.m_z*(n.m_z>0.0f ? _min[2] : _max[2]);
+    if(near<0.0f)
+    {
+      result=CameraIntercept::INTERSECT;
+    }
+  }
+  return result;
+}
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief below this many objects per thread it isn't worth starting threads
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t s_minObjectsPerThread=1<<14;
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the frustum planes as separate arrays of the normal and d so they can be broadcast
+  //----------------------------------------------------------------------------------------------------------------------
+  struct FrustumPlanes
+  {
+    Real m_nx[6];
+    Real m_ny[6];
+    Real m_nz[6];
+    Real m_d[6];
+    explicit FrustumPlanes(const Plane *_planes) noexcept
+    {
+      for(int i=0; i<6; ++i)
+      {
+        Vec3 n=_planes[i].getNormal();
+        m_nx[i]=n.m_x;
+        m_ny[i]=n.m_y;
+        m_nz[i]=n.m_z;
+        m_d[i]=_planes[i].getD();
+      }
+    }
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a sphere is outside if it is further than its radius behind any plane
+  //----------------------------------------------------------------------------------------------------------------------
+  struct SphereTest
+  {
+    FrustumPlanes m_planes;
+    const Real *m_x;
+    const Real *m_y;
+    const Real *m_z;
+    const Real *m_radius;
+
+    bool visible(size_t _i) const noexcept
+    {
+      for(int p=0; p<6; ++p)
+      {
+        if(m_planes.m_d[p]+m_planes.m_nx[p]*m_x[_i]+m_planes.m_ny[p]*m_y[_i]+m_planes.m_nz[p]*m_z[_i] < -m_radius[_i])
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+#if defined(NGL_SIMD)
+    /// @brief bit j is set if sphere _i+j is visible
+    int visible4(size_t _i) const noexcept
+    {
+      simd::float4 x=simd::load(m_x+_i);
+      simd::float4 y=simd::load(m_y+_i);
+      simd::float4 z=simd::load(m_z+_i);
+      simd::float4 nearest;
+      for(int p=0; p<6; ++p)
+      {
+        simd::float4 dist=simd::madd(x,simd::splat(m_planes.m_nx[p]),
+                          simd::madd(y,simd::splat(m_planes.m_ny[p]),
+                          simd::madd(z,simd::splat(m_planes.m_nz[p]),simd::splat(m_planes.m_d[p]))));
+        nearest= p==0 ? dist : simd::min(nearest,dist);
+      }
+      simd::float4 r=simd::load(m_radius+_i);
+      return ~simd::lessMask(nearest,simd::sub(simd::splat(0.0f),r)) & 0xf;
+    }
+#endif
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a box is outside if its corner furthest along the normal (the p vertex) is behind any plane
+  //----------------------------------------------------------------------------------------------------------------------
+  struct BoxTest
+  {
+    FrustumPlanes m_planes;
+    // for each plane the component arrays that make up the p vertex
+    const Real *m_px[6];
+    const Real *m_py[6];
+    const Real *m_pz[6];
+
+    BoxTest(const Plane *_planes, const Real *_minX, const Real *_minY, const Real *_minZ,
+            const Real *_maxX, const Real *_maxY, const Real *_maxZ) noexcept :
+      m_planes(_planes)
+    {
+      for(int p=0; p<6; ++p)
+      {
+        m_px[p]= m_planes.m_nx[p]>0.0f ? _maxX : _minX;
+        m_py[p]= m_planes.m_ny[p]>0.0f ? _maxY : _minY;
+        m_pz[p]= m_planes.m_nz[p]>0.0f ? _maxZ : _minZ;
+      }
+    }
+
+    bool visible(size_t _i) const noexcept
+    {
+      for(int p=0; p<6; ++p)
+      {
+        if(m_planes.m_d[p]+m_planes.m_nx[p]*m_px[p][_i]+m_planes.m_ny[p]*m_py[p][_i]+m_planes.m_nz[p]*m_pz[p][_i] < 0.0f)
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+#if defined(NGL_SIMD)
+    /// @brief bit j is set if box _i+j is visible
+    int visible4(size_t _i) const noexcept
+    {
+      simd::float4 nearest;
+      for(int p=0; p<6; ++p)
+      {
+        simd::float4 dist=simd::madd(simd::load(m_px[p]+_i),simd::splat(m_planes.m_nx[p]),
+                          simd::madd(simd::load(m_py[p]+_i),simd::splat(m_planes.m_ny[p]),
+                          simd::madd(simd::load(m_pz[p]+_i),simd::splat(m_planes.m_nz[p]),simd::splat(m_planes.m_d[p]))));
+        nearest= p==0 ? dist : simd::min(nearest,dist);
+      }
+      return ~simd::lessMask(nearest,simd::splat(0.0f)) & 0xf;
+    }
+#endif
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief fill the visibility mask, split into ranges of whole mask words so each thread writes its own words
+  //----------------------------------------------------------------------------------------------------------------------
+  template <class Test>
+  void cull(const Test &_test, size_t _n, uint32_t *o_mask, unsigned int _numThreads) noexcept
+  {
+    size_t numWords=(_n+31)/32;
+    size_t numChunks=chunkCount(_n,s_minObjectsPerThread,_numThreads);
+    size_t wordsPerChunk=(numWords+numChunks-1)/numChunks;
+    numChunks= numWords==0 ? 0 : (numWords+wordsPerChunk-1)/wordsPerChunk;
+    forEachChunk(numChunks,[&](size_t _c)
+    {
+      size_t endWord=std::min(numWords,(_c+1)*wordsPerChunk);
+      for(size_t w=_c*wordsPerChunk; w<endWord; ++w)
+      {
+        size_t begin=w*32;
+        size_t end=std::min(_n,begin+32);
+        uint32_t bits=0;
+        size_t i=begin;
+#if defined(NGL_SIMD)
+        for(; i+4<=end; i+=4)
+        {
+          bits|=static_cast<uint32_t>(_test.visible4(i)) << (i-begin);
+        }
+#endif
+        for(; i<end; ++i)
+        {
+          if(_test.visible(i))
+          {
+            bits|=1u << (i-begin);
+          }
+        }
+        o_mask[w]=bits;
+      }
+    });
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert a visibility mask to a list of indices
+  //----------------------------------------------------------------------------------------------------------------------
+  void compact(const std::vector<uint32_t> &_mask, std::vector<uint32_t> &o_visible) noexcept
+  {
+    o_visible.clear();
+    for(size_t w=0; w<_mask.size(); ++w)
+    {
+      uint32_t index=static_cast<uint32_t>(w*32);
+      for(uint32_t bits=_mask[w]; bits!=0; bits>>=1, ++index)
+      {
+        if(bits & 1)
+        {
+          o_visible.push_back(index);
+        }
+      }
+    }
+  }
+} // end anonymous namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+void Camera::spheresInFrustum(const Real *_x, const Real *_y, const Real *_z, const Real *_radius, size_t _n,
+                              uint32_t *o_mask, unsigned int _numThreads) const noexcept
+{
+  SphereTest test={FrustumPlanes(m_planes),_x,_y,_z,_radius};
+  cull(test,_n,o_mask,_numThreads);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Camera::spheresInFrustum(const Real *_x, const Real *_y, const Real *_z, const Real *_radius, size_t _n,
+                              std::vector<uint32_t> &o_visible, unsigned int _numThreads) const noexcept
+{
+  std::vector<uint32_t> mask((_n+31)/32);
+  spheresInFrustum(_x,_y,_z,_radius,_n,mask.data(),_numThreads);
+  compact(mask,o_visible);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Camera::boxesInFrustum(const Real *_minX, const Real *_minY, const Real *_minZ,
+                            const Real *_maxX, const Real *_maxY, const Real *_maxZ, size_t _n,
+                            uint32_t *o_mask, unsigned int _numThreads) const noexcept
+{
+  BoxTest test(m_planes,_minX,_minY,_minZ,_maxX,_maxY,_maxZ);
+  cull(test,_n,o_mask,_numThreads);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Camera::boxesInFrustum(const Real *_minX, const Real *_minY, const Real *_minZ,
+                            const Real *_maxX, const Real *_maxY, const Real *_maxZ, size_t _n,
+                            std::vector<uint32_t> &o_visible, unsigned int _numThreads) const noexcept
+{
+  std::vector<uint32_t> mask((_n+31)/32);
+  boxesInFrustum(_minX,_minY,_minZ,_maxX,_maxY,_maxZ,_n,mask.data(),_numThreads);
+  compact(mask,o_visible);
+}
+
 
 } // end namespace ngl
 
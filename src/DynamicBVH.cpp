@@ -0,0 +1,654 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "DynamicBVH.h"
+#include "BBox.h"
+#include "Camera.h"
+#include "Mat4.h"
+#include "Plane.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file DynamicBVH.cpp
+/// @brief implementation files for DynamicBVH class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief how far ahead the fat boxes are stretched in the direction of the displacement passed to move
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr Real s_displacementScale=2.0f;
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief a fat box more than this many margins bigger than needed is shrunk when the object is moved
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr Real s_maxSlack=4.0f;
+
+  inline Real surfaceArea(const Real *_min, const Real *_max) noexcept
+  {
+    Real dx=_max[0]-_min[0];
+    Real dy=_max[1]-_min[1];
+    Real dz=_max[2]-_min[2];
+    return 2.0f*(dx*dy+dy*dz+dz*dx);
+  }
+
+  inline Real mergedArea(const DynamicBVH::Node &_a, const DynamicBVH::Node &_b) noexcept
+  {
+    Real mn[3],mx[3];
+    for(int i=0; i<3; ++i)
+    {
+      mn[i]=std::min(_a.m_min[i],_b.m_min[i]);
+      mx[i]=std::max(_a.m_max[i],_b.m_max[i]);
+    }
+    return surfaceArea(mn,mx);
+  }
+
+  inline void merge(const DynamicBVH::Node &_a, const DynamicBVH::Node &_b, DynamicBVH::Node &o_res) noexcept
+  {
+    for(int i=0; i<3; ++i)
+    {
+      o_res.m_min[i]=std::min(_a.m_min[i],_b.m_min[i]);
+      o_res.m_max[i]=std::max(_a.m_max[i],_b.m_max[i]);
+    }
+  }
+
+  inline bool overlaps(const Real *_minA, const Real *_maxA, const Real *_minB, const Real *_maxB) noexcept
+  {
+    return _minA[0]<=_maxB[0] && _minB[0]<=_maxA[0] &&
+           _minA[1]<=_maxB[1] && _minB[1]<=_maxA[1] &&
+           _minA[2]<=_maxB[2] && _minB[2]<=_maxA[2];
+  }
+
+  inline bool containsBox(const Real *_outerMin, const Real *_outerMax, const Real *_min, const Real *_max) noexcept
+  {
+    return _outerMin[0]<=_min[0] && _outerMin[1]<=_min[1] && _outerMin[2]<=_min[2] &&
+           _max[0]<=_outerMax[0] && _max[1]<=_outerMax[1] && _max[2]<=_outerMax[2];
+  }
+
+  inline bool touchesSphere(const Real *_min, const Real *_max, const Vec3 &_center, Real _radius2) noexcept
+  {
+    Real d2=0.0f;
+    const Real c[3]={_center.m_x,_center.m_y,_center.m_z};
+    for(int i=0; i<3; ++i)
+    {
+      Real d=std::max(_min[i]-c[i],std::max(Real(0.0f),c[i]-_max[i]));
+      d2+=d*d;
+    }
+    return d2<=_radius2;
+  }
+
+} // end anonymous namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+DynamicBVH::DynamicBVH(Real _margin) noexcept : m_margin(_margin)
+{
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicBVH::transformBox(const Vec3 &_min, const Vec3 &_max, const Mat4 &_transform, Vec3 &o_min, Vec3 &o_max) noexcept
+{
+  // each world extent is the translation plus the smaller / larger of each matrix term applied to the local
+  // extents (J. Arvo, Graphics Gems 1990)
+  const Real bmin[3]={_min.m_x,_min.m_y,_min.m_z};
+  const Real bmax[3]={_max.m_x,_max.m_y,_max.m_z};
+  Real mn[3],mx[3];
+  for(int i=0; i<3; ++i)
+  {
+    mn[i]=mx[i]=_transform.m_m[3][i];
+    for(int j=0; j<3; ++j)
+    {
+      Real e=_transform.m_m[j][i]*bmin[j];
+      Real f=_transform.m_m[j][i]*bmax[j];
+      mn[i]+=std::min(e,f);
+      mx[i]+=std::max(e,f);
+    }
+  }
+  o_min.set(mn[0],mn[1],mn[2]);
+  o_max.set(mx[0],mx[1],mx[2]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+int32_t DynamicBVH::allocateNode() noexcept
+{
+  if(m_freeList==-1)
+  {
+    int32_t first=static_cast<int32_t>(m_nodes.size());
+    size_t grow=std::max<size_t>(16,m_nodes.size());
+    m_nodes.resize(m_nodes.size()+grow);
+    m_boxes.resize(m_nodes.size());
+    for(size_t i=first; i<m_nodes.size(); ++i)
+    {
+      m_nodes[i].m_parent= i+1<m_nodes.size() ? static_cast<int32_t>(i+1) : -1;
+      m_nodes[i].m_height=-1;
+    }
+    m_freeList=first;
+  }
+  int32_t node=m_freeList;
+  Node &n=m_nodes[node];
+  m_freeList=n.m_parent;
+  n.m_parent=-1;
+  n.m_child[0]=n.m_child[1]=-1;
+  n.m_height=0;
+  n.m_id=0;
+  return node;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicBVH::freeNode(int32_t _node) noexcept
+{
+  m_nodes[_node].m_parent=m_freeList;
+  m_nodes[_node].m_height=-1;
+  m_freeList=_node;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicBVH::setFatBox(int32_t _leaf, const Vec3 &_displacement) noexcept
+{
+  Node &n=m_nodes[_leaf];
+  const Box &b=m_boxes[_leaf];
+  const Real d[3]={_displacement.m_x*s_displacementScale,_displacement.m_y*s_displacementScale,
+                   _displacement.m_z*s_displacementScale};
+  for(int i=0; i<3; ++i)
+  {
+    n.m_min[i]=b.m_min[i]-m_margin+std::min(d[i],Real(0.0f));
+    n.m_max[i]=b.m_max[i]+m_margin+std::max(d[i],Real(0.0f));
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool DynamicBVH::insert(uint32_t _id, const Vec3 &_min, const Vec3 &_max) noexcept
+{
+  if(contains(_id))
+  {
+    std::cerr<<"DynamicBVH::insert object "<<_id<<" is already in the tree\n";
+    return false;
+  }
+  int32_t leaf=allocateNode();
+  m_nodes[leaf].m_id=_id;
+  Box &b=m_boxes[leaf];
+  b.m_min[0]=_min.m_x; b.m_min[1]=_min.m_y; b.m_min[2]=_min.m_z;
+  b.m_max[0]=_max.m_x; b.m_max[1]=_max.m_y; b.m_max[2]=_max.m_z;
+  setFatBox(leaf,Vec3(0.0f,0.0f,0.0f));
+  insertLeaf(leaf);
+  m_leaves[_id]=leaf;
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool DynamicBVH::insert(uint32_t _id, const BBox &_box, const Mat4 &_transform) noexcept
+{
+  Vec3 mn,mx;
+  transformBox(Vec3(_box.minX(),_box.minY(),_box.minZ()),Vec3(_box.maxX(),_box.maxY(),_box.maxZ()),_transform,mn,mx);
+  return insert(_id,mn,mx);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool DynamicBVH::remove(uint32_t _id) noexcept
+{
+  auto it=m_leaves.find(_id);
+  if(it==m_leaves.end())
+  {
+    std::cerr<<"DynamicBVH::remove object "<<_id<<" is not in the tree\n";
+    return false;
+  }
+  removeLeaf(it->second);
+  freeNode(it->second);
+  m_leaves.erase(it);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool DynamicBVH::move(uint32_t _id, const Vec3 &_min, const Vec3 &_max, const Vec3 &_displacement) noexcept
+{
+  auto it=m_leaves.find(_id);
+  if(it==m_leaves.end())
+  {
+    return false;
+  }
+  int32_t leaf=it->second;
+  Box &b=m_boxes[leaf];
+  b.m_min[0]=_min.m_x; b.m_min[1]=_min.m_y; b.m_min[2]=_min.m_z;
+  b.m_max[0]=_max.m_x; b.m_max[1]=_max.m_y; b.m_max[2]=_max.m_z;
+  const Node &n=m_nodes[leaf];
+  if(containsBox(n.m_min,n.m_max,b.m_min,b.m_max))
+  {
+    // keep the fat box unless it has become much bigger than needed (e.g. a fast object has stopped)
+    Real slack=s_maxSlack*m_margin;
+    const Real d[3]={_displacement.m_x*s_displacementScale,_displacement.m_y*s_displacementScale,
+                     _displacement.m_z*s_displacementScale};
+    Real hugeMin[3],hugeMax[3];
+    for(int i=0; i<3; ++i)
+    {
+      hugeMin[i]=b.m_min[i]-slack+std::min(d[i],Real(0.0f));
+      hugeMax[i]=b.m_max[i]+slack+std::max(d[i],Real(0.0f));
+    }
+    if(containsBox(hugeMin,hugeMax,n.m_min,n.m_max))
+    {
+      return false;
+    }
+  }
+  removeLeaf(leaf);
+  setFatBox(leaf,_displacement);
+  insertLeaf(leaf);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool DynamicBVH::move(uint32_t _id, const BBox &_box, const Mat4 &_transform) noexcept
+{
+  Vec3 mn,mx;
+  transformBox(Vec3(_box.minX(),_box.minY(),_box.minZ()),Vec3(_box.maxX(),_box.maxY(),_box.maxZ()),_transform,mn,mx);
+  return move(_id,mn,mx);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool DynamicBVH::getBox(uint32_t _id, Vec3 &o_min, Vec3 &o_max) const noexcept
+{
+  auto it=m_leaves.find(_id);
+  if(it==m_leaves.end())
+  {
+    return false;
+  }
+  const Box &b=m_boxes[it->second];
+  o_min.set(b.m_min[0],b.m_min[1],b.m_min[2]);
+  o_max.set(b.m_max[0],b.m_max[1],b.m_max[2]);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicBVH::clear() noexcept
+{
+  m_nodes.clear();
+  m_boxes.clear();
+  m_leaves.clear();
+  m_root=-1;
+  m_freeList=-1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+int DynamicBVH::height() const noexcept
+{
+  return m_root==-1 ? -1 : m_nodes[m_root].m_height;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicBVH::insertLeaf(int32_t _leaf) noexcept
+{
+  if(m_root==-1)
+  {
+    m_root=_leaf;
+    m_nodes[_leaf].m_parent=-1;
+    return;
+  }
+  // walk down choosing the child which adds least to the surface area of the tree, stopping when making a
+  // new parent here is cheaper than going further down
+  int32_t index=m_root;
+  while(!m_nodes[index].isLeaf())
+  {
+    const Node &n=m_nodes[index];
+    const Node &leaf=m_nodes[_leaf];
+    Real area=surfaceArea(n.m_min,n.m_max);
+    Real combinedArea=mergedArea(n,leaf);
+    Real cost=2.0f*combinedArea;
+    // the increase in area of this node and its parents if we go further down
+    Real inheritance=2.0f*(combinedArea-area);
+    Real childCost[2];
+    for(int c=0; c<2; ++c)
+    {
+      const Node &child=m_nodes[n.m_child[c]];
+      childCost[c]=mergedArea(child,leaf)+inheritance;
+      if(!child.isLeaf())
+      {
+        childCost[c]-=surfaceArea(child.m_min,child.m_max);
+      }
+    }
+    if(cost<childCost[0] && cost<childCost[1])
+    {
+      break;
+    }
+    index= childCost[0]<childCost[1] ? n.m_child[0] : n.m_child[1];
+  }
+  int32_t sibling=index;
+  // allocating may move the nodes so no references are held over it
+  int32_t newParent=allocateNode();
+  int32_t oldParent=m_nodes[sibling].m_parent;
+  Node &p=m_nodes[newParent];
+  p.m_parent=oldParent;
+  merge(m_nodes[sibling],m_nodes[_leaf],p);
+  p.m_height=m_nodes[sibling].m_height+1;
+  p.m_child[0]=sibling;
+  p.m_child[1]=_leaf;
+  m_nodes[sibling].m_parent=newParent;
+  m_nodes[_leaf].m_parent=newParent;
+  if(oldParent!=-1)
+  {
+    Node &op=m_nodes[oldParent];
+    op.m_child[op.m_child[0]==sibling ? 0 : 1]=newParent;
+  }
+  else
+  {
+    m_root=newParent;
+  }
+  refit(newParent);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicBVH::removeLeaf(int32_t _leaf) noexcept
+{
+  if(_leaf==m_root)
+  {
+    m_root=-1;
+    return;
+  }
+  int32_t parent=m_nodes[_leaf].m_parent;
+  int32_t grandParent=m_nodes[parent].m_parent;
+  int32_t sibling=m_nodes[parent].m_child[m_nodes[parent].m_child[0]==_leaf ? 1 : 0];
+  // the sibling takes the place of the parent
+  m_nodes[sibling].m_parent=grandParent;
+  freeNode(parent);
+  if(grandParent!=-1)
+  {
+    Node &gp=m_nodes[grandParent];
+    gp.m_child[gp.m_child[0]==parent ? 0 : 1]=sibling;
+    refit(grandParent);
+  }
+  else
+  {
+    m_root=sibling;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicBVH::refit(int32_t _node) noexcept
+{
+  bool first=true;
+  while(_node!=-1)
+  {
+    rotate(_node);
+    Node &n=m_nodes[_node];
+    const Node &a=m_nodes[n.m_child[0]];
+    const Node &b=m_nodes[n.m_child[1]];
+    Node old=n;
+    n.m_height=1+std::max(a.m_height,b.m_height);
+    merge(a,b,n);
+    // once a node is unchanged nothing above it needs updating (the first node may already have been set up)
+    if(!first && n.m_height==old.m_height && std::equal(n.m_min,n.m_min+3,old.m_min) && std::equal(n.m_max,n.m_max+3,old.m_max))
+    {
+      break;
+    }
+    first=false;
+    _node=n.m_parent;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicBVH::rotate(int32_t _node) noexcept
+{
+  const Node &a=m_nodes[_node];
+  if(a.m_height<2)
+  {
+    return;
+  }
+  // look for a swap of a child with a grandchild on the other side, or of two grandchildren, which most reduces
+  // the area of the two children (N. Kopta et al. "Fast, effective BVH updates for animated scenes" 2012)
+  int32_t b=a.m_child[0];
+  int32_t c=a.m_child[1];
+  const Node &nb=m_nodes[b];
+  const Node &nc=m_nodes[c];
+  Real areaB=surfaceArea(nb.m_min,nb.m_max);
+  Real areaC=surfaceArea(nc.m_min,nc.m_max);
+  int32_t swapX=-1;
+  int32_t swapY=-1;
+  Real best=0.0f;
+  auto consider=[&](int32_t _x, int32_t _y, Real _cost)
+  {
+    if(_cost<best)
+    {
+      best=_cost;
+      swapX=_x;
+      swapY=_y;
+    }
+  };
+  if(!nc.isLeaf())
+  {
+    const Node &f=m_nodes[nc.m_child[0]];
+    const Node &g=m_nodes[nc.m_child[1]];
+    consider(b,nc.m_child[0],mergedArea(nb,g)-areaC);
+    consider(b,nc.m_child[1],mergedArea(f,nb)-areaC);
+  }
+  if(!nb.isLeaf())
+  {
+    const Node &d=m_nodes[nb.m_child[0]];
+    const Node &e=m_nodes[nb.m_child[1]];
+    consider(c,nb.m_child[0],mergedArea(nc,e)-areaB);
+    consider(c,nb.m_child[1],mergedArea(d,nc)-areaB);
+    if(!nc.isLeaf())
+    {
+      const Node &f=m_nodes[nc.m_child[0]];
+      const Node &g=m_nodes[nc.m_child[1]];
+      consider(nb.m_child[0],nc.m_child[0],mergedArea(f,e)+mergedArea(d,g)-areaB-areaC);
+      consider(nb.m_child[0],nc.m_child[1],mergedArea(g,e)+mergedArea(f,d)-areaB-areaC);
+    }
+  }
+  if(swapX==-1)
+  {
+    return;
+  }
+  int32_t parentX=m_nodes[swapX].m_parent;
+  int32_t parentY=m_nodes[swapY].m_parent;
+  Node &px=m_nodes[parentX];
+  Node &py=m_nodes[parentY];
+  px.m_child[px.m_child[0]==swapX ? 0 : 1]=swapY;
+  py.m_child[py.m_child[0]==swapY ? 0 : 1]=swapX;
+  m_nodes[swapX].m_parent=parentY;
+  m_nodes[swapY].m_parent=parentX;
+  // a node moved down is unchanged so the two children can be refitted in any order
+  for(int32_t index : {b,c})
+  {
+    Node &n=m_nodes[index];
+    if(!n.isLeaf())
+    {
+      merge(m_nodes[n.m_child[0]],m_nodes[n.m_child[1]],n);
+      n.m_height=1+std::max(m_nodes[n.m_child[0]].m_height,m_nodes[n.m_child[1]].m_height);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicBVH::overlapBox(const Vec3 &_min, const Vec3 &_max, std::vector<uint32_t> &o_ids) const noexcept
+{
+  o_ids.clear();
+  if(m_root==-1)
+  {
+    return;
+  }
+  const Real mn[3]={_min.m_x,_min.m_y,_min.m_z};
+  const Real mx[3]={_max.m_x,_max.m_y,_max.m_z};
+  std::vector<int32_t> stack;
+  stack.reserve(64);
+  stack.push_back(m_root);
+  while(!stack.empty())
+  {
+    int32_t index=stack.back();
+    stack.pop_back();
+    const Node &n=m_nodes[index];
+    if(!overlaps(n.m_min,n.m_max,mn,mx))
+    {
+      continue;
+    }
+    if(n.isLeaf())
+    {
+      const Box &b=m_boxes[index];
+      if(overlaps(b.m_min,b.m_max,mn,mx))
+      {
+        o_ids.push_back(n.m_id);
+      }
+    }
+    else
+    {
+      stack.push_back(n.m_child[0]);
+      stack.push_back(n.m_child[1]);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicBVH::overlapSphere(const Vec3 &_center, Real _radius, std::vector<uint32_t> &o_ids) const noexcept
+{
+  o_ids.clear();
+  if(m_root==-1)
+  {
+    return;
+  }
+  Real radius2=_radius*_radius;
+  std::vector<int32_t> stack;
+  stack.reserve(64);
+  stack.push_back(m_root);
+  while(!stack.empty())
+  {
+    int32_t index=stack.back();
+    stack.pop_back();
+    const Node &n=m_nodes[index];
+    if(!touchesSphere(n.m_min,n.m_max,_center,radius2))
+    {
+      continue;
+    }
+    if(n.isLeaf())
+    {
+      const Box &b=m_boxes[index];
+      if(touchesSphere(b.m_min,b.m_max,_center,radius2))
+      {
+        o_ids.push_back(n.m_id);
+      }
+    }
+    else
+    {
+      stack.push_back(n.m_child[0]);
+      stack.push_back(n.m_child[1]);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicBVH::inFrustum(const Camera &_camera, std::vector<uint32_t> &o_ids) const noexcept
+{
+  o_ids.clear();
+  if(m_root==-1)
+  {
+    return;
+  }
+  // the stack holds the node and whether it is already known to be inside the frustum, the exact boxes are
+  // inside the fat ones so once a node is inside nothing below it needs testing
+  std::vector<std::pair<int32_t,bool>> stack;
+  stack.reserve(64);
+  stack.push_back(std::make_pair(m_root,false));
+  while(!stack.empty())
+  {
+    int32_t index=stack.back().first;
+    bool inside=stack.back().second;
+    stack.pop_back();
+    const Node &n=m_nodes[index];
+    if(!inside)
+    {
+      CameraIntercept c=_camera.boxInFrustum(n.m_min,n.m_max);
+      if(c==CameraIntercept::OUTSIDE)
+      {
+        continue;
+      }
+      inside= c==CameraIntercept::INSIDE;
+    }
+    if(n.isLeaf())
+    {
+      if(inside || _camera.boxInFrustum(m_boxes[index].m_min,m_boxes[index].m_max)!=CameraIntercept::OUTSIDE)
+      {
+        o_ids.push_back(n.m_id);
+      }
+    }
+    else
+    {
+      stack.push_back(std::make_pair(n.m_child[0],inside));
+      stack.push_back(std::make_pair(n.m_child[1],inside));
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void DynamicBVH::overlappingPairs(std::vector<std::pair<uint32_t,uint32_t>> &o_pairs) const noexcept
+{
+  o_pairs.clear();
+  if(m_root==-1)
+  {
+    return;
+  }
+  // descend the tree against itself, a pair of the same node means the pairs within that sub tree, other pairs
+  // are only pushed if their boxes overlap
+  std::vector<std::pair<int32_t,int32_t>> stack;
+  stack.reserve(128);
+  stack.push_back(std::make_pair(m_root,m_root));
+  auto pushIfOverlapping=[&](int32_t _a, int32_t _b)
+  {
+    const Node &a=m_nodes[_a];
+    const Node &b=m_nodes[_b];
+    if(overlaps(a.m_min,a.m_max,b.m_min,b.m_max))
+    {
+      stack.push_back(std::make_pair(_a,_b));
+    }
+  };
+  while(!stack.empty())
+  {
+    int32_t ia=stack.back().first;
+    int32_t ib=stack.back().second;
+    stack.pop_back();
+    const Node &a=m_nodes[ia];
+    if(ia==ib)
+    {
+      if(!a.isLeaf())
+      {
+        stack.push_back(std::make_pair(a.m_child[0],a.m_child[0]));
+        stack.push_back(std::make_pair(a.m_child[1],a.m_child[1]));
+        pushIfOverlapping(a.m_child[0],a.m_child[1]);
+      }
+      continue;
+    }
+    const Node &b=m_nodes[ib];
+    if(a.isLeaf() && b.isLeaf())
+    {
+      const Box &ba=m_boxes[ia];
+      const Box &bb=m_boxes[ib];
+      if(overlaps(ba.m_min,ba.m_max,bb.m_min,bb.m_max))
+      {
+        o_pairs.push_back(std::make_pair(std::min(a.m_id,b.m_id),std::max(a.m_id,b.m_id)));
+      }
+    }
+    // split the bigger node (or the one that isn't a leaf)
+    else if(b.isLeaf() || (!a.isLeaf() && surfaceArea(a.m_min,a.m_max)>surfaceArea(b.m_min,b.m_max)))
+    {
+      pushIfOverlapping(a.m_child[0],ib);
+      pushIfOverlapping(a.m_child[1],ib);
+    }
+    else
+    {
+      pushIfOverlapping(ia,b.m_child[0]);
+      pushIfOverlapping(ia,b.m_child[1]);
+    }
+  }
+}
+
+} // end namespace ngl
+//----------------------------------------------------------------------------------------------------------------------
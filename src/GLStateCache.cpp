@@ -0,0 +1,102 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "GLStateCache.h"
+//----------------------------------------------------------------------------------------------------------------------
+/// @file GLStateCache.cpp
+/// @brief implementation files for GLStateCache class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLStateCache::useProgram(GLuint _id) noexcept
+{
+  if(m_enabled && isProgramInUse(_id))
+  {
+    ++m_stats.m_programBindsSkipped;
+    return;
+  }
+  glUseProgram(_id);
+  m_program=_id;
+  m_programKnown=true;
+  ++m_stats.m_programBinds;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLStateCache::bindVertexArray(GLuint _id) noexcept
+{
+  if(m_enabled && isVertexArrayBound(_id))
+  {
+    ++m_stats.m_vaoBindsSkipped;
+    return;
+  }
+  glBindVertexArray(_id);
+  m_vao=_id;
+  m_vaoKnown=true;
+  ++m_stats.m_vaoBinds;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLStateCache::unbindVertexArray() noexcept
+{
+  if(m_enabled && m_deferUnbind && m_vaoKnown)
+  {
+    ++m_stats.m_vaoBindsSkipped;
+    return;
+  }
+  bindVertexArray(0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLStateCache::programDeleted(GLuint _id) noexcept
+{
+  if(m_program==_id)
+  {
+    m_programKnown=false;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLStateCache::vertexArrayDeleted(GLuint _id) noexcept
+{
+  if(m_vaoKnown && m_vao==_id)
+  {
+    m_vao=0;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLStateCache::invalidate() noexcept
+{
+  m_programKnown=false;
+  m_vaoKnown=false;
+  invalidateUniforms();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void GLStateCache::setEnabled(bool _enabled) noexcept
+{
+  // uniforms written while disabled were not compared so nothing stored can be trusted
+  if(_enabled && !m_enabled)
+  {
+    invalidate();
+  }
+  m_enabled=_enabled;
+}
+
+} // end namespace ngl
+//----------------------------------------------------------------------------------------------------------------------
@@ -17,6 +17,7 @@
 
 #include "Light.h"
 #include "ShaderLib.h"
+#include "UniformBlock.h"
 
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Light.cpp
@@ -138,6 +139,31 @@ void Light::loadToShader(std::string _uniformName )const noexcept
   }
 }
 
+void Light::loadToBlock(UniformBlock &o_block, const std::string &_uniformName )const noexcept
+{
+  if(m_active==true)
+  {
+    Vec4 pos=m_transform*m_position;
+    pos.m_w=Real(m_lightMode);
+    o_block.set(_uniformName+".position",pos);
+    o_block.set(_uniformName+".ambient",m_ambient);
+    o_block.set(_uniformName+".diffuse",m_diffuse);
+    o_block.set(_uniformName+".specular",m_specular);
+    o_block.set(_uniformName+".constantAttenuation",m_constantAtten);
+    o_block.set(_uniformName+".linearAttenuation",m_linearAtten);
+    o_block.set(_uniformName+".quadraticAttenuation",m_quadraticAtten);
+    o_block.set(_uniformName+".spotCosCutoff",m_cutoffAngle);
+  }
+  else
+  {
+    // turn light off by setting 0 values
+    o_block.set(_uniformName+".position",Vec4(0,0,0,Real(m_lightMode)));
+    o_block.set(_uniformName+".ambient",Vec4(0,0,0,0));
+    o_block.set(_uniformName+".diffuse",Vec4(0,0,0,0));
+    o_block.set(_uniformName+".specular",Vec4(0,0,0,0));
+  }
+}
+
 void Light::setTransform(Mat4 &_t) noexcept
 {
   m_transform=_t;
@@ -0,0 +1,143 @@
+/*
+  Copyright (C) 2016 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "MappedFile.h"
+#include <algorithm>
+#include <fstream>
+#if !defined(WIN32)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+//----------------------------------------------------------------------------------------------------------------------
+/// @file MappedFile.cpp
+/// @brief implementation files for MappedFile class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+MappedFile::MappedFile(const std::string &_fname, Access _access) noexcept
+{
+  open(_fname,_access);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+MappedFile::~MappedFile() noexcept
+{
+  close();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool MappedFile::open(const std::string &_fname, Access _access) noexcept
+{
+  close();
+#if defined(WIN32)
+  (void)_access;
+  std::ifstream in(_fname.c_str(),std::ios::in | std::ios::binary);
+  if(!in.is_open())
+  {
+    return false;
+  }
+  in.seekg(0,std::ios::end);
+  std::streamoff size=in.tellg();
+  in.seekg(0,std::ios::beg);
+  if(size<=0)
+  {
+    m_valid = size==0;
+    return m_valid;
+  }
+  m_buffer.resize(static_cast<size_t>(size));
+  in.read(&m_buffer[0],size);
+  m_data=&m_buffer[0];
+  m_size=m_buffer.size();
+  m_valid=true;
+#else
+  int fd=::open(_fname.c_str(),O_RDONLY);
+  if(fd==-1)
+  {
+    return false;
+  }
+  struct stat sb;
+  if(fstat(fd,&sb)==0)
+  {
+    m_size=static_cast<size_t>(sb.st_size);
+    if(m_size==0)
+    {
+      m_valid=true;
+    }
+    else
+    {
+      void *map=mmap(nullptr,m_size,PROT_READ,MAP_PRIVATE,fd,0);
+      if(map!=MAP_FAILED)
+      {
+        m_data=static_cast<const char *>(map);
+        m_mapped=true;
+        m_valid=true;
+        madvise(map,m_size,_access==Access::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+      }
+      else
+      {
+        m_size=0;
+      }
+    }
+  }
+  ::close(fd);
+#endif
+  return m_valid;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MappedFile::release(size_t _offset, size_t _size) const noexcept
+{
+#if !defined(WIN32)
+  if(!m_mapped || _offset>=m_size)
+  {
+    return;
+  }
+  // only whole pages inside the range can be dropped
+  const size_t page=static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t begin=(_offset+page-1)/page*page;
+  size_t end=std::min(_offset+_size,m_size)/page*page;
+  if(end>begin)
+  {
+    madvise(const_cast<char *>(m_data)+begin,end-begin,MADV_DONTNEED);
+  }
+#else
+  (void)_offset;
+  (void)_size;
+#endif
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void MappedFile::close() noexcept
+{
+#if !defined(WIN32)
+  if(m_mapped)
+  {
+    munmap(const_cast<char *>(m_data),m_size);
+  }
+#endif
+  m_buffer.clear();
+  m_buffer.shrink_to_fit();
+  m_data=nullptr;
+  m_size=0;
+  m_valid=false;
+  m_mapped=false;
+}
+
+} // end ngl namespace
@@ -19,6 +19,7 @@
 #include "Quaternion.h"
 #include "Util.h"
 #include "Vec3.h"
+#include "SIMD.h"
 #include <iostream>
 #include <cstring> // for memset
 #include <algorithm>
@@ -32,6 +33,101 @@
 namespace ngl
 {
 
+#if defined(NGL_SIMD)
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief o_res = _a * _b using the m_m row layout, o_res may be either of the inputs
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void multiply(const Real *_a, const Real *_b, Real *o_res) noexcept
+  {
+    simd::float4 b0=simd::load(_b);
+    simd::float4 b1=simd::load(_b+4);
+    simd::float4 b2=simd::load(_b+8);
+    simd::float4 b3=simd::load(_b+12);
+    simd::float4 r0=simd::combine(simd::load(_a),b0,b1,b2,b3);
+    simd::float4 r1=simd::combine(simd::load(_a+4),b0,b1,b2,b3);
+    simd::float4 r2=simd::combine(simd::load(_a+8),b0,b1,b2,b3);
+    simd::float4 r3=simd::combine(simd::load(_a+12),b0,b1,b2,b3);
+    simd::store(o_res,r0);
+    simd::store(o_res+4,r1);
+    simd::store(o_res+8,r2);
+    simd::store(o_res+12,r3);
+  }
+#if defined(NGL_SIMD_SSE)
+  template<int X,int Y,int Z,int W> inline __m128 swizzle(__m128 _v) noexcept
+  {
+    return _mm_shuffle_ps(_v,_v,_MM_SHUFFLE(W,Z,Y,X));
+  }
+  template<int X,int Y,int Z,int W> inline __m128 shuffle(__m128 _a, __m128 _b) noexcept
+  {
+    return _mm_shuffle_ps(_a,_b,_MM_SHUFFLE(W,Z,Y,X));
+  }
+  // 2x2 matrices are held as (m00,m01,m10,m11) in one register, # is the adjugate
+  // _a*_b
+  inline __m128 mat2Mul(__m128 _a, __m128 _b) noexcept
+  {
+    return _mm_add_ps(_mm_mul_ps(_a,swizzle<0,3,0,3>(_b)),_mm_mul_ps(swizzle<1,0,3,2>(_a),swizzle<2,1,2,1>(_b)));
+  }
+  // _a# * _b
+  inline __m128 mat2AdjMul(__m128 _a, __m128 _b) noexcept
+  {
+    return _mm_sub_ps(_mm_mul_ps(swizzle<3,3,0,0>(_a),_b),_mm_mul_ps(swizzle<1,1,2,2>(_a),swizzle<2,3,0,1>(_b)));
+  }
+  // _a * _b#
+  inline __m128 mat2MulAdj(__m128 _a, __m128 _b) noexcept
+  {
+    return _mm_sub_ps(_mm_mul_ps(_a,swizzle<3,0,3,0>(_b)),_mm_mul_ps(swizzle<1,0,3,2>(_a),swizzle<2,1,2,1>(_b)));
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief invert a 4x4 matrix by splitting it into the 2x2 blocks | A B | | C D | and using the block
+  /// inverse (with adjugates of the 2x2 blocks so there is only the one divide), as with the scalar version
+  /// there is no check for a singular matrix
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void invert(const Real *_m, Real *o_res) noexcept
+  {
+    __m128 r0=_mm_loadu_ps(_m);
+    __m128 r1=_mm_loadu_ps(_m+4);
+    __m128 r2=_mm_loadu_ps(_m+8);
+    __m128 r3=_mm_loadu_ps(_m+12);
+    __m128 a=_mm_movelh_ps(r0,r1);
+    __m128 b=_mm_movehl_ps(r1,r0);
+    __m128 c=_mm_movelh_ps(r2,r3);
+    __m128 d=_mm_movehl_ps(r3,r2);
+    // determinants of the blocks as (|A| |B| |C| |D|)
+    __m128 detSub=_mm_sub_ps(_mm_mul_ps(shuffle<0,2,0,2>(r0,r2),shuffle<1,3,1,3>(r1,r3)),
+                             _mm_mul_ps(shuffle<1,3,1,3>(r0,r2),shuffle<0,2,0,2>(r1,r3)));
+    __m128 detA=swizzle<0,0,0,0>(detSub);
+    __m128 detB=swizzle<1,1,1,1>(detSub);
+    __m128 detC=swizzle<2,2,2,2>(detSub);
+    __m128 detD=swizzle<3,3,3,3>(detSub);
+    __m128 dc=mat2AdjMul(d,c);
+    __m128 ab=mat2AdjMul(a,b);
+    // the blocks of the adjugate of the 4x4
+    __m128 x=_mm_sub_ps(_mm_mul_ps(detD,a),mat2Mul(b,dc));
+    __m128 w=_mm_sub_ps(_mm_mul_ps(detA,d),mat2Mul(c,ab));
+    __m128 y=_mm_sub_ps(_mm_mul_ps(detB,c),mat2MulAdj(d,ab));
+    __m128 z=_mm_sub_ps(_mm_mul_ps(detC,b),mat2MulAdj(a,dc));
+    // |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+    __m128 tr=_mm_mul_ps(ab,swizzle<0,2,1,3>(dc));
+    tr=_mm_add_ps(tr,swizzle<2,3,0,1>(tr));
+    tr=_mm_add_ps(tr,swizzle<1,0,3,2>(tr));
+    __m128 det=_mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA,detD),_mm_mul_ps(detB,detC)),tr);
+    __m128 invDet=_mm_div_ps(_mm_setr_ps(1.0f,-1.0f,-1.0f,1.0f),det);
+    x=_mm_mul_ps(x,invDet);
+    y=_mm_mul_ps(y,invDet);
+    z=_mm_mul_ps(z,invDet);
+    w=_mm_mul_ps(w,invDet);
+    // take the adjugate of each block as we put them back together
+    _mm_storeu_ps(o_res,shuffle<3,1,3,1>(x,y));
+    _mm_storeu_ps(o_res+4,shuffle<2,0,2,0>(x,y));
+    _mm_storeu_ps(o_res+8,shuffle<3,1,3,1>(z,w));
+    _mm_storeu_ps(o_res+12,shuffle<2,0,2,0>(z,w));
+  }
+#endif
+} // end anonymous namespace
+#endif
+
 //----------------------------------------------------------------------------------------------------------------------
 Mat4::Mat4() noexcept
 {
@@ -125,70 +221,9 @@ const Mat4&  Mat4::identity() noexcept
 Mat4 Mat4::operator*(const Mat4& _m ) const noexcept
 {
   Mat4 temp;
-  // according to this http://www.research.scea.com/research/pdfs/GDC2003_Memory_Optimization_18Mar03.pdf
-  // we get better cache performance and less in the way of
-  // cache misses by prefectching the data using the consume / process pardigm
-  // not really tested this yet so will be interesting to do so
-/*
-  ngl::Real  m00=m_m[0][0];
-  ngl::Real  m01=m_m[0][1];
-  ngl::Real  m02=m_m[0][2];
-  ngl::Real  m03=m_m[0][3];
-
-  ngl::Real  m10=m_m[1][0];
-  ngl::Real  m11=m_m[1][1];
-  ngl::Real  m12=m_m[1][2];
-  ngl::Real  m13=m_m[1][3];
-
-  ngl::Real  m20=m_m[2][0];
-  ngl::Real  m21=m_m[2][1];
-  ngl::Real  m22=m_m[2][2];
-  ngl::Real  m23=m_m[2][3];
-
-  ngl::Real  m30=m_m[3][0];
-  ngl::Real  m31=m_m[3][1];
-  ngl::Real  m32=m_m[3][2];
-  ngl::Real  m33=m_m[3][3];
-
-  ngl::Real  b00=_m.m_m[0][0];
-  ngl::Real  b01=_m.m_m[0][1];
-  ngl::Real  b02=_m.m_m[0][2];
-  ngl::Real  b03=_m.m_m[0][3];
-
-  ngl::Real  b10=_m.m_m[1][0];
-  ngl::Real  b11=_m.m_m[1][1];
-  ngl::Real  b12=_m.m_m[1][2];
-  ngl::Real  b13=_m.m_m[1][3];
-
-  ngl::Real  b20=_m.m_m[2][0];
-  ngl::Real  b21=_m.m_m[2][1];
-  ngl::Real  b22=_m.m_m[2][2];
-  ngl::Real  b23=_m.m_m[2][3];
-
-  ngl::Real  b30=_m.m_m[3][0];
-  ngl::Real  b31=_m.m_m[3][1];
-  ngl::Real  b32=_m.m_m[3][2];
-  ngl::Real  b33=_m.m_m[3][3];
-
-  temp.m_m[0][0] = m00 * b00 + m01 * b10 + m02 * b20 + m03 * b30;
-  temp.m_m[0][1] = m00 * b01 + m01 * b11 + m02 * b21 + m03 * b31;
-  temp.m_m[0][2] = m00 * _m.m_m[0][2] + m01 * b12 + m02 * b22 + m03 * b32;
-  temp.m_m[0][3] = m00 * b03 + m01 * b13 + m02 * b23 + m03 * b33;
-  temp.m_m[1][0] = m10 * b00 + m11 * b10 + m12 * b20 + m13 * b30;
-  temp.m_m[1][1] = m10 * b01 + m11 * b11 + m12 * b21 + m13 * b31;
-  temp.m_m[1][2] = m10 * _m.m_m[0][2] + m11 * b12 + m12 * b22 + m13 * b32;
-  temp.m_m[1][3] = m10 * b03 + m11 * b13 + m12 * b23 + m13 * b33;
-  temp.m_m[2][0] = m20 * b00 + m21 * b10 + m22 * b20 + m23 * b30;
-  temp.m_m[2][1] = m20 * b01 + m21 * b11 + m22 * b21 + m23 * b31;
-  temp.m_m[2][2] = m20 * _m.m_m[0][2] + m21 * b12 + m22 * b22 + m23 * b32;
-  temp.m_m[2][3] = m20 * b03 + m21 * b13 + m22 * b23 + m23 * b33;
-  temp.m_m[3][0] = m30 * b00 + m31 * b10 + m32 * b20 + m33 * b30;
-  temp.m_m[3][1] = m30 * b01 + m31 * b11 + m32 * b21 + m33 * b31;
-  temp.m_m[3][2] = m30 * _m.m_m[0][2] + m31 * b12 + m32 * b22 + m33 * b32;
-  temp.m_m[3][3] = m30 * b03 + m31 * b13 + m32 * b23 + m33 * b33;
-*/
-// orignal
-
+#if defined(NGL_SIMD)
+  multiply(&m_openGL[0],&_m.m_openGL[0],&temp.m_openGL[0]);
+#else
   temp.m_m[0][0] = m_m[0][0] * _m.m_m[0][0] + m_m[0][1] * _m.m_m[1][0] + m_m[0][2] * _m.m_m[2][0] + m_m[0][3] * _m.m_m[3][0];
   temp.m_m[0][1] = m_m[0][0] * _m.m_m[0][1] + m_m[0][1] * _m.m_m[1][1] + m_m[0][2] * _m.m_m[2][1] + m_m[0][3] * _m.m_m[3][1];
   temp.m_m[0][2] = m_m[0][0] * _m.m_m[0][2] + m_m[0][1] * _m.m_m[1][2] + m_m[0][2] * _m.m_m[2][2] + m_m[0][3] * _m.m_m[3][2];
@@ -205,13 +240,17 @@ Mat4 Mat4::operator*(const Mat4& _m ) const noexcept
   temp.m_m[3][1] = m_m[3][0] * _m.m_m[0][1] + m_m[3][1] * _m.m_m[1][1] + m_m[3][2] * _m.m_m[2][1] + m_m[3][3] * _m.m_m[3][1];
   temp.m_m[3][2] = m_m[3][0] * _m.m_m[0][2] + m_m[3][1] * _m.m_m[1][2] + m_m[3][2] * _m.m_m[2][2] + m_m[3][3] * _m.m_m[3][2];
   temp.m_m[3][3] = m_m[3][0] * _m.m_m[0][3] + m_m[3][1] * _m.m_m[1][3] + m_m[3][2] * _m.m_m[2][3] + m_m[3][3] * _m.m_m[3][3];
-
+#endif
   return temp;
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 const Mat4& Mat4::operator*= ( const Mat4 &_m ) noexcept
 {
+  // note this is _m * this (the m_m row layout) which is this*_m in the OpenGL column sense
+#if defined(NGL_SIMD)
+  multiply(&_m.m_openGL[0],&m_openGL[0],&m_openGL[0]);
+#else
   Mat4 temp(*this);
   //  row 0
   m_00  =  temp.m_00 * _m.m_00;
@@ -299,7 +338,7 @@ const Mat4& Mat4::operator*= ( const Mat4 &_m ) noexcept
   m_31 +=  temp.m_31 * _m.m_33;
   m_32 +=  temp.m_32 * _m.m_33;
   m_33 +=  temp.m_33 * _m.m_33;
-
+#endif
   return *this;
 }
 
@@ -375,12 +414,20 @@ const Mat4& Mat4::operator*=(const Real _i) noexcept
 Vec4 Mat4::operator * (const Vec4 &_v ) const noexcept
 {
   Vec4 temp;
-
+#if defined(NGL_SIMD)
+  // each element is a row dotted with _v, transposing to columns lets us do all four at once
+  simd::float4 c0=simd::load(&m_openGL[0]);
+  simd::float4 c1=simd::load(&m_openGL[4]);
+  simd::float4 c2=simd::load(&m_openGL[8]);
+  simd::float4 c3=simd::load(&m_openGL[12]);
+  simd::transpose(c0,c1,c2,c3);
+  simd::store(&temp.m_openGL[0],simd::combine(simd::load(&_v.m_openGL[0]),c0,c1,c2,c3));
+#else
   temp.m_x=_v.m_x * m_00 + _v.m_y	* m_01 + _v.m_z * m_02 + _v.m_w * m_03;
   temp.m_y=_v.m_x * m_10 + _v.m_y	* m_11 + _v.m_z * m_12 + _v.m_w * m_13;
   temp.m_z=_v.m_x * m_20 + _v.m_y	* m_21 + _v.m_z * m_22 + _v.m_w * m_23;
   temp.m_w=_v.m_x * m_30 + _v.m_y	* m_31 + _v.m_z * m_32 + _v.m_w * m_33;
-
+#endif
 return temp;
 }
 
@@ -388,6 +435,17 @@ return temp;
 //----------------------------------------------------------------------------------------------------------------------
 const Mat4& Mat4::transpose() noexcept
 {
+#if defined(NGL_SIMD)
+  simd::float4 r0=simd::load(&m_openGL[0]);
+  simd::float4 r1=simd::load(&m_openGL[4]);
+  simd::float4 r2=simd::load(&m_openGL[8]);
+  simd::float4 r3=simd::load(&m_openGL[12]);
+  simd::transpose(r0,r1,r2,r3);
+  simd::store(&m_openGL[0],r0);
+  simd::store(&m_openGL[4],r1);
+  simd::store(&m_openGL[8],r2);
+  simd::store(&m_openGL[12],r3);
+#else
   Mat4 tmp(*this);
 
   for(int row=0; row<4; row++)
@@ -397,6 +455,7 @@ const Mat4& Mat4::transpose() noexcept
       m_m[row][col]=tmp.m_m[col][row];
     }
   }
+#endif
   return *this;
 }
 
@@ -683,8 +742,11 @@ Mat4  Mat4::Adjacent() noexcept
 
 Mat4 Mat4::inverse() noexcept
 {
-
-
+#if defined(NGL_SIMD_SSE)
+  Mat4 t;
+  invert(&m_openGL[0],&t.m_openGL[0]);
+  return t;
+#else
   Mat4 t;
   t.m_00 = m_11*m_22*m_33 + m_12*m_23*m_31 + m_13*m_21*m_32 - m_11*m_32*m_23 - m_12*m_21*m_33 - m_13*m_22*m_31;
   t.m_01 = m_01*m_23*m_32 + m_02*m_21*m_33 + m_03*m_22*m_31 - m_01*m_22*m_33 - m_02*m_23*m_31 - m_03*m_21*m_32;
@@ -703,12 +765,11 @@ Mat4 Mat4::inverse() noexcept
   t.m_32 = m_00*m_12*m_31 + m_01*m_10*m_32 + m_02*m_11*m_30 - m_00*m_11*m_32 - m_01*m_12*m_30 - m_02*m_10*m_31;
   t.m_33 = m_00*m_11*m_22 + m_01*m_12*m_20 + m_02*m_10*m_21 - m_00*m_12*m_21 - m_01*m_10*m_22 - m_02*m_11*m_20;
 
-
-  auto det = determinant();
-  det = 1.0f/det;
-  return  t*det;
-
-
+  // t is the adjugate so the determinant is the first row dotted with its first column, no need
+  // to expand it again with determinant()
+  Real det = m_00*t.m_00 + m_01*t.m_10 + m_02*t.m_20 + m_03*t.m_30;
+  return  t*(1.0f/det);
+#endif
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -18,6 +18,7 @@
 #include "NGLStream.h"
 #include "Material.h"
 #include "ShaderLib.h"
+#include "UniformBlock.h"
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Material.cpp
 /// @brief implementation files for Material class
@@ -134,6 +135,15 @@ void Material::loadToShader( std::string _uniformName  )const noexcept
 }
 
 
+void Material::loadToBlock( UniformBlock &o_block, const std::string &_uniformName  )const noexcept
+{
+  o_block.set(_uniformName+".ambient",m_ambient);
+  o_block.set(_uniformName+".diffuse",m_diffuse);
+  o_block.set(_uniformName+".specular",m_specular);
+  o_block.set(_uniformName+".shininess",m_specularExponent);
+}
+
+
 } // end ngl namespace
 
 
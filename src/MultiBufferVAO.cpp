@@ -1,4 +1,5 @@
 #include "MultiBufferVAO.h"
+#include "GLStateCache.h"
 #include <iostream>
 #include <NGLassert.h>
 namespace ngl
@@ -21,12 +22,25 @@ namespace ngl
     glDrawArrays(m_mode, 0, static_cast<GLsizei>(m_indicesCount));
   }
 
+  void MultiBufferVAO::drawInstanced(GLsizei _instances) const
+  {
+    if(m_allocated == false)
+    {
+      std::cerr<<"Warning trying to draw an unallocated VOA\n";
+    }
+    if(m_bound == false)
+    {
+      std::cerr<<"Warning trying to draw an unbound VOA\n";
+    }
+    glDrawArraysInstanced(m_mode, 0, static_cast<GLsizei>(m_indicesCount), _instances);
+  }
   void MultiBufferVAO::removeVAO()
   {
     if(m_bound == true)
     {
       unbind();
     }
+    removeInstanceBuffers();
     if( m_allocated ==true)
     {
       for(auto b : m_vboIDs)
@@ -34,6 +48,7 @@ namespace ngl
         glDeleteBuffers(1,&b);
       }
       glDeleteVertexArrays(1,&m_id);
+      GLStateCache::instance()->vertexArrayDeleted(m_id);
       m_allocated=false;
     }
   }
@@ -14,9 +14,12 @@
     You should have received a copy of the GNU General Public License
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include "NCCABinMesh.h"
+#include "VAOFactory.h"
+#include "SimpleIndexVAO.h"
 #include <memory>
 //----------------------------------------------------------------------------------------------------------------------
 /// @file NCCABinMesh.cpp
@@ -26,90 +29,368 @@
 namespace ngl
 {
 
+namespace
+{
+  static_assert(sizeof(Real)==sizeof(float),"the binary mesh streams are stored as 32 bit floats");
+  const char s_magicV1[]="ngl::bin";
+  const char s_magicV2[]="ngl:bin2";
+  const uint32_t s_version=2;
+  const size_t s_headerSize=128;
+  const size_t s_sectionAlign=64;
+  const uint32_t s_hasNormals=1;
+  const uint32_t s_hasUVs=2;
+  // header field offsets, see NCCABinMesh.h
+  enum HeaderField : size_t
+  {
+    Magic=0, Version=8, Flags=12, NumVertices=16, NumIndices=24, IndexBytes=32,
+    SourceCounts=36, Bounds=52, Sections=88, FileSize=120
+  };
+  enum Section : size_t {Positions=0, Normals=1, UVs=2, Indices=3};
+
+  bool hostIsLittleEndian() noexcept
+  {
+    const uint16_t test=1;
+    unsigned char first;
+    std::memcpy(&first,&test,1);
+    return first==1;
+  }
+
+  // read / write a value stored little endian
+  template <typename T> T getLE(const char *_p) noexcept
+  {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes,_p,sizeof(T));
+    if(!hostIsLittleEndian())
+    {
+      std::reverse(bytes,bytes+sizeof(T));
+    }
+    T value;
+    std::memcpy(&value,bytes,sizeof(T));
+    return value;
+  }
+
+  template <typename T> void putLE(char *_p, T _value) noexcept
+  {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes,&_value,sizeof(T));
+    if(!hostIsLittleEndian())
+    {
+      std::reverse(bytes,bytes+sizeof(T));
+    }
+    std::memcpy(_p,bytes,sizeof(T));
+  }
+
+  uint64_t alignSection(uint64_t _offset) noexcept
+  {
+    return (_offset+s_sectionAlign-1) & ~static_cast<uint64_t>(s_sectionAlign-1);
+  }
+
+  // write _count values of _size bytes as little endian
+  void writeLE(std::ofstream &_file, const void *_data, uint64_t _count, size_t _size) noexcept
+  {
+    if(hostIsLittleEndian())
+    {
+      _file.write(static_cast<const char *>(_data),static_cast<std::streamsize>(_count*_size));
+      return;
+    }
+    const char *p=static_cast<const char *>(_data);
+    char value[8];
+    for(uint64_t i=0; i<_count; ++i)
+    {
+      std::reverse_copy(p,p+_size,value);
+      _file.write(value,static_cast<std::streamsize>(_size));
+      p+=_size;
+    }
+  }
+
+  // check every index of a triangle list points at a vertex in the streams
+  template <typename T> bool indicesInRange(const void *_indices, uint64_t _numIndices, uint64_t _numVertices) noexcept
+  {
+    const T *indices=static_cast<const T *>(_indices);
+    for(uint64_t i=0; i<_numIndices; ++i)
+    {
+      if(indices[i]>=_numVertices)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void padTo(std::ofstream &_file, uint64_t &io_offset, uint64_t _target) noexcept
+  {
+    static const char zero[s_sectionAlign]={0};
+    _file.write(zero,static_cast<std::streamsize>(_target-io_offset));
+    io_offset=_target;
+  }
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 bool NCCABinMesh::load(const std::string &_fname,bool _calcBB) noexcept
 {
-
-  // open a file stream for ip in binary mode
-  std::fstream file;
-  file.open(_fname.c_str(),std::ios::in | std::ios::binary);
-  // see if it worked
-  if (!file.is_open())
+  m_vao=false;
+  m_indexed=false;
+  m_version=0;
+  m_data=BinaryData();
+  m_streams.clear();
+  m_indexStream.clear();
+  if(!m_file.open(_fname))
   {
     std::cerr<<"problems Opening File "<<_fname<<std::endl;
     return false;
   }
-  // lets read in the header and see if the file is valid
-  char header[9];
-  file.read(header,8*sizeof(char));
-  header[8]=0; // for strcmp we need \n
   // basically I used the magick string ngl::bin (I presume unique in files!) and
-  // we test against it.
-  if(strcmp(header,"ngl::bin"))
+  // we test against it, version 2 files use ngl:bin2
+  bool loaded=false;
+  if(m_file.size()>=8 && std::memcmp(m_file.data(),s_magicV2,8)==0)
+  {
+    loaded=loadV2();
+  }
+  else if(m_file.size()>=8 && std::memcmp(m_file.data(),s_magicV1,8)==0)
+  {
+    loaded=loadV1();
+    // we have copied all we need so don't keep the file
+    m_file.close();
+  }
+  else
+  {
+    std::cerr<<"this is not an ngl::bin file "<<_fname<<std::endl;
+  }
+  if(!loaded)
   {
-    // best close the file and exit
-    file.close();
-    std::cout<<"this is not an ngl::bin file "<<std::endl;
+    m_file.close();
     return false;
   }
-
-  /// The number of vertices in the object
-  file.read(reinterpret_cast <char *> (&m_nVerts),sizeof(unsigned long int));
-  /// The number of normals in the object
-  file.read(reinterpret_cast <char *>(&m_nNorm),sizeof(unsigned long int));
-  /// the number of texture co-ordinates in the object
-  file.read(reinterpret_cast <char *>(&m_nTex),sizeof(unsigned long int));
-  /// the number of faces in the object
-  file.read(reinterpret_cast <char *>(&m_nFaces),sizeof(unsigned long int));
-  // now the x,y,z for the center could re-calc but why bother
-  file.read(reinterpret_cast <char *>(&m_center.m_x),sizeof(Real));
-  file.read(reinterpret_cast <char *>(&m_center.m_y),sizeof(Real));
-  file.read(reinterpret_cast <char *>(&m_center.m_z),sizeof(Real));
-  // now if texture is active
-  file.read(reinterpret_cast <char *>(&m_texture),sizeof(bool));
-  // the dimensions of the Bounding box
-  file.read(reinterpret_cast <char *>(&m_maxX),sizeof(Real));
-  file.read(reinterpret_cast <char *>(&m_maxY),sizeof(Real));
-  file.read(reinterpret_cast <char *>(&m_maxZ),sizeof(Real));
-  file.read(reinterpret_cast <char *>(&m_minX),sizeof(Real));
-  file.read(reinterpret_cast <char *>(&m_minY),sizeof(Real));
-  file.read(reinterpret_cast <char *>(&m_minZ),sizeof(Real));
-  // now how our data is packed for the VBO
-  file.read(reinterpret_cast <char *>(&  m_dataPackType),sizeof(GLuint));
-  file.read(reinterpret_cast <char *>(&  m_indexSize),sizeof(unsigned int));
-  file.read(reinterpret_cast <char *>(&  m_bufferPackSize),sizeof(unsigned int));
-  /// now we read how big the actual vbo data is
-  unsigned int size;
-  file.read(reinterpret_cast <char *>(&size),sizeof(unsigned int));
-  // allocate some memory to read into
-  std::unique_ptr <Real>vboMem( new Real[size]);
-  // then read into this buffer
-  file.read(reinterpret_cast<char *>(vboMem.get()),size);
-  // now we need the index arrays so first find how big
-  file.read(reinterpret_cast <char *>(&size),sizeof(unsigned int));
-  // now re-size our std::vector so add the data
-  m_outIndices.resize(size);
-  // then loop and copy the values in from the file.
-  for( unsigned int i=0; i<size; ++i)
-  {
-    file.read(reinterpret_cast <char *>(&m_outIndices[i]),sizeof(unsigned int));
-  }
-
-  // now were done with the file lets close it
-
-  file.close();
-  // and now allocate this as a vbo
-  glGenBuffers(1, &m_vboBuffers);
-  glBindBuffer(GL_ARRAY_BUFFER, m_vboBuffers);
-
-  // resize buffer
-  glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr> (m_indexSize*m_bufferPackSize*sizeof(GLfloat)), vboMem.get(), GL_DYNAMIC_DRAW);
+  m_nVerts=m_data.m_nVerts;
+  m_nNorm=m_data.m_nNorm;
+  m_nTex=m_data.m_nTex;
+  m_nFaces=m_data.m_nFaces;
+  m_center=m_data.m_center;
+  m_minX=m_data.m_min.m_x;
+  m_minY=m_data.m_min.m_y;
+  m_minZ=m_data.m_min.m_z;
+  m_maxX=m_data.m_max.m_x;
+  m_maxY=m_data.m_max.m_y;
+  m_maxZ=m_data.m_max.m_z;
+  m_dataPackType=GL_TRIANGLES;
   // create the BBox for the obj
   if(_calcBB)
   {
     m_ext.reset(new BBox(m_minX,m_maxX,m_minY,m_maxY,m_minZ,m_maxZ) );
   }
-  m_vbo=true;
+  m_loaded=true;
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool NCCABinMesh::loadV2() noexcept
+{
+  const char *base=m_file.data();
+  const uint64_t fileSize=m_file.size();
+  if(fileSize<s_headerSize || getLE<uint32_t>(base+Version)!=s_version)
+  {
+    std::cerr<<"unsupported ngl:bin2 header\n";
+    return false;
+  }
+  uint32_t flags=getLE<uint32_t>(base+Flags);
+  m_data.m_numVertices=getLE<uint64_t>(base+NumVertices);
+  m_data.m_numIndices=getLE<uint64_t>(base+NumIndices);
+  m_data.m_indexBytes=getLE<uint32_t>(base+IndexBytes);
+  m_data.m_nVerts=getLE<uint32_t>(base+SourceCounts);
+  m_data.m_nNorm=getLE<uint32_t>(base+SourceCounts+4);
+  m_data.m_nTex=getLE<uint32_t>(base+SourceCounts+8);
+  m_data.m_nFaces=getLE<uint32_t>(base+SourceCounts+12);
+  Real bounds[9];
+  for(size_t i=0; i<9; ++i)
+  {
+    bounds[i]=getLE<float>(base+Bounds+i*4);
+  }
+  m_data.m_center.set(bounds[0],bounds[1],bounds[2]);
+  m_data.m_min.set(bounds[3],bounds[4],bounds[5]);
+  m_data.m_max.set(bounds[6],bounds[7],bounds[8]);
+  uint64_t offsets[4];
+  for(size_t i=0; i<4; ++i)
+  {
+    offsets[i]=getLE<uint64_t>(base+Sections+i*8);
+  }
+  if(m_data.m_indexBytes!=2 && m_data.m_indexBytes!=4)
+  {
+    std::cerr<<"ngl:bin2 file has invalid index size "<<m_data.m_indexBytes<<"\n";
+    return false;
+  }
+  // the counts come from the file so make sure the section sizes computed from them can't wrap
+  if(m_data.m_numVertices>fileSize/(3*sizeof(float)) || m_data.m_numIndices>fileSize/m_data.m_indexBytes)
+  {
+    std::cerr<<"ngl:bin2 file has invalid vertex or index counts\n";
+    return false;
+  }
+  // check every section is aligned, in order and inside the file so we can point straight at them
+  const uint64_t sizes[4]=
+  {
+    m_data.m_numVertices*3*sizeof(float),
+    (flags & s_hasNormals) ? m_data.m_numVertices*3*sizeof(float) : 0,
+    (flags & s_hasUVs) ? m_data.m_numVertices*2*sizeof(float) : 0,
+    m_data.m_numIndices*m_data.m_indexBytes
+  };
+  uint64_t end=s_headerSize;
+  for(size_t i=0; i<4; ++i)
+  {
+    if(sizes[i]==0)
+    {
+      continue;
+    }
+    if(offsets[i]<end || offsets[i]%s_sectionAlign !=0 || sizes[i]>fileSize || offsets[i]>fileSize-sizes[i])
+    {
+      std::cerr<<"ngl:bin2 file is truncated or has a bad section table\n";
+      return false;
+    }
+    end=offsets[i]+sizes[i];
+  }
+  if(hostIsLittleEndian())
+  {
+    // zero copy, the streams are used directly from the mapped file
+    m_data.m_positions=reinterpret_cast<const Real *>(base+offsets[Positions]);
+    m_data.m_normals= sizes[Normals] ? reinterpret_cast<const Real *>(base+offsets[Normals]) : nullptr;
+    m_data.m_uvs= sizes[UVs] ? reinterpret_cast<const Real *>(base+offsets[UVs]) : nullptr;
+    m_data.m_indices=base+offsets[Indices];
+  }
+  else
+  {
+    // big endian so we have to swap everything into our own buffers
+    size_t numFloats=static_cast<size_t>((sizes[Positions]+sizes[Normals]+sizes[UVs])/sizeof(float));
+    m_streams.resize(numFloats);
+    size_t f=0;
+    for(size_t s=Positions; s<=UVs; ++s)
+    {
+      for(uint64_t i=0; i<sizes[s]; i+=sizeof(float))
+      {
+        m_streams[f++]=getLE<float>(base+offsets[s]+i);
+      }
+    }
+    m_indexStream.resize(static_cast<size_t>(sizes[Indices]));
+    for(uint64_t i=0; i<sizes[Indices]; i+=m_data.m_indexBytes)
+    {
+      std::reverse_copy(base+offsets[Indices]+i,base+offsets[Indices]+i+m_data.m_indexBytes,&m_indexStream[i]);
+    }
+    m_data.m_positions=m_streams.data();
+    m_data.m_normals= sizes[Normals] ? m_streams.data()+m_data.m_numVertices*3 : nullptr;
+    m_data.m_uvs= sizes[UVs] ? m_streams.data()+(sizes[Positions]+sizes[Normals])/sizeof(float) : nullptr;
+    m_data.m_indices=m_indexStream.data();
+  }
+  bool inRange= m_data.m_indexBytes==2 ?
+                indicesInRange<uint16_t>(m_data.m_indices,m_data.m_numIndices,m_data.m_numVertices) :
+                indicesInRange<uint32_t>(m_data.m_indices,m_data.m_numIndices,m_data.m_numVertices);
+  if(!inRange)
+  {
+    std::cerr<<"ngl:bin2 file has indices outside the vertex streams\n";
+    return false;
+  }
+  m_version=2;
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool NCCABinMesh::loadV1() noexcept
+{
+  // version 1 was written field by field from the in memory types, the counts were unsigned long
+  // which is 8 bytes on the 64 bit platforms it was used on, followed by the packed VBO data of
+  // u,v,nx,ny,nz,x,y,z per triangle corner
+  const char *p=m_file.data()+8;
+  const char *end=m_file.data()+m_file.size();
+  const size_t headerSize=4*8+3*4+1+6*4+4*4;
+  if(static_cast<size_t>(end-p)<headerSize)
+  {
+    std::cerr<<"ngl::bin file is truncated\n";
+    return false;
+  }
+  m_data.m_nVerts=static_cast<uint32_t>(getLE<uint64_t>(p));
+  m_data.m_nNorm=static_cast<uint32_t>(getLE<uint64_t>(p+8));
+  m_data.m_nTex=static_cast<uint32_t>(getLE<uint64_t>(p+16));
+  m_data.m_nFaces=static_cast<uint32_t>(getLE<uint64_t>(p+24));
+  p+=32;
+  m_data.m_center.set(getLE<float>(p),getLE<float>(p+4),getLE<float>(p+8));
+  p+=12;
+  m_texture= *p!=0;
+  p+=1;
+  m_data.m_max.set(getLE<float>(p),getLE<float>(p+4),getLE<float>(p+8));
+  m_data.m_min.set(getLE<float>(p+12),getLE<float>(p+16),getLE<float>(p+20));
+  p+=24;
+  // data pack type and index size are not needed as the byte count gives us the vertex count
+  uint32_t packSize=getLE<uint32_t>(p+8);
+  uint32_t size=getLE<uint32_t>(p+12);
+  p+=16;
+  if(packSize!=8 || size>static_cast<size_t>(end-p))
+  {
+    std::cerr<<"unsupported ngl::bin data (pack size "<<packSize<<")\n";
+    return false;
+  }
+  // the index list that follows was never written correctly so it is ignored, the corners are
+  // de-duplicated here instead using the same open addressing scheme as AbstractMesh::buildIndexedData
+  const size_t stride=8*sizeof(float);
+  const size_t numCorners=size/stride;
+  size_t tableSize=1;
+  while(tableSize < numCorners*2)
+  {
+    tableSize<<=1;
+  }
+  std::vector<uint32_t> table(tableSize,0xffffffff);
+  std::vector<uint32_t> indices(numCorners);
+  std::vector<const char *> unique;
+  for(size_t c=0; c<numCorners; ++c)
+  {
+    const char *corner=p+c*stride;
+    uint64_t h=14695981039346656037ULL;
+    for(size_t i=0; i<stride; ++i)
+    {
+      h=(h^static_cast<unsigned char>(corner[i]))*1099511628211ULL;
+    }
+    size_t slot=static_cast<size_t>(h) & (tableSize-1);
+    for(;;)
+    {
+      uint32_t id=table[slot];
+      if(id==0xffffffff)
+      {
+        id=static_cast<uint32_t>(unique.size());
+        table[slot]=id;
+        unique.push_back(corner);
+      }
+      if(std::memcmp(unique[id],corner,stride)==0)
+      {
+        indices[c]=id;
+        break;
+      }
+      slot=(slot+1) & (tableSize-1);
+    }
+  }
+  const size_t numVerts=unique.size();
+  m_streams.resize(numVerts*8);
+  Real *pos=m_streams.data();
+  Real *norm=pos+numVerts*3;
+  Real *uv=norm+numVerts*3;
+  for(size_t v=0; v<numVerts; ++v)
+  {
+    const char *d=unique[v];
+    uv[v*2]=getLE<float>(d);
+    uv[v*2+1]=getLE<float>(d+4);
+    for(size_t i=0; i<3; ++i)
+    {
+      norm[v*3+i]=getLE<float>(d+8+i*4);
+      pos[v*3+i]=getLE<float>(d+20+i*4);
+    }
+  }
+  m_indexStream.resize(numCorners*sizeof(uint32_t));
+  if(numCorners!=0)
+  {
+    std::memcpy(m_indexStream.data(),indices.data(),m_indexStream.size());
+  }
+  m_data.m_positions=pos;
+  m_data.m_normals=norm;
+  m_data.m_uvs=uv;
+  m_data.m_indices=m_indexStream.data();
+  m_data.m_numVertices=numVerts;
+  m_data.m_numIndices=numCorners;
+  m_data.m_indexBytes=4;
+  m_version=1;
   return true;
 }
 
@@ -135,13 +416,148 @@ NCCABinMesh::NCCABinMesh(const std::string& _fname,const std::string& _texName
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void NCCABinMesh::save( const std::string& _fname) noexcept
+void NCCABinMesh::createVAO() noexcept
+{
+  if(m_vao == true)
+  {
+    std::cout<<"VAO exist so returning\n";
+    return;
+  }
+  if(m_data.m_numIndices==0)
+  {
+    std::cerr<<"no mesh data loaded to create VAO from\n";
+    return;
+  }
+  // the vertex streams are contiguous (with some alignment padding) so are uploaded as a single
+  // buffer and the attributes point at each section
+  const Real *base=m_data.m_positions;
+  const Real *end=base+m_data.m_numVertices*3;
+  if(m_data.m_normals !=nullptr)
+  {
+    end=m_data.m_normals+m_data.m_numVertices*3;
+  }
+  if(m_data.m_uvs !=nullptr)
+  {
+    end=m_data.m_uvs+m_data.m_numVertices*2;
+  }
+  m_vaoMesh.reset( VAOFactory::createVAO("simpleIndexVAO",GL_TRIANGLES));
+  m_vaoMesh->bind();
+  m_vaoMesh->setData(SimpleIndexVAO::VertexData(static_cast<size_t>(end-base)*sizeof(Real),*base,
+                                                static_cast<unsigned int>(m_data.m_numIndices),m_data.m_indices,
+                                                m_data.m_indexBytes==2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT));
+  // same attributes as AbstractMesh::createVAO, vert 0, uv 1, normal 2
+  m_vaoMesh->setVertexAttributePointer(0,3,GL_FLOAT,0,0);
+  if(m_data.m_uvs !=nullptr)
+  {
+    m_vaoMesh->setVertexAttributePointer(1,2,GL_FLOAT,0,static_cast<unsigned int>(m_data.m_uvs-base));
+  }
+  if(m_data.m_normals !=nullptr)
+  {
+    m_vaoMesh->setVertexAttributePointer(2,3,GL_FLOAT,0,static_cast<unsigned int>(m_data.m_normals-base));
+  }
+  m_meshSize=m_data.m_numIndices;
+  m_vaoMesh->setNumIndices(m_meshSize);
+  m_vaoMesh->unbind();
+  m_vao=true;
+  m_indexed=true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool NCCABinMesh::save( const std::string& _fname) noexcept
+{
+  return saveNCCABinaryMesh(_fname);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool NCCABinMesh::saveNCCABinaryMesh( const std::string& _fname) noexcept
 {
-  AbstractMesh::saveNCCABinaryMesh(_fname);
+  if(m_version==0)
+  {
+    std::cerr<<"no mesh data loaded to save\n";
+    return false;
+  }
+  return writeFile(_fname,m_data);
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+bool NCCABinMesh::writeFile( const std::string &_fname, const BinaryData &_data ) noexcept
+{
+  if(_data.m_positions==nullptr || (_data.m_indexBytes!=2 && _data.m_indexBytes!=4))
+  {
+    std::cerr<<"invalid mesh data passed to NCCABinMesh::writeFile\n";
+    return false;
+  }
+  uint64_t sizes[4]=
+  {
+    _data.m_numVertices*3*sizeof(float),
+    _data.m_normals ? _data.m_numVertices*3*sizeof(float) : 0,
+    _data.m_uvs ? _data.m_numVertices*2*sizeof(float) : 0,
+    _data.m_numIndices*_data.m_indexBytes
+  };
+  uint64_t offsets[4];
+  uint64_t end=s_headerSize;
+  for(size_t i=0; i<4; ++i)
+  {
+    offsets[i]= sizes[i] ? alignSection(end) : 0;
+    end= sizes[i] ? offsets[i]+sizes[i] : end;
+  }
 
+  char header[s_headerSize]={0};
+  std::memcpy(header+Magic,s_magicV2,8);
+  putLE<uint32_t>(header+Version,s_version);
+  putLE<uint32_t>(header+Flags,(sizes[Normals] ? s_hasNormals : 0) | (sizes[UVs] ? s_hasUVs : 0));
+  putLE<uint64_t>(header+NumVertices,_data.m_numVertices);
+  putLE<uint64_t>(header+NumIndices,_data.m_numIndices);
+  putLE<uint32_t>(header+IndexBytes,_data.m_indexBytes);
+  putLE<uint32_t>(header+SourceCounts,_data.m_nVerts);
+  putLE<uint32_t>(header+SourceCounts+4,_data.m_nNorm);
+  putLE<uint32_t>(header+SourceCounts+8,_data.m_nTex);
+  putLE<uint32_t>(header+SourceCounts+12,_data.m_nFaces);
+  const Vec3 *bounds[3]={&_data.m_center,&_data.m_min,&_data.m_max};
+  for(size_t i=0; i<3; ++i)
+  {
+    putLE<float>(header+Bounds+i*12,bounds[i]->m_x);
+    putLE<float>(header+Bounds+i*12+4,bounds[i]->m_y);
+    putLE<float>(header+Bounds+i*12+8,bounds[i]->m_z);
+  }
+  for(size_t i=0; i<4; ++i)
+  {
+    putLE<uint64_t>(header+Sections+i*8,offsets[i]);
+  }
+  putLE<uint64_t>(header+FileSize,end);
 
-} //end ngl namespace
+  std::ofstream file(_fname.c_str(),std::ios::out | std::ios::binary);
+  if (!file.is_open())
+  {
+    std::cerr<<"problems Opening File "<<_fname<<std::endl;
+    return false;
+  }
+  file.write(header,s_headerSize);
+  uint64_t offset=s_headerSize;
+  const void *streams[4]={_data.m_positions,_data.m_normals,_data.m_uvs,_data.m_indices};
+  const size_t elementSize[4]={sizeof(float),sizeof(float),sizeof(float),_data.m_indexBytes};
+  for(size_t i=0; i<4; ++i)
+  {
+    if(sizes[i]==0)
+    {
+      continue;
+    }
+    padTo(file,offset,offsets[i]);
+    writeLE(file,streams[i],sizes[i]/elementSize[i],elementSize[i]);
+    offset+=sizes[i];
+  }
+  return file.good();
+}
 
+//----------------------------------------------------------------------------------------------------------------------
+bool NCCABinMesh::convert( const std::string &_v1Name, const std::string &_v2Name ) noexcept
+{
+  NCCABinMesh mesh;
+  if(!mesh.load(_v1Name,false))
+  {
+    return false;
+  }
+  return mesh.save(_v2Name);
+}
 
+} //end ngl namespace
@@ -16,10 +16,18 @@
 */
 
 #include "NCCAPointBake.h"
-#include "rapidxml/rapidxml.hpp"
-#include <boost/lexical_cast.hpp>
-#include <boost/tokenizer.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include "MappedFile.h"
+#include "TextScanner.h"
 //----------------------------------------------------------------------------------------------------------------------
 /// @file NCCAPointBake.cpp
 /// @brief implementation files for NCCAPointBake class
@@ -27,7 +35,1086 @@
 
 namespace ngl
 {
-  typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
+namespace
+{
+  static_assert(sizeof(Vec3)==3*sizeof(float),"binary point bakes are copied directly into Vec3 arrays");
+  const char s_magicV1[]="ngl::binpb";
+  const char s_magicV2[]="ngl:bpb2";
+  const uint32_t s_version=2;
+  const size_t s_headerSize=64;
+  const size_t s_frameAlign=64;
+  // v1 header is the magic then 4 unsigned ints and a bool
+  const size_t s_headerSizeV1=10+4*sizeof(uint32_t)+1;
+  // header field offsets for version 2
+  enum HeaderField : size_t
+  {
+    Magic=0, Version=8, Encoding=12, NumFrames=16, NumVerts=20, StartFrame=24, FrameTable=32, FileSize=40,
+    GridStep=48, KeyInterval=56
+  };
+  // how the frame data is stored
+  enum Encoding : uint32_t {RawFloat=0, Quantised=1};
+
+  bool hostIsLittleEndian() noexcept
+  {
+    const uint16_t test=1;
+    unsigned char first;
+    std::memcpy(&first,&test,1);
+    return first==1;
+  }
+
+  // read / write a value stored little endian
+  template <typename T> T getLE(const char *_p) noexcept
+  {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes,_p,sizeof(T));
+    if(!hostIsLittleEndian())
+    {
+      std::reverse(bytes,bytes+sizeof(T));
+    }
+    T value;
+    std::memcpy(&value,bytes,sizeof(T));
+    return value;
+  }
+
+  template <typename T> void putLE(char *_p, T _value) noexcept
+  {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes,&_value,sizeof(T));
+    if(!hostIsLittleEndian())
+    {
+      std::reverse(bytes,bytes+sizeof(T));
+    }
+    std::memcpy(_p,bytes,sizeof(T));
+  }
+
+  // where each frame lives in a binary bake file
+  struct BakeIndex
+  {
+    uint32_t m_numFrames=0;
+    uint32_t m_nVerts=0;
+    uint32_t m_startFrame=0;
+    uint32_t m_encoding=RawFloat;
+    double m_step=0.0;
+    std::vector<uint64_t> m_offset;
+    std::vector<uint64_t> m_size;
+  };
+
+  // Quantised frames : positions are snapped to a grid of spacing 2*tolerance (the header GridStep)
+  // so each coordinate becomes an integer. Keyframes store every vertex relative to the previous one
+  // starting from the frame's bounding box min, other frames store the difference from a prediction
+  // made from the previous one or two frames. The residuals are zig-zag coded, split into byte planes
+  // (x for all verts then y then z) and every plane that isn't all zero is run through a small LZ coder.
+  enum FrameType : uint8_t {KeyFrame=0, DeltaFrame=1, Delta2Frame=2};
+  enum PlaneMode : uint8_t {ZeroPlane=0, RawPlane=1, LZPlane=2};
+  const unsigned int s_numPlanes=12;
+  // frame header is the type, 12 plane modes, padding, the int64 grid origin then the uint32 plane sizes
+  enum FrameField : size_t {Type=0, Modes=1, Origin=16, PlaneSizes=40, PlaneData=40+s_numPlanes*4};
+  const unsigned int s_lzMinMatch=4;
+  const unsigned int s_lzHashBits=14;
+  const uint32_t s_noFrame=0xffffffff;
+  // the LZ decoder copies in 8 and 16 byte chunks so needs this much room after the end of the output
+  const size_t s_lzSlack=32;
+
+  inline uint32_t zigZag(int32_t _v) noexcept
+  {
+    return (static_cast<uint32_t>(_v)<<1) ^ static_cast<uint32_t>(_v>>31);
+  }
+
+  inline int32_t unZigZag(uint32_t _v) noexcept
+  {
+    return static_cast<int32_t>((_v>>1) ^ (0u-(_v&1)));
+  }
+
+  inline uint32_t read32(const uint8_t *_p) noexcept
+  {
+    uint32_t value;
+    std::memcpy(&value,_p,4);
+    return value;
+  }
+
+  // lengths of 15 or more are continued in the following bytes, 255 meaning there is another byte
+  void putLength(std::vector<uint8_t> &o_out, size_t _length) noexcept
+  {
+    for(; _length>=255; _length-=255)
+    {
+      o_out.push_back(255);
+    }
+    o_out.push_back(static_cast<uint8_t>(_length));
+  }
+
+  bool getLength(const uint8_t *&_p, const uint8_t *_end, size_t &io_length) noexcept
+  {
+    uint8_t byte;
+    do
+    {
+      if(_p==_end)
+      {
+        return false;
+      }
+      byte=*_p++;
+      io_length+=byte;
+    } while(byte==255);
+    return true;
+  }
+
+  // each sequence is a token (literal length, match length - 4) the literals then a 16 bit offset back
+  // to the match, the last sequence is literals only
+  void lzSequence(std::vector<uint8_t> &o_out, const uint8_t *_literals, size_t _numLiterals, size_t _offset, size_t _matchLength) noexcept
+  {
+    const size_t match=_matchLength>0 ? _matchLength-s_lzMinMatch : 0;
+    o_out.push_back(static_cast<uint8_t>((std::min<size_t>(_numLiterals,15)<<4) | std::min<size_t>(match,15)));
+    if(_numLiterals>=15)
+    {
+      putLength(o_out,_numLiterals-15);
+    }
+    o_out.insert(o_out.end(),_literals,_literals+_numLiterals);
+    if(_matchLength>0)
+    {
+      o_out.push_back(static_cast<uint8_t>(_offset));
+      o_out.push_back(static_cast<uint8_t>(_offset>>8));
+      if(match>=15)
+      {
+        putLength(o_out,match-15);
+      }
+    }
+  }
+
+  // greedy LZ77 using a hash of the next 4 bytes to find a previous match, appends to o_out
+  void lzCompress(const uint8_t *_src, size_t _size, std::vector<uint32_t> &io_table, std::vector<uint8_t> &o_out) noexcept
+  {
+    // the table holds position+1 so 0 is empty
+    io_table.assign(1u<<s_lzHashBits,0);
+    size_t anchor=0;
+    size_t i=0;
+    while(i+s_lzMinMatch<=_size)
+    {
+      const uint32_t sequence=read32(_src+i);
+      const uint32_t hash=(sequence*2654435761u)>>(32-s_lzHashBits);
+      const size_t candidate=io_table[hash];
+      io_table[hash]=static_cast<uint32_t>(i+1);
+      if(candidate!=0 && i-(candidate-1)<=0xffff && read32(_src+candidate-1)==sequence)
+      {
+        const size_t ref=candidate-1;
+        size_t length=s_lzMinMatch;
+        while(i+length<_size && _src[ref+length]==_src[i+length])
+        {
+          ++length;
+        }
+        lzSequence(o_out,_src+anchor,i-anchor,i-ref,length);
+        i+=length;
+        anchor=i;
+      }
+      else
+      {
+        ++i;
+      }
+    }
+    lzSequence(o_out,_src+anchor,_size-anchor,0,0);
+  }
+
+  // returns false if the data is corrupt or doesn't decode to exactly _dstSize bytes, o_dst must have
+  // s_lzSlack bytes of space after _dstSize
+  bool lzDecompress(const uint8_t *_src, size_t _srcSize, uint8_t *o_dst, size_t _dstSize) noexcept
+  {
+    const uint8_t *ip=_src;
+    const uint8_t *ipEnd=_src+_srcSize;
+    uint8_t *op=o_dst;
+    uint8_t *opEnd=o_dst+_dstSize;
+    while(ip<ipEnd)
+    {
+      const uint8_t token=*ip++;
+      size_t literals=token>>4;
+      if(literals==15 && !getLength(ip,ipEnd,literals))
+      {
+        return false;
+      }
+      if(static_cast<size_t>(ipEnd-ip)<literals || static_cast<size_t>(opEnd-op)<literals)
+      {
+        return false;
+      }
+      // short runs of literals are copied with a single fixed size move that may write into the slack
+      if(literals<=16 && ipEnd-ip>=16)
+      {
+        std::memcpy(op,ip,16);
+      }
+      else
+      {
+        std::memcpy(op,ip,literals);
+      }
+      ip+=literals;
+      op+=literals;
+      if(ip==ipEnd)
+      {
+        break;
+      }
+      if(ipEnd-ip<2)
+      {
+        return false;
+      }
+      const size_t offset=ip[0] | (static_cast<size_t>(ip[1])<<8);
+      ip+=2;
+      size_t length=token&15;
+      if(length==15 && !getLength(ip,ipEnd,length))
+      {
+        return false;
+      }
+      length+=s_lzMinMatch;
+      if(offset==0 || offset>static_cast<size_t>(op-o_dst) || static_cast<size_t>(opEnd-op)<length)
+      {
+        return false;
+      }
+      const uint8_t *ref=op-offset;
+      if(offset>=8)
+      {
+        // each chunk only reads bytes already written, the last may run into the slack
+        for(size_t k=0; k<length; k+=8)
+        {
+          std::memcpy(op+k,ref+k,8);
+        }
+      }
+      else if(offset==1)
+      {
+        std::memset(op,*ref,length);
+      }
+      else
+      {
+        // overlapping copy repeats the pattern
+        for(size_t k=0; k<length; ++k)
+        {
+          op[k]=ref[k];
+        }
+      }
+      op+=length;
+    }
+    return op==opEnd;
+  }
+
+  // the grid positions of the last frame coded plus scratch buffers, a decoder or encoder keeps one
+  // of these so playing frames in order only has to apply each frame's residuals once
+  struct QuantState
+  {
+    uint32_t m_frame=s_noFrame;
+    // the frame before m_frame is in m_prev (needed for Delta2Frame)
+    bool m_hasPrev=false;
+    int64_t m_origin[3]={0,0,0};
+    // grid position relative to m_origin, x for all verts then y then z
+    std::vector<int32_t> m_q;
+    std::vector<int32_t> m_prev;
+    std::vector<uint32_t> m_residual;
+    // the byte planes of one axis while decoding and an all zero plane
+    std::vector<uint8_t> m_planes;
+    std::vector<uint8_t> m_zero;
+    std::vector<uint8_t> m_plane;
+    std::vector<uint8_t> m_packed;
+    std::vector<uint32_t> m_table;
+    std::vector<int64_t> m_grid;
+  };
+
+  // put a residual back together from the byte planes of its axis, planes at or above Planes are zero
+  template <unsigned int Planes> inline uint32_t gatherResidual(const uint8_t *const *_planes, uint32_t _v) noexcept
+  {
+    uint32_t r=_planes[0][_v];
+    if(Planes>1)
+    {
+      r|=static_cast<uint32_t>(_planes[1][_v])<<8;
+    }
+    if(Planes>2)
+    {
+      r|=static_cast<uint32_t>(_planes[2][_v])<<16;
+    }
+    if(Planes>3)
+    {
+      r|=static_cast<uint32_t>(_planes[3][_v])<<24;
+    }
+    return r;
+  }
+
+  // add the residuals of one axis to the prediction, delta frames write the new positions over the
+  // older frame in io_prev and the caller swaps them. The encoder guarantees the results fit in an
+  // int32 so wrapping unsigned arithmetic gives the same answer
+  template <unsigned int Planes> void applyResiduals(uint8_t _type, const uint8_t *const *_planes, uint32_t _nVerts, int32_t *io_q, int32_t *io_prev) noexcept
+  {
+    if(_type==KeyFrame)
+    {
+      uint32_t acc=0;
+      for(uint32_t v=0; v<_nVerts; ++v)
+      {
+        acc+=static_cast<uint32_t>(unZigZag(gatherResidual<Planes>(_planes,v)));
+        io_q[v]=static_cast<int32_t>(acc);
+      }
+    }
+    else if(_type==DeltaFrame)
+    {
+      for(uint32_t v=0; v<_nVerts; ++v)
+      {
+        const uint32_t r=static_cast<uint32_t>(unZigZag(gatherResidual<Planes>(_planes,v)));
+        io_prev[v]=static_cast<int32_t>(static_cast<uint32_t>(io_q[v])+r);
+      }
+    }
+    else
+    {
+      for(uint32_t v=0; v<_nVerts; ++v)
+      {
+        const uint32_t r=static_cast<uint32_t>(unZigZag(gatherResidual<Planes>(_planes,v)));
+        io_prev[v]=static_cast<int32_t>(2u*static_cast<uint32_t>(io_q[v])-static_cast<uint32_t>(io_prev[v])+r);
+      }
+    }
+  }
+
+  // apply one compressed frame to the state which must hold the frame before unless this is a keyframe,
+  // if this fails part way the state is left invalid
+  bool applyQuantisedFrame(const char *_src, uint64_t _size, uint32_t _frame, uint32_t _nVerts, QuantState &io_state) noexcept
+  {
+    if(_size<PlaneData)
+    {
+      return false;
+    }
+    const uint8_t type=static_cast<uint8_t>(_src[Type]);
+    if(type>Delta2Frame)
+    {
+      return false;
+    }
+    if(type!=KeyFrame && (io_state.m_frame==s_noFrame || io_state.m_frame+1!=_frame))
+    {
+      return false;
+    }
+    if(type==Delta2Frame && !io_state.m_hasPrev)
+    {
+      return false;
+    }
+    const uint8_t *planes[s_numPlanes];
+    uint32_t sizes[s_numPlanes];
+    uint8_t modes[s_numPlanes];
+    const uint8_t *payload=reinterpret_cast<const uint8_t *>(_src)+PlaneData;
+    uint64_t remaining=_size-PlaneData;
+    if(io_state.m_zero.size()!=_nVerts)
+    {
+      io_state.m_zero.assign(_nVerts,0);
+    }
+    for(unsigned int p=0; p<s_numPlanes; ++p)
+    {
+      modes[p]=static_cast<uint8_t>(_src[Modes+p]);
+      sizes[p]=getLE<uint32_t>(_src+PlaneSizes+p*4);
+      if(sizes[p]>remaining || modes[p]>LZPlane || (modes[p]==RawPlane && sizes[p]!=_nVerts))
+      {
+        return false;
+      }
+      planes[p]= modes[p]==ZeroPlane ? io_state.m_zero.data() : payload;
+      payload+=sizes[p];
+      remaining-=sizes[p];
+    }
+
+    const size_t n=static_cast<size_t>(_nVerts)*3;
+    io_state.m_q.resize(n);
+    if(type!=KeyFrame)
+    {
+      io_state.m_prev.resize(n);
+    }
+    io_state.m_frame=s_noFrame;
+    const size_t stride=_nVerts+s_lzSlack;
+    io_state.m_planes.resize(4*stride);
+    for(unsigned int c=0; c<3; ++c)
+    {
+      for(unsigned int b=0; b<4; ++b)
+      {
+        if(modes[c*4+b]==LZPlane)
+        {
+          uint8_t *plane=&io_state.m_planes[b*stride];
+          if(!lzDecompress(planes[c*4+b],sizes[c*4+b],plane,_nVerts))
+          {
+            return false;
+          }
+          planes[c*4+b]=plane;
+        }
+      }
+      // the high planes are usually all zero so only gather the ones that aren't
+      unsigned int used=1;
+      for(unsigned int b=1; b<4; ++b)
+      {
+        if(modes[c*4+b]!=ZeroPlane)
+        {
+          used=b+1;
+        }
+      }
+      if(type==KeyFrame)
+      {
+        io_state.m_origin[c]=getLE<int64_t>(_src+Origin+c*8);
+      }
+      int32_t *q=&io_state.m_q[c*_nVerts];
+      int32_t *prev= type==KeyFrame ? nullptr : &io_state.m_prev[c*_nVerts];
+      switch(used)
+      {
+        case 1 : applyResiduals<1>(type,&planes[c*4],_nVerts,q,prev); break;
+        case 2 : applyResiduals<2>(type,&planes[c*4],_nVerts,q,prev); break;
+        case 3 : applyResiduals<3>(type,&planes[c*4],_nVerts,q,prev); break;
+        default : applyResiduals<4>(type,&planes[c*4],_nVerts,q,prev); break;
+      }
+    }
+    if(type!=KeyFrame)
+    {
+      io_state.m_q.swap(io_state.m_prev);
+    }
+    io_state.m_hasPrev= type!=KeyFrame;
+    io_state.m_frame=_frame;
+    return true;
+  }
+
+  // quantise _data and encode it as the frame after io_state.m_frame (or a keyframe) into o_out
+  bool encodeQuantisedFrame(const std::vector<Vec3> &_data, uint32_t _frame, double _step, uint32_t _keyInterval, QuantState &io_state, std::vector<char> &o_out) noexcept
+  {
+    const uint32_t nVerts=static_cast<uint32_t>(_data.size());
+    const size_t n=static_cast<size_t>(nVerts)*3;
+    io_state.m_grid.resize(n);
+    int64_t gridMin[3]={0,0,0};
+    int64_t gridMax[3]={0,0,0};
+    for(unsigned int c=0; c<3; ++c)
+    {
+      int64_t *grid=&io_state.m_grid[c*nVerts];
+      for(uint32_t v=0; v<nVerts; ++v)
+      {
+        const double value=static_cast<double>(_data[v].m_openGL[c])/_step;
+        if(!(std::abs(value)<9.0e18))
+        {
+          std::cerr<<"point bake frame "<<_frame<<" has values that can't be quantised\n";
+          return false;
+        }
+        grid[v]=std::llround(value);
+      }
+      if(nVerts>0)
+      {
+        auto range=std::minmax_element(grid,grid+nVerts);
+        gridMin[c]=*range.first;
+        gridMax[c]=*range.second;
+      }
+      if(gridMax[c]-gridMin[c]>std::numeric_limits<int32_t>::max()/2)
+      {
+        std::cerr<<"point bake frame "<<_frame<<" is too large for the tolerance requested\n";
+        return false;
+      }
+    }
+    // keep using the current grid origin if this frame still fits in it
+    bool key=io_state.m_frame==s_noFrame || io_state.m_frame+1!=_frame || _frame%_keyInterval==0;
+    for(unsigned int c=0; c<3 && !key; ++c)
+    {
+      key=gridMin[c]-io_state.m_origin[c]<std::numeric_limits<int32_t>::min()/2 ||
+          gridMax[c]-io_state.m_origin[c]>std::numeric_limits<int32_t>::max()/2;
+    }
+    io_state.m_residual.resize(n);
+    io_state.m_q.resize(n);
+    uint8_t type=KeyFrame;
+    if(!key)
+    {
+      // pick whichever prediction gives the smallest residuals, these are then guaranteed to fit as
+      // the current and predicted values are both within half the int32 range
+      int64_t cost1=0;
+      int64_t cost2=0;
+      for(unsigned int c=0; c<3; ++c)
+      {
+        const int64_t *grid=&io_state.m_grid[c*nVerts];
+        const int32_t *q=&io_state.m_q[c*nVerts];
+        const int32_t *prev=io_state.m_hasPrev ? &io_state.m_prev[c*nVerts] : nullptr;
+        for(uint32_t v=0; v<nVerts; ++v)
+        {
+          const int64_t current=grid[v]-io_state.m_origin[c];
+          cost1+=std::abs(current-q[v]);
+          if(prev!=nullptr)
+          {
+            cost2+=std::abs(current-(2*static_cast<int64_t>(q[v])-prev[v]));
+          }
+        }
+      }
+      type=(io_state.m_hasPrev && cost2<cost1) ? Delta2Frame : DeltaFrame;
+      int64_t worst=0;
+      for(size_t i=0; i<n && type==Delta2Frame; ++i)
+      {
+        worst=std::max(worst,std::abs(2*static_cast<int64_t>(io_state.m_q[i])-io_state.m_prev[i]));
+      }
+      if(worst>std::numeric_limits<int32_t>::max()/2)
+      {
+        type=DeltaFrame;
+      }
+      io_state.m_prev.resize(n);
+      for(unsigned int c=0; c<3; ++c)
+      {
+        const int64_t *grid=&io_state.m_grid[c*nVerts];
+        for(size_t i=c*nVerts; i<(c+1)*nVerts; ++i)
+        {
+          const int32_t current=static_cast<int32_t>(grid[i-c*nVerts]-io_state.m_origin[c]);
+          const int64_t predict= type==Delta2Frame ? 2*static_cast<int64_t>(io_state.m_q[i])-io_state.m_prev[i] : io_state.m_q[i];
+          io_state.m_residual[i]=zigZag(static_cast<int32_t>(current-predict));
+          io_state.m_prev[i]=io_state.m_q[i];
+          io_state.m_q[i]=current;
+        }
+      }
+      io_state.m_hasPrev=true;
+    }
+    else
+    {
+      for(unsigned int c=0; c<3; ++c)
+      {
+        io_state.m_origin[c]=gridMin[c];
+        const int64_t *grid=&io_state.m_grid[c*nVerts];
+        int32_t last=0;
+        for(size_t i=c*nVerts; i<(c+1)*nVerts; ++i)
+        {
+          const int32_t current=static_cast<int32_t>(grid[i-c*nVerts]-gridMin[c]);
+          // both are in [0,int32 max] so the difference fits
+          io_state.m_residual[i]=zigZag(current-last);
+          io_state.m_q[i]=last=current;
+        }
+      }
+      io_state.m_hasPrev=false;
+    }
+    io_state.m_frame=_frame;
+
+    o_out.assign(PlaneData,0);
+    o_out[Type]=static_cast<char>(type);
+    for(unsigned int c=0; c<3; ++c)
+    {
+      putLE<int64_t>(&o_out[Origin+c*8],io_state.m_origin[c]);
+    }
+    io_state.m_plane.resize(nVerts);
+    for(unsigned int p=0; p<s_numPlanes; ++p)
+    {
+      const unsigned int shift=(p%4)*8;
+      const uint32_t *residual=&io_state.m_residual[(p/4)*nVerts];
+      bool zero=true;
+      for(uint32_t v=0; v<nVerts; ++v)
+      {
+        io_state.m_plane[v]=static_cast<uint8_t>(residual[v]>>shift);
+        zero&=io_state.m_plane[v]==0;
+      }
+      uint8_t mode=ZeroPlane;
+      size_t size=0;
+      if(!zero)
+      {
+        io_state.m_packed.clear();
+        lzCompress(io_state.m_plane.data(),nVerts,io_state.m_table,io_state.m_packed);
+        if(io_state.m_packed.size()<nVerts)
+        {
+          mode=LZPlane;
+          size=io_state.m_packed.size();
+          o_out.insert(o_out.end(),io_state.m_packed.begin(),io_state.m_packed.end());
+        }
+        else
+        {
+          mode=RawPlane;
+          size=nVerts;
+          o_out.insert(o_out.end(),io_state.m_plane.begin(),io_state.m_plane.end());
+        }
+      }
+      o_out[Modes+p]=static_cast<char>(mode);
+      putLE<uint32_t>(&o_out[PlaneSizes+p*4],static_cast<uint32_t>(size));
+    }
+    return true;
+  }
+
+  // read the header and frame table from either version of the binary format
+  bool readBakeIndex(const MappedFile &_file, BakeIndex &o_index) noexcept
+  {
+    const char *base=_file.data();
+    const uint64_t fileSize=_file.size();
+    if(fileSize>=s_headerSize && std::memcmp(base,s_magicV2,8)==0)
+    {
+      if(getLE<uint32_t>(base+Version)!=s_version)
+      {
+        std::cerr<<"unsupported ngl:bpb2 version\n";
+        return false;
+      }
+      o_index.m_encoding=getLE<uint32_t>(base+Encoding);
+      o_index.m_numFrames=getLE<uint32_t>(base+NumFrames);
+      o_index.m_nVerts=getLE<uint32_t>(base+NumVerts);
+      o_index.m_startFrame=getLE<uint32_t>(base+StartFrame);
+      uint64_t table=getLE<uint64_t>(base+FrameTable);
+      if(o_index.m_encoding!=RawFloat && o_index.m_encoding!=Quantised)
+      {
+        std::cerr<<"unknown point bake encoding "<<o_index.m_encoding<<"\n";
+        return false;
+      }
+      o_index.m_step=getLE<double>(base+GridStep);
+      if(o_index.m_encoding==Quantised && !(o_index.m_step>0.0 && std::isfinite(o_index.m_step)))
+      {
+        std::cerr<<"ngl:bpb2 quantised bake has an invalid grid step\n";
+        return false;
+      }
+      if(table>fileSize || (fileSize-table)/16 < o_index.m_numFrames)
+      {
+        std::cerr<<"ngl:bpb2 frame table is truncated\n";
+        return false;
+      }
+      o_index.m_offset.resize(o_index.m_numFrames);
+      o_index.m_size.resize(o_index.m_numFrames);
+      for(uint32_t f=0; f<o_index.m_numFrames; ++f)
+      {
+        o_index.m_offset[f]=getLE<uint64_t>(base+table+f*16);
+        o_index.m_size[f]=getLE<uint64_t>(base+table+f*16+8);
+      }
+    }
+    else if(fileSize>=s_headerSizeV1 && std::memcmp(base,s_magicV1,10)==0)
+    {
+      // version 1 stores numFrames, currFrame, nVerts, startFrame and a bool then the frames back to back
+      o_index.m_numFrames=getLE<uint32_t>(base+10);
+      o_index.m_nVerts=getLE<uint32_t>(base+18);
+      o_index.m_startFrame=getLE<uint32_t>(base+22);
+      const uint64_t frameSize=static_cast<uint64_t>(o_index.m_nVerts)*3*sizeof(float);
+      o_index.m_offset.resize(o_index.m_numFrames);
+      o_index.m_size.assign(o_index.m_numFrames,frameSize);
+      for(uint32_t f=0; f<o_index.m_numFrames; ++f)
+      {
+        o_index.m_offset[f]=s_headerSizeV1+f*frameSize;
+      }
+    }
+    else
+    {
+      std::cerr<<"this is not an ngl::binpb file "<<std::endl;
+      return false;
+    }
+    // make sure every frame is inside the file
+    const uint64_t frameSize= o_index.m_encoding==Quantised ? PlaneData : static_cast<uint64_t>(o_index.m_nVerts)*3*sizeof(float);
+    for(uint32_t f=0; f<o_index.m_numFrames; ++f)
+    {
+      if(o_index.m_size[f]<frameSize || o_index.m_offset[f]>fileSize || fileSize-o_index.m_offset[f]<o_index.m_size[f])
+      {
+        std::cerr<<"point bake frame "<<f<<" is truncated\n";
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // decode a single frame from the file into o_data, quantised frames are decoded from the previous
+  // keyframe unless io_state already holds the frame before. If the frame is corrupt o_data is zeroed
+  // and false returned
+  bool decodeFrame(const char *_base, const BakeIndex &_index, uint32_t _frame, std::vector<Vec3> &o_data, QuantState &io_state) noexcept
+  {
+    o_data.resize(_index.m_nVerts);
+    if(_index.m_encoding==Quantised)
+    {
+      if(io_state.m_frame!=_frame)
+      {
+        uint32_t first=_frame;
+        if(io_state.m_frame==s_noFrame || io_state.m_frame+1!=_frame)
+        {
+          while(first>0 && _base[_index.m_offset[first]+Type]!=KeyFrame)
+          {
+            --first;
+          }
+        }
+        for(uint32_t f=first; f<=_frame; ++f)
+        {
+          if(!applyQuantisedFrame(_base+_index.m_offset[f],_index.m_size[f],f,_index.m_nVerts,io_state))
+          {
+            std::cerr<<"point bake frame "<<f<<" is corrupt\n";
+            io_state.m_frame=s_noFrame;
+            std::fill(o_data.begin(),o_data.end(),Vec3(0.0f,0.0f,0.0f));
+            return false;
+          }
+        }
+      }
+      const uint32_t nVerts=_index.m_nVerts;
+      const int32_t *x=&io_state.m_q[0];
+      const int32_t *y=&io_state.m_q[nVerts];
+      const int32_t *z=&io_state.m_q[2*nVerts];
+      const float step=static_cast<float>(_index.m_step);
+      const float originX=static_cast<float>(io_state.m_origin[0]*_index.m_step);
+      const float originY=static_cast<float>(io_state.m_origin[1]*_index.m_step);
+      const float originZ=static_cast<float>(io_state.m_origin[2]*_index.m_step);
+      Vec3 *out=o_data.data();
+      for(uint32_t v=0; v<nVerts; ++v)
+      {
+        out[v].m_x=originX+static_cast<float>(x[v])*step;
+        out[v].m_y=originY+static_cast<float>(y[v])*step;
+        out[v].m_z=originZ+static_cast<float>(z[v])*step;
+      }
+      return true;
+    }
+    const char *src=_base+_index.m_offset[_frame];
+    if(hostIsLittleEndian())
+    {
+      std::memcpy(o_data.data(),src,_index.m_nVerts*3*sizeof(float));
+    }
+    else
+    {
+      for(auto &v : o_data)
+      {
+        v.set(getLE<float>(src),getLE<float>(src+4),getLE<float>(src+8));
+        src+=12;
+      }
+    }
+    return true;
+  }
+
+  // write the header, frames and frame table of a version 2 bake, _encode fills in each frame's data
+  bool writeBake(const std::string &_fileName, uint32_t _numFrames, uint32_t _nVerts, uint32_t _startFrame,
+                 uint32_t _encoding, double _step, uint32_t _keyInterval,
+                 const std::function<bool(uint32_t, std::vector<char> &)> &_encode) noexcept
+  {
+    std::ofstream file(_fileName.c_str(),std::ios::out | std::ios::binary);
+    if (!file.is_open())
+    {
+      std::cerr<<"problems Opening File "<<_fileName<<std::endl;
+      return false;
+    }
+    // the header is re-written at the end once we know where the frame table is
+    char header[s_headerSize]={0};
+    file.write(header,s_headerSize);
+    uint64_t offset=s_headerSize;
+    std::vector<char> table(_numFrames*16);
+    static const char zero[s_frameAlign]={0};
+    std::vector<char> data;
+    for(uint32_t frame =0; frame<_numFrames; ++frame)
+    {
+      if(!_encode(frame,data))
+      {
+        return false;
+      }
+      uint64_t aligned=(offset+s_frameAlign-1) & ~static_cast<uint64_t>(s_frameAlign-1);
+      file.write(zero,static_cast<std::streamsize>(aligned-offset));
+      putLE<uint64_t>(&table[frame*16],aligned);
+      putLE<uint64_t>(&table[frame*16+8],data.size());
+      file.write(data.data(),static_cast<std::streamsize>(data.size()));
+      offset=aligned+data.size();
+    }
+    file.write(table.data(),static_cast<std::streamsize>(table.size()));
+
+    std::memcpy(header+Magic,s_magicV2,8);
+    putLE<uint32_t>(header+Version,s_version);
+    putLE<uint32_t>(header+Encoding,_encoding);
+    putLE<uint32_t>(header+NumFrames,_numFrames);
+    putLE<uint32_t>(header+NumVerts,_nVerts);
+    putLE<uint32_t>(header+StartFrame,_startFrame);
+    putLE<uint64_t>(header+FrameTable,offset);
+    putLE<uint64_t>(header+FileSize,offset+table.size());
+    putLE<double>(header+GridStep,_step);
+    putLE<uint32_t>(header+KeyInterval,_keyInterval);
+    file.seekp(0);
+    file.write(header,s_headerSize);
+    return file.good();
+  }
+
+  // XML bakes are scanned in place in the mapped file rather than building a DOM, the scanners stop at
+  // the < of the closing tags so never read past the end of the frame / element they are given
+  inline bool isXMLSpace(char _c) noexcept { return _c==' ' || _c=='\t' || _c=='\r' || _c=='\n'; }
+
+  // find the start of the tag _tag (e.g. "<Frame") in [_p,_end), returns _end if it isn't there
+  template <size_t N> const char *findTag(const char *_p, const char *_end, const char (&_tag)[N]) noexcept
+  {
+    const size_t length=N-1;
+    while(_p<_end)
+    {
+      _p=static_cast<const char *>(std::memchr(_p,'<',static_cast<size_t>(_end-_p)));
+      if(_p==nullptr)
+      {
+        return _end;
+      }
+      // make sure we have the whole name and not just the start of a longer one
+      if(static_cast<size_t>(_end-_p)>length && std::memcmp(_p,_tag,length)==0 &&
+         (isXMLSpace(_p[length]) || _p[length]=='>' || _p[length]=='/'))
+      {
+        return _p;
+      }
+      ++_p;
+    }
+    return _end;
+  }
+
+  // the text of the element <_tag>text</_tag> in [_p,_end)
+  template <size_t N> bool elementText(const char *_p, const char *_end, const char (&_tag)[N], const char *&o_begin, const char *&o_end) noexcept
+  {
+    const char *tag=findTag(_p,_end,_tag);
+    const char *open= tag==_end ? nullptr : static_cast<const char *>(std::memchr(tag,'>',static_cast<size_t>(_end-tag)));
+    if(open==nullptr)
+    {
+      return false;
+    }
+    o_begin=open+1;
+    o_end=static_cast<const char *>(std::memchr(o_begin,'<',static_cast<size_t>(_end-o_begin)));
+    return o_end!=nullptr;
+  }
+
+  // an unsigned value held in an element before _end
+  template <size_t N> bool elementValue(const char *_p, const char *_end, const char (&_tag)[N], unsigned int &o_value) noexcept
+  {
+    const char *begin;
+    const char *end;
+    if(!elementText(_p,_end,_tag,begin,end))
+    {
+      return false;
+    }
+    while(begin<end && isXMLSpace(*begin))
+    {
+      ++begin;
+    }
+    int64_t value;
+    if(!text::scanInt(begin,value) || value<0 || value>std::numeric_limits<unsigned int>::max())
+    {
+      return false;
+    }
+    o_value=static_cast<unsigned int>(value);
+    return true;
+  }
+
+  // the number="n" attribute of the tag starting at _p, o_body is set to the text after the tag
+  bool numberAttribute(const char *_p, const char *_end, int64_t &o_value, const char *&o_body) noexcept
+  {
+    const char *close=static_cast<const char *>(std::memchr(_p,'>',static_cast<size_t>(_end-_p)));
+    if(close==nullptr)
+    {
+      return false;
+    }
+    o_body=close+1;
+    for(const char *p=_p+1; p+6<close; ++p)
+    {
+      if(std::memcmp(p,"number",6)!=0 || !isXMLSpace(p[-1]))
+      {
+        continue;
+      }
+      p+=6;
+      while(p<close && isXMLSpace(*p)) { ++p; }
+      if(p==close || *p!='=') { return false; }
+      for(++p; p<close && isXMLSpace(*p); ++p) {}
+      if(p==close || (*p!='"' && *p!='\'')) { return false; }
+      ++p;
+      return text::scanInt(p,o_value);
+    }
+    return false;
+  }
+
+  // read the <Vertex number="n"> x y z </Vertex> elements of a frame, _end is the start of </Frame>
+  // @returns the number of vertices that couldn't be read
+  size_t parseXMLFrame(const char *_p, const char *_end, std::vector<Vec3> &o_frame) noexcept
+  {
+    size_t bad=0;
+    for(;;)
+    {
+      _p=findTag(_p,_end,"<Vertex");
+      if(_p==_end)
+      {
+        return bad;
+      }
+      int64_t index;
+      const char *body;
+      if(!numberAttribute(_p,_end,index,body) || index<0 || static_cast<uint64_t>(index)>=o_frame.size())
+      {
+        ++bad;
+        ++_p;
+        continue;
+      }
+      Real values[3];
+      unsigned int c=0;
+      for( ; c<3; ++c)
+      {
+        while(body<_end && isXMLSpace(*body)) { ++body; }
+        if(body==_end || !text::scanReal(body,values[c]))
+        {
+          break;
+        }
+      }
+      if(c==3)
+      {
+        o_frame[static_cast<size_t>(index)].set(values[0],values[1],values[2]);
+      }
+      else
+      {
+        ++bad;
+      }
+      _p=body;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief a least recently used cache of decoded frames over a mapped bake file, requested frames are
+/// decoded on the calling thread and the following frames are decoded on a worker thread. The last
+/// s_pinnedFrames frames handed to the caller are never evicted (by either thread) as the caller may
+/// still be reading them.
+//----------------------------------------------------------------------------------------------------------------------
+class NCCAPointBake::FrameStream
+{
+  public :
+    FrameStream(unsigned int _cacheFrames, unsigned int _prefetch) noexcept
+    {
+      // we need room for the pinned frames, the prefetched frames and one to load into
+      m_prefetch=_prefetch;
+      m_slots.resize(std::max(_cacheFrames,_prefetch+s_pinnedFrames+1));
+    }
+    ~FrameStream() noexcept
+    {
+      if(m_worker.joinable())
+      {
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          m_quit=true;
+        }
+        m_work.notify_all();
+        m_worker.join();
+      }
+    }
+    bool open(const std::string &_fileName) noexcept
+    {
+      if(!m_file.open(_fileName,MappedFile::Access::Random))
+      {
+        std::cerr<<"problems Opening File "<<_fileName<<std::endl;
+        return false;
+      }
+      if(!readBakeIndex(m_file,m_index))
+      {
+        return false;
+      }
+      m_fileName=_fileName;
+      if(m_prefetch>0)
+      {
+        m_worker=std::thread(&FrameStream::prefetchFrames,this);
+      }
+      return true;
+    }
+    const BakeIndex &index() const noexcept{return m_index;}
+    bool hasCorruptFrames() const noexcept{return m_corrupt;}
+    const std::string &fileName() const noexcept{return m_fileName;}
+    std::vector<Vec3> &frame(uint32_t _frame) noexcept
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      Slot *slot=findSlot(_frame);
+      // the worker may be part way through decoding the frame we want
+      while(slot !=nullptr && slot->m_state==State::Loading)
+      {
+        m_ready.wait(lock);
+        slot=findSlot(_frame);
+      }
+      if(slot==nullptr)
+      {
+        slot=victim();
+        slot->m_frame=_frame;
+        slot->m_state=State::Loading;
+        lock.unlock();
+        decode(_frame,slot->m_data,m_callerState);
+        lock.lock();
+        slot->m_state=State::Ready;
+        m_ready.notify_all();
+      }
+      slot->m_lastUse=++m_clock;
+      // the caller now holds this frame as well as the ones before it
+      if(m_pinned[0]!=slot)
+      {
+        std::copy_backward(m_pinned,m_pinned+s_pinnedFrames-1,m_pinned+s_pinnedFrames);
+        m_pinned[0]=slot;
+      }
+      // replace any outstanding requests with the frames following this one
+      if(m_prefetch>0)
+      {
+        m_queue.clear();
+        for(uint32_t i=1; i<=m_prefetch && _frame+i<m_index.m_numFrames; ++i)
+        {
+          m_queue.push_back(_frame+i);
+        }
+        m_work.notify_one();
+      }
+      return slot->m_data;
+    }
+
+  private :
+    static constexpr unsigned int s_pinnedFrames=2;
+    enum class State : char {Empty,Loading,Ready};
+    struct Slot
+    {
+      uint32_t m_frame=0;
+      State m_state=State::Empty;
+      uint64_t m_lastUse=0;
+      std::vector<Vec3> m_data;
+    };
+    // decode a frame then drop its pages from our resident set, the file may be bigger than memory
+    void decode(uint32_t _frame, std::vector<Vec3> &o_data, QuantState &io_state) noexcept
+    {
+      if(!decodeFrame(m_file.data(),m_index,_frame,o_data,io_state))
+      {
+        m_corrupt=true;
+      }
+      m_file.release(m_index.m_offset[_frame],m_index.m_size[_frame]);
+    }
+    // these must be called with the mutex locked
+    Slot *findSlot(uint32_t _frame) noexcept
+    {
+      for(auto &slot : m_slots)
+      {
+        if(slot.m_state!=State::Empty && slot.m_frame==_frame)
+        {
+          return &slot;
+        }
+      }
+      return nullptr;
+    }
+    bool isPinned(const Slot &_slot) const noexcept
+    {
+      return std::find(m_pinned,m_pinned+s_pinnedFrames,&_slot)!=m_pinned+s_pinnedFrames;
+    }
+    Slot *victim() noexcept
+    {
+      Slot *oldest=nullptr;
+      for(auto &slot : m_slots)
+      {
+        if(slot.m_state==State::Empty)
+        {
+          return &slot;
+        }
+        if(slot.m_state==State::Ready && !isPinned(slot) && (oldest==nullptr || slot.m_lastUse<oldest->m_lastUse))
+        {
+          oldest=&slot;
+        }
+      }
+      return oldest;
+    }
+    void prefetchFrames() noexcept
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      for(;;)
+      {
+        m_work.wait(lock,[this]{return m_quit || !m_queue.empty();});
+        if(m_quit)
+        {
+          return;
+        }
+        uint32_t frame=m_queue.front();
+        m_queue.pop_front();
+        if(findSlot(frame)!=nullptr)
+        {
+          continue;
+        }
+        Slot *slot=victim();
+        if(slot==nullptr)
+        {
+          continue;
+        }
+        slot->m_frame=frame;
+        slot->m_state=State::Loading;
+        slot->m_lastUse=++m_clock;
+        lock.unlock();
+        decode(frame,slot->m_data,m_workerState);
+        lock.lock();
+        slot->m_state=State::Ready;
+        m_ready.notify_all();
+      }
+    }
+
+    MappedFile m_file;
+    std::string m_fileName;
+    BakeIndex m_index;
+    // each decoding thread follows its own run of frames through a quantised bake
+    QuantState m_callerState;
+    QuantState m_workerState;
+    std::vector<Slot> m_slots;
+    // the slots last returned by frame(), most recent first
+    Slot *m_pinned[s_pinnedFrames]={nullptr,nullptr};
+    uint64_t m_clock=0;
+    unsigned int m_prefetch=0;
+    std::deque<uint32_t> m_queue;
+    std::mutex m_mutex;
+    std::condition_variable m_work;
+    std::condition_variable m_ready;
+    std::thread m_worker;
+    bool m_quit=false;
+    // set by either thread when a frame fails to decode
+    std::atomic<bool> m_corrupt{false};
+};
 
 //----------------------------------------------------------------------------------------------------------------------
 NCCAPointBake::NCCAPointBake() noexcept
@@ -41,7 +1128,7 @@ NCCAPointBake::NCCAPointBake() noexcept
 	m_binFile=false;
 }
 
-bool NCCAPointBake::loadPointBake(const std::string &_fileName) noexcept
+bool NCCAPointBake::loadPointBake(const std::string &_fileName, unsigned int _numThreads) noexcept
 {
 	m_numFrames=0;
 	m_currFrame=0;
@@ -50,86 +1137,107 @@ bool NCCAPointBake::loadPointBake(const std::string &_fileName) noexcept
 	m_endFrame=0;
 	m_mesh=0;
 	m_binFile=false;
-	rapidxml::xml_node<> * rootNode;
-	// Read the xml file into a vector
-	std::ifstream xmlFile (_fileName.c_str() );
-	if(!xmlFile.is_open())
-	{
-		std::cerr<<"Could not open file\n";
-		return false;
-	}
-	std::vector<char> buffer((std::istreambuf_iterator<char>(xmlFile)), std::istreambuf_iterator<char>());
-	buffer.push_back('\0');
-	rapidxml::xml_document<> doc;
-
-	doc.parse<rapidxml::parse_trim_whitespace>(&buffer[0]);
-	rootNode=doc.first_node();
-	if(rootNode->name() !=std::string("NCCAPointBake"))
-	{
-		std::cerr<<"this is not a pointbake file \n";
-		return false;
-	}
-
-  rapidxml::xml_node<> * child=rootNode->first_node("MeshName");
-  m_meshName=child->value();
-  std::cerr<<"found mesh "<<m_meshName<<"\n";
-
-
-  child=rootNode->first_node("NumVerts");
-  m_nVerts=boost::lexical_cast<unsigned int>(child->value());
-  std::cerr<<"NumVerts "<<m_nVerts<<"\n";
-  child=rootNode->first_node("StartFrame");
-  m_startFrame=boost::lexical_cast<unsigned int>(child->value());
-  std::cerr<<"StartFrame"<<m_startFrame<<"\n";
-  child=rootNode->first_node("EndFrame");
-  m_endFrame=boost::lexical_cast<unsigned int>(child->value());
-  std::cerr<<"EndFrame"<<m_endFrame<<"\n";
-  child=rootNode->first_node("NumFrames");
-  m_numFrames=boost::lexical_cast< unsigned int>(child->value());
-  std::cerr<<"EndFrame  "<<m_numFrames<<"\n";
-  //first allocate base pointer [vertex]
-  m_data.resize(m_numFrames);
-  //cout <<"Size is now"<<m_data.size()<<endl;
-  //now for each of these we need to allocate more space
-  // NOTE the use of a reference here as we are changing the size
-  for(auto &data : m_data)
-  {
-    data.resize(m_nVerts);
-  }
-  unsigned int CurrentFrame=0;
-  // this is the line we wish to parse
-  std::string lineBuffer;
-  // say which separators should be used in this
-  // case Spaces, Tabs and return \ new line
-  boost::char_separator<char> sep(" \t\r\n");
-  // now traverse each frame and grab the data
-  for(child=rootNode->first_node("Frame"); child; child=child->next_sibling())
-  {
-    std::cerr<<"doing frame "<<child->first_attribute("number")->value()<<"\n";
-    CurrentFrame=boost::lexical_cast<unsigned int>(child->first_attribute("number")->value());
-    CurrentFrame-=m_startFrame;
-    std::flush(std::cerr);
-
-    for(rapidxml::xml_node<> * vertex=child->first_node("Vertex"); vertex; vertex=vertex->next_sibling())
-    {
-      unsigned int index=boost::lexical_cast<unsigned int>(vertex->first_attribute("number")->value());
-      lineBuffer=vertex->value();
-      tokenizer tokens(lineBuffer, sep);
-      tokenizer::iterator  firstWord = tokens.begin();
-      Real x=boost::lexical_cast<Real>(*firstWord++);
-      Real y=boost::lexical_cast<Real>(*firstWord++);
-      Real z=boost::lexical_cast<Real>(*firstWord++);
-      m_data[CurrentFrame][index].set(x,y,z);
+	m_stream.reset();
+  MappedFile file(_fileName);
+  if(!file.isValid())
+  {
+    std::cerr<<"Could not open file\n";
+    return false;
+  }
+  const char *begin=file.data();
+  const char *end=begin+file.size();
+  const char *root=findTag(begin,end,"<NCCAPointBake");
+  if(root==end)
+  {
+    std::cerr<<"this is not a pointbake file \n";
+    return false;
+  }
+  // the header elements all come before the first frame
+  const char *firstFrame=findTag(root,end,"<Frame");
+  const char *nameBegin;
+  const char *nameEnd;
+  if(elementText(root,firstFrame,"<MeshName",nameBegin,nameEnd))
+  {
+    m_meshName.assign(nameBegin,nameEnd);
+  }
+  if(!elementValue(root,firstFrame,"<NumVerts",m_nVerts) ||
+     !elementValue(root,firstFrame,"<StartFrame",m_startFrame) ||
+     !elementValue(root,firstFrame,"<NumFrames",m_numFrames))
+  {
+    std::cerr<<"point bake header must have NumVerts, StartFrame and NumFrames\n";
+    m_nVerts=m_numFrames=0;
+    return false;
+  }
+  if(!elementValue(root,firstFrame,"<EndFrame",m_endFrame))
+  {
+    m_endFrame=m_startFrame+m_numFrames-1;
+  }
+  m_data.assign(m_numFrames,std::vector<Vec3>(m_nVerts));
 
+  // frames are independent so the file is split into chunks and each thread reads the frames that
+  // start in its chunk, the pages of each frame are dropped once read so only the frames in flight and
+  // the decoded data are held in memory
+  if(_numThreads==0)
+  {
+    _numThreads=std::max(1u,std::thread::hardware_concurrency());
+  }
+  static constexpr size_t s_minChunkSize=1<<20;
+  const size_t numChunks=std::max<size_t>(1,std::min<size_t>(_numThreads*4,static_cast<size_t>(end-firstFrame)/s_minChunkSize));
+  const size_t chunkSize=static_cast<size_t>(end-firstFrame)/numChunks;
+  std::atomic<size_t> nextChunk(0);
+  std::atomic<size_t> framesRead(0);
+  std::atomic<size_t> badVerts(0);
+  std::atomic<size_t> badFrames(0);
+  auto worker=[&]()
+  {
+    size_t c;
+    while((c=nextChunk++) < numChunks)
+    {
+      const char *chunkEnd= c==numChunks-1 ? end : firstFrame+(c+1)*chunkSize;
+      const char *frame=findTag(firstFrame+c*chunkSize,end,"<Frame");
+      while(frame<chunkEnd)
+      {
+        const char *frameEnd=findTag(frame,end,"</Frame");
+        if(frameEnd==end)
+        {
+          // truncated file, without the closing tag the scanners could run off the end
+          ++badFrames;
+          break;
+        }
+        int64_t number;
+        const char *body;
+        if(!numberAttribute(frame,frameEnd,number,body) || number<m_startFrame || number-m_startFrame>=m_numFrames)
+        {
+          ++badFrames;
+        }
+        else
+        {
+          badVerts+=parseXMLFrame(body,frameEnd,m_data[static_cast<size_t>(number-m_startFrame)]);
+          ++framesRead;
+        }
+        file.release(static_cast<uint64_t>(frame-begin),static_cast<uint64_t>(frameEnd-frame));
+        frame=findTag(frameEnd,end,"<Frame");
+      }
     }
-
+  };
+  std::vector<std::thread> threads;
+  for(unsigned int i=1; i<std::min<size_t>(_numThreads,numChunks); ++i)
+  {
+    threads.push_back(std::thread(worker));
   }
-  return true;
+  worker();
+  for(auto &t : threads)
+  {
+    t.join();
+  }
+  if(framesRead!=m_numFrames || badFrames!=0 || badVerts!=0)
+  {
+    std::cerr<<"point bake "<<_fileName<<" read "<<framesRead<<" of "<<m_numFrames<<" frames ("
+             <<badFrames<<" bad frames, "<<badVerts<<" bad verts)\n";
+  }
+  return framesRead!=0 || m_numFrames==0;
 }
 
-
-
-
 //----------------------------------------------------------------------------------------------------------------------
 NCCAPointBake::~NCCAPointBake() noexcept
 {
@@ -148,125 +1256,185 @@ void NCCAPointBake::setFrame( const unsigned int _frame) noexcept
 
 bool NCCAPointBake::loadBinaryPointBake( const std::string &_fileName) noexcept
 {
-  // open a file stream for ip in binary mode
-  std::fstream file;
-  file.open(_fileName.c_str(),std::ios::in | std::ios::binary);
+  MappedFile file(_fileName);
   // see if it worked
-  if (!file.is_open())
+  if (!file.isValid())
   {
     std::cerr<<"problems Opening File "<<_fileName<<std::endl;
     return false;
   }
-  // lets read in the header and see if the file is valid
-  char header[11];
-  file.read(header,10*sizeof(char));
-  header[10]=0; // for strcmp we need \n
-  // basically I used the magick string ngl::bin (I presume unique in files!) and
-  // we test against it.
-  if(strcmp(header,"ngl::binpb"))
-  {
-    // best close the file and exit
-    file.close();
-    std::cout<<"this is not an ngl::binpb file "<<std::endl;
+  BakeIndex index;
+  if(!readBakeIndex(file,index))
+  {
     return false;
   }
-
-  /// The number of vertices in the object
-  //file.read(reinterpret_cast <char *> (&m_nVerts),sizeof(unsigned long int));
-
-  file.read(reinterpret_cast <char *>(&m_numFrames),sizeof(unsigned int));
-  file.read(reinterpret_cast <char *>(&m_currFrame),sizeof(unsigned int));
-  file.read(reinterpret_cast <char *>(&m_nVerts),sizeof(unsigned int));
-  file.read(reinterpret_cast <char *>(&m_startFrame),sizeof(unsigned int));
-  file.read(reinterpret_cast <char *>(&m_binFile),sizeof(bool));
-  std::cout <<"Loaded header\n";
-  std::cout<<m_numFrames<<"\n";
-  std::cout<<m_currFrame<<"\n";
-  std::cout<<m_nVerts<<"\n";
-  std::cout<<m_startFrame<<"\n";
-  std::cout<<m_binFile<<"\n";
-
-  m_data.resize(m_numFrames);
-  for(unsigned int frame =0; frame<m_numFrames; ++frame)
+  // decode everything before changing anything so a corrupt file leaves the bake as it was
+  std::vector < std::vector<Vec3> > data(index.m_numFrames);
+  QuantState state;
+  for(unsigned int frame =0; frame<index.m_numFrames; ++frame)
   {
-    m_data[frame].resize(m_nVerts);
-    for(unsigned int v=0; v< m_nVerts; ++v)
+    if(!decodeFrame(file.data(),index,frame,data[frame],state))
     {
-     file.read( reinterpret_cast <char *>(&m_data[frame][v].m_x),sizeof(Real));
-     file.read( reinterpret_cast <char *>(&m_data[frame][v].m_y),sizeof(Real));
-     file.read( reinterpret_cast <char *>(&m_data[frame][v].m_z),sizeof(Real));
-   }
+      return false;
+    }
   }
+  m_stream.reset();
+  m_numFrames=index.m_numFrames;
+  m_nVerts=index.m_nVerts;
+  m_startFrame=index.m_startFrame;
+  m_endFrame=m_startFrame+m_numFrames-1;
+  m_currFrame=0;
+  m_binFile=true;
+  m_data.swap(data);
   return true;
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+bool NCCAPointBake::openBinaryPointBake(const std::string &_fileName, unsigned int _cacheFrames, unsigned int _prefetch) noexcept
+{
+  std::unique_ptr<FrameStream> stream(new FrameStream(_cacheFrames,_prefetch));
+  if(!stream->open(_fileName))
+  {
+    return false;
+  }
+  const BakeIndex &index=stream->index();
+  m_numFrames=index.m_numFrames;
+  m_nVerts=index.m_nVerts;
+  m_startFrame=index.m_startFrame;
+  m_endFrame=m_startFrame+m_numFrames-1;
+  m_currFrame=0;
+  m_binFile=true;
+  // free any fully loaded data as this is what we are trying to avoid
+  std::vector < std::vector<Vec3> >().swap(m_data);
+  m_stream=std::move(stream);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
 bool NCCAPointBake::saveBinaryPointBake( const std::string &_fileName) noexcept
 {
-  // so basically we need to save all the state data from the abstract mesh
-  // then map the vbo on the gpu and dump that in one go, this means we have to
-  // call CreateVBO first the Save
-    std::fstream file;
-    file.open(_fileName.c_str(),std::ios::out | std::ios::binary);
-    if (!file.is_open())
+  // the stream is reading from a mapping of the file so it can't be overwritten
+  if(m_stream !=nullptr && m_stream->fileName()==_fileName)
+  {
+    std::cerr<<"can't save point bake over the file being streamed "<<_fileName<<"\n";
+    return false;
+  }
+  const uint64_t frameSize=static_cast<uint64_t>(m_nVerts)*3*sizeof(float);
+  auto encode=[this,frameSize](uint32_t _frame, std::vector<char> &o_data)
+  {
+    const std::vector<Vec3> &data=getRawDataPointerAtFrame(_frame);
+    o_data.resize(frameSize);
+    if(hostIsLittleEndian())
     {
-      std::cerr<<"problems Opening File "<<_fileName<<std::endl;
-      return false;
+      std::memcpy(o_data.data(),data.data(),frameSize);
     }
-
-    // lets write out our own Magic Number file ID
-    const std::string header("ngl::binpb");
-    file.write(header.c_str(),static_cast<long>(header.length()));
-    m_binFile=true;
-    file.write(reinterpret_cast <char *>(&m_numFrames),sizeof(unsigned int));
-    file.write(reinterpret_cast <char *>(&m_currFrame),sizeof(unsigned int));
-    file.write(reinterpret_cast <char *>(&m_nVerts),sizeof(unsigned int));
-    file.write(reinterpret_cast <char *>(&m_startFrame),sizeof(unsigned int));
-    file.write(reinterpret_cast <char *>(&m_binFile),sizeof(bool));
-    std::cout<<m_numFrames<<"\n";
-    std::cout<<m_currFrame<<"\n";
-    std::cout<<m_nVerts<<"\n";
-    std::cout<<m_startFrame<<"\n";
-    std::cout<<m_binFile<<"\n";
-
-    // now write out data
-    for(unsigned int frame =0; frame<m_numFrames; ++frame)
+    else
     {
-      for(unsigned int v=0; v< m_nVerts; ++v)
+      for(unsigned int v=0; v<m_nVerts; ++v)
       {
-       file.write( reinterpret_cast <char *>(&m_data[frame][v].m_x),sizeof(Real));
-       file.write( reinterpret_cast <char *>(&m_data[frame][v].m_y),sizeof(Real));
-       file.write( reinterpret_cast <char *>(&m_data[frame][v].m_z),sizeof(Real));
-     }
+        putLE<float>(&o_data[v*12],data[v].m_x);
+        putLE<float>(&o_data[v*12+4],data[v].m_y);
+        putLE<float>(&o_data[v*12+8],data[v].m_z);
+      }
     }
-
-    file.close();
     return true;
+  };
+  if(!writeBake(_fileName,m_numFrames,m_nVerts,m_startFrame,RawFloat,0.0,1,encode))
+  {
+    return false;
+  }
+  m_binFile=true;
+  return true;
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+bool NCCAPointBake::saveCompressedPointBake(const std::string &_fileName, Real _tolerance, unsigned int _keyInterval) noexcept
+{
+  if(m_stream !=nullptr && m_stream->fileName()==_fileName)
+  {
+    std::cerr<<"can't save point bake over the file being streamed "<<_fileName<<"\n";
+    return false;
+  }
+  if(!(_tolerance>0.0f) || _keyInterval==0)
+  {
+    std::cerr<<"compressed point bakes need a tolerance > 0 and a key interval of at least 1\n";
+    return false;
+  }
+  // rounding to the nearest grid point is out by at most half the step
+  const double step=2.0*static_cast<double>(_tolerance);
+  QuantState state;
+  auto encode=[this,step,_keyInterval,&state](uint32_t _frame, std::vector<char> &o_data)
+  {
+    const std::vector<Vec3> &data=getRawDataPointerAtFrame(_frame);
+    if(data.size()!=m_nVerts)
+    {
+      std::cerr<<"point bake frame "<<_frame<<" has the wrong number of verts\n";
+      return false;
+    }
+    return encodeQuantisedFrame(data,_frame,step,_keyInterval,state,o_data);
+  };
+  if(!writeBake(_fileName,m_numFrames,m_nVerts,m_startFrame,Quantised,step,_keyInterval,encode))
+  {
+    return false;
+  }
+  m_binFile=true;
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
 void NCCAPointBake::setMeshToFrame(  const unsigned int _frame) noexcept
 {
+    const std::vector<Vec3> &frame=getRawDataPointerAtFrame(_frame);
+    // a mesh with its own position buffer just needs the positions gathered and uploaded
+    if(m_mesh->hasPositionStream())
+    {
+      m_mesh->updatePositionStream(frame);
+      m_currFrame=_frame;
+      return;
+    }
     // map the m_obj's vbo dat
     Real *ptr=m_mesh->mapVAOVerts();
-    std::vector <Face> faces=m_mesh->getFaceList();
-    //unsigned int nFaces=faces.size();
+    const FaceList &faces=m_mesh->getFaceList();
+    const std::vector<uint32_t> &offsets=faces.offsets();
+    const std::vector<uint32_t> &vertIndex=faces.vertIndices();
+    // an indexed mesh has one vertex per unique (vert,normal,uv) so we just walk the index refs
+    if(m_mesh->isIndexed())
+    {
+      unsigned int step=0;
+      for(const auto &ref : m_mesh->getIndices())
+      {
+        const Vec3 &v=frame[ref.m_v];
+        ptr[step+5]=v.m_x;
+        ptr[step+6]=v.m_y;
+        ptr[step+7]=v.m_z;
+        step+=8;
+      }
+      m_mesh->unMapVAO();
+      m_currFrame=_frame;
+      return;
+    }
     // loop for each of the faces
     unsigned int step=0;
-    for(auto face : faces)
+    for(size_t f=0; f<faces.size(); ++f)
     {
-      // now for each triangle in the face (remember we ensured tri when loading)
+      // now for each triangle in the face (polygons are a fan around the first vert as in createVAO)
       // loop for all the verts and set the new vert value
       // the data is packed uv, nx,ny,nz then x,y,z
       // as we only want to change x,y,z, we need to skip over
       // stuff
-
-      for(unsigned int j=0;j<3;++j)
+      uint32_t first=offsets[f];
+      for(uint32_t k=first+1; k+1<offsets[f+1]; ++k)
       {
-        ptr[step+5]=m_data[_frame][face.m_vert[j]].m_x;
-        ptr[step+6]=m_data[_frame][face.m_vert[j]].m_y;
-        ptr[step+7]=m_data[_frame][face.m_vert[j]].m_z;
-        step+=8;
+        const uint32_t corners[3]={first,k,k+1};
+        for(auto c : corners)
+        {
+          const Vec3 &v=frame[vertIndex[c]];
+          ptr[step+5]=v.m_x;
+          ptr[step+6]=v.m_y;
+          ptr[step+7]=v.m_z;
+          step+=8;
+        }
       }
-
     }
 
     // unmap the vbo as we have finished updating
@@ -297,10 +1465,20 @@ bool NCCAPointBake::attachMesh(AbstractMesh *_mesh) noexcept
 }
 
 
+//----------------------------------------------------------------------------------------------------------------------
+bool NCCAPointBake::hasCorruptFrames() const noexcept
+{
+  return m_stream !=nullptr && m_stream->hasCorruptFrames();
+}
+
 //----------------------------------------------------------------------------------------------------------------------
 std::vector<Vec3> & NCCAPointBake::getRawDataPointerAtFrame(unsigned int _f) noexcept
 {
-	NGL_ASSERT(_f<=m_numFrames);
+	NGL_ASSERT(_f<m_numFrames);
+	if(m_stream !=nullptr)
+	{
+		return m_stream->frame(_f);
+	}
 	return m_data[_f];
 }
 
@@ -14,11 +14,14 @@
     You should have received a copy of the GNU General Public License
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
-#include "boost/bind.hpp"
-
-#include "boost/spirit.hpp"
-/// @todo re-write this at some stage to use boost::spirit::qi
 #include "Obj.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include "MappedFile.h"
+#include "TextScanner.h"
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Obj.cpp
 /// @brief implementation files for Obj class
@@ -28,28 +31,259 @@
 namespace ngl
 {
 
-// make a namespace for our parser to save writing boost::spirit:: all the time
-namespace spt=boost::spirit;
+// the obj reader is a simple pointer walking scanner over a single buffer holding the whole file
+// (null terminated) this replaces the old boost::spirit classic parser which built rules and
+// temporary vectors for every line
+namespace
+{
+  using namespace text;
 
-// syntactic sugar for specifying our grammar
-typedef spt::rule<spt::phrase_scanner_t> srule;
+  inline void skipBlank(const char *&_p) noexcept
+  {
+    while(isBlank(*_p)) ++_p;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief move to the start of the next line
+  //----------------------------------------------------------------------------------------------------------------------
+  inline const char *nextLine(const char *_p) noexcept
+  {
+    while(!isEndOfLine(*_p)) ++_p;
+    return *_p=='\n' ? _p+1 : _p;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief convert an obj index (1 based or negative relative to the end of the current list)
+  /// to a zero based array index
+  //----------------------------------------------------------------------------------------------------------------------
+  inline uint32_t objIndex(int64_t _index, size_t _count) noexcept
+  {
+    return static_cast<uint32_t>(_index > 0 ? _index-1 : static_cast<int64_t>(_count)+_index);
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief skip the statement keyword (v vt vn f) at the start of the line
+  //----------------------------------------------------------------------------------------------------------------------
+  inline const char *skipKeyword(const char *_p) noexcept
+  {
+    skipBlank(_p);
+    while(!isBlank(*_p) && !isEndOfLine(*_p)) ++_p;
+    return _p;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief read up to 3 reals from the rest of the line, missing values are 0
+  /// @param[in] _begin the start of the line (pointing at the keyword)
+  //----------------------------------------------------------------------------------------------------------------------
+  inline Vec3 scanVec3(const char *_begin) noexcept
+  {
+    Real values[3]={0.0f,0.0f,0.0f};
+    const char *p=skipKeyword(_begin);
+    for(int n=0; n<3; ++n)
+    {
+      skipBlank(p);
+      if(!scanReal(p,values[n])) { break; }
+    }
+    return Vec3(values[0],values[1],values[2]);
+  }
 
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief scratch lists for the face currently being parsed, these are re-used for each face so
+  /// once they have grown to the largest face size there is no more allocation
+  //----------------------------------------------------------------------------------------------------------------------
+  struct FaceIndices
+  {
+    std::vector<uint32_t> m_vert;
+    std::vector<uint32_t> m_tex;
+    std::vector<uint32_t> m_norm;
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief add the parsed face to the list
+    //----------------------------------------------------------------------------------------------------------------------
+    void addTo(FaceList &_faces) const
+    {
+      _faces.addFace(static_cast<uint32_t>(m_vert.size()),m_vert.data(),
+                     m_tex.empty() ? nullptr : m_tex.data(),
+                     m_norm.empty() ? nullptr : m_norm.data());
+    }
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief overwrite the face _face in the list with the parsed face
+    //----------------------------------------------------------------------------------------------------------------------
+    void setIn(FaceList &_faces, size_t _face) const noexcept
+    {
+      _faces.setFace(_face,m_vert.data(),
+                     m_tex.empty() ? nullptr : m_tex.data(),
+                     m_norm.empty() ? nullptr : m_norm.data());
+    }
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief parse a face line
+  /// @param[in] _begin the start of the line (pointing at the keyword)
+  /// @param[in] _nVerts,_nTex,_nNorm the current size of each list used to resolve relative indices
+  /// @param[out] o_face the indices of the face
+  /// @param[out] o_relative set to true if any of the indices were negative (relative)
+  /// @param[in] _report report any problems with the face data to std::cerr
+  /// @returns false if the face is invalid (less than 3 vertices)
+  //----------------------------------------------------------------------------------------------------------------------
+  bool scanFace(const char *_begin, size_t _nVerts, size_t _nTex, size_t _nNorm, FaceIndices &o_face, bool &o_relative, bool _report=true) noexcept
+  {
+    o_face.m_vert.clear();
+    o_face.m_tex.clear();
+    o_face.m_norm.clear();
+    o_relative=false;
+    // each entry is always a vert, followed by optional t and norm seperated by /
+    // also it is possible to have just a V value with no /
+    const char *p=skipKeyword(_begin);
+    int64_t index;
+    for(;;)
+    {
+      skipBlank(p);
+      if(!scanInt(p,index))
+      {
+        break;
+      }
+      // index in obj start from 1 (or are negative relative to the current end of the list)
+      // so we need to convert to our array index
+      o_relative|= index<0;
+      o_face.m_vert.push_back(objIndex(index,_nVerts));
+      if(*p=='/')
+      {
+        ++p;
+        if(scanInt(p,index))
+        {
+          o_relative|= index<0;
+          o_face.m_tex.push_back(objIndex(index,_nTex));
+        }
+        if(*p=='/')
+        {
+          ++p;
+          if(scanInt(p,index))
+          {
+            o_relative|= index<0;
+            o_face.m_norm.push_back(objIndex(index,_nNorm));
+          }
+        }
+      }
+    }
+    // a face has at least 3 entries
+    if(o_face.m_vert.size()<3)
+    {
+      if(_report)
+      {
+        std::cerr <<"Face with less than 3 vertices found ignoring\n";
+      }
+      return false;
+    }
+
+    // merge in texture coordinates and normals, if present
+    // OBJ format requires an encoding for faces which uses one of the vertex/texture/normal specifications
+    // consistently across the entire face.  eg. we can have all v/vt/vn, or all v//vn, or all v, but not
+    // v//vn then v/vt/vn ... if not we pad with 0 so the lists stay the same length
+    if(!o_face.m_norm.empty() && o_face.m_norm.size() != o_face.m_vert.size())
+    {
+      if(_report)
+      {
+        std::cerr <<"Something wrong with the face data will continue but may not be correct\n";
+      }
+      o_face.m_norm.resize(o_face.m_vert.size(),0);
+    }
+    if(!o_face.m_tex.empty() && o_face.m_tex.size() != o_face.m_vert.size())
+    {
+      if(_report)
+      {
+        std::cerr <<"Something wrong with the face data will continue but may not be correct\n";
+      }
+      o_face.m_tex.resize(o_face.m_vert.size(),0);
+    }
+    return true;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the obj statements we understand, anything else (comments, groups, materials etc) is skipped
+  //----------------------------------------------------------------------------------------------------------------------
+  enum class Statement { Vertex, TextureCoordinate, Normal, Face, Other };
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief work out the statement type of the line, _p is moved past any leading white space
+  //----------------------------------------------------------------------------------------------------------------------
+  inline Statement statementType(const char *&_p) noexcept
+  {
+    skipBlank(_p);
+    if(_p[0]=='v')
+    {
+      if(isBlank(_p[1])) { return Statement::Vertex; }
+      if(_p[1]=='t' && isBlank(_p[2])) { return Statement::TextureCoordinate; }
+      if(_p[1]=='n' && isBlank(_p[2])) { return Statement::Normal; }
+    }
+    else if(_p[0]=='f' && isBlank(_p[1]))
+    {
+      return Statement::Face;
+    }
+    return Statement::Other;
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the data parsed from one chunk of the file when loading in parallel
+  //----------------------------------------------------------------------------------------------------------------------
+  struct ObjChunk
+  {
+    //----------------------------------------------------------------------------------------------------------------------
+    /// @brief a face using relative indices, this needs to be re-parsed once the chunk offsets are known
+    //----------------------------------------------------------------------------------------------------------------------
+    struct RelativeFace
+    {
+      size_t m_face;
+      const char *m_line;
+      size_t m_nVerts;
+      size_t m_nTex;
+      size_t m_nNorm;
+    };
+    const char *m_begin;
+    const char *m_end;
+    std::vector<Vec3> m_verts;
+    std::vector<Vec3> m_norm;
+    std::vector<Vec3> m_tex;
+    FaceList m_face;
+    std::vector<RelativeFace> m_relative;
+  };
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief parse all the lines in the chunk, the chunk must end with a new line so we never read past it
+  //----------------------------------------------------------------------------------------------------------------------
+  void parseChunk(ObjChunk &_chunk) noexcept
+  {
+    FaceIndices f;
+    bool relative;
+    const char *line=_chunk.m_begin;
+    while(line < _chunk.m_end)
+    {
+      const char *p=line;
+      switch(statementType(p))
+      {
+        case Statement::Vertex : _chunk.m_verts.push_back(scanVec3(p)); break;
+        case Statement::TextureCoordinate : _chunk.m_tex.push_back(scanVec3(p)); break;
+        case Statement::Normal : _chunk.m_norm.push_back(scanVec3(p)); break;
+        case Statement::Face :
+          // relative indices are resolved against the chunk for now and fixed up later
+          if(scanFace(p,_chunk.m_verts.size(),_chunk.m_tex.size(),_chunk.m_norm.size(),f,relative))
+          {
+            if(relative)
+            {
+              _chunk.m_relative.push_back({_chunk.m_face.size(),p,_chunk.m_verts.size(),_chunk.m_tex.size(),_chunk.m_norm.size()});
+            }
+            f.addTo(_chunk.m_face);
+          }
+        break;
+        case Statement::Other : break;
+      }
+      line=nextLine(p);
+    }
+  }
+
+} // end anon namespace
 
 //----------------------------------------------------------------------------------------------------------------------
 // parse a vertex
 void Obj::parseVertex( const char *_begin )  noexcept
 {
-  std::vector<Real> values;
-  // here is the parse rule to load the data into a vector (above)
-  srule vertex = "v" >> spt::real_p[spt::append(values)] >>
-                        spt::real_p[spt::append(values)] >>
-                        spt::real_p[spt::append(values)];
-  // now parse the data
-  spt::parse_info<> result = spt::parse(_begin, vertex, spt::space_p);
-  // should check this at some stage
-  NGL_UNUSED(result);
-  // and add it to our vert list in abstact mesh parent
-  m_verts.push_back(Vec3(values[0],values[1],values[2]));
+  // add it to our vert list in abstact mesh parent
+  m_verts.push_back(scanVec3(_begin));
 }
 
 
@@ -57,160 +291,199 @@ void Obj::parseVertex( const char *_begin )  noexcept
 // parse a texture coordinate
 void Obj::parseTextureCoordinate(const char * _begin ) noexcept
 {
-  std::vector<Real> values;
-  // generate our parse rule for a tex cord,
-  // this can be either a 2 or 3 d text so the *rule looks for an additional one
-  srule texcord = "vt" >> spt::real_p[spt::append(values)] >>
-                          spt::real_p[spt::append(values)] >>
-                          *(spt::real_p[spt::append(values)]);
-  spt::parse_info<> result = spt::parse(_begin, texcord, spt::space_p);
-  // should check the return values at some stage
-  NGL_UNUSED(result);
-
-  // build tex cord
-  // if we have a value use it other wise set to 0
-  Real vt3 = values.size() == 3 ? values[2] : 0.0f;
-  m_tex.push_back(Vec3(values[0],values[1],vt3));
+  // this can be either a 2 or 3 d tex so if we don't have the 3rd value it stays 0
+  m_tex.push_back(scanVec3(_begin));
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 // parse a normal
 void Obj::parseNormal( const char *_begin )  noexcept
 {
-  std::vector<Real> values;
-  // here is our rule for normals
-  srule norm = "vn" >> spt::real_p[spt::append(values)] >>
-                       spt::real_p[spt::append(values)] >>
-                       spt::real_p[spt::append(values)];
-  // parse and push back to the list
-  spt::parse_info<> result = spt::parse(_begin, norm, spt::space_p);
-  // should check the return values at some stage
-  NGL_UNUSED(result);
-  m_norm.push_back(Vec3(values[0],values[1],values[2]));
+  m_norm.push_back(scanVec3(_begin));
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 // parse face
 void Obj::parseFace(const char * _begin   )  noexcept
 {
-  // ok this one is quite complex first create some lists for our face data
-  // list to hold the vertex data indices
-  std::vector<unsigned int> vec;
-  // list to hold the tex cord indices
-  std::vector<unsigned int> tvec;
-  // list to hold the normal indices
-  std::vector<unsigned int> nvec;
-
-  // create the parse rule for a face entry V/T/N
-  // so our entry can be always a vert, followed by optional t and norm seperated by /
-  // also it is possible to have just a V value with no / so the rule should do all this
-  srule entry = spt::int_p[spt::append(vec)] >>
-    (
-      ("/" >> (spt::int_p[spt::append(tvec)] | spt::epsilon_p) >>
-       "/" >> (spt::int_p[spt::append(nvec)] | spt::epsilon_p)
-      )
-      | spt::epsilon_p
-    );
-  // a face has at least 3 of the above entries plus many optional ones
-  srule face = "f"  >> entry >> entry >> entry >> *(entry);
-  // now we've done this we can parse
- spt::parse(_begin, face, spt::space_p);
-
- unsigned int numVerts=static_cast<unsigned int>(vec.size());
-  // so now build a face structure.
-  Face f;
-  // verts are -1 the size
-  f.m_numVerts=numVerts-1;
-  f.m_textureCoord=false;
-  f.m_normals=false;
-  // copy the vertex indices into our face data structure index in obj start from 1
-  // so we need to do -1 for our array index
-  for(auto i : vec)
+  // the scratch lists are kept between calls to avoid allocating for each face
+  static thread_local FaceIndices f;
+  bool relative;
+  if(scanFace(_begin,m_verts.size(),m_tex.size(),m_norm.size(),f,relative))
   {
-    f.m_vert.push_back(i-1);
+    // finally save the face into our face list
+    f.addTo(m_face);
   }
+}
 
-  // merge in texture coordinates and normals, if present
-  // OBJ format requires an encoding for faces which uses one of the vertex/texture/normal specifications
-  // consistently across the entire face.  eg. we can have all v/vt/vn, or all v//vn, or all v, but not
-  // v//vn then v/vt/vn ...
-  if(!nvec.empty())
-  {
-    if(nvec.size() != vec.size())
-    {
-     std::cerr <<"Something wrong with the face data will continue but may not be correct\n";
-    }
+//----------------------------------------------------------------------------------------------------------------------
+bool Obj::load(const std::string &_fname,bool _calcBB )  noexcept
+{
+  // see below for the rest of the obj spec and other good format data
+  // http://local.wasp.uwa.edu.au/~pbourke/dataformats/obj/
 
-    // copy in these references to normal vectors to the mesh's normal vector
-    for(auto i : nvec)
-    {
-      f.m_norm.push_back(i-1);
-    }
-    f.m_normals=true;
+  // open the file to parse
+  std::ifstream in(_fname.c_str(),std::ios::in | std::ios::binary);
+  if (in.is_open() != true)
+  {
+    std::cout<<"FILE NOT FOUND !!!! "<<_fname.c_str()<<"\n";
+    return false;
 
   }
+  // read the whole file into a single null terminated buffer so we can parse with no
+  // further allocation or copying per line
+  in.seekg(0,std::ios::end);
+  std::streamoff size=in.tellg();
+  in.seekg(0,std::ios::beg);
+  if(size<0)
+  {
+    std::cerr<<"Problem reading obj file "<<_fname<<"\n";
+    return false;
+  }
+  std::vector<char> buffer(static_cast<size_t>(size)+1);
+  in.read(&buffer[0],size);
+  // now we are done close the file
+  in.close();
+  buffer[static_cast<size_t>(size)]='\0';
 
-  //
-  // merge in texture coordinates, if present
-  //
-  if(!tvec.empty())
+  const char *line=&buffer[0];
+  while(*line !='\0')
   {
-    if(tvec.size() != vec.size())
+    const char *p=line;
+    switch(statementType(p))
     {
-     std::cerr <<"Something wrong with the face data will continue but may not be correct\n";
+      case Statement::Vertex : parseVertex(p); break;
+      case Statement::TextureCoordinate : parseTextureCoordinate(p); break;
+      case Statement::Normal : parseNormal(p); break;
+      case Statement::Face : parseFace(p); break;
+      case Statement::Other : break;
     }
+    line=nextLine(p);
+  }
 
-    // copy in these references to normal vectors to the mesh's normal vector
-    for(auto i : tvec)
-    {
-      f.m_tex.push_back(i-1);
-    }
+  // grab the sizes used for drawing later
+  m_nVerts=static_cast<unsigned int>(m_verts.size());
+  m_nNorm=static_cast<unsigned int>(m_norm.size());
+  m_nTex=static_cast<unsigned int>(m_tex.size());
+  m_nFaces=static_cast<unsigned int>(m_face.size());
 
-    f.m_textureCoord=true;
 
+  // Calculate the center of the object.
+  if(_calcBB == true)
+  {
+    this->calcDimensions();
   }
-// finally save the face into our face list
-  m_face.push_back(f);
+  return true;
+
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-bool Obj::load(const std::string &_fname,bool _calcBB )  noexcept
+bool Obj::loadParallel(const std::string &_fname, bool _calcBB, unsigned int _numThreads )  noexcept
 {
- // here we build up our ebnf rules for parsing
-  // so first we have a comment
-  srule comment = spt::comment_p("#");
-
-  // see below for the rest of the obj spec and other good format data
-  // http://local.wasp.uwa.edu.au/~pbourke/dataformats/obj/
-
-  // vertices rule v is a parse of 3 reals and we run the parseVertex function
-  srule vertex= ("v"  >> spt::real_p >> spt::real_p >> spt::real_p) [bind(&Obj::parseVertex,boost::ref(*this), _1)];
-  /// our tex rule and binding of the parse function
-  srule tex= ("vt" >> spt::real_p >> spt::real_p) [bind(&Obj::parseTextureCoordinate, boost::ref(*this), _1)];
-  // the normal rule and parsing function
-  srule norm= ("vn" >> spt::real_p >> spt::real_p >> spt::real_p) [bind(&Obj::parseNormal,boost::ref(*this), _1)];
-
-  // our vertex data can be any of the above values
-  srule vertex_type = vertex | tex | norm;
-
-  // the rule for the face and parser
-  srule  face = (spt::ch_p('f') >> *(spt::anychar_p))[bind(&Obj::parseFace, boost::ref(*this), _1)];
-  // open the file to parse
-  std::ifstream in(_fname.c_str());
-  if (in.is_open() != true)
+  MappedFile file(_fname);
+  if(!file.isValid())
   {
     std::cout<<"FILE NOT FOUND !!!! "<<_fname.c_str()<<"\n";
     return false;
+  }
+  if(_numThreads==0)
+  {
+    _numThreads=std::max(1u,std::thread::hardware_concurrency());
+  }
+  const char *begin=file.data();
+  const char *end=begin+file.size();
+  // the mapped file is not null terminated, so the chunks only cover whole lines (up to the last new line)
+  // and any trailing line is copied into a null terminated string and parsed as a chunk of its own
+  const char *lastLine=end;
+  while(lastLine!=begin && lastLine[-1]!='\n') { --lastLine; }
+  std::string tail(lastLine,end);
+
+  // split into new line aligned chunks, using a few chunks per thread to balance the load as
+  // some parts of the file (faces) are slower to parse than others
+  static constexpr size_t s_minChunkSize=1<<20;
+  size_t numChunks=std::max<size_t>(1,std::min<size_t>(_numThreads*4,(lastLine-begin)/s_minChunkSize));
+  size_t chunkSize=(lastLine-begin)/numChunks;
+  std::vector<ObjChunk> chunks;
+  chunks.reserve(numChunks+1);
+  const char *chunkBegin=begin;
+  for(size_t i=0; i<numChunks && chunkBegin<lastLine; ++i)
+  {
+    const char *chunkEnd= i==numChunks-1 ? lastLine : chunkBegin+chunkSize;
+    if(chunkEnd>=lastLine)
+    {
+      chunkEnd=lastLine;
+    }
+    else
+    {
+      chunkEnd=static_cast<const char *>(std::memchr(chunkEnd,'\n',lastLine-chunkEnd))+1;
+    }
+    chunks.push_back(ObjChunk());
+    chunks.back().m_begin=chunkBegin;
+    chunks.back().m_end=chunkEnd;
+    chunkBegin=chunkEnd;
+  }
+  if(!tail.empty())
+  {
+    chunks.push_back(ObjChunk());
+    chunks.back().m_begin=tail.c_str();
+    chunks.back().m_end=tail.c_str()+tail.size();
+  }
 
+  // now each thread grabs the next chunk to parse until they are all done
+  std::atomic<size_t> nextChunk(0);
+  auto worker=[&chunks,&nextChunk]()
+  {
+    size_t c;
+    while((c=nextChunk++) < chunks.size())
+    {
+      parseChunk(chunks[c]);
+    }
+  };
+  std::vector<std::thread> threads;
+  for(unsigned int i=1; i<std::min<size_t>(_numThreads,chunks.size()); ++i)
+  {
+    threads.push_back(std::thread(worker));
   }
-  std::string str;
-  // loop grabbing a line and then pass it to our parsing framework
-  while(std::getline(in, str))
+  worker();
+  for(auto &t : threads)
   {
-    spt::parse(str.c_str(), vertex_type  | face | comment, spt::space_p);
+    t.join();
+  }
+
+  // prefix sum the sizes to get the offset of each chunk, then re-parse any faces with
+  // relative indices now we know where they are in the whole file
+  size_t nVerts=m_verts.size();
+  size_t nTex=m_tex.size();
+  size_t nNorm=m_norm.size();
+  size_t nFaces=m_face.size();
+  FaceIndices f;
+  size_t nIndices=m_face.numIndices();
+  for(auto &c : chunks)
+  {
+    for(auto &r : c.m_relative)
+    {
+      bool relative;
+      scanFace(r.m_line,nVerts+r.m_nVerts,nTex+r.m_nTex,nNorm+r.m_nNorm,f,relative,false);
+      f.setIn(c.m_face,r.m_face);
+    }
+    nVerts+=c.m_verts.size();
+    nTex+=c.m_tex.size();
+    nNorm+=c.m_norm.size();
+    nFaces+=c.m_face.size();
+    nIndices+=c.m_face.numIndices();
+  }
+  // finally concatenate the chunks into our lists
+  m_verts.reserve(nVerts);
+  m_tex.reserve(nTex);
+  m_norm.reserve(nNorm);
+  m_face.reserve(nFaces,nIndices);
+  for(auto &c : chunks)
+  {
+    m_verts.insert(m_verts.end(),c.m_verts.begin(),c.m_verts.end());
+    m_tex.insert(m_tex.end(),c.m_tex.begin(),c.m_tex.end());
+    m_norm.insert(m_norm.end(),c.m_norm.begin(),c.m_norm.end());
+    m_face.append(c.m_face);
   }
-  // now we are done close the file
-  in.close();
 
   // grab the sizes used for drawing later
   m_nVerts=static_cast<unsigned int>(m_verts.size());
@@ -319,22 +592,29 @@ void Obj::save(const std::string& _fname)const noexcept
   }
 
   // finally the faces
-  for(Face f : m_face)
-  {
-  fileOut<<"f ";
-  // we now have V/T/N for each to write out
-  for(unsigned int i=0; i<=f.m_numVerts; ++i)
+  for(auto f : m_face)
   {
-    // don't forget that obj indices start from 1 not 0 (i did originally !)
-    fileOut<<f.m_vert[i]+1;
-    fileOut<<"/";
-    fileOut<<f.m_tex[i]+1;
-    fileOut<<"/";
-
-    fileOut<<f.m_norm[i]+1;
-    fileOut<<" ";
-  }
-  fileOut<<std::endl;
+    fileOut<<"f ";
+    // we now have V/T/N for each to write out
+    for(unsigned int i=0; i<f.numVerts(); ++i)
+    {
+      // don't forget that obj indices start from 1 not 0 (i did originally !)
+      fileOut<<f.vert(i)+1;
+      if(f.hasTextureCoords() || f.hasNormals())
+      {
+        fileOut<<"/";
+        if(f.hasTextureCoords())
+        {
+          fileOut<<f.tex(i)+1;
+        }
+        if(f.hasNormals())
+        {
+          fileOut<<"/"<<f.norm(i)+1;
+        }
+      }
+      fileOut<<" ";
+    }
+    fileOut<<std::endl;
   }
 }
 
@@ -0,0 +1,430 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "QuaternionArray.h"
+#include "Vec3Array.h"
+#include "LaneKernels.h"
+#include "NGLassert.h"
+#include <cmath>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file QuaternionArray.cpp
+/// @brief implementation files for QuaternionArray class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+
+static_assert(sizeof(Quaternion)==4*sizeof(Real),"Quaternion arrays are accessed as packed components");
+
+//----------------------------------------------------------------------------------------------------------------------
+// the slerp weight sin(t*a)/sin(a) with x=cos(a) is the series t*(1+b1*(1+b2*(1+...))) with
+// bi=(x-1)*(t*t-i*i)/(i*(2i+1)) = (x-1)*(s_slerpU[i]*t*t-s_slerpV[i]), cut off after 8 terms with the last scaled
+// by 1.85298109 to spread the error over the range (Eberly 2011)
+//----------------------------------------------------------------------------------------------------------------------
+static const int s_slerpTerms=8;
+static const Real s_slerpMu=1.85298109f;
+static const Real s_slerpU[s_slerpTerms]={1.0f/(1*3),1.0f/(2*5),1.0f/(3*7),1.0f/(4*9),1.0f/(5*11),1.0f/(6*13),
+                                          1.0f/(7*15),s_slerpMu/(8*17)};
+static const Real s_slerpV[s_slerpTerms]={1.0f/3,2.0f/5,3.0f/7,4.0f/9,5.0f/11,6.0f/13,7.0f/15,s_slerpMu*8.0f/17.0f};
+
+static Real slerpWeight(Real _t, Real _xm1) noexcept
+{
+  Real t2=_t*_t;
+  Real w=1.0f;
+  for(int i=s_slerpTerms-1; i>=0; --i)
+  {
+    w=1.0f+(s_slerpU[i]*t2-s_slerpV[i])*_xm1*w;
+  }
+  return _t*w;
+}
+
+#if defined(NGL_SIMD)
+static simd::float4 slerpWeight(simd::float4 _t, simd::float4 _xm1) noexcept
+{
+  simd::float4 one=simd::splat(1.0f);
+  simd::float4 t2=simd::mul(_t,_t);
+  simd::float4 w=one;
+  for(int i=s_slerpTerms-1; i>=0; --i)
+  {
+    simd::float4 b=simd::mul(simd::sub(simd::mul(simd::splat(s_slerpU[i]),t2),simd::splat(s_slerpV[i])),_xm1);
+    w=simd::madd(b,w,one);
+  }
+  return simd::mul(_t,w);
+}
+#endif
+
+//----------------------------------------------------------------------------------------------------------------------
+/// @brief o_res = wa*_a + wb*_b per element, with wa and wb from slerp or lerp weights, normalised for nlerp. The t
+/// values are _t[i] if PerElement else _t[0] for all
+//----------------------------------------------------------------------------------------------------------------------
+template <bool Slerp, bool PerElement>
+static void blend(const Real *const *_a, const Real *const *_b, const Real *_t, Real *const *o_res, size_t _n) noexcept
+{
+  size_t i=0;
+#if defined(NGL_SIMD)
+  simd::float4 one=simd::splat(1.0f);
+  for(; i+4<=_n; i+=4)
+  {
+    simd::float4 a[4],b[4];
+    for(int l=0; l<4; ++l)
+    {
+      a[l]=simd::load(_a[l]+i);
+      b[l]=simd::load(_b[l]+i);
+    }
+    simd::float4 t= PerElement ? simd::load(_t+i) : simd::splat(_t[0]);
+    simd::float4 dot=simd::mul(a[0],b[0]);
+    dot=simd::madd(a[1],b[1],dot);
+    dot=simd::madd(a[2],b[2],dot);
+    dot=simd::madd(a[3],b[3],dot);
+    simd::float4 wa,wb;
+    if(Slerp)
+    {
+      simd::float4 xm1=simd::sub(simd::abs(dot),one);
+      wa=slerpWeight(simd::sub(one,t),xm1);
+      wb=slerpWeight(t,xm1);
+    }
+    else
+    {
+      wa=simd::sub(one,t);
+      wb=t;
+    }
+    // go the short way round
+    wb=simd::flipSign(wb,dot);
+    simd::float4 res[4];
+    for(int l=0; l<4; ++l)
+    {
+      res[l]=simd::madd(wa,a[l],simd::mul(wb,b[l]));
+    }
+    if(!Slerp)
+    {
+      simd::float4 len=simd::mul(res[0],res[0]);
+      len=simd::madd(res[1],res[1],len);
+      len=simd::madd(res[2],res[2],len);
+      len=simd::madd(res[3],res[3],len);
+      simd::float4 inv=simd::safeInvSqrt(len);
+      for(int l=0; l<4; ++l)
+      {
+        res[l]=simd::mul(res[l],inv);
+      }
+    }
+    for(int l=0; l<4; ++l)
+    {
+      simd::store(o_res[l]+i,res[l]);
+    }
+  }
+#endif
+  for(; i<_n; ++i)
+  {
+    Real t= PerElement ? _t[i] : _t[0];
+    Real dot=_a[0][i]*_b[0][i]+_a[1][i]*_b[1][i]+_a[2][i]*_b[2][i]+_a[3][i]*_b[3][i];
+    Real wa,wb;
+    if(Slerp)
+    {
+      Real xm1=std::abs(dot)-1.0f;
+      wa=slerpWeight(1.0f-t,xm1);
+      wb=slerpWeight(t,xm1);
+    }
+    else
+    {
+      wa=1.0f-t;
+      wb=t;
+    }
+    if(dot<0.0f)
+    {
+      wb=-wb;
+    }
+    Real res[4];
+    Real len=0.0f;
+    for(int l=0; l<4; ++l)
+    {
+      res[l]=wa*_a[l][i]+wb*_b[l][i];
+      len+=res[l]*res[l];
+    }
+    Real inv=1.0f;
+    if(!Slerp)
+    {
+      inv= len>0.0f ? 1.0f/std::sqrt(len) : 0.0f;
+    }
+    for(int l=0; l<4; ++l)
+    {
+      o_res[l][i]=res[l]*inv;
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+QuaternionArray::QuaternionArray(size_t _size) noexcept
+{
+  resize(_size);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+QuaternionArray::QuaternionArray(const std::vector<Quaternion> &_q) noexcept
+{
+  set(_q);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void QuaternionArray::set(const std::vector<Quaternion> &_q) noexcept
+{
+  resize(_q.size());
+  const Real *in=reinterpret_cast<const Real *>(_q.data());
+  size_t i=0;
+#if defined(NGL_SIMD)
+  // four elements are a 4x4 block so a transpose gives the components
+  for(; i+4<=_q.size(); i+=4)
+  {
+    simd::float4 s=simd::load(in+i*4);
+    simd::float4 x=simd::load(in+i*4+4);
+    simd::float4 y=simd::load(in+i*4+8);
+    simd::float4 z=simd::load(in+i*4+12);
+    simd::transpose(s,x,y,z);
+    simd::store(&m_s[i],s);
+    simd::store(&m_x[i],x);
+    simd::store(&m_y[i],y);
+    simd::store(&m_z[i],z);
+  }
+#endif
+  for(; i<_q.size(); ++i)
+  {
+    m_s[i]=in[i*4];
+    m_x[i]=in[i*4+1];
+    m_y[i]=in[i*4+2];
+    m_z[i]=in[i*4+3];
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void QuaternionArray::get(std::vector<Quaternion> &o_q) const noexcept
+{
+  o_q.resize(size());
+  Real *out=reinterpret_cast<Real *>(o_q.data());
+  size_t i=0;
+#if defined(NGL_SIMD)
+  for(; i+4<=size(); i+=4)
+  {
+    simd::float4 v0=simd::load(&m_s[i]);
+    simd::float4 v1=simd::load(&m_x[i]);
+    simd::float4 v2=simd::load(&m_y[i]);
+    simd::float4 v3=simd::load(&m_z[i]);
+    simd::transpose(v0,v1,v2,v3);
+    simd::store(out+i*4,v0);
+    simd::store(out+i*4+4,v1);
+    simd::store(out+i*4+8,v2);
+    simd::store(out+i*4+12,v3);
+  }
+#endif
+  for(; i<size(); ++i)
+  {
+    out[i*4]=m_s[i];
+    out[i*4+1]=m_x[i];
+    out[i*4+2]=m_y[i];
+    out[i*4+3]=m_z[i];
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+std::vector<Quaternion> QuaternionArray::toVector() const noexcept
+{
+  std::vector<Quaternion> q;
+  get(q);
+  return q;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Quaternion QuaternionArray::operator[](size_t _i) const noexcept
+{
+  NGL_ASSERT(_i<size());
+  return Quaternion(m_s[_i],m_x[_i],m_y[_i],m_z[_i]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void QuaternionArray::set(size_t _i, const Quaternion &_q) noexcept
+{
+  NGL_ASSERT(_i<size());
+  m_s[_i]=_q.getS();
+  m_x[_i]=_q.getX();
+  m_y[_i]=_q.getY();
+  m_z[_i]=_q.getZ();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void QuaternionArray::push_back(const Quaternion &_q) noexcept
+{
+  m_s.push_back(_q.getS());
+  m_x.push_back(_q.getX());
+  m_y.push_back(_q.getY());
+  m_z.push_back(_q.getZ());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void QuaternionArray::resize(size_t _size) noexcept
+{
+  m_s.resize(_size);
+  m_x.resize(_size);
+  m_y.resize(_size);
+  m_z.resize(_size);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void QuaternionArray::reserve(size_t _size) noexcept
+{
+  m_s.reserve(_size);
+  m_x.reserve(_size);
+  m_y.reserve(_size);
+  m_z.reserve(_size);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void QuaternionArray::clear() noexcept
+{
+  m_s.clear();
+  m_x.clear();
+  m_y.clear();
+  m_z.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void QuaternionArray::multiply(const QuaternionArray &_a, const QuaternionArray &_b) noexcept
+{
+  NGL_ASSERT(_a.size()==_b.size());
+  resize(_a.size());
+  size_t n=size();
+  size_t i=0;
+  // s=as*bs-av.bv  v=as*bv+bs*av+av x bv
+#if defined(NGL_SIMD)
+  for(; i+4<=n; i+=4)
+  {
+    simd::float4 as=simd::load(&_a.m_s[i]);
+    simd::float4 ax=simd::load(&_a.m_x[i]);
+    simd::float4 ay=simd::load(&_a.m_y[i]);
+    simd::float4 az=simd::load(&_a.m_z[i]);
+    simd::float4 bs=simd::load(&_b.m_s[i]);
+    simd::float4 bx=simd::load(&_b.m_x[i]);
+    simd::float4 by=simd::load(&_b.m_y[i]);
+    simd::float4 bz=simd::load(&_b.m_z[i]);
+    simd::float4 dot=simd::madd(ax,bx,simd::madd(ay,by,simd::mul(az,bz)));
+    simd::store(&m_s[i],simd::sub(simd::mul(as,bs),dot));
+    simd::store(&m_x[i],simd::madd(as,bx,simd::madd(bs,ax,simd::sub(simd::mul(ay,bz),simd::mul(az,by)))));
+    simd::store(&m_y[i],simd::madd(as,by,simd::madd(bs,ay,simd::sub(simd::mul(az,bx),simd::mul(ax,bz)))));
+    simd::store(&m_z[i],simd::madd(as,bz,simd::madd(bs,az,simd::sub(simd::mul(ax,by),simd::mul(ay,bx)))));
+  }
+#endif
+  for(; i<n; ++i)
+  {
+    Real as=_a.m_s[i], ax=_a.m_x[i], ay=_a.m_y[i], az=_a.m_z[i];
+    Real bs=_b.m_s[i], bx=_b.m_x[i], by=_b.m_y[i], bz=_b.m_z[i];
+    m_s[i]=as*bs-(ax*bx+ay*by+az*bz);
+    m_x[i]=as*bx+bs*ax+(ay*bz-az*by);
+    m_y[i]=as*by+bs*ay+(az*bx-ax*bz);
+    m_z[i]=as*bz+bs*az+(ax*by-ay*bx);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void QuaternionArray::normalise() noexcept
+{
+  Real *a[4]={m_s.data(),m_x.data(),m_y.data(),m_z.data()};
+  lanes::normalize<4>(a,size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void QuaternionArray::nlerp(const QuaternionArray &_a, const QuaternionArray &_b, Real _t) noexcept
+{
+  NGL_ASSERT(_a.size()==_b.size());
+  resize(_a.size());
+  const Real *a[4]={_a.m_s.data(),_a.m_x.data(),_a.m_y.data(),_a.m_z.data()};
+  const Real *b[4]={_b.m_s.data(),_b.m_x.data(),_b.m_y.data(),_b.m_z.data()};
+  Real *res[4]={m_s.data(),m_x.data(),m_y.data(),m_z.data()};
+  blend<false,false>(a,b,&_t,res,size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void QuaternionArray::nlerp(const QuaternionArray &_a, const QuaternionArray &_b, const std::vector<Real> &_t) noexcept
+{
+  NGL_ASSERT(_a.size()==_b.size() && _t.size()==_a.size());
+  resize(_a.size());
+  const Real *a[4]={_a.m_s.data(),_a.m_x.data(),_a.m_y.data(),_a.m_z.data()};
+  const Real *b[4]={_b.m_s.data(),_b.m_x.data(),_b.m_y.data(),_b.m_z.data()};
+  Real *res[4]={m_s.data(),m_x.data(),m_y.data(),m_z.data()};
+  blend<false,true>(a,b,_t.data(),res,size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void QuaternionArray::slerp(const QuaternionArray &_a, const QuaternionArray &_b, Real _t) noexcept
+{
+  NGL_ASSERT(_a.size()==_b.size());
+  resize(_a.size());
+  const Real *a[4]={_a.m_s.data(),_a.m_x.data(),_a.m_y.data(),_a.m_z.data()};
+  const Real *b[4]={_b.m_s.data(),_b.m_x.data(),_b.m_y.data(),_b.m_z.data()};
+  Real *res[4]={m_s.data(),m_x.data(),m_y.data(),m_z.data()};
+  blend<true,false>(a,b,&_t,res,size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void QuaternionArray::slerp(const QuaternionArray &_a, const QuaternionArray &_b, const std::vector<Real> &_t) noexcept
+{
+  NGL_ASSERT(_a.size()==_b.size() && _t.size()==_a.size());
+  resize(_a.size());
+  const Real *a[4]={_a.m_s.data(),_a.m_x.data(),_a.m_y.data(),_a.m_z.data()};
+  const Real *b[4]={_b.m_s.data(),_b.m_x.data(),_b.m_y.data(),_b.m_z.data()};
+  Real *res[4]={m_s.data(),m_x.data(),m_y.data(),m_z.data()};
+  blend<true,true>(a,b,_t.data(),res,size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void QuaternionArray::rotatePoints(Vec3Array &io_points) const noexcept
+{
+  NGL_ASSERT(io_points.size()==size());
+  size_t n=size();
+  Real *px=io_points.x();
+  Real *py=io_points.y();
+  Real *pz=io_points.z();
+  size_t i=0;
+  // Quaternion::rotatePoint is conjugate(q)*p*q which for a unit q=(s,u) is p-s*w+u x w with w=2(u x p)
+#if defined(NGL_SIMD)
+  simd::float4 two=simd::splat(2.0f);
+  for(; i+4<=n; i+=4)
+  {
+    simd::float4 s=simd::load(&m_s[i]);
+    simd::float4 ux=simd::load(&m_x[i]);
+    simd::float4 uy=simd::load(&m_y[i]);
+    simd::float4 uz=simd::load(&m_z[i]);
+    simd::float4 x=simd::load(px+i);
+    simd::float4 y=simd::load(py+i);
+    simd::float4 z=simd::load(pz+i);
+    simd::float4 wx=simd::mul(two,simd::sub(simd::mul(uy,z),simd::mul(uz,y)));
+    simd::float4 wy=simd::mul(two,simd::sub(simd::mul(uz,x),simd::mul(ux,z)));
+    simd::float4 wz=simd::mul(two,simd::sub(simd::mul(ux,y),simd::mul(uy,x)));
+    simd::store(px+i,simd::add(simd::sub(x,simd::mul(s,wx)),simd::sub(simd::mul(uy,wz),simd::mul(uz,wy))));
+    simd::store(py+i,simd::add(simd::sub(y,simd::mul(s,wy)),simd::sub(simd::mul(uz,wx),simd::mul(ux,wz))));
+    simd::store(pz+i,simd::add(simd::sub(z,simd::mul(s,wz)),simd::sub(simd::mul(ux,wy),simd::mul(uy,wx))));
+  }
+#endif
+  for(; i<n; ++i)
+  {
+    Real s=m_s[i], ux=m_x[i], uy=m_y[i], uz=m_z[i];
+    Real x=px[i], y=py[i], z=pz[i];
+    Real wx=2.0f*(uy*z-uz*y);
+    Real wy=2.0f*(uz*x-ux*z);
+    Real wz=2.0f*(ux*y-uy*x);
+    px[i]=x-s*wx+(uy*wz-uz*wy);
+    py[i]=y-s*wy+(uz*wx-ux*wz);
+    pz[i]=z-s*wz+(ux*wy-uy*wx);
+  }
+}
+
+} // end namespace ngl
+//----------------------------------------------------------------------------------------------------------------------
@@ -19,6 +19,7 @@
 #include <memory>
 #include <algorithm>
 #include "ShaderLib.h"
+#include "GLStateCache.h"
 #include "TextShaders.h"
 #include "ColourShaders.h"
 #include "DiffuseShaders.h"
@@ -36,63 +37,63 @@ namespace ngl
 
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderLib::setShaderParamFromMat4(const std::string &_paramName, Mat4 _p1 ) noexcept
+void ShaderLib::setShaderParamFromMat4(const std::string &_paramName, const Mat4 &_p1 ) noexcept
 {
-  (*this)[m_currentShader]->setUniformMatrix4fv(_paramName.c_str(),1,GL_FALSE,_p1.openGL());
+  m_currentProgram->setUniformMatrix4fv(_paramName.c_str(),1,GL_FALSE,&_p1.m_openGL[0]);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderLib::setRegisteredUniformFromMat4(const std::string &_registeredUniformName, Mat4 _p1  ) noexcept
+void ShaderLib::setRegisteredUniformFromMat4(const std::string &_registeredUniformName, const Mat4 &_p1  ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniformMatrix4fv(_registeredUniformName,1,GL_FALSE,_p1.openGL());
+  m_currentProgram->setRegisteredUniformMatrix4fv(_registeredUniformName,1,GL_FALSE,&_p1.m_openGL[0]);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderLib::setShaderParamFromMat3(const std::string &_paramName, Mat3 _p1  ) noexcept
+void ShaderLib::setShaderParamFromMat3(const std::string &_paramName, const Mat3 &_p1  ) noexcept
 {
-  (*this)[m_currentShader]->setUniformMatrix3fv(_paramName.c_str(),1,GL_FALSE,_p1.openGL());
+  m_currentProgram->setUniformMatrix3fv(_paramName.c_str(),1,GL_FALSE,&_p1.m_openGL[0]);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderLib::setRegisteredUniformFromMat3( const std::string &_paramName, Mat3 _p1  ) noexcept
+void ShaderLib::setRegisteredUniformFromMat3( const std::string &_paramName, const Mat3 &_p1  ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniformMatrix3fv(_paramName,1,GL_FALSE,_p1.openGL());
+  m_currentProgram->setRegisteredUniformMatrix3fv(_paramName,1,GL_FALSE,&_p1.m_openGL[0]);
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setShaderParamFromVec4(const std::string &_paramName,	Vec4 _p1 ) noexcept
 {
 
-  (*this)[m_currentShader]->setUniform4fv(_paramName.c_str(),1,_p1.openGL());
+  m_currentProgram->setUniform4fv(_paramName.c_str(),1,_p1.openGL());
 
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniformVec4( const std::string &_paramName, Vec4 _p1 ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform4f(_paramName,_p1.m_x,_p1.m_y,_p1.m_z,_p1.m_w);
+  m_currentProgram->setRegisteredUniform4f(_paramName,_p1.m_x,_p1.m_y,_p1.m_z,_p1.m_w);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setShaderParamFromColour( const std::string &_paramName,Colour _p1  ) noexcept
 {
 
-  (*this)[m_currentShader]->setUniform4fv(_paramName.c_str(),1,_p1.openGL());
+  m_currentProgram->setUniform4fv(_paramName.c_str(),1,_p1.openGL());
 
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniformFromColour(const std::string &_paramName, Colour _p1  ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform4f(_paramName,_p1.m_r,_p1.m_g,_p1.m_b,_p1.m_a);
+  m_currentProgram->setRegisteredUniform4f(_paramName,_p1.m_r,_p1.m_g,_p1.m_b,_p1.m_a);
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniformVec3(const std::string &_paramName,Vec3 _p1 ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform3f(_paramName,_p1.m_x,_p1.m_y,_p1.m_z);
+  m_currentProgram->setRegisteredUniform3f(_paramName,_p1.m_x,_p1.m_y,_p1.m_z);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniformVec2( const std::string &_paramName, Vec2 _p1 ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform2f(_paramName,_p1.m_x,_p1.m_y);
+  m_currentProgram->setRegisteredUniform2f(_paramName,_p1.m_x,_p1.m_y);
 }
 
 
@@ -101,50 +102,50 @@ void ShaderLib::setRegisteredUniformVec2( const std::string &_paramName, Vec2 _p
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setShaderParam4f(const std::string &_paramName, float _p1,float _p2, float _p3, float _p4 ) noexcept
 {
-  (*this)[m_currentShader]->setUniform4f(_paramName.c_str(),_p1,_p2,_p3,_p4);
+  m_currentProgram->setUniform4f(_paramName.c_str(),_p1,_p2,_p3,_p4);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniform4f(const std::string &_paramName,float _p1,float _p2, float _p3, float _p4 ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform4f(_paramName,_p1,_p2,_p3,_p4);
+  m_currentProgram->setRegisteredUniform4f(_paramName,_p1,_p2,_p3,_p4);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setShaderParam3f(const std::string &_paramName, float _p1, float _p2,  float _p3  ) noexcept
 {
-  (*this)[m_currentShader]->setUniform3f(_paramName.c_str(),_p1,_p2,_p3);
+  m_currentProgram->setUniform3f(_paramName.c_str(),_p1,_p2,_p3);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniform3f( const std::string &_paramName, float _p1, float _p2,  float _p3 ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform3f(_paramName,_p1,_p2,_p3);
+  m_currentProgram->setRegisteredUniform3f(_paramName,_p1,_p2,_p3);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setShaderParam2f( const std::string &_paramName,float _p1, float _p2  ) noexcept
 {
-  (*this)[m_currentShader]->setUniform2f(_paramName.c_str(),_p1,_p2);
+  m_currentProgram->setUniform2f(_paramName.c_str(),_p1,_p2);
 
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniform2f( const std::string &_paramName, float _p1, float _p2  ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform2f(_paramName,_p1,_p2);
+  m_currentProgram->setRegisteredUniform2f(_paramName,_p1,_p2);
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setShaderParam1i(const std::string &_paramName,  int _p1  ) noexcept
 {
-  (*this)[m_currentShader]->setUniform1i(_paramName.c_str(),_p1);
+  m_currentProgram->setUniform1i(_paramName.c_str(),_p1);
 
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniform1i(const std::string &_paramName, int _p1 ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform1i(_paramName,_p1);
+  m_currentProgram->setRegisteredUniform1i(_paramName,_p1);
 }
 
 
@@ -152,14 +153,14 @@ void ShaderLib::setRegisteredUniform1i(const std::string &_paramName, int _p1 )
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setShaderParam1f( const std::string &_paramName, float _p1 ) noexcept
 {
-  (*this)[m_currentShader]->setUniform1f(_paramName.c_str(),_p1);
+  m_currentProgram->setUniform1f(_paramName.c_str(),_p1);
 
 }
 
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::setRegisteredUniform1f(const std::string &_paramName, float _p1 ) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform1f(_paramName,_p1);
+  m_currentProgram->setRegisteredUniform1f(_paramName,_p1);
 }
 
 
@@ -235,6 +236,7 @@ ShaderLib::ShaderLib()  noexcept
  m_numShaders=0;
  m_nullProgram = new ShaderProgram("NULL");
  m_currentShader="NULL";
+ m_currentProgram=m_nullProgram;
  m_shaderPrograms["NULL"]=m_nullProgram;
  loadTextShaders();
  loadColourShaders();
@@ -303,6 +305,10 @@ void ShaderLib::createShaderProgram(const std::string &_name  ) noexcept
   if(m_debugState)
     std::cerr<<"creating empty ShaderProgram "<<_name.c_str()<<"\n";
  m_shaderPrograms[_name]= new ShaderProgram(_name);
+ if(_name==m_currentShader)
+ {
+   m_currentProgram=m_shaderPrograms[_name];
+ }
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderLib::attachShaderToProgram( const std::string &_program, const std::string &_shader   ) noexcept
@@ -512,13 +518,15 @@ void ShaderLib::use( const std::string &_name  )  noexcept
   {
     //std::cerr<<"Shader manager Use\n";
     m_currentShader=_name;
+    m_currentProgram=program->second;
     program->second->use();
   }
   else
   {
     std::cerr<<"Warning Program not know in use "<<_name.c_str()<<"\n";
     m_currentShader="NULL";
-    glUseProgram(0);
+    m_currentProgram=m_nullProgram;
+    GLStateCache::instance()->useProgram(0);
   }
 
 }
@@ -598,6 +606,7 @@ ShaderProgram * ShaderLib::operator[](const std::string &_name  ) noexcept
   if(program!=m_shaderPrograms.end() )
   {
     m_currentShader=_name;
+    m_currentProgram=program->second;
     return  program->second;
   }
   else
@@ -617,7 +626,7 @@ ShaderProgram * ShaderLib::operator[]( const char *_name ) noexcept
   if(program!=m_shaderPrograms.end() )
   {
     m_currentShader=_name;
-
+    m_currentProgram=program->second;
     return  program->second;
   }
   else
@@ -632,6 +641,7 @@ ShaderProgram * ShaderLib::operator[]( const char *_name ) noexcept
 void ShaderLib::useNullProgram() noexcept
 {
   m_currentShader="NULL";
+  m_currentProgram=m_nullProgram;
   m_nullProgram->use();
 }
 
@@ -657,6 +667,11 @@ GLuint ShaderLib::getUniformBlockIndex( const std::string &_uniformBlockName  )
   return id;
 }
 
+void ShaderLib::setUniformBlockBinding(const std::string &_uniformBlockName, GLuint _binding) const noexcept
+{
+  m_currentProgram->setUniformBlockBinding(_uniformBlockName,_binding);
+}
+
 void ShaderLib::loadTextShaders() noexcept
 {
 
@@ -801,130 +816,258 @@ void ShaderLib::printProperties() const noexcept
 
 void ShaderLib::setUniform(const std::string &_paramName,Real _v0) noexcept
 {
-  (*this)[m_currentShader]->setUniform1f(_paramName.c_str(),_v0);
+  m_currentProgram->setUniform1f(_paramName.c_str(),_v0);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,Real _v0) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform1f(_paramName.c_str(),_v0);
+  m_currentProgram->setRegisteredUniform1f(_paramName.c_str(),_v0);
 
 }
 
 void ShaderLib::setUniform(const std::string &_paramName,Real _v0,Real _v1) noexcept
 {
-  (*this)[m_currentShader]->setUniform2f(_paramName.c_str(),_v0,_v1);
+  m_currentProgram->setUniform2f(_paramName.c_str(),_v0,_v1);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,Real _v0,Real _v1) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform2f(_paramName.c_str(),_v0,_v1);
+  m_currentProgram->setRegisteredUniform2f(_paramName.c_str(),_v0,_v1);
 
 }
 
 void ShaderLib::setUniform(const std::string &_paramName,Real _v0,Real _v1,Real _v2) noexcept
 {
-  (*this)[m_currentShader]->setUniform3f(_paramName.c_str(),_v0,_v1,_v2);
+  m_currentProgram->setUniform3f(_paramName.c_str(),_v0,_v1,_v2);
 
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,Real _v0,Real _v1,Real _v2) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform3f(_paramName.c_str(),_v0,_v1,_v2);
+  m_currentProgram->setRegisteredUniform3f(_paramName.c_str(),_v0,_v1,_v2);
 }
 
 void ShaderLib::setUniform(const std::string &_paramName,Real _v0,Real _v1,Real _v2,Real _v3) noexcept
 {
-  (*this)[m_currentShader]->setUniform4f(_paramName.c_str(),_v0,_v1,_v2,_v3);
+  m_currentProgram->setUniform4f(_paramName.c_str(),_v0,_v1,_v2,_v3);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,Real _v0,Real _v1,Real _v2,Real _v3) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform4f(_paramName.c_str(),_v0,_v1,_v2,_v3);
+  m_currentProgram->setRegisteredUniform4f(_paramName.c_str(),_v0,_v1,_v2,_v3);
 }
 
 void ShaderLib::setUniform(const std::string &_paramName,GLint _v0) noexcept
 {
-  (*this)[m_currentShader]->setUniform1i(_paramName.c_str(),_v0);
+  m_currentProgram->setUniform1i(_paramName.c_str(),_v0);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,GLint _v0) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform1i(_paramName.c_str(),_v0);
+  m_currentProgram->setRegisteredUniform1i(_paramName.c_str(),_v0);
 }
 
 void ShaderLib::setUniform(const std::string &_paramName,GLint _v0,GLint _v1) noexcept
 {
-  (*this)[m_currentShader]->setUniform2i(_paramName.c_str(),_v0,_v1);
+  m_currentProgram->setUniform2i(_paramName.c_str(),_v0,_v1);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,GLint _v0,GLint _v1) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform2i(_paramName.c_str(),_v0,_v1);
+  m_currentProgram->setRegisteredUniform2i(_paramName.c_str(),_v0,_v1);
 }
 
 void ShaderLib::setUniform(const std::string &_paramName,GLint _v0,GLint _v1,GLint _v2) noexcept
 {
-  (*this)[m_currentShader]->setUniform3i(_paramName.c_str(),_v0,_v1,_v2);
+  m_currentProgram->setUniform3i(_paramName.c_str(),_v0,_v1,_v2);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,GLint _v0,GLint _v1,GLint _v2) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform3i(_paramName.c_str(),_v0,_v1,_v2);
+  m_currentProgram->setRegisteredUniform3i(_paramName.c_str(),_v0,_v1,_v2);
 }
 
 void ShaderLib::setUniform(const std::string &_paramName,GLint _v0,GLint _v1,GLint _v2,GLint _v3) noexcept
 {
-  (*this)[m_currentShader]->setUniform4i(_paramName.c_str(),_v0,_v1,_v2,_v3);
+  m_currentProgram->setUniform4i(_paramName.c_str(),_v0,_v1,_v2,_v3);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,GLint _v0,GLint _v1,GLint _v2,GLint _v3) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform4f(_paramName.c_str(),_v0,_v1,_v2,_v3);
+  m_currentProgram->setRegisteredUniform4f(_paramName.c_str(),_v0,_v1,_v2,_v3);
 }
 
 void ShaderLib::setUniform(const std::string &_paramName,Colour _v0) noexcept
 {
-  (*this)[m_currentShader]->setUniform4f(_paramName.c_str(),_v0.m_r,_v0.m_g,_v0.m_b,_v0.m_a);
+  m_currentProgram->setUniform4f(_paramName.c_str(),_v0.m_r,_v0.m_g,_v0.m_b,_v0.m_a);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,Colour _v0) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform4f(_paramName.c_str(),_v0.m_r,_v0.m_g,_v0.m_b,_v0.m_a);
+  m_currentProgram->setRegisteredUniform4f(_paramName.c_str(),_v0.m_r,_v0.m_g,_v0.m_b,_v0.m_a);
 }
 void ShaderLib::setUniform(const std::string &_paramName,Vec2 _v0) noexcept
 {
-  (*this)[m_currentShader]->setUniform2f(_paramName.c_str(),_v0.m_x,_v0.m_y);
+  m_currentProgram->setUniform2f(_paramName.c_str(),_v0.m_x,_v0.m_y);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,Vec2 _v0) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform2f(_paramName.c_str(),_v0.m_x,_v0.m_y);
+  m_currentProgram->setRegisteredUniform2f(_paramName.c_str(),_v0.m_x,_v0.m_y);
 }
 void ShaderLib::setUniform(const std::string &_paramName,Vec3 _v0) noexcept
 {
-  (*this)[m_currentShader]->setUniform3f(_paramName.c_str(),_v0.m_x,_v0.m_y,_v0.m_z);
+  m_currentProgram->setUniform3f(_paramName.c_str(),_v0.m_x,_v0.m_y,_v0.m_z);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,Vec3 _v0) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform3f(_paramName.c_str(),_v0.m_x,_v0.m_y,_v0.m_z);
+  m_currentProgram->setRegisteredUniform3f(_paramName.c_str(),_v0.m_x,_v0.m_y,_v0.m_z);
 }
 void ShaderLib::setUniform(const std::string &_paramName,Vec4 _v0) noexcept
 {
-  (*this)[m_currentShader]->setUniform4f(_paramName.c_str(),_v0.m_x,_v0.m_y,_v0.m_z,_v0.m_w);
+  m_currentProgram->setUniform4f(_paramName.c_str(),_v0.m_x,_v0.m_y,_v0.m_z,_v0.m_w);
 }
 void ShaderLib::setRegisteredUniform(const std::string &_paramName,Vec4 _v0) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniform4f(_paramName.c_str(),_v0.m_x,_v0.m_y,_v0.m_z,_v0.m_w);
+  m_currentProgram->setRegisteredUniform4f(_paramName.c_str(),_v0.m_x,_v0.m_y,_v0.m_z,_v0.m_w);
 }
 
-void ShaderLib::setUniform(const std::string &_paramName,Mat3 _v0) noexcept
+void ShaderLib::setUniform(const std::string &_paramName,const Mat3 &_v0) noexcept
 {
-  (*this)[m_currentShader]->setUniformMatrix3fv(_paramName.c_str(),1,GL_FALSE,_v0.openGL());
+  m_currentProgram->setUniformMatrix3fv(_paramName.c_str(),1,GL_FALSE,&_v0.m_openGL[0]);
 
 }
-void ShaderLib::setRegisteredUniform(const std::string &_paramName,Mat3 _v0) noexcept
+void ShaderLib::setRegisteredUniform(const std::string &_paramName,const Mat3 &_v0) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniformMatrix3fv(_paramName,1,GL_FALSE,_v0.openGL());
+  m_currentProgram->setRegisteredUniformMatrix3fv(_paramName,1,GL_FALSE,&_v0.m_openGL[0]);
 
 }
 
-void ShaderLib::setUniform(const std::string &_paramName,Mat4 _v0) noexcept
+void ShaderLib::setUniform(const std::string &_paramName,const Mat4 &_v0) noexcept
+{
+  m_currentProgram->setUniformMatrix4fv(_paramName.c_str(),1,GL_FALSE,&_v0.m_openGL[0]);
+}
+void ShaderLib::setRegisteredUniform(const std::string &_paramName,const Mat4 &_v0) noexcept
+{
+  m_currentProgram->setRegisteredUniformMatrix4fv(_paramName,1,GL_FALSE,&_v0.m_openGL[0]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UniformHandle ShaderLib::getUniformHandle(const std::string &_paramName) const noexcept
+{
+  return ShaderProgram::getUniformHandle(_paramName);
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ShaderLib::setUniform(UniformHandle _handle,Real _v0) noexcept
+{
+  GLint loc;
+  if(m_currentProgram->uniformNeedsUpload(_handle,&_v0,sizeof(_v0),loc))
+  {
+    glUniform1f(loc,_v0);
+  }
+}
+void ShaderLib::setUniform(UniformHandle _handle,Real _v0,Real _v1) noexcept
+{
+  const Real value[]={_v0,_v1};
+  GLint loc;
+  if(m_currentProgram->uniformNeedsUpload(_handle,value,sizeof(value),loc))
+  {
+    glUniform2f(loc,_v0,_v1);
+  }
+}
+void ShaderLib::setUniform(UniformHandle _handle,Real _v0,Real _v1,Real _v2) noexcept
+{
+  const Real value[]={_v0,_v1,_v2};
+  GLint loc;
+  if(m_currentProgram->uniformNeedsUpload(_handle,value,sizeof(value),loc))
+  {
+    glUniform3f(loc,_v0,_v1,_v2);
+  }
+}
+void ShaderLib::setUniform(UniformHandle _handle,Real _v0,Real _v1,Real _v2,Real _v3) noexcept
+{
+  const Real value[]={_v0,_v1,_v2,_v3};
+  GLint loc;
+  if(m_currentProgram->uniformNeedsUpload(_handle,value,sizeof(value),loc))
+  {
+    glUniform4f(loc,_v0,_v1,_v2,_v3);
+  }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ShaderLib::setUniform(UniformHandle _handle,GLint _v0) noexcept
+{
+  GLint loc;
+  if(m_currentProgram->uniformNeedsUpload(_handle,&_v0,sizeof(_v0),loc))
+  {
+    glUniform1i(loc,_v0);
+  }
+}
+void ShaderLib::setUniform(UniformHandle _handle,GLint _v0,GLint _v1) noexcept
 {
-  (*this)[m_currentShader]->setUniformMatrix4fv(_paramName.c_str(),1,GL_FALSE,_v0.openGL());
+  const GLint value[]={_v0,_v1};
+  GLint loc;
+  if(m_currentProgram->uniformNeedsUpload(_handle,value,sizeof(value),loc))
+  {
+    glUniform2i(loc,_v0,_v1);
+  }
+}
+void ShaderLib::setUniform(UniformHandle _handle,GLint _v0,GLint _v1,GLint _v2) noexcept
+{
+  const GLint value[]={_v0,_v1,_v2};
+  GLint loc;
+  if(m_currentProgram->uniformNeedsUpload(_handle,value,sizeof(value),loc))
+  {
+    glUniform3i(loc,_v0,_v1,_v2);
+  }
+}
+void ShaderLib::setUniform(UniformHandle _handle,GLint _v0,GLint _v1,GLint _v2,GLint _v3) noexcept
+{
+  const GLint value[]={_v0,_v1,_v2,_v3};
+  GLint loc;
+  if(m_currentProgram->uniformNeedsUpload(_handle,value,sizeof(value),loc))
+  {
+    glUniform4i(loc,_v0,_v1,_v2,_v3);
+  }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ShaderLib::setUniform(UniformHandle _handle,const Colour &_v0) noexcept
+{
+  GLint loc;
+  if(m_currentProgram->uniformNeedsUpload(_handle,&_v0.m_openGL[0],4*sizeof(Real),loc))
+  {
+    glUniform4f(loc,_v0.m_r,_v0.m_g,_v0.m_b,_v0.m_a);
+  }
+}
+void ShaderLib::setUniform(UniformHandle _handle,const Vec2 &_v0) noexcept
+{
+  GLint loc;
+  if(m_currentProgram->uniformNeedsUpload(_handle,&_v0.m_openGL[0],2*sizeof(Real),loc))
+  {
+    glUniform2f(loc,_v0.m_x,_v0.m_y);
+  }
 }
-void ShaderLib::setRegisteredUniform(const std::string &_paramName,Mat4 _v0) noexcept
+void ShaderLib::setUniform(UniformHandle _handle,const Vec3 &_v0) noexcept
 {
-  (*this)[m_currentShader]->setRegisteredUniformMatrix4fv(_paramName,1,GL_FALSE,_v0.openGL());
+  GLint loc;
+  if(m_currentProgram->uniformNeedsUpload(_handle,&_v0.m_openGL[0],3*sizeof(Real),loc))
+  {
+    glUniform3f(loc,_v0.m_x,_v0.m_y,_v0.m_z);
+  }
+}
+void ShaderLib::setUniform(UniformHandle _handle,const Vec4 &_v0) noexcept
+{
+  GLint loc;
+  if(m_currentProgram->uniformNeedsUpload(_handle,&_v0.m_openGL[0],4*sizeof(Real),loc))
+  {
+    glUniform4f(loc,_v0.m_x,_v0.m_y,_v0.m_z,_v0.m_w);
+  }
+}
+//----------------------------------------------------------------------------------------------------------------------
+void ShaderLib::setUniform(UniformHandle _handle,const Mat3 &_v0) noexcept
+{
+  GLint loc;
+  if(m_currentProgram->uniformNeedsUpload(_handle,&_v0.m_openGL[0],9*sizeof(Real),loc))
+  {
+    glUniformMatrix3fv(loc,1,GL_FALSE,&_v0.m_openGL[0]);
+  }
+}
+void ShaderLib::setUniform(UniformHandle _handle,const Mat4 &_v0) noexcept
+{
+  GLint loc;
+  if(m_currentProgram->uniformNeedsUpload(_handle,&_v0.m_openGL[0],16*sizeof(Real),loc))
+  {
+    glUniformMatrix4fv(loc,1,GL_FALSE,&_v0.m_openGL[0]);
+  }
 }
 
 
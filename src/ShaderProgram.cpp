@@ -20,7 +20,10 @@
 //----------------------------------------------------------------------------------------------------------------------
 
 #include "ShaderProgram.h"
+#include "GLStateCache.h"
+#include "NGLassert.h"
 #include "fmt/format.h"
+#include <cstring>
 
 namespace ngl
 {
@@ -47,12 +50,13 @@ ShaderProgram::~ShaderProgram()
 {
   std::cerr<<"removing ShaderProgram "<< m_programName<<"\n";
   glDeleteProgram(m_programID);
+  GLStateCache::instance()->programDeleted(m_programID);
 }
 //----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::use() noexcept
 {
  // std::cerr<<"Using shader "<<m_programName<<" id "<<m_programID<<"\n";
-  glUseProgram(m_programID);
+  GLStateCache::instance()->useProgram(m_programID);
   //NGLCheckGLError(__FILE__,__LINE__);
   m_active=true;
 }
@@ -61,7 +65,7 @@ void ShaderProgram::use() noexcept
 void ShaderProgram::unbind() noexcept
 {
   m_active=false;
-  glUseProgram(0);
+  GLStateCache::instance()->useProgram(0);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -128,7 +132,7 @@ void ShaderProgram::link() noexcept
   }
 
   m_linked=true;
-  glUseProgram(m_programID);
+  GLStateCache::instance()->useProgram(m_programID);
   autoRegisterUniforms();
 
 }
@@ -156,6 +160,126 @@ GLint ShaderProgram::getUniformLocation(const char* _name   ) const noexcept
   return -1;
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+const ShaderProgram::uniformData ShaderProgram::s_unresolvedUniform={};
+
+namespace
+{
+  // the interned uniform names, function statics so they are ready before any static ShaderProgram is used
+  std::unordered_map<std::string,UniformHandle> & uniformHandles()
+  {
+    static std::unordered_map<std::string,UniformHandle> handles;
+    return handles;
+  }
+  std::vector<std::string> & uniformHandleNames()
+  {
+    static std::vector<std::string> names;
+    return names;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UniformHandle ShaderProgram::getUniformHandle(const std::string &_name) noexcept
+{
+  auto &handles=uniformHandles();
+  auto handle=handles.find(_name);
+  if(handle!=handles.end())
+  {
+    return handle->second;
+  }
+  auto &names=uniformHandleNames();
+  UniformHandle id=static_cast<UniformHandle>(names.size());
+  names.push_back(_name);
+  handles[_name]=id;
+  return id;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const std::string & ShaderProgram::getUniformHandleName(UniformHandle _handle) noexcept
+{
+  auto &names=uniformHandleNames();
+  NGL_ASSERT(_handle<names.size());
+  return names[_handle];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const ShaderProgram::uniformData * ShaderProgram::resolveUniformHandle(UniformHandle _handle) const noexcept
+{
+  auto &names=uniformHandleNames();
+  if(_handle>=names.size())
+  {
+    std::cerr<<"Uniform handle "<<_handle<<" was never created in Program \""<<m_programName<<"\"\n";
+    return nullptr;
+  }
+  if(m_handleUniforms.size()<names.size())
+  {
+    m_handleUniforms.resize(names.size(),&s_unresolvedUniform);
+  }
+  const uniformData *data=nullptr;
+  auto uniform=m_registeredUniforms.find(names[_handle]);
+  if(uniform!=m_registeredUniforms.end())
+  {
+    data=&uniform->second;
+  }
+  else
+  {
+    // only reported the first time as the nullptr is cached
+    std::cerr<<"Uniform \""<<names[_handle]<<"\" not found in Program \""<<m_programName<<"\"\n";
+  }
+  m_handleUniforms[_handle]=data;
+  return data;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const ShaderProgram::uniformData * ShaderProgram::getUniform(const char *_name) const noexcept
+{
+  auto uniform=m_registeredUniforms.find(_name);
+  if(uniform!=m_registeredUniforms.end())
+  {
+    return &uniform->second;
+  }
+  std::cerr<<"Uniform \""<<_name<<"\" not found in Program \""<<m_programName<<"\"\n";
+  return nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool ShaderProgram::needsUpload(const uniformData *_uniform, const void *_value, size_t _bytes, bool _single) const noexcept
+{
+  GLStateCache *cache=GLStateCache::instance();
+  if(_uniform==nullptr || !cache->isEnabled())
+  {
+    cache->countUniform(true);
+    return true;
+  }
+  // a write to a program not in use goes to the one that is, so its values are no longer known either
+  if(!_single || _bytes>sizeof(_uniform->value) || !cache->isProgramInUse(m_programID))
+  {
+    cache->invalidateUniforms();
+    cache->countUniform(true);
+    return true;
+  }
+  if(_uniform->generation==cache->generation() && _uniform->size==_bytes &&
+     std::memcmp(_uniform->value.data(),_value,_bytes)==0)
+  {
+    cache->countUniform(false);
+    return false;
+  }
+  std::memcpy(_uniform->value.data(),_value,_bytes);
+  _uniform->size=_bytes;
+  _uniform->generation=cache->generation();
+  cache->countUniform(true);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool ShaderProgram::uniformNeedsUpload(UniformHandle _handle, const void *_value, size_t _bytes, GLint &o_location) const noexcept
+{
+  const uniformData *uniform=getUniform(_handle);
+  o_location=location(uniform);
+  return needsUpload(uniform,_value,_bytes);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
 void ShaderProgram::printProperties() const noexcept
 {
   printActiveUniforms();
@@ -218,281 +342,381 @@ void ShaderProgram::printActiveAttributes() const noexcept
 
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniform1f( const char* _varname,  float _v0  ) const noexcept
+void ShaderProgram::setUniform1f(const char* _varname, float _v0) const noexcept
 {
-  glUniform1f(getUniformLocation(_varname),_v0);
+  const uniformData *uniform=getUniform(_varname);
+  const float value[]={_v0};
+  if(needsUpload(uniform,value,sizeof(value)))
+  {
+    glUniform1f(location(uniform),_v0);
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setRegisteredUniform1f( const std::string &_varname, float _v0    ) const noexcept
+void ShaderProgram::setRegisteredUniform1f(const std::string &_varname, float _v0) const noexcept
 {
   auto uniform=m_registeredUniforms.find(_varname);
   // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  const float value[]={_v0};
+  if(uniform!=m_registeredUniforms.end() && needsUpload(&uniform->second,value,sizeof(value)))
   {
     glUniform1f(uniform->second.loc,_v0);
   }
-
 }
+
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniform2f(const char* _varname, float _v0, float _v1 ) const noexcept
+void ShaderProgram::setUniform2f(const char* _varname, float _v0, float _v1) const noexcept
 {
-  glUniform2f(getUniformLocation(_varname),_v0,_v1);
+  const uniformData *uniform=getUniform(_varname);
+  const float value[]={_v0,_v1};
+  if(needsUpload(uniform,value,sizeof(value)))
+  {
+    glUniform2f(location(uniform),_v0,_v1);
+  }
 }
 
-
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setRegisteredUniform2f(const std::string &_varname, float _v0, float _v1 ) const noexcept
+void ShaderProgram::setRegisteredUniform2f(const std::string &_varname, float _v0, float _v1) const noexcept
 {
   auto uniform=m_registeredUniforms.find(_varname);
   // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  const float value[]={_v0,_v1};
+  if(uniform!=m_registeredUniforms.end() && needsUpload(&uniform->second,value,sizeof(value)))
   {
     glUniform2f(uniform->second.loc,_v0,_v1);
   }
-
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniform3f(const char* _varname, float _v0,  float _v1, float _v2  ) const noexcept
+void ShaderProgram::setUniform3f(const char* _varname, float _v0, float _v1, float _v2) const noexcept
 {
-  glUniform3f(getUniformLocation(_varname),_v0,_v1,_v2);
+  const uniformData *uniform=getUniform(_varname);
+  const float value[]={_v0,_v1,_v2};
+  if(needsUpload(uniform,value,sizeof(value)))
+  {
+    glUniform3f(location(uniform),_v0,_v1,_v2);
+  }
 }
+
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setRegisteredUniform3f( const std::string &_varname, float _v0, float _v1, float _v2  ) const noexcept
+void ShaderProgram::setRegisteredUniform3f(const std::string &_varname, float _v0, float _v1, float _v2) const noexcept
 {
   auto uniform=m_registeredUniforms.find(_varname);
   // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  const float value[]={_v0,_v1,_v2};
+  if(uniform!=m_registeredUniforms.end() && needsUpload(&uniform->second,value,sizeof(value)))
   {
     glUniform3f(uniform->second.loc,_v0,_v1,_v2);
   }
-
 }
+
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniform4f( const char* _varname, float _v0,float _v1,  float _v2, float _v3 ) const noexcept
+void ShaderProgram::setUniform4f(const char* _varname, float _v0, float _v1, float _v2, float _v3) const noexcept
 {
-
-  glUniform4f(getUniformLocation(_varname),_v0,_v1,_v2,_v3);
+  const uniformData *uniform=getUniform(_varname);
+  const float value[]={_v0,_v1,_v2,_v3};
+  if(needsUpload(uniform,value,sizeof(value)))
+  {
+    glUniform4f(location(uniform),_v0,_v1,_v2,_v3);
+  }
 }
+
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setRegisteredUniform4f( const std::string &_varname, float _v0, float _v1,  float _v2, float _v3  ) const noexcept
+void ShaderProgram::setRegisteredUniform4f(const std::string &_varname, float _v0, float _v1, float _v2, float _v3) const noexcept
 {
   auto uniform=m_registeredUniforms.find(_varname);
   // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  const float value[]={_v0,_v1,_v2,_v3};
+  if(uniform!=m_registeredUniforms.end() && needsUpload(&uniform->second,value,sizeof(value)))
   {
     glUniform4f(uniform->second.loc,_v0,_v1,_v2,_v3);
   }
-
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniform1fv(const char* _varname,  size_t _count,  const float* _value ) const noexcept
+void ShaderProgram::setUniform1fv(const char* _varname, size_t _count, const float* _value) const noexcept
 {
-  glUniform1fv(getUniformLocation(_varname),_count,_value);
+  const uniformData *uniform=getUniform(_varname);
+  if(needsUpload(uniform,_value,1*_count*sizeof(float),_count==1))
+  {
+    glUniform1fv(location(uniform),_count,_value);
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniform2fv(const char* _varname,  size_t _count,  const float* _value ) const noexcept
+void ShaderProgram::setUniform2fv(const char* _varname, size_t _count, const float* _value) const noexcept
 {
-  glUniform2fv(getUniformLocation(_varname),_count,_value);
+  const uniformData *uniform=getUniform(_varname);
+  if(needsUpload(uniform,_value,2*_count*sizeof(float),_count==1))
+  {
+    glUniform2fv(location(uniform),_count,_value);
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniform3fv( const char* _varname, size_t _count, const float* _value  ) const noexcept
+void ShaderProgram::setUniform3fv(const char* _varname, size_t _count, const float* _value) const noexcept
 {
-  glUniform3fv(getUniformLocation(_varname),_count,_value);
+  const uniformData *uniform=getUniform(_varname);
+  if(needsUpload(uniform,_value,3*_count*sizeof(float),_count==1))
+  {
+    glUniform3fv(location(uniform),_count,_value);
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniform4fv(const char* _varname,size_t _count, const float* _value  ) const noexcept
+void ShaderProgram::setUniform4fv(const char* _varname, size_t _count, const float* _value) const noexcept
 {
-  glUniform4fv(getUniformLocation(_varname),_count,_value);
-
+  const uniformData *uniform=getUniform(_varname);
+  if(needsUpload(uniform,_value,4*_count*sizeof(float),_count==1))
+  {
+    glUniform4fv(location(uniform),_count,_value);
+  }
 }
 
-
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniform1i( const char* _varname, GLint _v0 ) const noexcept
+void ShaderProgram::setUniform1i(const char* _varname, GLint _v0) const noexcept
 {
-  glUniform1i(getUniformLocation(_varname),_v0);
-
+  const uniformData *uniform=getUniform(_varname);
+  const GLint value[]={_v0};
+  if(needsUpload(uniform,value,sizeof(value)))
+  {
+    glUniform1i(location(uniform),_v0);
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setRegisteredUniform1i( const std::string &_varname, int _v0  ) const noexcept
+void ShaderProgram::setRegisteredUniform1i(const std::string &_varname, int _v0) const noexcept
 {
   auto uniform=m_registeredUniforms.find(_varname);
   // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  const GLint value[]={_v0};
+  if(uniform!=m_registeredUniforms.end() && needsUpload(&uniform->second,value,sizeof(value)))
   {
     glUniform1i(uniform->second.loc,_v0);
   }
+}
 
+//----------------------------------------------------------------------------------------------------------------------
+void ShaderProgram::setUniform2i(const char* _varname, GLint _v0, GLint _v1) const noexcept
+{
+  const uniformData *uniform=getUniform(_varname);
+  const GLint value[]={_v0,_v1};
+  if(needsUpload(uniform,value,sizeof(value)))
+  {
+    glUniform2i(location(uniform),_v0,_v1);
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setRegisteredUniform2i( const std::string &_varname, int _v0, int _v1   ) const noexcept
+void ShaderProgram::setRegisteredUniform2i(const std::string &_varname, int _v0, int _v1) const noexcept
 {
   auto uniform=m_registeredUniforms.find(_varname);
   // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  const GLint value[]={_v0,_v1};
+  if(uniform!=m_registeredUniforms.end() && needsUpload(&uniform->second,value,sizeof(value)))
   {
     glUniform2i(uniform->second.loc,_v0,_v1);
   }
-
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+void ShaderProgram::setUniform3i(const char* _varname, GLint _v0, GLint _v1, GLint _v2) const noexcept
+{
+  const uniformData *uniform=getUniform(_varname);
+  const GLint value[]={_v0,_v1,_v2};
+  if(needsUpload(uniform,value,sizeof(value)))
+  {
+    glUniform3i(location(uniform),_v0,_v1,_v2);
+  }
+}
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setRegisteredUniform3i(const std::string &_varname,  int _v0,   int _v1,  int _v2   ) const noexcept
+void ShaderProgram::setRegisteredUniform3i(const std::string &_varname, int _v0, int _v1, int _v2) const noexcept
 {
   auto uniform=m_registeredUniforms.find(_varname);
   // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  const GLint value[]={_v0,_v1,_v2};
+  if(uniform!=m_registeredUniforms.end() && needsUpload(&uniform->second,value,sizeof(value)))
   {
     glUniform3i(uniform->second.loc,_v0,_v1,_v2);
   }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setRegisteredUniform4i( const std::string &_varname,  int _v0,   int _v1, int _v2,  int _v3  ) const noexcept
+void ShaderProgram::setUniform4i(const char* _varname, GLint _v0, GLint _v1, GLint _v2, GLint _v3) const noexcept
+{
+  const uniformData *uniform=getUniform(_varname);
+  const GLint value[]={_v0,_v1,_v2,_v3};
+  if(needsUpload(uniform,value,sizeof(value)))
+  {
+    glUniform4i(location(uniform),_v0,_v1,_v2,_v3);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void ShaderProgram::setRegisteredUniform4i(const std::string &_varname, int _v0, int _v1, int _v2, int _v3) const noexcept
 {
   auto uniform=m_registeredUniforms.find(_varname);
   // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  const GLint value[]={_v0,_v1,_v2,_v3};
+  if(uniform!=m_registeredUniforms.end() && needsUpload(&uniform->second,value,sizeof(value)))
   {
     glUniform4i(uniform->second.loc,_v0,_v1,_v2,_v3);
   }
-
 }
-//----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniform2i( const char* _varname,  GLint _v0,  GLint _v1 ) const noexcept
-{
-  glUniform2i(getUniformLocation(_varname),_v0,_v1);
 
-}
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniform3i( const char* _varname, GLint _v0,  GLint _v1,   GLint _v2  ) const noexcept
+void ShaderProgram::setUniform1iv(const char* _varname, size_t _count, const GLint* _value) const noexcept
 {
-  glUniform3i(getUniformLocation(_varname),_v0,_v1,_v2);
-
+  const uniformData *uniform=getUniform(_varname);
+  if(needsUpload(uniform,_value,1*_count*sizeof(GLint),_count==1))
+  {
+    glUniform1iv(location(uniform),_count,_value);
+  }
 }
-//----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniform4i( const char* _varname,   GLint _v0,GLint _v1,   GLint _v2, GLint _v3  ) const noexcept
-{
-  glUniform4i(getUniformLocation(_varname),_v0,_v1,_v2,_v3);
 
-}
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniform1iv( const char* _varname, size_t _count,  const GLint* _value ) const noexcept
+void ShaderProgram::setUniform2iv(const char* _varname, size_t _count, const GLint* _value) const noexcept
 {
-  glUniform1iv(getUniformLocation(_varname),_count,_value);
-
+  const uniformData *uniform=getUniform(_varname);
+  if(needsUpload(uniform,_value,2*_count*sizeof(GLint),_count==1))
+  {
+    glUniform2iv(location(uniform),_count,_value);
+  }
 }
+
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniform2iv( const char* _varname, size_t _count, const GLint* _value   ) const noexcept
+void ShaderProgram::setUniform3iv(const char* _varname, size_t _count, const GLint* _value) const noexcept
 {
-  glUniform2iv(getUniformLocation(_varname),_count,_value);
+  const uniformData *uniform=getUniform(_varname);
+  if(needsUpload(uniform,_value,3*_count*sizeof(GLint),_count==1))
+  {
+    glUniform3iv(location(uniform),_count,_value);
+  }
 }
-//----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniform3iv( const char* _varname,size_t _count, const GLint* _value ) const noexcept
-{
-  glUniform3iv(getUniformLocation(_varname),_count,_value);
 
-}
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniform4iv(const char* _varname, size_t _count,const GLint* _value  ) const noexcept
+void ShaderProgram::setUniform4iv(const char* _varname, size_t _count, const GLint* _value) const noexcept
 {
-  glUniform4iv(getUniformLocation(_varname),_count,_value);
+  const uniformData *uniform=getUniform(_varname);
+  if(needsUpload(uniform,_value,4*_count*sizeof(GLint),_count==1))
+  {
+    glUniform4iv(location(uniform),_count,_value);
+  }
 }
 
-
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniformMatrix2fv(const char* _varname,size_t _count, bool _transpose,const float* _value ) const noexcept
+void ShaderProgram::setUniformMatrix2fv(const char* _varname, size_t _count, bool _transpose, const float* _value) const noexcept
 {
-  glUniformMatrix2fv(getUniformLocation(_varname),_count,_transpose,_value);
+  const uniformData *uniform=getUniform(_varname);
+  if(needsUpload(uniform,_value,4*_count*sizeof(float),_count==1 && !_transpose))
+  {
+    glUniformMatrix2fv(location(uniform),_count,_transpose,_value);
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniformMatrix3fv( const char* _varname, size_t _count,bool _transpose, const float* _value ) const noexcept
+void ShaderProgram::setUniformMatrix3fv(const char* _varname, size_t _count, bool _transpose, const float* _value) const noexcept
 {
-  glUniformMatrix3fv(getUniformLocation(_varname),_count,_transpose,_value);
-
+  const uniformData *uniform=getUniform(_varname);
+  if(needsUpload(uniform,_value,9*_count*sizeof(float),_count==1 && !_transpose))
+  {
+    glUniformMatrix3fv(location(uniform),_count,_transpose,_value);
+  }
 }
 
-
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setRegisteredUniformMatrix3fv( const std::string &_varname,size_t _count, bool _transpose,const float* _value) const noexcept
+void ShaderProgram::setRegisteredUniformMatrix3fv(const std::string &_varname, size_t _count, bool _transpose, const float* _value) const noexcept
 {
   auto uniform=m_registeredUniforms.find(_varname);
   // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  if(uniform!=m_registeredUniforms.end() &&
+     needsUpload(&uniform->second,_value,9*_count*sizeof(float),_count==1 && !_transpose))
   {
     glUniformMatrix3fv(uniform->second.loc,_count,_transpose,_value);
   }
-
 }
+
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniformMatrix4fv(const char* _varname, size_t _count, bool _transpose, const float* _value ) const noexcept
+void ShaderProgram::setUniformMatrix4fv(const char* _varname, size_t _count, bool _transpose, const float* _value) const noexcept
 {
-  glUniformMatrix4fv(getUniformLocation(_varname),_count,_transpose,_value);
+  const uniformData *uniform=getUniform(_varname);
+  if(needsUpload(uniform,_value,16*_count*sizeof(float),_count==1 && !_transpose))
+  {
+    glUniformMatrix4fv(location(uniform),_count,_transpose,_value);
+  }
 }
 
-
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setRegisteredUniformMatrix4fv(const std::string &_varname, size_t _count, bool _transpose,  const float* _value ) const noexcept
+void ShaderProgram::setRegisteredUniformMatrix4fv(const std::string &_varname, size_t _count, bool _transpose, const float* _value) const noexcept
 {
   auto uniform=m_registeredUniforms.find(_varname);
   // make sure we have a valid shader
-  if(uniform!=m_registeredUniforms.end())
+  if(uniform!=m_registeredUniforms.end() &&
+     needsUpload(&uniform->second,_value,16*_count*sizeof(float),_count==1 && !_transpose))
   {
     glUniformMatrix4fv(uniform->second.loc,_count,_transpose,_value);
   }
-
 }
-//----------------------------------------------------------------------------------------------------------------------
-
-
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniformMatrix2x3fv(const char* _varname,size_t _count,bool _transpose, const float* _value  ) const noexcept
+void ShaderProgram::setUniformMatrix2x3fv(const char* _varname, size_t _count, bool _transpose, const float* _value) const noexcept
 {
-  glUniformMatrix2x3fv(getUniformLocation(_varname),_count,_transpose,_value);
+  const uniformData *uniform=getUniform(_varname);
+  if(needsUpload(uniform,_value,6*_count*sizeof(float),_count==1 && !_transpose))
+  {
+    glUniformMatrix2x3fv(location(uniform),_count,_transpose,_value);
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniformMatrix2x4fv(const char* _varname, size_t _count,bool _transpose,const float* _value) const noexcept
+void ShaderProgram::setUniformMatrix2x4fv(const char* _varname, size_t _count, bool _transpose, const float* _value) const noexcept
 {
-  glUniformMatrix2x4fv(getUniformLocation(_varname),_count,_transpose,_value);
-
+  const uniformData *uniform=getUniform(_varname);
+  if(needsUpload(uniform,_value,8*_count*sizeof(float),_count==1 && !_transpose))
+  {
+    glUniformMatrix2x4fv(location(uniform),_count,_transpose,_value);
+  }
 }
+
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniformMatrix3x2fv(const char* _varname,size_t _count,bool _transpose,const float* _value ) const noexcept
+void ShaderProgram::setUniformMatrix3x2fv(const char* _varname, size_t _count, bool _transpose, const float* _value) const noexcept
 {
-  glUniformMatrix3x2fv(getUniformLocation(_varname),_count,_transpose,_value);
-
+  const uniformData *uniform=getUniform(_varname);
+  if(needsUpload(uniform,_value,6*_count*sizeof(float),_count==1 && !_transpose))
+  {
+    glUniformMatrix3x2fv(location(uniform),_count,_transpose,_value);
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniformMatrix3x4fv(const char* _varname,size_t _count,bool _transpose, const float* _value) const noexcept
+void ShaderProgram::setUniformMatrix3x4fv(const char* _varname, size_t _count, bool _transpose, const float* _value) const noexcept
 {
-  glUniformMatrix3x4fv(getUniformLocation(_varname),_count,_transpose,_value);
-
+  const uniformData *uniform=getUniform(_varname);
+  if(needsUpload(uniform,_value,12*_count*sizeof(float),_count==1 && !_transpose))
+  {
+    glUniformMatrix3x4fv(location(uniform),_count,_transpose,_value);
+  }
 }
+
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniformMatrix4x2fv(const char* _varname,size_t _count,bool _transpose,const float* _value ) const noexcept
+void ShaderProgram::setUniformMatrix4x2fv(const char* _varname, size_t _count, bool _transpose, const float* _value) const noexcept
 {
-  glUniformMatrix4x2fv(getUniformLocation(_varname),_count,_transpose,_value);
-
+  const uniformData *uniform=getUniform(_varname);
+  if(needsUpload(uniform,_value,8*_count*sizeof(float),_count==1 && !_transpose))
+  {
+    glUniformMatrix4x2fv(location(uniform),_count,_transpose,_value);
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
-void ShaderProgram::setUniformMatrix4x3fv(const char* _varname,size_t _count,bool _transpose,const float* _value) const noexcept
+void ShaderProgram::setUniformMatrix4x3fv(const char* _varname, size_t _count, bool _transpose, const float* _value) const noexcept
 {
-  glUniformMatrix4x3fv(getUniformLocation(_varname),_count,_transpose,_value);
-
+  const uniformData *uniform=getUniform(_varname);
+  if(needsUpload(uniform,_value,12*_count*sizeof(float),_count==1 && !_transpose))
+  {
+    glUniformMatrix4x3fv(location(uniform),_count,_transpose,_value);
+  }
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -543,9 +767,22 @@ GLuint ShaderProgram::getUniformBlockIndex( const std::string &_uniformBlockName
   return glGetUniformBlockIndex(m_programID,_uniformBlockName.c_str());
 }
 
+void ShaderProgram::setUniformBlockBinding( const std::string &_uniformBlockName, GLuint _binding )const noexcept
+{
+  GLuint index=getUniformBlockIndex(_uniformBlockName);
+  if(index==GL_INVALID_INDEX)
+  {
+    std::cerr<<"Uniform block \""<<_uniformBlockName<<"\" not found in Program \""<<m_programName<<"\"\n";
+    return;
+  }
+  glUniformBlockBinding(m_programID,index,_binding);
+}
+
 
 void ShaderProgram::autoRegisterUniforms() noexcept
 {
+  // locations and values may have changed (re-link) so handles must be looked up again
+  m_handleUniforms.clear();
 
 
   GLint nUniforms;
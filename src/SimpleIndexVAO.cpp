@@ -1,4 +1,5 @@
 #include "SimpleIndexVAO.h"
+#include "GLStateCache.h"
 #include <iostream>
 namespace ngl
 {
@@ -20,6 +21,18 @@ namespace ngl
     glDrawElements(m_mode,static_cast<GLsizei>(m_indicesCount),m_indexType,static_cast<GLvoid *>(nullptr));
   }
 
+  void SimpleIndexVAO::drawInstanced(GLsizei _instances) const
+  {
+    if(m_allocated == false)
+    {
+      std::cerr<<"Warning trying to draw an unallocated VOA\n";
+    }
+    if(m_bound == false)
+    {
+      std::cerr<<"Warning trying to draw an unbound VOA\n";
+    }
+    glDrawElementsInstanced(m_mode,static_cast<GLsizei>(m_indicesCount),m_indexType,static_cast<GLvoid *>(nullptr),_instances);
+  }
   void SimpleIndexVAO::removeVAO()
   {
     if(m_bound == true)
@@ -29,8 +42,11 @@ namespace ngl
     if( m_allocated ==true)
     {
         glDeleteBuffers(1,&m_buffer);
+        glDeleteBuffers(1,&m_indexBuffer);
     }
+    removeInstanceBuffers();
     glDeleteVertexArrays(1,&m_id);
+    GLStateCache::instance()->vertexArrayDeleted(m_id);
     m_allocated=false;
     }
 
@@ -43,6 +59,12 @@ namespace ngl
     {
     std::cerr<<"trying to set VOA data when unbound\n";
     }
+    // if we already have data remove the old buffers so we don't leak them
+    if( m_allocated ==true)
+    {
+      glDeleteBuffers(1,&m_buffer);
+      glDeleteBuffers(1,&m_indexBuffer);
+    }
     GLuint vboID;
     glGenBuffers(1, &vboID);
 
@@ -67,6 +89,8 @@ namespace ngl
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.m_indexSize * static_cast<GLsizeiptr>(size), const_cast<GLvoid *>(data.m_indexData),data.m_mode);
 
     m_allocated=true;
+    m_buffer=vboID;
+    m_indexBuffer=iboID;
     m_indexType=data.m_indexType;
   }
 
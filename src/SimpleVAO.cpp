@@ -1,4 +1,5 @@
 #include "SimpleVAO.h"
+#include "GLStateCache.h"
 #include <iostream>
 namespace ngl
 {
@@ -20,6 +21,18 @@ namespace ngl
     glDrawArrays(m_mode, 0, static_cast<GLsizei>(m_indicesCount));
   }
 
+  void SimpleVAO::drawInstanced(GLsizei _instances) const
+  {
+    if(m_allocated == false)
+    {
+      std::cerr<<"Warning trying to draw an unallocated VOA\n";
+    }
+    if(m_bound == false)
+    {
+      std::cerr<<"Warning trying to draw an unbound VOA\n";
+    }
+    glDrawArraysInstanced(m_mode, 0, static_cast<GLsizei>(m_indicesCount), _instances);
+  }
   void SimpleVAO::removeVAO()
   {
     if(m_bound == true)
@@ -30,7 +43,9 @@ namespace ngl
     {
         glDeleteBuffers(1,&m_buffer);
     }
+    removeInstanceBuffers();
     glDeleteVertexArrays(1,&m_id);
+    GLStateCache::instance()->vertexArrayDeleted(m_id);
     m_allocated=false;
     }
 
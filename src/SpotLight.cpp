@@ -17,6 +17,7 @@
 //---------------------------------------------------------------------------
 #include "SpotLight.h"
 #include "ShaderLib.h"
+#include "UniformBlock.h"
 //----------------------------------------------------------------------------------------------------------------------
 /// @file SpotLight.cpp
 /// @brief implementation files for SpotLight class
@@ -159,6 +160,35 @@ void SpotLight::loadToShader( std::string _uniformName)const noexcept
     shader->setShaderParam4f(_uniformName+".specular",0,0,0,0);
   }
 }
+void SpotLight::loadToBlock(UniformBlock &o_block, const std::string &_uniformName)const noexcept
+{
+  if(m_active==true)
+  {
+    Vec4 pos=m_transform*m_position;
+    Vec4 dir=m_transform*m_dir;
+    pos.m_w=Real(m_lightMode);
+    o_block.set(_uniformName+".position",pos);
+    o_block.set(_uniformName+".direction",dir.toVec3());
+    o_block.set(_uniformName+".ambient",m_ambient);
+    o_block.set(_uniformName+".diffuse",m_diffuse);
+    o_block.set(_uniformName+".specular",m_specular);
+    o_block.set(_uniformName+".spotCosCutoff",m_cutoffAngle);
+    o_block.set(_uniformName+".spotCosInnerCutoff",m_innerCutoffAngle);
+    o_block.set(_uniformName+".spotExponent",m_spotExponent);
+    o_block.set(_uniformName+".constantAttenuation",m_constantAtten);
+    o_block.set(_uniformName+".linearAttenuation",m_linearAtten);
+    o_block.set(_uniformName+".quadraticAttenuation",m_quadraticAtten);
+  }
+  else
+  {
+    // turn light off by setting 0 values
+    o_block.set(_uniformName+".position",Vec4(0,0,0,Real(m_lightMode)));
+    o_block.set(_uniformName+".ambient",Vec4(0,0,0,0));
+    o_block.set(_uniformName+".diffuse",Vec4(0,0,0,0));
+    o_block.set(_uniformName+".specular",Vec4(0,0,0,0));
+  }
+}
+
 void SpotLight::setTransform(Mat4 &_t) noexcept
 {
   m_transform=_t;
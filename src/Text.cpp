@@ -271,9 +271,12 @@ void Text::renderText( float _x, float _y,  const QString &text ) const noexcept
   ShaderLib *shader=ShaderLib::instance();
   // use the built in text rendering shader
   (*shader)["nglTextShader"]->use();
+  // the positions are set for every glyph so use handles rather than names
+  static const UniformHandle xpos=shader->getUniformHandle("xpos");
+  static const UniformHandle ypos=shader->getUniformHandle("ypos");
   // the y pos will always be the same so set it once for each
   // string we are rendering
-  shader->setRegisteredUniform1f("ypos",_y);
+  shader->setUniform(ypos,_y);
   // now enable blending and disable depth sorting so the font renders
   // correctly
   glEnable(GL_BLEND);
@@ -286,7 +289,7 @@ void Text::renderText( float _x, float _y,  const QString &text ) const noexcept
   {
     // set the shader x position this will change each time
     // we render a glyph by the width of the char
-    shader->setRegisteredUniform1f("xpos",_x);
+    shader->setUniform(xpos,_x);
     // so find the FontChar data for our current char
 //    FontChar f = m_characters[text[i].toAscii()];
     FontChar f = m_characters[text[i].toLatin1()];
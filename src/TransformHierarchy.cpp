@@ -0,0 +1,389 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "TransformHierarchy.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <iostream>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file TransformHierarchy.cpp
+/// @brief implementation files for TransformHierarchy class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+
+constexpr uint32_t TransformHierarchy::s_none;
+
+namespace
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the fewest nodes worth giving a thread in update
+  //----------------------------------------------------------------------------------------------------------------------
+  constexpr size_t s_minNodesPerThread=4096;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+TransformHierarchy::TransformHierarchy() noexcept
+{
+  m_levels.push_back(0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint32_t TransformHierarchy::addNode(const Transformation &_local, uint32_t _parent) noexcept
+{
+  if(_parent!=s_none && !contains(_parent))
+  {
+    std::cerr<<"TransformHierarchy::addNode parent "<<_parent<<" is not a valid node\n";
+    return s_none;
+  }
+  uint32_t handle;
+  if(!m_freeHandles.empty())
+  {
+    handle=m_freeHandles.back();
+    m_freeHandles.pop_back();
+  }
+  else
+  {
+    handle=static_cast<uint32_t>(m_slot.size());
+    m_slot.push_back(-1);
+    m_parent.push_back(s_none);
+  }
+  size_t slot=m_handle.size();
+  m_local.push_back(_local);
+  m_world.push_back(Mat4());
+  m_parentSlot.push_back(_parent==s_none ? -1 : m_slot[_parent]);
+  m_changed.push_back(1);
+  m_handle.push_back(handle);
+  m_slot[handle]=static_cast<int32_t>(slot);
+  m_parent[handle]=_parent;
+  if(!m_orderChanged)
+  {
+    // the slots stay sorted if the new node is at the deepest level or one below it
+    size_t depth=0;
+    if(_parent!=s_none)
+    {
+      depth=std::upper_bound(m_levels.begin(),m_levels.end(),size_t(m_slot[_parent]))-m_levels.begin();
+    }
+    if(depth+1==numLevels())
+    {
+      m_levels.back()=slot+1;
+    }
+    else if(depth==numLevels())
+    {
+      m_levels.push_back(slot+1);
+    }
+    else
+    {
+      m_orderChanged=true;
+    }
+  }
+  return handle;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool TransformHierarchy::removeNode(uint32_t _node) noexcept
+{
+  if(!contains(_node))
+  {
+    std::cerr<<"TransformHierarchy::removeNode "<<_node<<" is not a valid node\n";
+    return false;
+  }
+  if(m_orderChanged)
+  {
+    sortByDepth();
+  }
+  // parents come before their children so one pass finds all the descendants
+  size_t n=m_handle.size();
+  std::vector<uint8_t> removed(n,0);
+  size_t first=static_cast<size_t>(m_slot[_node]);
+  removed[first]=1;
+  for(size_t i=first+1; i<n; ++i)
+  {
+    removed[i]= m_parentSlot[i]!=-1 && removed[m_parentSlot[i]];
+  }
+  // compact the slots keeping their order, so they stay sorted by depth
+  std::vector<int32_t> newSlot(n,-1);
+  size_t kept=0;
+  size_t level=0;
+  for(size_t i=0; i<n; ++i)
+  {
+    while(level<m_levels.size() && m_levels[level]==i)
+    {
+      m_levels[level++]=kept;
+    }
+    uint32_t handle=m_handle[i];
+    if(removed[i])
+    {
+      m_slot[handle]=-1;
+      m_parent[handle]=s_none;
+      m_freeHandles.push_back(handle);
+      continue;
+    }
+    newSlot[i]=static_cast<int32_t>(kept);
+    m_local[kept]=m_local[i];
+    m_world[kept]=m_world[i];
+    m_parentSlot[kept]= m_parentSlot[i]==-1 ? -1 : newSlot[m_parentSlot[i]];
+    m_changed[kept]=m_changed[i];
+    m_handle[kept]=handle;
+    m_slot[handle]=static_cast<int32_t>(kept);
+    ++kept;
+  }
+  m_levels.back()=kept;
+  // drop levels left empty at the bottom
+  while(m_levels.size()>1 && m_levels[m_levels.size()-2]==kept)
+  {
+    m_levels.pop_back();
+  }
+  m_local.resize(kept);
+  m_world.resize(kept);
+  m_parentSlot.resize(kept);
+  m_changed.resize(kept);
+  m_handle.resize(kept);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool TransformHierarchy::setParent(uint32_t _node, uint32_t _parent) noexcept
+{
+  if(!contains(_node) || (_parent!=s_none && !contains(_parent)))
+  {
+    std::cerr<<"TransformHierarchy::setParent "<<_node<<" or "<<_parent<<" is not a valid node\n";
+    return false;
+  }
+  for(uint32_t p=_parent; p!=s_none; p=m_parent[p])
+  {
+    if(p==_node)
+    {
+      std::cerr<<"TransformHierarchy::setParent "<<_parent<<" is "<<_node<<" or one of its children\n";
+      return false;
+    }
+  }
+  m_parent[_node]=_parent;
+  int32_t slot=m_slot[_node];
+  m_parentSlot[slot]= _parent==s_none ? -1 : m_slot[_parent];
+  m_changed[slot]=1;
+  m_orderChanged=true;
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+uint32_t TransformHierarchy::getParent(uint32_t _node) const noexcept
+{
+  return contains(_node) ? m_parent[_node] : s_none;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+int32_t TransformHierarchy::touch(uint32_t _node) noexcept
+{
+  if(!contains(_node))
+  {
+    return -1;
+  }
+  int32_t slot=m_slot[_node];
+  m_changed[slot]=1;
+  return slot;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool TransformHierarchy::setLocal(uint32_t _node, const Transformation &_local) noexcept
+{
+  int32_t slot=touch(_node);
+  if(slot!=-1)
+  {
+    m_local[slot]=_local;
+  }
+  return slot!=-1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool TransformHierarchy::setPosition(uint32_t _node, const Vec3 &_position) noexcept
+{
+  int32_t slot=touch(_node);
+  if(slot!=-1)
+  {
+    m_local[slot].setPosition(_position);
+  }
+  return slot!=-1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool TransformHierarchy::setRotation(uint32_t _node, const Vec3 &_rotation) noexcept
+{
+  int32_t slot=touch(_node);
+  if(slot!=-1)
+  {
+    m_local[slot].setRotation(_rotation);
+  }
+  return slot!=-1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool TransformHierarchy::setScale(uint32_t _node, const Vec3 &_scale) noexcept
+{
+  int32_t slot=touch(_node);
+  if(slot!=-1)
+  {
+    m_local[slot].setScale(_scale);
+  }
+  return slot!=-1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const Transformation & TransformHierarchy::getLocal(uint32_t _node) const noexcept
+{
+  NGL_ASSERT(contains(_node));
+  return m_local[m_slot[_node]];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const Mat4 & TransformHierarchy::getWorldMatrix(uint32_t _node) const noexcept
+{
+  NGL_ASSERT(contains(_node));
+  return m_world[m_slot[_node]];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformHierarchy::clear() noexcept
+{
+  m_local.clear();
+  m_world.clear();
+  m_parentSlot.clear();
+  m_changed.clear();
+  m_handle.clear();
+  m_levels.assign(1,0);
+  m_slot.clear();
+  m_parent.clear();
+  m_freeHandles.clear();
+  m_orderChanged=false;
+  m_numUpdated=0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformHierarchy::sortByDepth() noexcept
+{
+  size_t n=m_handle.size();
+  // find the depth of each node walking up to the first ancestor with a known depth
+  std::vector<int32_t> depth(m_slot.size(),-1);
+  std::vector<uint32_t> path;
+  int32_t maxDepth=0;
+  for(uint32_t handle : m_handle)
+  {
+    uint32_t h=handle;
+    while(depth[h]==-1 && m_parent[h]!=s_none)
+    {
+      path.push_back(h);
+      h=m_parent[h];
+    }
+    int32_t d= depth[h]==-1 ? 0 : depth[h];
+    depth[h]=d;
+    while(!path.empty())
+    {
+      depth[path.back()]=++d;
+      path.pop_back();
+    }
+    maxDepth=std::max(maxDepth,d);
+  }
+  // counting sort of the slots by depth, keeping the current order within each depth
+  m_levels.assign(maxDepth+2,0);
+  for(uint32_t handle : m_handle)
+  {
+    ++m_levels[depth[handle]+1];
+  }
+  for(size_t l=1; l<m_levels.size(); ++l)
+  {
+    m_levels[l]+=m_levels[l-1];
+  }
+  std::vector<size_t> next(m_levels.begin(),m_levels.end()-1);
+  std::vector<Transformation> local(n);
+  std::vector<Mat4> world(n);
+  std::vector<uint8_t> changed(n);
+  std::vector<uint32_t> handles(n);
+  for(size_t i=0; i<n; ++i)
+  {
+    uint32_t handle=m_handle[i];
+    size_t slot=next[depth[handle]]++;
+    local[slot]=m_local[i];
+    world[slot]=m_world[i];
+    changed[slot]=m_changed[i];
+    handles[slot]=handle;
+    m_slot[handle]=static_cast<int32_t>(slot);
+  }
+  for(size_t i=0; i<n; ++i)
+  {
+    uint32_t parent=m_parent[handles[i]];
+    m_parentSlot[i]= parent==s_none ? -1 : m_slot[parent];
+  }
+  m_local.swap(local);
+  m_world.swap(world);
+  m_changed.swap(changed);
+  m_handle.swap(handles);
+  m_orderChanged=false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t TransformHierarchy::updateSlots(size_t _begin, size_t _end) noexcept
+{
+  size_t count=0;
+  for(size_t i=_begin; i<_end; ++i)
+  {
+    int32_t parent=m_parentSlot[i];
+    // the parents are a level up so their flags are final
+    if(parent!=-1 && m_changed[parent])
+    {
+      m_changed[i]=1;
+    }
+    if(m_changed[i])
+    {
+      m_world[i]= parent==-1 ? m_local[i].getMatrix() : m_local[i].getMatrix()*m_world[parent];
+      ++count;
+    }
+  }
+  return count;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void TransformHierarchy::update(unsigned int _numThreads) noexcept
+{
+  if(m_orderChanged)
+  {
+    sortByDepth();
+  }
+  m_numUpdated=0;
+  for(size_t l=0; l+1<m_levels.size(); ++l)
+  {
+    size_t begin=m_levels[l];
+    size_t end=m_levels[l+1];
+    size_t numChunks=chunkCount(end-begin,s_minNodesPerThread,_numThreads);
+    if(numChunks==1)
+    {
+      m_numUpdated+=updateSlots(begin,end);
+      continue;
+    }
+    std::vector<size_t> counts(numChunks,0);
+    forEachChunk(numChunks,[&](size_t _chunk)
+    {
+      counts[_chunk]=updateSlots(begin+(end-begin)*_chunk/numChunks,begin+(end-begin)*(_chunk+1)/numChunks);
+    });
+    for(size_t c : counts)
+    {
+      m_numUpdated+=c;
+    }
+  }
+  std::fill(m_changed.begin(),m_changed.end(),0);
+}
+
+} // end namespace ngl
+//----------------------------------------------------------------------------------------------------------------------
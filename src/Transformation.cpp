@@ -16,6 +16,8 @@
 */
 #include "ShaderLib.h"
 #include "Transformation.h"
+#include "Util.h"
+#include <cmath>
 //----------------------------------------------------------------------------------------------------------------------
 /// @file Transformation.cpp
 /// @brief implementation files for Transformation class
@@ -29,12 +31,15 @@ Transformation::Transformation() noexcept
   m_position = Vec3(0.0f,0.0f,0.0f);
   m_scale = Vec3(1.0f,1.0f,1.0f);
   m_rotation = Vec3(0.0f,0.0f,0.0f);
-  m_isMatrixComputed = false;
+  m_quaternion.set(1.0f,0.0f,0.0f,0.0f);
+  m_useQuaternion = false;
+  m_isMatrixComputed = true;
+  m_isTransposeComputed = true;
+  m_isInverseComputed = true;
+  m_isMatrixSet = false;
   m_matrix=1.0f;
   m_transposeMatrix=1.0f;
   m_inverseMatrix=1.0f;
-  computeMatrices();
-
 }
 
 Transformation::Transformation(const Transformation &_t) noexcept
@@ -44,7 +49,13 @@ Transformation::Transformation(const Transformation &_t) noexcept
   this->m_position=_t.m_position;
   this->m_scale = _t.m_scale;
   this->m_rotation = _t.m_rotation;
-  this->m_isMatrixComputed = true;
+  const Quaternion &q=_t.m_quaternion;
+  this->m_quaternion.set(q.getS(),q.getX(),q.getY(),q.getZ());
+  this->m_useQuaternion = _t.m_useQuaternion;
+  this->m_isMatrixComputed = _t.m_isMatrixComputed;
+  this->m_isTransposeComputed = _t.m_isTransposeComputed;
+  this->m_isInverseComputed = _t.m_isInverseComputed;
+  this->m_isMatrixSet = _t.m_isMatrixSet;
   this->m_matrix=_t.m_matrix;
   this->m_transposeMatrix=_t.m_transposeMatrix;
   this->m_inverseMatrix=_t.m_inverseMatrix;
@@ -57,7 +68,13 @@ Transformation & Transformation::operator =(const Transformation &_t) noexcept
   this->m_position=_t.m_position;
   this->m_scale = _t.m_scale;
   this->m_rotation = _t.m_rotation;
-  this->m_isMatrixComputed = true;
+  const Quaternion &q=_t.m_quaternion;
+  this->m_quaternion.set(q.getS(),q.getX(),q.getY(),q.getZ());
+  this->m_useQuaternion = _t.m_useQuaternion;
+  this->m_isMatrixComputed = _t.m_isMatrixComputed;
+  this->m_isTransposeComputed = _t.m_isTransposeComputed;
+  this->m_isInverseComputed = _t.m_isInverseComputed;
+  this->m_isMatrixSet = _t.m_isMatrixSet;
   this->m_matrix=_t.m_matrix;
   this->m_transposeMatrix=_t.m_transposeMatrix;
   this->m_inverseMatrix=_t.m_inverseMatrix;
@@ -70,9 +87,10 @@ Transformation & Transformation::operator =(const Transformation &_t) noexcept
 void Transformation::setMatrix( const Mat4 &_m   ) noexcept
 {
   m_matrix=_m;
-  m_transposeMatrix=_m;
-  m_transposeMatrix.transpose();
   m_isMatrixComputed = true;
+  m_isTransposeComputed = false;
+  m_isInverseComputed = false;
+  m_isMatrixSet = true;
 }
 
 // Set scale ---------------------------------------------------------------------------------------------------------------------
@@ -148,11 +166,13 @@ void Transformation::addPosition( Real _x, Real _y, Real _z ) noexcept
 void Transformation::setRotation( const Vec3 &_rotation ) noexcept
 {
   m_rotation = _rotation;
+  m_useQuaternion = false;
   m_isMatrixComputed = false;
 }
 void Transformation::setRotation( const Vec4 &_rotation ) noexcept
 {
   m_rotation = _rotation;
+  m_useQuaternion = false;
   m_isMatrixComputed = false;
 }
 
@@ -160,7 +180,14 @@ void Transformation::setRotation( const Vec4 &_rotation ) noexcept
 void Transformation::setRotation(Real _x, Real _y,  Real _z ) noexcept
 {
   m_rotation.set(_x,_y,_z);
+  m_useQuaternion = false;
+  m_isMatrixComputed = false;
+}
 
+void Transformation::setRotation( const Quaternion &_rotation ) noexcept
+{
+  m_quaternion.set(_rotation.getS(),_rotation.getX(),_rotation.getY(),_rotation.getZ());
+  m_useQuaternion = true;
   m_isMatrixComputed = false;
 }
 
@@ -169,6 +196,7 @@ void Transformation::setRotation(Real _x, Real _y,  Real _z ) noexcept
 void Transformation::addRotation(const Vec3 &_rotation  ) noexcept
 {
   m_rotation+= _rotation;
+  m_useQuaternion = false;
   m_isMatrixComputed = false;
 }
 void Transformation::addRotation(Real _x, Real _y, Real _z) noexcept
@@ -176,6 +204,7 @@ void Transformation::addRotation(Real _x, Real _y, Real _z) noexcept
   m_rotation.m_x+=_x;
   m_rotation.m_y+=_y;
   m_rotation.m_z+=_z;
+  m_useQuaternion = false;
   m_isMatrixComputed = false;
 }
 
@@ -186,6 +215,7 @@ void Transformation::reset() noexcept
   m_position = Vec3(0.0f,0.0f,0.0f);
   m_scale = Vec3(1.0f,1.0f,1.0f);
   m_rotation = Vec3(0.0f,0.0f,0.0f);
+  m_useQuaternion = false;
   m_isMatrixComputed = false;
   computeMatrices();
 }
@@ -195,47 +225,94 @@ void Transformation::computeMatrices() noexcept
 {
   if (!m_isMatrixComputed)       // need to recalculate
   {
-    Mat4 scale;
-    Mat4 rX;
-    Mat4 rY;
-    Mat4 rZ;
-    Mat4 trans;
-
-    // rotation/scale matrix
-    Mat4 rotationScale;
-    scale.scale(m_scale.m_x, m_scale.m_y, m_scale.m_z);
-
-    rX.rotateX(m_rotation.m_x);
-    rY.rotateY(m_rotation.m_y);
-    rZ.rotateZ(m_rotation.m_z);
-    rotationScale = scale * rX * rY * rZ;
-
-    // transform matrix
-    m_matrix = rotationScale;
+    // the rotation rows, the same as rX * rY * rZ written out rather than multiplying three matrices
+    Real r[3][3];
+    if(m_useQuaternion)
+    {
+      Mat4 q=m_quaternion.toMat4();
+      for(int i=0; i<3; ++i)
+      {
+        for(int j=0; j<3; ++j)
+        {
+          r[i][j]=q.m_m[i][j];
+        }
+      }
+    }
+    else
+    {
+      Real sx=sinf(radians(m_rotation.m_x));
+      Real cx=cosf(radians(m_rotation.m_x));
+      Real sy=sinf(radians(m_rotation.m_y));
+      Real cy=cosf(radians(m_rotation.m_y));
+      Real sz=sinf(radians(m_rotation.m_z));
+      Real cz=cosf(radians(m_rotation.m_z));
+      r[0][0]=cy*cz;            r[0][1]=cy*sz;            r[0][2]=-sy;
+      r[1][0]=sx*sy*cz-cx*sz;   r[1][1]=sx*sy*sz+cx*cz;   r[1][2]=sx*cy;
+      r[2][0]=cx*sy*cz+sx*sz;   r[2][1]=cx*sy*sz-sx*cz;   r[2][2]=cx*cy;
+    }
+    // scale * rotation scales each row, then the position is the last row
+    const Real scale[3]={m_scale.m_x,m_scale.m_y,m_scale.m_z};
+    for(int i=0; i<3; ++i)
+    {
+      m_matrix.m_m[i][0]=scale[i]*r[i][0];
+      m_matrix.m_m[i][1]=scale[i]*r[i][1];
+      m_matrix.m_m[i][2]=scale[i]*r[i][2];
+      m_matrix.m_m[i][3]=0.0f;
+    }
     m_matrix.m_m[3][0] = m_position.m_x;
     m_matrix.m_m[3][1] = m_position.m_y;
     m_matrix.m_m[3][2] = m_position.m_z;
     m_matrix.m_m[3][3] = 1;
 
+    m_isMatrixComputed = true;
+    m_isTransposeComputed = false;
+    m_isInverseComputed = false;
+    m_isMatrixSet = false;
+  }
+}
 
-
-    // tranpose matrix
-    m_transposeMatrix = rotationScale;
+void Transformation::computeTranspose() noexcept
+{
+  computeMatrices();
+  if(!m_isTransposeComputed)
+  {
+    m_transposeMatrix=m_matrix;
     m_transposeMatrix.transpose();
-    m_transposeMatrix.m_m[0][3] = m_position.m_x;
-    m_transposeMatrix.m_m[1][3] = m_position.m_y;
-    m_transposeMatrix.m_m[2][3] = m_position.m_z;
-    m_transposeMatrix.m_m[3][3] = 1;
-
-    // inverse matrix
-    trans.translate(-m_position.m_x, -m_position.m_y, -m_position.m_z);
-    scale.scale(1.0f / m_scale.m_x, 1.0f / m_scale.m_y, 1.0f / m_scale.m_z);
-    rX.rotateX(-m_rotation.m_x);
-    rY.rotateY(-m_rotation.m_y);
-    rZ.rotateZ(-m_rotation.m_z);
-    m_inverseMatrix = trans * rZ * rY * rX * scale  ;
+    m_isTransposeComputed = true;
+  }
+}
 
-    m_isMatrixComputed = true;
+void Transformation::computeInverse() noexcept
+{
+  computeMatrices();
+  if(!m_isInverseComputed)
+  {
+    if(m_isMatrixSet)
+    {
+      m_inverseMatrix=m_matrix.inverse();
+    }
+    else
+    {
+      // the inverse of scale * rotation * translate is -translate * transpose(rotation) * 1/scale, the rotation rows
+      // are the matrix rows divided by the scale so each element is divided by the scale twice
+      const Real scale[3]={m_scale.m_x,m_scale.m_y,m_scale.m_z};
+      const Real position[3]={m_position.m_x,m_position.m_y,m_position.m_z};
+      for(int j=0; j<3; ++j)
+      {
+        Real invScaleSq=1.0f/(scale[j]*scale[j]);
+        Real t=0.0f;
+        for(int i=0; i<3; ++i)
+        {
+          Real v=m_matrix.m_m[j][i]*invScaleSq;
+          m_inverseMatrix.m_m[i][j]=v;
+          t-=position[i]*v;
+        }
+        m_inverseMatrix.m_m[3][j]=t;
+        m_inverseMatrix.m_m[j][3]=0.0f;
+      }
+      m_inverseMatrix.m_m[3][3]=1.0f;
+    }
+    m_isInverseComputed = true;
   }
 }
 
@@ -243,30 +320,49 @@ void Transformation::operator*= ( const Transformation &_m) noexcept
 {
   m_isMatrixComputed=false;
 
-  computeMatrices();
-  m_matrix*=_m.m_matrix;
+  computeTranspose();
+  computeInverse();
+  // _m is const so work on a copy to bring its matrices up to date
+  Transformation m(_m);
+  m.computeTranspose();
+  m.computeInverse();
+  m_matrix*=m.m_matrix;
 
   /// transpose matrix transformation
-  m_transposeMatrix*=_m.m_transposeMatrix;
+  m_transposeMatrix*=m.m_transposeMatrix;
 
   /// inverse matrix transformation
-  m_inverseMatrix*=_m.m_inverseMatrix;
+  m_inverseMatrix*=m.m_inverseMatrix;
+  m_isMatrixSet=true;
 }
 
 Transformation Transformation::operator*(const Transformation &_m) noexcept
 {
   m_isMatrixComputed=false;
-  computeMatrices();
+  computeTranspose();
+  computeInverse();
+  Transformation m(_m);
+  m.computeTranspose();
+  m.computeInverse();
   Transformation t;
-  t.m_matrix=m_matrix*_m.m_matrix;
-  t.m_transposeMatrix=m_transposeMatrix*_m.m_transposeMatrix;
-  t.m_inverseMatrix=m_inverseMatrix*_m.m_inverseMatrix;
+  t.m_matrix=m_matrix*m.m_matrix;
+  t.m_transposeMatrix=m_transposeMatrix*m.m_transposeMatrix;
+  t.m_inverseMatrix=m_inverseMatrix*m.m_inverseMatrix;
+  t.m_isMatrixSet=true;
 
   return t;
 }
 void Transformation::loadMatrixToShader(const std::string &_param, const ActiveMatrix &_which) noexcept
 {
   computeMatrices();
+  if(_which==ActiveMatrix::TRANSPOSE)
+  {
+    computeTranspose();
+  }
+  else if(_which==ActiveMatrix::INVERSE)
+  {
+    computeInverse();
+  }
   ShaderLib *shader=ShaderLib::instance();
   switch (_which)
   {
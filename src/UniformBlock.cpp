@@ -0,0 +1,396 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "UniformBlock.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file UniformBlock.cpp
+/// @brief implementation files for UniformBlockLayout and UniformBlock classes
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+
+static size_t roundUp(size_t _value, size_t _multiple)
+{
+  return (_value+_multiple-1)/_multiple*_multiple;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool UniformBlockLayout::typeSize(GLenum _type, unsigned int &o_columns, unsigned int &o_rows) noexcept
+{
+  o_columns=1;
+  switch(_type)
+  {
+    case GL_FLOAT : case GL_INT : case GL_UNSIGNED_INT : case GL_BOOL : o_rows=1; break;
+    case GL_FLOAT_VEC2 : case GL_INT_VEC2 : case GL_UNSIGNED_INT_VEC2 : case GL_BOOL_VEC2 : o_rows=2; break;
+    case GL_FLOAT_VEC3 : case GL_INT_VEC3 : case GL_UNSIGNED_INT_VEC3 : case GL_BOOL_VEC3 : o_rows=3; break;
+    case GL_FLOAT_VEC4 : case GL_INT_VEC4 : case GL_UNSIGNED_INT_VEC4 : case GL_BOOL_VEC4 : o_rows=4; break;
+    case GL_FLOAT_MAT2 : o_columns=2; o_rows=2; break;
+    case GL_FLOAT_MAT2x3 : o_columns=2; o_rows=3; break;
+    case GL_FLOAT_MAT2x4 : o_columns=2; o_rows=4; break;
+    case GL_FLOAT_MAT3 : o_columns=3; o_rows=3; break;
+    case GL_FLOAT_MAT3x2 : o_columns=3; o_rows=2; break;
+    case GL_FLOAT_MAT3x4 : o_columns=3; o_rows=4; break;
+    case GL_FLOAT_MAT4 : o_columns=4; o_rows=4; break;
+    case GL_FLOAT_MAT4x2 : o_columns=4; o_rows=2; break;
+    case GL_FLOAT_MAT4x3 : o_columns=4; o_rows=3; break;
+    default : o_rows=0; return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool UniformBlockLayout::addMember(const std::string &_name, GLenum _type, GLint _arraySize) noexcept
+{
+  unsigned int columns,rows;
+  if(!typeSize(_type,columns,rows) || _arraySize<1)
+  {
+    std::cerr<<"Uniform block member "<<_name<<" is not a basic type\n";
+    return false;
+  }
+  // std140: scalars align to 4 bytes, vec2 to 8 and vec3 / vec4 to 16. Matrices are arrays of column vectors and
+  // the elements of any array are rounded up to 16 bytes
+  size_t elementSize=4*rows;
+  size_t alignment= rows==1 ? 4 : rows==2 ? 8 : 16;
+  size_t matrixStride=0;
+  if(columns>1)
+  {
+    matrixStride=16;
+    elementSize=16*columns;
+    alignment=16;
+  }
+  size_t arrayStride=0;
+  if(_arraySize>1)
+  {
+    arrayStride=roundUp(elementSize,16);
+    alignment=16;
+  }
+  Member m;
+  m.m_name=_name;
+  m.m_type=_type;
+  m.m_arraySize=_arraySize;
+  m.m_offset=roundUp(m_end,alignment);
+  m.m_arrayStride=arrayStride;
+  m.m_matrixStride=matrixStride;
+  m.m_rowMajor=false;
+  insert(m);
+  m_end=m.m_offset+(_arraySize>1 ? arrayStride*static_cast<size_t>(_arraySize) : elementSize);
+  m_alignment=std::max(m_alignment,alignment);
+  m_size=roundUp(m_end,16);
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void UniformBlockLayout::addStruct(const std::string &_name, const UniformBlockLayout &_struct, GLint _arraySize) noexcept
+{
+  // std140: a struct is aligned to 16 bytes and its size rounded up to 16, which is also the stride of an array
+  size_t structSize=roundUp(_struct.m_end,16);
+  size_t offset=roundUp(m_end,16);
+  for(GLint i=0; i<_arraySize; ++i)
+  {
+    std::string prefix= _arraySize>1 ? _name+"["+std::to_string(i)+"]." : _name+".";
+    for(auto member : _struct.m_members)
+    {
+      member.m_name=prefix+member.m_name;
+      member.m_offset+=offset+structSize*static_cast<size_t>(i);
+      insert(member);
+    }
+  }
+  m_end=offset+structSize*static_cast<size_t>(std::max(_arraySize,0));
+  m_alignment=16;
+  m_size=roundUp(m_end,16);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool UniformBlockLayout::loadFromProgram(GLuint _program, const std::string &_blockName) noexcept
+{
+  GLuint block=glGetUniformBlockIndex(_program,_blockName.c_str());
+  if(block==GL_INVALID_INDEX)
+  {
+    std::cerr<<"Uniform block "<<_blockName<<" not found in program "<<_program<<"\n";
+    return false;
+  }
+  GLint size=0;
+  GLint count=0;
+  glGetActiveUniformBlockiv(_program,block,GL_UNIFORM_BLOCK_DATA_SIZE,&size);
+  glGetActiveUniformBlockiv(_program,block,GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS,&count);
+  std::vector<GLint> indices(static_cast<size_t>(count));
+  if(count>0)
+  {
+    glGetActiveUniformBlockiv(_program,block,GL_UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES,&indices[0]);
+  }
+  std::vector<GLuint> uniforms(indices.begin(),indices.end());
+  const GLenum properties[]={GL_UNIFORM_TYPE,GL_UNIFORM_SIZE,GL_UNIFORM_OFFSET,GL_UNIFORM_ARRAY_STRIDE,
+                             GL_UNIFORM_MATRIX_STRIDE,GL_UNIFORM_IS_ROW_MAJOR};
+  std::vector<GLint> values[6];
+  for(size_t p=0; p<6; ++p)
+  {
+    values[p].resize(uniforms.size());
+    if(count>0)
+    {
+      glGetActiveUniformsiv(_program,count,&uniforms[0],properties[p],&values[p][0]);
+    }
+  }
+  clear();
+  for(size_t i=0; i<uniforms.size(); ++i)
+  {
+    char name[256];
+    GLsizei length=0;
+    glGetActiveUniformName(_program,uniforms[i],sizeof(name),&length,name);
+    Member m;
+    m.m_name.assign(name,static_cast<size_t>(length));
+    // arrays of basic types are reported as name[0]
+    if(m.m_name.size()>3 && m.m_name.compare(m.m_name.size()-3,3,"[0]")==0)
+    {
+      m.m_name.resize(m.m_name.size()-3);
+    }
+    m.m_type=static_cast<GLenum>(values[0][i]);
+    m.m_arraySize=values[1][i];
+    m.m_offset=static_cast<size_t>(values[2][i]);
+    m.m_arrayStride=static_cast<size_t>(values[3][i]);
+    m.m_matrixStride=static_cast<size_t>(values[4][i]);
+    m.m_rowMajor=values[5][i]!=0;
+    insert(m);
+  }
+  std::sort(m_members.begin(),m_members.end(),[](const Member &_a, const Member &_b){return _a.m_offset<_b.m_offset;});
+  for(size_t i=0; i<m_members.size(); ++i)
+  {
+    m_index[m_members[i].m_name]=i;
+  }
+  m_size=static_cast<size_t>(size);
+  m_end=m_size;
+  m_alignment=16;
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void UniformBlockLayout::insert(const Member &_member) noexcept
+{
+  m_index[_member.m_name]=m_members.size();
+  m_members.push_back(_member);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const UniformBlockLayout::Member * UniformBlockLayout::find(const std::string &_name) const noexcept
+{
+  auto member=m_index.find(_name);
+  return member!=m_index.end() ? &m_members[member->second] : nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void UniformBlockLayout::clear() noexcept
+{
+  m_members.clear();
+  m_index.clear();
+  m_size=0;
+  m_end=0;
+  m_alignment=4;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UniformBlock::UniformBlock(const UniformBlockLayout &_layout) noexcept : m_layout(&_layout), m_data(_layout.size(),0)
+{
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+const UniformBlockLayout::Member * UniformBlock::find(const std::string &_name, GLint &o_index) const noexcept
+{
+  o_index=0;
+  const UniformBlockLayout::Member *member=m_layout->find(_name);
+  // name[i] for an element of an array of basic types
+  size_t bracket=_name.rfind('[');
+  if(member==nullptr && bracket!=std::string::npos && _name.back()==']')
+  {
+    member=m_layout->find(_name.substr(0,bracket));
+    o_index=std::atoi(_name.c_str()+bracket+1);
+  }
+  if(member==nullptr)
+  {
+    std::cerr<<"Uniform block member \""<<_name<<"\" not found\n";
+  }
+  return member;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void UniformBlock::write(const UniformBlockLayout::Member &_member, GLint _index, const void *_values,
+                         unsigned int _columns, unsigned int _rows) noexcept
+{
+  unsigned int columns,rows;
+  UniformBlockLayout::typeSize(_member.m_type,columns,rows);
+  if(columns!=_columns || rows!=_rows || _index<0 || _index>=_member.m_arraySize)
+  {
+    std::cerr<<"Uniform block member \""<<_member.m_name<<"\" set with the wrong type or index "<<_index<<"\n";
+    return;
+  }
+  unsigned char *dest=&m_data[_member.m_offset+static_cast<size_t>(_index)*_member.m_arrayStride];
+  const unsigned char *src=static_cast<const unsigned char *>(_values);
+  if(_columns==1)
+  {
+    std::memcpy(dest,src,4*_rows);
+  }
+  else if(!_member.m_rowMajor)
+  {
+    for(unsigned int c=0; c<_columns; ++c)
+    {
+      std::memcpy(dest+c*_member.m_matrixStride,src+4*c*_rows,4*_rows);
+    }
+  }
+  else
+  {
+    for(unsigned int c=0; c<_columns; ++c)
+    {
+      for(unsigned int r=0; r<_rows; ++r)
+      {
+        std::memcpy(dest+r*_member.m_matrixStride+4*c,src+4*(c*_rows+r),4);
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void UniformBlock::set(const UniformBlockLayout::Member &_member, Real _v, GLint _index) noexcept
+{
+  write(_member,_index,&_v,1,1);
+}
+
+void UniformBlock::set(const UniformBlockLayout::Member &_member, GLint _v, GLint _index) noexcept
+{
+  write(_member,_index,&_v,1,1);
+}
+
+void UniformBlock::set(const UniformBlockLayout::Member &_member, const Vec2 &_v, GLint _index) noexcept
+{
+  write(_member,_index,&_v.m_openGL[0],1,2);
+}
+
+void UniformBlock::set(const UniformBlockLayout::Member &_member, const Vec3 &_v, GLint _index) noexcept
+{
+  write(_member,_index,&_v.m_openGL[0],1,3);
+}
+
+void UniformBlock::set(const UniformBlockLayout::Member &_member, const Vec4 &_v, GLint _index) noexcept
+{
+  write(_member,_index,&_v.m_openGL[0],1,4);
+}
+
+void UniformBlock::set(const UniformBlockLayout::Member &_member, const Colour &_v, GLint _index) noexcept
+{
+  write(_member,_index,&_v.m_openGL[0],1,4);
+}
+
+void UniformBlock::set(const UniformBlockLayout::Member &_member, const Mat3 &_v, GLint _index) noexcept
+{
+  write(_member,_index,&_v.m_openGL[0],3,3);
+}
+
+void UniformBlock::set(const UniformBlockLayout::Member &_member, const Mat4 &_v, GLint _index) noexcept
+{
+  write(_member,_index,&_v.m_openGL[0],4,4);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+bool UniformBlock::set(const std::string &_name, Real _v) noexcept
+{
+  GLint index;
+  const UniformBlockLayout::Member *member=find(_name,index);
+  if(member!=nullptr)
+  {
+    set(*member,_v,index);
+  }
+  return member!=nullptr;
+}
+
+bool UniformBlock::set(const std::string &_name, GLint _v) noexcept
+{
+  GLint index;
+  const UniformBlockLayout::Member *member=find(_name,index);
+  if(member!=nullptr)
+  {
+    set(*member,_v,index);
+  }
+  return member!=nullptr;
+}
+
+bool UniformBlock::set(const std::string &_name, const Vec2 &_v) noexcept
+{
+  GLint index;
+  const UniformBlockLayout::Member *member=find(_name,index);
+  if(member!=nullptr)
+  {
+    set(*member,_v,index);
+  }
+  return member!=nullptr;
+}
+
+bool UniformBlock::set(const std::string &_name, const Vec3 &_v) noexcept
+{
+  GLint index;
+  const UniformBlockLayout::Member *member=find(_name,index);
+  if(member!=nullptr)
+  {
+    set(*member,_v,index);
+  }
+  return member!=nullptr;
+}
+
+bool UniformBlock::set(const std::string &_name, const Vec4 &_v) noexcept
+{
+  GLint index;
+  const UniformBlockLayout::Member *member=find(_name,index);
+  if(member!=nullptr)
+  {
+    set(*member,_v,index);
+  }
+  return member!=nullptr;
+}
+
+bool UniformBlock::set(const std::string &_name, const Colour &_v) noexcept
+{
+  GLint index;
+  const UniformBlockLayout::Member *member=find(_name,index);
+  if(member!=nullptr)
+  {
+    set(*member,_v,index);
+  }
+  return member!=nullptr;
+}
+
+bool UniformBlock::set(const std::string &_name, const Mat3 &_v) noexcept
+{
+  GLint index;
+  const UniformBlockLayout::Member *member=find(_name,index);
+  if(member!=nullptr)
+  {
+    set(*member,_v,index);
+  }
+  return member!=nullptr;
+}
+
+bool UniformBlock::set(const std::string &_name, const Mat4 &_v) noexcept
+{
+  GLint index;
+  const UniformBlockLayout::Member *member=find(_name,index);
+  if(member!=nullptr)
+  {
+    set(*member,_v,index);
+  }
+  return member!=nullptr;
+}
+
+} // end namespace ngl
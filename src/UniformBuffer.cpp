@@ -0,0 +1,186 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "UniformBuffer.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+//----------------------------------------------------------------------------------------------------------------------
+/// @file UniformBuffer.cpp
+/// @brief implementation files for UniformRing and UniformBuffer classes
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+
+//----------------------------------------------------------------------------------------------------------------------
+UniformRing::UniformRing(size_t _capacity, size_t _alignment, unsigned int _framesInFlight) noexcept :
+  m_capacity(_capacity),
+  m_alignment(std::max<size_t>(_alignment,1)),
+  m_framesInFlight(std::max(_framesInFlight,1u))
+{
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+GLintptr UniformRing::allocate(size_t _bytes) noexcept
+{
+  if(_bytes>m_capacity)
+  {
+    return -1;
+  }
+  size_t start=(m_head+m_alignment-1)/m_alignment*m_alignment;
+  // the bytes taken from the head, the alignment padding or the end of the ring skipped when wrapping
+  size_t consumed;
+  if(start+_bytes<=m_capacity)
+  {
+    consumed=start+_bytes-m_head;
+  }
+  else
+  {
+    start=0;
+    consumed=m_capacity-m_head+_bytes;
+  }
+  // everything from the oldest frame kept up to the head is in use
+  if(m_used+consumed>m_capacity)
+  {
+    return -1;
+  }
+  m_used+=consumed;
+  m_frameUsed+=consumed;
+  m_head=start+_bytes;
+  return static_cast<GLintptr>(start);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void UniformRing::nextFrame() noexcept
+{
+  m_frames.push_back(m_frameUsed);
+  m_frameUsed=0;
+  while(m_frames.size()>=m_framesInFlight)
+  {
+    m_used-=m_frames.front();
+    m_frames.pop_front();
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void UniformRing::reset() noexcept
+{
+  m_head=0;
+  m_used=0;
+  m_frameUsed=0;
+  m_frames.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UniformBuffer::UniformBuffer(size_t _size, unsigned int _framesInFlight, size_t _alignment) noexcept :
+  m_ring(_size,offsetAlignment(_alignment),_framesInFlight),
+  m_data(_size)
+{
+  glGenBuffers(1,&m_id);
+  glBindBuffer(GL_UNIFORM_BUFFER,m_id);
+  glBufferData(GL_UNIFORM_BUFFER,static_cast<GLsizeiptr>(_size),nullptr,GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_UNIFORM_BUFFER,0);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+UniformBuffer::~UniformBuffer() noexcept
+{
+  glDeleteBuffers(1,&m_id);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+size_t UniformBuffer::offsetAlignment(size_t _alignment) noexcept
+{
+  if(_alignment==0)
+  {
+    GLint alignment=0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT,&alignment);
+    // 256 is the largest any driver asks for
+    _alignment= alignment>0 ? static_cast<size_t>(alignment) : 256;
+  }
+  return _alignment;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+GLintptr UniformBuffer::push(const UniformBlock &_block) noexcept
+{
+  return push(_block.data(),_block.size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+GLintptr UniformBuffer::push(const void *_data, size_t _bytes) noexcept
+{
+  GLintptr offset=m_ring.allocate(_bytes);
+  if(offset<0)
+  {
+    if(_bytes>m_ring.capacity())
+    {
+      std::cerr<<"UniformBuffer push of "<<_bytes<<" bytes is larger than the buffer\n";
+      return -1;
+    }
+    // the frames in flight fill the buffer so start again from the beginning, OpenGL keeps the ranges already
+    // drawn with correct but may have to wait for the GPU
+    ++m_stats.m_overflows;
+    flush();
+    m_ring.reset();
+    offset=m_ring.allocate(_bytes);
+  }
+  size_t start=static_cast<size_t>(offset);
+  // a wrap back to the start leaves the pending range behind so send it now
+  if(start<m_dirtyEnd)
+  {
+    flush();
+  }
+  if(m_dirtyBegin==m_dirtyEnd)
+  {
+    m_dirtyBegin=start;
+  }
+  m_dirtyEnd=start+_bytes;
+  std::memcpy(&m_data[start],_data,_bytes);
+  return offset;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void UniformBuffer::flush() noexcept
+{
+  if(m_dirtyEnd>m_dirtyBegin)
+  {
+    glBindBuffer(GL_UNIFORM_BUFFER,m_id);
+    glBufferSubData(GL_UNIFORM_BUFFER,static_cast<GLintptr>(m_dirtyBegin),
+                    static_cast<GLsizeiptr>(m_dirtyEnd-m_dirtyBegin),&m_data[m_dirtyBegin]);
+    ++m_stats.m_uploads;
+    m_stats.m_bytesUploaded+=m_dirtyEnd-m_dirtyBegin;
+  }
+  m_dirtyBegin=0;
+  m_dirtyEnd=0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void UniformBuffer::bindRange(GLuint _binding, GLintptr _offset, size_t _bytes) noexcept
+{
+  flush();
+  glBindBufferRange(GL_UNIFORM_BUFFER,_binding,m_id,_offset,static_cast<GLsizeiptr>(_bytes));
+  ++m_stats.m_binds;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void UniformBuffer::nextFrame() noexcept
+{
+  flush();
+  m_ring.nextFrame();
+}
+
+} // end namespace ngl
@@ -72,6 +72,38 @@ void VAOPrimitives::draw( const std::string &_name, GLenum _mode ) noexcept
 
 }
 
+void VAOPrimitives::drawInstanced( const std::string &_name, const std::vector<Mat4> &_transforms ) noexcept
+{
+  drawInstanced(_name,_transforms.empty() ? nullptr : &_transforms[0],_transforms.size());
+}
+
+void VAOPrimitives::drawInstanced( const std::string &_name, const Mat4 *_transforms, size_t _count ) noexcept
+{
+  // get an iterator to the VertexArrayObjects
+  auto vao=m_createdVAOs.find(_name);
+  // make sure we have a valid shader
+  if(vao!=m_createdVAOs.end())
+  {
+    if(_count==0)
+    {
+      return;
+    }
+    AbstractVAO *v=vao->second;
+    v->bind();
+    // the first time this VAO is drawn instanced the transform attributes are pointed at its instance buffer,
+    // after that only the data changes
+    bool created=v->numInstanceBuffers()!=0;
+    v->setInstanceData(0,AbstractVAO::VertexData(_count*sizeof(Mat4),_transforms[0].m_openGL[0],GL_STREAM_DRAW));
+    if(!created)
+    {
+      v->setInstanceMat4AttributePointer(0,instanceTransformAttribute);
+    }
+    v->drawInstanced(static_cast<GLsizei>(_count));
+    v->unbind();
+  }
+  else {std::cerr<<"Warning VAO not know in Primitive list "<<_name.c_str()<<"\n";}
+}
+
 void VAOPrimitives::createVAOFromHeader(const std::string &_name, const Real *_data,  unsigned int _size ) noexcept
 {
     AbstractVAO *vao = VAOFactory::createVAO("simpleVAO",GL_TRIANGLES);
@@ -0,0 +1,255 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "Vec3Array.h"
+#include "LaneKernels.h"
+#include "NGLassert.h"
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Vec3Array.cpp
+/// @brief implementation files for Vec3Array class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+
+static_assert(sizeof(Vec3)==3*sizeof(Real),"Vec3 arrays are accessed as packed components");
+
+//----------------------------------------------------------------------------------------------------------------------
+Vec3Array::Vec3Array(size_t _size) noexcept
+{
+  resize(_size);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Vec3Array::Vec3Array(const std::vector<Vec3> &_v) noexcept
+{
+  set(_v);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::set(const std::vector<Vec3> &_v) noexcept
+{
+  resize(_v.size());
+  const Real *in=reinterpret_cast<const Real *>(_v.data());
+  size_t i=0;
+#if defined(NGL_SIMD)
+  for(; i+4<=_v.size(); i+=4)
+  {
+    simd::float4 x,y,z;
+    simd::load3(in+i*3,x,y,z);
+    simd::store(&m_x[i],x);
+    simd::store(&m_y[i],y);
+    simd::store(&m_z[i],z);
+  }
+#endif
+  for(; i<_v.size(); ++i)
+  {
+    m_x[i]=in[i*3];
+    m_y[i]=in[i*3+1];
+    m_z[i]=in[i*3+2];
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::get(std::vector<Vec3> &o_v) const noexcept
+{
+  o_v.resize(size());
+  Real *out=reinterpret_cast<Real *>(o_v.data());
+  size_t i=0;
+#if defined(NGL_SIMD)
+  for(; i+4<=size(); i+=4)
+  {
+    simd::store3(out+i*3,simd::load(&m_x[i]),simd::load(&m_y[i]),simd::load(&m_z[i]));
+  }
+#endif
+  for(; i<size(); ++i)
+  {
+    out[i*3]=m_x[i];
+    out[i*3+1]=m_y[i];
+    out[i*3+2]=m_z[i];
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+std::vector<Vec3> Vec3Array::toVector() const noexcept
+{
+  std::vector<Vec3> v;
+  get(v);
+  return v;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Vec3 Vec3Array::operator[](size_t _i) const noexcept
+{
+  NGL_ASSERT(_i<size());
+  return Vec3(m_x[_i],m_y[_i],m_z[_i]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::set(size_t _i, const Vec3 &_v) noexcept
+{
+  NGL_ASSERT(_i<size());
+  m_x[_i]=_v.m_x;
+  m_y[_i]=_v.m_y;
+  m_z[_i]=_v.m_z;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::push_back(const Vec3 &_v) noexcept
+{
+  m_x.push_back(_v.m_x);
+  m_y.push_back(_v.m_y);
+  m_z.push_back(_v.m_z);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::resize(size_t _size) noexcept
+{
+  m_x.resize(_size);
+  m_y.resize(_size);
+  m_z.resize(_size);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::reserve(size_t _size) noexcept
+{
+  m_x.reserve(_size);
+  m_y.reserve(_size);
+  m_z.reserve(_size);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::clear() noexcept
+{
+  m_x.clear();
+  m_y.clear();
+  m_z.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::operator+=(const Vec3Array &_v) noexcept
+{
+  NGL_ASSERT(_v.size()==size());
+  lanes::add(m_x.data(),_v.m_x.data(),m_x.data(),size());
+  lanes::add(m_y.data(),_v.m_y.data(),m_y.data(),size());
+  lanes::add(m_z.data(),_v.m_z.data(),m_z.data(),size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::operator-=(const Vec3Array &_v) noexcept
+{
+  NGL_ASSERT(_v.size()==size());
+  lanes::sub(m_x.data(),_v.m_x.data(),m_x.data(),size());
+  lanes::sub(m_y.data(),_v.m_y.data(),m_y.data(),size());
+  lanes::sub(m_z.data(),_v.m_z.data(),m_z.data(),size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::operator*=(const Vec3Array &_v) noexcept
+{
+  NGL_ASSERT(_v.size()==size());
+  lanes::mul(m_x.data(),_v.m_x.data(),m_x.data(),size());
+  lanes::mul(m_y.data(),_v.m_y.data(),m_y.data(),size());
+  lanes::mul(m_z.data(),_v.m_z.data(),m_z.data(),size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::operator*=(Real _s) noexcept
+{
+  lanes::scale(m_x.data(),_s,m_x.data(),size());
+  lanes::scale(m_y.data(),_s,m_y.data(),size());
+  lanes::scale(m_z.data(),_s,m_z.data(),size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::madd(const Vec3Array &_a, Real _s) noexcept
+{
+  NGL_ASSERT(_a.size()==size());
+  lanes::madd(_a.m_x.data(),_s,m_x.data(),m_x.data(),size());
+  lanes::madd(_a.m_y.data(),_s,m_y.data(),m_y.data(),size());
+  lanes::madd(_a.m_z.data(),_s,m_z.data(),m_z.data(),size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::madd(const Vec3Array &_a, const Vec3Array &_b) noexcept
+{
+  NGL_ASSERT(_a.size()==size() && _b.size()==size());
+  lanes::madd(_a.m_x.data(),_b.m_x.data(),m_x.data(),m_x.data(),size());
+  lanes::madd(_a.m_y.data(),_b.m_y.data(),m_y.data(),m_y.data(),size());
+  lanes::madd(_a.m_z.data(),_b.m_z.data(),m_z.data(),m_z.data(),size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::lerp(const Vec3Array &_a, const Vec3Array &_b, Real _t) noexcept
+{
+  NGL_ASSERT(_a.size()==_b.size());
+  resize(_a.size());
+  lanes::lerp(_a.m_x.data(),_b.m_x.data(),_t,m_x.data(),size());
+  lanes::lerp(_a.m_y.data(),_b.m_y.data(),_t,m_y.data(),size());
+  lanes::lerp(_a.m_z.data(),_b.m_z.data(),_t,m_z.data(),size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::cross(const Vec3Array &_v1, const Vec3Array &_v2) noexcept
+{
+  NGL_ASSERT(_v1.size()==_v2.size());
+  resize(_v1.size());
+  const Real *a[3]={_v1.m_x.data(),_v1.m_y.data(),_v1.m_z.data()};
+  const Real *b[3]={_v2.m_x.data(),_v2.m_y.data(),_v2.m_z.data()};
+  Real *res[3]={m_x.data(),m_y.data(),m_z.data()};
+  lanes::cross(a,b,res,size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::dot(const Vec3Array &_v, std::vector<Real> &o_res) const noexcept
+{
+  NGL_ASSERT(_v.size()==size());
+  o_res.resize(size());
+  const Real *a[3]={m_x.data(),m_y.data(),m_z.data()};
+  const Real *b[3]={_v.m_x.data(),_v.m_y.data(),_v.m_z.data()};
+  lanes::dot<3>(a,b,o_res.data(),size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::length(std::vector<Real> &o_res) const noexcept
+{
+  o_res.resize(size());
+  const Real *a[3]={m_x.data(),m_y.data(),m_z.data()};
+  lanes::length<3>(a,o_res.data(),size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::normalize() noexcept
+{
+  Real *a[3]={m_x.data(),m_y.data(),m_z.data()};
+  lanes::normalize<3>(a,size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec3Array::minMax(Vec3 &o_min, Vec3 &o_max) const noexcept
+{
+  o_min.null();
+  o_max.null();
+  if(empty())
+  {
+    return;
+  }
+  lanes::minMax(m_x.data(),size(),o_min.m_x,o_max.m_x);
+  lanes::minMax(m_y.data(),size(),o_min.m_y,o_max.m_y);
+  lanes::minMax(m_z.data(),size(),o_min.m_z,o_max.m_z);
+}
+
+} // end namespace ngl
+//----------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,283 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "Vec4Array.h"
+#include "LaneKernels.h"
+#include "NGLassert.h"
+//----------------------------------------------------------------------------------------------------------------------
+/// @file Vec4Array.cpp
+/// @brief implementation files for Vec4Array class
+//----------------------------------------------------------------------------------------------------------------------
+namespace ngl
+{
+
+static_assert(sizeof(Vec4)==4*sizeof(Real),"Vec4 arrays are accessed as packed components");
+
+//----------------------------------------------------------------------------------------------------------------------
+Vec4Array::Vec4Array(size_t _size) noexcept
+{
+  resize(_size);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Vec4Array::Vec4Array(const std::vector<Vec4> &_v) noexcept
+{
+  set(_v);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::set(const std::vector<Vec4> &_v) noexcept
+{
+  resize(_v.size());
+  const Real *in=reinterpret_cast<const Real *>(_v.data());
+  size_t i=0;
+#if defined(NGL_SIMD)
+  // four elements are a 4x4 block so a transpose gives the components
+  for(; i+4<=_v.size(); i+=4)
+  {
+    simd::float4 x=simd::load(in+i*4);
+    simd::float4 y=simd::load(in+i*4+4);
+    simd::float4 z=simd::load(in+i*4+8);
+    simd::float4 w=simd::load(in+i*4+12);
+    simd::transpose(x,y,z,w);
+    simd::store(&m_x[i],x);
+    simd::store(&m_y[i],y);
+    simd::store(&m_z[i],z);
+    simd::store(&m_w[i],w);
+  }
+#endif
+  for(; i<_v.size(); ++i)
+  {
+    m_x[i]=in[i*4];
+    m_y[i]=in[i*4+1];
+    m_z[i]=in[i*4+2];
+    m_w[i]=in[i*4+3];
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::get(std::vector<Vec4> &o_v) const noexcept
+{
+  o_v.resize(size());
+  Real *out=reinterpret_cast<Real *>(o_v.data());
+  size_t i=0;
+#if defined(NGL_SIMD)
+  for(; i+4<=size(); i+=4)
+  {
+    simd::float4 v0=simd::load(&m_x[i]);
+    simd::float4 v1=simd::load(&m_y[i]);
+    simd::float4 v2=simd::load(&m_z[i]);
+    simd::float4 v3=simd::load(&m_w[i]);
+    simd::transpose(v0,v1,v2,v3);
+    simd::store(out+i*4,v0);
+    simd::store(out+i*4+4,v1);
+    simd::store(out+i*4+8,v2);
+    simd::store(out+i*4+12,v3);
+  }
+#endif
+  for(; i<size(); ++i)
+  {
+    out[i*4]=m_x[i];
+    out[i*4+1]=m_y[i];
+    out[i*4+2]=m_z[i];
+    out[i*4+3]=m_w[i];
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+std::vector<Vec4> Vec4Array::toVector() const noexcept
+{
+  std::vector<Vec4> v;
+  get(v);
+  return v;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+Vec4 Vec4Array::operator[](size_t _i) const noexcept
+{
+  NGL_ASSERT(_i<size());
+  return Vec4(m_x[_i],m_y[_i],m_z[_i],m_w[_i]);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::set(size_t _i, const Vec4 &_v) noexcept
+{
+  NGL_ASSERT(_i<size());
+  m_x[_i]=_v.m_x;
+  m_y[_i]=_v.m_y;
+  m_z[_i]=_v.m_z;
+  m_w[_i]=_v.m_w;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::push_back(const Vec4 &_v) noexcept
+{
+  m_x.push_back(_v.m_x);
+  m_y.push_back(_v.m_y);
+  m_z.push_back(_v.m_z);
+  m_w.push_back(_v.m_w);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::resize(size_t _size) noexcept
+{
+  m_x.resize(_size);
+  m_y.resize(_size);
+  m_z.resize(_size);
+  m_w.resize(_size);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::reserve(size_t _size) noexcept
+{
+  m_x.reserve(_size);
+  m_y.reserve(_size);
+  m_z.reserve(_size);
+  m_w.reserve(_size);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::clear() noexcept
+{
+  m_x.clear();
+  m_y.clear();
+  m_z.clear();
+  m_w.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::operator+=(const Vec4Array &_v) noexcept
+{
+  NGL_ASSERT(_v.size()==size());
+  lanes::add(m_x.data(),_v.m_x.data(),m_x.data(),size());
+  lanes::add(m_y.data(),_v.m_y.data(),m_y.data(),size());
+  lanes::add(m_z.data(),_v.m_z.data(),m_z.data(),size());
+  lanes::add(m_w.data(),_v.m_w.data(),m_w.data(),size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::operator-=(const Vec4Array &_v) noexcept
+{
+  NGL_ASSERT(_v.size()==size());
+  lanes::sub(m_x.data(),_v.m_x.data(),m_x.data(),size());
+  lanes::sub(m_y.data(),_v.m_y.data(),m_y.data(),size());
+  lanes::sub(m_z.data(),_v.m_z.data(),m_z.data(),size());
+  lanes::sub(m_w.data(),_v.m_w.data(),m_w.data(),size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::operator*=(const Vec4Array &_v) noexcept
+{
+  NGL_ASSERT(_v.size()==size());
+  lanes::mul(m_x.data(),_v.m_x.data(),m_x.data(),size());
+  lanes::mul(m_y.data(),_v.m_y.data(),m_y.data(),size());
+  lanes::mul(m_z.data(),_v.m_z.data(),m_z.data(),size());
+  lanes::mul(m_w.data(),_v.m_w.data(),m_w.data(),size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::operator*=(Real _s) noexcept
+{
+  lanes::scale(m_x.data(),_s,m_x.data(),size());
+  lanes::scale(m_y.data(),_s,m_y.data(),size());
+  lanes::scale(m_z.data(),_s,m_z.data(),size());
+  lanes::scale(m_w.data(),_s,m_w.data(),size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::madd(const Vec4Array &_a, Real _s) noexcept
+{
+  NGL_ASSERT(_a.size()==size());
+  lanes::madd(_a.m_x.data(),_s,m_x.data(),m_x.data(),size());
+  lanes::madd(_a.m_y.data(),_s,m_y.data(),m_y.data(),size());
+  lanes::madd(_a.m_z.data(),_s,m_z.data(),m_z.data(),size());
+  lanes::madd(_a.m_w.data(),_s,m_w.data(),m_w.data(),size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::madd(const Vec4Array &_a, const Vec4Array &_b) noexcept
+{
+  NGL_ASSERT(_a.size()==size() && _b.size()==size());
+  lanes::madd(_a.m_x.data(),_b.m_x.data(),m_x.data(),m_x.data(),size());
+  lanes::madd(_a.m_y.data(),_b.m_y.data(),m_y.data(),m_y.data(),size());
+  lanes::madd(_a.m_z.data(),_b.m_z.data(),m_z.data(),m_z.data(),size());
+  lanes::madd(_a.m_w.data(),_b.m_w.data(),m_w.data(),m_w.data(),size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::lerp(const Vec4Array &_a, const Vec4Array &_b, Real _t) noexcept
+{
+  NGL_ASSERT(_a.size()==_b.size());
+  resize(_a.size());
+  lanes::lerp(_a.m_x.data(),_b.m_x.data(),_t,m_x.data(),size());
+  lanes::lerp(_a.m_y.data(),_b.m_y.data(),_t,m_y.data(),size());
+  lanes::lerp(_a.m_z.data(),_b.m_z.data(),_t,m_z.data(),size());
+  lanes::lerp(_a.m_w.data(),_b.m_w.data(),_t,m_w.data(),size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::cross(const Vec4Array &_v1, const Vec4Array &_v2) noexcept
+{
+  NGL_ASSERT(_v1.size()==_v2.size());
+  resize(_v1.size());
+  const Real *a[3]={_v1.m_x.data(),_v1.m_y.data(),_v1.m_z.data()};
+  const Real *b[3]={_v2.m_x.data(),_v2.m_y.data(),_v2.m_z.data()};
+  Real *res[3]={m_x.data(),m_y.data(),m_z.data()};
+  lanes::cross(a,b,res,size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::dot(const Vec4Array &_v, std::vector<Real> &o_res) const noexcept
+{
+  NGL_ASSERT(_v.size()==size());
+  o_res.resize(size());
+  const Real *a[3]={m_x.data(),m_y.data(),m_z.data()};
+  const Real *b[3]={_v.m_x.data(),_v.m_y.data(),_v.m_z.data()};
+  lanes::dot<3>(a,b,o_res.data(),size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::length(std::vector<Real> &o_res) const noexcept
+{
+  o_res.resize(size());
+  const Real *a[3]={m_x.data(),m_y.data(),m_z.data()};
+  lanes::length<3>(a,o_res.data(),size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::normalize() noexcept
+{
+  Real *a[3]={m_x.data(),m_y.data(),m_z.data()};
+  lanes::normalize<3>(a,size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+void Vec4Array::minMax(Vec4 &o_min, Vec4 &o_max) const noexcept
+{
+  o_min.null();
+  o_max.null();
+  if(empty())
+  {
+    return;
+  }
+  lanes::minMax(m_x.data(),size(),o_min.m_x,o_max.m_x);
+  lanes::minMax(m_y.data(),size(),o_min.m_y,o_max.m_y);
+  lanes::minMax(m_z.data(),size(),o_min.m_z,o_max.m_z);
+  lanes::minMax(m_w.data(),size(),o_min.m_w,o_max.m_w);
+}
+
+} // end namespace ngl
+//----------------------------------------------------------------------------------------------------------------------
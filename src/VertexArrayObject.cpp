@@ -15,6 +15,7 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "VertexArrayObject.h"
+#include "GLStateCache.h"
 #include <iostream>
 //----------------------------------------------------------------------------------------------------------------------
 /// @file VertexArrayObject.cpp
@@ -40,13 +41,13 @@ VertexArrayObject::VertexArrayObject(GLenum _mode)
 //----------------------------------------------------------------------------------------------------------------------
 void VertexArrayObject::bind()
 {
-  glBindVertexArray(m_id);
+  GLStateCache::instance()->bindVertexArray(m_id);
   m_bound=true;
 }
 //----------------------------------------------------------------------------------------------------------------------
 void VertexArrayObject::unbind()
 {
-  glBindVertexArray(0);
+  GLStateCache::instance()->unbindVertexArray();
   m_bound=false;
 }
 //----------------------------------------------------------------------------------------------------------------------
@@ -63,6 +64,7 @@ void VertexArrayObject::removeVOA()
       glDeleteBuffers(1,&b);
     }
     glDeleteVertexArrays(1,&m_id);
+    GLStateCache::instance()->vertexArrayDeleted(m_id);
     m_allocated=false;
   }
 }
@@ -0,0 +1,288 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef LANEKERNELS_H_
+#define LANEKERNELS_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file LaneKernels.h
+/// @brief loops over single component arrays (lanes) shared by Vec3Array and Vec4Array, four elements
+/// at a time with SIMD when available then the remainder one at a time. Outputs may be the same array
+/// as an input.
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include "SIMD.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace ngl
+{
+namespace lanes
+{
+  /// @brief o_res=_a+_b
+  inline void add(const Real *_a, const Real *_b, Real *o_res, size_t _n) noexcept
+  {
+    size_t i=0;
+#if defined(NGL_SIMD)
+    for(; i+4<=_n; i+=4)
+    {
+      simd::store(o_res+i,simd::add(simd::load(_a+i),simd::load(_b+i)));
+    }
+#endif
+    for(; i<_n; ++i)
+    {
+      o_res[i]=_a[i]+_b[i];
+    }
+  }
+  /// @brief o_res=_a-_b
+  inline void sub(const Real *_a, const Real *_b, Real *o_res, size_t _n) noexcept
+  {
+    size_t i=0;
+#if defined(NGL_SIMD)
+    for(; i+4<=_n; i+=4)
+    {
+      simd::store(o_res+i,simd::sub(simd::load(_a+i),simd::load(_b+i)));
+    }
+#endif
+    for(; i<_n; ++i)
+    {
+      o_res[i]=_a[i]-_b[i];
+    }
+  }
+  /// @brief o_res=_a*_b
+  inline void mul(const Real *_a, const Real *_b, Real *o_res, size_t _n) noexcept
+  {
+    size_t i=0;
+#if defined(NGL_SIMD)
+    for(; i+4<=_n; i+=4)
+    {
+      simd::store(o_res+i,simd::mul(simd::load(_a+i),simd::load(_b+i)));
+    }
+#endif
+    for(; i<_n; ++i)
+    {
+      o_res[i]=_a[i]*_b[i];
+    }
+  }
+  /// @brief o_res=_a*_s
+  inline void scale(const Real *_a, Real _s, Real *o_res, size_t _n) noexcept
+  {
+    size_t i=0;
+#if defined(NGL_SIMD)
+    simd::float4 s=simd::splat(_s);
+    for(; i+4<=_n; i+=4)
+    {
+      simd::store(o_res+i,simd::mul(simd::load(_a+i),s));
+    }
+#endif
+    for(; i<_n; ++i)
+    {
+      o_res[i]=_a[i]*_s;
+    }
+  }
+  /// @brief o_res=_a*_b+_c
+  inline void madd(const Real *_a, const Real *_b, const Real *_c, Real *o_res, size_t _n) noexcept
+  {
+    size_t i=0;
+#if defined(NGL_SIMD)
+    for(; i+4<=_n; i+=4)
+    {
+      simd::store(o_res+i,simd::madd(simd::load(_a+i),simd::load(_b+i),simd::load(_c+i)));
+    }
+#endif
+    for(; i<_n; ++i)
+    {
+      o_res[i]=_a[i]*_b[i]+_c[i];
+    }
+  }
+  /// @brief o_res=_a*_s+_c
+  inline void madd(const Real *_a, Real _s, const Real *_c, Real *o_res, size_t _n) noexcept
+  {
+    size_t i=0;
+#if defined(NGL_SIMD)
+    simd::float4 s=simd::splat(_s);
+    for(; i+4<=_n; i+=4)
+    {
+      simd::store(o_res+i,simd::madd(simd::load(_a+i),s,simd::load(_c+i)));
+    }
+#endif
+    for(; i<_n; ++i)
+    {
+      o_res[i]=_a[i]*_s+_c[i];
+    }
+  }
+  /// @brief o_res=_a+(_b-_a)*_t
+  inline void lerp(const Real *_a, const Real *_b, Real _t, Real *o_res, size_t _n) noexcept
+  {
+    size_t i=0;
+#if defined(NGL_SIMD)
+    simd::float4 t=simd::splat(_t);
+    for(; i+4<=_n; i+=4)
+    {
+      simd::float4 a=simd::load(_a+i);
+      simd::store(o_res+i,simd::madd(simd::sub(simd::load(_b+i),a),t,a));
+    }
+#endif
+    for(; i<_n; ++i)
+    {
+      o_res[i]=_a[i]+(_b[i]-_a[i])*_t;
+    }
+  }
+  /// @brief the smallest and largest values in the lane, _n must be > 0
+  inline void minMax(const Real *_a, size_t _n, Real &o_min, Real &o_max) noexcept
+  {
+    Real lo=_a[0];
+    Real hi=_a[0];
+    size_t i=0;
+#if defined(NGL_SIMD)
+    if(_n>=4)
+    {
+      simd::float4 vlo=simd::load(_a);
+      simd::float4 vhi=vlo;
+      for(i=4; i+4<=_n; i+=4)
+      {
+        simd::float4 v=simd::load(_a+i);
+        vlo=simd::min(vlo,v);
+        vhi=simd::max(vhi,v);
+      }
+      Real l[4],h[4];
+      simd::store(l,vlo);
+      simd::store(h,vhi);
+      lo=std::min(std::min(l[0],l[1]),std::min(l[2],l[3]));
+      hi=std::max(std::max(h[0],h[1]),std::max(h[2],h[3]));
+    }
+#endif
+    for(; i<_n; ++i)
+    {
+      lo=std::min(lo,_a[i]);
+      hi=std::max(hi,_a[i]);
+    }
+    o_min=lo;
+    o_max=hi;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief o_res[i] = sum over the lanes of _a[l][i]*_b[l][i]
+  //----------------------------------------------------------------------------------------------------------------------
+  template <int Lanes>
+  inline void dot(const Real *const *_a, const Real *const *_b, Real *o_res, size_t _n) noexcept
+  {
+    size_t i=0;
+#if defined(NGL_SIMD)
+    for(; i+4<=_n; i+=4)
+    {
+      simd::float4 sum=simd::mul(simd::load(_a[0]+i),simd::load(_b[0]+i));
+      for(int l=1; l<Lanes; ++l)
+      {
+        sum=simd::madd(simd::load(_a[l]+i),simd::load(_b[l]+i),sum);
+      }
+      simd::store(o_res+i,sum);
+    }
+#endif
+    for(; i<_n; ++i)
+    {
+      Real sum=_a[0][i]*_b[0][i];
+      for(int l=1; l<Lanes; ++l)
+      {
+        sum+=_a[l][i]*_b[l][i];
+      }
+      o_res[i]=sum;
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief o_res[i] = the length of element i
+  //----------------------------------------------------------------------------------------------------------------------
+  template <int Lanes>
+  inline void length(const Real *const *_a, Real *o_res, size_t _n) noexcept
+  {
+    dot<Lanes>(_a,_a,o_res,_n);
+    for(size_t i=0; i<_n; ++i)
+    {
+      o_res[i]=std::sqrt(o_res[i]);
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief normalize each element, zero length elements are left as zero
+  //----------------------------------------------------------------------------------------------------------------------
+  template <int Lanes>
+  inline void normalize(Real *const *io_a, size_t _n) noexcept
+  {
+    size_t i=0;
+#if defined(NGL_SIMD)
+    for(; i+4<=_n; i+=4)
+    {
+      simd::float4 v[Lanes];
+      v[0]=simd::load(io_a[0]+i);
+      simd::float4 len=simd::mul(v[0],v[0]);
+      for(int l=1; l<Lanes; ++l)
+      {
+        v[l]=simd::load(io_a[l]+i);
+        len=simd::madd(v[l],v[l],len);
+      }
+      simd::float4 inv=simd::safeInvSqrt(len);
+      for(int l=0; l<Lanes; ++l)
+      {
+        simd::store(io_a[l]+i,simd::mul(v[l],inv));
+      }
+    }
+#endif
+    for(; i<_n; ++i)
+    {
+      Real len=0.0f;
+      for(int l=0; l<Lanes; ++l)
+      {
+        len+=io_a[l][i]*io_a[l][i];
+      }
+      Real inv= len>0.0f ? 1.0f/std::sqrt(len) : 0.0f;
+      for(int l=0; l<Lanes; ++l)
+      {
+        io_a[l][i]*=inv;
+      }
+    }
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief o_res = _a x _b using the x,y,z lanes of each
+  //----------------------------------------------------------------------------------------------------------------------
+  inline void cross(const Real *const *_a, const Real *const *_b, Real *const *o_res, size_t _n) noexcept
+  {
+    size_t i=0;
+#if defined(NGL_SIMD)
+    for(; i+4<=_n; i+=4)
+    {
+      simd::float4 ax=simd::load(_a[0]+i);
+      simd::float4 ay=simd::load(_a[1]+i);
+      simd::float4 az=simd::load(_a[2]+i);
+      simd::float4 bx=simd::load(_b[0]+i);
+      simd::float4 by=simd::load(_b[1]+i);
+      simd::float4 bz=simd::load(_b[2]+i);
+      simd::store(o_res[0]+i,simd::sub(simd::mul(ay,bz),simd::mul(az,by)));
+      simd::store(o_res[1]+i,simd::sub(simd::mul(az,bx),simd::mul(ax,bz)));
+      simd::store(o_res[2]+i,simd::sub(simd::mul(ax,by),simd::mul(ay,bx)));
+    }
+#endif
+    for(; i<_n; ++i)
+    {
+      Real ax=_a[0][i], ay=_a[1][i], az=_a[2][i];
+      Real bx=_b[0][i], by=_b[1][i], bz=_b[2][i];
+      o_res[0][i]=ay*bz-az*by;
+      o_res[1][i]=az*bx-ax*bz;
+      o_res[2][i]=ax*by-ay*bx;
+    }
+  }
+
+} // end namespace lanes
+} // end namespace ngl
+
+#endif
@@ -0,0 +1,61 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef PARALLELFOR_H_
+#define PARALLELFOR_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file ParallelFor.h
+/// @brief helpers to split a range of work into chunks run on separate std::threads
+//----------------------------------------------------------------------------------------------------------------------
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace ngl
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief the number of chunks to split _n items into, at most _numThreads (0 for all cores) and
+  /// no fewer than _minPerChunk items in each
+  //----------------------------------------------------------------------------------------------------------------------
+  inline size_t chunkCount(size_t _n, size_t _minPerChunk, unsigned int _numThreads) noexcept
+  {
+    if(_numThreads==0)
+    {
+      _numThreads=std::max(1u,std::thread::hardware_concurrency());
+    }
+    return std::max<size_t>(1,std::min<size_t>(_numThreads,_n/_minPerChunk));
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief run _func(chunk) for each chunk, the calling thread does the first and the others get a thread each
+  //----------------------------------------------------------------------------------------------------------------------
+  template <class Func>
+  void forEachChunk(size_t _numChunks, Func _func)
+  {
+    std::vector<std::thread> threads;
+    for(size_t i=1; i<_numChunks; ++i)
+    {
+      threads.push_back(std::thread(_func,i));
+    }
+    _func(0);
+    for(auto &t : threads)
+    {
+      t.join();
+    }
+  }
+} // end namespace ngl
+
+#endif
@@ -0,0 +1,186 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SIMD_H_
+#define SIMD_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file SIMD.h
+/// @brief thin wrappers over the 4 wide float instructions used by the maths classes. The instruction set
+/// is chosen at compile time, SSE2 on x86 (always there on x86_64) or NEON on 64 bit ARM, if neither is available
+/// (or NGL_NO_SIMD is defined) NGL_SIMD is not defined and the classes use their scalar code.
+/// Loads and stores are unaligned as the maths classes are packed.
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include <type_traits>
+
+#if !defined(NGL_NO_SIMD)
+  #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define NGL_SIMD_SSE
+    #define NGL_SIMD
+    #include <emmintrin.h>
+  #elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && (defined(__aarch64__) || defined(_M_ARM64))
+    #define NGL_SIMD_NEON
+    #define NGL_SIMD
+    #include <arm_neon.h>
+  #endif
+#endif
+
+#if defined(NGL_SIMD)
+namespace ngl
+{
+namespace simd
+{
+  static_assert(std::is_same<Real,float>::value,"the SIMD code paths need Real to be float");
+
+#if defined(NGL_SIMD_SSE)
+  typedef __m128 float4;
+
+  inline float4 load(const float *_p) noexcept { return _mm_loadu_ps(_p); }
+  inline void store(float *_p, float4 _v) noexcept { _mm_storeu_ps(_p,_v); }
+  inline float4 splat(float _f) noexcept { return _mm_set1_ps(_f); }
+  inline float4 add(float4 _a, float4 _b) noexcept { return _mm_add_ps(_a,_b); }
+  inline float4 sub(float4 _a, float4 _b) noexcept { return _mm_sub_ps(_a,_b); }
+  inline float4 mul(float4 _a, float4 _b) noexcept { return _mm_mul_ps(_a,_b); }
+  inline float4 min(float4 _a, float4 _b) noexcept { return _mm_min_ps(_a,_b); }
+  inline float4 max(float4 _a, float4 _b) noexcept { return _mm_max_ps(_a,_b); }
+  /// @brief bit i of the result is set where _a[i] < _b[i]
+  inline int lessMask(float4 _a, float4 _b) noexcept { return _mm_movemask_ps(_mm_cmplt_ps(_a,_b)); }
+  /// @brief |_v|
+  inline float4 abs(float4 _v) noexcept { return _mm_andnot_ps(_mm_set1_ps(-0.0f),_v); }
+  /// @brief _v negated where _sign is negative
+  inline float4 flipSign(float4 _v, float4 _sign) noexcept { return _mm_xor_ps(_v,_mm_and_ps(_sign,_mm_set1_ps(-0.0f))); }
+  /// @brief _a*_b+_c
+  inline float4 madd(float4 _a, float4 _b, float4 _c) noexcept { return _mm_add_ps(_mm_mul_ps(_a,_b),_c); }
+  /// @brief broadcast element N of _v to all four elements
+  template<int N> inline float4 lane(float4 _v) noexcept { return _mm_shuffle_ps(_v,_v,_MM_SHUFFLE(N,N,N,N)); }
+  /// @brief transpose the 4x4 matrix held in four rows
+  inline void transpose(float4 &io_r0, float4 &io_r1, float4 &io_r2, float4 &io_r3) noexcept
+  {
+    _MM_TRANSPOSE4_PS(io_r0,io_r1,io_r2,io_r3);
+  }
+  /// @brief 1/sqrt(_v) or 0 where _v is 0 (so zero length vectors stay zero when normalised)
+  inline float4 safeInvSqrt(float4 _v) noexcept
+  {
+    __m128 mask=_mm_cmpgt_ps(_v,_mm_setzero_ps());
+    return _mm_and_ps(mask,_mm_div_ps(_mm_set1_ps(1.0f),_mm_sqrt_ps(_v)));
+  }
+  /// @brief load four packed x,y,z triples (12 floats) into one register per component
+  inline void load3(const float *_p, float4 &o_x, float4 &o_y, float4 &o_z) noexcept
+  {
+    // a=(x0 y0 z0 x1) b=(y1 z1 x2 y2) c=(z2 x3 y3 z3)
+    __m128 a=_mm_loadu_ps(_p);
+    __m128 b=_mm_loadu_ps(_p+4);
+    __m128 c=_mm_loadu_ps(_p+8);
+    __m128 b23c12=_mm_shuffle_ps(b,c,_MM_SHUFFLE(2,1,3,2));
+    __m128 a12b01=_mm_shuffle_ps(a,b,_MM_SHUFFLE(1,0,2,1));
+    o_x=_mm_shuffle_ps(a,b23c12,_MM_SHUFFLE(2,0,3,0));
+    o_y=_mm_shuffle_ps(a12b01,b23c12,_MM_SHUFFLE(3,1,2,0));
+    o_z=_mm_shuffle_ps(a12b01,c,_MM_SHUFFLE(3,0,3,1));
+  }
+  /// @brief store one register per component as four packed x,y,z triples
+  inline void store3(float *_p, float4 _x, float4 _y, float4 _z) noexcept
+  {
+    __m128 xy01=_mm_unpacklo_ps(_x,_y);
+    __m128 xy23=_mm_unpackhi_ps(_x,_y);
+    __m128 z0x1=_mm_shuffle_ps(_z,xy01,_MM_SHUFFLE(2,2,0,0));
+    __m128 y1z1=_mm_shuffle_ps(xy01,_z,_MM_SHUFFLE(1,1,3,3));
+    __m128 z2x3=_mm_shuffle_ps(_z,xy23,_MM_SHUFFLE(2,2,2,2));
+    __m128 y3z3=_mm_shuffle_ps(xy23,_z,_MM_SHUFFLE(3,3,3,3));
+    _mm_storeu_ps(_p,_mm_shuffle_ps(xy01,z0x1,_MM_SHUFFLE(2,0,1,0)));
+    _mm_storeu_ps(_p+4,_mm_shuffle_ps(y1z1,xy23,_MM_SHUFFLE(1,0,2,0)));
+    _mm_storeu_ps(_p+8,_mm_shuffle_ps(z2x3,y3z3,_MM_SHUFFLE(2,0,2,0)));
+  }
+#elif defined(NGL_SIMD_NEON)
+  typedef float32x4_t float4;
+
+  inline float4 load(const float *_p) noexcept { return vld1q_f32(_p); }
+  inline void store(float *_p, float4 _v) noexcept { vst1q_f32(_p,_v); }
+  inline float4 splat(float _f) noexcept { return vdupq_n_f32(_f); }
+  inline float4 add(float4 _a, float4 _b) noexcept { return vaddq_f32(_a,_b); }
+  inline float4 sub(float4 _a, float4 _b) noexcept { return vsubq_f32(_a,_b); }
+  inline float4 mul(float4 _a, float4 _b) noexcept { return vmulq_f32(_a,_b); }
+  inline float4 min(float4 _a, float4 _b) noexcept { return vminq_f32(_a,_b); }
+  inline float4 max(float4 _a, float4 _b) noexcept { return vmaxq_f32(_a,_b); }
+  /// @brief bit i of the result is set where _a[i] < _b[i]
+  inline int lessMask(float4 _a, float4 _b) noexcept
+  {
+    static const uint32_t bits[4]={1,2,4,8};
+    return static_cast<int>(vaddvq_u32(vandq_u32(vcltq_f32(_a,_b),vld1q_u32(bits))));
+  }
+  /// @brief |_v|
+  inline float4 abs(float4 _v) noexcept { return vabsq_f32(_v); }
+  /// @brief _v negated where _sign is negative
+  inline float4 flipSign(float4 _v, float4 _sign) noexcept
+  {
+    uint32x4_t sign=vandq_u32(vreinterpretq_u32_f32(_sign),vdupq_n_u32(0x80000000u));
+    return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(_v),sign));
+  }
+  /// @brief _a*_b+_c
+  inline float4 madd(float4 _a, float4 _b, float4 _c) noexcept { return vmlaq_f32(_c,_a,_b); }
+  /// @brief broadcast element N of _v to all four elements
+  template<int N> inline float4 lane(float4 _v) noexcept { return vdupq_n_f32(vgetq_lane_f32(_v,N)); }
+  /// @brief transpose the 4x4 matrix held in four rows
+  inline void transpose(float4 &io_r0, float4 &io_r1, float4 &io_r2, float4 &io_r3) noexcept
+  {
+    float32x4x2_t t01=vtrnq_f32(io_r0,io_r1);
+    float32x4x2_t t23=vtrnq_f32(io_r2,io_r3);
+    io_r0=vcombine_f32(vget_low_f32(t01.val[0]),vget_low_f32(t23.val[0]));
+    io_r1=vcombine_f32(vget_low_f32(t01.val[1]),vget_low_f32(t23.val[1]));
+    io_r2=vcombine_f32(vget_high_f32(t01.val[0]),vget_high_f32(t23.val[0]));
+    io_r3=vcombine_f32(vget_high_f32(t01.val[1]),vget_high_f32(t23.val[1]));
+  }
+  /// @brief 1/sqrt(_v) or 0 where _v is 0 (so zero length vectors stay zero when normalised)
+  inline float4 safeInvSqrt(float4 _v) noexcept
+  {
+    uint32x4_t mask=vcgtq_f32(_v,vdupq_n_f32(0.0f));
+    float4 inv=vdivq_f32(vdupq_n_f32(1.0f),vsqrtq_f32(_v));
+    return vreinterpretq_f32_u32(vandq_u32(mask,vreinterpretq_u32_f32(inv)));
+  }
+  /// @brief load four packed x,y,z triples (12 floats) into one register per component
+  inline void load3(const float *_p, float4 &o_x, float4 &o_y, float4 &o_z) noexcept
+  {
+    float32x4x3_t v=vld3q_f32(_p);
+    o_x=v.val[0];
+    o_y=v.val[1];
+    o_z=v.val[2];
+  }
+  /// @brief store one register per component as four packed x,y,z triples
+  inline void store3(float *_p, float4 _x, float4 _y, float4 _z) noexcept
+  {
+    float32x4x3_t v;
+    v.val[0]=_x;
+    v.val[1]=_y;
+    v.val[2]=_z;
+    vst3q_f32(_p,v);
+  }
+#endif
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief _a[0]*_r0 + _a[1]*_r1 + _a[2]*_r2 + _a[3]*_r3, a row of a matrix product or a row vector * matrix
+  //----------------------------------------------------------------------------------------------------------------------
+  inline float4 combine(float4 _a, float4 _r0, float4 _r1, float4 _r2, float4 _r3) noexcept
+  {
+    float4 res=mul(lane<0>(_a),_r0);
+    res=madd(lane<1>(_a),_r1,res);
+    res=madd(lane<2>(_a),_r2,res);
+    return madd(lane<3>(_a),_r3,res);
+  }
+
+} // end namespace simd
+} // end namespace ngl
+#endif // NGL_SIMD
+
+#endif
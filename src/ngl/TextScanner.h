@@ -0,0 +1,153 @@
+/*
+  Copyright (C) 2009 Jon Macey
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TEXTSCANNER_H_
+#define TEXTSCANNER_H_
+//----------------------------------------------------------------------------------------------------------------------
+/// @file TextScanner.h
+/// @brief pointer walking number scanners shared by the text file readers (Obj and NCCAPointBake)
+/// the text being scanned must end with a character that isn't part of a number (new line, \0, < etc)
+//----------------------------------------------------------------------------------------------------------------------
+#include "Types.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+namespace ngl
+{
+namespace text
+{
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief powers of ten which can be represented exactly as a double
+  //----------------------------------------------------------------------------------------------------------------------
+  const double s_pow10[]={1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,
+                          1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+
+  inline bool isDigit(char _c) noexcept { return _c>='0' && _c<='9'; }
+  // note new lines are not white space as they terminate an obj statement
+  inline bool isBlank(char _c) noexcept { return _c==' ' || _c=='\t' || _c=='\r'; }
+  inline bool isEndOfLine(char _c) noexcept { return _c=='\n' || _c=='\0'; }
+
+
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief scan a real number of the form [+-]digits[.digits][(e|E)[+-]digits] advancing _p past it
+  /// the mantissa is accumulated as an integer and scaled once so no locale or allocation is involved
+  /// @returns false if no number is present (in which case _p is not moved)
+  //----------------------------------------------------------------------------------------------------------------------
+  inline bool scanReal(const char *&_p, Real &o_value) noexcept
+  {
+    const char *p=_p;
+    bool negative=false;
+    if(*p=='-') { negative=true; ++p; }
+    else if(*p=='+') { ++p; }
+
+    uint64_t mantissa=0;
+    int significant=0;
+    int exponent=0;
+    bool hasDigits=false;
+    for( ; isDigit(*p); ++p)
+    {
+      hasDigits=true;
+      if(significant<19)
+      {
+        mantissa=mantissa*10+static_cast<uint64_t>(*p-'0');
+        if(mantissa!=0) { ++significant; }
+      }
+      else { ++exponent; }
+    }
+    if(*p=='.')
+    {
+      for(++p; isDigit(*p); ++p)
+      {
+        hasDigits=true;
+        if(significant<19)
+        {
+          mantissa=mantissa*10+static_cast<uint64_t>(*p-'0');
+          if(mantissa!=0) { ++significant; }
+          --exponent;
+        }
+      }
+    }
+    if(!hasDigits)
+    {
+      // let the c library deal with nan / inf etc, strtod skips white space (including new lines)
+      // so make sure we don't wander onto the next line
+      if(isBlank(*_p) || isEndOfLine(*_p)) { return false; }
+      char *end;
+      double v=std::strtod(_p,&end);
+      if(end==_p) { return false; }
+      o_value=static_cast<Real>(v);
+      _p=end;
+      return true;
+    }
+    if(*p=='e' || *p=='E')
+    {
+      const char *e=p+1;
+      bool negativeExp=false;
+      if(*e=='-') { negativeExp=true; ++e; }
+      else if(*e=='+') { ++e; }
+      if(isDigit(*e))
+      {
+        int exp=0;
+        for( ; isDigit(*e); ++e)
+        {
+          if(exp<10000) { exp=exp*10+(*e-'0'); }
+        }
+        exponent+= negativeExp ? -exp : exp;
+        p=e;
+      }
+    }
+    double value=static_cast<double>(mantissa);
+    if(mantissa!=0 && exponent!=0)
+    {
+      if(exponent>=-22 && exponent<=22)
+      {
+        value = exponent<0 ? value/s_pow10[-exponent] : value*s_pow10[exponent];
+      }
+      else
+      {
+        value*=std::pow(10.0,exponent);
+      }
+    }
+    o_value=static_cast<Real>(negative ? -value : value);
+    _p=p;
+    return true;
+  }
+  //----------------------------------------------------------------------------------------------------------------------
+  /// @brief scan a (possibly negative) integer advancing _p past it
+  /// @returns false if no integer is present (in which case _p is not moved)
+  //----------------------------------------------------------------------------------------------------------------------
+  inline bool scanInt(const char *&_p, int64_t &o_value) noexcept
+  {
+    const char *p=_p;
+    bool negative=false;
+    if(*p=='-') { negative=true; ++p; }
+    else if(*p=='+') { ++p; }
+    if(!isDigit(*p)) { return false; }
+    int64_t value=0;
+    for( ; isDigit(*p); ++p)
+    {
+      value=value*10+(*p-'0');
+    }
+    o_value= negative ? -value : value;
+    _p=p;
+    return true;
+  }
+
+} // end text namespace
+} // end ngl namespace
+
+#endif
@@ -0,0 +1,128 @@
+#include <ngl/GLStateCache.h>
+#include <ngl/ShaderLib.h>
+#include <ngl/SimpleVAO.h>
+#include <ngl/VAOFactory.h>
+#include <ngl/VAOPrimitives.h>
+#include "../ShaderLib/recordingGL.h"
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+// submitting 100k copies of a VAOPrimitives sphere. The per object path sets the MVP and calls draw for each as the
+// NGL demos do, the instanced paths stream the transforms into the per instance buffer and draw them with
+// drawInstanced, either all at once or in chunks. The GL calls go to a stand in for the driver so the times are only
+// the CPU cost of submitting, not of drawing.
+static const size_t s_instances=100000;
+static const size_t s_chunk=1000;
+
+static ngl::ShaderLib *s_shader=nullptr;
+static ngl::VAOPrimitives *s_prim=nullptr;
+static std::vector<ngl::Mat4> s_transforms;
+static ngl::UniformHandle s_mvpHandle;
+static size_t s_drawCalls=0;
+
+void drawPerObject()
+{
+  for(auto &t : s_transforms)
+  {
+    s_shader->setUniform(s_mvpHandle,t);
+    s_prim->draw("sphere");
+  }
+  s_drawCalls+=s_transforms.size();
+}
+
+void drawInstanced()
+{
+  s_prim->drawInstanced("sphere",s_transforms);
+  ++s_drawCalls;
+}
+
+void drawInstancedChunks()
+{
+  for(size_t i=0; i<s_transforms.size(); i+=s_chunk)
+  {
+    s_prim->drawInstanced("sphere",&s_transforms[i],std::min(s_chunk,s_transforms.size()-i));
+    ++s_drawCalls;
+  }
+}
+
+BENCHMARK(Submit100kInstances, PerObject, 5, 10) { drawPerObject(); }
+BENCHMARK(Submit100kInstances, Instanced, 5, 10) { drawInstanced(); }
+BENCHMARK(Submit100kInstances, InstancedChunks, 5, 10) { drawInstancedChunks(); }
+
+template <class Func>
+double bestTime(Func _func, int _runs)
+{
+  double best=1e30;
+  for(int run=0; run<_runs; ++run)
+  {
+    auto start=std::chrono::high_resolution_clock::now();
+    _func();
+    std::chrono::duration<double> time=std::chrono::high_resolution_clock::now()-start;
+    best=std::min(best,time.count());
+  }
+  return best;
+}
+
+template <class Func>
+void report(const char *_name, Func _func)
+{
+  auto &state=recordingGL::state();
+  _func();
+  state.uniformCalls=state.uniformBytes=state.bufferUploads=state.bufferBytes=0;
+  state.bindVertexArrayCalls=0;
+  s_drawCalls=0;
+  _func();
+  size_t draws=s_drawCalls;
+  size_t calls=draws+state.uniformCalls+state.bufferUploads+state.bindVertexArrayCalls;
+  size_t bytes=state.uniformBytes+state.bufferBytes;
+  double time=bestTime(_func,20);
+  state.draws.clear();
+  printf("%-26s %10zu %10zu %12zu %10.3f\n",_name,draws,calls,bytes,time*1e3);
+}
+
+int main(int argc, char **argv)
+{
+  recordingGL::install();
+  recordingGL::state().record=false;
+  // NGLInit normally does this
+  ngl::VAOFactory::registerVAOCreator("simpleVAO",ngl::SimpleVAO::create);
+  s_shader=ngl::ShaderLib::instance();
+  s_shader->createShaderProgram("Colour");
+  recordingGL::state().uniforms[s_shader->getProgramID("Colour")]={{"MVP",GL_FLOAT_MAT4,1}};
+  s_shader->linkProgramObject("Colour");
+  s_shader->use("Colour");
+  s_mvpHandle=s_shader->getUniformHandle("MVP");
+  // every transform differs so nothing would be filtered anyway
+  ngl::GLStateCache::instance()->setEnabled(false);
+  s_prim=ngl::VAOPrimitives::instance();
+  s_prim->createSphere("sphere",1.0f,8);
+  for(size_t i=0; i<s_instances; ++i)
+  {
+    ngl::Mat4 t;
+    t.translate(float(i%100),float(i/100%100),-float(i/10000));
+    s_transforms.push_back(t);
+  }
+
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+  recordingGL::state().draws.clear();
+
+  std::cout<<"\n"<<s_instances<<" spheres, "<<s_prim->getVAOFromName("sphere")->numIndices()<<" vertices each\n";
+  printf("%-26s %10s %10s %12s %10s\n","","draws","GL calls","bytes","ms");
+  report("per object",drawPerObject);
+  report("instanced",drawInstanced);
+  report("instanced, 1000 per draw",drawInstancedChunks);
+  return result;
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/MultiBufferVAO.h>
+#include <ngl/SimpleIndexVAO.h>
+#include <ngl/SimpleVAO.h>
+#include <ngl/VAOFactory.h>
+#include <ngl/VAOPrimitives.h>
+#include "../ShaderLib/recordingGL.h"
+#include <cstring>
+#include <memory>
+#include <vector>
+
+
+int main(int argc, char **argv)
+{
+  // no OpenGL context is needed as the calls go to the recording stand in
+  recordingGL::install();
+  // NGLInit normally does this
+  ngl::VAOFactory::registerVAOCreator("simpleVAO",ngl::SimpleVAO::create);
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+static const std::vector<float> s_triangle={0.0f,0.0f,0.0f, 1.0f,0.0f,0.0f, 0.0f,1.0f,0.0f};
+static const std::vector<float> s_offsets={0.0f,0.0f,0.0f, 2.0f,0.0f,0.0f, 4.0f,0.0f,0.0f, 6.0f,0.0f,0.0f};
+
+TEST(NGLAbstractVAO,simpleDrawInstanced)
+{
+  auto &state=recordingGL::state();
+  std::unique_ptr<ngl::AbstractVAO> vao(ngl::SimpleVAO::create(GL_TRIANGLES));
+  vao->bind();
+  vao->setData(ngl::SimpleVAO::VertexData(s_triangle.size()*sizeof(float),s_triangle[0]));
+  vao->setVertexAttributePointer(0,3,GL_FLOAT,0,0);
+  vao->setNumIndices(3);
+  vao->setInstanceData(0,ngl::SimpleVAO::VertexData(s_offsets.size()*sizeof(float),s_offsets[0],GL_STREAM_DRAW));
+  vao->setInstanceAttributePointer(0,1,3,GL_FLOAT,0,0);
+  GLuint id=state.currentVAO;
+  ASSERT_EQ(vao->numInstanceBuffers(),1u);
+  GLuint instances=vao->getInstanceBufferID(0);
+  EXPECT_NE(instances,vao->getBufferID(0));
+  // the vertices step per vertex and the offsets per instance
+  auto &attributes=state.attributes[id];
+  EXPECT_TRUE(attributes[1].enabled);
+  EXPECT_EQ(attributes[1].buffer,instances);
+  EXPECT_EQ(attributes[1].divisor,1u);
+  EXPECT_EQ(attributes[0].buffer,vao->getBufferID(0));
+  EXPECT_EQ(attributes[0].divisor,0u);
+  ASSERT_EQ(state.buffers[instances].size(),s_offsets.size()*sizeof(float));
+  EXPECT_EQ(std::memcmp(state.buffers[instances].data(),s_offsets.data(),s_offsets.size()*sizeof(float)),0);
+
+  state.draws.clear();
+  vao->drawInstanced(4);
+  vao->unbind();
+  ASSERT_EQ(state.draws.size(),1u);
+  EXPECT_STREQ(state.draws[0].func,"glDrawArraysInstanced");
+  EXPECT_EQ(state.draws[0].vao,id);
+  EXPECT_EQ(state.draws[0].mode,GLenum(GL_TRIANGLES));
+  EXPECT_EQ(state.draws[0].count,3);
+  EXPECT_EQ(state.draws[0].instances,4);
+
+  // new data replaces the old in the same buffer
+  vao->bind();
+  vao->setInstanceData(0,ngl::SimpleVAO::VertexData(3*sizeof(float),s_offsets[3],GL_STREAM_DRAW));
+  vao->unbind();
+  EXPECT_EQ(vao->numInstanceBuffers(),1u);
+  EXPECT_EQ(vao->getInstanceBufferID(0),instances);
+  EXPECT_EQ(state.buffers[instances].size(),3*sizeof(float));
+  // the instance buffers go with the VAO
+  vao->removeVAO();
+  EXPECT_EQ(vao->numInstanceBuffers(),0u);
+  EXPECT_EQ(state.buffers.count(instances),0u);
+}
+
+TEST(NGLAbstractVAO,indexAndMultiBufferDrawInstanced)
+{
+  auto &state=recordingGL::state();
+  std::unique_ptr<ngl::AbstractVAO> indexed(ngl::SimpleIndexVAO::create(GL_TRIANGLES));
+  std::vector<GLushort> indices={0,1,2};
+  indexed->bind();
+  indexed->setData(ngl::SimpleIndexVAO::VertexData(s_triangle.size()*sizeof(float),s_triangle[0],3,&indices[0],
+                                                   GL_UNSIGNED_SHORT));
+  indexed->setNumIndices(3);
+  state.draws.clear();
+  indexed->drawInstanced(7);
+  indexed->unbind();
+  ASSERT_EQ(state.draws.size(),1u);
+  EXPECT_STREQ(state.draws[0].func,"glDrawElementsInstanced");
+  EXPECT_EQ(state.draws[0].count,3);
+  EXPECT_EQ(state.draws[0].instances,7);
+
+  std::unique_ptr<ngl::AbstractVAO> multi(ngl::MultiBufferVAO::create(GL_POINTS));
+  multi->bind();
+  multi->setData(ngl::MultiBufferVAO::VertexData(s_triangle.size()*sizeof(float),s_triangle[0]));
+  multi->setNumIndices(3);
+  // a second instance buffer, the first is made too
+  multi->setInstanceData(1,ngl::MultiBufferVAO::VertexData(s_offsets.size()*sizeof(float),s_offsets[0]));
+  EXPECT_EQ(multi->numInstanceBuffers(),2u);
+  multi->setInstanceAttributePointer(1,4,3,GL_FLOAT,0,0,2);
+  EXPECT_EQ(state.attributes[state.currentVAO][4].divisor,2u);
+  EXPECT_EQ(state.attributes[state.currentVAO][4].buffer,multi->getInstanceBufferID(1));
+  multi->drawInstanced(8);
+  multi->unbind();
+  ASSERT_EQ(state.draws.size(),2u);
+  EXPECT_STREQ(state.draws[1].func,"glDrawArraysInstanced");
+  EXPECT_EQ(state.draws[1].mode,GLenum(GL_POINTS));
+  EXPECT_EQ(state.draws[1].instances,8);
+}
+
+TEST(NGLAbstractVAO,primitivesDrawInstanced)
+{
+  auto &state=recordingGL::state();
+  ngl::VAOPrimitives *prim=ngl::VAOPrimitives::instance();
+  prim->createSphere("instancedSphere",1.0f,8);
+  ngl::AbstractVAO *vao=prim->getVAOFromName("instancedSphere");
+  std::vector<ngl::Mat4> transforms(5);
+  for(size_t i=0; i<transforms.size(); ++i)
+  {
+    transforms[i].translate(float(i),0.0f,0.0f);
+  }
+  state.draws.clear();
+  prim->drawInstanced("instancedSphere",transforms);
+  ASSERT_EQ(state.draws.size(),1u);
+  EXPECT_EQ(state.draws[0].instances,5);
+  EXPECT_EQ(state.draws[0].count,GLsizei(vao->numIndices()));
+  // the transforms are a mat4 attribute, one column per attribute
+  GLuint buffer=vao->getInstanceBufferID(0);
+  auto &attributes=state.attributes[state.draws[0].vao];
+  for(GLuint c=0; c<4; ++c)
+  {
+    const recordingGL::Attribute &a=attributes[ngl::instanceTransformAttribute+c];
+    EXPECT_TRUE(a.enabled);
+    EXPECT_EQ(a.buffer,buffer);
+    EXPECT_EQ(a.divisor,1u);
+    EXPECT_EQ(a.size,4);
+    EXPECT_EQ(a.stride,GLsizei(sizeof(ngl::Mat4)));
+    EXPECT_EQ(a.offset,c*4*sizeof(float));
+  }
+  ASSERT_EQ(state.buffers[buffer].size(),5*sizeof(ngl::Mat4));
+  EXPECT_EQ(std::memcmp(state.buffers[buffer].data(),transforms.data(),5*sizeof(ngl::Mat4)),0);
+
+  // the next draw only sends the data
+  attributes[ngl::instanceTransformAttribute].divisor=0;
+  transforms.resize(2);
+  prim->drawInstanced("instancedSphere",transforms);
+  EXPECT_EQ(attributes[ngl::instanceTransformAttribute].divisor,0u);
+  EXPECT_EQ(vao->getInstanceBufferID(0),buffer);
+  EXPECT_EQ(state.buffers[buffer].size(),2*sizeof(ngl::Mat4));
+  ASSERT_EQ(state.draws.size(),2u);
+  EXPECT_EQ(state.draws[1].instances,2);
+  // nothing to draw and unknown names draw nothing
+  prim->drawInstanced("instancedSphere",std::vector<ngl::Mat4>());
+  prim->drawInstanced("notAPrimitive",transforms);
+  EXPECT_EQ(state.draws.size(),2u);
+}
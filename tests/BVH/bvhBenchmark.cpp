@@ -0,0 +1,216 @@
+#include <ngl/BVH.h>
+#include <ngl/Camera.h>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <vector>
+// the raw teapot data used by VAOPrimitives (tx,ty,nx,ny,nz,vx,vy,vz per vertex)
+#include "../../src/ngl/Teapot.h"
+
+// builds trees for the teapot and generated meshes of ~250k and ~1M triangles, then times picking rays
+// (closest and any hit), sphere overlap and frustum queries. The brute force column tests every triangle
+// as picking did before.
+struct TestMesh
+{
+  const char *m_name;
+  std::vector<ngl::Vec3> m_verts;
+  std::vector<uint32_t> m_indices;
+  ngl::BVH m_bvh;
+};
+
+static TestMesh s_meshes[3];
+static std::vector<ngl::Vec3> s_rayOrigins;
+static std::vector<ngl::Vec3> s_rayDirs;
+static const size_t s_numRays=10000;
+// query results are added here so the compiler can't drop the loops
+static volatile size_t s_sink=0;
+
+void teapotMesh(TestMesh &o_mesh)
+{
+  o_mesh.m_name="teapot";
+  for(unsigned int i=0; i<ngl::teapotSIZE; i+=8)
+  {
+    o_mesh.m_indices.push_back(o_mesh.m_verts.size());
+    o_mesh.m_verts.push_back(ngl::Vec3(ngl::teapot[i+5],ngl::teapot[i+6],ngl::teapot[i+7]));
+  }
+}
+
+void bumpySphere(const char *_name, int _rings, int _segments, TestMesh &o_mesh)
+{
+  o_mesh.m_name=_name;
+  for(int r=0; r<=_rings; ++r)
+  {
+    float phi=float(M_PI)*r/_rings;
+    for(int s=0; s<=_segments; ++s)
+    {
+      float theta=2.0f*float(M_PI)*s/_segments;
+      float radius=0.5f+0.05f*std::sin(theta*25.0f)*std::sin(phi*13.0f);
+      o_mesh.m_verts.push_back(ngl::Vec3(radius*std::sin(phi)*std::cos(theta),radius*std::cos(phi),radius*std::sin(phi)*std::sin(theta)));
+    }
+  }
+  for(int r=0; r<_rings; ++r)
+  {
+    for(int s=0; s<_segments; ++s)
+    {
+      uint32_t a=r*(_segments+1)+s;
+      uint32_t b=a+_segments+1;
+      o_mesh.m_indices.insert(o_mesh.m_indices.end(),{a,b,a+1,a+1,b,b+1});
+    }
+  }
+}
+
+bool bruteForce(const TestMesh &_mesh, const ngl::Vec3 &_o, const ngl::Vec3 &_d, float &o_t)
+{
+  bool found=false;
+  o_t=std::numeric_limits<float>::max();
+  const std::vector<ngl::Vec3> &v=_mesh.m_verts;
+  for(size_t i=0; i<_mesh.m_indices.size(); i+=3)
+  {
+    const ngl::Vec3 &v0=v[_mesh.m_indices[i]];
+    ngl::Vec3 e1(v[_mesh.m_indices[i+1]].m_x-v0.m_x,v[_mesh.m_indices[i+1]].m_y-v0.m_y,v[_mesh.m_indices[i+1]].m_z-v0.m_z);
+    ngl::Vec3 e2(v[_mesh.m_indices[i+2]].m_x-v0.m_x,v[_mesh.m_indices[i+2]].m_y-v0.m_y,v[_mesh.m_indices[i+2]].m_z-v0.m_z);
+    ngl::Vec3 p(_d.m_y*e2.m_z-_d.m_z*e2.m_y,_d.m_z*e2.m_x-_d.m_x*e2.m_z,_d.m_x*e2.m_y-_d.m_y*e2.m_x);
+    float det=e1.m_x*p.m_x+e1.m_y*p.m_y+e1.m_z*p.m_z;
+    if(std::fabs(det)<1e-12f)
+    {
+      continue;
+    }
+    float inv=1.0f/det;
+    ngl::Vec3 s(_o.m_x-v0.m_x,_o.m_y-v0.m_y,_o.m_z-v0.m_z);
+    float u=(s.m_x*p.m_x+s.m_y*p.m_y+s.m_z*p.m_z)*inv;
+    ngl::Vec3 q(s.m_y*e1.m_z-s.m_z*e1.m_y,s.m_z*e1.m_x-s.m_x*e1.m_z,s.m_x*e1.m_y-s.m_y*e1.m_x);
+    float vv=(_d.m_x*q.m_x+_d.m_y*q.m_y+_d.m_z*q.m_z)*inv;
+    float t=(e2.m_x*q.m_x+e2.m_y*q.m_y+e2.m_z*q.m_z)*inv;
+    if(u>=0.0f && vv>=0.0f && u+vv<=1.0f && t>0.0f && t<o_t)
+    {
+      o_t=t;
+      found=true;
+    }
+  }
+  return found;
+}
+
+size_t closestRays(const TestMesh &_mesh, size_t _n)
+{
+  size_t hits=0;
+  ngl::BVHHit hit;
+  for(size_t i=0; i<_n; ++i)
+  {
+    hits+=_mesh.m_bvh.intersect(s_rayOrigins[i],s_rayDirs[i],hit);
+  }
+  return hits;
+}
+
+size_t anyRays(const TestMesh &_mesh, size_t _n)
+{
+  size_t hits=0;
+  for(size_t i=0; i<_n; ++i)
+  {
+    hits+=_mesh.m_bvh.intersectAny(s_rayOrigins[i],s_rayDirs[i]);
+  }
+  return hits;
+}
+
+size_t bruteRays(const TestMesh &_mesh, size_t _n)
+{
+  size_t hits=0;
+  float t;
+  for(size_t i=0; i<_n; ++i)
+  {
+    hits+=bruteForce(_mesh,s_rayOrigins[i],s_rayDirs[i],t);
+  }
+  return hits;
+}
+
+size_t sphereQueries(const TestMesh &_mesh, size_t _n)
+{
+  size_t found=0;
+  std::vector<uint32_t> ids;
+  for(size_t i=0; i<_n; ++i)
+  {
+    _mesh.m_bvh.overlapSphere(s_rayOrigins[i]*0.2f,0.05f,ids);
+    found+=ids.size();
+  }
+  return found;
+}
+
+BENCHMARK(Teapot, Build, 5, 10) { s_meshes[0].m_bvh.build(s_meshes[0].m_verts,s_meshes[0].m_indices,1); }
+BENCHMARK(Teapot, ClosestHit, 5, 10) { s_sink+=closestRays(s_meshes[0],1000); }
+BENCHMARK(Teapot, AnyHit, 5, 10) { s_sink+=anyRays(s_meshes[0],1000); }
+BENCHMARK(Teapot, BruteForce, 5, 1) { s_sink+=bruteRays(s_meshes[0],100); }
+BENCHMARK(Sphere1M, Build, 3, 1) { s_meshes[2].m_bvh.build(s_meshes[2].m_verts,s_meshes[2].m_indices,1); }
+BENCHMARK(Sphere1M, ClosestHit, 5, 10) { s_sink+=closestRays(s_meshes[2],1000); }
+
+template <class Func>
+double bestTime(Func _func, int _runs)
+{
+  double best=1e30;
+  for(int run=0; run<_runs; ++run)
+  {
+    auto start=std::chrono::high_resolution_clock::now();
+    _func();
+    std::chrono::duration<double> time=std::chrono::high_resolution_clock::now()-start;
+    best=std::min(best,time.count());
+  }
+  return best;
+}
+
+
+int main(int argc, char **argv)
+{
+  teapotMesh(s_meshes[0]);
+  bumpySphere("sphere256k",256,512,s_meshes[1]);
+  bumpySphere("sphere1M",512,1024,s_meshes[2]);
+  // rays from a shell around the meshes aimed at points near the middle, about half hit
+  for(size_t i=0; i<s_numRays; ++i)
+  {
+    float a=i*0.618034f*2.0f*float(M_PI);
+    float b=i*0.7548776f*2.0f*float(M_PI);
+    ngl::Vec3 o(2.0f*std::cos(a)*std::cos(b),2.0f*std::sin(b),2.0f*std::sin(a)*std::cos(b));
+    ngl::Vec3 target(std::sin(i*0.3f)*0.7f,std::cos(i*0.7f)*0.7f,std::sin(i*1.1f)*0.7f);
+    s_rayOrigins.push_back(o);
+    s_rayDirs.push_back(target-o);
+  }
+  for(auto &m : s_meshes)
+  {
+    m.m_bvh.build(m.m_verts,m.m_indices);
+  }
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+
+  ngl::Camera cam(ngl::Vec3(0.3f,0.2f,1.2f),ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(0.0f,1.0f,0.0f));
+  cam.setShape(20.0f,1.0f,0.1f,10.0f);
+  cam.calculateFrustum();
+  std::cout<<"\n"<<std::thread::hardware_concurrency()<<" cores\n";
+  printf("%11s %9s %10s %10s %9s %10s %10s %10s %10s\n","mesh","tris","build ms","build all","nodes",
+         "closest/s","any/s","brute/s","sphere/s");
+  for(auto &m : s_meshes)
+  {
+    double build=bestTime([&]{m.m_bvh.build(m.m_verts,m.m_indices,1);},3);
+    double buildAll=bestTime([&]{m.m_bvh.build(m.m_verts,m.m_indices,0);},3);
+    double closest=bestTime([&]{s_sink+=closestRays(m,s_numRays);},3);
+    double any=bestTime([&]{s_sink+=anyRays(m,s_numRays);},3);
+    size_t bruteCount=std::max<size_t>(1,2000000/m.m_indices.size());
+    double brute=bestTime([&]{s_sink+=bruteRays(m,bruteCount);},1);
+    double sphere=bestTime([&]{s_sink+=sphereQueries(m,s_numRays);},3);
+    printf("%11s %9zu %10.1f %10.1f %9zu %10.0f %10.0f %10.0f %10.0f\n",m.m_name,m.m_indices.size()/3,build*1e3,buildAll*1e3,
+           m.m_bvh.getNodes().size(),s_numRays/closest,s_numRays/any,bruteCount/brute,s_numRays/sphere);
+  }
+  std::vector<uint32_t> ids;
+  double frustum=bestTime([&]{s_meshes[2].m_bvh.inFrustum(cam,ids);},5);
+  printf("\nfrustum query on sphere1M %.2f ms, %zu of %zu triangles visible\n",frustum*1e3,ids.size(),s_meshes[2].m_indices.size()/3);
+  return result;
+}
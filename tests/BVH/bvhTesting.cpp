@@ -0,0 +1,312 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/BVH.h>
+#include <ngl/Camera.h>
+#include <ngl/AABB.h>
+#include <ngl/Obj.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// a bumpy sphere made of _rings*_segments*2 triangles
+void bumpySphere(int _rings, int _segments, std::vector<ngl::Vec3> &o_verts, std::vector<uint32_t> &o_indices)
+{
+  o_verts.clear();
+  o_indices.clear();
+  for(int r=0; r<=_rings; ++r)
+  {
+    float phi=float(M_PI)*r/_rings;
+    for(int s=0; s<=_segments; ++s)
+    {
+      float theta=2.0f*float(M_PI)*s/_segments;
+      float radius=1.0f+0.1f*std::sin(theta*5.0f)*std::sin(phi*3.0f);
+      o_verts.push_back(ngl::Vec3(radius*std::sin(phi)*std::cos(theta),radius*std::cos(phi),radius*std::sin(phi)*std::sin(theta)));
+    }
+  }
+  for(int r=0; r<_rings; ++r)
+  {
+    for(int s=0; s<_segments; ++s)
+    {
+      uint32_t a=r*(_segments+1)+s;
+      uint32_t b=a+_segments+1;
+      o_indices.insert(o_indices.end(),{a,b,a+1,a+1,b,b+1});
+    }
+  }
+}
+
+// the closest hit by testing every triangle
+bool bruteForce(const std::vector<ngl::Vec3> &_verts, const std::vector<uint32_t> &_indices,
+                const ngl::Vec3 &_o, const ngl::Vec3 &_d, float &o_t, uint32_t &o_id)
+{
+  bool found=false;
+  o_t=std::numeric_limits<float>::max();
+  for(size_t i=0; i<_indices.size(); i+=3)
+  {
+    ngl::Vec3 v0=_verts[_indices[i]];
+    ngl::Vec3 e1=_verts[_indices[i+1]]-v0;
+    ngl::Vec3 e2=_verts[_indices[i+2]]-v0;
+    ngl::Vec3 p;
+    p.cross(_d,e2);
+    float det=e1.dot(p);
+    if(std::fabs(det)<1e-12f)
+    {
+      continue;
+    }
+    ngl::Vec3 s=_o-v0;
+    float u=s.dot(p)/det;
+    ngl::Vec3 q;
+    q.cross(s,e1);
+    float v=_d.dot(q)/det;
+    float t=e2.dot(q)/det;
+    if(u>=0.0f && v>=0.0f && u+v<=1.0f && t>0.0f && t<o_t)
+    {
+      o_t=t;
+      o_id=i/3;
+      found=true;
+    }
+  }
+  return found;
+}
+
+TEST(NGLBVH,empty)
+{
+  ngl::BVH bvh;
+  ngl::BVHHit hit;
+  EXPECT_FALSE(bvh.intersect(ngl::Vec3(0.0f,0.0f,5.0f),ngl::Vec3(0.0f,0.0f,-1.0f),hit));
+  EXPECT_FALSE(bvh.intersectAny(ngl::Vec3(0.0f,0.0f,5.0f),ngl::Vec3(0.0f,0.0f,-1.0f)));
+  std::vector<uint32_t> ids(1);
+  bvh.overlapSphere(ngl::Vec3(0.0f,0.0f,0.0f),1.0f,ids);
+  EXPECT_TRUE(ids.empty());
+  std::vector<ngl::Vec3> verts(3);
+  EXPECT_FALSE(bvh.build(verts,{0,1}));
+  EXPECT_FALSE(bvh.build(verts,{0,1,3}));
+}
+
+TEST(NGLBVH,rays)
+{
+  std::vector<ngl::Vec3> verts;
+  std::vector<uint32_t> indices;
+  bumpySphere(40,60,verts,indices);
+  ngl::BVH bvh;
+  ASSERT_TRUE(bvh.build(verts,indices));
+  EXPECT_EQ(bvh.numTriangles(),indices.size()/3);
+  int hits=0;
+  for(int i=0; i<500; ++i)
+  {
+    // rays from around the sphere aimed near the middle, some miss
+    float a=i*0.618034f*2.0f*float(M_PI);
+    float b=i*0.7548776f;
+    ngl::Vec3 o(3.0f*std::cos(a),std::sin(b)*2.0f,3.0f*std::sin(a));
+    ngl::Vec3 target(std::sin(i*0.3f)*1.3f,std::cos(i*0.7f)*1.3f,0.0f);
+    ngl::Vec3 d=target-o;
+    ngl::BVHHit hit;
+    float t;
+    uint32_t id;
+    bool expected=bruteForce(verts,indices,o,d,t,id);
+    ASSERT_EQ(bvh.intersect(o,d,hit),expected) <<"ray "<<i;
+    EXPECT_EQ(bvh.intersectAny(o,d),expected);
+    if(expected)
+    {
+      ++hits;
+      EXPECT_NEAR(hit.m_t,t,1e-4f);
+      // the hit must be on the triangle reported
+      ngl::Vec3 v0=verts[indices[hit.m_id*3]];
+      ngl::Vec3 p=v0+(verts[indices[hit.m_id*3+1]]-v0)*hit.m_u+(verts[indices[hit.m_id*3+2]]-v0)*hit.m_v;
+      EXPECT_NEAR((p-(o+d*hit.m_t)).length(),0.0f,1e-4f);
+      // nothing is found in front of the closest hit
+      EXPECT_FALSE(bvh.intersectAny(o,d,hit.m_t*0.999f));
+    }
+  }
+  EXPECT_GT(hits,100);
+  EXPECT_LT(hits,500);
+}
+
+TEST(NGLBVH,threadedBuild)
+{
+  std::vector<ngl::Vec3> verts;
+  std::vector<uint32_t> indices;
+  bumpySphere(100,200,verts,indices);
+  ngl::BVH single;
+  ngl::BVH multi;
+  single.build(verts,indices,1);
+  multi.build(verts,indices,4);
+  ASSERT_EQ(single.getNodes().size(),multi.getNodes().size());
+  for(size_t i=0; i<single.getNodes().size(); ++i)
+  {
+    const ngl::BVH::Node &a=single.getNodes()[i];
+    const ngl::BVH::Node &b=multi.getNodes()[i];
+    EXPECT_EQ(a.m_offset,b.m_offset);
+    EXPECT_EQ(a.m_count,b.m_count);
+  }
+  // every triangle is in exactly one leaf
+  size_t count=0;
+  for(auto &n : single.getNodes())
+  {
+    count+=n.m_count;
+  }
+  EXPECT_EQ(count,indices.size()/3);
+}
+
+TEST(NGLBVH,overlapBox)
+{
+  std::vector<ngl::Vec3> verts;
+  std::vector<uint32_t> indices;
+  bumpySphere(40,60,verts,indices);
+  ngl::BVH bvh;
+  bvh.build(verts,indices);
+  ngl::Vec3 lo(0.2f,-0.3f,0.1f);
+  ngl::Vec3 hi(1.2f,0.4f,0.9f);
+  std::vector<uint32_t> ids;
+  bvh.overlapBox(lo,hi,ids);
+  EXPECT_TRUE(std::is_sorted(ids.begin(),ids.end()));
+  auto inside=[&](const ngl::Vec3 &_p)
+  {
+    return _p.m_x>=lo.m_x && _p.m_x<=hi.m_x && _p.m_y>=lo.m_y && _p.m_y<=hi.m_y && _p.m_z>=lo.m_z && _p.m_z<=hi.m_z;
+  };
+  for(uint32_t t=0; t<indices.size()/3; ++t)
+  {
+    bool found=std::binary_search(ids.begin(),ids.end(),t);
+    const ngl::Vec3 &a=verts[indices[t*3]];
+    const ngl::Vec3 &b=verts[indices[t*3+1]];
+    const ngl::Vec3 &c=verts[indices[t*3+2]];
+    if(inside(a) || inside(b) || inside(c))
+    {
+      EXPECT_TRUE(found) <<"triangle "<<t;
+    }
+    bool boundsApart=std::max(std::max(a.m_x,b.m_x),c.m_x)<lo.m_x || std::min(std::min(a.m_x,b.m_x),c.m_x)>hi.m_x ||
+                     std::max(std::max(a.m_y,b.m_y),c.m_y)<lo.m_y || std::min(std::min(a.m_y,b.m_y),c.m_y)>hi.m_y ||
+                     std::max(std::max(a.m_z,b.m_z),c.m_z)<lo.m_z || std::min(std::min(a.m_z,b.m_z),c.m_z)>hi.m_z;
+    if(boundsApart)
+    {
+      EXPECT_FALSE(found) <<"triangle "<<t;
+    }
+  }
+  EXPECT_FALSE(ids.empty());
+}
+
+TEST(NGLBVH,overlapExact)
+{
+  // a big triangle through a small box with no corners inside it, and one whose bounds overlap the box
+  // but which passes beside it
+  std::vector<ngl::Vec3> verts={ngl::Vec3(-10.0f,-10.0f,0.0f),ngl::Vec3(10.0f,-10.0f,0.0f),ngl::Vec3(0.0f,10.0f,0.0f),
+                                ngl::Vec3(-1.0f,2.0f,1.0f),ngl::Vec3(2.0f,-1.0f,1.0f),ngl::Vec3(2.0f,2.0f,1.0f)};
+  ngl::BVH bvh;
+  bvh.build(verts,{0,1,2,3,4,5});
+  std::vector<uint32_t> ids;
+  bvh.overlapBox(ngl::Vec3(-0.1f,-0.1f,-0.1f),ngl::Vec3(0.1f,0.1f,1.5f),ids);
+  ASSERT_EQ(ids.size(),1u);
+  EXPECT_EQ(ids[0],0u);
+  bvh.overlapSphere(ngl::Vec3(0.0f,0.0f,0.5f),0.6f,ids);
+  ASSERT_EQ(ids.size(),1u);
+  EXPECT_EQ(ids[0],0u);
+  bvh.overlapSphere(ngl::Vec3(0.0f,0.0f,0.5f),0.9f,ids);
+  EXPECT_EQ(ids.size(),2u);
+}
+
+TEST(NGLBVH,overlapSphere)
+{
+  std::vector<ngl::Vec3> verts;
+  std::vector<uint32_t> indices;
+  bumpySphere(40,60,verts,indices);
+  ngl::BVH bvh;
+  bvh.build(verts,indices);
+  ngl::Vec3 center(0.8f,0.5f,0.0f);
+  float radius=0.4f;
+  std::vector<uint32_t> ids;
+  bvh.overlapSphere(center,radius,ids);
+  for(uint32_t t=0; t<indices.size()/3; ++t)
+  {
+    bool found=std::binary_search(ids.begin(),ids.end(),t);
+    float nearest=std::numeric_limits<float>::max();
+    float furthest=0.0f;
+    for(int c=0; c<3; ++c)
+    {
+      float d=(verts[indices[t*3+c]]-center).length();
+      nearest=std::min(nearest,d);
+      furthest=std::max(furthest,d);
+    }
+    if(nearest<=radius)
+    {
+      EXPECT_TRUE(found) <<"triangle "<<t;
+    }
+    // the triangles are small so none with every corner well outside can touch the sphere
+    if(nearest>radius+0.2f)
+    {
+      EXPECT_FALSE(found) <<"triangle "<<t;
+    }
+  }
+  EXPECT_FALSE(ids.empty());
+}
+
+TEST(NGLBVH,inFrustum)
+{
+  std::vector<ngl::Vec3> verts;
+  std::vector<uint32_t> indices;
+  bumpySphere(40,60,verts,indices);
+  ngl::BVH bvh;
+  bvh.build(verts,indices);
+  ngl::Camera cam(ngl::Vec3(0.5f,0.5f,2.0f),ngl::Vec3(0.8f,0.5f,0.0f),ngl::Vec3(0.0f,1.0f,0.0f));
+  cam.setShape(30.0f,1.0f,0.1f,10.0f);
+  cam.calculateFrustum();
+  std::vector<uint32_t> ids;
+  bvh.inFrustum(cam,ids);
+  std::vector<uint32_t> expected;
+  for(uint32_t t=0; t<indices.size()/3; ++t)
+  {
+    ngl::Vec3 lo=verts[indices[t*3]];
+    ngl::Vec3 hi=lo;
+    for(int c=1; c<3; ++c)
+    {
+      const ngl::Vec3 &p=verts[indices[t*3+c]];
+      lo.set(std::min(lo.m_x,p.m_x),std::min(lo.m_y,p.m_y),std::min(lo.m_z,p.m_z));
+      hi.set(std::max(hi.m_x,p.m_x),std::max(hi.m_y,p.m_y),std::max(hi.m_z,p.m_z));
+    }
+    ngl::AABB box(ngl::Vec4(lo.m_x,lo.m_y,lo.m_z),hi.m_x-lo.m_x,hi.m_y-lo.m_y,hi.m_z-lo.m_z);
+    if(cam.boxInFrustum(box)!=ngl::CameraIntercept::OUTSIDE)
+    {
+      expected.push_back(t);
+    }
+  }
+  EXPECT_EQ(ids,expected);
+  EXPECT_FALSE(ids.empty());
+  EXPECT_LT(ids.size(),indices.size()/3);
+}
+
+TEST(NGLBVH,mesh)
+{
+  // quads are split into triangles which report the face they came from
+  {
+    std::ofstream out("cube.obj");
+    out<<"v -1 -1  1\nv  1 -1  1\nv  1  1  1\nv -1  1  1\n"
+         "v -1 -1 -1\nv  1 -1 -1\nv  1  1 -1\nv -1  1 -1\n"
+         "f 1 2 3 4\nf 6 5 8 7\nf 2 6 7 3\nf 5 1 4 8\nf 4 3 7 8\nf 5 6 2 1\n";
+  }
+  ngl::Obj mesh;
+  ASSERT_TRUE(mesh.load("cube.obj",false));
+  std::remove("cube.obj");
+  ngl::BVH bvh;
+  ASSERT_TRUE(bvh.build(mesh));
+  EXPECT_EQ(bvh.numTriangles(),12u);
+  ngl::BVHHit hit;
+  // into the +z face (face 0)
+  ASSERT_TRUE(bvh.intersect(ngl::Vec3(0.2f,0.3f,5.0f),ngl::Vec3(0.0f,0.0f,-1.0f),hit));
+  EXPECT_EQ(hit.m_id,0u);
+  EXPECT_FLOAT_EQ(hit.m_t,4.0f);
+  // into the +x face (face 2)
+  ASSERT_TRUE(bvh.intersect(ngl::Vec3(5.0f,0.3f,-0.6f),ngl::Vec3(-2.0f,0.0f,0.0f),hit));
+  EXPECT_EQ(hit.m_id,2u);
+  EXPECT_FLOAT_EQ(hit.m_t,2.0f);
+  std::vector<uint32_t> ids;
+  bvh.overlapSphere(ngl::Vec3(1.0f,1.0f,1.0f),0.1f,ids);
+  EXPECT_EQ(ids,std::vector<uint32_t>({0,2,4}));
+}
@@ -0,0 +1,188 @@
+#include <ngl/BatchRenderer.h>
+#include <ngl/ShaderLib.h>
+#include <ngl/SimpleVAO.h>
+#include <ngl/VAOFactory.h>
+#include <ngl/VAOPrimitives.h>
+#include "../ShaderLib/recordingGL.h"
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// a frame of 10k objects made from 8 VAOPrimitives and drawn with 2 shaders. The per object path does the usual
+// use, set MVP and VAOPrimitives::draw for each, the batch path adds each object to a BatchRenderer and draws it with
+// one multi draw indirect per shader and draw mode. The GL calls go to a stand in for the driver which counts them
+// (glDrawArrays has no context so does nothing). The cost of sorting and building the commands alone is measured
+// with 1000 primitives and 4 shaders so there are thousands of commands.
+static const size_t s_objects=10000;
+
+struct Object
+{
+  std::string shader;
+  std::string primitive;
+  GLuint program;
+  int id;
+  ngl::Mat4 model;
+};
+
+static ngl::ShaderLib *s_shader=nullptr;
+static ngl::VAOPrimitives *s_prim=nullptr;
+static std::vector<Object> s_scene;
+static std::vector<Object> s_manyScene;
+static ngl::Mat4 s_VP;
+static ngl::BatchRenderer *s_batch=nullptr;
+static ngl::BatchRenderer *s_manyBatch=nullptr;
+
+void drawPerObject()
+{
+  for(auto &o : s_scene)
+  {
+    s_shader->use(o.shader);
+    s_shader->setUniform("MVP",s_VP*o.model);
+    s_prim->draw(o.primitive);
+  }
+}
+
+void drawBatch()
+{
+  s_batch->begin();
+  for(auto &o : s_scene)
+  {
+    s_batch->add(o.program,o.id,o.model);
+  }
+  s_batch->draw();
+}
+
+void buildMany()
+{
+  s_manyBatch->begin();
+  for(auto &o : s_manyScene)
+  {
+    s_manyBatch->add(o.program,o.id,o.model);
+  }
+  s_manyBatch->build();
+}
+
+BENCHMARK(Frame10kObjects, PerObject, 5, 10) { drawPerObject(); }
+BENCHMARK(Frame10kObjects, Batch, 5, 10) { drawBatch(); }
+BENCHMARK(Build10kInstances, ManyPrimitives, 5, 10) { buildMany(); }
+
+template <class Func>
+double bestTime(Func _func, int _runs)
+{
+  double best=1e30;
+  for(int run=0; run<_runs; ++run)
+  {
+    auto start=std::chrono::high_resolution_clock::now();
+    _func();
+    std::chrono::duration<double> time=std::chrono::high_resolution_clock::now()-start;
+    best=std::min(best,time.count());
+  }
+  return best;
+}
+
+// the GL calls of one frame, draws made with glDrawArrays are not seen by the stand in so are passed in
+template <class Func>
+void report(const char *_name, Func _func, size_t _untracedDraws)
+{
+  auto &state=recordingGL::state();
+  _func();
+  state.useProgramCalls=state.bindVertexArrayCalls=state.uniformCalls=state.uniformBytes=0;
+  state.bufferUploads=state.bufferBytes=0;
+  state.draws.clear();
+  _func();
+  size_t draws=state.draws.size()+_untracedDraws;
+  size_t calls=state.useProgramCalls+state.bindVertexArrayCalls+state.uniformCalls+state.bufferUploads+draws;
+  size_t bytes=state.uniformBytes+state.bufferBytes;
+  double time=bestTime(_func,20);
+  printf("%-26s %10zu %10zu %10zu %10.3f\n",_name,draws,calls,bytes,time*1e3);
+}
+
+int main(int argc, char **argv)
+{
+  recordingGL::install();
+  recordingGL::state().record=false;
+  __GLEW_VERSION_4_3=GL_TRUE;
+  ngl::VAOFactory::registerVAOCreator("simpleVAO",ngl::SimpleVAO::create);
+  s_shader=ngl::ShaderLib::instance();
+  s_prim=ngl::VAOPrimitives::instance();
+  const char *shaders[4]={"Phong","Colour","Toon","Diffuse"};
+  for(auto name : shaders)
+  {
+    s_shader->createShaderProgram(name);
+    s_shader->linkProgramObject(name);
+  }
+  s_prim->createSphere("sphere",1.0f,20);
+  s_prim->createCapsule("capsule",0.5f,2.0f,20);
+  s_prim->createCylinder("cylinder",0.5f,2.0f,20,4);
+  s_prim->createCone("cone",0.5f,2.0f,20,4);
+  s_prim->createDisk("disk",1.0f,20);
+  s_prim->createTorus("torus",0.2f,1.0f,20,20);
+  s_prim->createTrianglePlane("plane",1.0f,1.0f,4,4,ngl::Vec3(0.0f,1.0f,0.0f));
+  s_prim->createLineGrid("grid",2.0f,2.0f,8);
+  const char *primitives[8]={"sphere","capsule","cylinder","cone","disk","torus","plane","grid"};
+  ngl::BatchRenderer batch;
+  s_batch=&batch;
+  for(auto name : primitives)
+  {
+    batch.addFromPrimitives(name);
+  }
+  // objects in the order a scene might hold them, not sorted by shader or primitive
+  std::mt19937 rng(1234);
+  for(size_t i=0; i<s_objects; ++i)
+  {
+    Object o;
+    o.shader=shaders[rng()%2];
+    o.primitive=primitives[rng()%8];
+    o.program=s_shader->getProgramID(o.shader);
+    o.id=batch.getPrimitiveID(o.primitive);
+    o.model.translate(float(i%100),0.0f,float(i/100));
+    s_scene.push_back(o);
+  }
+  // 1000 single triangle primitives used by 10k instances with 4 shaders
+  ngl::BatchRenderer manyBatch;
+  s_manyBatch=&manyBatch;
+  std::vector<ngl::vertData> tri(3);
+  for(size_t p=0; p<1000; ++p)
+  {
+    manyBatch.addPrimitive("tri"+std::to_string(p),tri,GL_TRIANGLES);
+  }
+  for(size_t i=0; i<s_objects; ++i)
+  {
+    Object o;
+    o.program=s_shader->getProgramID(shaders[rng()%4]);
+    o.id=static_cast<int>(rng()%1000);
+    o.model.translate(float(i),0.0f,0.0f);
+    s_manyScene.push_back(o);
+  }
+
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+
+  std::cout<<"\n"<<s_objects<<" objects, 8 primitives, 2 shaders, per frame\n";
+  printf("%-26s %10s %10s %10s %10s\n","","draws","GL calls","bytes","ms");
+  report("per object",drawPerObject,s_objects);
+  report("batch, multi draw",drawBatch,0);
+  batch.setMultiDraw(false);
+  report("batch, instanced",drawBatch,0);
+
+  buildMany();
+  size_t commands=manyBatch.arraysCommands().size()+manyBatch.elementsCommands().size();
+  double time=bestTime(buildMany,20)*1e3;
+  std::cout<<"\nadd and build "<<s_objects<<" instances, 1000 primitives, 4 shaders: "<<commands<<" commands, "
+           <<manyBatch.groups().size()<<" groups in "<<time<<" ms, "<<commands/time<<" commands / ms, "
+           <<s_objects/time<<" instances / ms\n";
+  return result;
+}
@@ -0,0 +1,360 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/BatchRenderer.h>
+#include <ngl/Obj.h>
+#include <ngl/ShaderLib.h>
+#include <ngl/SimpleVAO.h>
+#include <ngl/VAOFactory.h>
+#include <ngl/VAOPrimitives.h>
+#include "../ShaderLib/recordingGL.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+int main(int argc, char **argv)
+{
+  // no OpenGL context is needed as the calls go to the recording stand in
+  recordingGL::install();
+  // NGLInit normally does this
+  ngl::VAOFactory::registerVAOCreator("simpleVAO",ngl::SimpleVAO::create);
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// a primitive of _numVerts vertices, the x of each position is _tag so the arena can be checked
+std::vector<ngl::vertData> makeVerts(size_t _numVerts, float _tag)
+{
+  std::vector<ngl::vertData> verts(_numVerts);
+  for(size_t i=0; i<_numVerts; ++i)
+  {
+    verts[i]={0.0f,0.0f,0.0f,1.0f,0.0f,_tag,float(i),0.0f};
+  }
+  return verts;
+}
+
+// instances are told apart by the x of their translation
+ngl::Mat4 tagged(float _tag)
+{
+  ngl::Mat4 m;
+  m.translate(_tag,0.0f,0.0f);
+  return m;
+}
+
+TEST(NGLBatchRenderer,addPrimitives)
+{
+  ngl::BatchRenderer batch;
+  EXPECT_EQ(batch.addPrimitive("tri",makeVerts(3,1.0f),GL_TRIANGLES),0);
+  EXPECT_EQ(batch.addPrimitive("lines",makeVerts(4,2.0f),GL_LINES),1);
+  std::vector<ngl::vertData> quad=makeVerts(4,3.0f);
+  std::vector<GLuint> indices={0,1,2,0,2,3};
+  EXPECT_EQ(batch.addPrimitive("quad",&quad[0].u,quad.size(),GL_TRIANGLES,indices.data(),indices.size()),2);
+  // names are unique and empty data is refused
+  EXPECT_EQ(batch.addPrimitive("tri",makeVerts(3,1.0f),GL_TRIANGLES),-1);
+  EXPECT_EQ(batch.addPrimitive("empty",std::vector<ngl::vertData>(),GL_TRIANGLES),-1);
+  EXPECT_EQ(batch.numPrimitives(),3u);
+  EXPECT_EQ(batch.getPrimitiveID("lines"),1);
+  EXPECT_EQ(batch.getPrimitiveID("notThere"),-1);
+
+  const ngl::BatchRenderer::Primitive &lines=batch.getPrimitive(1);
+  EXPECT_FALSE(lines.m_indexed);
+  EXPECT_EQ(lines.m_mode,GLenum(GL_LINES));
+  EXPECT_EQ(lines.m_first,3u);
+  EXPECT_EQ(lines.m_count,4u);
+  const ngl::BatchRenderer::Primitive &q=batch.getPrimitive(2);
+  EXPECT_TRUE(q.m_indexed);
+  EXPECT_EQ(q.m_first,0u);
+  EXPECT_EQ(q.m_count,6u);
+  EXPECT_EQ(q.m_baseVertex,7);
+  // all the vertices share the one arena
+  ASSERT_EQ(batch.vertices().size(),11u*8u);
+  EXPECT_FLOAT_EQ(batch.vertices()[3*8+5],2.0f);
+  EXPECT_FLOAT_EQ(batch.vertices()[7*8+5],3.0f);
+  EXPECT_EQ(batch.indices(),indices);
+}
+
+TEST(NGLBatchRenderer,commandsSortedByProgramAndPrimitive)
+{
+  ngl::BatchRenderer batch;
+  int tri=batch.addPrimitive("tri",makeVerts(3,1.0f),GL_TRIANGLES);
+  int lines=batch.addPrimitive("lines",makeVerts(2,2.0f),GL_LINES);
+  int box=batch.addPrimitive("box",makeVerts(6,3.0f),GL_TRIANGLES);
+  batch.begin();
+  // program 7 then 5, the primitives mixed up
+  batch.add(7,box,tagged(0));
+  batch.add(7,tri,tagged(1));
+  batch.add(5,lines,tagged(2));
+  batch.add(7,box,tagged(3));
+  batch.add(5,box,tagged(4));
+  batch.add(7,lines,tagged(5));
+  batch.add(7,tri,tagged(6));
+  batch.add(7,box,tagged(7));
+  EXPECT_EQ(batch.numInstances(),8u);
+  batch.build();
+
+  // ordered by program id then draw mode (GL_LINES is less than GL_TRIANGLES) then primitive, the instances of a
+  // primitive keep the order they were added in
+  std::vector<float> order;
+  for(auto &m : batch.transforms())
+  {
+    order.push_back(m.m_30);
+  }
+  EXPECT_EQ(order,std::vector<float>({2,4,5,1,6,0,3,7}));
+  const auto &groups=batch.groups();
+  ASSERT_EQ(groups.size(),4u);
+  EXPECT_EQ(groups[0].m_program,5u);
+  EXPECT_EQ(groups[0].m_mode,GLenum(GL_LINES));
+  EXPECT_EQ(groups[1].m_program,5u);
+  EXPECT_EQ(groups[1].m_mode,GLenum(GL_TRIANGLES));
+  EXPECT_EQ(groups[2].m_program,7u);
+  EXPECT_EQ(groups[2].m_mode,GLenum(GL_LINES));
+  EXPECT_EQ(groups[3].m_program,7u);
+  EXPECT_EQ(groups[3].m_mode,GLenum(GL_TRIANGLES));
+  EXPECT_EQ(groups[3].m_firstCommand,3u);
+  EXPECT_EQ(groups[3].m_numCommands,2u);
+
+  // one command per primitive per program pointing at its run of instances
+  const auto &commands=batch.arraysCommands();
+  ASSERT_EQ(commands.size(),5u);
+  const GLuint expected[5][4]=
+  {
+    {2,1,3,0}, // lines, program 5
+    {6,1,5,1}, // box, program 5
+    {2,1,3,2}, // lines, program 7
+    {3,2,0,3}, // tri, program 7
+    {6,3,5,5}  // box, program 7
+  };
+  for(size_t c=0; c<5; ++c)
+  {
+    EXPECT_EQ(commands[c].m_count,expected[c][0]);
+    EXPECT_EQ(commands[c].m_instanceCount,expected[c][1]);
+    EXPECT_EQ(commands[c].m_first,expected[c][2]);
+    EXPECT_EQ(commands[c].m_baseInstance,expected[c][3]);
+  }
+  EXPECT_TRUE(batch.elementsCommands().empty());
+
+  // begin starts a new frame
+  batch.begin();
+  batch.build();
+  EXPECT_TRUE(batch.groups().empty());
+  EXPECT_TRUE(batch.transforms().empty());
+}
+
+TEST(NGLBatchRenderer,indexedAndArraysApart)
+{
+  ngl::BatchRenderer batch;
+  std::vector<ngl::vertData> quad=makeVerts(4,1.0f);
+  std::vector<GLuint> indices={0,1,2,0,2,3};
+  int tri=batch.addPrimitive("tri",makeVerts(3,2.0f),GL_TRIANGLES);
+  int a=batch.addPrimitive("a",&quad[0].u,quad.size(),GL_TRIANGLES,indices.data(),indices.size());
+  int b=batch.addPrimitive("b",&quad[0].u,quad.size(),GL_TRIANGLES,indices.data(),indices.size());
+  batch.begin();
+  batch.add(1,b,tagged(0));
+  batch.add(1,tri,tagged(1));
+  batch.add(1,a,tagged(2));
+  batch.add(1,b,tagged(3));
+  // unknown ids are ignored
+  batch.add(1,12,tagged(4));
+  batch.build();
+  EXPECT_EQ(batch.numInstances(),4u);
+  ASSERT_EQ(batch.groups().size(),2u);
+  EXPECT_FALSE(batch.groups()[0].m_indexed);
+  EXPECT_TRUE(batch.groups()[1].m_indexed);
+  EXPECT_EQ(batch.groups()[1].m_firstCommand,0u);
+  EXPECT_EQ(batch.groups()[1].m_numCommands,2u);
+  const auto &commands=batch.elementsCommands();
+  ASSERT_EQ(commands.size(),2u);
+  EXPECT_EQ(commands[0].m_firstIndex,0u);
+  EXPECT_EQ(commands[0].m_baseVertex,3);
+  EXPECT_EQ(commands[0].m_instanceCount,1u);
+  EXPECT_EQ(commands[0].m_baseInstance,1u);
+  EXPECT_EQ(commands[1].m_firstIndex,6u);
+  EXPECT_EQ(commands[1].m_baseVertex,7);
+  EXPECT_EQ(commands[1].m_instanceCount,2u);
+  EXPECT_EQ(commands[1].m_baseInstance,2u);
+}
+
+TEST(NGLBatchRenderer,addMesh)
+{
+  {
+    std::ofstream out("batchCube.obj");
+    out<<"v -1 -1  1\nv  1 -1  1\nv  1  1  1\nv -1  1  1\n"
+         "v -1 -1 -1\nv  1 -1 -1\nv  1  1 -1\nv -1  1 -1\n"
+         "f 1 2 3 4\nf 6 5 8 7\nf 2 6 7 3\nf 5 1 4 8\nf 4 3 7 8\nf 5 6 2 1\n";
+  }
+  ngl::Obj mesh;
+  ASSERT_TRUE(mesh.load("batchCube.obj",false));
+  std::remove("batchCube.obj");
+  ngl::BatchRenderer batch;
+  batch.addPrimitive("tri",makeVerts(3,1.0f),GL_TRIANGLES);
+  int cube=batch.addMesh("cube",mesh);
+  ASSERT_EQ(cube,1);
+  const ngl::BatchRenderer::Primitive &p=batch.getPrimitive(cube);
+  EXPECT_TRUE(p.m_indexed);
+  EXPECT_EQ(p.m_count,36u);
+  EXPECT_EQ(p.m_baseVertex,3);
+  ASSERT_EQ(batch.vertices().size(),(3u+8u)*8u);
+  // the positions are those of the shared vertices
+  const auto &refs=mesh.getIndices();
+  const auto &verts=mesh.getVertexList();
+  for(size_t i=0; i<refs.size(); ++i)
+  {
+    const float *v=&batch.vertices()[(3+i)*8];
+    EXPECT_FLOAT_EQ(v[5],verts[refs[i].m_v].m_x);
+    EXPECT_FLOAT_EQ(v[6],verts[refs[i].m_v].m_y);
+    EXPECT_FLOAT_EQ(v[7],verts[refs[i].m_v].m_z);
+  }
+  EXPECT_EQ(batch.indices(),mesh.getOutIndices());
+}
+
+// a batch of a VAOPrimitives sphere and a line primitive drawn with two programs
+struct DrawScene
+{
+  ngl::BatchRenderer batch;
+  DrawScene()
+  {
+    ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+    if(ngl::VAOPrimitives::instance()->getVAOFromName("batchSphere")==nullptr)
+    {
+      shader->createShaderProgram("BatchA");
+      shader->linkProgramObject("BatchA");
+      shader->createShaderProgram("BatchB");
+      shader->linkProgramObject("BatchB");
+      ngl::VAOPrimitives::instance()->createSphere("batchSphere",1.0f,8);
+    }
+    batch.addFromPrimitives("batchSphere");
+    std::vector<ngl::vertData> quad=makeVerts(4,1.0f);
+    std::vector<GLuint> indices={0,1,2,0,2,3};
+    batch.addPrimitive("quad",&quad[0].u,quad.size(),GL_TRIANGLES,indices.data(),indices.size());
+  }
+  void frame()
+  {
+    batch.begin();
+    for(int i=0; i<10; ++i)
+    {
+      batch.add(i%2 ? "BatchA" : "BatchB",i%3 ? "batchSphere" : "quad",tagged(float(i)));
+    }
+    batch.draw();
+  }
+};
+
+TEST(NGLBatchRenderer,fromPrimitives)
+{
+  ngl::BatchRenderer batch;
+  ngl::VAOPrimitives *prim=ngl::VAOPrimitives::instance();
+  prim->createSphere("batchFromSphere",2.0f,10);
+  EXPECT_EQ(batch.addFromPrimitives("batchFromSphere"),0);
+  EXPECT_EQ(batch.addFromPrimitives("notAPrimitive"),-1);
+  ngl::AbstractVAO *vao=prim->getVAOFromName("batchFromSphere");
+  const ngl::BatchRenderer::Primitive &p=batch.getPrimitive(0);
+  EXPECT_EQ(p.m_count,vao->numIndices());
+  EXPECT_EQ(p.m_mode,vao->getMode());
+  // the data read back is what VAOPrimitives sent
+  const auto &buffer=recordingGL::state().buffers[vao->getBufferID(0)];
+  ASSERT_EQ(buffer.size(),batch.vertices().size()*sizeof(float));
+  EXPECT_EQ(std::memcmp(buffer.data(),batch.vertices().data(),buffer.size()),0);
+}
+
+TEST(NGLBatchRenderer,multiDrawIndirect)
+{
+  __GLEW_VERSION_4_3=GL_TRUE;
+  DrawScene scene;
+  auto &state=recordingGL::state();
+  state.draws.clear();
+  scene.frame();
+  ngl::BatchRenderer &batch=scene.batch;
+  EXPECT_TRUE(batch.multiDraw());
+  // one draw per program and mode
+  ASSERT_EQ(state.draws.size(),batch.groups().size());
+  ASSERT_EQ(state.draws.size(),4u);
+  size_t arraysBytes=batch.arraysCommands().size()*sizeof(ngl::DrawArraysIndirectCommand);
+  for(size_t g=0; g<4; ++g)
+  {
+    const recordingGL::Draw &d=state.draws[g];
+    const ngl::BatchRenderer::Group &group=batch.groups()[g];
+    EXPECT_EQ(d.program,group.m_program);
+    EXPECT_EQ(d.drawCount,GLsizei(group.m_numCommands));
+    if(group.m_indexed)
+    {
+      EXPECT_STREQ(d.func,"glMultiDrawElementsIndirect");
+      EXPECT_EQ(d.offset,arraysBytes+group.m_firstCommand*sizeof(ngl::DrawElementsIndirectCommand));
+    }
+    else
+    {
+      EXPECT_STREQ(d.func,"glMultiDrawArraysIndirect");
+      EXPECT_EQ(d.offset,group.m_firstCommand*sizeof(ngl::DrawArraysIndirectCommand));
+    }
+  }
+  GLuint vao=state.draws[0].vao;
+  // the command buffer holds the arrays then the elements commands
+  const auto &commands=state.buffers[state.boundBuffers[GL_DRAW_INDIRECT_BUFFER]];
+  ASSERT_EQ(commands.size(),arraysBytes+batch.elementsCommands().size()*sizeof(ngl::DrawElementsIndirectCommand));
+  EXPECT_EQ(std::memcmp(commands.data(),batch.arraysCommands().data(),arraysBytes),0);
+  EXPECT_EQ(std::memcmp(&commands[arraysBytes],batch.elementsCommands().data(),commands.size()-arraysBytes),0);
+  // the transforms are read one per instance from attributes 3 to 6
+  auto &attributes=state.attributes[vao];
+  for(GLuint a=3; a<7; ++a)
+  {
+    EXPECT_TRUE(attributes[a].enabled);
+    EXPECT_EQ(attributes[a].divisor,1u);
+    EXPECT_EQ(attributes[a].size,4);
+    EXPECT_EQ(attributes[a].stride,GLsizei(sizeof(ngl::Mat4)));
+    EXPECT_EQ(attributes[a].offset,(a-3)*4*sizeof(float));
+  }
+  const auto &transforms=state.buffers[attributes[3].buffer];
+  ASSERT_EQ(transforms.size(),10*sizeof(ngl::Mat4));
+  EXPECT_EQ(std::memcmp(transforms.data(),batch.transforms().data(),transforms.size()),0);
+  EXPECT_EQ(attributes[0].divisor,0u);
+  EXPECT_EQ(state.buffers[attributes[0].buffer].size(),batch.vertices().size()*sizeof(float));
+
+  // the arena is only sent once
+  batch.resetStats();
+  scene.frame();
+  EXPECT_EQ(batch.stats().m_bytesUploaded,transforms.size()+commands.size());
+  EXPECT_EQ(batch.stats().m_drawCalls,4u);
+  EXPECT_EQ(batch.stats().m_instances,10u);
+}
+
+TEST(NGLBatchRenderer,instancedFallback)
+{
+  __GLEW_VERSION_4_3=GL_FALSE;
+  DrawScene scene;
+  auto &state=recordingGL::state();
+  state.draws.clear();
+  scene.frame();
+  ngl::BatchRenderer &batch=scene.batch;
+  EXPECT_FALSE(batch.multiDraw());
+  // one instanced draw per command
+  size_t numCommands=batch.arraysCommands().size()+batch.elementsCommands().size();
+  ASSERT_EQ(state.draws.size(),numCommands);
+  size_t draw=0;
+  for(auto &g : batch.groups())
+  {
+    for(size_t c=g.m_firstCommand; c<g.m_firstCommand+g.m_numCommands; ++c, ++draw)
+    {
+      const recordingGL::Draw &d=state.draws[draw];
+      EXPECT_EQ(d.program,g.m_program);
+      EXPECT_EQ(d.mode,g.m_mode);
+      if(g.m_indexed)
+      {
+        const ngl::DrawElementsIndirectCommand &command=batch.elementsCommands()[c];
+        EXPECT_STREQ(d.func,"glDrawElementsInstancedBaseVertex");
+        EXPECT_EQ(d.count,GLsizei(command.m_count));
+        EXPECT_EQ(d.instances,GLsizei(command.m_instanceCount));
+        EXPECT_EQ(d.baseVertex,command.m_baseVertex);
+        EXPECT_EQ(d.offset,command.m_firstIndex*sizeof(GLuint));
+      }
+      else
+      {
+        const ngl::DrawArraysIndirectCommand &command=batch.arraysCommands()[c];
+        EXPECT_STREQ(d.func,"glDrawArraysInstanced");
+        EXPECT_EQ(d.first,GLint(command.m_first));
+        EXPECT_EQ(d.count,GLsizei(command.m_count));
+        EXPECT_EQ(d.instances,GLsizei(command.m_instanceCount));
+      }
+    }
+  }
+  EXPECT_EQ(batch.stats().m_drawCalls,numCommands);
+}
@@ -0,0 +1,116 @@
+#include <ngl/BatchTransform.h>
+#include <ngl/Mat3.h>
+#include <ngl/Mat4.h>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+// transforms 1k, 100k and 10M points by one matrix using a loop of Vec4 * Mat4 (what the mesh code does
+// now) and the batch functions for Vec3 arrays (AoS) and separate x,y,z arrays (SoA). Hayai reports the
+// time per call, the table at the end gives the points / second of each.
+static const size_t s_maxPoints=10000000;
+
+static std::vector<ngl::Vec3> s_points;
+static std::vector<ngl::Vec3> s_out;
+static std::vector<ngl::Real> s_x,s_y,s_z;
+static std::vector<ngl::Real> s_ox,s_oy,s_oz;
+static ngl::Mat4 s_matrix;
+static ngl::Mat3 s_normalMatrix;
+
+void scalarLoop(size_t _n)
+{
+  for(size_t i=0; i<_n; ++i)
+  {
+    const ngl::Vec3 &p=s_points[i];
+    s_out[i]=(ngl::Vec4(p.m_x,p.m_y,p.m_z,1.0f)*s_matrix).toVec3();
+  }
+}
+
+void batchAoS(size_t _n)
+{
+  ngl::transformPoints(s_matrix,s_points.data(),s_out.data(),_n);
+}
+
+void batchSoA(size_t _n)
+{
+  ngl::transformPoints(s_matrix,s_x.data(),s_y.data(),s_z.data(),s_ox.data(),s_oy.data(),s_oz.data(),_n);
+}
+
+void batchNormals(size_t _n)
+{
+  ngl::transformNormals(s_normalMatrix,s_points.data(),s_out.data(),_n);
+}
+
+#define TRANSFORM_BENCHMARKS(N,RUNS,ITERATIONS) \
+BENCHMARK(Transform##N, ScalarLoop, RUNS, ITERATIONS) { scalarLoop(N); } \
+BENCHMARK(Transform##N, BatchAoS, RUNS, ITERATIONS) { batchAoS(N); } \
+BENCHMARK(Transform##N, BatchSoA, RUNS, ITERATIONS) { batchSoA(N); } \
+BENCHMARK(Transform##N, BatchNormals, RUNS, ITERATIONS) { batchNormals(N); }
+
+TRANSFORM_BENCHMARKS(1000,10,1000)
+TRANSFORM_BENCHMARKS(100000,10,10)
+TRANSFORM_BENCHMARKS(10000000,5,1)
+
+double pointsPerSecond(void (*_func)(size_t), size_t _n)
+{
+  size_t iterations=std::max<size_t>(1,s_maxPoints/_n);
+  double best=1e30;
+  for(int run=0; run<5; ++run)
+  {
+    auto start=std::chrono::high_resolution_clock::now();
+    for(size_t i=0; i<iterations; ++i)
+    {
+      _func(_n);
+    }
+    std::chrono::duration<double> time=std::chrono::high_resolution_clock::now()-start;
+    best=std::min(best,time.count()/iterations);
+  }
+  return _n/best;
+}
+
+
+int main(int argc, char **argv)
+{
+  s_points.resize(s_maxPoints);
+  s_out.resize(s_maxPoints);
+  s_x.resize(s_maxPoints);
+  s_y.resize(s_maxPoints);
+  s_z.resize(s_maxPoints);
+  s_ox.resize(s_maxPoints);
+  s_oy.resize(s_maxPoints);
+  s_oz.resize(s_maxPoints);
+  for(size_t i=0; i<s_maxPoints; ++i)
+  {
+    s_points[i].set(i%1000*0.01f,(i/1000)%1000*0.01f,i*1e-6f);
+    s_x[i]=s_points[i].m_x;
+    s_y[i]=s_points[i].m_y;
+    s_z[i]=s_points[i].m_z;
+  }
+  ngl::Mat4 rotate;
+  rotate.euler(35.0f,0.2f,1.0f,0.4f);
+  ngl::Mat4 translate;
+  translate.translate(1.0f,2.0f,3.0f);
+  s_matrix=rotate*translate;
+  s_normalMatrix=ngl::Mat3(rotate);
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+
+  std::cout<<"\nmillion points / second\n";
+  printf("%10s %12s %12s %12s %12s\n","points","ScalarLoop","BatchAoS","BatchSoA","BatchNormals");
+  for(size_t n : {size_t(1000),size_t(100000),s_maxPoints})
+  {
+    printf("%10zu %12.1f %12.1f %12.1f %12.1f\n",n,pointsPerSecond(scalarLoop,n)*1e-6,pointsPerSecond(batchAoS,n)*1e-6,
+           pointsPerSecond(batchSoA,n)*1e-6,pointsPerSecond(batchNormals,n)*1e-6);
+  }
+  return result;
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/BatchTransform.h>
+#include <ngl/Mat3.h>
+#include <ngl/Mat4.h>
+#include <vector>
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// 11 points so both the SIMD loop and the remainder are used
+static const size_t s_count=11;
+
+ngl::Mat4 testMatrix()
+{
+  ngl::Mat4 rx;
+  rx.rotateX(30.0f);
+  ngl::Mat4 ry;
+  ry.rotateY(-45.0f);
+  ngl::Mat4 s;
+  s.scale(2.0f,0.5f,3.0f);
+  ngl::Mat4 t;
+  t.translate(1.0f,-2.0f,3.0f);
+  return s*rx*ry*t;
+}
+
+std::vector<ngl::Vec3> testPoints()
+{
+  std::vector<ngl::Vec3> points;
+  for(size_t i=0; i<s_count; ++i)
+  {
+    points.push_back(ngl::Vec3(i*0.5f-2.0f,1.0f-i*0.25f,i*i*0.1f));
+  }
+  return points;
+}
+
+void expectVec3(const ngl::Vec3 &_a, const ngl::Vec3 &_b)
+{
+  EXPECT_NEAR(_a.m_x,_b.m_x,1e-4f);
+  EXPECT_NEAR(_a.m_y,_b.m_y,1e-4f);
+  EXPECT_NEAR(_a.m_z,_b.m_z,1e-4f);
+}
+
+TEST(NGLBatchTransform,Points)
+{
+  ngl::Mat4 m=testMatrix();
+  auto in=testPoints();
+  std::vector<ngl::Vec3> out(in.size());
+  ngl::transformPoints(m,in.data(),out.data(),in.size());
+  for(size_t i=0; i<in.size(); ++i)
+  {
+    ngl::Vec4 p=ngl::Vec4(in[i].m_x,in[i].m_y,in[i].m_z,1.0f)*m;
+    expectVec3(out[i],p.toVec3());
+  }
+  // in place must give the same result
+  ngl::transformPoints(m,in.data(),in.data(),in.size());
+  for(size_t i=0; i<in.size(); ++i)
+  {
+    expectVec3(in[i],out[i]);
+  }
+}
+
+TEST(NGLBatchTransform,Directions)
+{
+  ngl::Mat4 m=testMatrix();
+  auto in=testPoints();
+  std::vector<ngl::Vec3> out(in.size());
+  ngl::transformDirections(m,in.data(),out.data(),in.size());
+  for(size_t i=0; i<in.size(); ++i)
+  {
+    ngl::Vec4 p=ngl::Vec4(in[i].m_x,in[i].m_y,in[i].m_z,0.0f)*m;
+    expectVec3(out[i],p.toVec3());
+  }
+}
+
+TEST(NGLBatchTransform,Vectors)
+{
+  ngl::Mat4 m=testMatrix();
+  std::vector<ngl::Vec4> in;
+  for(auto p : testPoints())
+  {
+    in.push_back(ngl::Vec4(p.m_x,p.m_y,p.m_z,p.m_x*0.5f));
+  }
+  std::vector<ngl::Vec4> out(in.size());
+  ngl::transformVectors(m,in.data(),out.data(),in.size());
+  for(size_t i=0; i<in.size(); ++i)
+  {
+    EXPECT_TRUE(out[i]==in[i]*m);
+  }
+}
+
+TEST(NGLBatchTransform,Normals)
+{
+  ngl::Mat4 m=testMatrix();
+  ngl::Mat3 normalMatrix(m);
+  normalMatrix.inverse();
+  normalMatrix.transpose();
+  auto in=testPoints();
+  in[3].null();
+  std::vector<ngl::Vec3> out(in.size());
+  ngl::transformNormals(normalMatrix,in.data(),out.data(),in.size());
+  for(size_t i=0; i<in.size(); ++i)
+  {
+    ngl::Vec3 n=in[i]*normalMatrix;
+    if(i==3)
+    {
+      // zero length normals stay zero rather than becoming NaN
+      expectVec3(out[i],ngl::Vec3(0.0f,0.0f,0.0f));
+    }
+    else
+    {
+      n.normalize();
+      expectVec3(out[i],n);
+    }
+  }
+  ngl::transformNormals(normalMatrix,in.data(),out.data(),in.size(),false);
+  for(size_t i=0; i<in.size(); ++i)
+  {
+    expectVec3(out[i],in[i]*normalMatrix);
+  }
+}
+
+TEST(NGLBatchTransform,SoA)
+{
+  ngl::Mat4 m=testMatrix();
+  auto in=testPoints();
+  std::vector<ngl::Real> x,y,z;
+  for(auto p : in)
+  {
+    x.push_back(p.m_x);
+    y.push_back(p.m_y);
+    z.push_back(p.m_z);
+  }
+  std::vector<ngl::Vec3> expected(in.size());
+  ngl::transformPoints(m,in.data(),expected.data(),in.size());
+  std::vector<ngl::Real> ox(in.size()),oy(in.size()),oz(in.size());
+  ngl::transformPoints(m,x.data(),y.data(),z.data(),ox.data(),oy.data(),oz.data(),in.size());
+  for(size_t i=0; i<in.size(); ++i)
+  {
+    expectVec3(ngl::Vec3(ox[i],oy[i],oz[i]),expected[i]);
+  }
+  ngl::transformDirections(m,in.data(),expected.data(),in.size());
+  ngl::transformDirections(m,x.data(),y.data(),z.data(),x.data(),y.data(),z.data(),in.size());
+  for(size_t i=0; i<in.size(); ++i)
+  {
+    expectVec3(ngl::Vec3(x[i],y[i],z[i]),expected[i]);
+  }
+}
+
+TEST(NGLBatchTransform,Empty)
+{
+  ngl::Mat4 m=testMatrix();
+  ngl::transformPoints(m,static_cast<ngl::Vec3 *>(nullptr),nullptr,0);
+  ngl::transformVectors(m,nullptr,nullptr,0);
+}
@@ -0,0 +1,132 @@
+#include <ngl/BoundingVolume.h>
+#include <ngl/Vec3.h>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// bounds of a million vertex mesh, the serial loops AbstractMesh used to run (center twice, the extents
+// then a Ritter sphere) against calcBoundingVolume on one thread and on all cores.
+static const size_t s_numVerts=1000000;
+
+static std::vector<ngl::Vec3> s_verts;
+static ngl::BoundingVolume s_result;
+
+void serialLoops()
+{
+  ngl::BoundingVolume &b=s_result;
+  for(int pass=0; pass<2; ++pass)
+  {
+    b.m_centroid=0.0f;
+    for(auto v : s_verts)
+    {
+      b.m_centroid+=v;
+    }
+    b.m_centroid/=s_verts.size();
+  }
+  b.m_min=b.m_max=b.m_centroid;
+  for(auto v : s_verts)
+  {
+    if     (v.m_x >b.m_max.m_x) { b.m_max.m_x=v.m_x; }
+    else if(v.m_x <b.m_min.m_x) { b.m_min.m_x=v.m_x; }
+    if     (v.m_y >b.m_max.m_y) { b.m_max.m_y=v.m_y; }
+    else if(v.m_y <b.m_min.m_y) { b.m_min.m_y=v.m_y; }
+    if     (v.m_z >b.m_max.m_z) { b.m_max.m_z=v.m_z; }
+    else if(v.m_z <b.m_min.m_z) { b.m_min.m_z=v.m_z; }
+  }
+  // Ritter sphere, initial sphere from the most separated pair of axis extremes then grown
+  size_t lo[3]={0,0,0},hi[3]={0,0,0};
+  for(size_t i=0; i<s_verts.size(); ++i)
+  {
+    for(int c=0; c<3; ++c)
+    {
+      if(s_verts[i].m_openGL[c]<s_verts[lo[c]].m_openGL[c]) { lo[c]=i; }
+      if(s_verts[i].m_openGL[c]>s_verts[hi[c]].m_openGL[c]) { hi[c]=i; }
+    }
+  }
+  int axis=0;
+  for(int c=1; c<3; ++c)
+  {
+    if((s_verts[hi[c]]-s_verts[lo[c]]).lengthSquared()>(s_verts[hi[axis]]-s_verts[lo[axis]]).lengthSquared()) { axis=c; }
+  }
+  ngl::Vec3 center=(s_verts[lo[axis]]+s_verts[hi[axis]])*0.5f;
+  ngl::Real rad=(s_verts[hi[axis]]-center).length();
+  for(auto v : s_verts)
+  {
+    ngl::Real dist2=(v-center).lengthSquared();
+    if(dist2>rad*rad)
+    {
+      ngl::Real dist=std::sqrt(dist2);
+      ngl::Real newRad=(rad+dist)*0.5f;
+      center=(center*newRad+v*(dist-newRad))/dist;
+      rad=newRad;
+    }
+  }
+  b.m_sphereCenter=center;
+  b.m_sphereRadius=rad;
+}
+
+void singleThread()
+{
+  s_result=ngl::calcBoundingVolume(s_verts.data(),s_verts.size(),1);
+}
+
+void allThreads()
+{
+  s_result=ngl::calcBoundingVolume(s_verts.data(),s_verts.size(),0);
+}
+
+BENCHMARK(Bounds, SerialLoops, 10, 10) { serialLoops(); }
+BENCHMARK(Bounds, SingleThread, 10, 10) { singleThread(); }
+BENCHMARK(Bounds, AllThreads, 10, 10) { allThreads(); }
+
+double bestTime(void (*_func)())
+{
+  double best=1e30;
+  for(int run=0; run<10; ++run)
+  {
+    auto start=std::chrono::high_resolution_clock::now();
+    _func();
+    std::chrono::duration<double> time=std::chrono::high_resolution_clock::now()-start;
+    best=std::min(best,time.count());
+  }
+  return best;
+}
+
+
+int main(int argc, char **argv)
+{
+  // a lumpy sphere of points
+  s_verts.resize(s_numVerts);
+  for(size_t i=0; i<s_numVerts; ++i)
+  {
+    float u=i*0.618034f;
+    float v=i*0.0001f;
+    float r=1.0f+0.2f*std::sin(u*7.0f);
+    s_verts[i].set(r*std::cos(u)*std::sin(v)+0.5f,r*std::cos(v),r*std::sin(u)*std::sin(v)*2.0f);
+  }
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+
+  std::cout<<"\n"<<s_numVerts<<" verts, "<<std::thread::hardware_concurrency()<<" cores\n";
+  printf("%14s %10s %10s\n","","ms","radius");
+  serialLoops();
+  printf("%14s %10.2f %10.4f\n","SerialLoops",bestTime(serialLoops)*1e3,s_result.m_sphereRadius);
+  singleThread();
+  printf("%14s %10.2f %10.4f\n","SingleThread",bestTime(singleThread)*1e3,s_result.m_sphereRadius);
+  allThreads();
+  printf("%14s %10.2f %10.4f\n","AllThreads",bestTime(allThreads)*1e3,s_result.m_sphereRadius);
+  return result;
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/BoundingVolume.h>
+#include <ngl/Vec3Array.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// a lop sided cloud with the extremes of each axis at different points
+std::vector<ngl::Vec3> testPoints(size_t _n)
+{
+  std::vector<ngl::Vec3> points;
+  for(size_t i=0; i<_n; ++i)
+  {
+    float t=i*0.37f;
+    points.push_back(ngl::Vec3(std::sin(t)*3.0f+1.0f,std::cos(t*1.3f)*0.5f-2.0f,(i%97)*0.01f*(i%5)));
+  }
+  return points;
+}
+
+void bruteForce(const std::vector<ngl::Vec3> &_points, ngl::Vec3 &o_min, ngl::Vec3 &o_max, ngl::Vec3 &o_centroid)
+{
+  o_min=o_max=_points[0];
+  double sum[3]={0.0,0.0,0.0};
+  for(auto &p : _points)
+  {
+    o_min.set(std::min(o_min.m_x,p.m_x),std::min(o_min.m_y,p.m_y),std::min(o_min.m_z,p.m_z));
+    o_max.set(std::max(o_max.m_x,p.m_x),std::max(o_max.m_y,p.m_y),std::max(o_max.m_z,p.m_z));
+    sum[0]+=p.m_x;
+    sum[1]+=p.m_y;
+    sum[2]+=p.m_z;
+  }
+  o_centroid.set(sum[0]/_points.size(),sum[1]/_points.size(),sum[2]/_points.size());
+}
+
+void checkSphere(const std::vector<ngl::Vec3> &_points, const ngl::BoundingVolume &_b)
+{
+  for(auto &p : _points)
+  {
+    EXPECT_LE((p-_b.m_sphereCenter).length(),_b.m_sphereRadius*1.0001f);
+  }
+  // never bigger than the sphere around the box
+  EXPECT_LE(_b.m_sphereRadius,(_b.m_max-_b.m_min).length()*0.5f*1.0001f);
+}
+
+TEST(NGLBoundingVolume,empty)
+{
+  ngl::BoundingVolume b=ngl::calcBoundingVolume(nullptr,0);
+  EXPECT_TRUE(b.m_min==ngl::Vec3(0.0f,0.0f,0.0f));
+  EXPECT_TRUE(b.m_max==ngl::Vec3(0.0f,0.0f,0.0f));
+  EXPECT_FLOAT_EQ(b.m_sphereRadius,0.0f);
+}
+
+TEST(NGLBoundingVolume,singlePoint)
+{
+  ngl::Vec3 p(1.0f,2.0f,3.0f);
+  ngl::BoundingVolume b=ngl::calcBoundingVolume(&p,1);
+  EXPECT_TRUE(b.m_min==p);
+  EXPECT_TRUE(b.m_max==p);
+  EXPECT_TRUE(b.m_centroid==p);
+  EXPECT_TRUE(b.m_sphereCenter==p);
+  EXPECT_FLOAT_EQ(b.m_sphereRadius,0.0f);
+}
+
+TEST(NGLBoundingVolume,small)
+{
+  // 11 points so both the SIMD loop and the remainder are used
+  std::vector<ngl::Vec3> points=testPoints(11);
+  ngl::Vec3 lo,hi,centroid;
+  bruteForce(points,lo,hi,centroid);
+  ngl::BoundingVolume b=ngl::calcBoundingVolume(points.data(),points.size());
+  EXPECT_TRUE(b.m_min==lo);
+  EXPECT_TRUE(b.m_max==hi);
+  EXPECT_TRUE(b.m_centroid==centroid);
+  checkSphere(points,b);
+}
+
+TEST(NGLBoundingVolume,extremesAtEnds)
+{
+  // the smallest and largest values in the first and last points
+  std::vector<ngl::Vec3> points=testPoints(23);
+  points.front().set(-10.0f,20.0f,-30.0f);
+  points.back().set(10.0f,-20.0f,30.0f);
+  ngl::BoundingVolume b=ngl::calcBoundingVolume(points.data(),points.size());
+  EXPECT_TRUE(b.m_min==ngl::Vec3(-10.0f,-20.0f,-30.0f));
+  EXPECT_TRUE(b.m_max==ngl::Vec3(10.0f,20.0f,30.0f));
+  checkSphere(points,b);
+}
+
+TEST(NGLBoundingVolume,threaded)
+{
+  // enough points to be split over several threads and an odd count for the remainder
+  std::vector<ngl::Vec3> points=testPoints(1000003);
+  points[777777].set(50.0f,-50.0f,50.0f);
+  ngl::Vec3 lo,hi,centroid;
+  bruteForce(points,lo,hi,centroid);
+  ngl::BoundingVolume single=ngl::calcBoundingVolume(points.data(),points.size(),1);
+  ngl::BoundingVolume multi=ngl::calcBoundingVolume(points.data(),points.size(),4);
+  for(auto b : {single,multi})
+  {
+    EXPECT_TRUE(b.m_min==lo);
+    EXPECT_TRUE(b.m_max==hi);
+    EXPECT_NEAR(b.m_centroid.m_x,centroid.m_x,1e-4f);
+    EXPECT_NEAR(b.m_centroid.m_y,centroid.m_y,1e-4f);
+    EXPECT_NEAR(b.m_centroid.m_z,centroid.m_z,1e-4f);
+    checkSphere(points,b);
+  }
+  EXPECT_FLOAT_EQ(single.m_sphereRadius,multi.m_sphereRadius);
+}
+
+TEST(NGLBoundingVolume,vec3Array)
+{
+  std::vector<ngl::Vec3> points=testPoints(101);
+  ngl::BoundingVolume aos=ngl::calcBoundingVolume(points.data(),points.size());
+  ngl::BoundingVolume soa=ngl::calcBoundingVolume(ngl::Vec3Array(points));
+  EXPECT_TRUE(aos.m_min==soa.m_min);
+  EXPECT_TRUE(aos.m_max==soa.m_max);
+  EXPECT_TRUE(aos.m_centroid==soa.m_centroid);
+  EXPECT_TRUE(aos.m_sphereCenter==soa.m_sphereCenter);
+  EXPECT_FLOAT_EQ(aos.m_sphereRadius,soa.m_sphereRadius);
+}
@@ -0,0 +1,125 @@
+#include <ngl/Camera.h>
+#include <ngl/AABB.h>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+// culls 100k spheres and boxes against the camera frustum, one at a time with isSphereInFrustum /
+// boxInFrustum and with the batch functions on one thread and on all cores. Runs without a GL context,
+// the table at the end gives the million objects culled / second of each.
+static const size_t s_count=100000;
+
+static ngl::Camera s_camera;
+static std::vector<ngl::Real> s_x,s_y,s_z,s_radius;
+static std::vector<ngl::Real> s_maxX,s_maxY,s_maxZ;
+static std::vector<ngl::AABB> s_boxes;
+static std::vector<uint32_t> s_visible;
+
+void sphereLoop()
+{
+  s_visible.clear();
+  for(size_t i=0; i<s_count; ++i)
+  {
+    if(s_camera.isSphereInFrustum(ngl::Vec3(s_x[i],s_y[i],s_z[i]),s_radius[i])!=ngl::CameraIntercept::OUTSIDE)
+    {
+      s_visible.push_back(i);
+    }
+  }
+}
+
+void sphereBatch()
+{
+  s_camera.spheresInFrustum(s_x.data(),s_y.data(),s_z.data(),s_radius.data(),s_count,s_visible,1);
+}
+
+void sphereThreads()
+{
+  s_camera.spheresInFrustum(s_x.data(),s_y.data(),s_z.data(),s_radius.data(),s_count,s_visible,0);
+}
+
+void boxLoop()
+{
+  s_visible.clear();
+  for(size_t i=0; i<s_count; ++i)
+  {
+    if(s_camera.boxInFrustum(s_boxes[i])!=ngl::CameraIntercept::OUTSIDE)
+    {
+      s_visible.push_back(i);
+    }
+  }
+}
+
+void boxBatch()
+{
+  s_camera.boxesInFrustum(s_x.data(),s_y.data(),s_z.data(),s_maxX.data(),s_maxY.data(),s_maxZ.data(),s_count,s_visible,1);
+}
+
+void boxThreads()
+{
+  s_camera.boxesInFrustum(s_x.data(),s_y.data(),s_z.data(),s_maxX.data(),s_maxY.data(),s_maxZ.data(),s_count,s_visible,0);
+}
+
+BENCHMARK(Spheres, Loop, 10, 10) { sphereLoop(); }
+BENCHMARK(Spheres, Batch, 10, 10) { sphereBatch(); }
+BENCHMARK(Spheres, BatchThreads, 10, 10) { sphereThreads(); }
+BENCHMARK(Boxes, Loop, 10, 10) { boxLoop(); }
+BENCHMARK(Boxes, Batch, 10, 10) { boxBatch(); }
+BENCHMARK(Boxes, BatchThreads, 10, 10) { boxThreads(); }
+
+double perSecond(void (*_func)())
+{
+  double best=1e30;
+  for(int run=0; run<10; ++run)
+  {
+    auto start=std::chrono::high_resolution_clock::now();
+    for(int i=0; i<10; ++i)
+    {
+      _func();
+    }
+    std::chrono::duration<double> time=std::chrono::high_resolution_clock::now()-start;
+    best=std::min(best,time.count()/10);
+  }
+  return s_count/best;
+}
+
+
+int main(int argc, char **argv)
+{
+  s_camera.set(ngl::Vec3(2.0f,3.0f,10.0f),ngl::Vec3(0.0f,0.0f,-20.0f),ngl::Vec3(0.0f,1.0f,0.0f));
+  s_camera.setShape(45.0f,1.5f,0.5f,80.0f);
+  s_camera.calculateFrustum();
+  for(size_t i=0; i<s_count; ++i)
+  {
+    ngl::Real t=i*0.618034f;
+    s_x.push_back((t-int(t))*200.0f-100.0f);
+    t=i*0.7548776f;
+    s_y.push_back((t-int(t))*100.0f-50.0f);
+    t=i*0.5698403f;
+    s_z.push_back((t-int(t))*200.0f-150.0f);
+    s_radius.push_back(0.5f+(i%7)*0.5f);
+    s_maxX.push_back(s_x.back()+s_radius.back());
+    s_maxY.push_back(s_y.back()+s_radius.back());
+    s_maxZ.push_back(s_z.back()+s_radius.back());
+    s_boxes.push_back(ngl::AABB(ngl::Vec4(s_x[i],s_y[i],s_z[i]),s_radius[i],s_radius[i],s_radius[i]));
+  }
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+
+  sphereBatch();
+  std::cout<<"\n"<<s_count<<" objects, "<<s_visible.size()<<" visible\nmillion objects / second\n";
+  printf("%10s %12s %12s %12s\n","","Loop","Batch","BatchThreads");
+  printf("%10s %12.1f %12.1f %12.1f\n","Spheres",perSecond(sphereLoop)*1e-6,perSecond(sphereBatch)*1e-6,perSecond(sphereThreads)*1e-6);
+  printf("%10s %12.1f %12.1f %12.1f\n","Boxes",perSecond(boxLoop)*1e-6,perSecond(boxBatch)*1e-6,perSecond(boxThreads)*1e-6);
+  return result;
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/Camera.h>
+#include <ngl/AABB.h>
+#include <vector>
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// objects scattered around the camera so some are inside, some outside and some cross the planes
+struct Objects
+{
+  std::vector<ngl::Real> m_x,m_y,m_z,m_radius;
+  std::vector<ngl::Real> m_maxX,m_maxY,m_maxZ;
+  explicit Objects(size_t _n)
+  {
+    for(size_t i=0; i<_n; ++i)
+    {
+      // a cheap repeatable spread
+      ngl::Real t=i*0.618034f;
+      m_x.push_back((t-int(t))*80.0f-40.0f);
+      t=i*0.7548776f;
+      m_y.push_back((t-int(t))*60.0f-30.0f);
+      t=i*0.5698403f;
+      m_z.push_back((t-int(t))*120.0f-100.0f);
+      m_radius.push_back(0.5f+(i%7)*0.75f);
+      m_maxX.push_back(m_x.back()+m_radius.back()*2.0f);
+      m_maxY.push_back(m_y.back()+m_radius.back());
+      m_maxZ.push_back(m_z.back()+m_radius.back()*1.5f);
+    }
+  }
+};
+
+ngl::Camera testCamera()
+{
+  ngl::Camera cam(ngl::Vec3(2.0f,3.0f,10.0f),ngl::Vec3(0.0f,0.0f,-20.0f),ngl::Vec3(0.0f,1.0f,0.0f));
+  cam.setShape(45.0f,1.5f,0.5f,80.0f);
+  cam.calculateFrustum();
+  return cam;
+}
+
+TEST(NGLCamera,spheresInFrustum)
+{
+  // 1001 so the SIMD loop, the remainder and a part filled mask word are used
+  const size_t n=1001;
+  Objects o(n);
+  ngl::Camera cam=testCamera();
+  std::vector<uint32_t> mask((n+31)/32);
+  cam.spheresInFrustum(o.m_x.data(),o.m_y.data(),o.m_z.data(),o.m_radius.data(),n,mask.data());
+  std::vector<uint32_t> visible;
+  cam.spheresInFrustum(o.m_x.data(),o.m_y.data(),o.m_z.data(),o.m_radius.data(),n,visible);
+  std::vector<uint32_t> expected;
+  for(size_t i=0; i<n; ++i)
+  {
+    bool in=cam.isSphereInFrustum(ngl::Vec3(o.m_x[i],o.m_y[i],o.m_z[i]),o.m_radius[i])!=ngl::CameraIntercept::OUTSIDE;
+    EXPECT_EQ(in,((mask[i/32]>>(i%32)) & 1)==1);
+    if(in)
+    {
+      expected.push_back(i);
+    }
+  }
+  EXPECT_EQ(visible,expected);
+  EXPECT_GT(expected.size(),0u);
+  EXPECT_LT(expected.size(),n);
+  // nothing past the end is set
+  EXPECT_EQ(mask.back()>>(n%32),0u);
+}
+
+TEST(NGLCamera,boxesInFrustum)
+{
+  const size_t n=1001;
+  Objects o(n);
+  ngl::Camera cam=testCamera();
+  std::vector<uint32_t> visible;
+  cam.boxesInFrustum(o.m_x.data(),o.m_y.data(),o.m_z.data(),o.m_maxX.data(),o.m_maxY.data(),o.m_maxZ.data(),n,visible);
+  std::vector<uint32_t> expected;
+  for(size_t i=0; i<n; ++i)
+  {
+    ngl::AABB box(ngl::Vec4(o.m_x[i],o.m_y[i],o.m_z[i]),o.m_maxX[i]-o.m_x[i],o.m_maxY[i]-o.m_y[i],o.m_maxZ[i]-o.m_z[i]);
+    if(cam.boxInFrustum(box)!=ngl::CameraIntercept::OUTSIDE)
+    {
+      expected.push_back(i);
+    }
+  }
+  EXPECT_EQ(visible,expected);
+  EXPECT_GT(expected.size(),0u);
+  EXPECT_LT(expected.size(),n);
+}
+
+TEST(NGLCamera,cullThreaded)
+{
+  // enough objects to be split over several threads
+  const size_t n=100003;
+  Objects o(n);
+  ngl::Camera cam=testCamera();
+  std::vector<uint32_t> single,multi;
+  cam.spheresInFrustum(o.m_x.data(),o.m_y.data(),o.m_z.data(),o.m_radius.data(),n,single,1);
+  cam.spheresInFrustum(o.m_x.data(),o.m_y.data(),o.m_z.data(),o.m_radius.data(),n,multi,4);
+  EXPECT_EQ(single,multi);
+  cam.boxesInFrustum(o.m_x.data(),o.m_y.data(),o.m_z.data(),o.m_maxX.data(),o.m_maxY.data(),o.m_maxZ.data(),n,single,1);
+  cam.boxesInFrustum(o.m_x.data(),o.m_y.data(),o.m_z.data(),o.m_maxX.data(),o.m_maxY.data(),o.m_maxZ.data(),n,multi,4);
+  EXPECT_EQ(single,multi);
+}
+
+TEST(NGLCamera,cullEmpty)
+{
+  ngl::Camera cam=testCamera();
+  std::vector<uint32_t> visible(3);
+  cam.spheresInFrustum(nullptr,nullptr,nullptr,nullptr,0,visible);
+  EXPECT_TRUE(visible.empty());
+}
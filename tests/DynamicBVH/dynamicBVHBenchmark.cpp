@@ -0,0 +1,203 @@
+#include <ngl/DynamicBVH.h>
+#include <ngl/Camera.h>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// simulates 100k objects moving around a 200 unit cube, each frame every object is moved in the tree then the
+// visible objects and touching pairs are found. Frustum culling is compared with testing every box
+// (Camera::boxesInFrustum) and the pairs with testing every pair for a smaller scene.
+static const uint32_t s_numObjects=100000;
+static const float s_extent=100.0f;
+
+struct Objects
+{
+  std::vector<ngl::Vec3> m_position;
+  std::vector<ngl::Vec3> m_velocity;
+  std::vector<ngl::Vec3> m_halfSize;
+  // the boxes as separate arrays for Camera::boxesInFrustum
+  std::vector<ngl::Real> m_minX,m_minY,m_minZ,m_maxX,m_maxY,m_maxZ;
+};
+
+static Objects s_objects;
+static ngl::DynamicBVH s_tree(0.2f);
+// one camera inside the scene seeing a few percent of it and one outside seeing about half
+static ngl::Camera s_camera(ngl::Vec3(0.0f,0.0f,100.0f),ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(0.0f,1.0f,0.0f));
+static ngl::Camera s_farCamera(ngl::Vec3(0.0f,20.0f,150.0f),ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(0.0f,1.0f,0.0f));
+static std::vector<uint32_t> s_visible;
+static std::vector<std::pair<uint32_t,uint32_t>> s_pairs;
+static size_t s_reinserted=0;
+
+float randomFloat(float _min, float _max)
+{
+  return _min+(_max-_min)*(std::rand()/float(RAND_MAX));
+}
+
+void createObjects(Objects &o_objects, uint32_t _n)
+{
+  std::srand(42);
+  for(uint32_t i=0; i<_n; ++i)
+  {
+    o_objects.m_position.push_back(ngl::Vec3(randomFloat(-s_extent,s_extent),randomFloat(-s_extent,s_extent),
+                                             randomFloat(-s_extent,s_extent)));
+    o_objects.m_velocity.push_back(ngl::Vec3(randomFloat(-0.1f,0.1f),randomFloat(-0.1f,0.1f),randomFloat(-0.1f,0.1f)));
+    o_objects.m_halfSize.push_back(ngl::Vec3(randomFloat(0.1f,0.5f),randomFloat(0.1f,0.5f),randomFloat(0.1f,0.5f)));
+  }
+  o_objects.m_minX.resize(_n);
+  o_objects.m_minY.resize(_n);
+  o_objects.m_minZ.resize(_n);
+  o_objects.m_maxX.resize(_n);
+  o_objects.m_maxY.resize(_n);
+  o_objects.m_maxZ.resize(_n);
+}
+
+// move each object bouncing off the walls, returns how many leaves were moved in the tree
+size_t updateFrame(Objects &io_objects, ngl::DynamicBVH &io_tree)
+{
+  size_t reinserted=0;
+  for(uint32_t i=0; i<io_objects.m_position.size(); ++i)
+  {
+    ngl::Vec3 &p=io_objects.m_position[i];
+    ngl::Vec3 &v=io_objects.m_velocity[i];
+    p+=v;
+    if(p.m_x<-s_extent || p.m_x>s_extent) v.m_x=-v.m_x;
+    if(p.m_y<-s_extent || p.m_y>s_extent) v.m_y=-v.m_y;
+    if(p.m_z<-s_extent || p.m_z>s_extent) v.m_z=-v.m_z;
+    const ngl::Vec3 &h=io_objects.m_halfSize[i];
+    reinserted+=io_tree.move(i,p-h,p+h,v);
+  }
+  return reinserted;
+}
+
+void updateArrays(Objects &io_objects)
+{
+  for(size_t i=0; i<io_objects.m_position.size(); ++i)
+  {
+    const ngl::Vec3 &p=io_objects.m_position[i];
+    const ngl::Vec3 &h=io_objects.m_halfSize[i];
+    io_objects.m_minX[i]=p.m_x-h.m_x;
+    io_objects.m_minY[i]=p.m_y-h.m_y;
+    io_objects.m_minZ[i]=p.m_z-h.m_z;
+    io_objects.m_maxX[i]=p.m_x+h.m_x;
+    io_objects.m_maxY[i]=p.m_y+h.m_y;
+    io_objects.m_maxZ[i]=p.m_z+h.m_z;
+  }
+}
+
+void bruteFrustum(const Objects &_objects, const ngl::Camera &_camera=s_camera)
+{
+  _camera.boxesInFrustum(_objects.m_minX.data(),_objects.m_minY.data(),_objects.m_minZ.data(),_objects.m_maxX.data(),
+                          _objects.m_maxY.data(),_objects.m_maxZ.data(),_objects.m_minX.size(),s_visible);
+}
+
+size_t brutePairs(const Objects &_objects)
+{
+  size_t count=0;
+  size_t n=_objects.m_minX.size();
+  for(size_t i=0; i<n; ++i)
+  {
+    for(size_t j=i+1; j<n; ++j)
+    {
+      count+=_objects.m_minX[i]<=_objects.m_maxX[j] && _objects.m_minX[j]<=_objects.m_maxX[i] &&
+             _objects.m_minY[i]<=_objects.m_maxY[j] && _objects.m_minY[j]<=_objects.m_maxY[i] &&
+             _objects.m_minZ[i]<=_objects.m_maxZ[j] && _objects.m_minZ[j]<=_objects.m_maxZ[i];
+    }
+  }
+  return count;
+}
+
+BENCHMARK(Scene100k, MoveAll, 5, 10) { s_reinserted+=updateFrame(s_objects,s_tree); }
+BENCHMARK(Scene100k, TreeFrustum, 5, 10) { s_tree.inFrustum(s_camera,s_visible); }
+BENCHMARK(Scene100k, BruteFrustum, 5, 10) { bruteFrustum(s_objects); }
+BENCHMARK(Scene100k, TreePairs, 5, 10) { s_tree.overlappingPairs(s_pairs); }
+
+template <class Func>
+double bestTime(Func _func, int _runs)
+{
+  double best=1e30;
+  for(int run=0; run<_runs; ++run)
+  {
+    auto start=std::chrono::high_resolution_clock::now();
+    _func();
+    std::chrono::duration<double> time=std::chrono::high_resolution_clock::now()-start;
+    best=std::min(best,time.count());
+  }
+  return best;
+}
+
+
+int main(int argc, char **argv)
+{
+  s_camera.setShape(45.0f,1.5f,0.5f,100.0f);
+  s_camera.calculateFrustum();
+  s_farCamera.setShape(45.0f,1.5f,0.5f,300.0f);
+  s_farCamera.calculateFrustum();
+  createObjects(s_objects,s_numObjects);
+  double build=bestTime([]
+  {
+    s_tree.clear();
+    for(uint32_t i=0; i<s_numObjects; ++i)
+    {
+      const ngl::Vec3 &p=s_objects.m_position[i];
+      const ngl::Vec3 &h=s_objects.m_halfSize[i];
+      s_tree.insert(i,p-h,p+h);
+    }
+  },3);
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+
+  const int frames=100;
+  double move=0.0,frustum=0.0,pairs=0.0,arrays=0.0,brute=0.0,farFrustum=0.0,farBrute=0.0;
+  size_t reinserted=0,visible=0,farVisible=0,numPairs=0;
+  for(int f=0; f<frames; ++f)
+  {
+    move+=bestTime([&]{reinserted+=updateFrame(s_objects,s_tree);},1);
+    frustum+=bestTime([&]{s_tree.inFrustum(s_camera,s_visible);},1);
+    visible+=s_visible.size();
+    pairs+=bestTime([&]{s_tree.overlappingPairs(s_pairs);},1);
+    numPairs+=s_pairs.size();
+    arrays+=bestTime([&]{updateArrays(s_objects);},1);
+    brute+=bestTime([&]{bruteFrustum(s_objects);},1);
+    farFrustum+=bestTime([&]{s_tree.inFrustum(s_farCamera,s_visible);},1);
+    farVisible+=s_visible.size();
+    farBrute+=bestTime([&]{bruteFrustum(s_objects,s_farCamera);},1);
+  }
+  std::cout<<"\n"<<s_numObjects<<" objects, "<<frames<<" frames, times in ms per frame\n";
+  printf("%-32s %10.2f\n","insert all (once)",build*1e3);
+  printf("%-32s %10.2f  (%.0f leaves moved in the tree)\n","move all",move*1e3/frames,double(reinserted)/frames);
+  printf("%-32s %10.2f  (%.0f visible)\n","tree frustum",frustum*1e3/frames,double(visible)/frames);
+  printf("%-32s %10.2f\n","boxesInFrustum every box",brute*1e3/frames);
+  printf("%-32s %10.2f  (%.0f visible)\n","tree frustum, outside camera",farFrustum*1e3/frames,double(farVisible)/frames);
+  printf("%-32s %10.2f\n","boxesInFrustum, outside camera",farBrute*1e3/frames);
+  printf("%-32s %10.2f  (to fill the boxesInFrustum arrays)\n","copy boxes",arrays*1e3/frames);
+  printf("%-32s %10.2f  (%.0f pairs)\n","tree pairs",pairs*1e3/frames,double(numPairs)/frames);
+  printf("tree height %d for %zu objects\n",s_tree.height(),s_tree.size());
+
+  // pairs against testing every pair for 10k objects
+  Objects small;
+  createObjects(small,10000);
+  ngl::DynamicBVH smallTree(0.2f);
+  for(uint32_t i=0; i<10000; ++i)
+  {
+    smallTree.insert(i,small.m_position[i]-small.m_halfSize[i],small.m_position[i]+small.m_halfSize[i]);
+  }
+  updateArrays(small);
+  size_t bruteCount=0;
+  double bruteTime=bestTime([&]{bruteCount=brutePairs(small);},1);
+  double treeTime=bestTime([&]{smallTree.overlappingPairs(s_pairs);},5);
+  printf("\n10000 objects pairs: tree %.3f ms (%zu), every pair %.1f ms (%zu)\n",treeTime*1e3,s_pairs.size(),bruteTime*1e3,bruteCount);
+  return result;
+}
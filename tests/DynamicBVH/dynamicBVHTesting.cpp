@@ -0,0 +1,313 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/DynamicBVH.h>
+#include <ngl/AABB.h>
+#include <ngl/Camera.h>
+#include <ngl/Transformation.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+struct TestBox
+{
+  ngl::Vec3 m_min;
+  ngl::Vec3 m_max;
+  bool m_used;
+};
+
+float randomFloat(float _min, float _max)
+{
+  return _min+(_max-_min)*(std::rand()/float(RAND_MAX));
+}
+
+ngl::Vec3 randomPoint(float _extent)
+{
+  return ngl::Vec3(randomFloat(-_extent,_extent),randomFloat(-_extent,_extent),randomFloat(-_extent,_extent));
+}
+
+void randomBox(TestBox &o_box, float _extent)
+{
+  ngl::Vec3 c=randomPoint(_extent);
+  ngl::Vec3 h(randomFloat(0.05f,0.5f),randomFloat(0.05f,0.5f),randomFloat(0.05f,0.5f));
+  o_box.m_min=c-h;
+  o_box.m_max=c+h;
+  o_box.m_used=true;
+}
+
+bool overlaps(const TestBox &_a, const ngl::Vec3 &_min, const ngl::Vec3 &_max)
+{
+  return _a.m_min.m_x<=_max.m_x && _min.m_x<=_a.m_max.m_x &&
+         _a.m_min.m_y<=_max.m_y && _min.m_y<=_a.m_max.m_y &&
+         _a.m_min.m_z<=_max.m_z && _min.m_z<=_a.m_max.m_z;
+}
+
+// checks the links, heights and boxes of every node, returns the number of leaves
+size_t checkTree(const ngl::DynamicBVH &_tree)
+{
+  const std::vector<ngl::DynamicBVH::Node> &nodes=_tree.getNodes();
+  if(_tree.getRoot()==-1)
+  {
+    return 0;
+  }
+  EXPECT_EQ(nodes[_tree.getRoot()].m_parent,-1);
+  size_t leaves=0;
+  std::vector<int32_t> stack(1,_tree.getRoot());
+  while(!stack.empty())
+  {
+    int32_t index=stack.back();
+    stack.pop_back();
+    const ngl::DynamicBVH::Node &n=nodes[index];
+    if(n.isLeaf())
+    {
+      EXPECT_EQ(n.m_height,0);
+      ngl::Vec3 mn,mx;
+      EXPECT_TRUE(_tree.getBox(n.m_id,mn,mx));
+      EXPECT_TRUE(n.m_min[0]<=mn.m_x && n.m_min[1]<=mn.m_y && n.m_min[2]<=mn.m_z);
+      EXPECT_TRUE(n.m_max[0]>=mx.m_x && n.m_max[1]>=mx.m_y && n.m_max[2]>=mx.m_z);
+      ++leaves;
+      continue;
+    }
+    const ngl::DynamicBVH::Node &a=nodes[n.m_child[0]];
+    const ngl::DynamicBVH::Node &b=nodes[n.m_child[1]];
+    EXPECT_EQ(a.m_parent,index);
+    EXPECT_EQ(b.m_parent,index);
+    EXPECT_EQ(n.m_height,1+std::max(a.m_height,b.m_height));
+    for(int i=0; i<3; ++i)
+    {
+      EXPECT_FLOAT_EQ(n.m_min[i],std::min(a.m_min[i],b.m_min[i]));
+      EXPECT_FLOAT_EQ(n.m_max[i],std::max(a.m_max[i],b.m_max[i]));
+    }
+    stack.push_back(n.m_child[0]);
+    stack.push_back(n.m_child[1]);
+  }
+  return leaves;
+}
+
+TEST(NGLDynamicBVH,insertRemove)
+{
+  ngl::DynamicBVH tree;
+  EXPECT_EQ(tree.height(),-1);
+  std::vector<uint32_t> ids;
+  tree.overlapBox(ngl::Vec3(-1.0f,-1.0f,-1.0f),ngl::Vec3(1.0f,1.0f,1.0f),ids);
+  EXPECT_TRUE(ids.empty());
+  EXPECT_TRUE(tree.insert(7,ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(1.0f,1.0f,1.0f)));
+  EXPECT_FALSE(tree.insert(7,ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(1.0f,1.0f,1.0f)));
+  EXPECT_TRUE(tree.insert(9,ngl::Vec3(2.0f,0.0f,0.0f),ngl::Vec3(3.0f,1.0f,1.0f)));
+  EXPECT_EQ(tree.size(),2u);
+  EXPECT_EQ(tree.height(),1);
+  EXPECT_TRUE(tree.contains(7));
+  ngl::Vec3 mn,mx;
+  EXPECT_TRUE(tree.getBox(9,mn,mx));
+  EXPECT_TRUE(mn==ngl::Vec3(2.0f,0.0f,0.0f));
+  EXPECT_TRUE(mx==ngl::Vec3(3.0f,1.0f,1.0f));
+  EXPECT_TRUE(tree.remove(7));
+  EXPECT_FALSE(tree.remove(7));
+  EXPECT_FALSE(tree.contains(7));
+  EXPECT_FALSE(tree.getBox(7,mn,mx));
+  EXPECT_EQ(tree.height(),0);
+  EXPECT_EQ(checkTree(tree),1u);
+  tree.clear();
+  EXPECT_EQ(tree.size(),0u);
+  EXPECT_EQ(tree.height(),-1);
+}
+
+TEST(NGLDynamicBVH,balanced)
+{
+  // boxes added in order along a line would make a list without the rotations, log2(4096)=12
+  ngl::DynamicBVH tree;
+  for(uint32_t i=0; i<4096; ++i)
+  {
+    tree.insert(i,ngl::Vec3(i,0.0f,0.0f),ngl::Vec3(i+0.5f,0.5f,0.5f));
+  }
+  EXPECT_EQ(checkTree(tree),4096u);
+  EXPECT_LE(tree.height(),2*12);
+  // removing every other one keeps it balanced
+  for(uint32_t i=0; i<4096; i+=2)
+  {
+    EXPECT_TRUE(tree.remove(i));
+  }
+  EXPECT_EQ(checkTree(tree),2048u);
+  EXPECT_LE(tree.height(),2*11);
+}
+
+TEST(NGLDynamicBVH,move)
+{
+  ngl::DynamicBVH tree(0.5f);
+  tree.insert(1,ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(1.0f,1.0f,1.0f));
+  tree.insert(2,ngl::Vec3(5.0f,0.0f,0.0f),ngl::Vec3(6.0f,1.0f,1.0f));
+  // small moves stay in the fat box
+  EXPECT_FALSE(tree.move(1,ngl::Vec3(0.2f,0.0f,0.0f),ngl::Vec3(1.2f,1.0f,1.0f)));
+  ngl::Vec3 mn,mx;
+  tree.getBox(1,mn,mx);
+  EXPECT_FLOAT_EQ(mn.m_x,0.2f);
+  // the queries use the exact box not the fat one
+  std::vector<uint32_t> ids;
+  tree.overlapBox(ngl::Vec3(-0.3f,0.0f,0.0f),ngl::Vec3(0.1f,1.0f,1.0f),ids);
+  EXPECT_TRUE(ids.empty());
+  // leaving the fat box moves the leaf
+  EXPECT_TRUE(tree.move(1,ngl::Vec3(4.5f,0.0f,0.0f),ngl::Vec3(5.5f,1.0f,1.0f)));
+  tree.overlapBox(ngl::Vec3(5.2f,0.5f,0.5f),ngl::Vec3(5.3f,0.6f,0.6f),ids);
+  std::sort(ids.begin(),ids.end());
+  ASSERT_EQ(ids.size(),2u);
+  EXPECT_EQ(ids[0],1u);
+  EXPECT_EQ(ids[1],2u);
+  // a displacement stretches the fat box so the next moves that way are free
+  EXPECT_TRUE(tree.move(2,ngl::Vec3(7.0f,0.0f,0.0f),ngl::Vec3(8.0f,1.0f,1.0f),ngl::Vec3(1.0f,0.0f,0.0f)));
+  EXPECT_FALSE(tree.move(2,ngl::Vec3(8.0f,0.0f,0.0f),ngl::Vec3(9.0f,1.0f,1.0f),ngl::Vec3(1.0f,0.0f,0.0f)));
+  EXPECT_FALSE(tree.move(3,ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(1.0f,1.0f,1.0f)));
+  EXPECT_EQ(checkTree(tree),2u);
+}
+
+TEST(NGLDynamicBVH,transformed)
+{
+  // the BBox versions of insert and move need a GL context for the BBox so use the box transform directly
+  ngl::Transformation tx;
+  tx.setPosition(10.0f,0.0f,0.0f);
+  tx.setRotation(0.0f,0.0f,90.0f);
+  ngl::Vec3 mn,mx;
+  ngl::DynamicBVH::transformBox(ngl::Vec3(-1.0f,-0.5f,-0.25f),ngl::Vec3(1.0f,0.5f,0.25f),tx.getMatrix(),mn,mx);
+  // rotated 90 degrees about z the x and y extents swap
+  EXPECT_NEAR(mn.m_x,9.5f,1e-4f);
+  EXPECT_NEAR(mx.m_x,10.5f,1e-4f);
+  EXPECT_NEAR(mn.m_y,-1.0f,1e-4f);
+  EXPECT_NEAR(mx.m_y,1.0f,1e-4f);
+  EXPECT_NEAR(mn.m_z,-0.25f,1e-4f);
+  EXPECT_NEAR(mx.m_z,0.25f,1e-4f);
+  // 45 degrees grows the box to hold the rotated corners
+  tx.setPosition(0.0f,0.0f,0.0f);
+  tx.setRotation(0.0f,45.0f,0.0f);
+  ngl::DynamicBVH::transformBox(ngl::Vec3(-1.0f,-1.0f,-1.0f),ngl::Vec3(1.0f,1.0f,1.0f),tx.getMatrix(),mn,mx);
+  EXPECT_NEAR(mx.m_x,std::sqrt(2.0f),1e-4f);
+  EXPECT_NEAR(mn.m_z,-std::sqrt(2.0f),1e-4f);
+  EXPECT_NEAR(mx.m_y,1.0f,1e-4f);
+}
+
+// random inserts, moves and removes then compare every query with testing all the boxes
+TEST(NGLDynamicBVH,randomQueries)
+{
+  std::srand(1234);
+  const uint32_t count=2000;
+  std::vector<TestBox> boxes(count);
+  ngl::DynamicBVH tree(0.2f);
+  for(uint32_t i=0; i<count; ++i)
+  {
+    randomBox(boxes[i],20.0f);
+    ASSERT_TRUE(tree.insert(i,boxes[i].m_min,boxes[i].m_max));
+  }
+  for(int step=0; step<10; ++step)
+  {
+    for(uint32_t i=0; i<count; ++i)
+    {
+      int action=std::rand()%10;
+      if(action<6 && boxes[i].m_used)
+      {
+        ngl::Vec3 d=randomPoint(0.3f);
+        boxes[i].m_min+=d;
+        boxes[i].m_max+=d;
+        tree.move(i,boxes[i].m_min,boxes[i].m_max,d);
+      }
+      else if(action==6 && boxes[i].m_used)
+      {
+        EXPECT_TRUE(tree.remove(i));
+        boxes[i].m_used=false;
+      }
+      else if(action==7 && !boxes[i].m_used)
+      {
+        randomBox(boxes[i],20.0f);
+        EXPECT_TRUE(tree.insert(i,boxes[i].m_min,boxes[i].m_max));
+      }
+    }
+  }
+  size_t used=std::count_if(boxes.begin(),boxes.end(),[](const TestBox &_b){return _b.m_used;});
+  EXPECT_EQ(tree.size(),used);
+  EXPECT_EQ(checkTree(tree),used);
+  EXPECT_LE(tree.height(),24);
+
+  std::vector<uint32_t> ids,expected;
+  for(int q=0; q<50; ++q)
+  {
+    ngl::Vec3 c=randomPoint(20.0f);
+    ngl::Vec3 h(randomFloat(0.1f,4.0f),randomFloat(0.1f,4.0f),randomFloat(0.1f,4.0f));
+    tree.overlapBox(c-h,c+h,ids);
+    expected.clear();
+    for(uint32_t i=0; i<count; ++i)
+    {
+      if(boxes[i].m_used && overlaps(boxes[i],c-h,c+h))
+      {
+        expected.push_back(i);
+      }
+    }
+    std::sort(ids.begin(),ids.end());
+    EXPECT_EQ(ids,expected);
+
+    float r=h.m_x;
+    tree.overlapSphere(c,r,ids);
+    expected.clear();
+    for(uint32_t i=0; i<count; ++i)
+    {
+      ngl::Vec3 p(std::max(boxes[i].m_min.m_x,std::min(c.m_x,boxes[i].m_max.m_x)),
+                  std::max(boxes[i].m_min.m_y,std::min(c.m_y,boxes[i].m_max.m_y)),
+                  std::max(boxes[i].m_min.m_z,std::min(c.m_z,boxes[i].m_max.m_z)));
+      if(boxes[i].m_used && (p-c).lengthSquared()<=r*r)
+      {
+        expected.push_back(i);
+      }
+    }
+    std::sort(ids.begin(),ids.end());
+    EXPECT_EQ(ids,expected);
+  }
+
+  std::vector<std::pair<uint32_t,uint32_t>> pairs,expectedPairs;
+  tree.overlappingPairs(pairs);
+  for(uint32_t i=0; i<count; ++i)
+  {
+    for(uint32_t j=i+1; j<count; ++j)
+    {
+      if(boxes[i].m_used && boxes[j].m_used && overlaps(boxes[i],boxes[j].m_min,boxes[j].m_max))
+      {
+        expectedPairs.push_back(std::make_pair(i,j));
+      }
+    }
+  }
+  EXPECT_FALSE(expectedPairs.empty());
+  std::sort(pairs.begin(),pairs.end());
+  EXPECT_EQ(pairs,expectedPairs);
+}
+
+TEST(NGLDynamicBVH,inFrustum)
+{
+  std::srand(99);
+  ngl::Camera cam(ngl::Vec3(0.0f,2.0f,25.0f),ngl::Vec3(3.0f,0.0f,0.0f),ngl::Vec3(0.0f,1.0f,0.0f));
+  cam.setShape(35.0f,1.5f,0.5f,30.0f);
+  cam.calculateFrustum();
+  const uint32_t count=3000;
+  ngl::DynamicBVH tree;
+  std::vector<uint32_t> expected;
+  for(uint32_t i=0; i<count; ++i)
+  {
+    TestBox b;
+    randomBox(b,30.0f);
+    tree.insert(i,b.m_min,b.m_max);
+    ngl::Vec3 size=b.m_max-b.m_min;
+    ngl::AABB aabb(ngl::Vec4(b.m_min.m_x,b.m_min.m_y,b.m_min.m_z),size.m_x,size.m_y,size.m_z);
+    if(cam.boxInFrustum(aabb)!=ngl::CameraIntercept::OUTSIDE)
+    {
+      expected.push_back(i);
+    }
+  }
+  std::vector<uint32_t> ids;
+  tree.inFrustum(cam,ids);
+  std::sort(ids.begin(),ids.end());
+  EXPECT_FALSE(expected.empty());
+  EXPECT_LT(expected.size(),count/2);
+  EXPECT_EQ(ids,expected);
+}
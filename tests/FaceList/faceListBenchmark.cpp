@@ -0,0 +1,148 @@
+#include <ngl/AbstractMesh.h>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <iostream>
+#include <vector>
+
+// compares the old per face storage (each face owning three std::vectors) against the
+// contiguous ngl::FaceList for building and walking a large triangle mesh
+static const uint32_t s_numFaces=1000000;
+static const uint32_t s_numVerts=s_numFaces/2;
+
+// this is the Face class as it was before the FaceList
+struct LegacyFace
+{
+  unsigned int m_numVerts;
+  std::vector<uint32_t> m_vert;
+  std::vector<uint32_t> m_tex;
+  std::vector<uint32_t> m_norm;
+  bool m_textureCoord;
+  bool m_normals;
+};
+
+static std::vector<LegacyFace> s_legacy;
+static ngl::FaceList s_faces;
+static uint64_t s_sum=0;
+
+void makeTri(uint32_t _face, uint32_t *o_idx)
+{
+  // scatter the indices a little as a real mesh would
+  o_idx[0]=(_face*7)%s_numVerts;
+  o_idx[1]=(_face*7+1)%s_numVerts;
+  o_idx[2]=(_face*7+513)%s_numVerts;
+}
+
+void buildLegacy(std::vector<LegacyFace> &o_faces)
+{
+  o_faces.clear();
+  uint32_t idx[3];
+  for(uint32_t f=0; f<s_numFaces; ++f)
+  {
+    makeTri(f,idx);
+    LegacyFace face;
+    face.m_numVerts=2;
+    face.m_textureCoord=face.m_normals=true;
+    for(auto i : idx)
+    {
+      face.m_vert.push_back(i);
+      face.m_tex.push_back(i);
+      face.m_norm.push_back(i);
+    }
+    o_faces.push_back(face);
+  }
+}
+
+void buildFaceList(ngl::FaceList &o_faces)
+{
+  o_faces.clear();
+  uint32_t idx[3];
+  for(uint32_t f=0; f<s_numFaces; ++f)
+  {
+    makeTri(f,idx);
+    o_faces.addFace(3,idx,idx,idx);
+  }
+}
+
+// approximate heap use, each allocation also has ~16 bytes of malloc overhead
+size_t legacySize(const std::vector<LegacyFace> &_faces)
+{
+  size_t size=_faces.capacity()*sizeof(LegacyFace);
+  for(auto &f : _faces)
+  {
+    size+=(f.m_vert.capacity()+f.m_tex.capacity()+f.m_norm.capacity())*sizeof(uint32_t)+3*16;
+  }
+  return size;
+}
+
+BENCHMARK(FaceList, BuildLegacy, 5, 1)
+{
+  std::vector<LegacyFace> faces;
+  buildLegacy(faces);
+}
+
+BENCHMARK(FaceList, BuildFaceList, 5, 1)
+{
+  ngl::FaceList faces;
+  buildFaceList(faces);
+}
+
+BENCHMARK(FaceList, TraverseLegacy, 10, 1)
+{
+  uint64_t sum=0;
+  for(const auto &f : s_legacy)
+  {
+    for(unsigned int i=0; i<=f.m_numVerts; ++i)
+    {
+      sum+=f.m_vert[i]+f.m_tex[i]+f.m_norm[i];
+    }
+  }
+  s_sum+=sum;
+}
+
+BENCHMARK(FaceList, TraverseFaceView, 10, 1)
+{
+  uint64_t sum=0;
+  for(auto f : s_faces)
+  {
+    for(unsigned int i=0; i<f.numVerts(); ++i)
+    {
+      sum+=f.vert(i)+f.tex(i)+f.norm(i);
+    }
+  }
+  s_sum+=sum;
+}
+
+BENCHMARK(FaceList, TraverseFaceArrays, 10, 1)
+{
+  uint64_t sum=0;
+  const std::vector<uint32_t> &vert=s_faces.vertIndices();
+  const std::vector<uint32_t> &tex=s_faces.texIndices();
+  const std::vector<uint32_t> &norm=s_faces.normalIndices();
+  for(size_t i=0; i<vert.size(); ++i)
+  {
+    sum+=vert[i]+tex[i]+norm[i];
+  }
+  s_sum+=sum;
+}
+
+
+int main(int argc, char **argv)
+{
+  buildLegacy(s_legacy);
+  buildFaceList(s_faces);
+  std::cout<<s_numFaces<<" triangles\n";
+  std::cout<<"Legacy face memory   "<<legacySize(s_legacy)/(1024*1024)<<" MB\n";
+  std::cout<<"FaceList face memory "<<s_faces.memorySize()/(1024*1024)<<" MB\n";
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+  // use the sum so the traversals are not optimised away
+  std::cout<<"checksum "<<s_sum<<"\n";
+  return result;
+}
@@ -0,0 +1,136 @@
+#include <ngl/GLStateCache.h>
+#include <ngl/ShaderLib.h>
+#include <ngl/SimpleVAO.h>
+#include "../ShaderLib/recordingGL.h"
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// a frame of 10k objects sorted by material, 4 shaders and 8 meshes, each drawn with the usual use, bind, set the
+// uniforms, unbind. The GL calls go to an empty stand in for the driver so the times are only the cost of NGL (and the
+// filtering), the number of calls that would reach the driver is counted.
+static const size_t s_objects=10000;
+static const size_t s_programs=4;
+static const size_t s_meshes=8;
+
+struct Object
+{
+  std::string program;
+  ngl::AbstractVAO *vao;
+  ngl::Mat4 mvp;
+  ngl::Vec4 colour;
+};
+
+static ngl::ShaderLib *s_shader=nullptr;
+static std::vector<std::unique_ptr<ngl::AbstractVAO>> s_vaos;
+static std::vector<Object> s_scene;
+static ngl::UniformHandle s_mvpHandle,s_colourHandle,s_shininessHandle;
+
+void drawFrame()
+{
+  for(auto &o : s_scene)
+  {
+    s_shader->use(o.program);
+    o.vao->bind();
+    s_shader->setUniform(s_mvpHandle,o.mvp);
+    s_shader->setUniform(s_colourHandle,o.colour);
+    s_shader->setUniform(s_shininessHandle,20.0f);
+    o.vao->unbind();
+  }
+}
+
+void setMode(bool _enabled, bool _defer)
+{
+  ngl::GLStateCache *cache=ngl::GLStateCache::instance();
+  cache->setEnabled(_enabled);
+  cache->setDeferredUnbind(_defer);
+  cache->invalidate();
+}
+
+BENCHMARK(Frame10kObjects, Unfiltered, 5, 10) { setMode(false,false); drawFrame(); }
+BENCHMARK(Frame10kObjects, Filtered, 5, 10) { setMode(true,false); drawFrame(); }
+BENCHMARK(Frame10kObjects, FilteredDeferredUnbind, 5, 10) { setMode(true,true); drawFrame(); }
+
+template <class Func>
+double bestTime(Func _func, int _runs)
+{
+  double best=1e30;
+  for(int run=0; run<_runs; ++run)
+  {
+    auto start=std::chrono::high_resolution_clock::now();
+    _func();
+    std::chrono::duration<double> time=std::chrono::high_resolution_clock::now()-start;
+    best=std::min(best,time.count());
+  }
+  return best;
+}
+
+void report(const char *_name, bool _enabled, bool _defer)
+{
+  setMode(_enabled,_defer);
+  // one frame to fill the stored values then count a second
+  drawFrame();
+  ngl::GLStateCache *cache=ngl::GLStateCache::instance();
+  cache->resetStats();
+  drawFrame();
+  ngl::GLStateCache::Stats stats=cache->stats();
+  double time=bestTime(drawFrame,20);
+  printf("%-26s %10zu %10zu %10zu %10.3f\n",_name,stats.m_programBinds,stats.m_vaoBinds,stats.m_uniforms,time*1e3);
+}
+
+int main(int argc, char **argv)
+{
+  recordingGL::install();
+  recordingGL::state().record=false;
+  s_shader=ngl::ShaderLib::instance();
+  std::vector<recordingGL::Uniform> uniforms={{"MVP",GL_FLOAT_MAT4,1},{"colour",GL_FLOAT_VEC4,1},{"shininess",GL_FLOAT,1}};
+  std::vector<std::string> programs;
+  for(size_t i=0; i<s_programs; ++i)
+  {
+    programs.push_back("Material"+std::to_string(i));
+    s_shader->createShaderProgram(programs.back());
+    recordingGL::state().uniforms[s_shader->getProgramID(programs.back())]=uniforms;
+    s_shader->linkProgramObject(programs.back());
+  }
+  for(size_t i=0; i<s_meshes; ++i)
+  {
+    s_vaos.emplace_back(ngl::SimpleVAO::create());
+  }
+  // sorted by program then mesh as a renderer would, each material has one colour
+  for(size_t i=0; i<s_objects; ++i)
+  {
+    size_t program=i*s_programs/s_objects;
+    Object o;
+    o.program=programs[program];
+    o.vao=s_vaos[(i*s_programs*s_meshes/s_objects)%s_meshes].get();
+    o.mvp.translate(float(i),0.0f,1.0f);
+    o.colour.set(program/float(s_programs),0.5f,0.5f,1.0f);
+    s_scene.push_back(o);
+  }
+  s_mvpHandle=s_shader->getUniformHandle("MVP");
+  s_colourHandle=s_shader->getUniformHandle("colour");
+  s_shininessHandle=s_shader->getUniformHandle("shininess");
+
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+
+  std::cout<<"\n"<<s_objects<<" objects, "<<s_programs<<" programs, "<<s_meshes<<" meshes, GL calls per frame\n";
+  printf("%-26s %10s %10s %10s %10s\n","","useProgram","bindVAO","uniforms","ms");
+  report("unfiltered",false,false);
+  report("filtered",true,false);
+  report("filtered, deferred unbind",true,true);
+  return result;
+}
@@ -0,0 +1,265 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/GLStateCache.h>
+#include <ngl/ShaderLib.h>
+#include <ngl/SimpleVAO.h>
+#include "../ShaderLib/recordingGL.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+
+int main(int argc, char **argv)
+{
+  // no OpenGL context is needed as the calls go to the recording stand in
+  recordingGL::install();
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// create and link a program reporting _uniforms as its active uniforms
+void createProgram(const std::string &_name, const std::vector<recordingGL::Uniform> &_uniforms)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  shader->createShaderProgram(_name);
+  recordingGL::state().uniforms[shader->getProgramID(_name)]=_uniforms;
+  shader->linkProgramObject(_name);
+}
+
+// start each test with nothing known and the counts at zero
+ngl::GLStateCache * resetCache()
+{
+  ngl::GLStateCache *cache=ngl::GLStateCache::instance();
+  cache->setEnabled(true);
+  cache->setDeferredUnbind(false);
+  cache->invalidate();
+  cache->resetStats();
+  recordingGL::state().calls.clear();
+  recordingGL::state().useProgramCalls=0;
+  recordingGL::state().bindVertexArrayCalls=0;
+  return cache;
+}
+
+static const std::vector<recordingGL::Uniform> s_uniforms=
+{
+  {"MVP",GL_FLOAT_MAT4,1},
+  {"colour",GL_FLOAT_VEC4,1},
+  {"shininess",GL_FLOAT,1},
+  {"tex",GL_SAMPLER_2D,1},
+  {"lights[0]",GL_FLOAT_VEC3,3}
+};
+
+TEST(NGLGLStateCache,programBindsFiltered)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  createProgram("CacheA",s_uniforms);
+  createProgram("CacheB",s_uniforms);
+  ngl::GLStateCache *cache=resetCache();
+  shader->use("CacheA");
+  shader->use("CacheA");
+  (*shader)["CacheA"]->use();
+  EXPECT_EQ(recordingGL::state().useProgramCalls,1u);
+  EXPECT_TRUE(cache->isProgramInUse(shader->getProgramID("CacheA")));
+  shader->use("CacheB");
+  shader->use("CacheA");
+  EXPECT_EQ(recordingGL::state().useProgramCalls,3u);
+  EXPECT_EQ(recordingGL::state().current,shader->getProgramID("CacheA"));
+  EXPECT_EQ(cache->stats().m_programBinds,3u);
+  EXPECT_EQ(cache->stats().m_programBindsSkipped,2u);
+  // unbinding then using again is issued
+  (*shader)["CacheA"]->unbind();
+  EXPECT_EQ(recordingGL::state().current,0u);
+  shader->use("CacheA");
+  EXPECT_EQ(recordingGL::state().useProgramCalls,5u);
+}
+
+TEST(NGLGLStateCache,uniformsFiltered)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  createProgram("CacheUniforms",s_uniforms);
+  ngl::GLStateCache *cache=resetCache();
+  shader->use("CacheUniforms");
+  ngl::Mat4 mvp;
+  mvp.translate(1.0f,2.0f,3.0f);
+  ngl::UniformHandle colour=shader->getUniformHandle("colour");
+  auto &calls=recordingGL::state().calls;
+  shader->setUniform("MVP",mvp);
+  shader->setUniform("MVP",mvp);
+  shader->setUniform("colour",1.0f,0.0f,0.0f,1.0f);
+  // the name and handle setters share the stored value
+  shader->setUniform(colour,1.0f,0.0f,0.0f,1.0f);
+  shader->setUniform(colour,ngl::Vec4(1.0f,0.0f,0.0f,1.0f));
+  shader->setUniform("shininess",20.0f);
+  shader->setUniform("shininess",20.0f);
+  shader->setUniform("tex",0);
+  shader->setUniform("tex",0);
+  ASSERT_EQ(calls.size(),4u);
+  EXPECT_STREQ(calls[0].func,"glUniformMatrix4fv");
+  EXPECT_STREQ(calls[1].func,"glUniform4f");
+  EXPECT_STREQ(calls[2].func,"glUniform1f");
+  EXPECT_STREQ(calls[3].func,"glUniform1i");
+  EXPECT_EQ(cache->stats().m_uniforms,4u);
+  EXPECT_EQ(cache->stats().m_uniformsSkipped,5u);
+  // a changed value is written
+  mvp.m_30=5.0f;
+  shader->setUniform("MVP",mvp);
+  shader->setUniform(colour,0.0f,1.0f,0.0f,1.0f);
+  shader->setUniform("shininess",21.0f);
+  ASSERT_EQ(calls.size(),7u);
+  EXPECT_EQ(calls[4].values,std::vector<float>(mvp.openGL(),mvp.openGL()+16));
+  EXPECT_EQ(calls[5].values,std::vector<float>({0.0f,1.0f,0.0f,1.0f}));
+  EXPECT_EQ(calls[6].values,std::vector<float>({21.0f}));
+  // unknown names are passed on so OpenGL reports the error as before
+  shader->setUniform("notAUniform",1.0f);
+  shader->setUniform("notAUniform",1.0f);
+  EXPECT_EQ(calls.size(),9u);
+}
+
+TEST(NGLGLStateCache,valuesKeptPerProgram)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  createProgram("CachePerA",s_uniforms);
+  createProgram("CachePerB",s_uniforms);
+  resetCache();
+  auto &calls=recordingGL::state().calls;
+  ngl::UniformHandle colour=shader->getUniformHandle("colour");
+  shader->use("CachePerA");
+  shader->setUniform(colour,1.0f,0.0f,0.0f,1.0f);
+  shader->use("CachePerB");
+  shader->setUniform(colour,1.0f,0.0f,0.0f,1.0f);
+  // uniforms belong to the program so A still has its value
+  shader->use("CachePerA");
+  shader->setUniform(colour,1.0f,0.0f,0.0f,1.0f);
+  shader->use("CachePerB");
+  shader->setUniform(colour,0.0f,0.0f,1.0f,1.0f);
+  ASSERT_EQ(calls.size(),3u);
+  GLint b=static_cast<GLint>(shader->getProgramID("CachePerB"));
+  EXPECT_EQ(calls[1].loc,b*100+1);
+  EXPECT_EQ(calls[2].loc,b*100+1);
+}
+
+TEST(NGLGLStateCache,arraysAndProgramsNotInUse)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  createProgram("CacheArrayA",s_uniforms);
+  createProgram("CacheArrayB",s_uniforms);
+  resetCache();
+  auto &calls=recordingGL::state().calls;
+  shader->use("CacheArrayA");
+  ngl::ShaderProgram *a=(*shader)["CacheArrayA"];
+  ngl::ShaderProgram *b=(*shader)["CacheArrayB"];
+  a->use();
+  a->setUniform4f("colour",1.0f,1.0f,1.0f,1.0f);
+  // a write of more than one element is always issued and forgets the stored values
+  float colours[8]={1.0f,1.0f,1.0f,1.0f,0.0f,0.0f,0.0f,1.0f};
+  a->setUniform4fv("colour",2,colours);
+  a->setUniform4fv("colour",2,colours);
+  a->setUniform4f("colour",1.0f,1.0f,1.0f,1.0f);
+  EXPECT_EQ(calls.size(),4u);
+  // so does a write to a program which isn't in use (it goes to the one that is)
+  a->setUniform1f("shininess",2.0f);
+  b->setUniform1f("shininess",2.0f);
+  a->setUniform1f("shininess",2.0f);
+  EXPECT_EQ(calls.size(),7u);
+  a->setUniform1f("shininess",2.0f);
+  EXPECT_EQ(calls.size(),7u);
+}
+
+TEST(NGLGLStateCache,invalidateAndDisable)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  createProgram("CacheInvalidate",s_uniforms);
+  ngl::GLStateCache *cache=resetCache();
+  auto &calls=recordingGL::state().calls;
+  shader->use("CacheInvalidate");
+  shader->setUniform("shininess",4.0f);
+  shader->setUniform("shininess",4.0f);
+  EXPECT_EQ(calls.size(),1u);
+  // OpenGL used directly, nothing stored can be trusted
+  cache->invalidate();
+  EXPECT_FALSE(cache->isProgramInUse(shader->getProgramID("CacheInvalidate")));
+  shader->use("CacheInvalidate");
+  shader->setUniform("shininess",4.0f);
+  EXPECT_EQ(recordingGL::state().useProgramCalls,2u);
+  EXPECT_EQ(calls.size(),2u);
+  // with the filtering off every call is made
+  cache->setEnabled(false);
+  shader->use("CacheInvalidate");
+  shader->setUniform("shininess",4.0f);
+  shader->setUniform("shininess",4.0f);
+  EXPECT_EQ(recordingGL::state().useProgramCalls,3u);
+  EXPECT_EQ(calls.size(),4u);
+  // turning it back on forgets everything so the program is used again
+  cache->setEnabled(true);
+  shader->use("CacheInvalidate");
+  EXPECT_EQ(recordingGL::state().useProgramCalls,4u);
+  shader->setUniform("shininess",4.0f);
+  shader->setUniform("shininess",4.0f);
+  EXPECT_EQ(calls.size(),5u);
+  EXPECT_EQ(cache->stats().m_uniformsSkipped,2u);
+}
+
+TEST(NGLGLStateCache,relinkForgetsValues)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  createProgram("CacheRelink",s_uniforms);
+  resetCache();
+  auto &calls=recordingGL::state().calls;
+  shader->use("CacheRelink");
+  shader->setUniform("shininess",4.0f);
+  // linking resets the uniforms to their defaults
+  shader->linkProgramObject("CacheRelink");
+  shader->use("CacheRelink");
+  shader->setUniform("shininess",4.0f);
+  EXPECT_EQ(calls.size(),2u);
+}
+
+TEST(NGLGLStateCache,vertexArrayBinds)
+{
+  ngl::GLStateCache *cache=resetCache();
+  std::unique_ptr<ngl::AbstractVAO> a(ngl::SimpleVAO::create());
+  std::unique_ptr<ngl::AbstractVAO> b(ngl::SimpleVAO::create());
+  auto &state=recordingGL::state();
+  a->bind();
+  GLuint aID=state.currentVAO;
+  b->bind();
+  GLuint bID=state.currentVAO;
+  b->unbind();
+  state.bindVertexArrayCalls=0;
+  // the usual bind, draw, unbind of each mesh
+  for(int i=0; i<3; ++i)
+  {
+    a->bind();
+    a->unbind();
+  }
+  EXPECT_EQ(state.bindVertexArrayCalls,6u);
+  EXPECT_EQ(state.currentVAO,0u);
+  a->bind();
+  a->bind();
+  EXPECT_EQ(state.bindVertexArrayCalls,7u);
+  a->unbind();
+  a->unbind();
+  EXPECT_EQ(state.bindVertexArrayCalls,8u);
+  // deferred the unbinds are dropped and only a change of VAO is issued
+  cache->setDeferredUnbind(true);
+  cache->resetStats();
+  state.bindVertexArrayCalls=0;
+  for(int i=0; i<3; ++i)
+  {
+    a->bind();
+    a->unbind();
+  }
+  EXPECT_EQ(state.bindVertexArrayCalls,1u);
+  EXPECT_EQ(state.currentVAO,aID);
+  b->bind();
+  b->unbind();
+  EXPECT_EQ(state.bindVertexArrayCalls,2u);
+  EXPECT_EQ(state.currentVAO,bID);
+  EXPECT_EQ(cache->stats().m_vaoBinds,2u);
+  EXPECT_EQ(cache->stats().m_vaoBindsSkipped,6u);
+  // deleting the bound VAO leaves 0 bound
+  b.reset();
+  EXPECT_FALSE(cache->isVertexArrayBound(bID));
+  EXPECT_TRUE(cache->isVertexArrayBound(0));
+  cache->setDeferredUnbind(false);
+}
@@ -7,6 +7,13 @@
 static ngl::Mat4 t1;
 static ngl::Mat4 t2(1.0);
 static ngl::Mat4 t3(2.0);
+// a general (non affine) matrix so the multiply and inverse can't take any short cuts
+static ngl::Mat4 t4(1.0f,2.0f,0.5f,0.0f,
+                    -1.0f,3.0f,1.0f,0.25f,
+                    0.0f,-2.0f,4.0f,1.0f,
+                    2.0f,1.0f,-1.0f,1.0f);
+static ngl::Vec4 v1(1.0f,2.0f,3.0f,1.0f);
+static ngl::Vec4 v2;
 
 void testAdd()
 {
@@ -38,6 +45,32 @@ BENCHMARK(Mat4Tests, TestCopyCtor, 10, 100)
     ngl::Mat4 t(t3);
 }
 
+BENCHMARK(Mat4Tests, Mat4Mult, 10, 1000)
+{
+    t1=t4*t3;
+}
+
+BENCHMARK(Mat4Tests, Mat4MultEquals, 10, 1000)
+{
+    t1=t4;
+    t1*=t3;
+}
+
+BENCHMARK(Mat4Tests, Mat4Inverse, 10, 1000)
+{
+    t1=t4.inverse();
+}
+
+BENCHMARK(Mat4Tests, Mat4Transpose, 10, 1000)
+{
+    t1.transpose();
+}
+
+BENCHMARK(Mat4Tests, Mat4Vec4, 10, 1000)
+{
+    v2=t4*v1;
+}
+
 
 int main(int argc, char **argv)
 {
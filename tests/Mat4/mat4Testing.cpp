@@ -280,6 +280,70 @@ TEST(NGLMat4,Mat4xVec4)
   EXPECT_TRUE(test == result);
 }
 
+// general (non affine) matrices so every element of the SIMD paths is exercised
+static const ngl::Mat4 s_a(1.0f,2.0f,0.5f,0.0f,
+                           -1.0f,3.0f,1.0f,0.25f,
+                           0.0f,-2.0f,4.0f,1.0f,
+                           2.0f,1.0f,-1.0f,1.0f);
+static const ngl::Mat4 s_b(0.5f,-1.0f,2.0f,3.0f,
+                           1.0f,0.0f,-0.5f,1.0f,
+                           4.0f,2.0f,1.0f,0.0f,
+                           -3.0f,1.0f,0.0f,2.0f);
+
+TEST(NGLMat4,Mat4xMat4General)
+{
+  ngl::Mat4 test=s_a*s_b;
+  for(int y=0; y<4; ++y)
+  {
+    for(int x=0; x<4; ++x)
+    {
+      ngl::Real sum=0.0f;
+      for(int k=0; k<4; ++k)
+      {
+        sum+=s_a.m_m[y][k]*s_b.m_m[k][x];
+      }
+      EXPECT_FLOAT_EQ(test.m_m[y][x],sum);
+    }
+  }
+  ngl::Mat4 eq=s_b;
+  eq*=s_a;
+  EXPECT_TRUE(eq == test);
+}
+
+TEST(NGLMat4,transposeGeneral)
+{
+  ngl::Mat4 test=s_a;
+  test.transpose();
+  for(int y=0; y<4; ++y)
+  {
+    for(int x=0; x<4; ++x)
+    {
+      EXPECT_FLOAT_EQ(test.m_m[y][x],s_a.m_m[x][y]);
+    }
+  }
+}
+
+TEST(NGLMat4,inverseGeneral)
+{
+  ngl::Mat4 test=s_a;
+  ngl::Mat4 inv=test.inverse();
+  ngl::Mat4 result;
+  EXPECT_TRUE(inv*s_a == result)<<print(inv*s_a);
+  EXPECT_TRUE(s_a*inv == result)<<print(s_a*inv);
+  EXPECT_TRUE(inv.inverse() == s_a)<<print(inv.inverse());
+}
+
+TEST(NGLMat4,Mat4xVec4General)
+{
+  ngl::Vec4 v(1.0f,-2.0f,0.5f,3.0f);
+  ngl::Vec4 test=s_a*v;
+  ngl::Vec4 result(1.0f*1.0f+2.0f*-2.0f+0.5f*0.5f,
+                   -1.0f*1.0f+3.0f*-2.0f+1.0f*0.5f+0.25f*3.0f,
+                   -2.0f*-2.0f+4.0f*0.5f+1.0f*3.0f,
+                   2.0f*1.0f+1.0f*-2.0f-1.0f*0.5f+1.0f*3.0f);
+  EXPECT_TRUE(test == result);
+}
+
 /* after thinking about it this is not a valid test!
 class EulerTestRot : public ::testing::TestWithParam<ngl::Real> {
   // You can implement all the usual fixture class members here.
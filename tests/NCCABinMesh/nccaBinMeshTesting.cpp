@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/Obj.h>
+#include <ngl/NCCABinMesh.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// unit cube with uv's and per face normals
+static const char *s_cube=
+"v -1 -1  1\nv  1 -1  1\nv  1  1  1\nv -1  1  1\n"
+"v -1 -1 -1\nv  1 -1 -1\nv  1  1 -1\nv -1  1 -1\n"
+"vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+"vn 0 0 1\nvn 0 0 -1\nvn 1 0 0\nvn -1 0 0\nvn 0 1 0\nvn 0 -1 0\n"
+"f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+"f 6/1/2 5/2/2 8/3/2 7/4/2\n"
+"f 2/1/3 6/2/3 7/3/3 3/4/3\n"
+"f 5/1/4 1/2/4 4/3/4 8/4/4\n"
+"f 4/1/5 3/2/5 7/3/5 8/4/5\n"
+"f 5/1/6 6/2/6 2/3/6 1/4/6\n";
+
+uint32_t index(const ngl::NCCABinMesh::BinaryData &_data, size_t _i)
+{
+  if(_data.m_indexBytes==2)
+  {
+    return static_cast<const uint16_t *>(_data.m_indices)[_i];
+  }
+  return static_cast<const uint32_t *>(_data.m_indices)[_i];
+}
+
+TEST(NGLNCCABinMesh,SaveLoadV2)
+{
+  {
+    std::ofstream out("cube.obj");
+    out<<s_cube;
+  }
+  ngl::Obj obj;
+  ASSERT_TRUE(obj.load("cube.obj",false));
+  ASSERT_TRUE(obj.saveNCCABinaryMesh("cube.nglbin"));
+
+  ngl::NCCABinMesh mesh;
+  ASSERT_TRUE(mesh.load("cube.nglbin",false));
+  EXPECT_EQ(mesh.getVersion(),2u);
+  EXPECT_EQ(mesh.getNumVerts(),8u);
+  EXPECT_EQ(mesh.getNumNormals(),6u);
+  EXPECT_EQ(mesh.getNumFaces(),6u);
+  const auto &data=mesh.getData();
+  EXPECT_EQ(data.m_numVertices,obj.getIndices().size());
+  EXPECT_EQ(data.m_numIndices,36u);
+  EXPECT_EQ(data.m_indexBytes,2u);
+  ASSERT_TRUE(data.m_normals!=nullptr);
+  ASSERT_TRUE(data.m_uvs!=nullptr);
+  // the streams are 64 byte aligned in the mapped file
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(data.m_positions)%64,0u);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(data.m_indices)%64,0u);
+  // every stored triangle corner must match the obj data
+  const ngl::FaceList &faces=obj.getFaceList();
+  auto verts=obj.getVertexList();
+  auto normals=obj.getNormalList();
+  auto uvs=obj.getTextureCordList();
+  size_t i=0;
+  for(auto f : faces)
+  {
+    for(uint32_t k=1; k+1<f.numVerts(); ++k)
+    {
+      const uint32_t corners[3]={0,k,k+1};
+      for(auto c : corners)
+      {
+        uint32_t v=index(data,i++);
+        ASSERT_LT(v,data.m_numVertices);
+        EXPECT_FLOAT_EQ(data.m_positions[v*3],verts[f.vert(c)].m_x);
+        EXPECT_FLOAT_EQ(data.m_positions[v*3+1],verts[f.vert(c)].m_y);
+        EXPECT_FLOAT_EQ(data.m_positions[v*3+2],verts[f.vert(c)].m_z);
+        EXPECT_FLOAT_EQ(data.m_normals[v*3+2],normals[f.norm(c)].m_z);
+        EXPECT_FLOAT_EQ(data.m_uvs[v*2],uvs[f.tex(c)].m_x);
+      }
+    }
+  }
+  EXPECT_FLOAT_EQ(data.m_min.m_x,-1.0f);
+  EXPECT_FLOAT_EQ(data.m_max.m_y,1.0f);
+  // re-saving the loaded data must give an identical file
+  ASSERT_TRUE(mesh.save("cube2.nglbin"));
+  std::ifstream a("cube.nglbin",std::ios::binary);
+  std::ifstream b("cube2.nglbin",std::ios::binary);
+  std::string fileA((std::istreambuf_iterator<char>(a)),std::istreambuf_iterator<char>());
+  std::string fileB((std::istreambuf_iterator<char>(b)),std::istreambuf_iterator<char>());
+  EXPECT_TRUE(fileA==fileB);
+  std::remove("cube.obj");
+  std::remove("cube.nglbin");
+  std::remove("cube2.nglbin");
+}
+
+// write a version 1 file as the old saver did, two triangles forming a quad (6 packed corners)
+void writeV1(const char *_fname)
+{
+  std::ofstream out(_fname,std::ios::binary);
+  out.write("ngl::bin",8);
+  uint64_t counts[4]={4,1,4,1};
+  out.write(reinterpret_cast<const char *>(counts),sizeof(counts));
+  float center[3]={0.5f,0.0f,0.5f};
+  out.write(reinterpret_cast<const char *>(center),sizeof(center));
+  char texture=0;
+  out.write(&texture,1);
+  float bounds[6]={1,0,1,0,0,0};
+  out.write(reinterpret_cast<const char *>(bounds),sizeof(bounds));
+  uint32_t pack[3]={GL_TRIANGLES,6,8};
+  out.write(reinterpret_cast<const char *>(pack),sizeof(pack));
+  // u,v,nx,ny,nz,x,y,z
+  const float corners[4][8]=
+  {
+    {0,0,0,1,0,0,0,0},
+    {1,0,0,1,0,1,0,0},
+    {1,1,0,1,0,1,0,1},
+    {0,1,0,1,0,0,0,1}
+  };
+  const int order[6]={0,1,2,0,2,3};
+  uint32_t size=6*8*sizeof(float);
+  out.write(reinterpret_cast<const char *>(&size),sizeof(size));
+  for(auto c : order)
+  {
+    out.write(reinterpret_cast<const char *>(corners[c]),8*sizeof(float));
+  }
+  uint32_t numIndices=0;
+  out.write(reinterpret_cast<const char *>(&numIndices),sizeof(numIndices));
+}
+
+TEST(NGLNCCABinMesh,ConvertV1)
+{
+  writeV1("quad.v1");
+  ngl::NCCABinMesh v1;
+  ASSERT_TRUE(v1.load("quad.v1",false));
+  EXPECT_EQ(v1.getVersion(),1u);
+  EXPECT_EQ(v1.getData().m_numVertices,4u);
+  EXPECT_EQ(v1.getData().m_numIndices,6u);
+
+  ASSERT_TRUE(ngl::NCCABinMesh::convert("quad.v1","quad.v2"));
+  ngl::NCCABinMesh v2;
+  ASSERT_TRUE(v2.load("quad.v2",false));
+  EXPECT_EQ(v2.getVersion(),2u);
+  EXPECT_EQ(v2.getNumVerts(),4u);
+  const auto &data=v2.getData();
+  ASSERT_EQ(data.m_numVertices,4u);
+  ASSERT_EQ(data.m_numIndices,6u);
+  const uint32_t expected[6]={0,1,2,0,2,3};
+  for(size_t i=0; i<6; ++i)
+  {
+    EXPECT_EQ(index(data,i),expected[i]);
+  }
+  EXPECT_FLOAT_EQ(data.m_positions[2*3],1.0f);
+  EXPECT_FLOAT_EQ(data.m_positions[2*3+2],1.0f);
+  EXPECT_FLOAT_EQ(data.m_normals[1],1.0f);
+  EXPECT_FLOAT_EQ(data.m_uvs[2*2+1],1.0f);
+  EXPECT_FLOAT_EQ(data.m_center.m_x,0.5f);
+  EXPECT_FLOAT_EQ(data.m_max.m_z,1.0f);
+  std::remove("quad.v1");
+  std::remove("quad.v2");
+}
+
+TEST(NGLNCCABinMesh,EmptyV1)
+{
+  // a version 1 file with no corners loads as an empty mesh
+  std::ofstream out("empty.v1",std::ios::binary);
+  out.write("ngl::bin",8);
+  char header[4*8+3*4+1+6*4+4*4]={0};
+  // pack size of 8 floats and 0 bytes of data
+  header[4*8+3*4+1+6*4+8]=8;
+  out.write(header,sizeof(header));
+  out.close();
+  ngl::NCCABinMesh mesh;
+  ASSERT_TRUE(mesh.load("empty.v1",false));
+  EXPECT_EQ(mesh.getData().m_numVertices,0u);
+  EXPECT_EQ(mesh.getData().m_numIndices,0u);
+  std::remove("empty.v1");
+}
+
+TEST(NGLNCCABinMesh,RejectBadFiles)
+{
+  {
+    std::ofstream out("bad.nglbin",std::ios::binary);
+    out<<"not a mesh";
+  }
+  ngl::NCCABinMesh mesh;
+  EXPECT_FALSE(mesh.load("bad.nglbin",false));
+  EXPECT_FALSE(mesh.load("doesNotExist.nglbin",false));
+  // a truncated v2 file must fail rather than point past the end of the mapping
+  {
+    std::ofstream out("cube.obj");
+    out<<s_cube;
+  }
+  ngl::Obj obj;
+  ASSERT_TRUE(obj.load("cube.obj",false));
+  ASSERT_TRUE(obj.saveNCCABinaryMesh("cube.nglbin"));
+  std::ifstream in("cube.nglbin",std::ios::binary);
+  std::string file((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+  {
+    std::ofstream out("bad.nglbin",std::ios::binary);
+    out.write(file.data(),static_cast<std::streamsize>(file.size()-8));
+  }
+  EXPECT_FALSE(mesh.load("bad.nglbin",false));
+  // a vertex count which wraps the section size to 0 must not get past the size checks
+  auto writeModified=[&file](size_t _offset, const void *_value, size_t _size)
+  {
+    std::string modified(file);
+    modified.replace(_offset,_size,static_cast<const char *>(_value),_size);
+    std::ofstream out("bad.nglbin",std::ios::binary);
+    out.write(modified.data(),static_cast<std::streamsize>(modified.size()));
+  };
+  uint64_t numVertices=1ULL<<62;
+  writeModified(16,&numVertices,sizeof(numVertices));
+  EXPECT_FALSE(mesh.load("bad.nglbin",false));
+  // as must an index past the end of the vertex streams
+  uint64_t indexOffset;
+  std::memcpy(&indexOffset,&file[88+3*8],sizeof(indexOffset));
+  uint16_t badIndex=0xffff;
+  writeModified(indexOffset,&badIndex,sizeof(badIndex));
+  EXPECT_FALSE(mesh.load("bad.nglbin",false));
+  writeModified(indexOffset,&file[indexOffset],sizeof(badIndex));
+  EXPECT_TRUE(mesh.load("bad.nglbin",false));
+  std::remove("bad.nglbin");
+  std::remove("cube.obj");
+  std::remove("cube.nglbin");
+}
@@ -0,0 +1,109 @@
+#include <ngl/Obj.h>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// compares the CPU side of NCCAPointBake::setMeshToFrame, the old path writes every position into the
+// interleaved u,v,nx,ny,nz,x,y,z VBO by walking the face list, the position stream path (createAnimatedVAO)
+// gathers into a tightly packed buffer with the precomputed remap. No GL context is needed, the
+// mapped VBO is simulated by a std::vector so only the remap and scatter are timed.
+static const uint32_t s_gridSize=1000;
+
+// a triangulated grid of s_gridSize x s_gridSize quads
+class GridMesh : public ngl::Obj
+{
+public :
+  void generate()
+  {
+    for(uint32_t y=0; y<=s_gridSize; ++y)
+    {
+      for(uint32_t x=0; x<=s_gridSize; ++x)
+      {
+        m_verts.push_back(ngl::Vec3(float(x),0.0f,float(y)));
+      }
+    }
+    for(uint32_t y=0; y<s_gridSize; ++y)
+    {
+      for(uint32_t x=0; x<s_gridSize; ++x)
+      {
+        uint32_t a=y*(s_gridSize+1)+x;
+        uint32_t b=a+1;
+        uint32_t c=a+s_gridSize+1;
+        uint32_t d=c+1;
+        const uint32_t t0[3]={a,b,d};
+        const uint32_t t1[3]={a,d,c};
+        m_face.addFace(3,t0,nullptr,nullptr);
+        m_face.addFace(3,t1,nullptr,nullptr);
+      }
+    }
+    m_nVerts=static_cast<unsigned int>(m_verts.size());
+    m_nFaces=static_cast<unsigned int>(m_face.size());
+    buildPositionRemap();
+  }
+};
+
+static GridMesh s_mesh;
+static std::vector<ngl::Vec3> s_frame;
+static std::vector<float> s_interleaved;
+static std::vector<ngl::Vec3> s_stream;
+
+// this is the loop setMeshToFrame used before the position stream
+BENCHMARK(PointBakePlayback, InterleavedScatter, 10, 10)
+{
+  const ngl::FaceList &faces=s_mesh.getFaceList();
+  const std::vector<uint32_t> &offsets=faces.offsets();
+  const std::vector<uint32_t> &vertIndex=faces.vertIndices();
+  float *ptr=s_interleaved.data();
+  unsigned int step=0;
+  for(size_t f=0; f<faces.size(); ++f)
+  {
+    uint32_t first=offsets[f];
+    for(uint32_t k=first+1; k+1<offsets[f+1]; ++k)
+    {
+      const uint32_t corners[3]={first,k,k+1};
+      for(auto c : corners)
+      {
+        const ngl::Vec3 &v=s_frame[vertIndex[c]];
+        ptr[step+5]=v.m_x;
+        ptr[step+6]=v.m_y;
+        ptr[step+7]=v.m_z;
+        step+=8;
+      }
+    }
+  }
+}
+
+BENCHMARK(PointBakePlayback, PositionStream, 10, 10)
+{
+  s_mesh.remapPositions(s_frame,s_stream);
+}
+
+
+int main(int argc, char **argv)
+{
+  s_mesh.generate();
+  s_frame=s_mesh.getVertexList();
+  for(auto &v : s_frame)
+  {
+    v.m_y=0.1f*std::sin(v.m_x*0.1f)*std::cos(v.m_z*0.1f);
+  }
+  size_t corners=s_mesh.getPositionRemap().size();
+  s_interleaved.resize(corners*8);
+  s_mesh.remapPositions(s_frame,s_stream);
+  std::cout<<s_mesh.getNumFaces()<<" triangles "<<corners<<" corners\n";
+  // the old path maps the whole buffer read / write, the new one only uploads positions
+  std::cout<<"interleaved bytes per frame "<<corners*8*sizeof(float)<<" (mapped GL_READ_WRITE)\n";
+  std::cout<<"position stream bytes per frame "<<corners*sizeof(ngl::Vec3)<<" (glBufferSubData)\n";
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+  return result;
+}
@@ -0,0 +1,413 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/NCCAPointBake.h>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// gives us access to fill in the bake data directly
+class TestBake : public ngl::NCCAPointBake
+{
+public :
+  void generate(unsigned int _frames, unsigned int _verts)
+  {
+    m_numFrames=_frames;
+    m_nVerts=_verts;
+    m_startFrame=1;
+    m_data.resize(_frames);
+    for(unsigned int f=0; f<_frames; ++f)
+    {
+      m_data[f].resize(_verts);
+      for(unsigned int v=0; v<_verts; ++v)
+      {
+        m_data[f][v].set(value(f,v,0),value(f,v,1),value(f,v,2));
+      }
+    }
+  }
+  static float value(unsigned int _f, unsigned int _v, unsigned int _c)
+  {
+    return std::sin(0.1f*_f+0.01f*_v+_c);
+  }
+};
+
+void checkFrame(ngl::NCCAPointBake &_bake, unsigned int _f)
+{
+  const std::vector<ngl::Vec3> &frame=_bake.getRawDataPointerAtFrame(_f);
+  ASSERT_EQ(frame.size(),_bake.getNumVerts());
+  for(unsigned int v=0; v<frame.size(); ++v)
+  {
+    ASSERT_FLOAT_EQ(frame[v].m_x,TestBake::value(_f,v,0));
+    ASSERT_FLOAT_EQ(frame[v].m_y,TestBake::value(_f,v,1));
+    ASSERT_FLOAT_EQ(frame[v].m_z,TestBake::value(_f,v,2));
+  }
+}
+
+TEST(NGLNCCAPointBake,SaveLoadBinary)
+{
+  TestBake bake;
+  bake.generate(20,1000);
+  ASSERT_TRUE(bake.saveBinaryPointBake("bake.binpb"));
+  ngl::NCCAPointBake load;
+  ASSERT_TRUE(load.loadBinaryPointBake("bake.binpb"));
+  EXPECT_FALSE(load.isStreaming());
+  EXPECT_EQ(load.getNumVerts(),1000u);
+  EXPECT_EQ(load.getRawDataPointer().size(),20u);
+  for(unsigned int f=0; f<20; ++f)
+  {
+    checkFrame(load,f);
+  }
+  std::remove("bake.binpb");
+}
+
+TEST(NGLNCCAPointBake,StreamBinary)
+{
+  TestBake bake;
+  bake.generate(50,2000);
+  ASSERT_TRUE(bake.saveBinaryPointBake("bake.binpb"));
+  ngl::NCCAPointBake stream;
+  ASSERT_TRUE(stream.openBinaryPointBake("bake.binpb",4,2));
+  EXPECT_TRUE(stream.isStreaming());
+  EXPECT_TRUE(stream.getRawDataPointer().empty());
+  EXPECT_EQ(stream.getNumVerts(),2000u);
+  // forward playback then random access, more frames than the cache holds
+  for(unsigned int f=0; f<50; ++f)
+  {
+    checkFrame(stream,f);
+  }
+  const unsigned int frames[]={49,3,17,3,0,48,25,26,27,12};
+  for(auto f : frames)
+  {
+    checkFrame(stream,f);
+  }
+  // can't write over the file we are reading
+  EXPECT_FALSE(stream.saveBinaryPointBake("bake.binpb"));
+  // but can save somewhere else from the stream
+  ASSERT_TRUE(stream.saveBinaryPointBake("bake2.binpb"));
+  ngl::NCCAPointBake load;
+  ASSERT_TRUE(load.loadBinaryPointBake("bake2.binpb"));
+  checkFrame(load,31);
+  std::remove("bake.binpb");
+  std::remove("bake2.binpb");
+}
+
+// check a frame which has already been handed out still holds the right values
+void checkHeldFrame(const std::vector<ngl::Vec3> &_frame, unsigned int _f)
+{
+  for(unsigned int v=0; v<_frame.size(); ++v)
+  {
+    ASSERT_FLOAT_EQ(_frame[v].m_x,TestBake::value(_f,v,0));
+    ASSERT_FLOAT_EQ(_frame[v].m_z,TestBake::value(_f,v,2));
+  }
+}
+
+TEST(NGLNCCAPointBake,StreamHoldTwoFrames)
+{
+  TestBake bake;
+  bake.generate(40,2000);
+  ASSERT_TRUE(bake.saveBinaryPointBake("bake.binpb"));
+  ngl::NCCAPointBake stream;
+  // the smallest cache so the prefetch thread is always looking for a slot to evict
+  ASSERT_TRUE(stream.openBinaryPointBake("bake.binpb",1,2));
+  // jump about so the frames prefetched after the second request have to evict something older
+  for(unsigned int i=0; i<20; ++i)
+  {
+    unsigned int f=(i*7)%20;
+    const std::vector<ngl::Vec3> &a=stream.getRawDataPointerAtFrame(f);
+    const std::vector<ngl::Vec3> &b=stream.getRawDataPointerAtFrame(f+20);
+    // give the prefetch of f+21 and f+22 time to run before reading the frames we hold
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    checkHeldFrame(a,f);
+    checkHeldFrame(b,f+20);
+  }
+  std::remove("bake.binpb");
+}
+
+// the original format, a 27 byte header and the frames with no table
+void writeV1(const char *_fname, unsigned int _frames, unsigned int _verts)
+{
+  std::ofstream out(_fname,std::ios::binary);
+  out.write("ngl::binpb",10);
+  unsigned int header[4]={_frames,0,_verts,1};
+  out.write(reinterpret_cast<const char *>(header),sizeof(header));
+  char bin=1;
+  out.write(&bin,1);
+  for(unsigned int f=0; f<_frames; ++f)
+  {
+    for(unsigned int v=0; v<_verts; ++v)
+    {
+      for(unsigned int c=0; c<3; ++c)
+      {
+        float value=TestBake::value(f,v,c);
+        out.write(reinterpret_cast<const char *>(&value),sizeof(float));
+      }
+    }
+  }
+}
+
+TEST(NGLNCCAPointBake,ReadVersion1)
+{
+  writeV1("bake.v1",10,100);
+  ngl::NCCAPointBake load;
+  ASSERT_TRUE(load.loadBinaryPointBake("bake.v1"));
+  checkFrame(load,0);
+  checkFrame(load,9);
+  ngl::NCCAPointBake stream;
+  ASSERT_TRUE(stream.openBinaryPointBake("bake.v1",2,0));
+  for(unsigned int f=0; f<10; ++f)
+  {
+    checkFrame(stream,9-f);
+  }
+  std::remove("bake.v1");
+}
+
+TEST(NGLNCCAPointBake,RejectTruncated)
+{
+  writeV1("bake.v1",10,100);
+  std::ifstream in("bake.v1",std::ios::binary);
+  std::string file((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+  {
+    std::ofstream out("bad.binpb",std::ios::binary);
+    out.write(file.data(),static_cast<std::streamsize>(file.size()-4));
+  }
+  ngl::NCCAPointBake load;
+  EXPECT_FALSE(load.loadBinaryPointBake("bad.binpb"));
+  EXPECT_FALSE(load.openBinaryPointBake("bad.binpb"));
+  EXPECT_FALSE(load.loadBinaryPointBake("missing.binpb"));
+  std::remove("bake.v1");
+  std::remove("bad.binpb");
+}
+
+void checkFrameNear(ngl::NCCAPointBake &_bake, unsigned int _f, float _tolerance)
+{
+  const std::vector<ngl::Vec3> &frame=_bake.getRawDataPointerAtFrame(_f);
+  ASSERT_EQ(frame.size(),_bake.getNumVerts());
+  for(unsigned int v=0; v<frame.size(); ++v)
+  {
+    ASSERT_NEAR(frame[v].m_x,TestBake::value(_f,v,0),_tolerance);
+    ASSERT_NEAR(frame[v].m_y,TestBake::value(_f,v,1),_tolerance);
+    ASSERT_NEAR(frame[v].m_z,TestBake::value(_f,v,2),_tolerance);
+  }
+}
+
+size_t fileSize(const char *_fname)
+{
+  std::ifstream in(_fname,std::ios::binary | std::ios::ate);
+  return static_cast<size_t>(in.tellg());
+}
+
+TEST(NGLNCCAPointBake,SaveLoadCompressed)
+{
+  TestBake bake;
+  bake.generate(40,5000);
+  const float tolerance=0.0005f;
+  ASSERT_TRUE(bake.saveBinaryPointBake("bake.binpb"));
+  ASSERT_TRUE(bake.saveCompressedPointBake("bake.qpb",tolerance,16));
+  EXPECT_LT(fileSize("bake.qpb")*3,fileSize("bake.binpb"));
+  ngl::NCCAPointBake load;
+  ASSERT_TRUE(load.loadBinaryPointBake("bake.qpb"));
+  EXPECT_EQ(load.getNumVerts(),5000u);
+  EXPECT_EQ(load.getRawDataPointer().size(),40u);
+  // allow for the float rounding of the reconstructed value
+  for(unsigned int f=0; f<40; ++f)
+  {
+    checkFrameNear(load,f,tolerance+1e-6f);
+  }
+  std::remove("bake.binpb");
+  std::remove("bake.qpb");
+}
+
+TEST(NGLNCCAPointBake,StreamCompressed)
+{
+  TestBake bake;
+  bake.generate(50,2000);
+  const float tolerance=0.001f;
+  ASSERT_TRUE(bake.saveCompressedPointBake("bake.qpb",tolerance,8));
+  ngl::NCCAPointBake stream;
+  ASSERT_TRUE(stream.openBinaryPointBake("bake.qpb",4,2));
+  for(unsigned int f=0; f<50; ++f)
+  {
+    checkFrameNear(stream,f,tolerance+1e-6f);
+  }
+  // seeking has to decode from the keyframe before
+  const unsigned int frames[]={49,3,17,3,0,48,25,26,27,12,7,8};
+  for(auto f : frames)
+  {
+    checkFrameNear(stream,f,tolerance+1e-6f);
+  }
+  // re-compressing from the stream gives the same values
+  ASSERT_TRUE(stream.saveCompressedPointBake("bake2.qpb",tolerance,8));
+  ngl::NCCAPointBake load;
+  ASSERT_TRUE(load.loadBinaryPointBake("bake2.qpb"));
+  for(unsigned int f=0; f<50; f+=7)
+  {
+    const std::vector<ngl::Vec3> &a=load.getRawDataPointerAtFrame(f);
+    const std::vector<ngl::Vec3> &b=stream.getRawDataPointerAtFrame(f);
+    for(unsigned int v=0; v<a.size(); ++v)
+    {
+      ASSERT_EQ(a[v],b[v]);
+    }
+  }
+  std::remove("bake.qpb");
+  std::remove("bake2.qpb");
+}
+
+TEST(NGLNCCAPointBake,CompressedLargeMotion)
+{
+  // jumps far bigger than the frame extents and a static frame, exercising every frame type
+  TestBake bake;
+  bake.generate(12,300);
+  std::vector<std::vector<ngl::Vec3>> &data=bake.getRawDataPointer();
+  for(auto &v : data[5])
+  {
+    v+=ngl::Vec3(5000.0f,-3000.0f,0.0f);
+  }
+  data[6]=data[5];
+  ASSERT_TRUE(bake.saveCompressedPointBake("bake.qpb",0.001f,100));
+  ngl::NCCAPointBake load;
+  ASSERT_TRUE(load.loadBinaryPointBake("bake.qpb"));
+  for(unsigned int f=0; f<12; ++f)
+  {
+    const std::vector<ngl::Vec3> &a=load.getRawDataPointerAtFrame(f);
+    for(unsigned int v=0; v<a.size(); ++v)
+    {
+      // floats near 5000 only have ~0.0005 precision
+      ASSERT_NEAR(a[v].m_x,data[f][v].m_x,0.0015f);
+      ASSERT_NEAR(a[v].m_y,data[f][v].m_y,0.0015f);
+      ASSERT_NEAR(a[v].m_z,data[f][v].m_z,0.0015f);
+    }
+  }
+  EXPECT_FALSE(bake.saveCompressedPointBake("bake.qpb",0.0f));
+  std::remove("bake.qpb");
+}
+
+TEST(NGLNCCAPointBake,RejectCorruptCompressed)
+{
+  TestBake bake;
+  bake.generate(4,1000);
+  ASSERT_TRUE(bake.saveCompressedPointBake("bake.qpb",0.001f));
+  std::string file;
+  {
+    std::ifstream in("bake.qpb",std::ios::binary);
+    file.assign((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+  }
+  // scribble over the first frame's plane data, decoding must not read or write out of bounds
+  for(size_t i=64+88; i<64+400 && i<file.size(); ++i)
+  {
+    file[i]=static_cast<char>(i*37);
+  }
+  {
+    std::ofstream out("bad.qpb",std::ios::binary);
+    out.write(file.data(),static_cast<std::streamsize>(file.size()));
+  }
+  // a full load fails and keeps what was loaded before
+  ngl::NCCAPointBake load;
+  ASSERT_TRUE(load.loadBinaryPointBake("bake.qpb"));
+  EXPECT_FALSE(load.loadBinaryPointBake("bad.qpb"));
+  EXPECT_EQ(load.getRawDataPointer().size(),4u);
+  // streaming gives a zeroed frame and reports it
+  ngl::NCCAPointBake stream;
+  ASSERT_TRUE(stream.openBinaryPointBake("bad.qpb",4,0));
+  EXPECT_FALSE(stream.hasCorruptFrames());
+  EXPECT_EQ(stream.getRawDataPointerAtFrame(0).size(),1000u);
+  EXPECT_TRUE(stream.hasCorruptFrames());
+  std::remove("bake.qpb");
+  std::remove("bad.qpb");
+}
+
+// write an xml bake the way the maya exporter does (numbers are written with enough digits to round trip)
+void writeXML(const char *_fname, unsigned int _frames, unsigned int _verts, bool _truncate=false)
+{
+  std::ofstream out(_fname);
+  out<<"<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n<NCCAPointBake>\n";
+  out<<"  <MeshName>pPlane1</MeshName>\n  <NumVerts>"<<_verts<<"</NumVerts>\n";
+  out<<"  <StartFrame>1</StartFrame>\n  <EndFrame>"<<_frames<<"</EndFrame>\n";
+  out<<"  <NumFrames>"<<_frames<<"</NumFrames>\n  <TranslateMode>absolute</TranslateMode>\n";
+  out<<std::setprecision(9);
+  for(unsigned int f=0; f<_frames; ++f)
+  {
+    out<<"  <Frame number=\""<<f+1<<"\">\n";
+    for(unsigned int v=0; v<_verts; ++v)
+    {
+      out<<"    <Vertex number=\""<<v<<"\" attrib=\"translate\"> "<<TestBake::value(f,v,0)<<" "
+         <<TestBake::value(f,v,1)<<" "<<TestBake::value(f,v,2)<<" </Vertex>\n";
+      if(_truncate && f==_frames-1 && v==_verts/2)
+      {
+        out<<"    <Vertex number=\""<<v+1<<"\" attrib=\"translate\"> 0.1234";
+        return;
+      }
+    }
+    out<<"  </Frame>\n";
+  }
+  out<<"</NCCAPointBake>\n";
+}
+
+TEST(NGLNCCAPointBake,LoadXML)
+{
+  writeXML("bake.xml",30,500);
+  for(unsigned int threads : {1u,3u,0u})
+  {
+    ngl::NCCAPointBake load;
+    ASSERT_TRUE(load.loadPointBake("bake.xml",threads));
+    EXPECT_EQ(load.getNumVerts(),500u);
+    EXPECT_EQ(load.getRawDataPointer().size(),30u);
+    for(unsigned int f=0; f<30; ++f)
+    {
+      checkFrame(load,f);
+    }
+  }
+  std::remove("bake.xml");
+}
+
+TEST(NGLNCCAPointBake,LoadXMLLayout)
+{
+  // attributes in any order, other white space and elements we don't know about
+  {
+    std::ofstream out("bake.xml");
+    out<<"<NCCAPointBake>\r\n<NumFrames>2</NumFrames><NumVerts> 2 </NumVerts>\r\n<StartFrame>10</StartFrame>\r\n";
+    out<<"<Frame number='11'><Vertex attrib=\"translate\" number = \"1\">1e2\t-2.5\r\n+3</Vertex>\r\n";
+    out<<"<Vertex number=\"0\">4 5 6</Vertex><Extra/></Frame>\r\n";
+    out<<"<Frame number=\"10\" ><Vertex number=\"0\">-1 -2 -3</Vertex><Vertex number=\"1\">.5 1.5e-1 7.</Vertex></Frame>\r\n";
+    out<<"</NCCAPointBake>";
+  }
+  ngl::NCCAPointBake load;
+  ASSERT_TRUE(load.loadPointBake("bake.xml"));
+  std::vector<std::vector<ngl::Vec3>> &data=load.getRawDataPointer();
+  ASSERT_EQ(data.size(),2u);
+  EXPECT_EQ(data[0][0],ngl::Vec3(-1.0f,-2.0f,-3.0f));
+  EXPECT_EQ(data[0][1],ngl::Vec3(0.5f,0.15f,7.0f));
+  EXPECT_EQ(data[1][0],ngl::Vec3(4.0f,5.0f,6.0f));
+  EXPECT_EQ(data[1][1],ngl::Vec3(100.0f,-2.5f,3.0f));
+  std::remove("bake.xml");
+}
+
+TEST(NGLNCCAPointBake,RejectBadXML)
+{
+  ngl::NCCAPointBake load;
+  EXPECT_FALSE(load.loadPointBake("missing.xml"));
+  writeV1("bake.v1",2,10);
+  EXPECT_FALSE(load.loadPointBake("bake.v1"));
+  std::remove("bake.v1");
+  {
+    std::ofstream out("bake.xml");
+    out<<"<NCCAPointBake><MeshName>x</MeshName><NumVerts>3</NumVerts></NCCAPointBake>";
+  }
+  EXPECT_FALSE(load.loadPointBake("bake.xml"));
+  // the frames before the truncated one are still read
+  writeXML("bake.xml",4,100,true);
+  EXPECT_TRUE(load.loadPointBake("bake.xml",2));
+  checkFrame(load,0);
+  checkFrame(load,2);
+  std::remove("bake.xml");
+}
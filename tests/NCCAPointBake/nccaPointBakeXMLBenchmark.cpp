@@ -0,0 +1,162 @@
+#include <ngl/NCCAPointBake.h>
+#include <ngl/rapidxml/rapidxml.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/tokenizer.hpp>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <sys/resource.h>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+// generates a large xml point bake and loads it with the streaming reader (serial and parallel) and the
+// previous rapidxml DOM loader. Hayai reports runs / second so MB / second is this multiplied by the
+// file size printed at startup. The peak memory use of a single load of each is printed first.
+static const char *s_fname="benchmark.xml";
+static const unsigned int s_numFrames=100;
+static const unsigned int s_numVerts=5000;
+
+// this is the original loader from NCCAPointBake.cpp kept here for comparison
+class DomPointBake : public ngl::NCCAPointBake
+{
+public :
+  bool loadDom(const std::string &_fileName)
+  {
+    typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
+    std::ifstream xmlFile (_fileName.c_str() );
+    if(!xmlFile.is_open())
+    {
+      return false;
+    }
+    std::vector<char> buffer((std::istreambuf_iterator<char>(xmlFile)), std::istreambuf_iterator<char>());
+    buffer.push_back('\0');
+    rapidxml::xml_document<> doc;
+    doc.parse<rapidxml::parse_trim_whitespace>(&buffer[0]);
+    rapidxml::xml_node<> *rootNode=doc.first_node();
+    rapidxml::xml_node<> * child=rootNode->first_node("MeshName");
+    m_meshName=child->value();
+    child=rootNode->first_node("NumVerts");
+    m_nVerts=boost::lexical_cast<unsigned int>(child->value());
+    child=rootNode->first_node("StartFrame");
+    m_startFrame=boost::lexical_cast<unsigned int>(child->value());
+    child=rootNode->first_node("EndFrame");
+    m_endFrame=boost::lexical_cast<unsigned int>(child->value());
+    child=rootNode->first_node("NumFrames");
+    m_numFrames=boost::lexical_cast< unsigned int>(child->value());
+    m_data.resize(m_numFrames);
+    for(auto &data : m_data)
+    {
+      data.resize(m_nVerts);
+    }
+    std::string lineBuffer;
+    boost::char_separator<char> sep(" \t\r\n");
+    for(child=rootNode->first_node("Frame"); child; child=child->next_sibling())
+    {
+      unsigned int currentFrame=boost::lexical_cast<unsigned int>(child->first_attribute("number")->value());
+      currentFrame-=m_startFrame;
+      for(rapidxml::xml_node<> * vertex=child->first_node("Vertex"); vertex; vertex=vertex->next_sibling())
+      {
+        unsigned int index=boost::lexical_cast<unsigned int>(vertex->first_attribute("number")->value());
+        lineBuffer=vertex->value();
+        tokenizer tokens(lineBuffer, sep);
+        tokenizer::iterator  firstWord = tokens.begin();
+        ngl::Real x=boost::lexical_cast<ngl::Real>(*firstWord++);
+        ngl::Real y=boost::lexical_cast<ngl::Real>(*firstWord++);
+        ngl::Real z=boost::lexical_cast<ngl::Real>(*firstWord++);
+        m_data[currentFrame][index].set(x,y,z);
+      }
+    }
+    return true;
+  }
+};
+
+// write out a rippling plane in the same layout as the maya exporter
+size_t generateXML(const char *_fname)
+{
+  FILE *out=fopen(_fname,"w");
+  if(out==nullptr)
+  {
+    return 0;
+  }
+  fprintf(out,"<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n<NCCAPointBake>\n");
+  fprintf(out,"\t<MeshName>pPlane1</MeshName>\n\t<NumVerts>%u</NumVerts>\n",s_numVerts);
+  fprintf(out,"\t<StartFrame>1</StartFrame>\n\t<EndFrame>%u</EndFrame>\n",s_numFrames);
+  fprintf(out,"\t<NumFrames>%u</NumFrames>\n\t<TranslateMode>absolute</TranslateMode>\n",s_numFrames);
+  for(unsigned int f=0; f<s_numFrames; ++f)
+  {
+    fprintf(out,"\t<Frame number=\"%u\">\n",f+1);
+    for(unsigned int v=0; v<s_numVerts; ++v)
+    {
+      float x=float(v%100)*0.1f-5.0f;
+      float z=float(v/100)*0.1f-5.0f;
+      fprintf(out,"\t\t<Vertex number=\"%u\" attrib=\"translate\"> %f %f %f </Vertex>\n",v,x,0.3f*sinf(x+f*0.1f)*cosf(z),z);
+    }
+    fprintf(out,"\t</Frame>\n");
+  }
+  fprintf(out,"</NCCAPointBake>\n");
+  long size=ftell(out);
+  fclose(out);
+  return static_cast<size_t>(size);
+}
+
+long peakMB()
+{
+  rusage usage;
+  getrusage(RUSAGE_SELF,&usage);
+  return usage.ru_maxrss/1024;
+}
+
+BENCHMARK(PointBakeXML, DomParser, 3, 1)
+{
+  DomPointBake bake;
+  bake.loadDom(s_fname);
+}
+
+BENCHMARK(PointBakeXML, StreamingParser, 5, 1)
+{
+  ngl::NCCAPointBake bake;
+  bake.loadPointBake(s_fname);
+}
+
+BENCHMARK(PointBakeXML, ParallelStreamingParser, 5, 1)
+{
+  ngl::NCCAPointBake bake;
+  bake.loadPointBake(s_fname,0);
+}
+
+
+int main(int argc, char **argv)
+{
+  size_t size=generateXML(s_fname);
+  if(size==0)
+  {
+    std::cerr<<"unable to write "<<s_fname<<"\n";
+    return EXIT_FAILURE;
+  }
+  std::cout<<"Generated "<<s_fname<<" "<<size/(1024*1024)<<" MB, "<<s_numFrames<<" frames of "<<s_numVerts<<" verts\n";
+  // the streaming reader goes first as peak memory only ever grows
+  const size_t dataMB=s_numFrames*s_numVerts*sizeof(ngl::Vec3)/(1024*1024);
+  long base=peakMB();
+  {
+    ngl::NCCAPointBake bake;
+    bake.loadPointBake(s_fname);
+  }
+  long streaming=peakMB();
+  {
+    DomPointBake bake;
+    bake.loadDom(s_fname);
+  }
+  long dom=peakMB();
+  std::cout<<"decoded data "<<dataMB<<" MB, peak memory streaming +"<<streaming-base<<" MB, dom +"<<dom-base<<" MB\n";
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+  std::remove(s_fname);
+  return result;
+}
@@ -0,0 +1,171 @@
+#include <ngl/Obj.h>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include "boost/bind.hpp"
+#include "boost/spirit.hpp"
+#include <cstdio>
+#include <iostream>
+
+// the benchmark generates a large grid mesh and loads it using the current ngl::Obj (serial and
+// parallel) and the previous boost::spirit based loader. Hayai reports runs / second so lines / second is this
+// multiplied by the line count printed at startup.
+static const char *s_fname="benchmark.obj";
+// grid of 1000x1000 quads gives ~2M faces and ~5M lines
+static const int s_gridSize=1000;
+
+namespace spt=boost::spirit;
+typedef spt::rule<spt::phrase_scanner_t> srule;
+
+// this is the original spirit parser from Obj.cpp kept here for comparison
+class SpiritObj : public ngl::Obj
+{
+public :
+  bool load(const std::string& _fname, bool _calcBB=true ) noexcept override
+  {
+    srule comment = spt::comment_p("#");
+    srule vertex= ("v"  >> spt::real_p >> spt::real_p >> spt::real_p) [boost::bind(&SpiritObj::spiritVertex,boost::ref(*this), _1)];
+    srule tex= ("vt" >> spt::real_p >> spt::real_p) [boost::bind(&SpiritObj::spiritTex, boost::ref(*this), _1)];
+    srule norm= ("vn" >> spt::real_p >> spt::real_p >> spt::real_p) [boost::bind(&SpiritObj::spiritNormal,boost::ref(*this), _1)];
+    srule vertex_type = vertex | tex | norm;
+    srule  face = (spt::ch_p('f') >> *(spt::anychar_p))[boost::bind(&SpiritObj::spiritFace, boost::ref(*this), _1)];
+    std::ifstream in(_fname.c_str());
+    if (in.is_open() != true)
+    {
+      return false;
+    }
+    std::string str;
+    while(std::getline(in, str))
+    {
+      spt::parse(str.c_str(), vertex_type  | face | comment, spt::space_p);
+    }
+    m_nVerts=static_cast<unsigned int>(m_verts.size());
+    m_nNorm=static_cast<unsigned int>(m_norm.size());
+    m_nTex=static_cast<unsigned int>(m_tex.size());
+    m_nFaces=static_cast<unsigned int>(m_face.size());
+    return true;
+  }
+
+private :
+  void spiritVertex( const char *_begin ) noexcept
+  {
+    std::vector<ngl::Real> values;
+    srule vertex = "v" >> spt::real_p[spt::append(values)] >> spt::real_p[spt::append(values)] >> spt::real_p[spt::append(values)];
+    spt::parse(_begin, vertex, spt::space_p);
+    m_verts.push_back(ngl::Vec3(values[0],values[1],values[2]));
+  }
+  void spiritTex( const char *_begin ) noexcept
+  {
+    std::vector<ngl::Real> values;
+    srule texcord = "vt" >> spt::real_p[spt::append(values)] >> spt::real_p[spt::append(values)] >> *(spt::real_p[spt::append(values)]);
+    spt::parse(_begin, texcord, spt::space_p);
+    m_tex.push_back(ngl::Vec3(values[0],values[1],values.size() == 3 ? values[2] : 0.0f));
+  }
+  void spiritNormal( const char *_begin ) noexcept
+  {
+    std::vector<ngl::Real> values;
+    srule norm = "vn" >> spt::real_p[spt::append(values)] >> spt::real_p[spt::append(values)] >> spt::real_p[spt::append(values)];
+    spt::parse(_begin, norm, spt::space_p);
+    m_norm.push_back(ngl::Vec3(values[0],values[1],values[2]));
+  }
+  void spiritFace( const char *_begin ) noexcept
+  {
+    std::vector<unsigned int> vec;
+    std::vector<unsigned int> tvec;
+    std::vector<unsigned int> nvec;
+    srule entry = spt::int_p[spt::append(vec)] >>
+      (
+        ("/" >> (spt::int_p[spt::append(tvec)] | spt::epsilon_p) >>
+         "/" >> (spt::int_p[spt::append(nvec)] | spt::epsilon_p)
+        )
+        | spt::epsilon_p
+      );
+    srule face = "f"  >> entry >> entry >> entry >> *(entry);
+    spt::parse(_begin, face, spt::space_p);
+    for(auto &i : vec) { --i; }
+    for(auto &i : tvec) { --i; }
+    for(auto &i : nvec) { --i; }
+    m_face.addFace(static_cast<uint32_t>(vec.size()),vec.data(),
+                   tvec.empty() ? nullptr : tvec.data(),
+                   nvec.empty() ? nullptr : nvec.data());
+  }
+};
+
+// write out a triangulated grid with positions, uv's and normals
+size_t generateObj(const char *_fname, int _size)
+{
+  FILE *out=fopen(_fname,"w");
+  if(out==nullptr)
+  {
+    return 0;
+  }
+  size_t lines=1;
+  fprintf(out,"# generated by objBenchmark\n");
+  for(int y=0; y<=_size; ++y)
+  {
+    for(int x=0; x<=_size; ++x)
+    {
+      float u=float(x)/_size;
+      float v=float(y)/_size;
+      fprintf(out,"v %f %f %f\n",u*2.0f-1.0f,0.1f*sinf(u*20.0f)*cosf(v*20.0f),v*2.0f-1.0f);
+      fprintf(out,"vt %f %f\n",u,v);
+      fprintf(out,"vn 0.0 1.0 0.0\n");
+      lines+=3;
+    }
+  }
+  for(int y=0; y<_size; ++y)
+  {
+    for(int x=0; x<_size; ++x)
+    {
+      int a=y*(_size+1)+x+1;
+      int b=a+1;
+      int c=a+_size+1;
+      int d=c+1;
+      fprintf(out,"f %d/%d/%d %d/%d/%d %d/%d/%d\n",a,a,a,b,b,b,d,d,d);
+      fprintf(out,"f %d/%d/%d %d/%d/%d %d/%d/%d\n",a,a,a,d,d,d,c,c,c);
+      lines+=2;
+    }
+  }
+  fclose(out);
+  return lines;
+}
+
+BENCHMARK(ObjLoad, SpiritParser, 5, 1)
+{
+  SpiritObj mesh;
+  mesh.load(s_fname,false);
+}
+
+BENCHMARK(ObjLoad, ScannerParser, 5, 1)
+{
+  ngl::Obj mesh;
+  mesh.load(s_fname,false);
+}
+
+BENCHMARK(ObjLoad, ParallelScannerParser, 5, 1)
+{
+  ngl::Obj mesh;
+  mesh.loadParallel(s_fname,false);
+}
+
+
+int main(int argc, char **argv)
+{
+  size_t lines=generateObj(s_fname,s_gridSize);
+  if(lines==0)
+  {
+    std::cerr<<"unable to write "<<s_fname<<"\n";
+    return EXIT_FAILURE;
+  }
+  std::cout<<"Generated "<<s_fname<<" with "<<lines<<" lines\n";
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+  std::remove(s_fname);
+  return result;
+}
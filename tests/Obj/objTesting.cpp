@@ -0,0 +1,320 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/Obj.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <array>
+#include <string>
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// unit cube, each quad has its own normal so corners only merge within a face
+static const char *s_cube=
+"v -1 -1  1\nv  1 -1  1\nv  1  1  1\nv -1  1  1\n"
+"v -1 -1 -1\nv  1 -1 -1\nv  1  1 -1\nv -1  1 -1\n"
+"vn 0 0 1\nvn 0 0 -1\nvn 1 0 0\nvn -1 0 0\nvn 0 1 0\nvn 0 -1 0\n"
+"f 1//1 2//1 3//1 4//1\n"
+"f 6//2 5//2 8//2 7//2\n"
+"f 2//3 6//3 7//3 3//3\n"
+"f 5//4 1//4 4//4 8//4\n"
+"f 4//5 3//5 7//5 8//5\n"
+"f 5//6 6//6 2//6 1//6\n";
+
+// same cube without normals so all the corners of a vertex are shared
+static const char *s_cubeNoNormals=
+"v -1 -1  1\nv  1 -1  1\nv  1  1  1\nv -1  1  1\n"
+"v -1 -1 -1\nv  1 -1 -1\nv  1  1 -1\nv -1  1 -1\n"
+"f 1 2 3 4\nf 6 5 8 7\nf 2 6 7 3\nf 5 1 4 8\nf 4 3 7 8\nf 5 6 2 1\n";
+
+void writeFile(const char *_fname, const char *_data)
+{
+  std::ofstream out(_fname);
+  out<<_data;
+}
+
+// the indexed data must expand back to the same corner stream createVAO would build
+void checkExpansion(ngl::Obj &_mesh)
+{
+  const ngl::FaceList &faces=_mesh.getFaceList();
+  const auto &indices=_mesh.getIndices();
+  const auto &out=_mesh.getOutIndices();
+  size_t i=0;
+  for(auto f : faces)
+  {
+    for(uint32_t k=1; k+1<f.numVerts(); ++k)
+    {
+      const uint32_t corners[3]={0,k,k+1};
+      for(auto c : corners)
+      {
+        ASSERT_LT(i,out.size());
+        const ngl::IndexRef &ref=indices[out[i++]];
+        EXPECT_EQ(ref.m_v,f.vert(c));
+        if(f.hasNormals())
+        {
+          EXPECT_EQ(ref.m_n,f.norm(c));
+        }
+      }
+    }
+  }
+  EXPECT_EQ(i,out.size());
+}
+
+TEST(NGLObj,IndexedCubeNormals)
+{
+  writeFile("cube.obj",s_cube);
+  ngl::Obj mesh;
+  ASSERT_TRUE(mesh.load("cube.obj",false));
+  mesh.buildIndexedData();
+  EXPECT_EQ(mesh.getIndices().size(),24u);
+  EXPECT_EQ(mesh.getOutIndices().size(),36u);
+  EXPECT_FLOAT_EQ(mesh.getVertexReuseRatio(),1.5f);
+  checkExpansion(mesh);
+  std::remove("cube.obj");
+}
+
+TEST(NGLObj,IndexedCubeShared)
+{
+  writeFile("cubeNoNormals.obj",s_cubeNoNormals);
+  ngl::Obj mesh;
+  ASSERT_TRUE(mesh.load("cubeNoNormals.obj",false));
+  mesh.buildIndexedData();
+  EXPECT_EQ(mesh.getIndices().size(),8u);
+  EXPECT_EQ(mesh.getOutIndices().size(),36u);
+  EXPECT_FLOAT_EQ(mesh.getVertexReuseRatio(),4.5f);
+  checkExpansion(mesh);
+  std::remove("cubeNoNormals.obj");
+}
+
+TEST(NGLObj,IndexedEmpty)
+{
+  ngl::Obj mesh;
+  mesh.buildIndexedData();
+  EXPECT_TRUE(mesh.getIndices().empty());
+  EXPECT_TRUE(mesh.getOutIndices().empty());
+  EXPECT_FLOAT_EQ(mesh.getVertexReuseRatio(),0.0f);
+}
+
+// the loader drops faces with less than 3 vertices but FaceList::addFace doesn't
+class DegenerateObj : public ngl::Obj
+{
+public :
+  void addFace(uint32_t _numVerts, const uint32_t *_vert) { m_face.addFace(_numVerts,_vert,nullptr,nullptr); }
+};
+
+TEST(NGLObj,IndexedDegenerateFaces)
+{
+  writeFile("degenerate.obj","v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n");
+  DegenerateObj mesh;
+  ASSERT_TRUE(mesh.load("degenerate.obj",false));
+  // lines and points give no triangles (and must not upset the sizing)
+  const uint32_t verts[3]={0,1,2};
+  mesh.addFace(2,verts);
+  mesh.addFace(1,verts);
+  mesh.addFace(1,verts);
+  ASSERT_EQ(mesh.getFaceList().size(),4u);
+  mesh.buildIndexedData();
+  EXPECT_EQ(mesh.getOutIndices().size(),3u);
+  checkExpansion(mesh);
+  std::remove("degenerate.obj");
+}
+
+TEST(NGLObj,ACMRCube)
+{
+  writeFile("cubeNoNormals.obj",s_cubeNoNormals);
+  ngl::Obj mesh;
+  ASSERT_TRUE(mesh.load("cubeNoNormals.obj",false));
+  mesh.buildIndexedData();
+  // all 8 verts fit in the cache so each is only transformed once
+  EXPECT_FLOAT_EQ(mesh.calcACMR(32),8.0f/12.0f);
+  // a 3 entry FIFO can only re-use about the shared fan edge of each quad
+  EXPECT_GT(mesh.calcACMR(3),1.5f);
+  std::remove("cubeNoNormals.obj");
+}
+
+// a grid with the quads written in a scattered order so the cache use is poor
+void writeScatteredGrid(const char *_fname, int _size)
+{
+  std::ofstream out(_fname);
+  for(int y=0; y<=_size; ++y)
+  {
+    for(int x=0; x<=_size; ++x)
+    {
+      out<<"v "<<x<<" 0 "<<y<<"\n";
+    }
+  }
+  int numQuads=_size*_size;
+  // step through the quads with a stride co-prime to the count
+  for(int i=0; i<numQuads; ++i)
+  {
+    int q=(i*7919)%numQuads;
+    int a=(q/_size)*(_size+1)+q%_size+1;
+    int b=a+1;
+    int c=a+_size+1;
+    int d=c+1;
+    out<<"f "<<a<<' '<<b<<' '<<d<<"\nf "<<a<<' '<<d<<' '<<c<<"\n";
+  }
+}
+
+std::vector<std::array<uint32_t,3>> sortedTriangles(ngl::Obj &_mesh)
+{
+  const auto &indices=_mesh.getIndices();
+  const auto &out=_mesh.getOutIndices();
+  std::vector<std::array<uint32_t,3>> tris;
+  for(size_t i=0; i<out.size(); i+=3)
+  {
+    std::array<uint32_t,3> t={{indices[out[i]].m_v,indices[out[i+1]].m_v,indices[out[i+2]].m_v}};
+    // rotate so the smallest index is first, keeping the winding
+    std::rotate(t.begin(),std::min_element(t.begin(),t.end()),t.end());
+    tris.push_back(t);
+  }
+  std::sort(tris.begin(),tris.end());
+  return tris;
+}
+
+TEST(NGLObj,OptimiseIndexedData)
+{
+  writeScatteredGrid("grid.obj",64);
+  ngl::Obj mesh;
+  ASSERT_TRUE(mesh.load("grid.obj",false));
+  mesh.buildIndexedData();
+  auto before=sortedTriangles(mesh);
+  ngl::Real acmrBefore=mesh.calcACMR();
+  mesh.optimiseIndexedData();
+  ngl::Real acmrAfter=mesh.calcACMR();
+  // only the two triangles of each quad share vertices
+  EXPECT_GT(acmrBefore,1.9f);
+  EXPECT_LT(acmrAfter,0.8f);
+  // the same triangles (and windings) must be drawn
+  EXPECT_TRUE(before==sortedTriangles(mesh));
+  // vertices are renumbered in order of first use
+  uint32_t next=0;
+  for(auto i : mesh.getOutIndices())
+  {
+    ASSERT_LE(i,next);
+    if(i==next)
+    {
+      ++next;
+    }
+  }
+  EXPECT_EQ(next,mesh.getIndices().size());
+  std::remove("grid.obj");
+}
+
+TEST(NGLObj,PositionRemap)
+{
+  writeFile("cube.obj",s_cube);
+  ngl::Obj mesh;
+  ASSERT_TRUE(mesh.load("cube.obj",false));
+  mesh.buildPositionRemap();
+  const auto &remap=mesh.getPositionRemap();
+  ASSERT_EQ(remap.size(),36u);
+  // the remap must follow the same fan triangulation as createVAO
+  size_t i=0;
+  for(auto f : mesh.getFaceList())
+  {
+    for(uint32_t k=1; k+1<f.numVerts(); ++k)
+    {
+      EXPECT_EQ(remap[i++],f.vert(0));
+      EXPECT_EQ(remap[i++],f.vert(k));
+      EXPECT_EQ(remap[i++],f.vert(k+1));
+    }
+  }
+  // gather a moved copy of the verts
+  std::vector<ngl::Vec3> moved(mesh.getVertexList());
+  for(auto &v : moved)
+  {
+    v+=ngl::Vec3(1.0f,2.0f,3.0f);
+  }
+  std::vector<ngl::Vec3> stream;
+  mesh.remapPositions(moved,stream);
+  ASSERT_EQ(stream.size(),remap.size());
+  for(size_t c=0; c<stream.size(); ++c)
+  {
+    EXPECT_TRUE(stream[c]==moved[remap[c]]);
+  }
+  EXPECT_FALSE(mesh.hasPositionStream());
+  std::remove("cube.obj");
+}
+
+// a strip of groups, each adding a row of 100 v, vt and vn then the quads joining it to the row before using
+// relative indices, so the faces reach back over the chunk boundaries. The faces cycle through v/vt/vn, v//vn,
+// v/vt and absolute indices, with the odd triangle and pentagon, and the last line has no new line
+void writeStrip(const char *_fname, int _groups)
+{
+  const int row=100;
+  std::ofstream out(_fname);
+  for(int g=0; g<_groups; ++g)
+  {
+    for(int i=0; i<row; ++i)
+    {
+      out<<"v "<<i*0.5f<<' '<<g*0.25f<<' '<<(i*g%7)*0.125f<<'\n';
+      out<<"vt "<<i/float(row)<<' '<<g/float(_groups)<<'\n';
+      out<<"vn 0 "<<(i%3)*0.5f<<" 1\n";
+    }
+    if(g==0)
+    {
+      continue;
+    }
+    for(int i=0; i+1<row; ++i)
+    {
+      // relative indices of this row and the one before
+      int a=-(2*row-i), b=-(2*row-i-1), c=-(row-i-1), d=-(row-i);
+      switch(i%5)
+      {
+        case 0 : out<<"f "<<a<<'/'<<a<<'/'<<a<<' '<<b<<'/'<<b<<'/'<<b<<' '<<c<<'/'<<c<<'/'<<c<<' '
+                    <<d<<'/'<<d<<'/'<<d<<'\n'; break;
+        case 1 : out<<"f "<<a<<"//"<<a<<' '<<b<<"//"<<b<<' '<<c<<"//"<<c<<' '<<d<<"//"<<d<<'\n'; break;
+        case 2 : out<<"f "<<a<<'/'<<a<<' '<<b<<'/'<<b<<' '<<c<<'/'<<c<<'\n'; break;
+        case 3 :
+        {
+          int base=(g-1)*row+i+1;
+          out<<"f "<<base<<'/'<<base<<'/'<<base<<' '<<base+1<<'/'<<base+1<<'/'<<base+1<<' '
+             <<base+row+1<<'/'<<base+row+1<<'/'<<base+row+1<<' '<<base+row<<'/'<<base+row<<'/'<<base+row<<'\n';
+          break;
+        }
+        default : out<<"f "<<a<<"//"<<a<<' '<<b<<"//"<<b<<' '<<c<<"//"<<c<<' '<<d<<"//"<<d<<' '
+                     <<-row*3<<"//"<<-row*3<<'\n'; break;
+      }
+    }
+  }
+  out<<"f -1//-1 -2//-2 -3//-3";
+}
+
+TEST(NGLObj,LoadParallelMatchesLoad)
+{
+  // big enough to be split into several chunks
+  writeStrip("strip.obj",400);
+  ngl::Obj serial;
+  ngl::Obj parallel;
+  ASSERT_TRUE(serial.load("strip.obj",false));
+  ASSERT_TRUE(parallel.loadParallel("strip.obj",false,4));
+  EXPECT_EQ(serial.getVertexList().size(),40000u);
+  EXPECT_TRUE(serial.getVertexList()==parallel.getVertexList());
+  EXPECT_TRUE(serial.getNormalList()==parallel.getNormalList());
+  EXPECT_TRUE(serial.getTextureCordList()==parallel.getTextureCordList());
+  const ngl::FaceList &a=serial.getFaceList();
+  const ngl::FaceList &b=parallel.getFaceList();
+  ASSERT_EQ(a.size(),399u*99u+1u);
+  ASSERT_EQ(a.size(),b.size());
+  EXPECT_EQ(a.offsets(),b.offsets());
+  EXPECT_EQ(a.vertIndices(),b.vertIndices());
+  EXPECT_EQ(a.texIndices(),b.texIndices());
+  EXPECT_EQ(a.normalIndices(),b.normalIndices());
+  for(size_t f=0; f<a.size(); ++f)
+  {
+    EXPECT_EQ(a[f].hasTextureCoords(),b[f].hasTextureCoords());
+    EXPECT_EQ(a[f].hasNormals(),b[f].hasNormals());
+  }
+  // the relative indices of the last face are resolved against the whole file
+  ngl::FaceList::Face last=b[b.size()-1];
+  EXPECT_EQ(last.vert(0),39999u);
+  EXPECT_EQ(last.norm(2),39997u);
+  std::remove("strip.obj");
+}
@@ -0,0 +1,147 @@
+#include <ngl/QuaternionArray.h>
+#include <ngl/Vec3Array.h>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// blending two poses of 100k joints (a crowd of skeletons), the Quaternion functions called per joint against the
+// QuaternionArray batch versions
+static const size_t s_count=100000;
+
+static std::vector<ngl::Quaternion> s_poseA,s_poseB,s_result;
+static std::vector<ngl::Vec3> s_points;
+static ngl::QuaternionArray s_a,s_b,s_res;
+static ngl::Vec3Array s_pointArray;
+static volatile float s_sink=0.0f;
+
+float randomFloat(float _min, float _max)
+{
+  return _min+(_max-_min)*(std::rand()/float(RAND_MAX));
+}
+
+ngl::Quaternion randomRotation()
+{
+  ngl::Quaternion q(randomFloat(-1.0f,1.0f),randomFloat(-1.0f,1.0f),randomFloat(-1.0f,1.0f),randomFloat(-1.0f,1.0f));
+  q.normalise();
+  return q;
+}
+
+void scalarSlerp()
+{
+  for(size_t i=0; i<s_count; ++i)
+  {
+    s_result[i]=ngl::Quaternion::slerp(s_poseA[i],s_poseB[i],0.3f);
+  }
+  s_sink+=s_result[s_count/2].getS();
+}
+
+void scalarNlerp()
+{
+  for(size_t i=0; i<s_count; ++i)
+  {
+    const ngl::Quaternion &a=s_poseA[i];
+    const ngl::Quaternion &b=s_poseB[i];
+    float dot=a.getS()*b.getS()+a.getX()*b.getX()+a.getY()*b.getY()+a.getZ()*b.getZ();
+    ngl::Quaternion q=a*0.7f+b*(dot<0.0f ? -0.3f : 0.3f);
+    q.normalise();
+    s_result[i]=q;
+  }
+  s_sink+=s_result[s_count/2].getS();
+}
+
+void scalarMultiply()
+{
+  for(size_t i=0; i<s_count; ++i)
+  {
+    s_result[i]=s_poseA[i]*s_poseB[i];
+  }
+  s_sink+=s_result[s_count/2].getS();
+}
+
+void scalarNormalise()
+{
+  for(size_t i=0; i<s_count; ++i)
+  {
+    s_result[i].normalise();
+  }
+  s_sink+=s_result[s_count/2].getS();
+}
+
+void scalarRotate()
+{
+  for(size_t i=0; i<s_count; ++i)
+  {
+    s_poseA[i].rotatePoint(s_poseA[i],s_points[i]);
+  }
+  s_sink+=s_points[s_count/2].m_x;
+}
+
+BENCHMARK(Quaternion100k, ScalarSlerp, 5, 10) { scalarSlerp(); }
+BENCHMARK(Quaternion100k, BatchSlerp, 5, 10) { s_res.slerp(s_a,s_b,0.3f); }
+BENCHMARK(Quaternion100k, BatchNlerp, 5, 10) { s_res.nlerp(s_a,s_b,0.3f); }
+BENCHMARK(Quaternion100k, ScalarMultiply, 5, 10) { scalarMultiply(); }
+BENCHMARK(Quaternion100k, BatchMultiply, 5, 10) { s_res.multiply(s_a,s_b); }
+
+template <class Func>
+double bestTime(Func _func, int _runs)
+{
+  double best=1e30;
+  for(int run=0; run<_runs; ++run)
+  {
+    auto start=std::chrono::high_resolution_clock::now();
+    _func();
+    std::chrono::duration<double> time=std::chrono::high_resolution_clock::now()-start;
+    best=std::min(best,time.count());
+  }
+  return best;
+}
+
+
+int main(int argc, char **argv)
+{
+  std::srand(42);
+  for(size_t i=0; i<s_count; ++i)
+  {
+    s_poseA.push_back(randomRotation());
+    s_poseB.push_back(randomRotation());
+    s_points.push_back(ngl::Vec3(randomFloat(-1.0f,1.0f),randomFloat(-1.0f,1.0f),randomFloat(-1.0f,1.0f)));
+  }
+  s_result.resize(s_count);
+  s_a.set(s_poseA);
+  s_b.set(s_poseB);
+  s_pointArray.set(s_points);
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+
+  const int runs=20;
+  std::cout<<"\n"<<s_count<<" quaternions, best of "<<runs<<" in ms\n";
+  printf("%-16s %10s %10s %8s\n","","Quaternion","batch","speedup");
+  double scalar=bestTime(scalarSlerp,runs);
+  double batch=bestTime([]{s_res.slerp(s_a,s_b,0.3f);},runs);
+  printf("%-16s %10.3f %10.3f %8.1f\n","slerp",scalar*1e3,batch*1e3,scalar/batch);
+  scalar=bestTime(scalarNlerp,runs);
+  batch=bestTime([]{s_res.nlerp(s_a,s_b,0.3f);},runs);
+  printf("%-16s %10.3f %10.3f %8.1f\n","nlerp",scalar*1e3,batch*1e3,scalar/batch);
+  scalar=bestTime(scalarMultiply,runs);
+  batch=bestTime([]{s_res.multiply(s_a,s_b);},runs);
+  printf("%-16s %10.3f %10.3f %8.1f\n","multiply",scalar*1e3,batch*1e3,scalar/batch);
+  scalar=bestTime(scalarNormalise,runs);
+  batch=bestTime([]{s_res.normalise();},runs);
+  printf("%-16s %10.3f %10.3f %8.1f\n","normalise",scalar*1e3,batch*1e3,scalar/batch);
+  scalar=bestTime(scalarRotate,runs);
+  batch=bestTime([]{s_a.rotatePoints(s_pointArray);},runs);
+  printf("%-16s %10.3f %10.3f %8.1f\n","rotatePoint",scalar*1e3,batch*1e3,scalar/batch);
+  return result;
+}
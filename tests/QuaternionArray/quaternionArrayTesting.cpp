@@ -0,0 +1,273 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/QuaternionArray.h>
+#include <ngl/Vec3Array.h>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// not a multiple of four so the SIMD and scalar loops are both used
+static const size_t s_size=1003;
+
+float randomFloat(float _min, float _max)
+{
+  return _min+(_max-_min)*(std::rand()/float(RAND_MAX));
+}
+
+ngl::Quaternion randomRotation()
+{
+  ngl::Quaternion q(randomFloat(-1.0f,1.0f),randomFloat(-1.0f,1.0f),randomFloat(-1.0f,1.0f),randomFloat(-1.0f,1.0f));
+  q.normalise();
+  return q;
+}
+
+std::vector<ngl::Quaternion> randomRotations(size_t _n)
+{
+  std::vector<ngl::Quaternion> q;
+  for(size_t i=0; i<_n; ++i)
+  {
+    q.push_back(randomRotation());
+  }
+  return q;
+}
+
+void expectQuaternionNear(const ngl::Quaternion &_a, const ngl::Quaternion &_b, float _tolerance)
+{
+  EXPECT_NEAR(_a.getS(),_b.getS(),_tolerance);
+  EXPECT_NEAR(_a.getX(),_b.getX(),_tolerance);
+  EXPECT_NEAR(_a.getY(),_b.getY(),_tolerance);
+  EXPECT_NEAR(_a.getZ(),_b.getZ(),_tolerance);
+}
+
+// slerp in double precision taking the short way
+void exactSlerp(const ngl::Quaternion &_a, const ngl::Quaternion &_b, double _t, double o_q[4])
+{
+  double a[4]={_a.getS(),_a.getX(),_a.getY(),_a.getZ()};
+  double b[4]={_b.getS(),_b.getX(),_b.getY(),_b.getZ()};
+  double dot=a[0]*b[0]+a[1]*b[1]+a[2]*b[2]+a[3]*b[3];
+  double sign= dot<0.0 ? -1.0 : 1.0;
+  double angle=std::acos(std::min(1.0,std::abs(dot)));
+  double wa=1.0-_t,wb=_t;
+  if(angle>1e-9)
+  {
+    wa=std::sin((1.0-_t)*angle)/std::sin(angle);
+    wb=std::sin(_t*angle)/std::sin(angle);
+  }
+  for(int i=0; i<4; ++i)
+  {
+    o_q[i]=wa*a[i]+sign*wb*b[i];
+  }
+}
+
+TEST(NGLQuaternionArray,setGet)
+{
+  std::srand(1);
+  std::vector<ngl::Quaternion> q=randomRotations(s_size);
+  ngl::QuaternionArray a(q);
+  EXPECT_EQ(a.size(),s_size);
+  std::vector<ngl::Quaternion> back=a.toVector();
+  ASSERT_EQ(back.size(),s_size);
+  for(size_t i=0; i<s_size; ++i)
+  {
+    EXPECT_TRUE(back[i]==q[i]);
+    EXPECT_TRUE(a[i]==q[i]);
+  }
+  a.set(5,ngl::Quaternion(1.0f,2.0f,3.0f,4.0f));
+  EXPECT_FLOAT_EQ(a.s()[5],1.0f);
+  EXPECT_FLOAT_EQ(a.z()[5],4.0f);
+  a.push_back(ngl::Quaternion(1.0f,0.0f,0.0f,0.0f));
+  EXPECT_EQ(a.size(),s_size+1);
+  a.clear();
+  EXPECT_TRUE(a.empty());
+}
+
+TEST(NGLQuaternionArray,multiply)
+{
+  std::srand(2);
+  std::vector<ngl::Quaternion> qa=randomRotations(s_size);
+  std::vector<ngl::Quaternion> qb=randomRotations(s_size);
+  ngl::QuaternionArray a(qa),b(qb),res;
+  res.multiply(a,b);
+  for(size_t i=0; i<s_size; ++i)
+  {
+    expectQuaternionNear(res[i],qa[i]*qb[i],1e-6f);
+  }
+  // in place
+  a.multiply(a,b);
+  for(size_t i=0; i<s_size; ++i)
+  {
+    expectQuaternionNear(a[i],qa[i]*qb[i],1e-6f);
+  }
+}
+
+TEST(NGLQuaternionArray,normalise)
+{
+  std::srand(3);
+  ngl::QuaternionArray a;
+  std::vector<ngl::Quaternion> q;
+  for(size_t i=0; i<s_size; ++i)
+  {
+    q.push_back(ngl::Quaternion(randomFloat(-5.0f,5.0f),randomFloat(-5.0f,5.0f),randomFloat(-5.0f,5.0f),randomFloat(-5.0f,5.0f)));
+    a.push_back(q.back());
+  }
+  a.set(0,ngl::Quaternion(0.0f,0.0f,0.0f,0.0f));
+  a.set(s_size-1,ngl::Quaternion(0.0f,0.0f,0.0f,0.0f));
+  a.normalise();
+  for(size_t i=1; i<s_size-1; ++i)
+  {
+    q[i].normalise();
+    expectQuaternionNear(a[i],q[i],1e-6f);
+  }
+  EXPECT_TRUE(a[0]==ngl::Quaternion(0.0f,0.0f,0.0f,0.0f));
+  EXPECT_TRUE(a[s_size-1]==ngl::Quaternion(0.0f,0.0f,0.0f,0.0f));
+}
+
+TEST(NGLQuaternionArray,rotatePoints)
+{
+  std::srand(4);
+  std::vector<ngl::Quaternion> q=randomRotations(s_size);
+  std::vector<ngl::Vec3> p;
+  for(size_t i=0; i<s_size; ++i)
+  {
+    p.push_back(ngl::Vec3(randomFloat(-10.0f,10.0f),randomFloat(-10.0f,10.0f),randomFloat(-10.0f,10.0f)));
+  }
+  ngl::QuaternionArray a(q);
+  ngl::Vec3Array points(p);
+  a.rotatePoints(points);
+  for(size_t i=0; i<s_size; ++i)
+  {
+    ngl::Vec3 expected=p[i];
+    q[i].rotatePoint(q[i],expected);
+    ngl::Vec3 r=points[i];
+    EXPECT_NEAR(r.m_x,expected.m_x,1e-4f);
+    EXPECT_NEAR(r.m_y,expected.m_y,1e-4f);
+    EXPECT_NEAR(r.m_z,expected.m_z,1e-4f);
+  }
+}
+
+TEST(NGLQuaternionArray,slerpAccuracy)
+{
+  std::srand(5);
+  std::vector<ngl::Quaternion> qa=randomRotations(s_size);
+  std::vector<ngl::Quaternion> qb=randomRotations(s_size);
+  // some nearly the same, nearly opposite and exactly opposite pairs
+  for(size_t i=0; i<40; ++i)
+  {
+    ngl::Quaternion q=qa[i];
+    float e= i<10 ? 0.0f : 1e-3f*i;
+    ngl::Quaternion n(q.getS()+e,q.getX(),q.getY()-e,q.getZ());
+    n.normalise();
+    qb[i]=n;
+    // negated so the short way round has to be taken
+    if(i%2==0)
+    {
+      qb[i].set(-n.getS(),-n.getX(),-n.getY(),-n.getZ());
+    }
+  }
+  ngl::QuaternionArray a(qa),b(qb),res;
+  float worst=0.0f;
+  for(float t=0.0f; t<=1.0f; t+=0.125f)
+  {
+    res.slerp(a,b,t);
+    for(size_t i=0; i<s_size; ++i)
+    {
+      double exact[4];
+      exactSlerp(qa[i],qb[i],t,exact);
+      ngl::Quaternion r=res[i];
+      float got[4]={r.getS(),r.getX(),r.getY(),r.getZ()};
+      for(int c=0; c<4; ++c)
+      {
+        worst=std::max(worst,float(std::abs(got[c]-exact[c])));
+      }
+    }
+  }
+  // the bound documented in QuaternionArray::slerp
+  EXPECT_LT(worst,4e-5f);
+  // and close to the scalar version
+  res.slerp(a,b,0.3f);
+  for(size_t i=40; i<s_size; ++i)
+  {
+    expectQuaternionNear(res[i],ngl::Quaternion::slerp(qa[i],qb[i],0.3f),1e-4f);
+  }
+}
+
+TEST(NGLQuaternionArray,slerpEnds)
+{
+  std::srand(6);
+  std::vector<ngl::Quaternion> qa=randomRotations(s_size);
+  std::vector<ngl::Quaternion> qb=randomRotations(s_size);
+  ngl::QuaternionArray a(qa),b(qb),res;
+  res.slerp(a,b,0.0f);
+  for(size_t i=0; i<s_size; ++i)
+  {
+    expectQuaternionNear(res[i],qa[i],1e-6f);
+  }
+  res.slerp(a,b,1.0f);
+  for(size_t i=0; i<s_size; ++i)
+  {
+    float sign=qa[i].getS()*qb[i].getS()+qa[i].getX()*qb[i].getX()+qa[i].getY()*qb[i].getY()+
+               qa[i].getZ()*qb[i].getZ() < 0.0f ? -1.0f : 1.0f;
+    expectQuaternionNear(res[i],qb[i]*sign,2e-5f);
+  }
+}
+
+TEST(NGLQuaternionArray,perElement)
+{
+  std::srand(7);
+  std::vector<ngl::Quaternion> qa=randomRotations(s_size);
+  std::vector<ngl::Quaternion> qb=randomRotations(s_size);
+  std::vector<ngl::Real> t;
+  for(size_t i=0; i<s_size; ++i)
+  {
+    t.push_back(randomFloat(0.0f,1.0f));
+  }
+  ngl::QuaternionArray a(qa),b(qb),res,single;
+  res.slerp(a,b,t);
+  for(size_t i=0; i<s_size; i+=7)
+  {
+    single.slerp(a,b,t[i]);
+    expectQuaternionNear(res[i],single[i],1e-6f);
+  }
+  res.nlerp(a,b,t);
+  for(size_t i=0; i<s_size; i+=7)
+  {
+    single.nlerp(a,b,t[i]);
+    expectQuaternionNear(res[i],single[i],1e-6f);
+  }
+}
+
+TEST(NGLQuaternionArray,nlerp)
+{
+  std::srand(8);
+  std::vector<ngl::Quaternion> qa=randomRotations(s_size);
+  std::vector<ngl::Quaternion> qb=randomRotations(s_size);
+  ngl::QuaternionArray a(qa),b(qb),res;
+  res.nlerp(a,b,0.25f);
+  for(size_t i=0; i<s_size; ++i)
+  {
+    ngl::Quaternion q=res[i];
+    EXPECT_NEAR(q.magnitude(),1.0f,1e-5f);
+    // the same as the exact slerp when the sign of b is matched and both are normalised
+    double exact[4];
+    exactSlerp(qa[i],qb[i],0.25,exact);
+    double dot=q.getS()*exact[0]+q.getX()*exact[1]+q.getY()*exact[2]+q.getZ()*exact[3];
+    // nlerp doesn't keep a constant speed so only lies close to the slerp for a quarter of the way
+    EXPECT_GT(dot,0.98);
+  }
+  // in place
+  a.nlerp(a,b,1.0f);
+  for(size_t i=0; i<s_size; ++i)
+  {
+    ngl::Quaternion q=a[i];
+    ngl::Quaternion sq=qb[i];
+    float dot=std::abs(q.getS()*sq.getS()+q.getX()*sq.getX()+q.getY()*sq.getY()+q.getZ()*sq.getZ());
+    EXPECT_NEAR(dot,1.0f,1e-5f);
+  }
+}
@@ -0,0 +1,507 @@
+#ifndef RECORDINGGL_H_
+#define RECORDINGGL_H_
+#include <ngl/Types.h>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// a stand in for the OpenGL driver so ShaderLib / ShaderProgram can be run without a context. The glew function
+// pointers used by the shader classes are pointed at these functions, programs report the uniforms set in state()
+// and every glUniform* call is recorded so the values and locations sent can be checked. Buffers are kept in memory
+// so the data sent to a uniform buffer can be checked too, as can the vertex attributes and the draws made.
+namespace recordingGL
+{
+
+struct Uniform
+{
+  std::string name;
+  GLenum type;
+  GLint size;
+};
+
+struct Call
+{
+  const char *func;
+  GLint loc;
+  std::vector<float> values;
+  bool operator==(const Call &_c) const
+  {
+    return std::string(func)==_c.func && loc==_c.loc && values==_c.values;
+  }
+};
+
+struct BlockMember
+{
+  std::string name;
+  GLenum type;
+  GLint size;
+  GLint offset;
+  GLint arrayStride;
+  GLint matrixStride;
+};
+
+struct Block
+{
+  std::string name;
+  GLint size;
+  std::vector<BlockMember> members;
+};
+
+struct BindRange
+{
+  GLuint binding;
+  GLuint buffer;
+  GLintptr offset;
+  GLsizeiptr size;
+};
+
+struct Attribute
+{
+  bool enabled=false;
+  GLuint buffer=0;
+  GLint size=0;
+  GLsizei stride=0;
+  size_t offset=0;
+  GLuint divisor=0;
+};
+
+// a draw, the indirect ones read drawCount commands from the GL_DRAW_INDIRECT_BUFFER at offset
+struct Draw
+{
+  const char *func;
+  GLenum mode;
+  GLuint program;
+  GLuint vao;
+  GLint first;
+  GLsizei count;
+  GLsizei instances;
+  GLint baseVertex;
+  size_t offset;
+  GLsizei drawCount;
+};
+
+struct State
+{
+  GLuint nextID=1;
+  GLuint current=0;
+  GLuint currentVAO=0;
+  // the number of glUseProgram / glBindVertexArray calls made
+  size_t useProgramCalls=0;
+  size_t bindVertexArrayCalls=0;
+  // the active uniforms of each program, programs not listed report defaultUniforms
+  std::vector<Uniform> defaultUniforms={{"MVP",GL_FLOAT_MAT4,1},{"Colour",GL_FLOAT_VEC4,1}};
+  std::unordered_map<GLuint,std::vector<Uniform>> uniforms;
+  // the uniform blocks of each program
+  std::unordered_map<GLuint,std::vector<Block>> blocks;
+  // program*100+block index to the binding point set
+  std::unordered_map<GLuint,GLuint> blockBindings;
+  // when false the glUniform functions do nothing (for benchmarking)
+  bool record=true;
+  std::vector<Call> calls;
+  // the number of glUniform* calls and the bytes sent by them, counted even when not recording
+  size_t uniformCalls=0;
+  size_t uniformBytes=0;
+  // the contents of each buffer and the buffer bound to each target
+  std::unordered_map<GLuint,std::vector<unsigned char>> buffers;
+  std::unordered_map<GLenum,GLuint> boundBuffers;
+  // the glBufferData (with data) and glBufferSubData calls and the bytes sent by them
+  size_t bufferUploads=0;
+  size_t bufferBytes=0;
+  std::vector<BindRange> ranges;
+  // the vertex attributes of each vertex array and the draws made
+  std::unordered_map<GLuint,std::unordered_map<GLuint,Attribute>> attributes;
+  std::vector<Draw> draws;
+};
+
+inline State & state()
+{
+  static State s;
+  return s;
+}
+
+inline const std::vector<Uniform> & programUniforms(GLuint _program)
+{
+  auto u=state().uniforms.find(_program);
+  return u!=state().uniforms.end() ? u->second : state().defaultUniforms;
+}
+
+// uniform locations are program*100 + the index of the name with arrays expanded so each program is different
+inline GLint location(GLuint _program, const std::string &_name)
+{
+  GLint index=0;
+  for(auto &u : programUniforms(_program))
+  {
+    std::string base=u.name.substr(0,u.name.find('['));
+    for(GLint i=0; i<u.size; ++i, ++index)
+    {
+      if( (u.size==1 && _name==u.name) || (u.size>1 && _name==base+"["+std::to_string(i)+"]") )
+      {
+        return static_cast<GLint>(_program)*100+index;
+      }
+    }
+  }
+  return -1;
+}
+
+inline void record(const char *_func, GLint _loc, const float *_values, size_t _count)
+{
+  ++state().uniformCalls;
+  state().uniformBytes+=_count*sizeof(float);
+  if(state().record)
+  {
+    state().calls.push_back({_func,_loc,std::vector<float>(_values,_values+_count)});
+  }
+}
+
+inline void record(const char *_func, GLint _loc, std::initializer_list<float> _values)
+{
+  record(_func,_loc,_values.begin(),_values.size());
+}
+
+inline GLuint GLAPIENTRY createProgram() { return state().nextID++; }
+inline GLuint GLAPIENTRY createShader(GLenum) { return state().nextID++; }
+inline void GLAPIENTRY ignore(GLuint) {}
+inline void GLAPIENTRY ignore2(GLuint,GLuint) {}
+inline void GLAPIENTRY useProgram(GLuint _program)
+{
+  state().current=_program;
+  ++state().useProgramCalls;
+}
+inline void GLAPIENTRY genVertexArrays(GLsizei _n, GLuint *o_arrays)
+{
+  for(GLsizei i=0; i<_n; ++i)
+  {
+    o_arrays[i]=state().nextID++;
+  }
+}
+inline void GLAPIENTRY deleteVertexArrays(GLsizei _n, const GLuint *_arrays)
+{
+  for(GLsizei i=0; i<_n; ++i)
+  {
+    if(state().currentVAO==_arrays[i])
+    {
+      state().currentVAO=0;
+    }
+  }
+}
+inline void GLAPIENTRY bindVertexArray(GLuint _vao)
+{
+  state().currentVAO=_vao;
+  ++state().bindVertexArrayCalls;
+}
+inline void GLAPIENTRY shaderSource(GLuint, GLsizei, const GLchar *const*, const GLint*) {}
+inline void GLAPIENTRY getShaderiv(GLuint, GLenum _pname, GLint *o_param)
+{
+  *o_param= _pname==GL_COMPILE_STATUS ? GL_TRUE : 0;
+}
+inline void GLAPIENTRY getInfoLog(GLuint, GLsizei, GLsizei *o_length, GLchar *o_log)
+{
+  if(o_length) *o_length=0;
+  if(o_log) *o_log=0;
+}
+inline void GLAPIENTRY getProgramiv(GLuint _program, GLenum _pname, GLint *o_param)
+{
+  switch(_pname)
+  {
+    case GL_LINK_STATUS : *o_param=GL_TRUE; break;
+    case GL_ACTIVE_UNIFORMS : *o_param=static_cast<GLint>(programUniforms(_program).size()); break;
+    default : *o_param=0;
+  }
+}
+inline void GLAPIENTRY bindLocation(GLuint, GLuint, const GLchar*) {}
+inline void GLAPIENTRY getActiveUniform(GLuint _program, GLuint _index, GLsizei _max, GLsizei *o_length, GLint *o_size,
+                                        GLenum *o_type, GLchar *o_name)
+{
+  const Uniform &u=programUniforms(_program)[_index];
+  *o_length=static_cast<GLsizei>(u.name.copy(o_name,static_cast<size_t>(_max)-1));
+  o_name[*o_length]=0;
+  *o_size=u.size;
+  *o_type=u.type;
+}
+inline GLint GLAPIENTRY getUniformLocation(GLuint _program, const GLchar *_name)
+{
+  return location(_program,_name);
+}
+inline void GLAPIENTRY uniform1f(GLint _loc, GLfloat _v0) { record("glUniform1f",_loc,{_v0}); }
+inline void GLAPIENTRY uniform2f(GLint _loc, GLfloat _v0, GLfloat _v1) { record("glUniform2f",_loc,{_v0,_v1}); }
+inline void GLAPIENTRY uniform3f(GLint _loc, GLfloat _v0, GLfloat _v1, GLfloat _v2)
+{
+  record("glUniform3f",_loc,{_v0,_v1,_v2});
+}
+inline void GLAPIENTRY uniform4f(GLint _loc, GLfloat _v0, GLfloat _v1, GLfloat _v2, GLfloat _v3)
+{
+  record("glUniform4f",_loc,{_v0,_v1,_v2,_v3});
+}
+inline void GLAPIENTRY uniform1i(GLint _loc, GLint _v0) { record("glUniform1i",_loc,{float(_v0)}); }
+inline void GLAPIENTRY uniform2i(GLint _loc, GLint _v0, GLint _v1) { record("glUniform2i",_loc,{float(_v0),float(_v1)}); }
+inline void GLAPIENTRY uniform3i(GLint _loc, GLint _v0, GLint _v1, GLint _v2)
+{
+  record("glUniform3i",_loc,{float(_v0),float(_v1),float(_v2)});
+}
+inline void GLAPIENTRY uniform4i(GLint _loc, GLint _v0, GLint _v1, GLint _v2, GLint _v3)
+{
+  record("glUniform4i",_loc,{float(_v0),float(_v1),float(_v2),float(_v3)});
+}
+inline void GLAPIENTRY uniform4fv(GLint _loc, GLsizei _count, const GLfloat *_v)
+{
+  record("glUniform4f",_loc,_v,4*static_cast<size_t>(_count));
+}
+inline void GLAPIENTRY uniformMatrix3fv(GLint _loc, GLsizei _count, GLboolean, const GLfloat *_v)
+{
+  record("glUniformMatrix3fv",_loc,_v,9*static_cast<size_t>(_count));
+}
+inline void GLAPIENTRY uniformMatrix4fv(GLint _loc, GLsizei _count, GLboolean, const GLfloat *_v)
+{
+  record("glUniformMatrix4fv",_loc,_v,16*static_cast<size_t>(_count));
+}
+
+inline void GLAPIENTRY genBuffers(GLsizei _n, GLuint *o_buffers)
+{
+  for(GLsizei i=0; i<_n; ++i)
+  {
+    o_buffers[i]=state().nextID++;
+  }
+}
+inline void GLAPIENTRY deleteBuffers(GLsizei _n, const GLuint *_buffers)
+{
+  for(GLsizei i=0; i<_n; ++i)
+  {
+    state().buffers.erase(_buffers[i]);
+  }
+}
+inline void GLAPIENTRY bindBuffer(GLenum _target, GLuint _buffer) { state().boundBuffers[_target]=_buffer; }
+inline void GLAPIENTRY bufferData(GLenum _target, GLsizeiptr _size, const void *_data, GLenum)
+{
+  auto &buffer=state().buffers[state().boundBuffers[_target]];
+  buffer.assign(static_cast<size_t>(_size),0);
+  if(_data)
+  {
+    std::memcpy(buffer.data(),_data,buffer.size());
+    ++state().bufferUploads;
+    state().bufferBytes+=buffer.size();
+  }
+}
+inline void GLAPIENTRY bufferSubData(GLenum _target, GLintptr _offset, GLsizeiptr _size, const void *_data)
+{
+  auto &buffer=state().buffers[state().boundBuffers[_target]];
+  if(_offset>=0 && static_cast<size_t>(_offset+_size)<=buffer.size())
+  {
+    std::memcpy(&buffer[static_cast<size_t>(_offset)],_data,static_cast<size_t>(_size));
+  }
+  ++state().bufferUploads;
+  state().bufferBytes+=static_cast<size_t>(_size);
+}
+inline void GLAPIENTRY bindBufferRange(GLenum _target, GLuint _binding, GLuint _buffer, GLintptr _offset, GLsizeiptr _size)
+{
+  state().boundBuffers[_target]=_buffer;
+  state().ranges.push_back({_binding,_buffer,_offset,_size});
+}
+
+// uniform blocks, the members of block b are given the uniform indices 1000*(b+1)+member
+inline const Block * findBlock(GLuint _program, GLuint _block)
+{
+  auto blocks=state().blocks.find(_program);
+  if(blocks==state().blocks.end() || _block>=blocks->second.size())
+  {
+    return nullptr;
+  }
+  return &blocks->second[_block];
+}
+inline const BlockMember * findBlockMember(GLuint _program, GLuint _uniform)
+{
+  const Block *block=findBlock(_program,_uniform/1000-1);
+  if(_uniform<1000 || block==nullptr || _uniform%1000>=block->members.size())
+  {
+    return nullptr;
+  }
+  return &block->members[_uniform%1000];
+}
+inline GLuint GLAPIENTRY getUniformBlockIndex(GLuint _program, const GLchar *_name)
+{
+  auto blocks=state().blocks.find(_program);
+  if(blocks!=state().blocks.end())
+  {
+    for(size_t i=0; i<blocks->second.size(); ++i)
+    {
+      if(blocks->second[i].name==_name)
+      {
+        return static_cast<GLuint>(i);
+      }
+    }
+  }
+  return GL_INVALID_INDEX;
+}
+inline void GLAPIENTRY getActiveUniformBlockiv(GLuint _program, GLuint _block, GLenum _pname, GLint *o_params)
+{
+  const Block *block=findBlock(_program,_block);
+  if(block==nullptr)
+  {
+    return;
+  }
+  switch(_pname)
+  {
+    case GL_UNIFORM_BLOCK_DATA_SIZE : *o_params=block->size; break;
+    case GL_UNIFORM_BLOCK_ACTIVE_UNIFORMS : *o_params=static_cast<GLint>(block->members.size()); break;
+    case GL_UNIFORM_BLOCK_ACTIVE_UNIFORM_INDICES :
+      for(size_t i=0; i<block->members.size(); ++i)
+      {
+        o_params[i]=static_cast<GLint>(1000*(_block+1)+i);
+      }
+    break;
+    default : break;
+  }
+}
+inline void GLAPIENTRY getActiveUniformsiv(GLuint _program, GLsizei _count, const GLuint *_uniforms, GLenum _pname,
+                                           GLint *o_params)
+{
+  for(GLsizei i=0; i<_count; ++i)
+  {
+    const BlockMember *m=findBlockMember(_program,_uniforms[i]);
+    if(m==nullptr)
+    {
+      o_params[i]=-1;
+      continue;
+    }
+    switch(_pname)
+    {
+      case GL_UNIFORM_TYPE : o_params[i]=static_cast<GLint>(m->type); break;
+      case GL_UNIFORM_SIZE : o_params[i]=m->size; break;
+      case GL_UNIFORM_OFFSET : o_params[i]=m->offset; break;
+      case GL_UNIFORM_ARRAY_STRIDE : o_params[i]=m->arrayStride; break;
+      case GL_UNIFORM_MATRIX_STRIDE : o_params[i]=m->matrixStride; break;
+      default : o_params[i]=0;
+    }
+  }
+}
+inline void GLAPIENTRY getActiveUniformName(GLuint _program, GLuint _uniform, GLsizei _max, GLsizei *o_length,
+                                            GLchar *o_name)
+{
+  const BlockMember *m=findBlockMember(_program,_uniform);
+  std::string name= m ? m->name : "";
+  *o_length=static_cast<GLsizei>(name.copy(o_name,static_cast<size_t>(_max)-1));
+  o_name[*o_length]=0;
+}
+inline void GLAPIENTRY uniformBlockBinding(GLuint _program, GLuint _block, GLuint _binding)
+{
+  state().blockBindings[_program*100+_block]=_binding;
+}
+
+inline void GLAPIENTRY getBufferSubData(GLenum _target, GLintptr _offset, GLsizeiptr _size, void *o_data)
+{
+  auto &buffer=state().buffers[state().boundBuffers[_target]];
+  if(_offset>=0 && static_cast<size_t>(_offset+_size)<=buffer.size())
+  {
+    std::memcpy(o_data,&buffer[static_cast<size_t>(_offset)],static_cast<size_t>(_size));
+  }
+}
+inline void GLAPIENTRY enableVertexAttribArray(GLuint _index)
+{
+  state().attributes[state().currentVAO][_index].enabled=true;
+}
+inline void GLAPIENTRY disableVertexAttribArray(GLuint _index)
+{
+  state().attributes[state().currentVAO][_index].enabled=false;
+}
+inline void GLAPIENTRY vertexAttribPointer(GLuint _index, GLint _size, GLenum, GLboolean, GLsizei _stride,
+                                           const void *_pointer)
+{
+  Attribute &a=state().attributes[state().currentVAO][_index];
+  a.buffer=state().boundBuffers[GL_ARRAY_BUFFER];
+  a.size=_size;
+  a.stride=_stride;
+  a.offset=reinterpret_cast<size_t>(_pointer);
+}
+inline void GLAPIENTRY vertexAttribDivisor(GLuint _index, GLuint _divisor)
+{
+  state().attributes[state().currentVAO][_index].divisor=_divisor;
+}
+inline void GLAPIENTRY drawArraysInstanced(GLenum _mode, GLint _first, GLsizei _count, GLsizei _instances)
+{
+  state().draws.push_back({"glDrawArraysInstanced",_mode,state().current,state().currentVAO,_first,_count,_instances,
+                           0,0,1});
+}
+inline void GLAPIENTRY drawElementsInstanced(GLenum _mode, GLsizei _count, GLenum, const void *_indices,
+                                             GLsizei _instances)
+{
+  state().draws.push_back({"glDrawElementsInstanced",_mode,state().current,state().currentVAO,0,_count,_instances,0,
+                           reinterpret_cast<size_t>(_indices),1});
+}
+inline void GLAPIENTRY drawElementsInstancedBaseVertex(GLenum _mode, GLsizei _count, GLenum, const void *_indices,
+                                                       GLsizei _instances, GLint _baseVertex)
+{
+  state().draws.push_back({"glDrawElementsInstancedBaseVertex",_mode,state().current,state().currentVAO,0,_count,
+                           _instances,_baseVertex,reinterpret_cast<size_t>(_indices),1});
+}
+inline void GLAPIENTRY multiDrawArraysIndirect(GLenum _mode, const void *_indirect, GLsizei _drawCount, GLsizei)
+{
+  state().draws.push_back({"glMultiDrawArraysIndirect",_mode,state().current,state().currentVAO,0,0,0,0,
+                           reinterpret_cast<size_t>(_indirect),_drawCount});
+}
+inline void GLAPIENTRY multiDrawElementsIndirect(GLenum _mode, GLenum, const void *_indirect, GLsizei _drawCount, GLsizei)
+{
+  state().draws.push_back({"glMultiDrawElementsIndirect",_mode,state().current,state().currentVAO,0,0,0,0,
+                           reinterpret_cast<size_t>(_indirect),_drawCount});
+}
+
+// point the glew entry points at the recording functions, call before ShaderLib::instance()
+inline void install()
+{
+  __glewCreateProgram=createProgram;
+  __glewCreateShader=createShader;
+  __glewDeleteProgram=ignore;
+  __glewDeleteShader=ignore;
+  __glewCompileShader=ignore;
+  __glewLinkProgram=ignore;
+  __glewUseProgram=useProgram;
+  __glewGenVertexArrays=genVertexArrays;
+  __glewDeleteVertexArrays=deleteVertexArrays;
+  __glewBindVertexArray=bindVertexArray;
+  __glewAttachShader=ignore2;
+  __glewShaderSource=shaderSource;
+  __glewGetShaderiv=getShaderiv;
+  __glewGetShaderInfoLog=getInfoLog;
+  __glewGetProgramiv=getProgramiv;
+  __glewGetProgramInfoLog=getInfoLog;
+  __glewBindAttribLocation=bindLocation;
+  __glewBindFragDataLocation=bindLocation;
+  __glewGetActiveUniform=getActiveUniform;
+  __glewGetUniformLocation=getUniformLocation;
+  __glewUniform1f=uniform1f;
+  __glewUniform2f=uniform2f;
+  __glewUniform3f=uniform3f;
+  __glewUniform4f=uniform4f;
+  __glewUniform1i=uniform1i;
+  __glewUniform2i=uniform2i;
+  __glewUniform3i=uniform3i;
+  __glewUniform4i=uniform4i;
+  __glewUniform4fv=uniform4fv;
+  __glewUniformMatrix3fv=uniformMatrix3fv;
+  __glewUniformMatrix4fv=uniformMatrix4fv;
+  __glewGenBuffers=genBuffers;
+  __glewDeleteBuffers=deleteBuffers;
+  __glewBindBuffer=bindBuffer;
+  __glewBufferData=bufferData;
+  __glewBufferSubData=bufferSubData;
+  __glewBindBufferRange=bindBufferRange;
+  __glewGetUniformBlockIndex=getUniformBlockIndex;
+  __glewGetActiveUniformBlockiv=getActiveUniformBlockiv;
+  __glewGetActiveUniformsiv=getActiveUniformsiv;
+  __glewGetActiveUniformName=getActiveUniformName;
+  __glewUniformBlockBinding=uniformBlockBinding;
+  __glewGetBufferSubData=getBufferSubData;
+  __glewEnableVertexAttribArray=enableVertexAttribArray;
+  __glewDisableVertexAttribArray=disableVertexAttribArray;
+  __glewVertexAttribPointer=vertexAttribPointer;
+  __glewVertexAttribDivisor=vertexAttribDivisor;
+  __glewDrawArraysInstanced=drawArraysInstanced;
+  __glewDrawElementsInstanced=drawElementsInstanced;
+  __glewDrawElementsInstancedBaseVertex=drawElementsInstancedBaseVertex;
+  __glewMultiDrawArraysIndirect=multiDrawArraysIndirect;
+  __glewMultiDrawElementsIndirect=multiDrawElementsIndirect;
+}
+
+} // end namespace recordingGL
+
+#endif
@@ -0,0 +1,158 @@
+#include <ngl/ShaderLib.h>
+#include <ngl/GLStateCache.h>
+#include "recordingGL.h"
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+// setting the uniforms for 10k draws of a phong shader with the glUniform calls going to an empty stand in for the
+// driver, so only the cost of finding the program and the uniform location is measured
+static const size_t s_draws=10000;
+
+static ngl::ShaderLib *s_shader=nullptr;
+static std::string s_current="Phong";
+static ngl::Mat4 s_mvp,s_mv;
+static ngl::Mat3 s_normal;
+static ngl::Vec4 s_colour(0.8f,0.2f,0.2f,1.0f);
+static ngl::Vec3 s_light(2.0f,5.0f,2.0f);
+
+static ngl::UniformHandle s_mvpHandle,s_mvHandle,s_normalHandle,s_colourHandle,s_lightHandle,s_shininessHandle;
+
+// what the ShaderLib setters did before the current program was cached, the program found by name every call and
+// matrices passed by value
+void oldSetUniform(const std::string &_name, ngl::Mat4 _m)
+{
+  (*s_shader)[s_current]->setUniformMatrix4fv(_name.c_str(),1,GL_FALSE,_m.openGL());
+}
+void oldSetUniform(const std::string &_name, ngl::Mat3 _m)
+{
+  (*s_shader)[s_current]->setUniformMatrix3fv(_name.c_str(),1,GL_FALSE,_m.openGL());
+}
+void oldSetUniform(const std::string &_name, ngl::Vec4 _v)
+{
+  (*s_shader)[s_current]->setUniform4f(_name.c_str(),_v.m_x,_v.m_y,_v.m_z,_v.m_w);
+}
+void oldSetUniform(const std::string &_name, ngl::Vec3 _v)
+{
+  (*s_shader)[s_current]->setUniform3f(_name.c_str(),_v.m_x,_v.m_y,_v.m_z);
+}
+void oldSetUniform(const std::string &_name, float _v)
+{
+  (*s_shader)[s_current]->setUniform1f(_name.c_str(),_v);
+}
+
+void drawOld()
+{
+  for(size_t i=0; i<s_draws; ++i)
+  {
+    oldSetUniform("MVP",s_mvp);
+    oldSetUniform("MV",s_mv);
+    oldSetUniform("normalMatrix",s_normal);
+    oldSetUniform("colour",s_colour);
+    oldSetUniform("lightPos",s_light);
+    oldSetUniform("shininess",20.0f);
+  }
+}
+
+void drawByName()
+{
+  for(size_t i=0; i<s_draws; ++i)
+  {
+    s_shader->setUniform("MVP",s_mvp);
+    s_shader->setUniform("MV",s_mv);
+    s_shader->setUniform("normalMatrix",s_normal);
+    s_shader->setUniform("colour",s_colour);
+    s_shader->setUniform("lightPos",s_light);
+    s_shader->setUniform("shininess",20.0f);
+  }
+}
+
+void drawByHandle()
+{
+  for(size_t i=0; i<s_draws; ++i)
+  {
+    s_shader->setUniform(s_mvpHandle,s_mvp);
+    s_shader->setUniform(s_mvHandle,s_mv);
+    s_shader->setUniform(s_normalHandle,s_normal);
+    s_shader->setUniform(s_colourHandle,s_colour);
+    s_shader->setUniform(s_lightHandle,s_light);
+    s_shader->setUniform(s_shininessHandle,20.0f);
+  }
+}
+
+BENCHMARK(Uniforms10kDraws, OldByName, 5, 10) { drawOld(); }
+BENCHMARK(Uniforms10kDraws, ByName, 5, 10) { drawByName(); }
+BENCHMARK(Uniforms10kDraws, ByHandle, 5, 10) { drawByHandle(); }
+
+template <class Func>
+double bestTime(Func _func, int _runs)
+{
+  double best=1e30;
+  for(int run=0; run<_runs; ++run)
+  {
+    auto start=std::chrono::high_resolution_clock::now();
+    _func();
+    std::chrono::duration<double> time=std::chrono::high_resolution_clock::now()-start;
+    best=std::min(best,time.count());
+  }
+  return best;
+}
+
+
+int main(int argc, char **argv)
+{
+  recordingGL::install();
+  recordingGL::state().record=false;
+  s_shader=ngl::ShaderLib::instance();
+  s_shader->createShaderProgram("Phong");
+  recordingGL::state().uniforms[s_shader->getProgramID("Phong")]=
+  {
+    {"MVP",GL_FLOAT_MAT4,1},
+    {"MV",GL_FLOAT_MAT4,1},
+    {"normalMatrix",GL_FLOAT_MAT3,1},
+    {"colour",GL_FLOAT_VEC4,1},
+    {"lightPos",GL_FLOAT_VEC3,1},
+    {"shininess",GL_FLOAT,1},
+    {"lightColour",GL_FLOAT_VEC4,1},
+    {"eyePos",GL_FLOAT_VEC3,1}
+  };
+  s_shader->linkProgramObject("Phong");
+  s_shader->use("Phong");
+  s_mvpHandle=s_shader->getUniformHandle("MVP");
+  s_mvHandle=s_shader->getUniformHandle("MV");
+  s_normalHandle=s_shader->getUniformHandle("normalMatrix");
+  s_colourHandle=s_shader->getUniformHandle("colour");
+  s_lightHandle=s_shader->getUniformHandle("lightPos");
+  s_shininessHandle=s_shader->getUniformHandle("shininess");
+  // the same values are set every draw, turn off the filtering so every call is made and only the lookups compared
+  ngl::GLStateCache::instance()->setEnabled(false);
+  s_mvp.translate(1.0f,2.0f,3.0f);
+  s_mv.scale(2.0f,2.0f,2.0f);
+
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+
+  const int runs=20;
+  std::cout<<"\n"<<s_draws<<" draws of 6 uniforms, best of "<<runs<<"\n";
+  printf("%-28s %10s %12s\n","","ms","ns/uniform");
+  double old=bestTime(drawOld,runs);
+  double name=bestTime(drawByName,runs);
+  double handle=bestTime(drawByHandle,runs);
+  const double calls=s_draws*6.0;
+  printf("%-28s %10.3f %12.1f\n","by name (program looked up)",old*1e3,old*1e9/calls);
+  printf("%-28s %10.3f %12.1f\n","by name (current program)",name*1e3,name*1e9/calls);
+  printf("%-28s %10.3f %12.1f\n","by handle",handle*1e3,handle*1e9/calls);
+  printf("handle speedup %.1fx over the old name path, %.1fx over the name path\n",old/handle,name/handle);
+  return result;
+}
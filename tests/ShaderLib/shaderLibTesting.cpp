@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/ShaderLib.h>
+#include <ngl/GLStateCache.h>
+#include "recordingGL.h"
+#include <string>
+#include <vector>
+
+
+int main(int argc, char **argv)
+{
+  // no OpenGL context is needed as the calls go to the recording stand in
+  recordingGL::install();
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// create and link a program reporting _uniforms as its active uniforms
+void createProgram(const std::string &_name, const std::vector<recordingGL::Uniform> &_uniforms)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  shader->createShaderProgram(_name);
+  recordingGL::state().uniforms[shader->getProgramID(_name)]=_uniforms;
+  shader->linkProgramObject(_name);
+}
+
+static const std::vector<recordingGL::Uniform> s_phong=
+{
+  {"MVP",GL_FLOAT_MAT4,1},
+  {"normalMatrix",GL_FLOAT_MAT3,1},
+  {"colour",GL_FLOAT_VEC4,1},
+  {"lightPos",GL_FLOAT_VEC3,1},
+  {"uvScale",GL_FLOAT_VEC2,1},
+  {"shininess",GL_FLOAT,1},
+  {"tex",GL_SAMPLER_2D,1},
+  {"tiles",GL_INT_VEC4,1},
+  {"lights[0]",GL_FLOAT_VEC3,3}
+};
+
+TEST(NGLShaderLib,handlesInterned)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  ngl::UniformHandle mvp=shader->getUniformHandle("MVP");
+  EXPECT_EQ(mvp,shader->getUniformHandle("MVP"));
+  EXPECT_EQ(mvp,ngl::ShaderProgram::getUniformHandle("MVP"));
+  EXPECT_NE(mvp,shader->getUniformHandle("normalMatrix"));
+  EXPECT_EQ(ngl::ShaderProgram::getUniformHandleName(mvp),"MVP");
+}
+
+TEST(NGLShaderLib,handleMatchesName)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  createProgram("Phong",s_phong);
+  shader->use("Phong");
+  ngl::Mat4 mvp;
+  mvp.translate(1.0f,2.0f,3.0f);
+  mvp.m_01=0.5f;
+  ngl::Mat3 normal;
+  normal.m_12=0.25f;
+  auto &calls=recordingGL::state().calls;
+  // the same values are written twice so turn off the filtering of repeated values
+  ngl::GLStateCache::instance()->setEnabled(false);
+
+  calls.clear();
+  shader->setUniform("MVP",mvp);
+  shader->setUniform("normalMatrix",normal);
+  shader->setUniform("colour",ngl::Vec4(0.1f,0.2f,0.3f,1.0f));
+  shader->setUniform("colour",ngl::Colour(0.4f,0.5f,0.6f,0.7f));
+  shader->setUniform("lightPos",ngl::Vec3(1.0f,2.0f,3.0f));
+  shader->setUniform("lightPos",4.0f,5.0f,6.0f);
+  shader->setUniform("uvScale",ngl::Vec2(2.0f,4.0f));
+  shader->setUniform("uvScale",3.0f,5.0f);
+  shader->setUniform("shininess",20.0f);
+  shader->setUniform("tex",2);
+  shader->setUniform("tiles",1,2,3,4);
+  shader->setUniform("lights[2]",7.0f,8.0f,9.0f);
+  std::vector<recordingGL::Call> byName=calls;
+
+  calls.clear();
+  shader->setUniform(shader->getUniformHandle("MVP"),mvp);
+  shader->setUniform(shader->getUniformHandle("normalMatrix"),normal);
+  shader->setUniform(shader->getUniformHandle("colour"),ngl::Vec4(0.1f,0.2f,0.3f,1.0f));
+  shader->setUniform(shader->getUniformHandle("colour"),ngl::Colour(0.4f,0.5f,0.6f,0.7f));
+  shader->setUniform(shader->getUniformHandle("lightPos"),ngl::Vec3(1.0f,2.0f,3.0f));
+  shader->setUniform(shader->getUniformHandle("lightPos"),4.0f,5.0f,6.0f);
+  shader->setUniform(shader->getUniformHandle("uvScale"),ngl::Vec2(2.0f,4.0f));
+  shader->setUniform(shader->getUniformHandle("uvScale"),3.0f,5.0f);
+  shader->setUniform(shader->getUniformHandle("shininess"),20.0f);
+  shader->setUniform(shader->getUniformHandle("tex"),2);
+  shader->setUniform(shader->getUniformHandle("tiles"),1,2,3,4);
+  shader->setUniform(shader->getUniformHandle("lights[2]"),7.0f,8.0f,9.0f);
+  std::vector<recordingGL::Call> byHandle=calls;
+  ngl::GLStateCache::instance()->setEnabled(true);
+
+  ASSERT_EQ(byName.size(),12u);
+  ASSERT_EQ(byHandle.size(),byName.size());
+  for(size_t i=0; i<byName.size(); ++i)
+  {
+    EXPECT_TRUE(byHandle[i]==byName[i]) <<"call "<<i<<" "<<byName[i].func;
+    EXPECT_NE(byHandle[i].loc,-1);
+  }
+  GLint id=static_cast<GLint>(shader->getProgramID("Phong"));
+  EXPECT_EQ(byHandle[0].loc,id*100);
+  EXPECT_EQ(byHandle[11].loc,id*100+10);
+  EXPECT_EQ(byHandle[0].values,std::vector<float>(mvp.openGL(),mvp.openGL()+16));
+}
+
+TEST(NGLShaderLib,handleFollowsCurrentProgram)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  createProgram("A",{{"MVP",GL_FLOAT_MAT4,1},{"colour",GL_FLOAT_VEC4,1}});
+  createProgram("B",{{"colour",GL_FLOAT_VEC4,1},{"MVP",GL_FLOAT_MAT4,1}});
+  GLint a=static_cast<GLint>(shader->getProgramID("A"));
+  GLint b=static_cast<GLint>(shader->getProgramID("B"));
+  ngl::UniformHandle colour=shader->getUniformHandle("colour");
+  auto &calls=recordingGL::state().calls;
+  calls.clear();
+  shader->use("A");
+  EXPECT_EQ(shader->getCurrentProgram(),(*shader)["A"]);
+  shader->setUniform(colour,1.0f,0.0f,0.0f,1.0f);
+  shader->use("B");
+  EXPECT_EQ(shader->getCurrentProgram(),(*shader)["B"]);
+  shader->setUniform(colour,0.0f,1.0f,0.0f,1.0f);
+  // [] also makes the program current for the setters
+  (*shader)["A"];
+  shader->setUniform(colour,0.0f,0.0f,1.0f,1.0f);
+  ASSERT_EQ(calls.size(),3u);
+  EXPECT_EQ(calls[0].loc,a*100+1);
+  EXPECT_EQ(calls[1].loc,b*100);
+  EXPECT_EQ(calls[2].loc,a*100+1);
+  EXPECT_EQ(recordingGL::state().current,static_cast<GLuint>(b));
+  // an unknown program falls back to the null program where nothing is found
+  shader->use("notAProgram");
+  EXPECT_EQ(shader->getCurrentProgram(),(*shader)["NULL"]);
+  calls.clear();
+  shader->setUniform(colour,1.0f,1.0f,1.0f,1.0f);
+  ASSERT_EQ(calls.size(),1u);
+  EXPECT_EQ(calls[0].loc,-1);
+  shader->useNullProgram();
+  EXPECT_EQ(shader->getCurrentProgram(),(*shader)["NULL"]);
+}
+
+TEST(NGLShaderLib,relinkResolvesAgain)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  createProgram("Relink",{{"colour",GL_FLOAT_VEC4,1}});
+  ngl::ShaderProgram *program=(*shader)["Relink"];
+  ngl::UniformHandle later=shader->getUniformHandle("addedLater");
+  ngl::UniformHandle colour=shader->getUniformHandle("colour");
+  GLint id=static_cast<GLint>(program->getID());
+  EXPECT_EQ(program->getUniformLocation(later),-1);
+  EXPECT_EQ(program->getUniformLocation(colour),id*100);
+  // new source with another uniform before colour
+  recordingGL::state().uniforms[program->getID()]={{"addedLater",GL_FLOAT,1},{"colour",GL_FLOAT_VEC4,1}};
+  shader->linkProgramObject("Relink");
+  EXPECT_EQ(program->getUniformLocation(later),id*100);
+  EXPECT_EQ(program->getUniformLocation(colour),id*100+1);
+  // a handle interned after the program was linked
+  EXPECT_EQ(program->getUniformLocation(shader->getUniformHandle("neverUsed")),-1);
+}
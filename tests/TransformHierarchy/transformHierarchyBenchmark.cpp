@@ -0,0 +1,145 @@
+#include <ngl/TransformHierarchy.h>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// a scene graph of 100k nodes, a root with 10 children each with 10 children and so on, where 1% of the nodes
+// change each frame. The hierarchy only recomputes the changed sub trees, this is compared with recomputing every
+// world matrix from the local transforms each frame, walking the tree from the root.
+static const uint32_t s_numNodes=100000;
+static const uint32_t s_branching=10;
+
+struct Scene
+{
+  ngl::TransformHierarchy m_hierarchy;
+  // the same tree as plain arrays for the full recompute, nodes are created parents first
+  std::vector<ngl::Transformation> m_local;
+  std::vector<ngl::Mat4> m_world;
+  std::vector<uint32_t> m_parent;
+  std::vector<uint32_t> m_handle;
+};
+
+static Scene s_scene;
+static volatile float s_sink=0.0f;
+
+float randomFloat(float _min, float _max)
+{
+  return _min+(_max-_min)*(std::rand()/float(RAND_MAX));
+}
+
+void createScene(Scene &o_scene)
+{
+  std::srand(42);
+  for(uint32_t i=0; i<s_numNodes; ++i)
+  {
+    uint32_t parent= i==0 ? ngl::TransformHierarchy::s_none : (i-1)/s_branching;
+    ngl::Transformation t;
+    t.setPosition(randomFloat(-1.0f,1.0f),randomFloat(-1.0f,1.0f),randomFloat(-1.0f,1.0f));
+    t.setRotation(0.0f,randomFloat(0.0f,360.0f),0.0f);
+    o_scene.m_local.push_back(t);
+    o_scene.m_parent.push_back(parent);
+    o_scene.m_handle.push_back(o_scene.m_hierarchy.addNode(t,parent==ngl::TransformHierarchy::s_none ?
+                                                             parent : o_scene.m_handle[parent]));
+  }
+  o_scene.m_world.resize(s_numNodes);
+}
+
+// change the rotation of _count random nodes in both copies
+void changeNodes(Scene &io_scene, uint32_t _count)
+{
+  for(uint32_t i=0; i<_count; ++i)
+  {
+    uint32_t n=std::rand()%s_numNodes;
+    ngl::Vec3 r(0.0f,randomFloat(0.0f,360.0f),0.0f);
+    io_scene.m_local[n].setRotation(r);
+    io_scene.m_hierarchy.setRotation(io_scene.m_handle[n],r);
+  }
+}
+
+void fullRecompute(Scene &io_scene)
+{
+  for(uint32_t i=0; i<s_numNodes; ++i)
+  {
+    const ngl::Mat4 &local=io_scene.m_local[i].getMatrix();
+    io_scene.m_world[i]= io_scene.m_parent[i]==ngl::TransformHierarchy::s_none ?
+                         local : local*io_scene.m_world[io_scene.m_parent[i]];
+  }
+  s_sink+=io_scene.m_world[s_numNodes-1].m_30;
+}
+
+BENCHMARK(Hierarchy100k, FullRecompute, 5, 10) { changeNodes(s_scene,s_numNodes/100); fullRecompute(s_scene); }
+BENCHMARK(Hierarchy100k, Update, 5, 10) { changeNodes(s_scene,s_numNodes/100); s_scene.m_hierarchy.update(1); }
+BENCHMARK(Hierarchy100k, UpdateThreaded, 5, 10) { changeNodes(s_scene,s_numNodes/100); s_scene.m_hierarchy.update(0); }
+
+template <class Func>
+double bestTime(Func _func, int _runs)
+{
+  double best=1e30;
+  for(int run=0; run<_runs; ++run)
+  {
+    auto start=std::chrono::high_resolution_clock::now();
+    _func();
+    std::chrono::duration<double> time=std::chrono::high_resolution_clock::now()-start;
+    best=std::min(best,time.count());
+  }
+  return best;
+}
+
+
+int main(int argc, char **argv)
+{
+  createScene(s_scene);
+  s_scene.m_hierarchy.update();
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+
+  const int frames=100;
+  std::cout<<"\n"<<s_numNodes<<" nodes in "<<s_scene.m_hierarchy.numLevels()<<" levels, "<<frames
+           <<" frames, times in ms per frame\n";
+  for(uint32_t percent : {1u,10u,100u})
+  {
+    uint32_t count=s_numNodes*percent/100;
+    double full=0.0,single=0.0,threaded=0.0;
+    size_t updated=0;
+    for(int f=0; f<frames; ++f)
+    {
+      changeNodes(s_scene,count);
+      full+=bestTime([]{fullRecompute(s_scene);},1);
+      single+=bestTime([]{s_scene.m_hierarchy.update(1);},1);
+      updated+=s_scene.m_hierarchy.numUpdated();
+      changeNodes(s_scene,count);
+      threaded+=bestTime([]{s_scene.m_hierarchy.update(0);},1);
+      // the full recompute has to see the second set of changes as well
+      fullRecompute(s_scene);
+    }
+    printf("%u%% of nodes changed (%.0f world matrices recomputed)\n",percent,double(updated)/frames);
+    printf("  %-28s %10.3f\n","recompute every node",full*1e3/frames);
+    printf("  %-28s %10.3f\n","update one thread",single*1e3/frames);
+    printf("  %-28s %10.3f\n","update all cores",threaded*1e3/frames);
+  }
+  // check the two agree
+  float error=0.0f;
+  for(uint32_t i=0; i<s_numNodes; ++i)
+  {
+    const ngl::Mat4 &a=s_scene.m_world[i];
+    const ngl::Mat4 &b=s_scene.m_hierarchy.getWorldMatrix(s_scene.m_handle[i]);
+    for(int j=0; j<16; ++j)
+    {
+      error=std::max(error,std::abs(a.m_openGL[j]-b.m_openGL[j]));
+    }
+  }
+  printf("largest difference %g\n",error);
+  return result;
+}
@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/TransformHierarchy.h>
+#include <ngl/Vec4.h>
+#include <cstdlib>
+#include <vector>
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+ngl::Transformation makeTransform(const ngl::Vec3 &_position, const ngl::Vec3 &_rotation=ngl::Vec3(0.0f,0.0f,0.0f),
+                                  const ngl::Vec3 &_scale=ngl::Vec3(1.0f,1.0f,1.0f))
+{
+  ngl::Transformation t;
+  t.setPosition(_position);
+  t.setRotation(_rotation);
+  t.setScale(_scale);
+  return t;
+}
+
+void expectMatrixNear(const ngl::Mat4 &_a, const ngl::Mat4 &_b)
+{
+  for(int i=0; i<16; ++i)
+  {
+    EXPECT_NEAR(_a.m_openGL[i],_b.m_openGL[i],1e-4f);
+  }
+}
+
+// the world matrix of a node computed by walking up its parents
+ngl::Mat4 expectedWorld(ngl::TransformHierarchy &_h, uint32_t _node)
+{
+  ngl::Mat4 m;
+  for(uint32_t n=_node; n!=ngl::TransformHierarchy::s_none; n=_h.getParent(n))
+  {
+    ngl::Transformation t=_h.getLocal(n);
+    m=m*t.getMatrix();
+  }
+  return m;
+}
+
+TEST(NGLTransformHierarchy,chain)
+{
+  ngl::TransformHierarchy h;
+  EXPECT_EQ(h.size(),0u);
+  EXPECT_EQ(h.numLevels(),0u);
+  uint32_t root=h.addNode(makeTransform(ngl::Vec3(10.0f,0.0f,0.0f),ngl::Vec3(0.0f,90.0f,0.0f)));
+  uint32_t arm=h.addNode(makeTransform(ngl::Vec3(0.0f,0.0f,2.0f),ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(2.0f,2.0f,2.0f)),root);
+  uint32_t hand=h.addNode(makeTransform(ngl::Vec3(1.0f,0.0f,0.0f)),arm);
+  EXPECT_EQ(h.size(),3u);
+  EXPECT_EQ(h.numLevels(),3u);
+  EXPECT_EQ(h.getParent(hand),arm);
+  EXPECT_EQ(h.getParent(root),ngl::TransformHierarchy::s_none);
+  h.update();
+  EXPECT_EQ(h.numUpdated(),3u);
+  // the hand origin: 1 along x scaled by 2, moved 2 along z, then rotated 90 about y and moved 10 along x
+  ngl::Vec4 p=ngl::Vec4(0.0f,0.0f,0.0f,1.0f)*h.getWorldMatrix(hand);
+  EXPECT_NEAR(p.m_x,12.0f,1e-4f);
+  EXPECT_NEAR(p.m_y,0.0f,1e-4f);
+  EXPECT_NEAR(p.m_z,-2.0f,1e-4f);
+  for(uint32_t n : {root,arm,hand})
+  {
+    expectMatrixNear(h.getWorldMatrix(n),expectedWorld(h,n));
+  }
+  // nothing changed so nothing is recomputed
+  h.update();
+  EXPECT_EQ(h.numUpdated(),0u);
+}
+
+TEST(NGLTransformHierarchy,onlyChangedSubtrees)
+{
+  ngl::TransformHierarchy h;
+  uint32_t root=h.addNode();
+  std::vector<uint32_t> branches,leaves;
+  for(int b=0; b<4; ++b)
+  {
+    branches.push_back(h.addNode(makeTransform(ngl::Vec3(b,0.0f,0.0f)),root));
+  }
+  for(int b=0; b<4; ++b)
+  {
+    for(int l=0; l<10; ++l)
+    {
+      leaves.push_back(h.addNode(makeTransform(ngl::Vec3(0.0f,l,0.0f)),branches[b]));
+    }
+  }
+  h.update();
+  EXPECT_EQ(h.numUpdated(),45u);
+  // a branch and its 10 leaves
+  EXPECT_TRUE(h.setRotation(branches[2],ngl::Vec3(0.0f,0.0f,30.0f)));
+  h.update();
+  EXPECT_EQ(h.numUpdated(),11u);
+  // two leaves
+  h.setPosition(leaves[0],ngl::Vec3(1.0f,1.0f,1.0f));
+  h.setScale(leaves[39],ngl::Vec3(3.0f,3.0f,3.0f));
+  h.update();
+  EXPECT_EQ(h.numUpdated(),2u);
+  // everything
+  h.setLocal(root,makeTransform(ngl::Vec3(0.0f,0.0f,-5.0f)));
+  h.update();
+  EXPECT_EQ(h.numUpdated(),45u);
+  for(uint32_t n : leaves)
+  {
+    expectMatrixNear(h.getWorldMatrix(n),expectedWorld(h,n));
+  }
+  EXPECT_FALSE(h.setPosition(1000,ngl::Vec3(1.0f,1.0f,1.0f)));
+}
+
+TEST(NGLTransformHierarchy,structure)
+{
+  ngl::TransformHierarchy h;
+  EXPECT_EQ(h.addNode(ngl::Transformation(),5),ngl::TransformHierarchy::s_none);
+  uint32_t a=h.addNode(makeTransform(ngl::Vec3(1.0f,0.0f,0.0f)));
+  uint32_t b=h.addNode(makeTransform(ngl::Vec3(0.0f,1.0f,0.0f)),a);
+  uint32_t c=h.addNode(makeTransform(ngl::Vec3(0.0f,0.0f,1.0f)),b);
+  uint32_t d=h.addNode(makeTransform(ngl::Vec3(5.0f,0.0f,0.0f)));
+  // a root after a deeper node and a child of it
+  uint32_t e=h.addNode(makeTransform(ngl::Vec3(0.0f,5.0f,0.0f)),d);
+  h.update();
+  for(uint32_t n : {a,b,c,d,e})
+  {
+    expectMatrixNear(h.getWorldMatrix(n),expectedWorld(h,n));
+  }
+  // no cycles
+  EXPECT_FALSE(h.setParent(a,c));
+  EXPECT_FALSE(h.setParent(a,a));
+  EXPECT_FALSE(h.setParent(a,99));
+  // move b (and c) under e, only they are recomputed
+  EXPECT_TRUE(h.setParent(b,e));
+  h.update();
+  EXPECT_EQ(h.numUpdated(),2u);
+  EXPECT_EQ(h.getParent(b),e);
+  EXPECT_EQ(h.numLevels(),4u);
+  for(uint32_t n : {a,b,c,d,e})
+  {
+    expectMatrixNear(h.getWorldMatrix(n),expectedWorld(h,n));
+  }
+  ngl::Vec4 p=ngl::Vec4(0.0f,0.0f,0.0f,1.0f)*h.getWorldMatrix(c);
+  EXPECT_NEAR(p.m_x,5.0f,1e-4f);
+  EXPECT_NEAR(p.m_y,6.0f,1e-4f);
+  EXPECT_NEAR(p.m_z,1.0f,1e-4f);
+  // removing d takes e, b and c with it
+  EXPECT_TRUE(h.removeNode(d));
+  EXPECT_FALSE(h.removeNode(d));
+  EXPECT_EQ(h.size(),1u);
+  EXPECT_EQ(h.numLevels(),1u);
+  EXPECT_TRUE(h.contains(a));
+  for(uint32_t n : {b,c,d,e})
+  {
+    EXPECT_FALSE(h.contains(n));
+  }
+  // handles are reused
+  uint32_t f=h.addNode(makeTransform(ngl::Vec3(0.0f,0.0f,3.0f)),a);
+  EXPECT_TRUE(f==b || f==c || f==d || f==e);
+  h.update();
+  EXPECT_EQ(h.numUpdated(),1u);
+  expectMatrixNear(h.getWorldMatrix(f),expectedWorld(h,f));
+  h.clear();
+  EXPECT_EQ(h.size(),0u);
+  EXPECT_FALSE(h.contains(a));
+}
+
+// a random hierarchy built in depth first order then shuffled with setParent, updated on one and many threads
+TEST(NGLTransformHierarchy,threaded)
+{
+  std::srand(7);
+  ngl::TransformHierarchy single,threaded;
+  std::vector<uint32_t> nodes;
+  for(int i=0; i<20000; ++i)
+  {
+    uint32_t parent= i==0 ? ngl::TransformHierarchy::s_none : nodes[std::rand()%nodes.size()];
+    ngl::Transformation t=makeTransform(ngl::Vec3(std::rand()%5*0.1f,std::rand()%5*0.1f,0.2f),
+                                        ngl::Vec3(0.0f,std::rand()%90,0.0f));
+    uint32_t a=single.addNode(t,parent);
+    uint32_t b=threaded.addNode(t,parent);
+    ASSERT_EQ(a,b);
+    nodes.push_back(a);
+  }
+  for(int i=0; i<100; ++i)
+  {
+    uint32_t n=nodes[1+std::rand()%(nodes.size()-1)];
+    uint32_t p=nodes[std::rand()%nodes.size()];
+    EXPECT_EQ(single.setParent(n,p),threaded.setParent(n,p));
+  }
+  single.update(1);
+  threaded.update(4);
+  EXPECT_EQ(single.numUpdated(),nodes.size());
+  EXPECT_EQ(threaded.numUpdated(),nodes.size());
+  for(size_t i=0; i<nodes.size(); i+=97)
+  {
+    expectMatrixNear(single.getWorldMatrix(nodes[i]),expectedWorld(single,nodes[i]));
+  }
+  for(int i=0; i<200; ++i)
+  {
+    uint32_t n=nodes[std::rand()%nodes.size()];
+    single.setPosition(n,ngl::Vec3(1.0f,2.0f,3.0f));
+    threaded.setPosition(n,ngl::Vec3(1.0f,2.0f,3.0f));
+  }
+  single.update(1);
+  threaded.update(0);
+  EXPECT_EQ(single.numUpdated(),threaded.numUpdated());
+  EXPECT_LT(single.numUpdated(),nodes.size());
+  for(uint32_t n : nodes)
+  {
+    ASSERT_TRUE(single.getWorldMatrix(n)==threaded.getWorldMatrix(n));
+  }
+}
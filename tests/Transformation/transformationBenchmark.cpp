@@ -0,0 +1,180 @@
+#include <ngl/Transformation.h>
+#include <ngl/Quaternion.h>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// compute the matrices of 1M transformations after every one has changed. The previous way, a Mat4 per part
+// multiplied together and then the transpose and inverse, is written out here to compare against.
+static const size_t s_count=1000000;
+
+struct Parts
+{
+  ngl::Vec3 m_position;
+  ngl::Vec3 m_rotation;
+  ngl::Vec3 m_scale;
+};
+
+static std::vector<Parts> s_parts;
+static std::vector<ngl::Transformation> s_transforms;
+static std::vector<ngl::Quaternion> s_quaternions;
+static volatile float s_sink=0.0f;
+
+float randomFloat(float _min, float _max)
+{
+  return _min+(_max-_min)*(std::rand()/float(RAND_MAX));
+}
+
+void previousMatrices(const Parts &_p, ngl::Mat4 &o_matrix, ngl::Mat4 &o_transpose, ngl::Mat4 &o_inverse)
+{
+  ngl::Mat4 scale,rX,rY,rZ,trans;
+  scale.scale(_p.m_scale.m_x,_p.m_scale.m_y,_p.m_scale.m_z);
+  rX.rotateX(_p.m_rotation.m_x);
+  rY.rotateY(_p.m_rotation.m_y);
+  rZ.rotateZ(_p.m_rotation.m_z);
+  ngl::Mat4 rotationScale=scale*rX*rY*rZ;
+  o_matrix=rotationScale;
+  o_matrix.m_m[3][0]=_p.m_position.m_x;
+  o_matrix.m_m[3][1]=_p.m_position.m_y;
+  o_matrix.m_m[3][2]=_p.m_position.m_z;
+  o_matrix.m_m[3][3]=1;
+  o_transpose=rotationScale;
+  o_transpose.transpose();
+  o_transpose.m_m[0][3]=_p.m_position.m_x;
+  o_transpose.m_m[1][3]=_p.m_position.m_y;
+  o_transpose.m_m[2][3]=_p.m_position.m_z;
+  o_transpose.m_m[3][3]=1;
+  trans.translate(-_p.m_position.m_x,-_p.m_position.m_y,-_p.m_position.m_z);
+  scale.scale(1.0f/_p.m_scale.m_x,1.0f/_p.m_scale.m_y,1.0f/_p.m_scale.m_z);
+  rX.rotateX(-_p.m_rotation.m_x);
+  rY.rotateY(-_p.m_rotation.m_y);
+  rZ.rotateZ(-_p.m_rotation.m_z);
+  o_inverse=trans*rZ*rY*rX*scale;
+}
+
+void previousAll()
+{
+  ngl::Mat4 m,t,i;
+  float sum=0.0f;
+  for(const Parts &p : s_parts)
+  {
+    previousMatrices(p,m,t,i);
+    sum+=m.m_30+t.m_03+i.m_30;
+  }
+  s_sink+=sum;
+}
+
+// touch every transform so the next get has to compute
+void changeAll()
+{
+  for(size_t i=0; i<s_count; ++i)
+  {
+    s_transforms[i].setPosition(s_parts[i].m_position);
+  }
+}
+
+void changeAllQuaternion()
+{
+  for(size_t i=0; i<s_count; ++i)
+  {
+    s_transforms[i].setRotation(s_quaternions[i]);
+  }
+}
+
+void matrixOnly()
+{
+  float sum=0.0f;
+  for(ngl::Transformation &t : s_transforms)
+  {
+    sum+=t.getMatrix().m_30;
+  }
+  s_sink+=sum;
+}
+
+void matrixAndInverse()
+{
+  float sum=0.0f;
+  for(ngl::Transformation &t : s_transforms)
+  {
+    sum+=t.getMatrix().m_30+t.getInverseMatrix().m_30;
+  }
+  s_sink+=sum;
+}
+
+void allThree()
+{
+  float sum=0.0f;
+  for(ngl::Transformation &t : s_transforms)
+  {
+    sum+=t.getMatrix().m_30+t.getTransposeMatrix().m_03+t.getInverseMatrix().m_30;
+  }
+  s_sink+=sum;
+}
+
+BENCHMARK(Transformation1M, Previous, 2, 5) { previousAll(); }
+BENCHMARK(Transformation1M, MatrixOnly, 2, 5) { changeAll(); matrixOnly(); }
+BENCHMARK(Transformation1M, AllThree, 2, 5) { changeAll(); allThree(); }
+
+template <class Func>
+double bestTime(Func _func, int _runs)
+{
+  double best=1e30;
+  for(int run=0; run<_runs; ++run)
+  {
+    auto start=std::chrono::high_resolution_clock::now();
+    _func();
+    std::chrono::duration<double> time=std::chrono::high_resolution_clock::now()-start;
+    best=std::min(best,time.count());
+  }
+  return best;
+}
+
+
+int main(int argc, char **argv)
+{
+  std::srand(42);
+  for(size_t i=0; i<s_count; ++i)
+  {
+    Parts p;
+    p.m_position.set(randomFloat(-10.0f,10.0f),randomFloat(-10.0f,10.0f),randomFloat(-10.0f,10.0f));
+    p.m_rotation.set(randomFloat(0.0f,360.0f),randomFloat(0.0f,360.0f),randomFloat(0.0f,360.0f));
+    p.m_scale.set(randomFloat(0.5f,2.0f),randomFloat(0.5f,2.0f),randomFloat(0.5f,2.0f));
+    s_parts.push_back(p);
+    ngl::Transformation t;
+    t.setPosition(p.m_position);
+    t.setRotation(p.m_rotation);
+    t.setScale(p.m_scale);
+    s_transforms.push_back(t);
+    s_quaternions.push_back(ngl::Quaternion(p.m_rotation));
+  }
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+
+  // the change loop is timed on its own and taken off the get times
+  double change=bestTime(changeAll,5);
+  double previous=bestTime(previousAll,5);
+  double matrix=bestTime([]{changeAll(); matrixOnly();},5)-change;
+  double inverse=bestTime([]{changeAll(); matrixAndInverse();},5)-change;
+  double all=bestTime([]{changeAll(); allThree();},5)-change;
+  double quatChange=bestTime(changeAllQuaternion,5);
+  double quat=bestTime([]{changeAllQuaternion(); matrixOnly();},5)-quatChange;
+  std::cout<<"\n"<<s_count<<" transformations, best of 5 in ms\n";
+  printf("%-40s %10.2f\n","previous: multiplies, transpose, inverse",previous*1e3);
+  printf("%-40s %10.2f\n","matrix only",matrix*1e3);
+  printf("%-40s %10.2f\n","matrix and inverse",inverse*1e3);
+  printf("%-40s %10.2f\n","matrix, transpose and inverse",all*1e3);
+  printf("%-40s %10.2f\n","matrix only from a quaternion",quat*1e3);
+  return result;
+}
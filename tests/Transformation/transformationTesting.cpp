@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/Transformation.h>
+#include <ngl/Quaternion.h>
+#include <cstdlib>
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+float randomFloat(float _min, float _max)
+{
+  return _min+(_max-_min)*(std::rand()/float(RAND_MAX));
+}
+
+void expectMatrixNear(const ngl::Mat4 &_a, const ngl::Mat4 &_b, float _tolerance=1e-4f)
+{
+  for(int i=0; i<16; ++i)
+  {
+    EXPECT_NEAR(_a.m_openGL[i],_b.m_openGL[i],_tolerance);
+  }
+}
+
+// the matrix built the way it was before with a multiply per part
+ngl::Mat4 matrixFromParts(const ngl::Vec3 &_position, const ngl::Vec3 &_rotation, const ngl::Vec3 &_scale)
+{
+  ngl::Mat4 scale,rX,rY,rZ;
+  scale.scale(_scale.m_x,_scale.m_y,_scale.m_z);
+  rX.rotateX(_rotation.m_x);
+  rY.rotateY(_rotation.m_y);
+  rZ.rotateZ(_rotation.m_z);
+  ngl::Mat4 m=scale*rX*rY*rZ;
+  m.m_30=_position.m_x;
+  m.m_31=_position.m_y;
+  m.m_32=_position.m_z;
+  return m;
+}
+
+TEST(NGLTransformation,defaultIdentity)
+{
+  ngl::Transformation t;
+  expectMatrixNear(t.getMatrix(),ngl::Mat4());
+  expectMatrixNear(t.getTransposeMatrix(),ngl::Mat4());
+  expectMatrixNear(t.getInverseMatrix(),ngl::Mat4());
+}
+
+TEST(NGLTransformation,matchesMatrixProduct)
+{
+  std::srand(1);
+  for(int i=0; i<200; ++i)
+  {
+    ngl::Vec3 position(randomFloat(-10.0f,10.0f),randomFloat(-10.0f,10.0f),randomFloat(-10.0f,10.0f));
+    ngl::Vec3 rotation(randomFloat(-360.0f,360.0f),randomFloat(-360.0f,360.0f),randomFloat(-360.0f,360.0f));
+    ngl::Vec3 scale(randomFloat(0.2f,3.0f),randomFloat(0.2f,3.0f),randomFloat(0.2f,3.0f));
+    ngl::Transformation t;
+    t.setPosition(position);
+    t.setRotation(rotation);
+    t.setScale(scale);
+    ngl::Mat4 m=matrixFromParts(position,rotation,scale);
+    expectMatrixNear(t.getMatrix(),m);
+    ngl::Mat4 transpose=m;
+    transpose.transpose();
+    expectMatrixNear(t.getTransposeMatrix(),transpose);
+    expectMatrixNear(t.getInverseMatrix(),m.inverse(),1e-3f);
+    expectMatrixNear(t.getMatrix()*t.getInverseMatrix(),ngl::Mat4());
+  }
+}
+
+TEST(NGLTransformation,lazyAfterChange)
+{
+  ngl::Transformation t;
+  t.setPosition(1.0f,2.0f,3.0f);
+  // the inverse is asked for first and must bring the matrix up to date too
+  ngl::Mat4 inv=t.getInverseMatrix();
+  EXPECT_FLOAT_EQ(inv.m_30,-1.0f);
+  EXPECT_FLOAT_EQ(inv.m_31,-2.0f);
+  EXPECT_FLOAT_EQ(inv.m_32,-3.0f);
+  EXPECT_FLOAT_EQ(t.getMatrix().m_30,1.0f);
+  t.addPosition(1.0f,0.0f,0.0f);
+  EXPECT_FLOAT_EQ(t.getTransposeMatrix().m_03,2.0f);
+  EXPECT_FLOAT_EQ(t.getInverseMatrix().m_30,-2.0f);
+  // a copy of a changed transform is still changed
+  t.setScale(2.0f,2.0f,2.0f);
+  ngl::Transformation copy(t);
+  EXPECT_FLOAT_EQ(copy.getMatrix().m_00,2.0f);
+  EXPECT_FLOAT_EQ(copy.getInverseMatrix().m_00,0.5f);
+  t.reset();
+  expectMatrixNear(t.getInverseMatrix(),ngl::Mat4());
+}
+
+TEST(NGLTransformation,quaternion)
+{
+  ngl::Quaternion q;
+  q.fromAxisAngle(ngl::Vec3(1.0f,2.0f,-0.5f),37.0f);
+  ngl::Transformation t;
+  t.setPosition(3.0f,-1.0f,2.0f);
+  t.setScale(1.0f,2.0f,0.5f);
+  t.setRotation(q);
+  ngl::Mat4 m=q.toMat4();
+  ngl::Mat4 scale;
+  scale.scale(1.0f,2.0f,0.5f);
+  m=scale*m;
+  m.m_30=3.0f;
+  m.m_31=-1.0f;
+  m.m_32=2.0f;
+  expectMatrixNear(t.getMatrix(),m);
+  expectMatrixNear(t.getInverseMatrix(),m.inverse(),1e-3f);
+  // setting euler angles goes back to using them
+  t.setRotation(0.0f,90.0f,0.0f);
+  expectMatrixNear(t.getMatrix(),matrixFromParts(ngl::Vec3(3.0f,-1.0f,2.0f),ngl::Vec3(0.0f,90.0f,0.0f),
+                                                 ngl::Vec3(1.0f,2.0f,0.5f)));
+}
+
+TEST(NGLTransformation,setMatrix)
+{
+  ngl::Mat4 m=matrixFromParts(ngl::Vec3(1.0f,2.0f,3.0f),ngl::Vec3(10.0f,20.0f,30.0f),ngl::Vec3(1.0f,1.0f,1.0f));
+  m.m_01=0.5f; // a shear so the inverse has to be a general one
+  ngl::Transformation t;
+  t.setMatrix(m);
+  expectMatrixNear(t.getMatrix(),m);
+  expectMatrixNear(t.getInverseMatrix(),m.inverse());
+  ngl::Mat4 transpose=m;
+  transpose.transpose();
+  expectMatrixNear(t.getTransposeMatrix(),transpose);
+}
+
+TEST(NGLTransformation,multiply)
+{
+  ngl::Transformation a,b;
+  a.setPosition(1.0f,0.0f,0.0f);
+  a.setRotation(0.0f,45.0f,0.0f);
+  b.setScale(2.0f,2.0f,2.0f);
+  b.setPosition(0.0f,3.0f,0.0f);
+  ngl::Mat4 ma=matrixFromParts(ngl::Vec3(1.0f,0.0f,0.0f),ngl::Vec3(0.0f,45.0f,0.0f),ngl::Vec3(1.0f,1.0f,1.0f));
+  ngl::Mat4 mb=matrixFromParts(ngl::Vec3(0.0f,3.0f,0.0f),ngl::Vec3(0.0f,0.0f,0.0f),ngl::Vec3(2.0f,2.0f,2.0f));
+  ngl::Transformation c=a*b;
+  expectMatrixNear(c.getMatrix(),ma*mb);
+  expectMatrixNear(c.getInverseMatrix(),ma.inverse()*mb.inverse());
+  // *= uses Mat4::operator*= which multiplies by _m on the left
+  a*=b;
+  expectMatrixNear(a.getMatrix(),mb*ma);
+  expectMatrixNear(a.getInverseMatrix(),mb.inverse()*ma.inverse());
+}
@@ -0,0 +1,220 @@
+#include <ngl/GLStateCache.h>
+#include <ngl/Light.h>
+#include <ngl/Material.h>
+#include <ngl/ShaderLib.h>
+#include <ngl/UniformBlock.h>
+#include <ngl/UniformBuffer.h>
+#include "../ShaderLib/recordingGL.h"
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// a frame of 1000 objects lit by 4 lights, each with its own matrices and material. The per uniform path sets the
+// matrices, Material::loadToShader and Light::loadToShader for every draw as the NGL demos do, the uniform buffer
+// path packs a per frame block (camera and lights) and a per object block (matrices and material) into a
+// UniformBuffer and binds a range for each draw. The GL calls go to a stand in for the driver which counts them.
+static const size_t s_objects=1000;
+static const size_t s_lights=4;
+
+struct Object
+{
+  ngl::Mat4 MVP;
+  ngl::Mat4 MV;
+  ngl::Mat3 normalMatrix;
+  ngl::Material material;
+  GLintptr offset;
+};
+
+static ngl::ShaderLib *s_shader=nullptr;
+static std::vector<Object> s_scene;
+static std::vector<ngl::Light> s_lightList;
+static ngl::Mat4 s_VP;
+static ngl::Vec3 s_eye(0.0f,2.0f,10.0f);
+static std::vector<std::string> s_lightNames;
+
+static ngl::UniformBlockLayout s_frameLayout,s_objectLayout;
+static std::unique_ptr<ngl::UniformBlock> s_frameBlock,s_objectBlock;
+static std::unique_ptr<ngl::UniformBuffer> s_ubo;
+static const ngl::UniformBlockLayout::Member *s_MVP,*s_MV,*s_normalMatrix;
+
+void drawPerUniform()
+{
+  s_shader->setUniform("VP",s_VP);
+  s_shader->setUniform("eye",s_eye);
+  for(auto &o : s_scene)
+  {
+    s_shader->setUniform("MVP",o.MVP);
+    s_shader->setUniform("MV",o.MV);
+    s_shader->setUniform("normalMatrix",o.normalMatrix);
+    o.material.loadToShader("material");
+    for(size_t l=0; l<s_lights; ++l)
+    {
+      s_lightList[l].loadToShader(s_lightNames[l]);
+    }
+  }
+}
+
+void drawUniformBuffer()
+{
+  s_frameBlock->set("VP",s_VP);
+  s_frameBlock->set("eye",s_eye);
+  for(size_t l=0; l<s_lights; ++l)
+  {
+    s_lightList[l].loadToBlock(*s_frameBlock,s_lightNames[l]);
+  }
+  GLintptr frame=s_ubo->push(*s_frameBlock);
+  for(auto &o : s_scene)
+  {
+    s_objectBlock->set(*s_MVP,o.MVP);
+    s_objectBlock->set(*s_MV,o.MV);
+    s_objectBlock->set(*s_normalMatrix,o.normalMatrix);
+    o.material.loadToBlock(*s_objectBlock,"material");
+    o.offset=s_ubo->push(*s_objectBlock);
+  }
+  s_ubo->bindRange(0,frame,s_frameBlock->size());
+  for(auto &o : s_scene)
+  {
+    s_ubo->bindRange(1,o.offset,s_objectBlock->size());
+  }
+  s_ubo->nextFrame();
+}
+
+BENCHMARK(Frame1kObjects, PerUniform, 5, 10) { drawPerUniform(); }
+BENCHMARK(Frame1kObjects, UniformBuffer, 5, 10) { drawUniformBuffer(); }
+
+template <class Func>
+double bestTime(Func _func, int _runs)
+{
+  double best=1e30;
+  for(int run=0; run<_runs; ++run)
+  {
+    auto start=std::chrono::high_resolution_clock::now();
+    _func();
+    std::chrono::duration<double> time=std::chrono::high_resolution_clock::now()-start;
+    best=std::min(best,time.count());
+  }
+  return best;
+}
+
+template <class Func>
+void report(const char *_name, Func _func)
+{
+  auto &state=recordingGL::state();
+  _func();
+  state.uniformCalls=state.uniformBytes=state.bufferUploads=state.bufferBytes=0;
+  state.ranges.clear();
+  _func();
+  size_t calls=state.uniformCalls+state.bufferUploads+state.ranges.size();
+  size_t bytes=state.uniformBytes+state.bufferBytes;
+  double time=bestTime(_func,20);
+  printf("%-30s %10zu %12zu %10.3f\n",_name,calls,bytes,time*1e3);
+}
+
+ngl::UniformBlockLayout lightLayout()
+{
+  ngl::UniformBlockLayout light;
+  light.addMember("position",GL_FLOAT_VEC4);
+  light.addMember("ambient",GL_FLOAT_VEC4);
+  light.addMember("diffuse",GL_FLOAT_VEC4);
+  light.addMember("specular",GL_FLOAT_VEC4);
+  light.addMember("constantAttenuation",GL_FLOAT);
+  light.addMember("linearAttenuation",GL_FLOAT);
+  light.addMember("quadraticAttenuation",GL_FLOAT);
+  light.addMember("spotCosCutoff",GL_FLOAT);
+  return light;
+}
+
+ngl::UniformBlockLayout materialLayout()
+{
+  ngl::UniformBlockLayout material;
+  material.addMember("ambient",GL_FLOAT_VEC4);
+  material.addMember("diffuse",GL_FLOAT_VEC4);
+  material.addMember("specular",GL_FLOAT_VEC4);
+  material.addMember("shininess",GL_FLOAT);
+  return material;
+}
+
+int main(int argc, char **argv)
+{
+  recordingGL::install();
+  recordingGL::state().record=false;
+  s_shader=ngl::ShaderLib::instance();
+  // the uniforms of the per uniform shader
+  std::vector<recordingGL::Uniform> uniforms={{"VP",GL_FLOAT_MAT4,1},{"eye",GL_FLOAT_VEC3,1},{"MVP",GL_FLOAT_MAT4,1},
+                                               {"MV",GL_FLOAT_MAT4,1},{"normalMatrix",GL_FLOAT_MAT3,1}};
+  ngl::UniformBlockLayout material=materialLayout();
+  ngl::UniformBlockLayout light=lightLayout();
+  for(auto &m : material.members())
+  {
+    uniforms.push_back({"material."+m.m_name,m.m_type,1});
+  }
+  for(size_t l=0; l<s_lights; ++l)
+  {
+    s_lightNames.push_back("light["+std::to_string(l)+"]");
+    for(auto &m : light.members())
+    {
+      uniforms.push_back({s_lightNames.back()+"."+m.m_name,m.m_type,1});
+    }
+    s_lightList.push_back(ngl::Light(ngl::Vec3(float(l),5.0f,2.0f),ngl::Colour(1.0f,1.0f,1.0f,1.0f),
+                                     ngl::LightModes::POINTLIGHT));
+  }
+  s_shader->createShaderProgram("Phong");
+  recordingGL::state().uniforms[s_shader->getProgramID("Phong")]=uniforms;
+  s_shader->linkProgramObject("Phong");
+  s_shader->use("Phong");
+  // every call is made so the two paths send the same values
+  ngl::GLStateCache::instance()->setEnabled(false);
+
+  s_frameLayout.addMember("VP",GL_FLOAT_MAT4);
+  s_frameLayout.addMember("eye",GL_FLOAT_VEC3);
+  s_frameLayout.addStruct("light",light,s_lights);
+  s_objectLayout.addMember("MVP",GL_FLOAT_MAT4);
+  s_objectLayout.addMember("MV",GL_FLOAT_MAT4);
+  s_objectLayout.addMember("normalMatrix",GL_FLOAT_MAT3);
+  s_objectLayout.addStruct("material",material);
+  s_frameBlock.reset(new ngl::UniformBlock(s_frameLayout));
+  s_objectBlock.reset(new ngl::UniformBlock(s_objectLayout));
+  s_MVP=s_objectLayout.find("MVP");
+  s_MV=s_objectLayout.find("MV");
+  s_normalMatrix=s_objectLayout.find("normalMatrix");
+  s_ubo.reset(new ngl::UniformBuffer(1<<20,3,256));
+
+  for(size_t i=0; i<s_objects; ++i)
+  {
+    Object o;
+    o.MV.translate(float(i),0.0f,-5.0f);
+    o.MVP=s_VP*o.MV;
+    o.normalMatrix=o.MV;
+    o.material=ngl::Material(ngl::Colour(0.1f,0.1f,0.1f,1.0f),ngl::Colour(i/float(s_objects),0.5f,0.5f,1.0f),
+                             ngl::Colour(1.0f,1.0f,1.0f,1.0f));
+    s_scene.push_back(o);
+  }
+
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+
+  std::cout<<"\n"<<s_objects<<" objects, "<<s_lights<<" lights, per frame (frame block "<<s_frameLayout.size()
+           <<" bytes, object block "<<s_objectLayout.size()<<" bytes)\n";
+  printf("%-30s %10s %12s %10s\n","","GL calls","bytes","ms");
+  report("per uniform",drawPerUniform);
+  // with the GLStateCache filtering the repeated values are skipped but every name is still looked up and compared
+  ngl::GLStateCache::instance()->setEnabled(true);
+  s_shader->use("Phong");
+  report("per uniform, filtered",drawPerUniform);
+  ngl::GLStateCache::instance()->setEnabled(false);
+  report("uniform buffer",drawUniformBuffer);
+  return result;
+}
@@ -0,0 +1,373 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/UniformBlock.h>
+#include <ngl/UniformBuffer.h>
+#include <ngl/Material.h>
+#include <ngl/Light.h>
+#include <ngl/ShaderLib.h>
+#include "../ShaderLib/recordingGL.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+int main(int argc, char **argv)
+{
+  // no OpenGL context is needed as the calls go to the recording stand in
+  recordingGL::install();
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+size_t offsetOf(const ngl::UniformBlockLayout &_layout, const std::string &_name)
+{
+  const ngl::UniformBlockLayout::Member *m=_layout.find(_name);
+  EXPECT_TRUE(m!=nullptr) <<_name;
+  return m ? m->m_offset : 0;
+}
+
+float floatAt(const ngl::UniformBlock &_block, size_t _offset)
+{
+  float f;
+  std::memcpy(&f,_block.data()+_offset,sizeof(float));
+  return f;
+}
+
+// the example block from the ARB_uniform_buffer_object specification with the offsets it gives
+//   float a; vec2 b; vec3 c; struct { int d; bvec2 e; } f; float g; float h[2]; mat2x3 i;
+//   struct { uvec3 j; vec2 k; float l[2]; vec2 m; mat3 n[2]; } o[2];
+ngl::UniformBlockLayout specExample()
+{
+  ngl::UniformBlockLayout f;
+  f.addMember("d",GL_INT);
+  f.addMember("e",GL_BOOL_VEC2);
+  ngl::UniformBlockLayout o;
+  o.addMember("j",GL_UNSIGNED_INT_VEC3);
+  o.addMember("k",GL_FLOAT_VEC2);
+  o.addMember("l",GL_FLOAT,2);
+  o.addMember("m",GL_FLOAT_VEC2);
+  o.addMember("n",GL_FLOAT_MAT3,2);
+  ngl::UniformBlockLayout layout;
+  layout.addMember("a",GL_FLOAT);
+  layout.addMember("b",GL_FLOAT_VEC2);
+  layout.addMember("c",GL_FLOAT_VEC3);
+  layout.addStruct("f",f);
+  layout.addMember("g",GL_FLOAT);
+  layout.addMember("h",GL_FLOAT,2);
+  layout.addMember("i",GL_FLOAT_MAT2x3);
+  layout.addStruct("o",o,2);
+  return layout;
+}
+
+TEST(NGLUniformBlock,std140SpecExample)
+{
+  ngl::UniformBlockLayout layout=specExample();
+  EXPECT_EQ(offsetOf(layout,"a"),0u);
+  EXPECT_EQ(offsetOf(layout,"b"),8u);
+  EXPECT_EQ(offsetOf(layout,"c"),16u);
+  EXPECT_EQ(offsetOf(layout,"f.d"),32u);
+  EXPECT_EQ(offsetOf(layout,"f.e"),40u);
+  EXPECT_EQ(offsetOf(layout,"g"),48u);
+  EXPECT_EQ(offsetOf(layout,"h"),64u);
+  EXPECT_EQ(layout.find("h")->m_arrayStride,16u);
+  EXPECT_EQ(offsetOf(layout,"i"),96u);
+  EXPECT_EQ(layout.find("i")->m_matrixStride,16u);
+  EXPECT_EQ(offsetOf(layout,"o[0].j"),128u);
+  EXPECT_EQ(offsetOf(layout,"o[0].k"),144u);
+  EXPECT_EQ(offsetOf(layout,"o[0].l"),160u);
+  EXPECT_EQ(offsetOf(layout,"o[0].m"),192u);
+  EXPECT_EQ(offsetOf(layout,"o[0].n"),208u);
+  EXPECT_EQ(layout.find("o[0].n")->m_arrayStride,48u);
+  EXPECT_EQ(offsetOf(layout,"o[1].j"),304u);
+  EXPECT_EQ(offsetOf(layout,"o[1].k"),320u);
+  EXPECT_EQ(offsetOf(layout,"o[1].l"),336u);
+  EXPECT_EQ(offsetOf(layout,"o[1].m"),368u);
+  EXPECT_EQ(offsetOf(layout,"o[1].n"),384u);
+  EXPECT_EQ(layout.size(),480u);
+  EXPECT_TRUE(layout.find("o[2].j")==nullptr);
+  EXPECT_FALSE(layout.addMember("sampler",GL_SAMPLER_2D));
+}
+
+TEST(NGLUniformBlock,std140Packing)
+{
+  // a float fills the end of a vec3, a vec3 after a float and every matrix start on 16
+  ngl::UniformBlockLayout layout;
+  layout.addMember("direction",GL_FLOAT_VEC3);
+  layout.addMember("cutoff",GL_FLOAT);
+  layout.addMember("shininess",GL_FLOAT);
+  layout.addMember("position",GL_FLOAT_VEC3);
+  layout.addMember("normalMatrix",GL_FLOAT_MAT3);
+  layout.addMember("MVP",GL_FLOAT_MAT4);
+  layout.addMember("flags",GL_INT,3);
+  EXPECT_EQ(offsetOf(layout,"cutoff"),12u);
+  EXPECT_EQ(offsetOf(layout,"shininess"),16u);
+  EXPECT_EQ(offsetOf(layout,"position"),32u);
+  EXPECT_EQ(offsetOf(layout,"normalMatrix"),48u);
+  EXPECT_EQ(offsetOf(layout,"MVP"),96u);
+  EXPECT_EQ(offsetOf(layout,"flags"),160u);
+  EXPECT_EQ(layout.size(),208u);
+
+  ngl::UniformBlock block(layout);
+  ASSERT_EQ(block.size(),208u);
+  ngl::Mat3 normal;
+  for(int i=0; i<9; ++i)
+  {
+    normal.m_openGL[i]=float(i+1);
+  }
+  ngl::Mat4 mvp;
+  mvp.translate(1.0f,2.0f,3.0f);
+  EXPECT_TRUE(block.set("direction",ngl::Vec3(1.0f,2.0f,3.0f)));
+  EXPECT_TRUE(block.set("cutoff",0.5f));
+  EXPECT_TRUE(block.set("normalMatrix",normal));
+  EXPECT_TRUE(block.set("MVP",mvp));
+  EXPECT_TRUE(block.set("flags[2]",7));
+  EXPECT_FLOAT_EQ(floatAt(block,0),1.0f);
+  EXPECT_FLOAT_EQ(floatAt(block,8),3.0f);
+  EXPECT_FLOAT_EQ(floatAt(block,12),0.5f);
+  // each column of the mat3 on 16 bytes, the padding left 0
+  for(size_t c=0; c<3; ++c)
+  {
+    for(size_t r=0; r<3; ++r)
+    {
+      EXPECT_FLOAT_EQ(floatAt(block,48+16*c+4*r),float(c*3+r+1));
+    }
+    EXPECT_FLOAT_EQ(floatAt(block,48+16*c+12),0.0f);
+  }
+  EXPECT_EQ(std::memcmp(block.data()+96,mvp.openGL(),64),0);
+  GLint flag;
+  std::memcpy(&flag,block.data()+160+32,sizeof(GLint));
+  EXPECT_EQ(flag,7);
+  // errors leave the data alone
+  std::vector<unsigned char> before(block.data(),block.data()+block.size());
+  EXPECT_FALSE(block.set("notAMember",1.0f));
+  EXPECT_TRUE(block.set("cutoff",ngl::Vec4(1.0f,1.0f,1.0f,1.0f)));
+  EXPECT_TRUE(block.set("flags[3]",1));
+  EXPECT_TRUE(std::vector<unsigned char>(block.data(),block.data()+block.size())==before);
+}
+
+TEST(NGLUniformBlock,structArrays)
+{
+  ngl::UniformBlockLayout layout=specExample();
+  ngl::UniformBlock block(layout);
+  EXPECT_TRUE(block.set("o[1].k",ngl::Vec2(4.0f,5.0f)));
+  EXPECT_TRUE(block.set("o[1].l[1]",6.0f));
+  ngl::Mat3 n;
+  n.m_openGL[8]=9.0f;
+  EXPECT_TRUE(block.set("o[1].n[1]",n));
+  EXPECT_FLOAT_EQ(floatAt(block,320),4.0f);
+  EXPECT_FLOAT_EQ(floatAt(block,324),5.0f);
+  EXPECT_FLOAT_EQ(floatAt(block,352),6.0f);
+  EXPECT_FLOAT_EQ(floatAt(block,384+48+32+8),9.0f);
+  // the Member setters skip the look up
+  const ngl::UniformBlockLayout::Member *h=layout.find("h");
+  block.set(*h,2.0f,1);
+  EXPECT_FLOAT_EQ(floatAt(block,80),2.0f);
+}
+
+TEST(NGLUniformBlock,loadFromProgram)
+{
+  ngl::ShaderLib *shader=ngl::ShaderLib::instance();
+  shader->createShaderProgram("Blocks");
+  GLuint id=shader->getProgramID("Blocks");
+  // what a driver reports for "layout(std140) uniform Frame { mat4 VP; vec3 eye; float time; vec4 colours[2]; };"
+  recordingGL::state().blocks[id]=
+  {
+    {"Other",16,{{"unused",GL_FLOAT,1,0,0,0}}},
+    {"Frame",112,
+      {
+        {"colours[0]",GL_FLOAT_VEC4,2,80,16,0},
+        {"VP",GL_FLOAT_MAT4,1,0,0,16},
+        {"eye",GL_FLOAT_VEC3,1,64,0,0},
+        {"time",GL_FLOAT,1,76,0,0}
+      }
+    }
+  };
+  shader->linkProgramObject("Blocks");
+  ngl::UniformBlockLayout layout;
+  EXPECT_FALSE(layout.loadFromProgram(id,"NotABlock"));
+  ASSERT_TRUE(layout.loadFromProgram(id,"Frame"));
+  EXPECT_EQ(layout.size(),112u);
+  ASSERT_EQ(layout.members().size(),4u);
+  // in offset order with the [0] taken off arrays
+  EXPECT_EQ(layout.members()[0].m_name,"VP");
+  EXPECT_EQ(layout.members()[3].m_name,"colours");
+  EXPECT_EQ(layout.find("colours")->m_arraySize,2);
+  // and the same as the CPU std140 layout
+  ngl::UniformBlockLayout cpu;
+  cpu.addMember("VP",GL_FLOAT_MAT4);
+  cpu.addMember("eye",GL_FLOAT_VEC3);
+  cpu.addMember("time",GL_FLOAT);
+  cpu.addMember("colours",GL_FLOAT_VEC4,2);
+  EXPECT_EQ(cpu.size(),layout.size());
+  for(auto &m : cpu.members())
+  {
+    const ngl::UniformBlockLayout::Member *fromGL=layout.find(m.m_name);
+    ASSERT_TRUE(fromGL!=nullptr) <<m.m_name;
+    EXPECT_EQ(fromGL->m_offset,m.m_offset) <<m.m_name;
+    EXPECT_EQ(fromGL->m_type,m.m_type) <<m.m_name;
+    EXPECT_EQ(fromGL->m_arrayStride,m.m_arrayStride) <<m.m_name;
+    EXPECT_EQ(fromGL->m_matrixStride,m.m_matrixStride) <<m.m_name;
+  }
+  ngl::UniformBlock block(layout);
+  EXPECT_TRUE(block.set("colours[1]",ngl::Vec4(1.0f,2.0f,3.0f,4.0f)));
+  EXPECT_FLOAT_EQ(floatAt(block,96+12),4.0f);
+  // and the binding point set for the block
+  shader->use("Blocks");
+  shader->setUniformBlockBinding("Frame",3);
+  EXPECT_EQ(recordingGL::state().blockBindings[id*100+1],3u);
+}
+
+TEST(NGLUniformBlock,materialAndLight)
+{
+  ngl::UniformBlockLayout material;
+  material.addMember("ambient",GL_FLOAT_VEC4);
+  material.addMember("diffuse",GL_FLOAT_VEC4);
+  material.addMember("specular",GL_FLOAT_VEC4);
+  material.addMember("shininess",GL_FLOAT);
+  ngl::UniformBlockLayout light;
+  light.addMember("position",GL_FLOAT_VEC4);
+  light.addMember("ambient",GL_FLOAT_VEC4);
+  light.addMember("diffuse",GL_FLOAT_VEC4);
+  light.addMember("specular",GL_FLOAT_VEC4);
+  light.addMember("constantAttenuation",GL_FLOAT);
+  light.addMember("linearAttenuation",GL_FLOAT);
+  light.addMember("quadraticAttenuation",GL_FLOAT);
+  light.addMember("spotCosCutoff",GL_FLOAT);
+  ngl::UniformBlockLayout layout;
+  layout.addStruct("material",material);
+  layout.addStruct("lights",light,2);
+  ngl::UniformBlock block(layout);
+  ngl::Material m(ngl::Colour(0.1f,0.2f,0.3f,1.0f),ngl::Colour(0.4f,0.5f,0.6f,1.0f),ngl::Colour(0.7f,0.8f,0.9f,1.0f));
+  m.setSpecularExponent(20.0f);
+  m.loadToBlock(block,"material");
+  EXPECT_FLOAT_EQ(floatAt(block,offsetOf(layout,"material.diffuse")+4),0.5f);
+  EXPECT_FLOAT_EQ(floatAt(block,offsetOf(layout,"material.shininess")),20.0f);
+  ngl::Light l(ngl::Vec3(1.0f,2.0f,3.0f),ngl::Colour(1.0f,1.0f,1.0f,1.0f),ngl::LightModes::POINTLIGHT);
+  l.setAttenuation(1.0f,0.5f,0.25f);
+  l.loadToBlock(block,"lights[1]");
+  size_t position=offsetOf(layout,"lights[1].position");
+  EXPECT_FLOAT_EQ(floatAt(block,position),1.0f);
+  EXPECT_FLOAT_EQ(floatAt(block,position+8),3.0f);
+  EXPECT_FLOAT_EQ(floatAt(block,position+12),float(ngl::LightModes::POINTLIGHT));
+  EXPECT_FLOAT_EQ(floatAt(block,offsetOf(layout,"lights[1].linearAttenuation")),0.5f);
+  EXPECT_FLOAT_EQ(floatAt(block,offsetOf(layout,"lights[0].linearAttenuation")),0.0f);
+}
+
+TEST(NGLUniformRing,allocate)
+{
+  ngl::UniformRing ring(1024,256,2);
+  EXPECT_EQ(ring.allocate(100),0);
+  EXPECT_EQ(ring.allocate(100),256);
+  EXPECT_EQ(ring.allocate(256),512);
+  EXPECT_EQ(ring.used(),768u);
+  // doesn't fit at the end so wraps to the start, which is still in use by this frame
+  EXPECT_EQ(ring.allocate(300),-1);
+  EXPECT_EQ(ring.used(),768u);
+  EXPECT_EQ(ring.allocate(256),768);
+  EXPECT_EQ(ring.allocate(1),-1);
+  EXPECT_EQ(ring.allocate(2000),-1);
+  // with 2 frames in flight the last frame is kept
+  ring.nextFrame();
+  EXPECT_EQ(ring.allocate(1),-1);
+  ring.nextFrame();
+  EXPECT_EQ(ring.used(),0u);
+  EXPECT_EQ(ring.allocate(100),0);
+  ring.nextFrame();
+  // the previous frame holds [0,100) so a wrap to 0 can't happen until the next
+  EXPECT_EQ(ring.allocate(700),256);
+  EXPECT_EQ(ring.allocate(100),-1);
+  ring.nextFrame();
+  EXPECT_EQ(ring.allocate(100),0);
+  ring.reset();
+  EXPECT_EQ(ring.used(),0u);
+  EXPECT_EQ(ring.head(),0u);
+}
+
+TEST(NGLUniformRing,framesInFlight)
+{
+  // three frames of 300 bytes fit in 1024 and the fourth reuses the first
+  ngl::UniformRing ring(1024,4,3);
+  GLintptr first=ring.allocate(300);
+  ring.nextFrame();
+  ring.allocate(300);
+  ring.nextFrame();
+  ring.allocate(300);
+  EXPECT_EQ(ring.allocate(300),-1);
+  ring.nextFrame();
+  EXPECT_EQ(ring.allocate(300),first);
+  EXPECT_LE(ring.used(),ring.capacity());
+  // a single frame in flight frees everything each frame
+  ngl::UniformRing single(512,16,1);
+  for(int frame=0; frame<10; ++frame)
+  {
+    EXPECT_GE(single.allocate(400),0);
+    single.nextFrame();
+    EXPECT_EQ(single.used(),0u);
+  }
+}
+
+TEST(NGLUniformBuffer,pushAndBind)
+{
+  auto &state=recordingGL::state();
+  state.bufferUploads=0;
+  state.bufferBytes=0;
+  state.ranges.clear();
+  ngl::UniformBuffer ubo(1024,2,256);
+  ASSERT_EQ(state.buffers[ubo.getID()].size(),1024u);
+  std::vector<float> a(16,1.0f),b(16,2.0f),c(8,3.0f);
+  GLintptr offsetA=ubo.push(a.data(),64);
+  GLintptr offsetB=ubo.push(b.data(),64);
+  EXPECT_EQ(offsetA,0);
+  EXPECT_EQ(offsetB,256);
+  EXPECT_EQ(state.bufferUploads,0u);
+  // the first bind sends everything pushed in one upload
+  ubo.bindRange(0,offsetA,64);
+  ubo.bindRange(1,offsetB,64);
+  EXPECT_EQ(state.bufferUploads,1u);
+  EXPECT_EQ(state.bufferBytes,256u+64u);
+  ASSERT_EQ(state.ranges.size(),2u);
+  EXPECT_EQ(state.ranges[1].binding,1u);
+  EXPECT_EQ(state.ranges[1].buffer,ubo.getID());
+  EXPECT_EQ(state.ranges[1].offset,256);
+  EXPECT_EQ(state.ranges[1].size,64);
+  const std::vector<unsigned char> &gpu=state.buffers[ubo.getID()];
+  EXPECT_EQ(std::memcmp(&gpu[0],a.data(),64),0);
+  EXPECT_EQ(std::memcmp(&gpu[256],b.data(),64),0);
+  // the next frame carries on after the last and wraps to the start once frame 1 is no longer in flight
+  ubo.nextFrame();
+  EXPECT_EQ(ubo.push(c.data(),32),512);
+  EXPECT_EQ(ubo.push(c.data(),32),768);
+  ubo.nextFrame();
+  GLintptr offsetC=ubo.push(c.data(),32);
+  EXPECT_EQ(offsetC,0);
+  ubo.bindRange(2,offsetC,32);
+  EXPECT_EQ(std::memcmp(&gpu[0],c.data(),32),0);
+  EXPECT_EQ(ubo.stats().m_overflows,0u);
+  EXPECT_EQ(ubo.stats().m_binds,3u);
+}
+
+TEST(NGLUniformBuffer,wrapAndOverflow)
+{
+  auto &state=recordingGL::state();
+  ngl::UniformBuffer ubo(1024,3,256);
+  std::vector<unsigned char> data(200);
+  for(size_t i=0; i<data.size(); ++i)
+  {
+    data[i]=static_cast<unsigned char>(i);
+  }
+  ubo.push(data.data(),200);
+  ubo.push(data.data(),200);
+  ubo.push(data.data(),200);
+  state.bufferUploads=0;
+  // more than the buffer holds in one frame, the pending data is sent before the start is reused
+  ubo.push(data.data(),200);
+  EXPECT_EQ(ubo.push(data.data(),200),0);
+  EXPECT_EQ(ubo.stats().m_overflows,1u);
+  EXPECT_EQ(state.bufferUploads,1u);
+  ubo.flush();
+  EXPECT_EQ(state.bufferUploads,2u);
+  const std::vector<unsigned char> &gpu=state.buffers[ubo.getID()];
+  EXPECT_EQ(std::memcmp(&gpu[768],data.data(),200),0);
+  EXPECT_EQ(std::memcmp(&gpu[0],data.data(),200),0);
+  EXPECT_EQ(ubo.push(data.data(),2000),-1);
+}
@@ -0,0 +1,157 @@
+#include <ngl/Vec3.h>
+#include <ngl/Vec3Array.h>
+#include <hayai/hayai.hpp>
+#include <hayai/hayai_main.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+// compares loops over std::vector<Vec3> (AoS) with the same operation on a Vec3Array (SoA) for a
+// particle style update (p+=v*dt), normalize, dot, cross and the min / max extents. Hayai reports the
+// time per call, the table at the end gives the million elements / second of each.
+static const size_t s_count=100000;
+
+static std::vector<ngl::Vec3> s_pos;
+static std::vector<ngl::Vec3> s_vel;
+static std::vector<ngl::Vec3> s_res;
+static std::vector<ngl::Real> s_dot;
+static ngl::Vec3Array s_apos;
+static ngl::Vec3Array s_avel;
+static ngl::Vec3Array s_ares;
+static ngl::Vec3 s_min,s_max;
+
+void aosMadd()
+{
+  for(size_t i=0; i<s_count; ++i)
+  {
+    s_pos[i]+=s_vel[i]*0.01f;
+  }
+}
+
+void soaMadd()
+{
+  s_apos.madd(s_avel,0.01f);
+}
+
+void aosNormalize()
+{
+  for(size_t i=0; i<s_count; ++i)
+  {
+    s_res[i]=s_vel[i];
+    s_res[i].normalize();
+  }
+}
+
+void soaNormalize()
+{
+  s_ares=s_avel;
+  s_ares.normalize();
+}
+
+void aosDot()
+{
+  for(size_t i=0; i<s_count; ++i)
+  {
+    s_dot[i]=s_pos[i].dot(s_vel[i]);
+  }
+}
+
+void soaDot()
+{
+  s_apos.dot(s_avel,s_dot);
+}
+
+void aosCross()
+{
+  for(size_t i=0; i<s_count; ++i)
+  {
+    s_res[i].cross(s_pos[i],s_vel[i]);
+  }
+}
+
+void soaCross()
+{
+  s_ares.cross(s_apos,s_avel);
+}
+
+void aosMinMax()
+{
+  ngl::Vec3 lo=s_pos[0];
+  ngl::Vec3 hi=s_pos[0];
+  for(auto &p : s_pos)
+  {
+    lo.set(std::min(lo.m_x,p.m_x),std::min(lo.m_y,p.m_y),std::min(lo.m_z,p.m_z));
+    hi.set(std::max(hi.m_x,p.m_x),std::max(hi.m_y,p.m_y),std::max(hi.m_z,p.m_z));
+  }
+  s_min=lo;
+  s_max=hi;
+}
+
+void soaMinMax()
+{
+  s_apos.minMax(s_min,s_max);
+}
+
+BENCHMARK(Madd, AoS, 10, 100) { aosMadd(); }
+BENCHMARK(Madd, SoA, 10, 100) { soaMadd(); }
+BENCHMARK(Normalize, AoS, 10, 100) { aosNormalize(); }
+BENCHMARK(Normalize, SoA, 10, 100) { soaNormalize(); }
+BENCHMARK(Dot, AoS, 10, 100) { aosDot(); }
+BENCHMARK(Dot, SoA, 10, 100) { soaDot(); }
+BENCHMARK(Cross, AoS, 10, 100) { aosCross(); }
+BENCHMARK(Cross, SoA, 10, 100) { soaCross(); }
+BENCHMARK(MinMax, AoS, 10, 100) { aosMinMax(); }
+BENCHMARK(MinMax, SoA, 10, 100) { soaMinMax(); }
+
+double perSecond(void (*_func)())
+{
+  double best=1e30;
+  for(int run=0; run<5; ++run)
+  {
+    auto start=std::chrono::high_resolution_clock::now();
+    for(int i=0; i<100; ++i)
+    {
+      _func();
+    }
+    std::chrono::duration<double> time=std::chrono::high_resolution_clock::now()-start;
+    best=std::min(best,time.count()/100);
+  }
+  return s_count/best;
+}
+
+
+int main(int argc, char **argv)
+{
+  s_pos.resize(s_count);
+  s_vel.resize(s_count);
+  s_res.resize(s_count);
+  s_dot.resize(s_count);
+  for(size_t i=0; i<s_count; ++i)
+  {
+    s_pos[i].set(i%1000*0.01f,(i/1000)%1000*0.01f,i*1e-6f);
+    s_vel[i].set(0.5f-(i%7)*0.1f,1.0f,(i%13)*0.05f);
+  }
+  s_apos.set(s_pos);
+  s_avel.set(s_vel);
+  s_ares.resize(s_count);
+  // Set up the main runner.
+  ::hayai::MainRunner runner;
+  // Parse the arguments.
+  int result = runner.ParseArgs(argc, argv);
+  if (result)
+      return result;
+
+  // Execute based on the selected mode.
+  result=runner.Run();
+
+  std::cout<<"\nmillion elements / second ("<<s_count<<" elements)\n";
+  printf("%10s %12s %12s\n","","AoS","SoA");
+  printf("%10s %12.1f %12.1f\n","Madd",perSecond(aosMadd)*1e-6,perSecond(soaMadd)*1e-6);
+  printf("%10s %12.1f %12.1f\n","Normalize",perSecond(aosNormalize)*1e-6,perSecond(soaNormalize)*1e-6);
+  printf("%10s %12.1f %12.1f\n","Dot",perSecond(aosDot)*1e-6,perSecond(soaDot)*1e-6);
+  printf("%10s %12.1f %12.1f\n","Cross",perSecond(aosCross)*1e-6,perSecond(soaCross)*1e-6);
+  printf("%10s %12.1f %12.1f\n","MinMax",perSecond(aosMinMax)*1e-6,perSecond(soaMinMax)*1e-6);
+  return result;
+}
@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+#include <ngl/Types.h>
+#include <ngl/Vec3Array.h>
+#include <ngl/Vec4Array.h>
+#include <cstdint>
+#include <vector>
+
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// 11 elements so both the SIMD loop and the remainder are used
+static const size_t s_count=11;
+
+std::vector<ngl::Vec3> testVec3(float _offset=0.0f)
+{
+  std::vector<ngl::Vec3> v;
+  for(size_t i=0; i<s_count; ++i)
+  {
+    v.push_back(ngl::Vec3(i*0.5f-2.0f+_offset,1.0f-i*0.25f,i*i*0.1f-_offset));
+  }
+  return v;
+}
+
+std::vector<ngl::Vec4> testVec4(float _offset=0.0f)
+{
+  std::vector<ngl::Vec4> v;
+  for(size_t i=0; i<s_count; ++i)
+  {
+    v.push_back(ngl::Vec4(i*0.5f-2.0f+_offset,1.0f-i*0.25f,i*i*0.1f-_offset,i+1.0f));
+  }
+  return v;
+}
+
+TEST(NGLVec3Array,convert)
+{
+  std::vector<ngl::Vec3> v=testVec3();
+  ngl::Vec3Array a(v);
+  EXPECT_EQ(a.size(),s_count);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(a.x()) % 32,0u);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(a.z()) % 32,0u);
+  std::vector<ngl::Vec3> res=a.toVector();
+  ASSERT_EQ(res.size(),s_count);
+  for(size_t i=0; i<s_count; ++i)
+  {
+    EXPECT_TRUE(res[i]==v[i]);
+    EXPECT_TRUE(a[i]==v[i]);
+  }
+  a.set(3,ngl::Vec3(9.0f,8.0f,7.0f));
+  EXPECT_TRUE(a[3]==ngl::Vec3(9.0f,8.0f,7.0f));
+  a.push_back(ngl::Vec3(1.0f,2.0f,3.0f));
+  EXPECT_EQ(a.size(),s_count+1);
+  EXPECT_TRUE(a[s_count]==ngl::Vec3(1.0f,2.0f,3.0f));
+  a.clear();
+  EXPECT_TRUE(a.empty());
+}
+
+TEST(NGLVec3Array,arithmetic)
+{
+  std::vector<ngl::Vec3> v1=testVec3();
+  std::vector<ngl::Vec3> v2=testVec3(1.5f);
+  ngl::Vec3Array a(v1);
+  ngl::Vec3Array b(v2);
+  a+=b;
+  for(size_t i=0; i<s_count; ++i)
+  {
+    EXPECT_TRUE(a[i]==v1[i]+v2[i]);
+  }
+  a-=b;
+  a*=b;
+  for(size_t i=0; i<s_count; ++i)
+  {
+    EXPECT_TRUE(a[i]==ngl::Vec3(v1[i].m_x*v2[i].m_x,v1[i].m_y*v2[i].m_y,v1[i].m_z*v2[i].m_z));
+  }
+  a.set(v1);
+  a*=2.0f;
+  a.madd(b,0.5f);
+  for(size_t i=0; i<s_count; ++i)
+  {
+    EXPECT_TRUE(a[i]==v1[i]*2.0f+v2[i]*0.5f);
+  }
+  a.set(v1);
+  a.madd(b,b);
+  for(size_t i=0; i<s_count; ++i)
+  {
+    EXPECT_TRUE(a[i]==v1[i]+ngl::Vec3(v2[i].m_x*v2[i].m_x,v2[i].m_y*v2[i].m_y,v2[i].m_z*v2[i].m_z));
+  }
+}
+
+TEST(NGLVec3Array,geometry)
+{
+  std::vector<ngl::Vec3> v1=testVec3();
+  std::vector<ngl::Vec3> v2=testVec3(1.5f);
+  ngl::Vec3Array a(v1);
+  ngl::Vec3Array b(v2);
+  std::vector<ngl::Real> dot;
+  a.dot(b,dot);
+  std::vector<ngl::Real> len;
+  a.length(len);
+  ASSERT_EQ(dot.size(),s_count);
+  ASSERT_EQ(len.size(),s_count);
+  for(size_t i=0; i<s_count; ++i)
+  {
+    EXPECT_FLOAT_EQ(dot[i],v1[i].dot(v2[i]));
+    EXPECT_FLOAT_EQ(len[i],v1[i].length());
+  }
+  ngl::Vec3Array c;
+  c.cross(a,b);
+  for(size_t i=0; i<s_count; ++i)
+  {
+    ngl::Vec3 expected;
+    expected.cross(v1[i],v2[i]);
+    EXPECT_TRUE(c[i]==expected);
+  }
+  // in place
+  a.cross(a,b);
+  for(size_t i=0; i<s_count; ++i)
+  {
+    EXPECT_TRUE(a[i]==c[i]);
+  }
+  a.set(v1);
+  a.set(5,ngl::Vec3(0.0f,0.0f,0.0f));
+  a.normalize();
+  for(size_t i=0; i<s_count; ++i)
+  {
+    ngl::Vec3 expected=v1[i];
+    if(i==5)
+    {
+      EXPECT_TRUE(a[i]==ngl::Vec3(0.0f,0.0f,0.0f));
+      continue;
+    }
+    expected.normalize();
+    EXPECT_TRUE(a[i]==expected);
+  }
+  c.lerp(ngl::Vec3Array(v1),b,0.25f);
+  for(size_t i=0; i<s_count; ++i)
+  {
+    EXPECT_TRUE(c[i]==v1[i]+(v2[i]-v1[i])*0.25f);
+  }
+}
+
+TEST(NGLVec3Array,minMax)
+{
+  std::vector<ngl::Vec3> v=testVec3();
+  v[9].set(-100.0f,50.0f,0.5f);
+  ngl::Vec3Array a(v);
+  ngl::Vec3 lo,hi;
+  a.minMax(lo,hi);
+  ngl::Vec3 elo=v[0];
+  ngl::Vec3 ehi=v[0];
+  for(auto &p : v)
+  {
+    elo.set(std::min(elo.m_x,p.m_x),std::min(elo.m_y,p.m_y),std::min(elo.m_z,p.m_z));
+    ehi.set(std::max(ehi.m_x,p.m_x),std::max(ehi.m_y,p.m_y),std::max(ehi.m_z,p.m_z));
+  }
+  EXPECT_TRUE(lo==elo);
+  EXPECT_TRUE(hi==ehi);
+  ngl::Vec3Array empty;
+  empty.minMax(lo,hi);
+  EXPECT_TRUE(lo==ngl::Vec3(0.0f,0.0f,0.0f));
+  EXPECT_TRUE(hi==ngl::Vec3(0.0f,0.0f,0.0f));
+}
+
+TEST(NGLVec4Array,convert)
+{
+  std::vector<ngl::Vec4> v=testVec4();
+  ngl::Vec4Array a(v);
+  EXPECT_EQ(a.size(),s_count);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(a.w()) % 32,0u);
+  std::vector<ngl::Vec4> res;
+  a.get(res);
+  ASSERT_EQ(res.size(),s_count);
+  for(size_t i=0; i<s_count; ++i)
+  {
+    EXPECT_TRUE(res[i]==v[i]);
+    EXPECT_TRUE(a[i]==v[i]);
+  }
+}
+
+TEST(NGLVec4Array,arithmetic)
+{
+  std::vector<ngl::Vec4> v1=testVec4();
+  std::vector<ngl::Vec4> v2=testVec4(1.5f);
+  ngl::Vec4Array a(v1);
+  ngl::Vec4Array b(v2);
+  a+=b;
+  for(size_t i=0; i<s_count; ++i)
+  {
+    EXPECT_TRUE(a[i]==v1[i]+v2[i]);
+  }
+  a.set(v1);
+  a.madd(b,0.5f);
+  for(size_t i=0; i<s_count; ++i)
+  {
+    EXPECT_TRUE(a[i]==v1[i]+v2[i]*0.5f);
+  }
+  a.lerp(ngl::Vec4Array(v1),b,0.75f);
+  for(size_t i=0; i<s_count; ++i)
+  {
+    EXPECT_TRUE(a[i]==v1[i]+(v2[i]-v1[i])*0.75f);
+  }
+}
+
+TEST(NGLVec4Array,geometry)
+{
+  // like Vec4 these only use x,y,z and leave w alone
+  std::vector<ngl::Vec4> v1=testVec4();
+  std::vector<ngl::Vec4> v2=testVec4(1.5f);
+  ngl::Vec4Array a(v1);
+  ngl::Vec4Array b(v2);
+  std::vector<ngl::Real> dot;
+  a.dot(b,dot);
+  std::vector<ngl::Real> len;
+  a.length(len);
+  for(size_t i=0; i<s_count; ++i)
+  {
+    EXPECT_FLOAT_EQ(dot[i],v1[i].dot(v2[i]));
+    EXPECT_FLOAT_EQ(len[i],v1[i].length());
+  }
+  ngl::Vec4Array c(a);
+  c.cross(a,b);
+  for(size_t i=0; i<s_count; ++i)
+  {
+    ngl::Vec4 expected=v1[i];
+    expected.cross(v1[i],v2[i]);
+    EXPECT_TRUE(c[i]==expected);
+  }
+  a.normalize();
+  for(size_t i=0; i<s_count; ++i)
+  {
+    ngl::Vec4 expected=v1[i];
+    expected.normalize();
+    EXPECT_TRUE(a[i]==expected);
+  }
+}